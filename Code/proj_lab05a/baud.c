@@ -0,0 +1,63 @@
+//! \file   baud.c
+//! \brief  Contains the SCI baud rate calculation (BAUD) functions
+//!
+
+
+// **************************************************************************
+// the includes
+
+#include "baud.h"
+
+
+// **************************************************************************
+// the defines
+
+
+// **************************************************************************
+// the globals
+
+
+// **************************************************************************
+// the functions
+
+bool BAUD_compute(const uint32_t lspClk_Hz,const uint32_t rate,BAUD_Config_t *pConfig)
+{
+  uint32_t divider;
+  int64_t delta;
+
+
+  pConfig->rate = rate;
+  pConfig->brr = 0;
+  pConfig->actual = 0;
+  pConfig->error_ppm = 0;
+
+  if(rate == 0)
+    {
+      return(false);
+    }
+
+  // round LSPCLK / (8 * rate) to the nearest integer, that is BRR + 1
+  divider = (lspClk_Hz + 4 * rate) / (8 * rate);
+
+  if((divider < 2) || (divider > 0x10000UL))
+    {
+      return(false);
+    }
+
+  pConfig->brr = (uint_least16_t)(divider - 1);
+  pConfig->actual = lspClk_Hz / (8 * divider);
+
+  // error from the exact rate, not the truncated one reported in actual
+  delta = (int64_t)lspClk_Hz - (int64_t)8 * divider * rate;
+  pConfig->error_ppm = (int32_t)((delta * 1000000L) / ((int64_t)8 * divider * rate));
+
+  if((pConfig->error_ppm > BAUD_MAX_ERROR_ppm) || (pConfig->error_ppm < -BAUD_MAX_ERROR_ppm))
+    {
+      return(false);
+    }
+
+  return(true);
+} // end of BAUD_compute() function
+
+
+// end of file
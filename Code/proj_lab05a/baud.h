@@ -0,0 +1,76 @@
+#ifndef _BAUD_H_
+#define _BAUD_H_
+
+//! \file   baud.h
+//! \brief  Contains the public interface to the SCI baud rate calculation (BAUD)
+//!
+//!         The F2806x SCI runs at LSPCLK / ((BRR + 1) * 8) for BRR in
+//!         [1, 0xFFFF].  BRR is rounded to the nearest achievable rate, and
+//!         that rate and its error against the requested one are reported, so
+//!         the other end of the link can be set to exactly the same rate.
+//!
+//!         The module has no device specific includes and builds on the host.
+
+
+// **************************************************************************
+// the includes
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+//!
+//!
+//! \defgroup BAUD BAUD
+//!
+//@{
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+// **************************************************************************
+// the defines
+
+//! \brief Defines the largest accepted baud rate error, parts per million
+//!
+#define BAUD_MAX_ERROR_ppm          (30000L)
+
+//! \brief Defines the link default baud rate
+//!
+#define BAUD_DEFAULT_RATE           (115200UL)
+
+
+// **************************************************************************
+// the typedefs
+
+//! \brief Defines a computed baud rate setting
+//!
+typedef struct _BAUD_Config_t_
+{
+  uint32_t        rate;           //!< the requested baud rate
+  uint_least16_t  brr;            //!< the SCIHBAUD:SCILBAUD value
+  uint32_t        actual;         //!< the baud rate the SCI will really run at
+  int32_t         error_ppm;      //!< (actual - rate) / rate, parts per million
+} BAUD_Config_t;
+
+
+// **************************************************************************
+// the function prototypes
+
+//! \brief      Computes the BRR value for a baud rate
+//! \param[in]  lspClk_Hz  The low speed peripheral clock, Hz
+//! \param[in]  rate       The requested baud rate
+//! \param[out] pConfig    A pointer to the result, always written
+//! \return     False if BRR is out of range or the error exceeds BAUD_MAX_ERROR_ppm
+extern bool BAUD_compute(const uint32_t lspClk_Hz,const uint32_t rate,BAUD_Config_t *pConfig);
+
+
+#ifdef __cplusplus
+}
+#endif // extern "C"
+
+//@} // ingroup
+#endif // end of _BAUD_H_ definition
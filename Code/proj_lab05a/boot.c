@@ -0,0 +1,95 @@
+//! \file   boot.c
+//! \brief  Contains the boot phase timeline (BOOT) functions
+//!
+
+
+// **************************************************************************
+// the includes
+
+#include "boot.h"
+
+
+// **************************************************************************
+// the defines
+
+
+// **************************************************************************
+// the globals
+
+
+// **************************************************************************
+// the functions
+
+void BOOT_init(BOOT_Obj *obj,const uint32_t start_cnt,const uint32_t cntPerUs)
+{
+  uint_least16_t phase;
+
+
+  for(phase=0;phase<BOOT_MAX_PHASES;phase++)
+    {
+      obj->time_us[phase] = 0;
+    }
+
+  obj->start_cnt = start_cnt;
+  obj->cntPerUs = (cntPerUs != 0) ? cntPerUs : 1;
+  obj->doneMask = 0;
+  obj->sentMask = 0;
+  obj->flag_report = false;
+  obj->flag_request = false;
+
+  return;
+} // end of BOOT_init() function
+
+
+bool BOOT_mark(BOOT_Obj *obj,const uint_least16_t phase,const uint32_t cnt)
+{
+  const uint16_t bit = (uint16_t)1 << (phase & (BOOT_MAX_PHASES - 1));
+
+
+  if(obj->doneMask & bit)
+    {
+      return(false);
+    }
+
+  // the timer counts down
+  obj->time_us[phase & (BOOT_MAX_PHASES - 1)] = (obj->start_cnt - cnt) / obj->cntPerUs;
+  obj->doneMask |= bit;
+
+  return(true);
+} // end of BOOT_mark() function
+
+
+bool BOOT_getNext(BOOT_Obj *obj,uint_least16_t *pPhase,uint32_t *pTime_us)
+{
+  uint16_t pending;
+  uint_least16_t phase;
+
+
+  if(obj->flag_request)
+    {
+      obj->flag_request = false;
+      obj->flag_report = true;
+      obj->sentMask = 0;
+    }
+
+  pending = obj->doneMask & ~obj->sentMask;
+
+  if(!obj->flag_report || (pending == 0))
+    {
+      return(false);
+    }
+
+  for(phase=0;(pending & ((uint16_t)1 << phase)) == 0;phase++)
+    {
+    }
+
+  obj->sentMask |= (uint16_t)1 << phase;
+
+  *pPhase = phase;
+  *pTime_us = obj->time_us[phase];
+
+  return(true);
+} // end of BOOT_getNext() function
+
+
+// end of file
@@ -0,0 +1,119 @@
+#ifndef _BOOT_H_
+#define _BOOT_H_
+
+//! \file   boot.h
+//! \brief  Contains the public interface to the boot phase timeline (BOOT)
+//!
+//!         main() marks the end of each init step with BOOT_mark(), and the
+//!         background loop marks the controller state changes and the first
+//!         torque command.  Each phase keeps the time it was first marked,
+//!         in us since BOOT_init(), so the timeline can be read from the
+//!         watch window or sent over the command link afterwards.
+//!
+//!         The time base is a free running timer that counts down, such as
+//!         CPU timer 2.  It wraps after 2^32 counts, 47 s at 90 MHz, so only
+//!         phases marked within that time are right.
+//!
+//!         BOOT_requestReport() asks for the timeline, and BOOT_getNext()
+//!         then hands out every marked phase once, and each phase marked
+//!         later as it comes.
+//!
+//!         The module has no device specific includes and builds on the host.
+
+
+// **************************************************************************
+// the includes
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+//!
+//!
+//! \defgroup BOOT BOOT
+//!
+//@{
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+// **************************************************************************
+// the defines
+
+//! \brief Defines the number of phases the timeline holds, bit per phase
+//!
+#define BOOT_MAX_PHASES             (16)
+
+
+// **************************************************************************
+// the typedefs
+
+//! \brief Defines the boot phase timeline
+//!
+typedef struct _BOOT_Obj_
+{
+  uint32_t        start_cnt;                 //!< the timer count at BOOT_init()
+  uint32_t        cntPerUs;                  //!< the timer counts per us
+  uint32_t        time_us[BOOT_MAX_PHASES];  //!< the time each phase was marked, us
+  uint16_t        doneMask;                  //!< the phases marked, bit per phase
+  uint16_t        sentMask;                  //!< the phases BOOT_getNext() handed out since the request
+  bool            flag_report;               //!< a report was asked for
+  volatile bool   flag_request;              //!< set by BOOT_requestReport(), may be from an ISR
+} BOOT_Obj;
+
+
+// **************************************************************************
+// the function prototypes
+
+//! \brief     Initializes the timeline empty, the time base starts here
+//! \param[in] obj        A pointer to the timeline
+//! \param[in] start_cnt  The timer count now
+//! \param[in] cntPerUs   The timer counts per us
+extern void BOOT_init(BOOT_Obj *obj,const uint32_t start_cnt,const uint32_t cntPerUs);
+
+
+//! \brief     Marks the end of a phase, only the first mark of a phase is kept
+//! \param[in] obj    A pointer to the timeline
+//! \param[in] phase  The phase, below BOOT_MAX_PHASES
+//! \param[in] cnt    The timer count now
+//! \return    True if the phase was marked now
+extern bool BOOT_mark(BOOT_Obj *obj,const uint_least16_t phase,const uint32_t cnt);
+
+
+//! \brief     Determines if a phase was marked
+//! \param[in] obj    A pointer to the timeline
+//! \param[in] phase  The phase
+//! \return    True if the phase was marked
+static inline bool BOOT_isDone(BOOT_Obj *obj,const uint_least16_t phase)
+{
+  return((obj->doneMask & ((uint16_t)1 << (phase & (BOOT_MAX_PHASES - 1)))) != 0);
+} // end of BOOT_isDone() function
+
+
+//! \brief     Asks for the whole timeline to be handed out again by BOOT_getNext()
+//! \param[in] obj  A pointer to the timeline
+static inline void BOOT_requestReport(BOOT_Obj *obj)
+{
+  obj->flag_request = true;
+
+  return;
+} // end of BOOT_requestReport() function
+
+
+//! \brief      Gets the next marked phase to report, in phase order
+//! \param[in]  obj      A pointer to the timeline
+//! \param[out] pPhase   The phase
+//! \param[out] pTime_us The time the phase was marked, us
+//! \return     True if a phase was handed out, false before a request or when all were
+extern bool BOOT_getNext(BOOT_Obj *obj,uint_least16_t *pPhase,uint32_t *pTime_us);
+
+
+#ifdef __cplusplus
+}
+#endif // extern "C"
+
+//@} // ingroup
+#endif // end of _BOOT_H_ definition
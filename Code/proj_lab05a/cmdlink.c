@@ -0,0 +1,199 @@
+//! \file   cmdlink.c
+//! \brief  Contains the frame encoder and decoder for the binary command link
+//!         between the Teensy balance controller and the F28069 torque controller
+//!
+
+
+// **************************************************************************
+// the includes
+
+#include "cmdlink.h"
+
+
+// **************************************************************************
+// the defines
+
+
+// **************************************************************************
+// the globals
+
+//! \brief CRC-8 (poly 0x07) remainders for each 4 bit value
+//!
+static const uint_least8_t CMDLINK_crcTable[16] =
+{
+  0x00, 0x07, 0x0E, 0x09, 0x1C, 0x1B, 0x12, 0x15,
+  0x38, 0x3F, 0x36, 0x31, 0x24, 0x23, 0x2A, 0x2D
+};
+
+
+// **************************************************************************
+// the functions
+
+uint_least8_t CMDLINK_crc8(const uint_least8_t *pData,const uint_least8_t length)
+{
+  uint_least8_t crc = 0;
+  uint_least8_t cnt;
+
+
+  for(cnt=0;cnt<length;cnt++)
+    {
+      crc ^= (pData[cnt] & 0xFF);
+
+      // two nibbles per byte
+      crc = ((crc << 4) & 0xFF) ^ CMDLINK_crcTable[crc >> 4];
+      crc = ((crc << 4) & 0xFF) ^ CMDLINK_crcTable[crc >> 4];
+    }
+
+  return(crc);
+} // end of CMDLINK_crc8() function
+
+
+void CMDLINK_encode(uint_least8_t *pBuf,const CMDLINK_Frame_t *pFrame)
+{
+  uint32_t payload = (uint32_t)pFrame->payload;
+
+
+  pBuf[0] = CMDLINK_SYNC;
+  pBuf[1] = pFrame->seq & 0xFF;
+  pBuf[2] = pFrame->type & 0xFF;
+  pBuf[3] = (uint_least8_t)(payload & 0xFF);
+  pBuf[4] = (uint_least8_t)((payload >> 8) & 0xFF);
+  pBuf[5] = (uint_least8_t)((payload >> 16) & 0xFF);
+  pBuf[6] = (uint_least8_t)((payload >> 24) & 0xFF);
+  pBuf[7] = CMDLINK_crc8(&pBuf[1],CMDLINK_CRC_LENGTH);
+
+  return;
+} // end of CMDLINK_encode() function
+
+
+void CMDLINK_initDecoder(CMDLINK_Decoder_t *pDecoder)
+{
+  pDecoder->length = 0;
+  pDecoder->telemLength = 0;
+  pDecoder->telemMask = 0;
+  pDecoder->telemFrameLength = 0;
+  pDecoder->numFrames = 0;
+  pDecoder->numCrcErrors = 0;
+  pDecoder->numSyncErrors = 0;
+  pDecoder->numTelemFrames = 0;
+
+  return;
+} // end of CMDLINK_initDecoder() function
+
+
+bool CMDLINK_decode(CMDLINK_Decoder_t *pDecoder,const uint_least8_t data,CMDLINK_Frame_t *pFrame)
+{
+  uint_least8_t *pBuf = pDecoder->buf;
+  uint_least8_t cnt;
+  uint_least8_t shift;
+
+
+  // hunt for the sync byte
+  if(pDecoder->length == 0)
+    {
+      if((data & 0xFF) != CMDLINK_SYNC)
+        {
+          pDecoder->numSyncErrors++;
+
+          return(false);
+        }
+    }
+
+  pBuf[pDecoder->length++] = data & 0xFF;
+
+  if(pDecoder->length < CMDLINK_FRAME_LENGTH)
+    {
+      return(false);
+    }
+
+  if(CMDLINK_crc8(&pBuf[1],CMDLINK_CRC_LENGTH) == pBuf[7])
+    {
+      pFrame->seq = pBuf[1];
+      pFrame->type = pBuf[2];
+      pFrame->payload = (int32_t)((uint32_t)pBuf[3] |
+                                  ((uint32_t)pBuf[4] << 8) |
+                                  ((uint32_t)pBuf[5] << 16) |
+                                  ((uint32_t)pBuf[6] << 24));
+
+      pDecoder->length = 0;
+      pDecoder->numFrames++;
+
+      return(true);
+    }
+
+  pDecoder->numCrcErrors++;
+
+  // resynchronize on the next sync byte already in the buffer
+  for(shift=1;shift<CMDLINK_FRAME_LENGTH;shift++)
+    {
+      if(pBuf[shift] == CMDLINK_SYNC)
+        {
+          break;
+        }
+    }
+
+  for(cnt=shift;cnt<CMDLINK_FRAME_LENGTH;cnt++)
+    {
+      pBuf[cnt - shift] = pBuf[cnt];
+    }
+
+  pDecoder->length = CMDLINK_FRAME_LENGTH - shift;
+
+  return(false);
+} // end of CMDLINK_decode() function
+
+
+bool CMDLINK_decodeMixed(CMDLINK_Decoder_t *pDecoder,const uint_least8_t data,CMDLINK_Frame_t *pFrame)
+{
+  uint_least16_t mask;
+
+
+  if(pDecoder->telemLength == 0)
+    {
+      // a telemetry frame can only start between command link frames
+      if((pDecoder->length != 0) || ((data & 0xFF) != CMDLINK_TELEM_SYNC))
+        {
+          return(CMDLINK_decode(pDecoder,data,pFrame));
+        }
+
+      pDecoder->telemMask = 0;
+      pDecoder->telemFrameLength = 0;
+    }
+
+  pDecoder->telemLength++;
+
+  if(pDecoder->telemLength == 3)
+    {
+      pDecoder->telemMask = data & 0xFF;
+    }
+  else if(pDecoder->telemLength == 4)
+    {
+      pDecoder->telemMask |= (uint_least16_t)(data & 0xFF) << 8;
+
+      if((pDecoder->telemMask == 0) || ((pDecoder->telemMask & ~CMDLINK_TELEM_CHANNEL_MASK) != 0))
+        {
+          pDecoder->numSyncErrors += pDecoder->telemLength;
+          pDecoder->telemLength = 0;
+
+          return(false);
+        }
+
+      // 4 bytes per channel present
+      pDecoder->telemFrameLength = CMDLINK_TELEM_BASE_LENGTH;
+
+      for(mask=pDecoder->telemMask;mask!=0;mask>>=1)
+        {
+          pDecoder->telemFrameLength += (mask & 1) << 2;
+        }
+    }
+  else if(pDecoder->telemLength == pDecoder->telemFrameLength)
+    {
+      pDecoder->telemLength = 0;
+      pDecoder->numTelemFrames++;
+    }
+
+  return(false);
+} // end of CMDLINK_decodeMixed() function
+
+
+// end of file
@@ -0,0 +1,289 @@
+#ifndef _CMDLINK_H_
+#define _CMDLINK_H_
+
+//! \file   cmdlink.h
+//! \brief  Contains the public interface to the binary command link between
+//!         the Teensy balance controller (rwp-1) and the F28069 torque
+//!         controller (proj_lab05a)
+//!
+//!         The same cmdlink.h/cmdlink.c pair is used on both ends of the link
+//!         and on the host, so it must stay free of any device specific
+//!         includes.  Keep the copies in Code/rwp-1 and Code/proj_lab05a
+//!         identical.
+//!
+//!         Every frame is CMDLINK_FRAME_LENGTH bytes long:
+//!
+//!           [0]    CMDLINK_SYNC
+//!           [1]    sequence number, incremented by the sender for each frame
+//!           [2]    frame type, see CMDLINK_Type_e
+//!           [3..6] payload, signed 32 bit, little endian
+//!           [7]    CRC-8 (poly 0x07, init 0x00) over bytes [1..6]
+//!
+//!         The type byte pads the frame to 8 bytes so that a frame is exactly
+//!         two fills of the 4 word SCI receive FIFO.  Torque commands carry the
+//!         Iq reference in amps as an IQ24 value.
+//!
+//!         Echo frames carry the sequence number of the torque command they
+//!         report on.  The payload low half is the receive to apply time and
+//!         the high half the apply to first PWM update time, both in us and
+//!         saturated at 0xFFFF.  Not every command is echoed.
+//!
+//!         Speed frames also carry the sequence number of a torque command,
+//!         and the motor speed in krpm as an IQ24 value, as the F28069 had it
+//!         when the command arrived.  They close the wheel speed loop of the
+//!         full state balance law; a command that arrives before the last
+//!         reply has gone out is not answered.
+//!
+//!         Excite frames change one setting of the F28069 excitation
+//!         generator: the top payload byte is the setting, EXCITE_Param_e in
+//!         proj_lab05a/excite.h, and the low 24 bits the signed value.  The
+//!         F28069 answers each with an ExciteAck or ExciteNack carrying the
+//!         same sequence number and payload, and sends an unsolicited
+//!         ExciteAck for the Run setting with value 0 when a run ends.
+//!
+//!         Model frames carry the wheel model the F28069 identifies online,
+//!         see proj_lab05a/wheelid.h, one CMDLINK_Model_e parameter per
+//!         frame in the same layout as the Excite payload.  They are sent in
+//!         turn every CMDLINK_MODEL_PERIOD_ms once the estimate is valid, with
+//!         a sequence number of their own, and are not answered.
+//!
+//!         BootRequest frames ask the F28069 for its boot timeline.  It
+//!         answers with a BootMark frame for each phase it has marked, and
+//!         sends one more for each phase it marks afterwards.  A BootMark
+//!         carries the CMDLINK_Boot_e phase in the sequence byte and, as
+//!         payload, the time the phase ended in us since HAL_init()
+//!         returned, see proj_lab05a/boot.h.
+//!
+//!         Baud rate handshake, both ends start at BAUD_DEFAULT_RATE:
+//!
+//!           Teensy  BaudRequest(rate)    ->
+//!                                       <-  BaudAck(actual) or BaudNack
+//!           both ends switch to actual once the Ack has been sent
+//!           Teensy  BaudProbe            ->
+//!                                       <-  BaudProbeAck
+//!
+//!         A probe that does not arrive intact within CMDLINK_PROBE_TIMEOUT_ms
+//!         makes the F28069 fall back to the previous rate, and the Teensy does
+//!         the same when no ProbeAck comes back.
+//!
+//!         The F28069 sends its telemetry frames, see proj_lab05a/telem.h, on
+//!         the same line, whole and between whole command link frames.  Their
+//!         values may hold CMDLINK_SYNC, so the Teensy reads the line with
+//!         CMDLINK_decodeMixed(), which takes the length of each telemetry
+//!         frame from its channel mask and skips it whole.
+//!
+//!         Bytes are held in uint_least8_t so the code works unchanged on the
+//!         C28x, where the smallest addressable unit is 16 bits wide.
+
+
+// **************************************************************************
+// the includes
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+//!
+//!
+//! \defgroup CMDLINK CMDLINK
+//!
+//@{
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+// **************************************************************************
+// the defines
+
+//! \brief Defines the frame synchronization byte
+//!
+#define CMDLINK_SYNC                (0xA5)
+
+//! \brief Defines the length of a frame, bytes
+//!
+#define CMDLINK_FRAME_LENGTH        (8)
+
+//! \brief Defines the number of bytes covered by the CRC
+//!
+#define CMDLINK_CRC_LENGTH          (6)
+
+//! \brief Defines the telemetry frame synchronization byte, TELEM_SYNC in proj_lab05a/telem.h
+//!
+#define CMDLINK_TELEM_SYNC          (0x5A)
+
+//! \brief Defines the telemetry frame length without channel values, TELEM_HEADER_LENGTH plus the CRC
+//!
+#define CMDLINK_TELEM_BASE_LENGTH   (7)
+
+//! \brief Defines the telemetry channels, bit per channel, TELEM_NumChannels in proj_lab05a/telem.h
+//!
+#define CMDLINK_TELEM_CHANNEL_MASK  (0x07FF)
+
+//! \brief Defines the baud rate probe payload, alternating bits to catch a wrong rate
+//!
+#define CMDLINK_PROBE_PATTERN       ((int32_t)0x55AA33CCL)
+
+//! \brief Defines how long the F28069 waits for a probe at a new baud rate, ms
+//!
+#define CMDLINK_PROBE_TIMEOUT_ms    (200)
+
+//! \brief Defines the time between Model frames, ms
+//!
+#define CMDLINK_MODEL_PERIOD_ms     (100)
+
+//! \brief Gets the receive to apply time from an Echo payload, us
+//!
+#define CMDLINK_getEchoRxToApply_us(payload)   ((uint16_t)((uint32_t)(payload) & 0xFFFF))
+
+//! \brief Gets the apply to first PWM update time from an Echo payload, us
+//!
+#define CMDLINK_getEchoApplyToPwm_us(payload)  ((uint16_t)(((uint32_t)(payload) >> 16) & 0xFFFF))
+
+//! \brief Makes an Excite or Model payload from a parameter id and a value, the value is cut to 24 bits
+//!
+#define CMDLINK_makeParamPayload(id,value)     ((int32_t)(((uint32_t)(id) << 24) | ((uint32_t)(value) & 0xFFFFFFUL)))
+
+//! \brief Gets the parameter id from an Excite or Model payload
+//!
+#define CMDLINK_getParamId(payload)            ((uint_least8_t)(((uint32_t)(payload) >> 24) & 0xFF))
+
+//! \brief Gets the sign extended value from an Excite or Model payload
+//!
+#define CMDLINK_getParamValue(payload)         ((int32_t)((((uint32_t)(payload) & 0xFFFFFFUL) ^ 0x800000UL)) - (int32_t)0x800000L)
+
+
+// **************************************************************************
+// the typedefs
+
+//! \brief Enumeration for the frame types
+//!
+typedef enum
+{
+  CMDLINK_Type_Torque=0,         //!< Iq reference in amps, IQ24
+  CMDLINK_Type_BaudRequest=1,    //!< Teensy asks to switch to the payload baud rate
+  CMDLINK_Type_BaudAck=2,        //!< F28069 accepts, the payload is the rate it will really run at
+  CMDLINK_Type_BaudNack=3,       //!< F28069 refuses, the payload is the rate it stays at
+  CMDLINK_Type_BaudProbe=4,      //!< Teensy checks the link at the new rate, payload is CMDLINK_PROBE_PATTERN
+  CMDLINK_Type_BaudProbeAck=5,   //!< F28069 commits the new rate, payload is CMDLINK_PROBE_PATTERN
+  CMDLINK_Type_Echo=6,           //!< F28069 latency stamps for the torque command with this seq
+  CMDLINK_Type_Speed=7,          //!< F28069 motor speed in krpm, IQ24, for the torque command with this seq
+  CMDLINK_Type_Excite=8,         //!< excitation setting and value, see CMDLINK_makeParamPayload()
+  CMDLINK_Type_ExciteAck=9,      //!< F28069 took the setting, same payload
+  CMDLINK_Type_ExciteNack=10,    //!< F28069 refused the setting, same payload
+  CMDLINK_Type_Model=11,         //!< F28069 identified wheel model parameter, see CMDLINK_Model_e
+  CMDLINK_Type_BootRequest=12,   //!< Teensy asks for the F28069 boot timeline
+  CMDLINK_Type_BootMark=13       //!< F28069 boot phase in the seq, its end time in us, see CMDLINK_Boot_e
+} CMDLINK_Type_e;
+
+
+//! \brief Enumeration for the Model frame parameter ids
+//!
+typedef enum
+{
+  CMDLINK_Model_Gain_rpmpsPerA=0,    //!< the wheel acceleration per A of Iq, rpm/s
+  CMDLINK_Model_Viscous_mApKrpm,     //!< the Iq that holds the viscous friction, mA per krpm
+  CMDLINK_Model_Coulomb_mA,          //!< the Iq that holds the Coulomb friction, mA
+  CMDLINK_NumModelParams             //!< the number of parameters
+} CMDLINK_Model_e;
+
+
+//! \brief Enumeration for the F28069 boot phases of BootMark frames, each marks the end of a step
+//!
+typedef enum
+{
+  CMDLINK_Boot_HalInit=0,            //!< HAL_init() returned, the timeline starts here
+  CMDLINK_Boot_UserCheck,            //!< USER_checkForErrors() passed
+  CMDLINK_Boot_UserParams,           //!< USER_setParams() and the parameter store load
+  CMDLINK_Boot_HalParams,            //!< HAL_setParams()
+  CMDLINK_Boot_CtrlInit,             //!< CTRL_initCtrl() and CTRL_setParams()
+  CMDLINK_Boot_IntsOn,               //!< the modules set up and the interrupts enabled
+  CMDLINK_Boot_DrvSpi,               //!< the DRV8305 enabled and set up over SPI
+  CMDLINK_Boot_LoopStart,            //!< the first pass of the enabled background loop
+  CMDLINK_Boot_OffLine,              //!< the controller went OffLine, the offset calibration runs
+  CMDLINK_Boot_OnLine,               //!< the controller went OnLine, the biases set and the PWM on
+  CMDLINK_Boot_FirstTorque,          //!< the first torque command reached the background loop
+  CMDLINK_NumBootPhases              //!< the number of phases
+} CMDLINK_Boot_e;
+
+
+//! \brief Defines a decoded frame
+//!
+typedef struct _CMDLINK_Frame_t_
+{
+  uint_least8_t  seq;            //!< the sequence number
+  uint_least8_t  type;           //!< the frame type, see CMDLINK_Type_e
+  int32_t        payload;        //!< the payload
+} CMDLINK_Frame_t;
+
+
+//! \brief Defines the streaming frame decoder
+//!
+typedef struct _CMDLINK_Decoder_t_
+{
+  uint_least8_t  buf[CMDLINK_FRAME_LENGTH];  //!< the partially received frame
+  uint_least8_t  length;                     //!< the number of bytes in buf
+
+  uint_least16_t telemLength;                //!< the number of bytes of the telemetry frame being skipped, 0 for none
+  uint_least16_t telemMask;                  //!< its channel mask
+  uint_least16_t telemFrameLength;           //!< its length, once the mask is in
+
+  uint32_t       numFrames;                  //!< the number of valid frames
+  uint32_t       numCrcErrors;               //!< the number of frames dropped on CRC mismatch
+  uint32_t       numSyncErrors;              //!< the number of bytes discarded while hunting for sync
+  uint32_t       numTelemFrames;             //!< the number of telemetry frames skipped
+} CMDLINK_Decoder_t;
+
+
+// **************************************************************************
+// the function prototypes
+
+//! \brief     Computes the CRC-8 of a byte buffer
+//! \param[in] pData   A pointer to the data
+//! \param[in] length  The number of bytes
+//! \return    The CRC-8 (poly 0x07, init 0x00)
+extern uint_least8_t CMDLINK_crc8(const uint_least8_t *pData,const uint_least8_t length);
+
+
+//! \brief      Encodes a frame
+//! \param[out] pBuf    A pointer to a buffer of at least CMDLINK_FRAME_LENGTH bytes
+//! \param[in]  pFrame  A pointer to the frame
+extern void CMDLINK_encode(uint_least8_t *pBuf,const CMDLINK_Frame_t *pFrame);
+
+
+//! \brief     Initializes the frame decoder
+//! \param[in] pDecoder  A pointer to the decoder
+extern void CMDLINK_initDecoder(CMDLINK_Decoder_t *pDecoder);
+
+
+//! \brief      Feeds one received byte to the frame decoder
+//! \details    Resynchronizes on the next sync byte after a CRC mismatch, so a
+//!             dropped byte costs at most one frame.
+//! \param[in]  pDecoder  A pointer to the decoder
+//! \param[in]  data      The received byte
+//! \param[out] pFrame    A pointer to the frame, written only when a valid frame completes
+//! \return     True when a valid frame has been decoded into pFrame
+extern bool CMDLINK_decode(CMDLINK_Decoder_t *pDecoder,const uint_least8_t data,CMDLINK_Frame_t *pFrame);
+
+
+//! \brief      Feeds one byte of a line that also carries telemetry frames to the frame decoder
+//! \details    A CMDLINK_TELEM_SYNC between frames starts a telemetry frame.
+//!             Its length follows from the channel mask in bytes [2..3], and
+//!             it is skipped whole without checking its CRC.  A mask with no
+//!             channels or unknown ones is counted as a sync error and the
+//!             header dropped.  Other bytes go to CMDLINK_decode().
+//! \param[in]  pDecoder  A pointer to the decoder
+//! \param[in]  data      The received byte
+//! \param[out] pFrame    A pointer to the frame, written only when a valid frame completes
+//! \return     True when a valid frame has been decoded into pFrame
+extern bool CMDLINK_decodeMixed(CMDLINK_Decoder_t *pDecoder,const uint_least8_t data,CMDLINK_Frame_t *pFrame);
+
+
+#ifdef __cplusplus
+}
+#endif // extern "C"
+
+//@} // ingroup
+#endif // end of _CMDLINK_H_ definition
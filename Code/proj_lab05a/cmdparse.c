@@ -0,0 +1,200 @@
+//! \file   cmdparse.c
+//! \brief  Contains the streaming parser (CMDPARSE) functions for the legacy
+//!         ASCII torque commands
+//!
+
+
+// **************************************************************************
+// the includes
+
+#include "cmdparse.h"
+
+
+// **************************************************************************
+// the defines
+
+
+// **************************************************************************
+// the typedefs
+
+//! \brief Defines the IQ24 weight of a fraction digit of one
+//!
+typedef struct _CMDPARSE_Weight_
+{
+  uint32_t  lsb;                  //!< the whole LSBs, floor(2^24 / 10^k)
+  uint64_t  rem;                  //!< the rest, in units of 1/CMDPARSE_FRAC_DEN LSB
+} CMDPARSE_Weight_t;
+
+
+// **************************************************************************
+// the globals
+
+//! \brief The weight of a one in fraction digit k, 2^24 / 10^k = 2^(24-k) / 5^k,
+//!        for k = 1 to CMDPARSE_MAX_FRAC_DIGITS
+//!
+static const CMDPARSE_Weight_t CMDPARSE_weight[CMDPARSE_MAX_FRAC_DIGITS] =
+{
+  {1677721UL, 35762786865234375ULL},
+  { 167772UL,  9536743164062500ULL},
+  {  16777UL, 12874603271484375ULL},
+  {   1677UL, 43010711669921875ULL},
+  {    167UL, 46024322509765625ULL},
+  {     16UL, 46325683593750000ULL},
+  {      1UL, 40395355224609375ULL},
+  {      0UL, 10000000000000000ULL},
+  {      0UL,  1000000000000000ULL},
+  {      0UL,   100000000000000ULL},
+  {      0UL,    10000000000000ULL},
+  {      0UL,     1000000000000ULL},
+  {      0UL,      100000000000ULL},
+  {      0UL,       10000000000ULL},
+  {      0UL,        1000000000ULL},
+  {      0UL,         100000000ULL},
+  {      0UL,          10000000ULL},
+  {      0UL,           1000000ULL},
+  {      0UL,            100000ULL},
+  {      0UL,             10000ULL},
+  {      0UL,              1000ULL},
+  {      0UL,               100ULL},
+  {      0UL,                10ULL},
+  {      0UL,                 1ULL}
+};
+
+
+// **************************************************************************
+// the functions
+
+void CMDPARSE_init(CMDPARSE_Obj *obj)
+{
+  obj->numErrors = 0;
+
+  CMDPARSE_reset(obj);
+
+  return;
+} // end of CMDPARSE_init() function
+
+
+void CMDPARSE_reset(CMDPARSE_Obj *obj)
+{
+  obj->state = CMDPARSE_State_Sign;
+  obj->negative = false;
+  obj->malformed = false;
+  obj->overflow = false;
+  obj->numDigits = 0;
+  obj->numFrac = 0;
+  obj->intPart = 0;
+  obj->fracLsb = 0;
+  obj->fracRem = 0;
+
+  return;
+} // end of CMDPARSE_reset() function
+
+
+void CMDPARSE_putChar(CMDPARSE_Obj *obj,const char data)
+{
+  // ignore whitespace and line endings
+  if(data <= ' ')
+    {
+      return;
+    }
+
+  if((data >= '0') && (data <= '9'))
+    {
+      uint32_t digit = (uint32_t)(data - '0');
+
+      obj->numDigits++;
+
+      if(obj->state == CMDPARSE_State_Frac)
+        {
+          if(obj->numFrac < CMDPARSE_MAX_FRAC_DIGITS)
+            {
+              const CMDPARSE_Weight_t *pWeight = &CMDPARSE_weight[obj->numFrac];
+
+              // add the digit one weight at a time, the remainder stays below
+              // CMDPARSE_FRAC_DEN so one carry per step is enough
+              for(; digit > 0; digit--)
+                {
+                  obj->fracLsb += pWeight->lsb;
+                  obj->fracRem += pWeight->rem;
+
+                  if(obj->fracRem >= CMDPARSE_FRAC_DEN)
+                    {
+                      obj->fracRem -= CMDPARSE_FRAC_DEN;
+                      obj->fracLsb++;
+                    }
+                }
+
+              obj->numFrac++;
+            }
+        }
+      else
+        {
+          obj->state = CMDPARSE_State_Int;
+
+          if(!obj->overflow)
+            {
+              obj->intPart = obj->intPart * 10 + digit;
+
+              if(obj->intPart > CMDPARSE_MAX_INT)
+                {
+                  obj->overflow = true;
+                }
+            }
+        }
+    }
+  else if(((data == '-') || (data == '+')) && (obj->state == CMDPARSE_State_Sign) && (obj->numDigits == 0))
+    {
+      obj->negative = (data == '-');
+      obj->state = CMDPARSE_State_Int;
+    }
+  else if((data == '.') && (obj->state != CMDPARSE_State_Frac))
+    {
+      obj->state = CMDPARSE_State_Frac;
+    }
+  else
+    {
+      obj->malformed = true;
+    }
+
+  return;
+} // end of CMDPARSE_putChar() function
+
+
+CMDPARSE_Status_e CMDPARSE_commit(CMDPARSE_Obj *obj,int32_t *pValue)
+{
+  CMDPARSE_Status_e status;
+
+
+  if(obj->malformed)
+    {
+      status = CMDPARSE_Status_Malformed;
+    }
+  else if(obj->numDigits == 0)
+    {
+      status = CMDPARSE_Status_Empty;
+    }
+  else if(obj->overflow)
+    {
+      *pValue = obj->negative ? INT32_MIN : INT32_MAX;
+      status = CMDPARSE_Status_Overflow;
+    }
+  else
+    {
+      int32_t value = (int32_t)((obj->intPart << 24) + obj->fracLsb);
+
+      *pValue = obj->negative ? -value : value;
+      status = CMDPARSE_Status_Ok;
+    }
+
+  if(status != CMDPARSE_Status_Ok)
+    {
+      obj->numErrors++;
+    }
+
+  CMDPARSE_reset(obj);
+
+  return(status);
+} // end of CMDPARSE_commit() function
+
+
+// end of file
@@ -0,0 +1,134 @@
+#ifndef _CMDPARSE_H_
+#define _CMDPARSE_H_
+
+//! \file   cmdparse.h
+//! \brief  Contains the public interface to the streaming parser (CMDPARSE) for
+//!         the legacy ASCII "<float>a" torque commands
+//!
+//!         Each character is folded into the accumulators as it arrives, so
+//!         the terminator only has to combine them.  The result is IQ24,
+//!         truncated toward zero bit exact with _atoIQ.  Each fraction digit
+//!         adds its exact share of an LSB as a whole part and a remainder in
+//!         units of 1/5^24, so no fraction digit is lost and the commit does
+//!         not divide.
+//!
+//!         The module has no device specific includes and builds on the host.
+
+
+// **************************************************************************
+// the includes
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+//!
+//!
+//! \defgroup CMDPARSE CMDPARSE
+//!
+//@{
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+// **************************************************************************
+// the defines
+
+//! \brief Defines the number of fraction digits that are kept, the rest are ignored
+//! \details An IQ24 step is 2^-24, whose decimal expansion ends at the 24th digit,
+//!          so the digits past it cannot move the truncated value
+//!
+#define CMDPARSE_MAX_FRAC_DIGITS    (24)
+
+//! \brief Defines the fraction remainder unit, 10^24 / 2^24 = 5^24
+//!
+#define CMDPARSE_FRAC_DEN           (59604644775390625ULL)
+
+//! \brief Defines the largest integer part that fits IQ24
+//!
+#define CMDPARSE_MAX_INT            (127)
+
+
+// **************************************************************************
+// the typedefs
+
+//! \brief Enumeration for the parser status
+//!
+typedef enum
+{
+  CMDPARSE_Status_Ok=0,           //!< a number was committed
+  CMDPARSE_Status_Empty,          //!< no digits were received
+  CMDPARSE_Status_Malformed,      //!< an unexpected character was received
+  CMDPARSE_Status_Overflow        //!< the value does not fit IQ24, the result is saturated
+} CMDPARSE_Status_e;
+
+
+//! \brief Enumeration for the parser states
+//!
+typedef enum
+{
+  CMDPARSE_State_Sign=0,          //!< waiting for a sign or the first digit
+  CMDPARSE_State_Int,             //!< receiving the integer part
+  CMDPARSE_State_Frac             //!< receiving the fraction part
+} CMDPARSE_State_e;
+
+
+//! \brief Defines the parser object
+//!
+typedef struct _CMDPARSE_Obj_
+{
+  CMDPARSE_State_e  state;        //!< the parser state
+  bool              negative;     //!< a leading '-' was received
+  bool              malformed;    //!< an unexpected character was received
+  bool              overflow;     //!< the integer part exceeded CMDPARSE_MAX_INT
+  uint_least8_t     numDigits;    //!< the number of digits received
+  uint_least8_t     numFrac;      //!< the number of significant fraction digits
+  uint32_t          intPart;      //!< the integer part
+  uint32_t          fracLsb;      //!< the fraction in IQ24 LSBs, truncated
+  uint64_t          fracRem;      //!< the truncated part of fracLsb, in units of 1/CMDPARSE_FRAC_DEN LSB
+
+  uint32_t          numErrors;    //!< the number of commits that were not Ok
+} CMDPARSE_Obj;
+
+
+// **************************************************************************
+// the function prototypes
+
+//! \brief     Initializes the parser and clears the error count
+//! \param[in] obj  A pointer to the parser object
+extern void CMDPARSE_init(CMDPARSE_Obj *obj);
+
+
+//! \brief     Starts a new number, keeping the error count
+//! \param[in] obj  A pointer to the parser object
+extern void CMDPARSE_reset(CMDPARSE_Obj *obj);
+
+
+//! \brief     Folds one character into the number
+//! \details   Whitespace and control characters are ignored.  Anything other
+//!            than a leading sign, digits and one decimal point marks the
+//!            number malformed.  A fraction digit takes at most nine 64 bit
+//!            add and compare steps and no multiply or divide.
+//! \param[in] obj   A pointer to the parser object
+//! \param[in] data  The received character
+extern void CMDPARSE_putChar(CMDPARSE_Obj *obj,const char data);
+
+
+//! \brief      Finishes the number and starts the next one
+//! \details    Constant time, a shift and an add.  On Malformed and Empty
+//!             pValue is not written.
+//! \param[in]  obj     A pointer to the parser object
+//! \param[out] pValue  A pointer to the IQ24 result
+//! \return     The parser status
+extern CMDPARSE_Status_e CMDPARSE_commit(CMDPARSE_Obj *obj,int32_t *pValue);
+
+
+#ifdef __cplusplus
+}
+#endif // extern "C"
+
+//@} // ingroup
+#endif // end of _CMDPARSE_H_ definition
@@ -1150,6 +1150,218 @@ void DRV8305_writeSpi(DRV8305_Handle handle,const DRV8305_Address_e regAddr,cons
 }  // end of DRV8305_writeSpi() function
 
 
+uint16_t DRV8305_getCtrlData(const DRV_SPI_8305_Vars_t *Spi_8305_Vars,const DRV8305_Address_e regAddr)
+{
+  uint16_t drvDataNew = 0;
+
+  switch(regAddr)
+  {
+    case Address_Control_5:
+      drvDataNew = (Spi_8305_Vars->Ctrl_Reg_05.IDRIVEP_HS) | \
+                   (Spi_8305_Vars->Ctrl_Reg_05.IDRIVEN_HS) | \
+                   (Spi_8305_Vars->Ctrl_Reg_05.TDRIVEN)    | \
+                   (Spi_8305_Vars->Ctrl_Reg_05.CTRL05_RSV1 << 10);
+      break;
+
+    case Address_Control_6:
+      drvDataNew = (Spi_8305_Vars->Ctrl_Reg_06.IDRIVEP_LS) | \
+                   (Spi_8305_Vars->Ctrl_Reg_06.IDRIVEN_LS) | \
+                   (Spi_8305_Vars->Ctrl_Reg_06.TDRIVEP)    | \
+                   (Spi_8305_Vars->Ctrl_Reg_06.CTRL06_RSV1 << 10);
+      break;
+
+    case Address_Control_7:
+      drvDataNew = (Spi_8305_Vars->Ctrl_Reg_07.TVDS)      | \
+                   (Spi_8305_Vars->Ctrl_Reg_07.TBLANK)    | \
+                   (Spi_8305_Vars->Ctrl_Reg_07.DEAD_TIME) | \
+                   (Spi_8305_Vars->Ctrl_Reg_07.PWM_MODE)  | \
+                   (Spi_8305_Vars->Ctrl_Reg_07.COMM_OPT)  | \
+                   (Spi_8305_Vars->Ctrl_Reg_07.CTRL07_RSV1 << 10);
+      break;
+
+    case Address_Control_9:
+      drvDataNew = (Spi_8305_Vars->Ctrl_Reg_09.SET_VCPH_UV << 0)    | \
+                   (Spi_8305_Vars->Ctrl_Reg_09.CLR_FLTS << 1)       | \
+                   (Spi_8305_Vars->Ctrl_Reg_09.SLEEP << 2)          | \
+                   (Spi_8305_Vars->Ctrl_Reg_09.WD_EN << 3)          | \
+                   (Spi_8305_Vars->Ctrl_Reg_09.DIS_SNS_OCP << 4)    | \
+                   (Spi_8305_Vars->Ctrl_Reg_09.WD_DLY)              | \
+                   (Spi_8305_Vars->Ctrl_Reg_09.EN_SNS_CLAMP << 7)   | \
+                   (Spi_8305_Vars->Ctrl_Reg_09.DIS_GDRV_FAULT << 8) | \
+                   (Spi_8305_Vars->Ctrl_Reg_09.DISABLE << 9)        | \
+                   (Spi_8305_Vars->Ctrl_Reg_09.FLIP_OTS << 10);
+      break;
+
+    case Address_Control_A:
+      drvDataNew = (Spi_8305_Vars->Ctrl_Reg_0A.GAIN_CS1)        | \
+                   (Spi_8305_Vars->Ctrl_Reg_0A.GAIN_CS2)        | \
+                   (Spi_8305_Vars->Ctrl_Reg_0A.GAIN_CS3)        | \
+                   (Spi_8305_Vars->Ctrl_Reg_0A.CS_BLANK)        | \
+                   (Spi_8305_Vars->Ctrl_Reg_0A.DC_CAL_CH1 << 8) | \
+                   (Spi_8305_Vars->Ctrl_Reg_0A.DC_CAL_CH2 << 9) | \
+                   (Spi_8305_Vars->Ctrl_Reg_0A.DC_CAL_CH3 << 10);
+      break;
+
+    case Address_Control_B:
+      drvDataNew = (Spi_8305_Vars->Ctrl_Reg_0B.VREG_UV_LEVEL)     | \
+                   (Spi_8305_Vars->Ctrl_Reg_0B.DIS_PWRGD << 2)    | \
+                   (Spi_8305_Vars->Ctrl_Reg_0B.SLP_DLY)           | \
+                   (Spi_8305_Vars->Ctrl_Reg_0B.CTRL0B_RSV1 << 5)  | \
+                   (Spi_8305_Vars->Ctrl_Reg_0B.CTRL0B_RSV2 << 6)  | \
+                   (Spi_8305_Vars->Ctrl_Reg_0B.CTRL0B_RSV3 << 7)  | \
+                   (Spi_8305_Vars->Ctrl_Reg_0B.VREF_SCALING)      | \
+                   (Spi_8305_Vars->Ctrl_Reg_0B.CTRL0B_RSV4 << 10);
+      break;
+
+    case Address_Control_C:
+      drvDataNew = (Spi_8305_Vars->Ctrl_Reg_0C.VDS_MODE)          | \
+                   (Spi_8305_Vars->Ctrl_Reg_0C.VDS_LEVEL)         | \
+                   (Spi_8305_Vars->Ctrl_Reg_0C.CTRL0C_RSV1 << 8)  | \
+                   (Spi_8305_Vars->Ctrl_Reg_0C.CTRL0C_RSV2 << 9)  | \
+                   (Spi_8305_Vars->Ctrl_Reg_0C.CTRL0C_RSV3 << 10);
+      break;
+
+    default:
+      break;
+  }
+
+  return(drvDataNew);
+} // end of DRV8305_getCtrlData() function
+
+
+void DRV8305_setRegData(DRV_SPI_8305_Vars_t *Spi_8305_Vars,const DRV8305_Address_e regAddr,const uint16_t drvDataNew)
+{
+  switch(regAddr)
+  {
+    case Address_Status_1:
+      Spi_8305_Vars->Stat_Reg_01.OTW         = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS01_OTW_BITS)?1:0;
+      Spi_8305_Vars->Stat_Reg_01.TEMP_FLAG3  = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS01_TEMP_FLAG3_BITS)?1:0;
+      Spi_8305_Vars->Stat_Reg_01.TEMP_FLAG2  = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS01_TEMP_FLAG2_BITS)?1:0;
+      Spi_8305_Vars->Stat_Reg_01.TEMP_FLAG1  = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS01_TEMP_FLAG1_BITS)?1:0;
+      Spi_8305_Vars->Stat_Reg_01.VCPH_UVFL   = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS01_VCPH_UVFL_BITS)?1:0;
+      Spi_8305_Vars->Stat_Reg_01.VDS_STATUS  = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS01_VDS_STATUS_BITS)?1:0;
+      Spi_8305_Vars->Stat_Reg_01.PVDD_OVFL   = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS01_PVDD_OVFL_BITS)?1:0;
+      Spi_8305_Vars->Stat_Reg_01.PVDD_UVFL   = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS01_PVDD_UVFL_BITS)?1:0;
+      Spi_8305_Vars->Stat_Reg_01.TEMP_FLAG4  = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS01_TEMP_FLAG4_BITS)?1:0;
+      Spi_8305_Vars->Stat_Reg_01.STAT01_RSV1 = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS01_RESERVED1_BITS)?1:0;
+      Spi_8305_Vars->Stat_Reg_01.FAULT       = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS01_FAULT_BITS)?1:0;
+      break;
+
+    case Address_Status_2:
+      Spi_8305_Vars->Stat_Reg_02.SNS_A_OCP   = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS02_SNS_A_OCP_BITS)?1:0;
+      Spi_8305_Vars->Stat_Reg_02.SNS_B_OCP   = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS02_SNS_B_OCP_BITS)?1:0;
+      Spi_8305_Vars->Stat_Reg_02.SNS_C_OCP   = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS02_SNS_C_OCP_BITS)?1:0;
+      Spi_8305_Vars->Stat_Reg_02.STAT02_RSV1 = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS02_RESERVED1_BITS)?1:0;
+      Spi_8305_Vars->Stat_Reg_02.STAT02_RSV2 = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS02_RESERVED2_BITS)?1:0;
+      Spi_8305_Vars->Stat_Reg_02.FETLC_VDS   = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS02_FETLC_VDS_BITS)?1:0;
+      Spi_8305_Vars->Stat_Reg_02.FETHC_VDS   = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS02_FETHC_VDS_BITS)?1:0;
+      Spi_8305_Vars->Stat_Reg_02.FETLB_VDS   = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS02_FETLB_VDS_BITS)?1:0;
+      Spi_8305_Vars->Stat_Reg_02.FETHB_VDS   = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS02_FETHB_VDS_BITS)?1:0;
+      Spi_8305_Vars->Stat_Reg_02.FETLA_VDS   = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS02_FETLA_VDS_BITS)?1:0;
+      Spi_8305_Vars->Stat_Reg_02.FETHA_VDS   = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS02_FETHA_VDS_BITS)?1:0;
+      break;
+
+    case Address_Status_3:
+      Spi_8305_Vars->Stat_Reg_03.VCPH_OVLO_ABS = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS03_VCPH_OVLO_ABS_BITS)?1:0;
+      Spi_8305_Vars->Stat_Reg_03.VCPH_OVLO     = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS03_VCPH_OVLO_BITS)?1:0;
+      Spi_8305_Vars->Stat_Reg_03.VCPH_UVLO2    = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS03_VCPH_UVLO2_BITS)?1:0;
+      Spi_8305_Vars->Stat_Reg_03.STAT03_RSV1   = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS03_RESERVED1_BITS)?1:0;
+      Spi_8305_Vars->Stat_Reg_03.VCP_LSD_UVLO2 = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS03_VCP_LSD_UVLO2_BITS)?1:0;
+      Spi_8305_Vars->Stat_Reg_03.AVDD_UVLO     = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS03_AVDD_UVLO_BITS)?1:0;
+      Spi_8305_Vars->Stat_Reg_03.VREG_UV       = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS03_VREG_UV_BITS)?1:0;
+      Spi_8305_Vars->Stat_Reg_03.STAT03_RSV2   = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS03_RESERVED2_BITS)?1:0;
+      Spi_8305_Vars->Stat_Reg_03.OTS           = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS03_OTS_BITS)?1:0;
+      Spi_8305_Vars->Stat_Reg_03.WD_FAULT      = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS03_WD_FAULT_BITS)?1:0;
+      Spi_8305_Vars->Stat_Reg_03.PVDD_UVLO2    = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS03_PVDD_UVLO2_BITS)?1:0;
+      break;
+
+    case Address_Status_4:
+      Spi_8305_Vars->Stat_Reg_04.STAT04_RSV1 = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS04_RESERVED1_BITS)?1:0;
+      Spi_8305_Vars->Stat_Reg_04.STAT04_RSV2 = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS04_RESERVED2_BITS)?1:0;
+      Spi_8305_Vars->Stat_Reg_04.STAT04_RSV3 = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS04_RESERVED3_BITS)?1:0;
+      Spi_8305_Vars->Stat_Reg_04.STAT04_RSV4 = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS04_RESERVED4_BITS)?1:0;
+      Spi_8305_Vars->Stat_Reg_04.STAT04_RSV5 = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS04_RESERVED5_BITS)?1:0;
+      Spi_8305_Vars->Stat_Reg_04.FETLC_VGS   = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS04_FETLC_VGS_BITS)?1:0;
+      Spi_8305_Vars->Stat_Reg_04.FETHC_VGS   = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS04_FETHC_VGS_BITS)?1:0;
+      Spi_8305_Vars->Stat_Reg_04.FETLB_VGS   = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS04_FETLB_VGS_BITS)?1:0;
+      Spi_8305_Vars->Stat_Reg_04.FETHB_VGS   = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS04_FETHB_VGS_BITS)?1:0;
+      Spi_8305_Vars->Stat_Reg_04.FETLA_VGS   = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS04_FETLA_VGS_BITS)?1:0;
+      Spi_8305_Vars->Stat_Reg_04.FETHA_VGS   = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS04_FETHA_VGS_BITS)?1:0;
+      break;
+
+    case Address_Control_5:
+      Spi_8305_Vars->Ctrl_Reg_05.IDRIVEP_HS  = (DRV8305_CTRL05_PeakSourCurHS_e)(drvDataNew & (uint16_t)DRV8305_CTRL05_IDRIVEP_HS_BITS);
+      Spi_8305_Vars->Ctrl_Reg_05.IDRIVEN_HS  = (DRV8305_CTRL05_PeakSinkCurHS_e)(drvDataNew & (uint16_t)DRV8305_CTRL05_IDRIVEN_HS_BITS);
+      Spi_8305_Vars->Ctrl_Reg_05.TDRIVEN     = (DRV8305_CTRL05_PeakSourTime_e)(drvDataNew & (uint16_t)DRV8305_CTRL05_TDRIVEN_BITS);
+      Spi_8305_Vars->Ctrl_Reg_05.CTRL05_RSV1 = (bool)(drvDataNew & (uint16_t)DRV8305_CTRL05_RESERVED1_BITS)?1:0;
+      break;
+
+    case Address_Control_6:
+      Spi_8305_Vars->Ctrl_Reg_06.IDRIVEP_LS  = (DRV8305_CTRL06_PeakSourCurLS_e)(drvDataNew & (uint16_t)DRV8305_CTRL06_IDRIVEP_LS_BITS);
+      Spi_8305_Vars->Ctrl_Reg_06.IDRIVEN_LS  = (DRV8305_CTRL06_PeakSinkCurLS_e)(drvDataNew & (uint16_t)DRV8305_CTRL06_IDRIVEN_LS_BITS);
+      Spi_8305_Vars->Ctrl_Reg_06.TDRIVEP     = (DRV8305_CTRL06_PeakSinkTime_e)(drvDataNew & (uint16_t)DRV8305_CTRL06_TDRIVEP_BITS);
+      Spi_8305_Vars->Ctrl_Reg_06.CTRL06_RSV1 = (bool)(drvDataNew & (uint16_t)DRV8305_CTRL05_RESERVED1_BITS)?1:0;
+      break;
+
+    case Address_Control_7:
+      Spi_8305_Vars->Ctrl_Reg_07.TVDS        = (DRV8305_CTRL07_VDSDeglitch_e)(drvDataNew & (uint16_t)DRV8305_CTRL07_TVDS_BITS);
+      Spi_8305_Vars->Ctrl_Reg_07.TBLANK      = (DRV8305_CTRL07_VDSBlanking_e)(drvDataNew & (uint16_t)DRV8305_CTRL07_TBLANK_BITS);
+      Spi_8305_Vars->Ctrl_Reg_07.DEAD_TIME   = (DRV8305_CTRL07_DeadTime_e)(drvDataNew & (uint16_t)DRV8305_CTRL07_DEAD_TIME_BITS);
+      Spi_8305_Vars->Ctrl_Reg_07.PWM_MODE    = (DRV8305_CTRL07_PwmMode_e)(drvDataNew & (uint16_t)DRV8305_CTRL07_PWM_MODE_BITS);
+      Spi_8305_Vars->Ctrl_Reg_07.COMM_OPT    = (DRV8305_CTRL07_CommOption_e)(drvDataNew & (uint16_t)DRV8305_CTRL07_COMM_OPT_BITS);
+      Spi_8305_Vars->Ctrl_Reg_07.CTRL07_RSV1 = (bool)(drvDataNew & (uint16_t)DRV8305_CTRL07_RESERVED1_BITS)?1:0;
+      break;
+
+    case Address_Control_9:
+      Spi_8305_Vars->Ctrl_Reg_09.SET_VCPH_UV    = (bool)(drvDataNew & (uint16_t)DRV8305_CTRL09_SET_VCPH_UV_BITS)?1:0;
+      Spi_8305_Vars->Ctrl_Reg_09.CLR_FLTS       = (bool)(drvDataNew & (uint16_t)DRV8305_CTRL09_CLR_FLTS_BITS)?1:0;
+      Spi_8305_Vars->Ctrl_Reg_09.SLEEP          = (bool)(drvDataNew & (uint16_t)DRV8305_CTRL09_SLEEP_BITS)?1:0;
+      Spi_8305_Vars->Ctrl_Reg_09.WD_EN          = (bool)(drvDataNew & (uint16_t)DRV8305_CTRL09_WD_EN_BITS)?1:0;
+      Spi_8305_Vars->Ctrl_Reg_09.DIS_SNS_OCP    = (bool)(drvDataNew & (uint16_t)DRV8305_CTRL09_DIS_SNS_OCP_BITS)?1:0;
+      Spi_8305_Vars->Ctrl_Reg_09.WD_DLY         = (DRV8305_CTRL09_WatchDelay_e)(drvDataNew & (uint16_t)DRV8305_CTRL09_WD_DLY_BITS);
+      Spi_8305_Vars->Ctrl_Reg_09.EN_SNS_CLAMP   = (bool)(drvDataNew & (uint16_t)DRV8305_CTRL09_EN_SNS_CLAMP_BITS)?1:0;
+      Spi_8305_Vars->Ctrl_Reg_09.DIS_GDRV_FAULT = (bool)(drvDataNew & (uint16_t)DRV8305_CTRL09_DIS_GDRV_FAULT_BITS)?1:0;
+      Spi_8305_Vars->Ctrl_Reg_09.DISABLE        = (bool)(drvDataNew & (uint16_t)DRV8305_CTRL09_DISABLE_BITS)?1:0;
+      Spi_8305_Vars->Ctrl_Reg_09.FLIP_OTS       = (bool)(drvDataNew & (uint16_t)DRV8305_CTRL09_FLIP_OTS_BITS)?1:0;
+      break;
+
+    case Address_Control_A:
+      Spi_8305_Vars->Ctrl_Reg_0A.GAIN_CS1   = (DRV8305_CTRL0A_CSGain1_e)(drvDataNew & (uint16_t)DRV8305_CTRL0A_GAIN_CS1_BITS);
+      Spi_8305_Vars->Ctrl_Reg_0A.GAIN_CS2   = (DRV8305_CTRL0A_CSGain2_e)(drvDataNew & (uint16_t)DRV8305_CTRL0A_GAIN_CS2_BITS);
+      Spi_8305_Vars->Ctrl_Reg_0A.GAIN_CS3   = (DRV8305_CTRL0A_CSGain3_e)(drvDataNew & (uint16_t)DRV8305_CTRL0A_GAIN_CS3_BITS);
+      Spi_8305_Vars->Ctrl_Reg_0A.CS_BLANK   = (DRV8305_CTRL0A_CSBlank_e)(drvDataNew & (uint16_t)DRV8305_CTRL0A_CS_BLANK_BITS);
+      Spi_8305_Vars->Ctrl_Reg_0A.DC_CAL_CH1 = (bool)(drvDataNew & (uint16_t)DRV8305_CTRL0A_DC_CAL_CH1_BITS)?1:0;
+      Spi_8305_Vars->Ctrl_Reg_0A.DC_CAL_CH2 = (bool)(drvDataNew & (uint16_t)DRV8305_CTRL0A_DC_CAL_CH2_BITS)?1:0;
+      Spi_8305_Vars->Ctrl_Reg_0A.DC_CAL_CH3 = (bool)(drvDataNew & (uint16_t)DRV8305_CTRL0A_DC_CAL_CH3_BITS)?1:0;
+      break;
+
+    case Address_Control_B:
+      Spi_8305_Vars->Ctrl_Reg_0B.VREG_UV_LEVEL = (DRV8305_CTRL0B_VregUvLevel_e)(drvDataNew & (uint16_t)DRV8305_CTRL0B_VREG_UV_LEVEL_BITS);
+      Spi_8305_Vars->Ctrl_Reg_0B.DIS_PWRGD     = (bool)(drvDataNew & (uint16_t)DRV8305_CTRL0B_DIS_PWRGD_BITS)?1:0;
+      Spi_8305_Vars->Ctrl_Reg_0B.SLP_DLY       = (DRV8305_CTRL0B_SleepDelay_e)(drvDataNew & (uint16_t)DRV8305_CTRL0B_SLP_DLY_BITS);
+      Spi_8305_Vars->Ctrl_Reg_0B.CTRL0B_RSV1   = (bool)(drvDataNew & (uint16_t)DRV8305_CTRL0B_RESERVED1_BITS)?1:0;
+      Spi_8305_Vars->Ctrl_Reg_0B.CTRL0B_RSV2   = (bool)(drvDataNew & (uint16_t)DRV8305_CTRL0B_RESERVED2_BITS)?1:0;
+      Spi_8305_Vars->Ctrl_Reg_0B.CTRL0B_RSV3   = (bool)(drvDataNew & (uint16_t)DRV8305_CTRL0B_RESERVED3_BITS)?1:0;
+      Spi_8305_Vars->Ctrl_Reg_0B.VREF_SCALING  = (DRV8305_CTRL0B_VrefScaling_e)(drvDataNew & (uint16_t)DRV8305_CTRL0B_VREF_SCALING_BITS);
+      Spi_8305_Vars->Ctrl_Reg_0B.CTRL0B_RSV4   = (bool)(drvDataNew & (uint16_t)DRV8305_CTRL0B_RESERVED4_BITS)?1:0;
+      break;
+
+    case Address_Control_C:
+      Spi_8305_Vars->Ctrl_Reg_0C.VDS_MODE    = (DRV8305_CTRL0C_VDSMode_e)(drvDataNew & (uint16_t)DRV8305_CTRL0C_VDS_MODE_BITS);
+      Spi_8305_Vars->Ctrl_Reg_0C.VDS_LEVEL   = (DRV8305_CTRL0C_VDSLevel_e)(drvDataNew & (uint16_t)DRV8305_CTRL0C_VDS_LEVEL_BITS);
+      Spi_8305_Vars->Ctrl_Reg_0C.CTRL0C_RSV1 = (bool)(drvDataNew & (uint16_t)DRV8305_CTRL0C_RESERVED1_BITS)?1:0;
+      Spi_8305_Vars->Ctrl_Reg_0C.CTRL0C_RSV2 = (bool)(drvDataNew & (uint16_t)DRV8305_CTRL0C_RESERVED2_BITS)?1:0;
+      Spi_8305_Vars->Ctrl_Reg_0C.CTRL0C_RSV3 = (bool)(drvDataNew & (uint16_t)DRV8305_CTRL0C_RESERVED3_BITS)?1:0;
+      break;
+
+    default:
+      break;
+  }
+
+  return;
+} // end of DRV8305_setRegData() function
+
+
 void DRV8305_writeData(DRV8305_Handle handle, DRV_SPI_8305_Vars_t *Spi_8305_Vars)
 {
   DRV8305_Address_e drvRegAddr;
@@ -1159,28 +1371,17 @@ void DRV8305_writeData(DRV8305_Handle handle, DRV_SPI_8305_Vars_t *Spi_8305_Vars
   {
     // Write Control Register 5
     drvRegAddr = Address_Control_5;
-    drvDataNew = (Spi_8305_Vars->Ctrl_Reg_05.IDRIVEP_HS) | \
-    		     (Spi_8305_Vars->Ctrl_Reg_05.IDRIVEN_HS) | \
-    		     (Spi_8305_Vars->Ctrl_Reg_05.TDRIVEN)    | \
-    		     (Spi_8305_Vars->Ctrl_Reg_05.CTRL05_RSV1 << 10);
+    drvDataNew = DRV8305_getCtrlData(Spi_8305_Vars,drvRegAddr);
     DRV8305_writeSpi(handle,drvRegAddr,drvDataNew);
 
     // Write Control Register 6
     drvRegAddr = Address_Control_6;
-    drvDataNew = (Spi_8305_Vars->Ctrl_Reg_06.IDRIVEP_LS) | \
-    		     (Spi_8305_Vars->Ctrl_Reg_06.IDRIVEN_LS) | \
-    		     (Spi_8305_Vars->Ctrl_Reg_06.TDRIVEP)    | \
-                 (Spi_8305_Vars->Ctrl_Reg_06.CTRL06_RSV1 << 10);
+    drvDataNew = DRV8305_getCtrlData(Spi_8305_Vars,drvRegAddr);
     DRV8305_writeSpi(handle,drvRegAddr,drvDataNew);
 
     // Write Control Register 7
     drvRegAddr = Address_Control_7;
-    drvDataNew = (Spi_8305_Vars->Ctrl_Reg_07.TVDS)      | \
-    		     (Spi_8305_Vars->Ctrl_Reg_07.TBLANK)    | \
-    		     (Spi_8305_Vars->Ctrl_Reg_07.DEAD_TIME) | \
-    		     (Spi_8305_Vars->Ctrl_Reg_07.PWM_MODE)  | \
-    		     (Spi_8305_Vars->Ctrl_Reg_07.COMM_OPT)  | \
-                 (Spi_8305_Vars->Ctrl_Reg_07.CTRL07_RSV1 << 10);
+    drvDataNew = DRV8305_getCtrlData(Spi_8305_Vars,drvRegAddr);
     DRV8305_writeSpi(handle,drvRegAddr,drvDataNew);
 
     // Write Control Register 8
@@ -1190,48 +1391,22 @@ void DRV8305_writeData(DRV8305_Handle handle, DRV_SPI_8305_Vars_t *Spi_8305_Vars
 
     // Write Control Register 9
     drvRegAddr = Address_Control_9;
-    drvDataNew = (Spi_8305_Vars->Ctrl_Reg_09.SET_VCPH_UV << 0)    | \
-    		     (Spi_8305_Vars->Ctrl_Reg_09.CLR_FLTS << 1)       | \
-    		     (Spi_8305_Vars->Ctrl_Reg_09.SLEEP << 2)          | \
-    		     (Spi_8305_Vars->Ctrl_Reg_09.WD_EN << 3)          | \
-    		     (Spi_8305_Vars->Ctrl_Reg_09.DIS_SNS_OCP << 4)    | \
-                 (Spi_8305_Vars->Ctrl_Reg_09.WD_DLY)              | \
-                 (Spi_8305_Vars->Ctrl_Reg_09.EN_SNS_CLAMP << 7)   | \
-                 (Spi_8305_Vars->Ctrl_Reg_09.DIS_GDRV_FAULT << 8) | \
-                 (Spi_8305_Vars->Ctrl_Reg_09.DISABLE << 9)        | \
-                 (Spi_8305_Vars->Ctrl_Reg_09.FLIP_OTS << 10);
+    drvDataNew = DRV8305_getCtrlData(Spi_8305_Vars,drvRegAddr);
     DRV8305_writeSpi(handle,drvRegAddr,drvDataNew);
 
     // Write Control Register A
     drvRegAddr = Address_Control_A;
-    drvDataNew = (Spi_8305_Vars->Ctrl_Reg_0A.GAIN_CS1)        | \
-    		     (Spi_8305_Vars->Ctrl_Reg_0A.GAIN_CS2)        | \
-    		     (Spi_8305_Vars->Ctrl_Reg_0A.GAIN_CS3)        | \
-    		     (Spi_8305_Vars->Ctrl_Reg_0A.CS_BLANK)        | \
-    		     (Spi_8305_Vars->Ctrl_Reg_0A.DC_CAL_CH1 << 8) | \
-                 (Spi_8305_Vars->Ctrl_Reg_0A.DC_CAL_CH2 << 9) | \
-                 (Spi_8305_Vars->Ctrl_Reg_0A.DC_CAL_CH3 << 10);
+    drvDataNew = DRV8305_getCtrlData(Spi_8305_Vars,drvRegAddr);
     DRV8305_writeSpi(handle,drvRegAddr,drvDataNew);
 
     // Write Control Register B
     drvRegAddr = Address_Control_B;
-    drvDataNew = (Spi_8305_Vars->Ctrl_Reg_0B.VREG_UV_LEVEL)     | \
-    		     (Spi_8305_Vars->Ctrl_Reg_0B.DIS_PWRGD << 2)    | \
-    		     (Spi_8305_Vars->Ctrl_Reg_0B.SLP_DLY)           | \
-    		     (Spi_8305_Vars->Ctrl_Reg_0B.CTRL0B_RSV1 << 5)  | \
-    		     (Spi_8305_Vars->Ctrl_Reg_0B.CTRL0B_RSV2 << 6)  | \
-                 (Spi_8305_Vars->Ctrl_Reg_0B.CTRL0B_RSV3 << 7)  | \
-                 (Spi_8305_Vars->Ctrl_Reg_0B.VREF_SCALING)      | \
-                 (Spi_8305_Vars->Ctrl_Reg_0B.CTRL0B_RSV4 << 10);
+    drvDataNew = DRV8305_getCtrlData(Spi_8305_Vars,drvRegAddr);
     DRV8305_writeSpi(handle,drvRegAddr,drvDataNew);
 
     // Write Control Register C
     drvRegAddr = Address_Control_C;
-    drvDataNew = (Spi_8305_Vars->Ctrl_Reg_0C.VDS_MODE)          | \
-    		     (Spi_8305_Vars->Ctrl_Reg_0C.VDS_LEVEL)         | \
-    		     (Spi_8305_Vars->Ctrl_Reg_0C.CTRL0C_RSV1 << 8)  | \
-    		     (Spi_8305_Vars->Ctrl_Reg_0C.CTRL0C_RSV2 << 9)  | \
-                 (Spi_8305_Vars->Ctrl_Reg_0C.CTRL0C_RSV3 << 10);
+    drvDataNew = DRV8305_getCtrlData(Spi_8305_Vars,drvRegAddr);
     DRV8305_writeSpi(handle,drvRegAddr,drvDataNew);
 
     Spi_8305_Vars->WriteCmd = false;
@@ -1262,88 +1437,37 @@ void DRV8305_readData(DRV8305_Handle handle, DRV_SPI_8305_Vars_t *Spi_8305_Vars)
     // Read Status Register 1
     drvRegAddr = Address_Status_1;
     drvDataNew = DRV8305_readSpi(handle,drvRegAddr);
-    Spi_8305_Vars->Stat_Reg_01.OTW         = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS01_OTW_BITS)?1:0;
-    Spi_8305_Vars->Stat_Reg_01.TEMP_FLAG3  = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS01_TEMP_FLAG3_BITS)?1:0;
-    Spi_8305_Vars->Stat_Reg_01.TEMP_FLAG2  = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS01_TEMP_FLAG2_BITS)?1:0;
-    Spi_8305_Vars->Stat_Reg_01.TEMP_FLAG1  = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS01_TEMP_FLAG1_BITS)?1:0;
-    Spi_8305_Vars->Stat_Reg_01.VCPH_UVFL   = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS01_VCPH_UVFL_BITS)?1:0;
-    Spi_8305_Vars->Stat_Reg_01.VDS_STATUS  = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS01_VDS_STATUS_BITS)?1:0;
-    Spi_8305_Vars->Stat_Reg_01.PVDD_OVFL   = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS01_PVDD_OVFL_BITS)?1:0;
-    Spi_8305_Vars->Stat_Reg_01.PVDD_UVFL   = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS01_PVDD_UVFL_BITS)?1:0;
-    Spi_8305_Vars->Stat_Reg_01.TEMP_FLAG4  = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS01_TEMP_FLAG4_BITS)?1:0;
-    Spi_8305_Vars->Stat_Reg_01.STAT01_RSV1 = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS01_RESERVED1_BITS)?1:0;
-    Spi_8305_Vars->Stat_Reg_01.FAULT       = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS01_FAULT_BITS)?1:0;
+    DRV8305_setRegData(Spi_8305_Vars,drvRegAddr,drvDataNew);
 
     // Read Status Register 2
     drvRegAddr = Address_Status_2;
     drvDataNew = DRV8305_readSpi(handle,drvRegAddr);
-    Spi_8305_Vars->Stat_Reg_02.SNS_A_OCP   = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS02_SNS_A_OCP_BITS)?1:0;
-    Spi_8305_Vars->Stat_Reg_02.SNS_B_OCP   = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS02_SNS_B_OCP_BITS)?1:0;
-    Spi_8305_Vars->Stat_Reg_02.SNS_C_OCP   = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS02_SNS_C_OCP_BITS)?1:0;
-    Spi_8305_Vars->Stat_Reg_02.STAT02_RSV1 = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS02_RESERVED1_BITS)?1:0;
-    Spi_8305_Vars->Stat_Reg_02.STAT02_RSV2 = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS02_RESERVED2_BITS)?1:0;
-    Spi_8305_Vars->Stat_Reg_02.FETLC_VDS   = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS02_FETLC_VDS_BITS)?1:0;
-    Spi_8305_Vars->Stat_Reg_02.FETHC_VDS   = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS02_FETHC_VDS_BITS)?1:0;
-    Spi_8305_Vars->Stat_Reg_02.FETLB_VDS   = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS02_FETLB_VDS_BITS)?1:0;
-    Spi_8305_Vars->Stat_Reg_02.FETHB_VDS   = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS02_FETHB_VDS_BITS)?1:0;
-    Spi_8305_Vars->Stat_Reg_02.FETLA_VDS   = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS02_FETLA_VDS_BITS)?1:0;
-    Spi_8305_Vars->Stat_Reg_02.FETHA_VDS   = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS02_FETHA_VDS_BITS)?1:0;
+    DRV8305_setRegData(Spi_8305_Vars,drvRegAddr,drvDataNew);
 
     // Read Status Register 3
     drvRegAddr = Address_Status_3;
     drvDataNew = DRV8305_readSpi(handle,drvRegAddr);
-    Spi_8305_Vars->Stat_Reg_03.VCPH_OVLO_ABS = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS03_VCPH_OVLO_ABS_BITS)?1:0;
-    Spi_8305_Vars->Stat_Reg_03.VCPH_OVLO     = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS03_VCPH_OVLO_BITS)?1:0;
-    Spi_8305_Vars->Stat_Reg_03.VCPH_UVLO2    = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS03_VCPH_UVLO2_BITS)?1:0;
-    Spi_8305_Vars->Stat_Reg_03.STAT03_RSV1   = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS03_RESERVED1_BITS)?1:0;
-    Spi_8305_Vars->Stat_Reg_03.VCP_LSD_UVLO2 = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS03_VCP_LSD_UVLO2_BITS)?1:0;
-    Spi_8305_Vars->Stat_Reg_03.AVDD_UVLO     = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS03_AVDD_UVLO_BITS)?1:0;
-    Spi_8305_Vars->Stat_Reg_03.VREG_UV       = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS03_VREG_UV_BITS)?1:0;
-    Spi_8305_Vars->Stat_Reg_03.STAT03_RSV2   = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS03_RESERVED2_BITS)?1:0;
-    Spi_8305_Vars->Stat_Reg_03.OTS           = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS03_OTS_BITS)?1:0;
-    Spi_8305_Vars->Stat_Reg_03.WD_FAULT      = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS03_WD_FAULT_BITS)?1:0;
-    Spi_8305_Vars->Stat_Reg_03.PVDD_UVLO2    = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS03_PVDD_UVLO2_BITS)?1:0;
+    DRV8305_setRegData(Spi_8305_Vars,drvRegAddr,drvDataNew);
 
     // Read Status Register 4
     drvRegAddr = Address_Status_4;
     drvDataNew = DRV8305_readSpi(handle,drvRegAddr);
-    Spi_8305_Vars->Stat_Reg_04.STAT04_RSV1 = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS04_RESERVED1_BITS)?1:0;
-    Spi_8305_Vars->Stat_Reg_04.STAT04_RSV2 = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS04_RESERVED2_BITS)?1:0;
-    Spi_8305_Vars->Stat_Reg_04.STAT04_RSV3 = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS04_RESERVED3_BITS)?1:0;
-    Spi_8305_Vars->Stat_Reg_04.STAT04_RSV4 = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS04_RESERVED4_BITS)?1:0;
-    Spi_8305_Vars->Stat_Reg_04.STAT04_RSV5 = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS04_RESERVED5_BITS)?1:0;
-    Spi_8305_Vars->Stat_Reg_04.FETLC_VGS   = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS04_FETLC_VGS_BITS)?1:0;
-    Spi_8305_Vars->Stat_Reg_04.FETHC_VGS   = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS04_FETHC_VGS_BITS)?1:0;
-    Spi_8305_Vars->Stat_Reg_04.FETLB_VGS   = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS04_FETLB_VGS_BITS)?1:0;
-    Spi_8305_Vars->Stat_Reg_04.FETHB_VGS   = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS04_FETHB_VGS_BITS)?1:0;
-    Spi_8305_Vars->Stat_Reg_04.FETLA_VGS   = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS04_FETLA_VGS_BITS)?1:0;
-    Spi_8305_Vars->Stat_Reg_04.FETHA_VGS   = (bool)(drvDataNew & (uint16_t)DRV8305_STATUS04_FETHA_VGS_BITS)?1:0;
+    DRV8305_setRegData(Spi_8305_Vars,drvRegAddr,drvDataNew);
 
     // Read Control Register 5
     drvRegAddr = Address_Control_5;
     drvDataNew = DRV8305_readSpi(handle,drvRegAddr);
-    Spi_8305_Vars->Ctrl_Reg_05.IDRIVEP_HS  = (DRV8305_CTRL05_PeakSourCurHS_e)(drvDataNew & (uint16_t)DRV8305_CTRL05_IDRIVEP_HS_BITS);
-    Spi_8305_Vars->Ctrl_Reg_05.IDRIVEN_HS  = (DRV8305_CTRL05_PeakSinkCurHS_e)(drvDataNew & (uint16_t)DRV8305_CTRL05_IDRIVEN_HS_BITS);
-    Spi_8305_Vars->Ctrl_Reg_05.TDRIVEN     = (DRV8305_CTRL05_PeakSourTime_e)(drvDataNew & (uint16_t)DRV8305_CTRL05_TDRIVEN_BITS);
-    Spi_8305_Vars->Ctrl_Reg_05.CTRL05_RSV1 = (bool)(drvDataNew & (uint16_t)DRV8305_CTRL05_RESERVED1_BITS)?1:0;
+    DRV8305_setRegData(Spi_8305_Vars,drvRegAddr,drvDataNew);
 
     // Read Control Register 6
     drvRegAddr = Address_Control_6;
     drvDataNew = DRV8305_readSpi(handle,drvRegAddr);
-    Spi_8305_Vars->Ctrl_Reg_06.IDRIVEP_LS  = (DRV8305_CTRL06_PeakSourCurLS_e)(drvDataNew & (uint16_t)DRV8305_CTRL06_IDRIVEP_LS_BITS);
-    Spi_8305_Vars->Ctrl_Reg_06.IDRIVEN_LS  = (DRV8305_CTRL06_PeakSinkCurLS_e)(drvDataNew & (uint16_t)DRV8305_CTRL06_IDRIVEN_LS_BITS);
-    Spi_8305_Vars->Ctrl_Reg_06.TDRIVEP     = (DRV8305_CTRL06_PeakSinkTime_e)(drvDataNew & (uint16_t)DRV8305_CTRL06_TDRIVEP_BITS);
-    Spi_8305_Vars->Ctrl_Reg_06.CTRL06_RSV1 = (bool)(drvDataNew & (uint16_t)DRV8305_CTRL05_RESERVED1_BITS)?1:0;
+    DRV8305_setRegData(Spi_8305_Vars,drvRegAddr,drvDataNew);
 
     // Read Control Register 7
     drvRegAddr = Address_Control_7;
     drvDataNew = DRV8305_readSpi(handle,drvRegAddr);
-    Spi_8305_Vars->Ctrl_Reg_07.TVDS        = (DRV8305_CTRL07_VDSDeglitch_e)(drvDataNew & (uint16_t)DRV8305_CTRL07_TVDS_BITS);
-    Spi_8305_Vars->Ctrl_Reg_07.TBLANK      = (DRV8305_CTRL07_VDSBlanking_e)(drvDataNew & (uint16_t)DRV8305_CTRL07_TBLANK_BITS);
-    Spi_8305_Vars->Ctrl_Reg_07.DEAD_TIME   = (DRV8305_CTRL07_DeadTime_e)(drvDataNew & (uint16_t)DRV8305_CTRL07_DEAD_TIME_BITS);
-    Spi_8305_Vars->Ctrl_Reg_07.PWM_MODE    = (DRV8305_CTRL07_PwmMode_e)(drvDataNew & (uint16_t)DRV8305_CTRL07_PWM_MODE_BITS);
-    Spi_8305_Vars->Ctrl_Reg_07.COMM_OPT    = (DRV8305_CTRL07_CommOption_e)(drvDataNew & (uint16_t)DRV8305_CTRL07_COMM_OPT_BITS);
-    Spi_8305_Vars->Ctrl_Reg_07.CTRL07_RSV1 = (bool)(drvDataNew & (uint16_t)DRV8305_CTRL07_RESERVED1_BITS)?1:0;
+    DRV8305_setRegData(Spi_8305_Vars,drvRegAddr,drvDataNew);
 
     // Read Control Register 8
     //drvRegAddr = Address_Control_8;
@@ -1353,48 +1477,22 @@ void DRV8305_readData(DRV8305_Handle handle, DRV_SPI_8305_Vars_t *Spi_8305_Vars)
     // Read Control Register 9
     drvRegAddr = Address_Control_9;
     drvDataNew = DRV8305_readSpi(handle,drvRegAddr);
-    Spi_8305_Vars->Ctrl_Reg_09.SET_VCPH_UV    = (bool)(drvDataNew & (uint16_t)DRV8305_CTRL09_SET_VCPH_UV_BITS)?1:0;
-    Spi_8305_Vars->Ctrl_Reg_09.CLR_FLTS       = (bool)(drvDataNew & (uint16_t)DRV8305_CTRL09_CLR_FLTS_BITS)?1:0;
-    Spi_8305_Vars->Ctrl_Reg_09.SLEEP          = (bool)(drvDataNew & (uint16_t)DRV8305_CTRL09_SLEEP_BITS)?1:0;
-    Spi_8305_Vars->Ctrl_Reg_09.WD_EN          = (bool)(drvDataNew & (uint16_t)DRV8305_CTRL09_WD_EN_BITS)?1:0;
-    Spi_8305_Vars->Ctrl_Reg_09.DIS_SNS_OCP    = (bool)(drvDataNew & (uint16_t)DRV8305_CTRL09_DIS_SNS_OCP_BITS)?1:0;
-    Spi_8305_Vars->Ctrl_Reg_09.WD_DLY         = (DRV8305_CTRL09_WatchDelay_e)(drvDataNew & (uint16_t)DRV8305_CTRL09_WD_DLY_BITS);
-    Spi_8305_Vars->Ctrl_Reg_09.EN_SNS_CLAMP   = (bool)(drvDataNew & (uint16_t)DRV8305_CTRL09_EN_SNS_CLAMP_BITS)?1:0;
-    Spi_8305_Vars->Ctrl_Reg_09.DIS_GDRV_FAULT = (bool)(drvDataNew & (uint16_t)DRV8305_CTRL09_DIS_GDRV_FAULT_BITS)?1:0;
-    Spi_8305_Vars->Ctrl_Reg_09.DISABLE        = (bool)(drvDataNew & (uint16_t)DRV8305_CTRL09_DISABLE_BITS)?1:0;
-    Spi_8305_Vars->Ctrl_Reg_09.FLIP_OTS       = (bool)(drvDataNew & (uint16_t)DRV8305_CTRL09_FLIP_OTS_BITS)?1:0;
+    DRV8305_setRegData(Spi_8305_Vars,drvRegAddr,drvDataNew);
 
     // Read Control Register A
     drvRegAddr = Address_Control_A;
     drvDataNew = DRV8305_readSpi(handle,drvRegAddr);
-    Spi_8305_Vars->Ctrl_Reg_0A.GAIN_CS1   = (DRV8305_CTRL0A_CSGain1_e)(drvDataNew & (uint16_t)DRV8305_CTRL0A_GAIN_CS1_BITS);
-    Spi_8305_Vars->Ctrl_Reg_0A.GAIN_CS2   = (DRV8305_CTRL0A_CSGain2_e)(drvDataNew & (uint16_t)DRV8305_CTRL0A_GAIN_CS2_BITS);
-    Spi_8305_Vars->Ctrl_Reg_0A.GAIN_CS3   = (DRV8305_CTRL0A_CSGain3_e)(drvDataNew & (uint16_t)DRV8305_CTRL0A_GAIN_CS3_BITS);
-    Spi_8305_Vars->Ctrl_Reg_0A.CS_BLANK   = (DRV8305_CTRL0A_CSBlank_e)(drvDataNew & (uint16_t)DRV8305_CTRL0A_CS_BLANK_BITS);
-    Spi_8305_Vars->Ctrl_Reg_0A.DC_CAL_CH1 = (bool)(drvDataNew & (uint16_t)DRV8305_CTRL0A_DC_CAL_CH1_BITS)?1:0;
-    Spi_8305_Vars->Ctrl_Reg_0A.DC_CAL_CH2 = (bool)(drvDataNew & (uint16_t)DRV8305_CTRL0A_DC_CAL_CH2_BITS)?1:0;
-    Spi_8305_Vars->Ctrl_Reg_0A.DC_CAL_CH3 = (bool)(drvDataNew & (uint16_t)DRV8305_CTRL0A_DC_CAL_CH3_BITS)?1:0;
+    DRV8305_setRegData(Spi_8305_Vars,drvRegAddr,drvDataNew);
 
     // Read Control Register B
     drvRegAddr = Address_Control_B;
     drvDataNew = DRV8305_readSpi(handle,drvRegAddr);
-    Spi_8305_Vars->Ctrl_Reg_0B.VREG_UV_LEVEL = (DRV8305_CTRL0B_VregUvLevel_e)(drvDataNew & (uint16_t)DRV8305_CTRL0B_VREG_UV_LEVEL_BITS);
-    Spi_8305_Vars->Ctrl_Reg_0B.DIS_PWRGD     = (bool)(drvDataNew & (uint16_t)DRV8305_CTRL0B_DIS_PWRGD_BITS)?1:0;
-    Spi_8305_Vars->Ctrl_Reg_0B.SLP_DLY       = (DRV8305_CTRL0B_SleepDelay_e)(drvDataNew & (uint16_t)DRV8305_CTRL0B_SLP_DLY_BITS);
-    Spi_8305_Vars->Ctrl_Reg_0B.CTRL0B_RSV1   = (bool)(drvDataNew & (uint16_t)DRV8305_CTRL0B_RESERVED1_BITS)?1:0;
-    Spi_8305_Vars->Ctrl_Reg_0B.CTRL0B_RSV2   = (bool)(drvDataNew & (uint16_t)DRV8305_CTRL0B_RESERVED2_BITS)?1:0;
-    Spi_8305_Vars->Ctrl_Reg_0B.CTRL0B_RSV3   = (bool)(drvDataNew & (uint16_t)DRV8305_CTRL0B_RESERVED3_BITS)?1:0;
-    Spi_8305_Vars->Ctrl_Reg_0B.VREF_SCALING  = (DRV8305_CTRL0B_VrefScaling_e)(drvDataNew & (uint16_t)DRV8305_CTRL0B_VREF_SCALING_BITS);
-    Spi_8305_Vars->Ctrl_Reg_0B.CTRL0B_RSV4   = (bool)(drvDataNew & (uint16_t)DRV8305_CTRL0B_RESERVED4_BITS)?1:0;
+    DRV8305_setRegData(Spi_8305_Vars,drvRegAddr,drvDataNew);
 
     // Read Control Register C
     drvRegAddr = Address_Control_C;
     drvDataNew = DRV8305_readSpi(handle,drvRegAddr);
-    Spi_8305_Vars->Ctrl_Reg_0C.VDS_MODE    = (DRV8305_CTRL0C_VDSMode_e)(drvDataNew & (uint16_t)DRV8305_CTRL0C_VDS_MODE_BITS);
-    Spi_8305_Vars->Ctrl_Reg_0C.VDS_LEVEL   = (DRV8305_CTRL0C_VDSLevel_e)(drvDataNew & (uint16_t)DRV8305_CTRL0C_VDS_LEVEL_BITS);
-    Spi_8305_Vars->Ctrl_Reg_0C.CTRL0C_RSV1 = (bool)(drvDataNew & (uint16_t)DRV8305_CTRL0C_RESERVED1_BITS)?1:0;
-    Spi_8305_Vars->Ctrl_Reg_0C.CTRL0C_RSV2 = (bool)(drvDataNew & (uint16_t)DRV8305_CTRL0C_RESERVED2_BITS)?1:0;
-    Spi_8305_Vars->Ctrl_Reg_0C.CTRL0C_RSV3 = (bool)(drvDataNew & (uint16_t)DRV8305_CTRL0C_RESERVED3_BITS)?1:0;
+    DRV8305_setRegData(Spi_8305_Vars,drvRegAddr,drvDataNew);
 
     Spi_8305_Vars->ReadCmd = false;
   }
@@ -0,0 +1,204 @@
+//! \file   drvspi.c
+//! \brief  Contains the DRV8305 SPI transaction queue (DRVSPI) functions
+//!
+
+
+// **************************************************************************
+// the includes
+
+#include "drvspi.h"
+
+
+// **************************************************************************
+// the defines
+
+
+// **************************************************************************
+// the globals
+
+
+// **************************************************************************
+// the functions
+
+void DRVSPI_init(DRVSPI_Obj *obj,const uint_least16_t pollPeriod_ms,const uint32_t now_ms)
+{
+  uint_least16_t reg;
+
+
+  for(reg=0;reg<DRVSPI_NUM_REGS;reg++)
+    {
+      obj->value[reg] = 0;
+    }
+
+  obj->readMask = 0;
+  obj->writeMask = 0;
+  obj->pollPeriod_ms = pollPeriod_ms;
+  obj->nextPoll = 0;
+  obj->lastPoll_ms = now_ms;
+  obj->flag_busy = false;
+  obj->flag_busyWrite = false;
+  obj->busyReg = 0;
+  obj->start_ms = now_ms;
+  obj->flag_fault = false;
+  obj->numReads = 0;
+  obj->numWrites = 0;
+  obj->numTimeouts = 0;
+  obj->numFaults = 0;
+
+  return;
+} // end of DRVSPI_init() function
+
+
+void DRVSPI_write(DRVSPI_Obj *obj,const uint_least16_t reg,const uint16_t data)
+{
+  const uint_least16_t index = reg & (DRVSPI_NUM_REGS - 1);
+
+
+  // the value is sent when the write starts, so a later write replaces it
+  obj->value[index] = data & DRVSPI_DATA_MASK;
+  obj->writeMask |= (uint16_t)1 << index;
+
+  return;
+} // end of DRVSPI_write() function
+
+
+bool DRVSPI_update(DRVSPI_Obj *obj,const uint_least16_t reg,const uint16_t data)
+{
+  if((data & DRVSPI_DATA_MASK) == obj->value[reg & (DRVSPI_NUM_REGS - 1)])
+    {
+      return(false);
+    }
+
+  DRVSPI_write(obj,reg,data);
+
+  return(true);
+} // end of DRVSPI_update() function
+
+
+bool DRVSPI_start(DRVSPI_Obj *obj,const uint32_t now_ms,uint16_t *pFrame)
+{
+  uint_least16_t reg;
+
+
+  if(obj->flag_busy)
+    {
+      return(false);
+    }
+
+  // queue the next status register when it is due
+  if((obj->pollPeriod_ms != 0) && ((now_ms - obj->lastPoll_ms) >= obj->pollPeriod_ms))
+    {
+      DRVSPI_read(obj,DRVSPI_REG_STATUS_1 + obj->nextPoll);
+
+      obj->nextPoll = (obj->nextPoll + 1) % DRVSPI_NUM_STATUS_REGS;
+      obj->lastPoll_ms = now_ms;
+    }
+
+  if(obj->writeMask != 0)
+    {
+      for(reg=0;(obj->writeMask & ((uint16_t)1 << reg)) == 0;reg++)
+        {
+        }
+
+      obj->writeMask &= ~((uint16_t)1 << reg);
+      obj->flag_busyWrite = true;
+      *pFrame = (uint16_t)(reg << DRVSPI_ADDR_SHIFT) | obj->value[reg];
+    }
+  else if(obj->readMask != 0)
+    {
+      for(reg=0;(obj->readMask & ((uint16_t)1 << reg)) == 0;reg++)
+        {
+        }
+
+      obj->readMask &= ~((uint16_t)1 << reg);
+      obj->flag_busyWrite = false;
+      *pFrame = DRVSPI_READ_BIT | (uint16_t)(reg << DRVSPI_ADDR_SHIFT);
+    }
+  else
+    {
+      return(false);
+    }
+
+  obj->busyReg = reg;
+  obj->start_ms = now_ms;
+  obj->flag_busy = true;
+
+  return(true);
+} // end of DRVSPI_start() function
+
+
+bool DRVSPI_finish(DRVSPI_Obj *obj,const uint16_t reply,uint_least16_t *pReg)
+{
+  const uint_least16_t reg = obj->busyReg;
+
+
+  if(!obj->flag_busy)
+    {
+      return(false);
+    }
+
+  obj->flag_busy = false;
+
+  if(obj->flag_busyWrite)
+    {
+      // the DRV8305 clears the fault clear bit itself, so the next one differs again
+      if(reg == DRVSPI_REG_CONTROL_9)
+        {
+          obj->value[reg] &= ~DRVSPI_CTRL09_CLR_FLTS;
+        }
+
+      obj->numWrites++;
+
+      return(false);
+    }
+
+  // a write queued meanwhile keeps its value until it is sent
+  if((obj->writeMask & ((uint16_t)1 << reg)) == 0)
+    {
+      obj->value[reg] = reply & DRVSPI_DATA_MASK;
+    }
+
+  obj->numReads++;
+
+  if(reg == DRVSPI_REG_STATUS_1)
+    {
+      const bool flag_fault = (reply & DRVSPI_STATUS01_FAULT) != 0;
+
+      if(flag_fault && !obj->flag_fault)
+        {
+          obj->numFaults++;
+        }
+
+      obj->flag_fault = flag_fault;
+    }
+
+  *pReg = reg;
+
+  return(true);
+} // end of DRVSPI_finish() function
+
+
+bool DRVSPI_checkTimeout(DRVSPI_Obj *obj,const uint32_t now_ms)
+{
+  if(!obj->flag_busy || ((now_ms - obj->start_ms) < DRVSPI_TIMEOUT_ms))
+    {
+      return(false);
+    }
+
+  obj->flag_busy = false;
+  obj->numTimeouts++;
+
+  if(obj->flag_busyWrite)
+    {
+      obj->writeMask |= (uint16_t)1 << obj->busyReg;
+    }
+  else
+    {
+      obj->readMask |= (uint16_t)1 << obj->busyReg;
+    }
+
+  return(true);
+} // end of DRVSPI_checkTimeout() function
+
+
+// end of file
@@ -0,0 +1,231 @@
+#ifndef _DRVSPI_H_
+#define _DRVSPI_H_
+
+//! \file   drvspi.h
+//! \brief  Contains the public interface to the DRV8305 SPI transaction
+//!         queue (DRVSPI)
+//!
+//!         The blocking DRV8305_readData() and DRV8305_writeData() spin on
+//!         the SPI receive FIFO for every register.  The queue instead keeps
+//!         one transfer in flight: DRVSPI_start() hands out the next 16 bit
+//!         frame to write to the SPI transmit FIFO, and DRVSPI_finish() takes
+//!         the word the receive FIFO returns for it on a later background
+//!         loop pass, so no pass waits on the DRV8305.
+//!
+//!         The queue holds a bit per register to read and to write and the
+//!         last value read from or written to each register.  Writes go out
+//!         ahead of reads, lowest register first.  DRVSPI_update() only queues
+//!         a write when the value differs from the last one, so the
+//!         configuration is only sent when it changes.  The four status
+//!         registers are read round robin, one every pollPeriod_ms, and a
+//!         transfer that gets no reply within DRVSPI_TIMEOUT_ms is queued
+//!         again.
+//!
+//!         The DRV8305 frame is a read bit, a 4 bit address and 11 data bits.
+//!
+//!         The module has no device specific includes and builds on the host,
+//!         where Code/tools/drvspitest checks it against a scripted SPI stub.
+
+
+// **************************************************************************
+// the includes
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+//!
+//!
+//! \defgroup DRVSPI DRVSPI
+//!
+//@{
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+// **************************************************************************
+// the defines
+
+//! \brief Defines the number of register addresses
+//!
+#define DRVSPI_NUM_REGS             (16)
+
+//! \brief Defines the frame read bit
+//!
+#define DRVSPI_READ_BIT             (0x8000)
+
+//! \brief Defines the frame address shift
+//!
+#define DRVSPI_ADDR_SHIFT           (11)
+
+//! \brief Defines the frame data mask
+//!
+#define DRVSPI_DATA_MASK            (0x07FF)
+
+//! \brief Defines the first status register
+//!
+#define DRVSPI_REG_STATUS_1         (0x1)
+
+//! \brief Defines the number of status registers
+//!
+#define DRVSPI_NUM_STATUS_REGS      (4)
+
+//! \brief Defines the register that holds the fault clear bit
+//!
+#define DRVSPI_REG_CONTROL_9        (0x9)
+
+//! \brief Defines the status registers, bit per address
+//!
+#define DRVSPI_STATUS_REGS          (0x001E)
+
+//! \brief Defines the control registers, bit per address, without the reserved register 8
+//!
+#define DRVSPI_CONTROL_REGS         (0x1EE0)
+
+//! \brief Defines the status register 1 fault bit
+//!
+#define DRVSPI_STATUS01_FAULT       (1 << 10)
+
+//! \brief Defines the control register 9 fault clear bit, the DRV8305 clears it
+//!        once the faults are cleared
+//!
+#define DRVSPI_CTRL09_CLR_FLTS      (1 << 1)
+
+//! \brief Defines the default time between status register reads, ms
+//!
+#define DRVSPI_DEFAULT_POLL_PERIOD_ms  (10)
+
+//! \brief Defines the time after which a transfer without reply is queued again, ms
+//!
+//!        elapsedMillis ticks once per ms, so this waits at least 1 ms
+//!
+#define DRVSPI_TIMEOUT_ms           (2)
+
+
+// **************************************************************************
+// the typedefs
+
+//! \brief Defines the transaction queue
+//!
+//!        pollPeriod_ms may be changed from the watch window, 0 stops the
+//!        status reads
+//!
+typedef struct _DRVSPI_Obj_
+{
+  uint16_t        value[DRVSPI_NUM_REGS];    //!< the last value read from or written to each register
+  uint16_t        readMask;                  //!< the registers waiting to be read, bit per address
+  uint16_t        writeMask;                 //!< the registers waiting to be written, bit per address
+  uint_least16_t  pollPeriod_ms;             //!< the time between status register reads, ms
+  uint_least16_t  nextPoll;                  //!< the status register read next, 0 for the first
+  uint32_t        lastPoll_ms;               //!< the time of the last status register read, ms
+  bool            flag_busy;                 //!< a transfer waits for its reply
+  bool            flag_busyWrite;            //!< the transfer in flight is a write
+  uint_least16_t  busyReg;                   //!< the register of the transfer in flight
+  uint32_t        start_ms;                  //!< the time the transfer in flight was started, ms
+  bool            flag_fault;                //!< the last status register 1 read had the fault bit set
+  uint32_t        numReads;                  //!< the number of reads completed
+  uint32_t        numWrites;                 //!< the number of writes completed
+  uint32_t        numTimeouts;               //!< the number of transfers without reply
+  uint32_t        numFaults;                 //!< the number of times the fault bit was seen set after clear
+} DRVSPI_Obj;
+
+
+// **************************************************************************
+// the function prototypes
+
+//! \brief     Initializes the queue empty, with all values 0
+//! \param[in] obj            A pointer to the queue
+//! \param[in] pollPeriod_ms  The time between status register reads, ms
+//! \param[in] now_ms         The current time, ms
+extern void DRVSPI_init(DRVSPI_Obj *obj,const uint_least16_t pollPeriod_ms,const uint32_t now_ms);
+
+
+//! \brief     Sets the known value of a register without writing it, after a blocking read
+//! \param[in] obj   A pointer to the queue
+//! \param[in] reg   The register address
+//! \param[in] data  The register value
+static inline void DRVSPI_setValue(DRVSPI_Obj *obj,const uint_least16_t reg,const uint16_t data)
+{
+  obj->value[reg & (DRVSPI_NUM_REGS - 1)] = data & DRVSPI_DATA_MASK;
+
+  return;
+} // end of DRVSPI_setValue() function
+
+
+//! \brief     Gets the last value read from or written to a register
+//! \param[in] obj  A pointer to the queue
+//! \param[in] reg  The register address
+//! \return    The register value
+static inline uint16_t DRVSPI_getValue(DRVSPI_Obj *obj,const uint_least16_t reg)
+{
+  return(obj->value[reg & (DRVSPI_NUM_REGS - 1)]);
+} // end of DRVSPI_getValue() function
+
+
+//! \brief     Determines if a transfer waits for its reply
+//! \param[in] obj  A pointer to the queue
+//! \return    True while a transfer is in flight
+static inline bool DRVSPI_isBusy(DRVSPI_Obj *obj)
+{
+  return(obj->flag_busy);
+} // end of DRVSPI_isBusy() function
+
+
+//! \brief     Queues a read of a register
+//! \param[in] obj  A pointer to the queue
+//! \param[in] reg  The register address
+static inline void DRVSPI_read(DRVSPI_Obj *obj,const uint_least16_t reg)
+{
+  obj->readMask |= (uint16_t)1 << (reg & (DRVSPI_NUM_REGS - 1));
+
+  return;
+} // end of DRVSPI_read() function
+
+
+//! \brief     Queues a write of a register
+//! \param[in] obj   A pointer to the queue
+//! \param[in] reg   The register address
+//! \param[in] data  The register value
+extern void DRVSPI_write(DRVSPI_Obj *obj,const uint_least16_t reg,const uint16_t data);
+
+
+//! \brief     Queues a write of a register if the value differs from the last one
+//! \param[in] obj   A pointer to the queue
+//! \param[in] reg   The register address
+//! \param[in] data  The register value
+//! \return    True if the write was queued
+extern bool DRVSPI_update(DRVSPI_Obj *obj,const uint_least16_t reg,const uint16_t data);
+
+
+//! \brief      Gets the next frame to send, if no transfer is in flight
+//! \param[in]  obj     A pointer to the queue
+//! \param[in]  now_ms  The current time, ms
+//! \param[out] pFrame  The frame to write to the SPI transmit FIFO
+//! \return     True if a transfer was started
+extern bool DRVSPI_start(DRVSPI_Obj *obj,const uint32_t now_ms,uint16_t *pFrame);
+
+
+//! \brief      Ends the transfer in flight with the word the SPI returned for it
+//! \param[in]  obj    A pointer to the queue
+//! \param[in]  reply  The word read from the SPI receive FIFO
+//! \param[out] pReg   The register read
+//! \return     True if a read was completed, false for a write or with no transfer in flight
+extern bool DRVSPI_finish(DRVSPI_Obj *obj,const uint16_t reply,uint_least16_t *pReg);
+
+
+//! \brief     Queues the transfer in flight again if it has had no reply for DRVSPI_TIMEOUT_ms
+//! \param[in] obj     A pointer to the queue
+//! \param[in] now_ms  The current time, ms
+//! \return    True if the transfer timed out
+extern bool DRVSPI_checkTimeout(DRVSPI_Obj *obj,const uint32_t now_ms);
+
+
+#ifdef __cplusplus
+}
+#endif // extern "C"
+
+//@} // ingroup
+#endif // end of _DRVSPI_H_ definition
@@ -0,0 +1,413 @@
+//! \file   excite.c
+//! \brief  Contains the Iq excitation generator (EXCITE) functions
+//!
+
+
+// **************************************************************************
+// the includes
+
+#include <math.h>
+
+#include "excite.h"
+
+
+#ifdef FLASH
+#pragma CODE_SECTION(EXCITE_run,"ramfuncs");
+#pragma CODE_SECTION(EXCITE_getSine,"ramfuncs");
+#endif
+
+
+// **************************************************************************
+// the defines
+
+//! \brief Defines the PRBS shift register seed, any nonzero 15 bit value
+//!
+#define EXCITE_PRBS_SEED            (0x7FFF)
+
+
+// **************************************************************************
+// the globals
+
+//! \brief Defines one sine cycle in Q15, the last entry repeats the first for the interpolation
+//!
+static const int16_t EXCITE_sineTable[EXCITE_TABLE_LENGTH + 1] =
+{
+       0,    804,   1608,   2410,   3212,   4011,   4808,   5602,
+    6393,   7179,   7962,   8739,   9512,  10278,  11039,  11793,
+   12539,  13279,  14010,  14732,  15446,  16151,  16846,  17530,
+   18204,  18868,  19519,  20159,  20787,  21403,  22005,  22594,
+   23170,  23731,  24279,  24811,  25329,  25832,  26319,  26790,
+   27245,  27683,  28105,  28510,  28898,  29268,  29621,  29956,
+   30273,  30571,  30852,  31113,  31356,  31580,  31785,  31971,
+   32137,  32285,  32412,  32521,  32609,  32678,  32728,  32757,
+   32767,  32757,  32728,  32678,  32609,  32521,  32412,  32285,
+   32137,  31971,  31785,  31580,  31356,  31113,  30852,  30571,
+   30273,  29956,  29621,  29268,  28898,  28510,  28105,  27683,
+   27245,  26790,  26319,  25832,  25329,  24811,  24279,  23731,
+   23170,  22594,  22005,  21403,  20787,  20159,  19519,  18868,
+   18204,  17530,  16846,  16151,  15446,  14732,  14010,  13279,
+   12539,  11793,  11039,  10278,   9512,   8739,   7962,   7179,
+    6393,   5602,   4808,   4011,   3212,   2410,   1608,    804,
+       0,   -804,  -1608,  -2410,  -3212,  -4011,  -4808,  -5602,
+   -6393,  -7179,  -7962,  -8739,  -9512, -10278, -11039, -11793,
+  -12539, -13279, -14010, -14732, -15446, -16151, -16846, -17530,
+  -18204, -18868, -19519, -20159, -20787, -21403, -22005, -22594,
+  -23170, -23731, -24279, -24811, -25329, -25832, -26319, -26790,
+  -27245, -27683, -28105, -28510, -28898, -29268, -29621, -29956,
+  -30273, -30571, -30852, -31113, -31356, -31580, -31785, -31971,
+  -32137, -32285, -32412, -32521, -32609, -32678, -32728, -32757,
+  -32767, -32757, -32728, -32678, -32609, -32521, -32412, -32285,
+  -32137, -31971, -31785, -31580, -31356, -31113, -30852, -30571,
+  -30273, -29956, -29621, -29268, -28898, -28510, -28105, -27683,
+  -27245, -26790, -26319, -25832, -25329, -24811, -24279, -23731,
+  -23170, -22594, -22005, -21403, -20787, -20159, -19519, -18868,
+  -18204, -17530, -16846, -16151, -15446, -14732, -14010, -13279,
+  -12539, -11793, -11039, -10278,  -9512,  -8739,  -7962,  -7179,
+   -6393,  -5602,  -4808,  -4011,  -3212,  -2410,  -1608,   -804,
+       0
+};
+
+
+// **************************************************************************
+// the functions
+
+//! \brief Converts a frequency to a phase increment per ISR tick, 2^32 per cycle
+static uint32_t EXCITE_getPhaseInc(const EXCITE_Obj *obj,const int32_t freq_mHz)
+{
+  return((uint32_t)(((uint64_t)freq_mHz << 32) / ((uint64_t)obj->isrFreq_Hz * 1000)));
+} // end of EXCITE_getPhaseInc() function
+
+
+//! \brief Scales a Q15 value by an IQ24 amplitude
+static inline int32_t EXCITE_scale(const int32_t amplitude,const int32_t q15)
+{
+  return((int32_t)(((int64_t)amplitude * q15) >> 15));
+} // end of EXCITE_scale() function
+
+
+void EXCITE_init(EXCITE_Obj *obj,const uint32_t isrFreq_Hz,const int32_t maxAmplitude_mA)
+{
+  uint_least8_t cnt;
+
+
+  obj->mode = EXCITE_Mode_Chirp;
+  obj->amplitude_mA = 5000;
+  obj->startFreq_mHz = 400;
+  obj->endFreq_mHz = 1000;
+  obj->duration_ms = 2000;
+  obj->logDecimation = 0;
+
+  obj->isrFreq_Hz = isrFreq_Hz;
+  obj->maxAmplitude_mA = maxAmplitude_mA;
+
+  obj->numTicks = 0;
+  obj->amplitude = 0;
+  obj->sweepQuot = 0;
+  obj->sweepRem = 0;
+  obj->bitTicks = 1;
+
+  for(cnt=0;cnt<EXCITE_NUM_TONES;cnt++)
+    {
+      obj->phaseInc[cnt] = 0;
+      obj->phase[cnt] = 0;
+    }
+
+  obj->state = EXCITE_State_Idle;
+  obj->tick = 0;
+  obj->sweepAcc = 0;
+  obj->bitCounter = 0;
+  obj->lfsr = EXCITE_PRBS_SEED;
+  obj->value = 0;
+  obj->numRuns = 0;
+
+  return;
+} // end of EXCITE_init() function
+
+
+bool EXCITE_setParam(EXCITE_Obj *obj,const EXCITE_Param_e param,const int32_t value)
+{
+  const int32_t maxFreq_mHz = (int32_t)(obj->isrFreq_Hz * 500);
+
+
+  if(param == EXCITE_Param_Run)
+    {
+      if(value == 0)
+        {
+          EXCITE_stop(obj);
+
+          return(true);
+        }
+
+      return((value == 1) && EXCITE_start(obj));
+    }
+
+  if((obj->state == EXCITE_State_Armed) || (obj->state == EXCITE_State_Running))
+    {
+      return(false);
+    }
+
+  switch(param)
+    {
+      case EXCITE_Param_Mode:
+        if((value < 0) || (value >= EXCITE_NumModes))
+          {
+            return(false);
+          }
+        obj->mode = (EXCITE_Mode_e)value;
+        break;
+
+      case EXCITE_Param_Amplitude_mA:
+        if((value < -obj->maxAmplitude_mA) || (value > obj->maxAmplitude_mA))
+          {
+            return(false);
+          }
+        obj->amplitude_mA = value;
+        break;
+
+      case EXCITE_Param_StartFreq_mHz:
+      case EXCITE_Param_EndFreq_mHz:
+        // below the Nyquist frequency of the ISR
+        if((value <= 0) || (value > maxFreq_mHz))
+          {
+            return(false);
+          }
+        if(param == EXCITE_Param_StartFreq_mHz)
+          {
+            obj->startFreq_mHz = value;
+          }
+        else
+          {
+            obj->endFreq_mHz = value;
+          }
+        break;
+
+      case EXCITE_Param_Duration_ms:
+        if((value <= 0) || (value > EXCITE_MAX_VALUE))
+          {
+            return(false);
+          }
+        obj->duration_ms = value;
+        break;
+
+      case EXCITE_Param_LogDecimation:
+        if((value < 0) || (value > 0xFFFF))
+          {
+            return(false);
+          }
+        obj->logDecimation = (uint_least16_t)value;
+        break;
+
+      default:
+        return(false);
+    }
+
+  return(true);
+} // end of EXCITE_setParam() function
+
+
+bool EXCITE_start(EXCITE_Obj *obj)
+{
+  const int32_t amplitude = (int32_t)(((int64_t)obj->amplitude_mA << 24) / 1000);
+  uint_least8_t cnt;
+
+
+  if((obj->state == EXCITE_State_Armed) || (obj->state == EXCITE_State_Running) ||
+     (obj->mode == EXCITE_Mode_Off))
+    {
+      return(false);
+    }
+
+  obj->numTicks = (uint32_t)(((uint64_t)obj->duration_ms * obj->isrFreq_Hz + 500) / 1000);
+  if(obj->numTicks == 0)
+    {
+      obj->numTicks = 1;
+    }
+
+  for(cnt=0;cnt<EXCITE_NUM_TONES;cnt++)
+    {
+      obj->phaseInc[cnt] = 0;
+      obj->phase[cnt] = 0;
+    }
+
+  obj->amplitude = amplitude;
+  obj->sweepQuot = 0;
+  obj->sweepRem = 0;
+
+  switch(obj->mode)
+    {
+      case EXCITE_Mode_Chirp:
+        {
+          // both increments are below 2^31, so the difference fits
+          const int32_t delta = (int32_t)(EXCITE_getPhaseInc(obj,obj->endFreq_mHz) -
+                                          EXCITE_getPhaseInc(obj,obj->startFreq_mHz));
+
+          obj->phaseInc[0] = EXCITE_getPhaseInc(obj,obj->startFreq_mHz);
+          obj->sweepQuot = delta / (int32_t)obj->numTicks;
+          obj->sweepRem = delta % (int32_t)obj->numTicks;
+        }
+        break;
+
+      case EXCITE_Mode_Prbs:
+        // 2.5 bits per period of the top frequency
+        obj->bitTicks = (uint32_t)(((uint64_t)obj->isrFreq_Hz * 2000 + (uint64_t)obj->endFreq_mHz * 5 / 2) /
+                                   ((uint64_t)obj->endFreq_mHz * 5));
+        if(obj->bitTicks == 0)
+          {
+            obj->bitTicks = 1;
+          }
+        break;
+
+      case EXCITE_Mode_Multisine:
+        {
+          const double ratio = (double)obj->endFreq_mHz / (double)obj->startFreq_mHz;
+          uint32_t harmonic = 0;
+
+          if(obj->endFreq_mHz <= obj->startFreq_mHz)
+            {
+              return(false);
+            }
+
+          for(cnt=0;cnt<EXCITE_NUM_TONES;cnt++)
+            {
+              uint32_t next = (uint32_t)(pow(ratio,(double)cnt / (double)(EXCITE_NUM_TONES - 1)) + 0.5);
+              // Schroeder phase -pi k (k - 1) / N, in cycles of 2^32
+              uint32_t k = (uint32_t)cnt + 1;
+              uint32_t fraction = (k * (k - 1)) % (2 * EXCITE_NUM_TONES);
+
+              // distinct harmonics even when the range is narrow
+              harmonic = (next > harmonic) ? next : (harmonic + 1);
+              if((int64_t)harmonic * obj->startFreq_mHz > (int64_t)obj->isrFreq_Hz * 500)
+                {
+                  return(false);
+                }
+
+              obj->phaseInc[cnt] = EXCITE_getPhaseInc(obj,(int32_t)harmonic * obj->startFreq_mHz);
+              obj->phase[cnt] = (uint32_t)0 - (uint32_t)(((uint64_t)fraction << 32) / (2 * EXCITE_NUM_TONES));
+            }
+
+          obj->amplitude = amplitude / EXCITE_NUM_TONES;
+        }
+        break;
+
+      default:
+        break;
+    }
+
+  obj->tick = 0;
+  obj->sweepAcc = 0;
+  obj->bitCounter = 0;
+  obj->lfsr = EXCITE_PRBS_SEED;
+  obj->value = 0;
+
+  // publish the run once it is complete
+  obj->state = EXCITE_State_Armed;
+
+  return(true);
+} // end of EXCITE_start() function
+
+
+void EXCITE_stop(EXCITE_Obj *obj)
+{
+  obj->state = EXCITE_State_Idle;
+
+  return;
+} // end of EXCITE_stop() function
+
+
+int32_t EXCITE_getSine(const uint32_t phase)
+{
+  const uint_least16_t index = (uint_least16_t)(phase >> 24);
+  const int32_t fraction = (int32_t)((phase >> 8) & 0xFFFF);
+  const int32_t s0 = EXCITE_sineTable[index];
+  const int32_t s1 = EXCITE_sineTable[index + 1];
+
+  return(s0 + (((s1 - s0) * fraction) >> 16));
+} // end of EXCITE_getSine() function
+
+
+int32_t EXCITE_run(EXCITE_Obj *obj)
+{
+  int32_t value = 0;
+  uint_least8_t cnt;
+
+
+  if(obj->state == EXCITE_State_Armed)
+    {
+      obj->state = EXCITE_State_Running;
+    }
+  else if(obj->state != EXCITE_State_Running)
+    {
+      obj->value = 0;
+
+      return(0);
+    }
+
+  switch(obj->mode)
+    {
+      case EXCITE_Mode_Step:
+        value = obj->amplitude;
+        break;
+
+      case EXCITE_Mode_Chirp:
+        value = EXCITE_scale(obj->amplitude,EXCITE_getSine(obj->phase[0]));
+        obj->phase[0] += obj->phaseInc[0];
+
+        // sweep the increment, carrying the remainder so the end is exact
+        obj->phaseInc[0] += (uint32_t)obj->sweepQuot;
+        obj->sweepAcc += obj->sweepRem;
+        if(obj->sweepAcc >= (int32_t)obj->numTicks)
+          {
+            obj->sweepAcc -= (int32_t)obj->numTicks;
+            obj->phaseInc[0]++;
+          }
+        else if(obj->sweepAcc <= -(int32_t)obj->numTicks)
+          {
+            obj->sweepAcc += (int32_t)obj->numTicks;
+            obj->phaseInc[0]--;
+          }
+        break;
+
+      case EXCITE_Mode_Prbs:
+        if(obj->bitCounter == 0)
+          {
+            // x^15 + x^14 + 1
+            uint_least16_t bit = ((obj->lfsr >> 14) ^ (obj->lfsr >> 13)) & 1;
+
+            obj->lfsr = ((obj->lfsr << 1) | bit) & 0x7FFF;
+            obj->bitCounter = obj->bitTicks;
+          }
+        obj->bitCounter--;
+        value = (obj->lfsr & 1) ? obj->amplitude : -obj->amplitude;
+        break;
+
+      case EXCITE_Mode_Multisine:
+        {
+          int32_t sum = 0;
+
+          for(cnt=0;cnt<EXCITE_NUM_TONES;cnt++)
+            {
+              sum += EXCITE_getSine(obj->phase[cnt]);
+              obj->phase[cnt] += obj->phaseInc[cnt];
+            }
+
+          value = EXCITE_scale(obj->amplitude,sum);
+        }
+        break;
+
+      default:
+        break;
+    }
+
+  if(++obj->tick >= obj->numTicks)
+    {
+      obj->state = EXCITE_State_Done;
+      obj->numRuns++;
+    }
+
+  obj->value = value;
+
+  return(value);
+} // end of EXCITE_run() function
+
+
+// end of file
@@ -0,0 +1,206 @@
+#ifndef _EXCITE_H_
+#define _EXCITE_H_
+
+//! \file   excite.h
+//! \brief  Contains the public interface to the Iq excitation generator (EXCITE)
+//!         for system identification runs
+//!
+//!         mainISR calls EXCITE_run() once per tick and adds the result to
+//!         the commanded Iq reference.  The background loop changes the
+//!         settings with EXCITE_setParam(), which refuses them while a run is
+//!         in progress, and EXCITE_start() does the divisions up front, so
+//!         every tick of a run costs the same few integer operations and no
+//!         floating point:
+//!
+//!           Step       the amplitude for the whole duration
+//!           Chirp      a sine swept linearly from startFreq to endFreq
+//!           Prbs       +-amplitude from a 15 bit maximum length sequence,
+//!                      clocked at 2.5 * endFreq, so the spectrum is flat
+//!                      to about endFreq
+//!           Multisine  EXCITE_NUM_TONES sines at harmonics of startFreq,
+//!                      log spaced up to endFreq, with Schroeder phases and
+//!                      amplitude / EXCITE_NUM_TONES each, so the sum never
+//!                      exceeds the amplitude
+//!
+//!         The sines come from a 32 bit phase accumulator, 2^32 per cycle,
+//!         and a 256 entry Q15 table with linear interpolation, which is
+//!         within 2e-4 of sin().  The chirp steps its phase increment by a
+//!         quotient and a remainder, so the sweep ends exactly on endFreq.
+//!
+//!         Over the command link the settings travel in Excite frames, see
+//!         cmdlink.h, with an EXCITE_Param_e in the top payload byte and the
+//!         value in the low 24 bits.
+//!
+//!         The module has no device specific includes and builds on the host,
+//!         where Code/tools/hostsim runs it against the PMSM model.
+
+
+// **************************************************************************
+// the includes
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+//!
+//!
+//! \defgroup EXCITE EXCITE
+//!
+//@{
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+// **************************************************************************
+// the defines
+
+//! \brief Defines the number of multisine tones
+//!
+#define EXCITE_NUM_TONES            (8)
+
+//! \brief Defines the number of sine table intervals, the table has one more entry
+//!
+#define EXCITE_TABLE_LENGTH         (256)
+
+//! \brief Defines the largest value a setting can carry in a frame
+//!
+#define EXCITE_MAX_VALUE            ((int32_t)0x7FFFFF)
+
+
+// **************************************************************************
+// the typedefs
+
+//! \brief Enumeration for the excitation modes
+//!
+typedef enum
+{
+  EXCITE_Mode_Off=0,             //!< no excitation
+  EXCITE_Mode_Step,              //!< the amplitude for the whole duration
+  EXCITE_Mode_Chirp,             //!< a linear sine sweep from startFreq to endFreq
+  EXCITE_Mode_Prbs,              //!< a pseudo random binary sequence up to endFreq
+  EXCITE_Mode_Multisine,         //!< log spaced harmonics of startFreq up to endFreq
+  EXCITE_NumModes                //!< the number of modes
+} EXCITE_Mode_e;
+
+
+//! \brief Enumeration for the settings, the Excite frame parameter ids
+//!
+typedef enum
+{
+  EXCITE_Param_Mode=0,           //!< an EXCITE_Mode_e
+  EXCITE_Param_Amplitude_mA,     //!< the peak, negative flips a step
+  EXCITE_Param_StartFreq_mHz,    //!< the chirp start and the multisine fundamental
+  EXCITE_Param_EndFreq_mHz,      //!< the chirp end and the top of the PRBS and multisine
+  EXCITE_Param_Duration_ms,      //!< the run length
+  EXCITE_Param_LogDecimation,    //!< the telemetry decimation during a run, ISR ticks, 0 leaves it alone
+  EXCITE_Param_Run,              //!< 1 starts a run with the current settings, 0 stops it
+  EXCITE_NumParams               //!< the number of settings
+} EXCITE_Param_e;
+
+
+//! \brief Enumeration for the generator states
+//!
+typedef enum
+{
+  EXCITE_State_Idle=0,           //!< the settings may change
+  EXCITE_State_Armed,            //!< started, the next EXCITE_run() is the first tick
+  EXCITE_State_Running,          //!< mainISR is generating
+  EXCITE_State_Done              //!< the run is over, waiting for EXCITE_stop()
+} EXCITE_State_e;
+
+
+//! \brief Defines the excitation generator
+//!
+//!        The settings and the precomputed run are written by the
+//!        background loop only while the state is Idle or Done, the run
+//!        fields by mainISR only while it is Armed or Running
+//!
+typedef struct _EXCITE_Obj_
+{
+  // the settings
+  EXCITE_Mode_e   mode;                          //!< the mode
+  int32_t         amplitude_mA;                  //!< the peak
+  int32_t         startFreq_mHz;                 //!< the start or fundamental frequency
+  int32_t         endFreq_mHz;                   //!< the end or top frequency
+  int32_t         duration_ms;                   //!< the run length
+  uint_least16_t  logDecimation;                 //!< the telemetry decimation during a run
+
+  // the limits, from EXCITE_init()
+  uint32_t        isrFreq_Hz;                    //!< the EXCITE_run() rate
+  int32_t         maxAmplitude_mA;               //!< the largest accepted amplitude
+
+  // precomputed by EXCITE_start()
+  uint32_t        numTicks;                      //!< the run length, ISR ticks
+  int32_t         amplitude;                     //!< the peak of one step, bit or tone, IQ24 A
+  uint32_t        phaseInc[EXCITE_NUM_TONES];    //!< the phase advance per tick, 2^32 per cycle, swept by the chirp
+  int32_t         sweepQuot;                     //!< the chirp increment change per tick
+  int32_t         sweepRem;                      //!< the chirp increment change remainder, per numTicks
+  uint32_t        bitTicks;                      //!< the ISR ticks per PRBS bit
+
+  // the run, mainISR only
+  volatile EXCITE_State_e state;                 //!< the generator state
+  uint32_t        tick;                          //!< the ticks since the start
+  uint32_t        phase[EXCITE_NUM_TONES];       //!< the phase accumulators
+  int32_t         sweepAcc;                      //!< the chirp remainder accumulator
+  uint32_t        bitCounter;                    //!< the ticks left in the PRBS bit
+  uint_least16_t  lfsr;                          //!< the PRBS shift register
+  int32_t         value;                         //!< the last output, IQ24 A
+
+  uint32_t        numRuns;                       //!< the number of runs completed
+} EXCITE_Obj;
+
+
+// **************************************************************************
+// the function prototypes
+
+//! \brief     Initializes the generator, idle, with the settings of the old
+//!            SINE_RES test: a 5 A chirp from 0.4 Hz to 1 Hz over 2 s
+//! \param[in] obj              A pointer to the generator
+//! \param[in] isrFreq_Hz       The EXCITE_run() rate
+//! \param[in] maxAmplitude_mA  The largest accepted amplitude
+extern void EXCITE_init(EXCITE_Obj *obj,const uint32_t isrFreq_Hz,const int32_t maxAmplitude_mA);
+
+
+//! \brief     Changes one setting, or starts or stops a run, call from the background loop
+//! \details   Settings are refused while a run is armed or in progress, and
+//!            out of range values are refused rather than clamped.
+//! \param[in] obj    A pointer to the generator
+//! \param[in] param  The setting
+//! \param[in] value  The value, in the units of the setting
+//! \return    True if the setting was taken
+extern bool EXCITE_setParam(EXCITE_Obj *obj,const EXCITE_Param_e param,const int32_t value);
+
+
+//! \brief     Precomputes a run from the settings and arms it, call from the background loop
+//! \param[in] obj  A pointer to the generator
+//! \return    False if a run is in progress, the mode is Off, or the
+//!            frequencies do not suit the mode
+extern bool EXCITE_start(EXCITE_Obj *obj);
+
+
+//! \brief     Stops a run or acknowledges a finished one, back to Idle
+//! \param[in] obj  A pointer to the generator
+extern void EXCITE_stop(EXCITE_Obj *obj);
+
+
+//! \brief     Gets the sine of a phase from the table
+//! \param[in] phase  The phase, 2^32 per cycle
+//! \return    The sine, Q15
+extern int32_t EXCITE_getSine(const uint32_t phase);
+
+
+//! \brief     Generates one tick, call from mainISR
+//! \param[in] obj  A pointer to the generator
+//! \return    The excitation, IQ24 A, 0 unless Armed or Running
+extern int32_t EXCITE_run(EXCITE_Obj *obj);
+
+
+#ifdef __cplusplus
+}
+#endif // extern "C"
+
+//@} // ingroup
+#endif // end of _EXCITE_H_ definition
@@ -0,0 +1,126 @@
+//! \file   fric.c
+//! \brief  Contains the friction and cogging feedforward (FRIC) functions
+//!
+
+
+// **************************************************************************
+// the includes
+
+#include "fric.h"
+
+
+#ifdef FLASH
+#pragma CODE_SECTION(FRIC_run,"ramfuncs");
+#endif
+
+
+// **************************************************************************
+// the defines
+
+//! \brief Defines the IQ24 fraction mask
+//!
+#define FRIC_IQ24_FRACTION          (0xFFFFFFUL)
+
+//! \brief Converts a table entry to IQ24 A
+//!
+#define FRIC_toIQ24(entry)          ((int32_t)(entry) * ((int32_t)1 << (24 - FRIC_TABLE_Q)))
+
+
+// **************************************************************************
+// the globals
+
+
+// **************************************************************************
+// the functions
+
+void FRIC_init(FRIC_Obj *obj,const FRIC_Table_t *pTable)
+{
+  uint_least16_t cnt;
+
+
+  obj->table.numSpeedPoints = pTable->numSpeedPoints;
+  obj->table.pointsPerKrpm = pTable->pointsPerKrpm;
+  obj->table.numCoggingPoints = pTable->numCoggingPoints;
+
+  for(cnt=0;cnt<FRIC_MAX_SPEED_POINTS;cnt++)
+    {
+      obj->table.speed[cnt] = pTable->speed[cnt];
+    }
+
+  for(cnt=0;cnt<FRIC_MAX_COGGING_POINTS;cnt++)
+    {
+      obj->table.cogging[cnt] = pTable->cogging[cnt];
+    }
+
+  // a table that does not fit is not used
+  if((obj->table.numSpeedPoints < 2) || (obj->table.numSpeedPoints > FRIC_MAX_SPEED_POINTS) ||
+     (obj->table.pointsPerKrpm == 0))
+    {
+      obj->table.numSpeedPoints = 0;
+    }
+
+  if((obj->table.numCoggingPoints > FRIC_MAX_COGGING_POINTS) ||
+     ((obj->table.numCoggingPoints & (obj->table.numCoggingPoints - 1)) != 0))
+    {
+      obj->table.numCoggingPoints = 0;
+    }
+
+  obj->maxSpeed_krpm = (obj->table.numSpeedPoints != 0) ?
+                       (int32_t)((((int64_t)obj->table.numSpeedPoints - 1) << 24) / obj->table.pointsPerKrpm) : 0;
+  obj->flag_enableSpeed = (obj->table.numSpeedPoints != 0);
+  obj->flag_enableCogging = (obj->table.numCoggingPoints != 0);
+  obj->value = 0;
+
+  return;
+} // end of FRIC_init() function
+
+
+int32_t FRIC_run(FRIC_Obj *obj,const int32_t speed_krpm,const int32_t angle_pu)
+{
+  int32_t value = 0;
+
+
+  if(obj->flag_enableSpeed && (obj->table.numSpeedPoints != 0))
+    {
+      int32_t absSpeed_krpm = (speed_krpm < 0) ? -speed_krpm : speed_krpm;
+      int32_t friction;
+
+      if(absSpeed_krpm >= obj->maxSpeed_krpm)
+        {
+          friction = FRIC_toIQ24(obj->table.speed[obj->table.numSpeedPoints - 1]);
+        }
+      else
+        {
+          // the table position, IQ24 points, below maxSpeed_krpm it fits 32 bits
+          const uint32_t position = (uint32_t)absSpeed_krpm * obj->table.pointsPerKrpm;
+          const uint_least16_t index = (uint_least16_t)(position >> 24);
+          const int32_t y0 = obj->table.speed[index];
+          const int32_t y1 = obj->table.speed[index + 1];
+
+          friction = FRIC_toIQ24(y0) +
+                     (int32_t)(((int64_t)(y1 - y0) * (int64_t)(position & FRIC_IQ24_FRACTION)) >> FRIC_TABLE_Q);
+        }
+
+      value = (speed_krpm < 0) ? -friction : friction;
+    }
+
+  if(obj->flag_enableCogging && (obj->table.numCoggingPoints != 0))
+    {
+      // one revolution is the IQ24 fraction, so a negative angle wraps
+      const uint_least16_t mask = obj->table.numCoggingPoints - 1;
+      const uint32_t position = ((uint32_t)angle_pu & FRIC_IQ24_FRACTION) * obj->table.numCoggingPoints;
+      const uint_least16_t index = (uint_least16_t)(position >> 24) & mask;
+      const int32_t y0 = obj->table.cogging[index];
+      const int32_t y1 = obj->table.cogging[(index + 1) & mask];
+
+      value += FRIC_toIQ24(y0) +
+               (int32_t)(((int64_t)(y1 - y0) * (int64_t)(position & FRIC_IQ24_FRACTION)) >> FRIC_TABLE_Q);
+    }
+
+  obj->value = value;
+
+  return(value);
+} // end of FRIC_run() function
+
+
+// end of file
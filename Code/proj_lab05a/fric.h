@@ -0,0 +1,127 @@
+#ifndef _FRIC_H_
+#define _FRIC_H_
+
+//! \file   fric.h
+//! \brief  Contains the public interface to the friction and cogging
+//!         feedforward (FRIC)
+//!
+//!         mainISR calls FRIC_run() once per tick and adds the result to the
+//!         commanded Iq reference, so the balance loop no longer has to hold
+//!         the wheel bearing friction with feedback alone.  The compensation
+//!         is looked up in two fixed point tables, Q12 A, with linear
+//!         interpolation:
+//!
+//!           speed    the Iq the friction takes at |speed|, at pointsPerKrpm
+//!                    points per krpm from 0, applied with the sign of the
+//!                    speed and held at the last point beyond the table.
+//!                    The first point is 0, so the compensation ramps through
+//!                    zero speed instead of switching sign on estimator noise.
+//!           cogging  the Iq to add over one electrical revolution, a power
+//!                    of two points, indexed by the estimated angle
+//!
+//!         The tables are const, in flash in a FLASH build, and FRIC_init()
+//!         copies them into the object, so mainISR only reads RAM.  The
+//!         speed table in fric_table.c is generated by Code/tools/fricfit from
+//!         the Data/ step runs.  Those runs logged no angle, so it carries no
+//!         cogging points and the cogging term stays off until a table with
+//!         them is loaded.
+//!
+//!         The module has no device specific includes and builds on the host.
+
+
+// **************************************************************************
+// the includes
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+//!
+//!
+//! \defgroup FRIC FRIC
+//!
+//@{
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+// **************************************************************************
+// the defines
+
+//! \brief Defines the Q format of the table entries, A
+//!
+#define FRIC_TABLE_Q                (12)
+
+//! \brief Defines the largest number of speed table points
+//!
+#define FRIC_MAX_SPEED_POINTS       (64)
+
+//! \brief Defines the largest number of cogging table points
+//!
+#define FRIC_MAX_COGGING_POINTS     (64)
+
+
+// **************************************************************************
+// the typedefs
+
+//! \brief Defines the feedforward tables
+//!
+typedef struct _FRIC_Table_t_
+{
+  uint_least16_t  numSpeedPoints;                //!< the speed points, 0 for none
+  uint_least16_t  pointsPerKrpm;                 //!< the speed points per krpm
+  int16_t         speed[FRIC_MAX_SPEED_POINTS];  //!< the friction from 0 krpm up, Q12 A
+  uint_least16_t  numCoggingPoints;              //!< the cogging points, 0 for none or a power of two
+  int16_t         cogging[FRIC_MAX_COGGING_POINTS];  //!< the cogging over one electrical revolution, Q12 A
+} FRIC_Table_t;
+
+
+//! \brief Defines the feedforward
+//!
+//!        The enables may be changed from the watch window, the tables only
+//!        with FRIC_init()
+//!
+typedef struct _FRIC_Obj_
+{
+  FRIC_Table_t    table;                         //!< the RAM copy of the tables
+  int32_t         maxSpeed_krpm;                 //!< the speed of the last point, IQ24
+  bool            flag_enableSpeed;              //!< adds the speed table
+  bool            flag_enableCogging;            //!< adds the cogging table
+  int32_t         value;                         //!< the last output, IQ24 A
+} FRIC_Obj;
+
+
+// **************************************************************************
+// the globals
+
+//! \brief The tables generated by Code/tools/fricfit, see fric_table.c
+//!
+extern const FRIC_Table_t gFricTable;
+
+
+// **************************************************************************
+// the function prototypes
+
+//! \brief     Copies the tables into the feedforward and enables the terms they have points for
+//! \param[in] obj     A pointer to the feedforward
+//! \param[in] pTable  A pointer to the tables, usually in flash
+extern void FRIC_init(FRIC_Obj *obj,const FRIC_Table_t *pTable);
+
+
+//! \brief     Gets the feedforward for one tick, call from mainISR
+//! \param[in] obj          A pointer to the feedforward
+//! \param[in] speed_krpm   The estimated speed, IQ24 krpm
+//! \param[in] angle_pu     The estimated electrical angle, IQ24, 1.0 per revolution
+//! \return    The Iq to add, IQ24 A
+extern int32_t FRIC_run(FRIC_Obj *obj,const int32_t speed_krpm,const int32_t angle_pu);
+
+
+#ifdef __cplusplus
+}
+#endif // extern "C"
+
+//@} // ingroup
+#endif // end of _FRIC_H_ definition
@@ -0,0 +1,45 @@
+//! \file   fric_table.c
+//! \brief  Contains the friction feedforward table (see fric.h), generated by
+//!         Code/tools/fricfit, do not edit
+//!
+//!         gain 6.176 krpm/s per A, from
+//!
+//!           11amp-500hz.xlsm
+//!           13amp-500hz.xlsm
+//!           15amp-500hz.xlsm
+//!           1amp-500hz.xlsm
+//!           2amp-500hz.xlsm
+//!           3amp-500hz.xlsm
+//!           4amp-500hz.xlsm
+//!           5amp-500hz.xlsm
+//!           7amp-500hz.xlsm
+//!           9amp-500hz.xlsm
+//!           1amp-500hz-2.xlsm
+//!           7amp-500hz-2.xlsm
+
+
+// **************************************************************************
+// the includes
+
+#include "fric.h"
+
+
+// **************************************************************************
+// the globals
+
+const FRIC_Table_t gFricTable =
+{
+  29,    // numSpeedPoints
+  4,     // pointsPerKrpm
+  {      // speed, Q12 A
+        0,  923,  604,  551,  750,  726,  809,  784,
+      906,  886,  906,  962,  957, 1019, 1039, 1102,
+     1194, 1212, 1240, 1303, 1401, 1367, 1449, 1536,
+     1709, 1676, 1846, 1872, 2015
+  },
+  0,     // numCoggingPoints
+  {0}    // cogging
+};
+
+
+// end of file
@@ -39,6 +39,9 @@
 // the includes
 
 // drivers
+#ifdef PARAM_STORE_FLASH_API
+#include "Flash2806x_API_Library.h"
+#endif
 
 // modules
 
@@ -724,6 +727,29 @@ HAL_Handle HAL_init(void *pMemory,const size_t numBytes)
 } // end of HAL_init() function
 
 
+//! \brief Sets the baud rate of one SCI, leaving it unchanged if the rate cannot be reached
+static bool HAL_setSciBaudRate(SCI_Handle sciHandle,const uint32_t rate,BAUD_Config_t *pConfig) {
+    BAUD_Config_t config;
+
+    if(!BAUD_compute(HAL_LSPCLK_FREQ_Hz,rate,&config)) {
+        return(false);
+    }
+
+    SCI_setBaudRate(sciHandle,(SCI_BaudRate_e)config.brr);
+    *pConfig = config;
+    return(true);
+}    // end of HAL_setSciBaudRate() function
+
+bool HAL_setSciABaudRate(HAL_Handle handle,const uint32_t rate) {
+    HAL_Obj *obj = (HAL_Obj *)handle;
+    return(HAL_setSciBaudRate(obj->sciAHandle,rate,&obj->sciABaud));
+}    // end of HAL_setSciABaudRate() function
+
+bool HAL_setSciBBaudRate(HAL_Handle handle,const uint32_t rate) {
+    HAL_Obj *obj = (HAL_Obj *)handle;
+    return(HAL_setSciBaudRate(obj->sciBHandle,rate,&obj->sciBBaud));
+}    // end of HAL_setSciBBaudRate() function
+
 void HAL_setupSciB(HAL_Handle handle) {
     HAL_Obj *obj = (HAL_Obj *)handle;
     SCI_reset(obj->sciBHandle);
@@ -732,9 +758,21 @@ void HAL_setupSciB(HAL_Handle handle) {
     SCI_disableParity(obj->sciBHandle);
     SCI_setNumStopBits(obj->sciBHandle,SCI_NumStopBits_One);
     SCI_setCharLength(obj->sciBHandle,SCI_CharLength_8_Bits);
-    // set baud rate to 115200
-    SCI_setBaudRate(obj->sciBHandle,(SCI_BaudRate_e)(0x0061));
+    // set baud rate to 115200, BRR computed from LSPCLK
+    HAL_setSciBBaudRate(handle,BAUD_DEFAULT_RATE);
     SCI_setPriority(obj->sciBHandle,SCI_Priority_FreeRun);
+
+    // use the 4 word FIFOs so a command frame costs one interrupt per FIFO fill
+    SCI_enableTxFifoEnh(obj->sciBHandle);
+    SCI_resetTxFifo(obj->sciBHandle);
+    SCI_clearTxFifoInt(obj->sciBHandle);
+    SCI_setTxFifoIntLevel(obj->sciBHandle,SCI_FifoLevel_Empty);
+    SCI_resetRxFifo(obj->sciBHandle);
+    SCI_clearRxFifoOvf(obj->sciBHandle);
+    SCI_clearRxFifoInt(obj->sciBHandle);
+    SCI_setRxFifoIntLevel(obj->sciBHandle,SCI_FifoLevel_4_Words);
+    SCI_resetChannels(obj->sciBHandle);
+
     SCI_enable(obj->sciBHandle);
     return;
 }    // end of HAL_setupSciB() function
@@ -747,8 +785,8 @@ void HAL_setupSciA(HAL_Handle handle) {
     SCI_disableParity(obj->sciAHandle);
     SCI_setNumStopBits(obj->sciAHandle,SCI_NumStopBits_One);
     SCI_setCharLength(obj->sciAHandle,SCI_CharLength_8_Bits);
-    // set baud rate to 115200
-    SCI_setBaudRate(obj->sciAHandle,(SCI_BaudRate_e)(0x0061));
+    // set baud rate to 115200, BRR computed from LSPCLK
+    HAL_setSciABaudRate(handle,BAUD_DEFAULT_RATE);
     SCI_setPriority(obj->sciAHandle,SCI_Priority_FreeRun);
     SCI_enable(obj->sciAHandle);
     return;
@@ -761,10 +799,9 @@ void HAL_enableSciInts(HAL_Handle handle) {
     PIE_enableInt(obj->pieHandle,PIE_GroupNumber_9,PIE_InterruptSource_SCIBTX);
     PIE_enableInt(obj->pieHandle,PIE_GroupNumber_9,PIE_InterruptSource_SCIBRX);
 
-    // enable SCI TX interrupts
-    // enable SCIB TX interrupt
-    SCI_enableTxInt(obj->sciBHandle);
-    SCI_enableRxInt(obj->sciBHandle);
+    // enable SCIB RX FIFO interrupt, the TX FIFO interrupt is enabled
+    // whenever there is data queued for transmission
+    SCI_enableRxFifoInt(obj->sciBHandle);
 
     // enable the cpu interrupt for SCI interrupts
     CPU_enableInt(obj->cpuHandle,CPU_IntNumber_9);
@@ -1077,7 +1114,7 @@ void HAL_setupClks(HAL_Handle handle)
   // disable oscillator 2
   CLK_disableOsc2(obj->clkHandle);
 
-  // set the low speed clock prescaler
+  // set the low speed clock prescaler, keep HAL_LSPCLK_FREQ_Hz in step
   CLK_setLowSpdPreScaler(obj->clkHandle,CLK_LowSpdPreScaler_SysClkOut_by_1);
 
   // set the clock out prescaler
@@ -1792,6 +1829,146 @@ void HAL_setupDrvSpi(HAL_Handle handle, DRV_SPI_8305_Vars_t *Spi_8305_Vars)
 }  // end of HAL_setupDrvSpi() function
 
 
+void HAL_setupDrvSpiQueue(HAL_Handle handle, DRVSPI_Obj *pDrvSpi, DRV_SPI_8305_Vars_t *Spi_8305_Vars, const uint32_t now_ms)
+{
+  uint_least16_t reg;
+
+  DRVSPI_init(pDrvSpi,DRVSPI_DEFAULT_POLL_PERIOD_ms,now_ms);
+
+  // the control registers as read, so only changes are written
+  for(reg=0;reg<DRVSPI_NUM_REGS;reg++)
+  {
+    if(DRVSPI_CONTROL_REGS & ((uint16_t)1 << reg))
+    {
+      DRVSPI_setValue(pDrvSpi,reg,DRV8305_getCtrlData(Spi_8305_Vars,(DRV8305_Address_e)(reg << DRVSPI_ADDR_SHIFT)));
+    }
+  }
+
+  return;
+}  // end of HAL_setupDrvSpiQueue() function
+
+
+void HAL_runDrvSpi(HAL_Handle handle, DRVSPI_Obj *pDrvSpi, DRV_SPI_8305_Vars_t *Spi_8305_Vars, const uint32_t now_ms)
+{
+  HAL_Obj  *obj = (HAL_Obj *)handle;
+  SPI_Handle spiHandle = ((DRV8305_Obj *)obj->drv8305Handle)->spiHandle;
+  uint_least16_t reg;
+  uint16_t frame;
+
+  // take the reply of the transfer in flight
+  if(DRVSPI_isBusy(pDrvSpi))
+  {
+    if(SPI_getRxFifoStatus(spiHandle) >= SPI_FifoStatus_1_Word)
+    {
+      if(DRVSPI_finish(pDrvSpi,SPI_readEmu(spiHandle),&reg))
+      {
+        DRV8305_setRegData(Spi_8305_Vars,(DRV8305_Address_e)(reg << DRVSPI_ADDR_SHIFT),DRVSPI_getValue(pDrvSpi,reg));
+
+        if(reg == Spi_8305_Vars->ManReadAddr)
+        {
+          Spi_8305_Vars->ManReadData = DRVSPI_getValue(pDrvSpi,reg);
+        }
+      }
+    }
+    else
+    {
+      DRVSPI_checkTimeout(pDrvSpi,now_ms);
+    }
+  }
+
+  // queue the commands
+  if(Spi_8305_Vars->WriteCmd)
+  {
+    for(reg=0;reg<DRVSPI_NUM_REGS;reg++)
+    {
+      if(DRVSPI_CONTROL_REGS & ((uint16_t)1 << reg))
+      {
+        DRVSPI_update(pDrvSpi,reg,DRV8305_getCtrlData(Spi_8305_Vars,(DRV8305_Address_e)(reg << DRVSPI_ADDR_SHIFT)));
+      }
+    }
+
+    Spi_8305_Vars->WriteCmd = false;
+  }
+
+  if(Spi_8305_Vars->ManWriteCmd)
+  {
+    DRVSPI_write(pDrvSpi,Spi_8305_Vars->ManWriteAddr,Spi_8305_Vars->ManWriteData);
+
+    Spi_8305_Vars->ManWriteCmd = false;
+  }
+
+  if(Spi_8305_Vars->ReadCmd)
+  {
+    for(reg=0;reg<DRVSPI_NUM_REGS;reg++)
+    {
+      if((DRVSPI_STATUS_REGS | DRVSPI_CONTROL_REGS) & ((uint16_t)1 << reg))
+      {
+        DRVSPI_read(pDrvSpi,reg);
+      }
+    }
+
+    Spi_8305_Vars->ReadCmd = false;
+  }
+
+  if(Spi_8305_Vars->ManReadCmd)
+  {
+    DRVSPI_read(pDrvSpi,Spi_8305_Vars->ManReadAddr);
+
+    Spi_8305_Vars->ManReadCmd = false;
+  }
+
+  // start the next transfer, its reply is taken on a later pass
+  if(DRVSPI_start(pDrvSpi,now_ms,&frame))
+  {
+    SPI_resetRxFifo(spiHandle);
+    SPI_enableRxFifo(spiHandle);
+    SPI_write(spiHandle,frame);
+  }
+
+  return;
+}  // end of HAL_runDrvSpi() function
+
+
+bool HAL_writeParamRecord(HAL_Handle handle, const uint_least16_t slot, const bool flag_erase, uint16_t *pRecord)
+{
+#ifdef PARAM_STORE_FLASH_API
+  uint16_t *pFlash = (uint16_t *)HAL_PARAM_FLASH_ADDR + slot * PSTORE_RECORD_WORDS;
+  FLASH_ST status;
+  uint16_t result = STATUS_SUCCESS;
+
+  // the flash cannot be read while it is erased or programmed
+  HAL_disableGlobalInts(handle);
+
+  EALLOW;
+  Flash_CPUScaleFactor = SCALE_FACTOR;
+  Flash_CallbackPtr = NULL;
+  EDIS;
+
+  if(flag_erase)
+  {
+    result = Flash_Erase(HAL_PARAM_FLASH_SECTOR,&status);
+  }
+
+  if(result == STATUS_SUCCESS)
+  {
+    result = Flash_Program(pFlash,pRecord,PSTORE_RECORD_WORDS,&status);
+  }
+
+  if(result == STATUS_SUCCESS)
+  {
+    result = Flash_Verify(pFlash,pRecord,PSTORE_RECORD_WORDS,&status);
+  }
+
+  HAL_enableGlobalInts(handle);
+
+  return(result == STATUS_SUCCESS);
+#else
+  // no flash API linked, the save is refused
+  return(false);
+#endif
+}  // end of HAL_writeParamRecord() function
+
+
 void HAL_setDacParameters(HAL_Handle handle, HAL_DacData_t *pDacData)
 {
 	HAL_Obj *obj = (HAL_Obj *)handle;
@@ -133,6 +133,23 @@ extern "C" {
 #define HAL_toggleLed             HAL_toggleGpio
 
 
+//! \brief Defines the low speed peripheral clock (LSPCLK) frequency, Hz
+//! \note  Must match the CLK_setLowSpdPreScaler() setting in HAL_setupClks()
+//!
+#define HAL_LSPCLK_FREQ_Hz        ((uint32_t)(USER_SYSTEM_FREQ_MHz * 1000000.0 / 1.0))
+
+
+//! \brief Defines the start of the flash sector the parameter store uses, sector H
+//! \note  Sector H is not used by the linker command file, keep it out of it
+//!
+#define HAL_PARAM_FLASH_ADDR      (0x3D8000)
+
+
+//! \brief Defines the flash API sector mask of HAL_PARAM_FLASH_ADDR
+//!
+#define HAL_PARAM_FLASH_SECTOR    (0x0080)
+
+
 // **************************************************************************
 // the typedefs
 
@@ -234,6 +251,18 @@ extern void HAL_setupSciA(HAL_Handle handle);
 //! \param[in] handle The hardware abstraction layer (HAL) handle
 extern void HAL_setupSciB(HAL_Handle handle);
 
+//! \brief     Sets the sciA baud rate, BRR is computed from HAL_LSPCLK_FREQ_Hz
+//! \param[in] handle  The hardware abstraction layer (HAL) handle
+//! \param[in] rate    The baud rate
+//! \return    False if the rate cannot be reached, the setting is then left unchanged
+extern bool HAL_setSciABaudRate(HAL_Handle handle,const uint32_t rate);
+
+//! \brief     Sets the sciB baud rate, BRR is computed from HAL_LSPCLK_FREQ_Hz
+//! \param[in] handle  The hardware abstraction layer (HAL) handle
+//! \param[in] rate    The baud rate
+//! \return    False if the rate cannot be reached, the setting is then left unchanged
+extern bool HAL_setSciBBaudRate(HAL_Handle handle,const uint32_t rate);
+
 //! \brief     Acknowledges an interrupt from the PWM so that another PWM interrupt can
 //!            happen again.
 //! \param[in] handle     The hardware abstraction layer (HAL) handle
@@ -1425,6 +1454,60 @@ void HAL_readDrvData(HAL_Handle handle, DRV_SPI_8305_Vars_t *Spi_8305_Vars);
 //! \param[in] Spi_8305_Vars  SPI variables
 void HAL_setupDrvSpi(HAL_Handle handle, DRV_SPI_8305_Vars_t *Spi_8305_Vars);
 
+
+//! \brief     Sets up the driver SPI transaction queue from the registers HAL_setupDrvSpi() read
+//! \param[in] handle         The hardware abstraction layer (HAL) handle
+//! \param[in] pDrvSpi        The transaction queue
+//! \param[in] Spi_8305_Vars  SPI variables
+//! \param[in] now_ms         The current time, ms
+void HAL_setupDrvSpiQueue(HAL_Handle handle, DRVSPI_Obj *pDrvSpi, DRV_SPI_8305_Vars_t *Spi_8305_Vars, const uint32_t now_ms);
+
+
+//! \brief     Services the driver SPI through the transaction queue, without waiting on it
+//!
+//!            Takes the reply of the transfer in flight if it is in, queues the
+//!            SPI variables read and write commands, the writes only for the
+//!            registers that changed, and starts the next transfer.  The
+//!            commands are cleared when queued, the read data follows within a
+//!            few passes.
+//!
+//! \param[in] handle         The hardware abstraction layer (HAL) handle
+//! \param[in] pDrvSpi        The transaction queue
+//! \param[in] Spi_8305_Vars  SPI variables
+//! \param[in] now_ms         The current time, ms
+void HAL_runDrvSpi(HAL_Handle handle, DRVSPI_Obj *pDrvSpi, DRV_SPI_8305_Vars_t *Spi_8305_Vars, const uint32_t now_ms);
+
+
+//! \brief     Encodes a driver control register from the SPI variables, in drv8305.c
+//! \param[in] Spi_8305_Vars  SPI variables
+//! \param[in] regAddr        The control register
+//! \return    The register data
+uint16_t DRV8305_getCtrlData(const DRV_SPI_8305_Vars_t *Spi_8305_Vars,const DRV8305_Address_e regAddr);
+
+
+//! \brief     Decodes driver register data into the SPI variables, in drv8305.c
+//! \param[in] Spi_8305_Vars  SPI variables
+//! \param[in] regAddr        The status or control register
+//! \param[in] drvDataNew     The register data
+void DRV8305_setRegData(DRV_SPI_8305_Vars_t *Spi_8305_Vars,const DRV8305_Address_e regAddr,const uint16_t drvDataNew);
+
+
+//! \brief     Programs a parameter store record to its slot in the HAL_PARAM_FLASH_ADDR sector
+//!
+//!            Needs the F2806x flash API library, Flash2806x_API_V100.lib, linked
+//!            and PARAM_STORE_FLASH_API in the project predefined symbols, with the
+//!            API placed in ramfuncs, and sector H reserved by pstore_lnk.cmd.
+//!            Without it every write is refused.  The interrupts, mainISR too,
+//!            are held off while the flash is busy, an erase takes seconds, so
+//!            only call with the controller Idle and the PWM disabled.
+//!
+//! \param[in] handle      The hardware abstraction layer (HAL) handle
+//! \param[in] slot        The record slot
+//! \param[in] flag_erase  True to erase the sector first
+//! \param[in] pRecord     The record, PSTORE_RECORD_WORDS words
+//! \return    True if the record was programmed and verified
+bool HAL_writeParamRecord(HAL_Handle handle, const uint_least16_t slot, const bool flag_erase, uint16_t *pRecord);
+
 //! \brief     Writes DAC data to the PWM comparators for DAC (digital-to-analog conversion) output
 //! \param[in] handle    The hardware abstraction layer (HAL) handle
 //! \param[in] pDacData  The pointer to the DAC data
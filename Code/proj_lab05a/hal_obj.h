@@ -65,6 +65,9 @@
 #include "sw/modules/offset/src/32b/offset.h"
 #include "sw/modules/types/src/types.h"
 #include "sw/modules/usDelay/src/32b/usDelay.h"
+#include "baud.h"
+#include "drvspi.h"
+#include "pstore.h"
 
 
 // platforms
@@ -185,6 +188,9 @@ typedef struct _HAL_Obj_
   SCI_Handle    sciAHandle;
   SCI_Handle    sciBHandle;
 
+  BAUD_Config_t sciABaud;           //!< the SCI-A baud rate setting
+  BAUD_Config_t sciBBaud;           //!< the SCI-B baud rate setting
+
 } HAL_Obj;
 
 
@@ -62,12 +62,111 @@
 #include "sw/modules/ctrl/src/32b/ctrl.h"
 #include "hal.h"
 #include "user.h"
+#include "cmdlink.h"
+#include "ringbuf.h"
+#include "cmdparse.h"
+#include "telem.h"
+#include "prof.h"
+#include "excite.h"
+#include "wheelid.h"
+#include "fric.h"
+#include "pstore.h"
+#include "boot.h"
 
 
 // **************************************************************************
 // the defines
 
 
+//! \brief Define to accept the legacy ASCII "<float>a" torque commands on SCI-B
+//!        instead of binary CMDLINK frames
+//!
+//#define CMDLINK_ASCII
+
+//! \brief Define to hand received torque commands to the current controller on
+//!        the next mainISR tick, undefine to apply them from the background loop
+//!        in updateIqRef() as before, for comparison.  While defined, watch
+//!        window writes to gMotorVars.IqRef_A are not applied.
+//!
+#define CMD_APPLY_IN_ISR
+
+//! \brief Define to add the friction feedforward of fric.h to the torque
+//!        command, from the table in fric_table.c.  The feedforward never
+//!        takes the command past USER_MOTOR_MAX_CURRENT, and
+//!        gFric.flag_enableSpeed turns it off from the watch window.  Left
+//!        undefined, as the table has to be fit with Code/tools/fricfit for the
+//!        wheel on hand before it adds torque to every command.
+//!
+//#define FRIC_FEEDFORWARD
+
+//! \brief Define to run the DRV8305 SPI through the transaction queue of
+//!        drvspi.h, one transfer per background loop pass without waiting on
+//!        it, the status registers read round robin every
+//!        DRVSPI_DEFAULT_POLL_PERIOD_ms.  Undefine to call the blocking
+//!        HAL_writeDrvData() and HAL_readDrvData() every pass as before, to
+//!        compare gBgLoop.
+//!
+#define DRV_SPI_QUEUE
+
+//! \brief Define to keep the ADC biases and the identified motor parameters in
+//!        the flash parameter store of pstore.h.  At boot the stored motor
+//!        parameters replace the user.h ones, and stored biases turn off the
+//!        offset calibration, so the controller goes from Idle straight to
+//!        OnLine without the OffLine wait.  Changed parameters are saved while
+//!        the PWM is off, see HAL_writeParamRecord() for the flash API it needs.
+//!        Set gMotorVars.Flag_enableOffsetcalc to calibrate and save again.
+//!        Left undefined, as without PARAM_STORE_FLASH_API and the flash API
+//!        linked every save is refused and nothing is ever stored.  Define it
+//!        with them in the Flash build, pstore_lnk.cmd reserves the sector.
+//!        The boot timeline only reaches OnLine within ms of HAL_init() once a
+//!        record is stored, the default build runs the OffLine calibration on
+//!        every boot.
+//!
+//#define PARAM_STORE
+
+//! \brief Defines the size of the SCI-B transmit queue, must be a power of two
+//!
+#define TX_QUEUE_SIZE  256
+
+//! \brief Defines the default telemetry decimation, ISR ticks
+//!
+#define TELEM_DEFAULT_DECIMATION  (uint_least16_t)(USER_ISR_FREQ_Hz / USER_PRINT_FREQ_Hz)
+
+//! \brief Defines the telemetry channels an excitation run logs, all at its decimation
+//!
+#define EXCITE_LOG_CHANNELS       ((1 << TELEM_Channel_Speed_krpm) | (1 << TELEM_Channel_Iq_A) | \
+                                   (1 << TELEM_Channel_IqRef_A) | (1 << TELEM_Channel_Excite_A))
+
+//! \brief Defines the wheel model estimator window, ISR ticks, 500 Hz
+//!
+#define WHEELID_DECIMATION        (uint_least16_t)(USER_ISR_FREQ_Hz / 500.0)
+
+//! \brief Defines the decimation of the wheel model telemetry channels, ISR ticks, 10 Hz
+//!
+#define TELEM_MODEL_DECIMATION    (uint_least16_t)(USER_ISR_FREQ_Hz / 10.0)
+
+//! \brief Defines the background loop rate measurement window, ms
+//!
+#define BGLOOP_WINDOW_ms          (1000)
+
+//! \brief Defines the free running CPU timer used for time stamps, counts down at SYSCLK
+//!
+#define CPU_TIME_TIMER_NUMBER     2
+
+//! \brief Define to profile the mainISR stages into gProf, see prof.h
+//!
+#define PROFILE_MAINISR
+
+#ifdef PROFILE_MAINISR
+#define PROFILE_START()           PROF_start(&gProf,HAL_readTimerCnt(halHandle,CPU_TIME_TIMER_NUMBER))
+#define PROFILE_MARK(stage)       PROF_mark(&gProf,(stage),HAL_readTimerCnt(halHandle,CPU_TIME_TIMER_NUMBER))
+#define PROFILE_END()             PROF_end(&gProf,HAL_readTimerCnt(halHandle,CPU_TIME_TIMER_NUMBER))
+#else
+#define PROFILE_START()
+#define PROFILE_MARK(stage)
+#define PROFILE_END()
+#endif
+
 //! \brief Defines the number of main iterations before global variables are updated
 //!
 #define NUM_MAIN_TICKS_FOR_GLOBAL_VARIABLE_UPDATE  1
@@ -241,6 +340,174 @@ typedef struct _MOTOR_Vars_t_
 }MOTOR_Vars_t;
 
 
+//! \brief Defines the SCI-B receive statistics, readable from the watch window
+//!
+//!        Interrupts per command is numInts/numCmds, two for an 8 byte frame
+//!
+typedef struct _SCIB_RxStats_t_
+{
+  uint32_t numInts;              //!< the number of receive FIFO interrupts
+  uint32_t numBytes;             //!< the number of bytes drained from the FIFO
+  uint32_t numCmds;              //!< the number of torque commands received
+  uint32_t numFifoOvf;           //!< the number of receive FIFO overflows
+  uint32_t numTimeouts;          //!< the number of partial fills drained on timeout
+  uint_least16_t lastLevel;      //!< the FIFO level at the previous timeout check
+} SCIB_RxStats_t;
+
+
+//! \brief Enumeration for the SCI-B baud rate handshake states, see cmdlink.h
+//!
+typedef enum
+{
+  SCIB_BaudState_Idle=0,         //!< running at a committed rate
+  SCIB_BaudState_Switching,      //!< Ack queued, waiting for the transmitter to drain
+  SCIB_BaudState_Probing         //!< running at the new rate, waiting for a probe
+} SCIB_BaudState_e;
+
+
+//! \brief Defines the SCI-B baud rate handshake
+//!
+//!        The receive path only posts requests and probes, the background
+//!        loop answers them and switches the rate
+//!
+typedef struct _SCIB_BaudLink_t_
+{
+  SCIB_BaudState_e state;                //!< the handshake state
+  volatile bool flag_request;            //!< set by the receive path on a BaudRequest
+  volatile bool flag_probe;              //!< set by the receive path on a valid BaudProbe
+  volatile uint32_t requestedRate;       //!< the BaudRequest payload
+  volatile uint_least16_t timer_ms;      //!< probe timeout, counted down by mainISR
+  uint32_t previousRate;                 //!< the rate to fall back to
+  uint_least8_t txSeq;                   //!< the next reply sequence number
+  uint32_t numSwitches;                  //!< the number of committed rate changes
+  uint32_t numFallbacks;                 //!< the number of probe timeouts
+  uint32_t numNacks;                     //!< the number of refused requests
+} SCIB_BaudLink_t;
+
+
+//! \brief Enumeration for the torque command latency stamp states
+//!
+//!        A command is applied by takeIqRef(), which mainISR calls while
+//!        CMD_APPLY_IN_ISR is defined, the default, and updateIqRef() calls
+//!        from the background loop with #undef CMD_APPLY_IN_ISR
+//!
+typedef enum
+{
+  CMDECHO_State_Idle=0,          //!< free, the receive path may stamp the next command
+  CMDECHO_State_Received,        //!< stamped on receive, waiting for takeIqRef()
+  CMDECHO_State_Applied,         //!< stamped on apply, waiting for the next PWM update
+  CMDECHO_State_Done             //!< stamped on the PWM update, waiting to be echoed
+} CMDECHO_State_e;
+
+
+//! \brief Defines the torque command latency stamps, CPU timer counts
+//!
+//!        Each state is advanced by one context only: receive path, mainISR
+//!        (the background loop with #undef CMD_APPLY_IN_ISR), mainISR,
+//!        background loop
+//!
+typedef struct _CMDECHO_Obj_
+{
+  volatile CMDECHO_State_e state;        //!< the stamp state
+  uint_least8_t seq;                     //!< the sequence number of the stamped command
+  uint32_t rxStamp;                      //!< the timer count when the frame was decoded
+  uint32_t applyStamp;                   //!< the timer count when the Iq reference was set
+  uint32_t pwmStamp;                     //!< the timer count after the next PWM update
+  uint32_t numEchoes;                    //!< the number of echoes sent
+} CMDECHO_Obj;
+
+
+//! \brief Defines the wheel speed reply to a torque command
+//!
+//!        The receive path latches the speed and raises the flag, the
+//!        background loop sends the reply and lowers it
+//!
+typedef struct _SPEEDREPLY_Obj_
+{
+  volatile bool flag_pending;            //!< a reply is waiting to be sent
+  uint_least8_t seq;                     //!< the sequence number of the torque command
+  _iq speed_krpm;                        //!< the motor speed when the command arrived
+  uint32_t numReplies;                   //!< the number of replies sent
+  uint32_t numSkipped;                   //!< the number of commands not answered
+} SPEEDREPLY_Obj;
+
+
+//! \brief Defines the excitation settings received over the command link
+//!
+//!        The receive path latches one Excite frame and raises the flag, the
+//!        background loop applies it, answers and lowers it.  While a run
+//!        logs, the telemetry decimation from before it is kept here.
+//!
+typedef struct _EXCITELINK_Obj_
+{
+  volatile bool flag_pending;            //!< a setting is waiting for the background loop
+  uint_least8_t seq;                     //!< the sequence number of the Excite frame
+  int32_t payload;                       //!< the Excite payload
+  uint_least8_t runSeq;                  //!< the sequence number of the frame that started the run
+  bool flag_logging;                     //!< the telemetry decimation is set for the run
+  uint_least16_t decimation[TELEM_NumChannels];  //!< the telemetry decimation before the run
+  uint32_t numTaken;                     //!< the number of settings taken
+  uint32_t numRefused;                   //!< the number of settings refused or dropped
+} EXCITELINK_Obj;
+
+
+//! \brief Defines the identified wheel model as it is published
+//!
+//!        The background loop converts the estimate for the telemetry
+//!        channels, which mainISR copies, and sends it to the Teensy in
+//!        Model frames one parameter at a time, see cmdlink.h.  The cached
+//!        values are in the telemetry units, the Model frames are scaled to
+//!        the CMDLINK_Model_e units when they are built
+//!
+typedef struct _WHEELMODEL_Obj_
+{
+  int32_t gain_krpmpsPerA;               //!< the wheel acceleration per A of Iq, krpm/s, IQ24
+  int32_t viscous_ApKrpm;                //!< the Iq that holds the viscous friction, A per krpm, IQ24
+  int32_t coulomb_A;                     //!< the Iq that holds the Coulomb friction, A, IQ24
+  uint_least16_t nextId;                 //!< the CMDLINK_Model_e sent next
+  uint_least8_t txSeq;                   //!< the next Model frame sequence number
+  uint_least32_t lastSent_ms;            //!< elapsedMillis when the last Model frame was queued
+  uint32_t numSent;                      //!< the number of Model frames sent
+} WHEELMODEL_Obj;
+
+
+//! \brief Defines the torque command handoff from the SCI-B receive path to the controller
+//!
+//!        The receive path fills the buffer that was not published last and
+//!        then publishes it, the apply side always takes the latest published
+//!        buffer.  The delay fields read in us after dividing by
+//!        USER_SYSTEM_FREQ_MHz.
+//!
+typedef struct _CMDAPPLY_Obj_
+{
+  _iq iqRef_pu[2];                       //!< the double-buffered Iq reference, pu
+  uint32_t postStamp[2];                 //!< the CPU timer count when each buffer was filled
+  volatile uint_least16_t index;         //!< the buffer published last
+  volatile bool flag_new;                //!< set on post, cleared on take
+  uint32_t numApplied;                   //!< the number of commands taken
+  uint32_t lastDelay_cnt;                //!< post to apply delay of the last command, CPU timer counts
+  uint32_t maxDelay_cnt;                 //!< worst case post to apply delay, CPU timer counts
+} CMDAPPLY_Obj;
+
+
+//! \brief Defines the background loop rate measurement
+//!
+//!        A pass is timed from the start of one while(gMotorVars.Flag_enableSys)
+//!        iteration to the start of the next, including the time mainISR
+//!        takes from it
+//!
+typedef struct _BGLOOP_Obj_
+{
+  bool flag_started;                     //!< lastStamp holds the start of a pass
+  uint32_t lastStamp;                    //!< the CPU timer count at the start of the last pass
+  uint32_t maxPass_cnt;                  //!< the longest pass since the last reset, CPU timer counts
+  uint32_t numPasses;                    //!< the passes in the current window
+  uint_least32_t windowStart_ms;         //!< elapsedMillis when the current window started
+  uint32_t rate_Hz;                      //!< the passes per second over the last window
+  volatile bool flag_reset;              //!< set to clear maxPass_cnt on the next pass
+} BGLOOP_Obj;
+
+
 
 // **************************************************************************
 // the globals
@@ -257,11 +524,24 @@ interrupt void mainISR(void);
 interrupt void sciBTxISR(void);
 interrupt void sciBRxISR(void);
 
+//! \brief Reads every byte in the SCI-B receive FIFO into the command decoder
+//!
+void drainSciBRx(void);
+
+//! \brief     Adds the friction feedforward to an Iq reference, see FRIC_FEEDFORWARD
+//! \param[in] iqRef_pu  The Iq reference, pu
+//! \return    The Iq reference with the feedforward, pu
+_iq addFriction(const _iq iqRef_pu);
+
+//! \brief     Publishes a new Iq reference for the controller, see CMDAPPLY_Obj
+//! \param[in] iqRef_A  The Iq reference, A
+void postIqRef(const _iq iqRef_A);
+
+//! \brief      Takes the Iq reference published last, and records the handoff delay
+//! \param[out] pIqRef_pu  A pointer to the Iq reference, pu, written only when a new one was posted
+//! \return     True if a new reference was posted since the last take
+bool takeIqRef(_iq *pIqRef_pu);
 
-void enqueue(char c);
-char dequeue();
-int empty();
-int full();
 
 void runCurrentReconstruction(void);
 
@@ -321,6 +601,64 @@ void updateIqRef(CTRL_Handle handle);
 void updateKpKiGains(CTRL_Handle handle);
 
 
+//! \brief     Times the background loop pass that just ended into gBgLoop, call first in every pass
+//!
+void measureBackgroundLoop(void);
+
+
+//! \brief     Loads the parameter store and applies what it holds, see PARAM_STORE
+//! \param[in] pUserParams  The user parameters, the motor parameters are replaced
+//!
+void loadParamStore(USER_Params *pUserParams);
+
+
+//! \brief     Saves the parameters to flash if they changed, call only with the PWM disabled
+//!
+void serviceParamStore(void);
+
+
+//! \brief     Marks the end of a boot phase on the gBoot timeline, repeats are ignored
+//! \param[in] phase  The phase
+//!
+void markBoot(const CMDLINK_Boot_e phase);
+
+
+//! \brief     Sends the boot timeline to the Teensy as BootMark frames once it asks, see cmdlink.h
+//!
+void serviceBootReport(void);
+
+
+//! \brief     Encodes the queued telemetry samples and queues them for the SCI-B transmit ISR
+//!
+void serviceTelemetryTx(void);
+
+
+//! \brief     Answers SCI-B baud rate requests and switches the rate, see cmdlink.h
+//!
+void serviceBaudLink(void);
+
+
+//! \brief     Runs the wheel model estimator on the windows mainISR queued and
+//!            publishes the model to the telemetry and, once valid, the Teensy
+//!
+void serviceWheelModel(void);
+
+
+//! \brief     Sends the latency stamps of a torque command back to the Teensy, see cmdlink.h
+//!
+void serviceCmdEcho(void);
+
+
+//! \brief     Sends the motor speed back to the Teensy for the full state balance law, see cmdlink.h
+//!
+void serviceSpeedReply(void);
+
+
+//! \brief     Applies and answers the excitation settings from the command link, see excite.h
+//!
+void serviceExcite(void);
+
+
 //! \brief     Runs Rs online
 //!
 void runRsOnLine(CTRL_Handle handle);
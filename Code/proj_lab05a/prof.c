@@ -0,0 +1,149 @@
+//! \file   prof.c
+//! \brief  Contains the mainISR stage profiler (PROF) functions
+//!
+
+
+// **************************************************************************
+// the includes
+
+#include "prof.h"
+
+
+// **************************************************************************
+// the defines
+
+//! \brief Defines log2 of PROF_WINDOW_LENGTH
+//!
+#define PROF_WINDOW_SHIFT           (10)
+
+
+// **************************************************************************
+// the globals
+
+
+// **************************************************************************
+// the functions
+
+void PROF_init(PROF_Obj *obj,const uint32_t period_cnt)
+{
+  obj->period_cnt = period_cnt;
+  obj->binWidth_cnt = (period_cnt + PROF_NUM_BINS - 1) / PROF_NUM_BINS;
+
+  if(obj->binWidth_cnt == 0)
+    {
+      obj->binWidth_cnt = 1;
+    }
+
+  obj->startStamp = 0;
+  obj->markStamp = 0;
+
+  PROF_reset(obj);
+
+  return;
+} // end of PROF_init() function
+
+
+void PROF_reset(PROF_Obj *obj)
+{
+  uint_least8_t stage;
+  uint_least8_t bin;
+
+
+  for(stage=0;stage<PROF_NumStages;stage++)
+    {
+      PROF_StageStats_t *pStats = &obj->stage[stage];
+
+      pStats->last_cnt = 0;
+      pStats->min_cnt = 0xFFFFFFFF;
+      pStats->max_cnt = 0;
+      pStats->mean_cnt = 0;
+      pStats->sum_cnt = 0;
+
+      for(bin=0;bin<PROF_NUM_BINS;bin++)
+        {
+          pStats->hist[bin] = 0;
+        }
+    }
+
+  obj->windowCount = 0;
+  obj->loadMean_pmil = 0;
+  obj->loadMax_pmil = 0;
+  obj->numOverruns = 0;
+  obj->flag_reset = false;
+
+  return;
+} // end of PROF_reset() function
+
+
+void PROF_record(PROF_Obj *obj,const PROF_Stage_e stage,const uint32_t time_cnt)
+{
+  PROF_StageStats_t *pStats = &obj->stage[stage];
+  uint32_t bin = time_cnt / obj->binWidth_cnt;
+
+
+  pStats->last_cnt = time_cnt;
+
+  if(time_cnt < pStats->min_cnt)
+    {
+      pStats->min_cnt = time_cnt;
+    }
+
+  if(time_cnt > pStats->max_cnt)
+    {
+      pStats->max_cnt = time_cnt;
+    }
+
+  pStats->sum_cnt += time_cnt;
+
+  if(bin >= PROF_NUM_BINS)
+    {
+      bin = PROF_NUM_BINS - 1;
+    }
+
+  pStats->hist[bin]++;
+
+  return;
+} // end of PROF_record() function
+
+
+void PROF_end(PROF_Obj *obj,const uint32_t stamp)
+{
+  uint32_t total_cnt = obj->startStamp - stamp;
+  uint_least8_t stage;
+
+
+  if(obj->flag_reset)
+    {
+      PROF_reset(obj);
+
+      return;
+    }
+
+  PROF_record(obj,PROF_Stage_Total,total_cnt);
+
+  if(total_cnt > obj->period_cnt)
+    {
+      obj->numOverruns++;
+    }
+
+  if(++obj->windowCount >= PROF_WINDOW_LENGTH)
+    {
+      obj->windowCount = 0;
+
+      for(stage=0;stage<PROF_NumStages;stage++)
+        {
+          PROF_StageStats_t *pStats = &obj->stage[stage];
+
+          pStats->mean_cnt = pStats->sum_cnt >> PROF_WINDOW_SHIFT;
+          pStats->sum_cnt = 0;
+        }
+
+      obj->loadMean_pmil = (uint_least16_t)((obj->stage[PROF_Stage_Total].mean_cnt * 1000) / obj->period_cnt);
+      obj->loadMax_pmil = (uint_least16_t)((obj->stage[PROF_Stage_Total].max_cnt * 1000) / obj->period_cnt);
+    }
+
+  return;
+} // end of PROF_end() function
+
+
+// end of file
@@ -0,0 +1,164 @@
+#ifndef _PROF_H_
+#define _PROF_H_
+
+//! \file   prof.h
+//! \brief  Contains the public interface to the mainISR stage profiler (PROF)
+//!
+//!         The profiler is fed raw counts of a free running, down counting
+//!         CPU timer.  PROF_start() is called on ISR entry, PROF_mark() after
+//!         each stage and PROF_end() last.  Every stage keeps its last, min,
+//!         max and mean time and a coarse histogram, in timer counts, and the
+//!         whole ISR is kept as PROF_Stage_Total together with the load
+//!         against the ISR period.  Means and loads are refreshed every
+//!         PROF_WINDOW_LENGTH ISR ticks.
+//!
+//!         The interrupt entry and context save happen before PROF_start()
+//!         and are not counted.
+//!
+//!         The module has no device specific includes and builds on the host.
+
+
+// **************************************************************************
+// the includes
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+//!
+//!
+//! \defgroup PROF PROF
+//!
+//@{
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+// **************************************************************************
+// the defines
+
+//! \brief Defines the number of histogram bins, each 1/PROF_NUM_BINS of the
+//!        ISR period wide, the last bin also counts overruns
+//!
+#define PROF_NUM_BINS               (8)
+
+//! \brief Defines the number of ISR ticks per mean and load update, must be a power of two
+//!
+#define PROF_WINDOW_LENGTH          (1024)
+
+
+// **************************************************************************
+// the typedefs
+
+//! \brief Enumeration for the profiled stages, in mainISR order
+//!
+typedef enum
+{
+  PROF_Stage_Entry=0,            //!< millisecond tasks, LED and ADC acknowledge
+  PROF_Stage_Excite,             //!< command handoff, EXCITE_run(), FRIC_run() and the Iq reference update
+  PROF_Stage_ReadAdc,            //!< HAL_readAdcData()
+  PROF_Stage_CtrlRun,            //!< CTRL_run()
+  PROF_Stage_WritePwm,           //!< HAL_writePwmData()
+  PROF_Stage_CtrlSetup,          //!< CTRL_setup()
+  PROF_Stage_Telem,              //!< telemetry sample capture and the wheel model window sums
+  PROF_Stage_Total,              //!< the whole ISR, PROF_start() to PROF_end()
+  PROF_NumStages                 //!< the number of stages
+} PROF_Stage_e;
+
+
+//! \brief Defines the statistics of one stage, CPU timer counts
+//!
+typedef struct _PROF_StageStats_t_
+{
+  uint32_t  last_cnt;                    //!< the last time
+  uint32_t  min_cnt;                     //!< the shortest time since the last reset
+  uint32_t  max_cnt;                     //!< the longest time since the last reset
+  uint32_t  mean_cnt;                    //!< the mean time over the last window
+  uint32_t  sum_cnt;                     //!< the running sum over the current window
+  uint32_t  hist[PROF_NUM_BINS];         //!< the number of times in each bin
+} PROF_StageStats_t;
+
+
+//! \brief Defines the profiler object
+//!
+typedef struct _PROF_Obj_
+{
+  PROF_StageStats_t stage[PROF_NumStages];   //!< the stage statistics, indexed by stage
+
+  uint32_t  period_cnt;                      //!< the ISR period, CPU timer counts
+  uint32_t  binWidth_cnt;                    //!< the histogram bin width, CPU timer counts
+
+  uint32_t  startStamp;                      //!< the timer count at PROF_start()
+  uint32_t  markStamp;                       //!< the timer count at the last mark
+
+  uint_least16_t windowCount;                //!< ISR ticks in the current window
+  uint_least16_t loadMean_pmil;              //!< mean ISR load over the last window, 0.1 %
+  uint_least16_t loadMax_pmil;               //!< longest ISR since the last reset against the period, 0.1 %
+  uint32_t  numOverruns;                     //!< the number of ISRs longer than the period
+
+  volatile bool flag_reset;                  //!< set to clear the statistics on the next PROF_end()
+} PROF_Obj;
+
+
+// **************************************************************************
+// the function prototypes
+
+//! \brief     Initializes the profiler
+//! \param[in] obj         A pointer to the profiler object
+//! \param[in] period_cnt  The ISR period, CPU timer counts
+extern void PROF_init(PROF_Obj *obj,const uint32_t period_cnt);
+
+
+//! \brief     Clears the statistics, keeping the period
+//! \param[in] obj  A pointer to the profiler object
+extern void PROF_reset(PROF_Obj *obj);
+
+
+//! \brief     Records one stage time, used by PROF_mark() and PROF_end()
+//! \param[in] obj    A pointer to the profiler object
+//! \param[in] stage  The stage
+//! \param[in] time_cnt  The stage time, CPU timer counts
+extern void PROF_record(PROF_Obj *obj,const PROF_Stage_e stage,const uint32_t time_cnt);
+
+
+//! \brief     Starts profiling one ISR
+//! \param[in] obj    A pointer to the profiler object
+//! \param[in] stamp  The CPU timer count
+static inline void PROF_start(PROF_Obj *obj,const uint32_t stamp)
+{
+  obj->startStamp = stamp;
+  obj->markStamp = stamp;
+
+  return;
+} // end of PROF_start() function
+
+
+//! \brief     Ends a stage and starts the next one
+//! \param[in] obj    A pointer to the profiler object
+//! \param[in] stage  The stage that just ended
+//! \param[in] stamp  The CPU timer count
+static inline void PROF_mark(PROF_Obj *obj,const PROF_Stage_e stage,const uint32_t stamp)
+{
+  // the timer counts down
+  PROF_record(obj,stage,obj->markStamp - stamp);
+  obj->markStamp = stamp;
+
+  return;
+} // end of PROF_mark() function
+
+
+//! \brief     Ends profiling one ISR, records the total and updates the load
+//! \param[in] obj    A pointer to the profiler object
+//! \param[in] stamp  The CPU timer count
+extern void PROF_end(PROF_Obj *obj,const uint32_t stamp);
+
+
+#ifdef __cplusplus
+}
+#endif // extern "C"
+
+//@} // ingroup
+#endif // end of _PROF_H_ definition
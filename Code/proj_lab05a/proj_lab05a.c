@@ -53,6 +53,10 @@
 
 #ifdef FLASH
 #pragma CODE_SECTION(mainISR,"ramfuncs");
+#pragma CODE_SECTION(drainSciBRx,"ramfuncs");
+#pragma CODE_SECTION(postIqRef,"ramfuncs");
+#pragma CODE_SECTION(takeIqRef,"ramfuncs");
+#pragma CODE_SECTION(addFriction,"ramfuncs");
 #endif
 
 // Include header files used in the main function
@@ -63,12 +67,15 @@
 
 #define LED_BLINK_FREQ_Hz   5
 
+//! \brief Defines when the forced angle is turned off after reset, ms
+//!
+#define FORCE_ANGLE_OFF_ms  6100
+
 
 // **************************************************************************
 // the globals
 
 uint_least16_t gCounter_updateGlobals = 0;
-uint_least16_t gCounter_print = 0;
 uint_least16_t gCounter_txdone = 0;
 uint_least16_t gCounter_millis = 0;
 uint_least32_t elapsedMillis = 0;
@@ -106,6 +113,52 @@ uint16_t gLEDcnt = 0;
 
 volatile MOTOR_Vars_t gMotorVars = MOTOR_Vars_INIT;
 
+SCIB_RxStats_t gSciBRxStats = {0,0,0,0,0,0};
+
+TELEM_Obj gTelem;
+
+uint_least8_t gTxBuf[TX_QUEUE_SIZE];
+
+RINGBUF_Obj gTxQueue;
+
+#ifdef CMDLINK_ASCII
+CMDPARSE_Obj gCmdParser;
+#else
+CMDLINK_Decoder_t gCmdDecoder;
+
+uint_least8_t gCmdSeq = 0;
+
+SCIB_BaudLink_t gBaudLink = {SCIB_BaudState_Idle,false,false,0,0,BAUD_DEFAULT_RATE,0,0,0,0};
+
+CMDECHO_Obj gCmdEcho = {CMDECHO_State_Idle,0,0,0,0,0};
+
+SPEEDREPLY_Obj gSpeedReply = {false,0,0,0,0};
+#endif
+
+CMDAPPLY_Obj gCmdApply = {{0,0},{0,0},0,false,0,0,0};
+
+EXCITE_Obj gExcite;
+
+#ifndef CMDLINK_ASCII
+EXCITELINK_Obj gExciteLink = {false,0,0,0,false,{0},0,0};
+#endif
+
+WHEELID_Obj gWheelId;
+
+WHEELMODEL_Obj gWheelModel = {0,0,0,0,0,0,0};
+
+// the last torque command taken and the excitation on top of it, pu
+_iq gIqCmd_pu = _IQ(0.0);
+
+_iq gExciteIq_pu = _IQ(0.0);
+
+// the friction feedforward, and its Iq at the last speed estimate, pu
+FRIC_Obj gFric;
+
+_iq gFricIq_pu = _IQ(0.0);
+
+PROF_Obj gProf;
+
 #ifdef FLASH
 // Used for running BackGround in flash, and ISR in RAM
 extern uint16_t *RamfuncsLoadStart, *RamfuncsLoadEnd, *RamfuncsRunStart;
@@ -125,6 +178,22 @@ DRV_SPI_8301_Vars_t gDrvSpi8301Vars;
 #ifdef DRV8305_SPI
 // Watch window interface to the 8305 SPI
 DRV_SPI_8305_Vars_t gDrvSpi8305Vars;
+
+#ifdef DRV_SPI_QUEUE
+// the 8305 SPI transactions the background loop runs without waiting
+DRVSPI_Obj gDrvSpi;
+#endif
+#endif
+
+// the background loop rate, to see what the loop services cost
+BGLOOP_Obj gBgLoop;
+
+// the time each boot phase ended, from HAL_init() on
+BOOT_Obj gBoot;
+
+#ifdef PARAM_STORE
+// the biases and motor parameters kept in flash across resets
+PSTORE_Obj gParamStore;
 #endif
 
 _iq gFlux_pu_to_Wb_sf;
@@ -173,6 +242,17 @@ void main(void)
   halHandle = HAL_init(&hal,sizeof(hal));
 
 
+  // start the free running CPU timer used for time stamps, the reset period
+  // and prescaler are the ones HAL_setupTimers() sets later
+  HAL_reloadTimer(halHandle,CPU_TIME_TIMER_NUMBER);
+  HAL_startTimer(halHandle,CPU_TIME_TIMER_NUMBER);
+
+
+  // time the boot phases from here
+  BOOT_init(&gBoot,HAL_readTimerCnt(halHandle,CPU_TIME_TIMER_NUMBER),(uint32_t)USER_SYSTEM_FREQ_MHz);
+  markBoot(CMDLINK_Boot_HalInit);
+
+
   // check for errors in user parameters
   USER_checkForErrors(&gUserParams);
 
@@ -190,14 +270,30 @@ void main(void)
         }
     }
 
+  markBoot(CMDLINK_Boot_UserCheck);
+
 
   // initialize the user parameters
   USER_setParams(&gUserParams);
 
 
+#ifdef PARAM_STORE
+  // replace them with what an earlier run calibrated and identified
+  loadParamStore(&gUserParams);
+#endif
+
+  markBoot(CMDLINK_Boot_UserParams);
+
+
   // set the hardware abstraction layer parameters
   HAL_setParams(halHandle,&gUserParams);
 
+  markBoot(CMDLINK_Boot_HalParams);
+
+
+  // initialize the mainISR profiler against the ISR period
+  PROF_init(&gProf,(uint32_t)(USER_ISR_PERIOD_usec * USER_SYSTEM_FREQ_MHz));
+
 
   // initialize the controller
 #ifdef FAST_ROM_V1p6
@@ -221,6 +317,8 @@ void main(void)
   // set the default controller parameters
   CTRL_setParams(ctrlHandle,&gUserParams);
 
+  markBoot(CMDLINK_Boot_CtrlInit);
+
   /*datalogHandle = DATALOG_init(&datalog,sizeof(datalog));
 
     datalog.iptr[0] = &gMotorVars.Speed_krpm;        // datalogBuff[0]
@@ -242,12 +340,44 @@ void main(void)
   // enable the ADC interrupts
   HAL_enableAdcInts(halHandle);
 
+  // initialize the SCI-B transmit queue
+  RINGBUF_init(&gTxQueue,gTxBuf,TX_QUEUE_SIZE);
+
+  // initialize the telemetry stream, the other channels can be turned on
+  // from the watch window by setting gTelem.decimation
+  TELEM_init(&gTelem);
+  TELEM_setDecimation(&gTelem,TELEM_Channel_Speed_krpm,TELEM_DEFAULT_DECIMATION);
+  TELEM_setDecimation(&gTelem,TELEM_Channel_Iq_A,TELEM_DEFAULT_DECIMATION);
+  TELEM_setDecimation(&gTelem,TELEM_Channel_IqRef_A,TELEM_DEFAULT_DECIMATION);
+
+  // initialize the excitation generator, idle until started over the command link
+  EXCITE_init(&gExcite,(uint32_t)USER_ISR_FREQ_Hz,(int32_t)(USER_IQ_FULL_SCALE_CURRENT_A * 1000.0));
+
+  // load the friction feedforward table from flash
+  FRIC_init(&gFric,&gFricTable);
+
+  // initialize the wheel model estimator and stream what it finds
+  WHEELID_init(&gWheelId,USER_ISR_FREQ_Hz,WHEELID_DECIMATION);
+  TELEM_setDecimation(&gTelem,TELEM_Channel_WheelGain_krpmpsPerA,TELEM_MODEL_DECIMATION);
+  TELEM_setDecimation(&gTelem,TELEM_Channel_WheelViscous_ApKrpm,TELEM_MODEL_DECIMATION);
+  TELEM_setDecimation(&gTelem,TELEM_Channel_WheelCoulomb_A,TELEM_MODEL_DECIMATION);
+
+#ifdef CMDLINK_ASCII
+  // initialize the streaming ASCII command parser
+  CMDPARSE_init(&gCmdParser);
+#else
+  // initialize the torque command frame decoder
+  CMDLINK_initDecoder(&gCmdDecoder);
+#endif
+
   // enable the Sci interrupts
   HAL_enableSciInts(halHandle);
 
   // enable global interrupts
   HAL_enableGlobalInts(halHandle);
 
+  markBoot(CMDLINK_Boot_IntsOn);
+
 
   // enable debug interrupts
   HAL_enableDebugInt(halHandle);
@@ -269,7 +399,14 @@ void main(void)
   HAL_enableDrv(halHandle);
   // initialize the DRV8305 interface
   HAL_setupDrvSpi(halHandle,&gDrvSpi8305Vars);
+
+#ifdef DRV_SPI_QUEUE
+  // poll the DRV8305 from here on without blocking
+  HAL_setupDrvSpiQueue(halHandle,&gDrvSpi,&gDrvSpi8305Vars,elapsedMillis);
 #endif
+#endif
+
+  markBoot(CMDLINK_Boot_DrvSpi);
 
 
   // enable DC bus compensation
@@ -291,11 +428,23 @@ void main(void)
     // Dis-able the Library internal PI.  Iq has no reference now
     CTRL_setFlag_enableSpeedCtrl(ctrlHandle, false);
 
+    // the first pass only starts the rate measurement
+    gBgLoop.flag_started = false;
+
     // loop while the enable system flag is true
     while(gMotorVars.Flag_enableSys)
       {
         CTRL_Obj *obj = (CTRL_Obj *)ctrlHandle;
 
+        measureBackgroundLoop();
+
+        markBoot(CMDLINK_Boot_LoopStart);
+
+        if(gSciBRxStats.numCmds != 0)
+          {
+            markBoot(CMDLINK_Boot_FirstTorque);
+          }
+
         // increment counters
         gCounter_updateGlobals++;
 
@@ -336,6 +485,8 @@ void main(void)
                   {
                     // enable the PWM
                     HAL_enablePwm(halHandle);
+
+                    markBoot(CMDLINK_Boot_OffLine);
                   }
                 else if(ctrlState == CTRL_State_OnLine)
                   {
@@ -344,6 +495,19 @@ void main(void)
                       // update the ADC bias values
                       HAL_updateAdcBias(halHandle);
                     }
+#ifdef PARAM_STORE
+                    else if(gParamStore.params.flags & PSTORE_Flag_Bias)
+                    {
+                      uint_least8_t cnt;
+
+                      // set the biases the last offset calibration saved
+                      for(cnt=0;cnt<3;cnt++)
+                      {
+                        HAL_setBias(halHandle,HAL_SensorType_Current,cnt,(_iq)gParamStore.params.I_bias[cnt]);
+                        HAL_setBias(halHandle,HAL_SensorType_Voltage,cnt,(_iq)gParamStore.params.V_bias[cnt]);
+                      }
+                    }
+#endif
                     else
                     {
                       // set the current bias
@@ -367,14 +531,29 @@ void main(void)
                     gMotorVars.V_bias.value[1] = HAL_getBias(halHandle,HAL_SensorType_Voltage,1);
                     gMotorVars.V_bias.value[2] = HAL_getBias(halHandle,HAL_SensorType_Voltage,2);
 
+#ifdef PARAM_STORE
+                    if(gMotorVars.Flag_enableOffsetcalc == true)
+                    {
+                      // keep the calibration for the next start
+                      PSTORE_setBias(&gParamStore,(const int32_t *)gMotorVars.I_bias.value,(const int32_t *)gMotorVars.V_bias.value);
+                    }
+#endif
+
                     // enable the PWM
                     HAL_enablePwm(halHandle);
+
+                    markBoot(CMDLINK_Boot_OnLine);
                   }
                 else if(ctrlState == CTRL_State_Idle)
                   {
                     // disable the PWM
                     HAL_disablePwm(halHandle);
                     gMotorVars.Flag_Run_Identify = false;
+
+#ifdef PARAM_STORE
+                    // save what changed while the PWM is off
+                    serviceParamStore();
+#endif
                   }
 
                 if((CTRL_getFlag_enableUserMotorParams(ctrlHandle) == true) &&
@@ -405,6 +584,15 @@ void main(void)
               // initialize the watch window kp and ki current values with pre-calculated values
               gMotorVars.Kp_Idq = CTRL_getKp(ctrlHandle,CTRL_Type_PID_Id);
               gMotorVars.Ki_Idq = CTRL_getKi(ctrlHandle,CTRL_Type_PID_Id);
+
+#ifdef PARAM_STORE
+              // keep what the identification found for the next start
+              if(gMotorVars.Flag_enableUserParams == false)
+              {
+                PSTORE_setMotor(&gParamStore,EST_getRs_Ohm(obj->estHandle),EST_getLs_d_H(obj->estHandle),
+                                EST_getLs_q_H(obj->estHandle),EST_getFlux_VpHz(obj->estHandle));
+              }
+#endif
             }
 
           }
@@ -434,6 +622,30 @@ void main(void)
         // update Kp and Ki gains
         updateKpKiGains(ctrlHandle);
 
+#ifndef CMDLINK_ASCII
+        // answer baud rate requests from the Teensy
+        serviceBaudLink();
+
+        // answer the last torque command with the motor speed, ahead of the
+        // echo since the balance law waits on it
+        serviceSpeedReply();
+
+        // echo the latency stamps of the last stamped torque command
+        serviceCmdEcho();
+
+        // apply and answer the excitation settings
+        serviceExcite();
+
+        // send the boot timeline once the Teensy asks for it
+        serviceBootReport();
+#endif
+
+        // identify the wheel model from the windows mainISR queued
+        serviceWheelModel();
+
+        // encode and queue any telemetry captured by mainISR
+        serviceTelemetryTx();
+
         // enable/disable the forced angle
         EST_setFlag_enableForceAngle(obj->estHandle,gMotorVars.Flag_enableForceAngle);
 
@@ -446,9 +658,14 @@ void main(void)
         HAL_readDrvData(halHandle,&gDrvSpi8301Vars);
 #endif
 #ifdef DRV8305_SPI
+#ifdef DRV_SPI_QUEUE
+        // at most one DRV8305 transfer per pass, the reply is taken on a later one
+        HAL_runDrvSpi(halHandle,&gDrvSpi,&gDrvSpi8305Vars,elapsedMillis);
+#else
         HAL_writeDrvData(halHandle,&gDrvSpi8305Vars);
 
         HAL_readDrvData(halHandle,&gDrvSpi8305Vars);
+#endif
 #endif
       } // end of while(gFlag_enableSys) loop
 
@@ -456,6 +673,11 @@ void main(void)
     // disable the PWM
     HAL_disablePwm(halHandle);
 
+#ifdef PARAM_STORE
+    // save what changed while the PWM is off
+    serviceParamStore();
+#endif
+
     // set the default controller parameters (Reset the control to re-identify the motor)
     CTRL_setParams(ctrlHandle,&gUserParams);
     gMotorVars.Flag_Run_Identify = false;
@@ -464,37 +686,32 @@ void main(void)
 
 } // end of main() function
 
-//#define STEP_RES
-//#define SINE_RES
-#define START_RES  6000
-#define LEN_RES    2000
-#define END_RES    START_RES+LEN_RES
-
-#define END_CONTROL_GAP 5000
-#define END_CONTROL     END_CONTROL_GAP+END_RES
-
-#define SINE_AMPL   (double)5.0
-
 interrupt void mainISR(void)
 {
+    PROFILE_START();
+
     gCounter_millis++;
     if(gCounter_millis >= USER_ISR_FREQ_Hz / 1000) { // 1000 millis per second
         gCounter_millis = 0;
         elapsedMillis++;
 
-        if(elapsedMillis>(START_RES+100)) gMotorVars.Flag_enableForceAngle = false;
-#ifdef STEP_RES
-        if(elapsedMillis>START_RES && elapsedMillis<END_RES) gMotorVars.IqRef_A = _IQ(15.0);
-        else if(elapsedMillis>=END_RES) gMotorVars.IqRef_A = _IQ(0.0);
-        if(elapsedMillis>=END_CONTROL) gMotorVars.Flag_Run_Identify = false;
-#endif
+        if(elapsedMillis>FORCE_ANGLE_OFF_ms) gMotorVars.Flag_enableForceAngle = false;
 
-#ifdef SINE_RES
-        if(elapsedMillis>START_RES && elapsedMillis<END_RES) {
-            gMotorVars.IqRef_A = _IQ(SINE_AMPL*sin((double)(elapsedMillis-START_RES)*(double)(elapsedMillis-START_RES+2500)/(double)1000000.0));
+        // the RX FIFO only interrupts when full, so flush a partial fill
+        // that has not grown for a millisecond
+        {
+            uint_least16_t level = SCI_getRxFifoStatus(halHandle->sciBHandle) >> 8;
+
+            if(level != 0 && level == gSciBRxStats.lastLevel)
+            {
+                gSciBRxStats.numTimeouts++;
+                drainSciBRx();
+                level = 0;
+            }
+            gSciBRxStats.lastLevel = level;
         }
-        else if(elapsedMillis>=END_RES) gMotorVars.IqRef_A = _IQ(0.0);
-        if(elapsedMillis>=END_CONTROL) gMotorVars.Flag_Run_Identify = false;
+#ifndef CMDLINK_ASCII
+        if(gBaudLink.timer_ms != 0) gBaudLink.timer_ms--;
 #endif
     }
 
@@ -509,155 +726,672 @@ interrupt void mainISR(void)
   // acknowledge the ADC interrupt
   HAL_acqAdcInt(halHandle,ADC_IntNumber_1);
 
+  PROFILE_MARK(PROF_Stage_Entry);
+
+
+#ifdef CMD_APPLY_IN_ISR
+  // take a torque command posted since the last tick
+  {
+    _iq iqRef_pu;
+
+    if(takeIqRef(&iqRef_pu))
+      {
+        gIqCmd_pu = iqRef_pu;
+      }
+  }
+#endif
+
+  // on the first tick of an excitation run only its channels stream, all
+  // from this tick on, so every frame has the input and the response
+  if(gExcite.state == EXCITE_State_Armed && gExcite.logDecimation != 0)
+    {
+      uint_least16_t cnt;
+
+      for(cnt=0;cnt<TELEM_NumChannels;cnt++)
+        {
+          TELEM_setDecimation(&gTelem,(TELEM_Channel_e)cnt,
+                              (EXCITE_LOG_CHANNELS & (1 << cnt)) ? gExcite.logDecimation : 0);
+        }
+    }
+
+  gExciteIq_pu = _IQmpy(_IQ24toIQ(EXCITE_run(&gExcite)),_IQ(1.0/USER_IQ_FULL_SCALE_CURRENT_A));
+
+#ifdef FRIC_FEEDFORWARD
+  // the friction at the speed estimate of the last tick
+  gFricIq_pu = _IQmpy(_IQ24toIQ(FRIC_run(&gFric,_IQtoIQ24(EST_getSpeed_krpm(((CTRL_Obj *)ctrlHandle)->estHandle)),
+                                         _IQtoIQ24(EST_getAngle_pu(((CTRL_Obj *)ctrlHandle)->estHandle)))),
+                      _IQ(1.0/USER_IQ_FULL_SCALE_CURRENT_A));
+#endif
+
+#ifdef CMD_APPLY_IN_ISR
+  // the command with the feedforward and the excitation go to the current
+  // controller every tick
+  CTRL_setIq_ref_pu(ctrlHandle,addFriction(gIqCmd_pu) + gExciteIq_pu);
+#endif
+
+  PROFILE_MARK(PROF_Stage_Excite);
+
 
   // convert the ADC data
   HAL_readAdcData(halHandle,&gAdcData);
 
+  PROFILE_MARK(PROF_Stage_ReadAdc);
+
 
   // run the controller
   CTRL_run(ctrlHandle,halHandle,&gAdcData,&gPwmData);
 
+  PROFILE_MARK(PROF_Stage_CtrlRun);
+
 
   // write the PWM compare values
   HAL_writePwmData(halHandle,&gPwmData);
 
+  PROFILE_MARK(PROF_Stage_WritePwm);
+
+#ifndef CMDLINK_ASCII
+  // first PWM update carrying the stamped torque command
+  if(gCmdEcho.state == CMDECHO_State_Applied)
+    {
+      gCmdEcho.pwmStamp = HAL_readTimerCnt(halHandle,CPU_TIME_TIMER_NUMBER);
+      gCmdEcho.state = CMDECHO_State_Done;
+    }
+#endif
+
 
   // setup the controller
   CTRL_setup(ctrlHandle);
 
+  PROFILE_MARK(PROF_Stage_CtrlSetup);
+
   //DATALOG_update(datalogHandle);
-  gCounter_print++;
-  if (gCounter_print >= USER_ISR_FREQ_Hz / USER_PRINT_FREQ_Hz)
-    {
-        gCounter_print = 0;
-        //gMotorVars.IqRef_A = 0;
-        if (gMotorVars.IqRef_A != 0)
-        {
-            char message[20]; // initialize a char array for the message
-            //char currentMessage[15];
-            _IQtoa(message, "%2.3f", gMotorVars.Speed_krpm); // put the variable into the char array as a string
-            //_IQtoa(currentMessage, "%2.3f", gMotorVars.IqRef_A);
-            //strcat(message, ",");
-            //strcat(message, currentMessage);
-            strcat(message, "\n"); // add line endings to the char array
-
-            int i = 0;
-            while (message[i] != '\0')
-            { // queue each char
-                enqueue(message[i]);
-                i++;
-            }
-            SCI_putDataBlocking(halHandle->sciBHandle, dequeue()); // put the first char to start the flow
-            // Blocking shouldn't actually block at this point of the program,
-            // as long as the queue has been cleared
-        }
-    }
+
+  // only sum the wheel model windows and copy the due telemetry channels
+  // here, the background loop runs the estimate and encodes the frames
+  {
+    const int32_t iq = _IQtoIQ24(_IQmpy(CTRL_getIq_in_pu(ctrlHandle),_IQ(USER_IQ_FULL_SCALE_CURRENT_A)));
+    uint_least16_t mask = TELEM_getDueMask(&gTelem);
+
+    WHEELID_putTick(&gWheelId,iq,_IQtoIQ24(EST_getSpeed_krpm(((CTRL_Obj *)ctrlHandle)->estHandle)),
+                    CTRL_getState(ctrlHandle) == CTRL_State_OnLine);
+
+    if(mask)
+      {
+        int32_t values[TELEM_NumChannels];
+
+        values[TELEM_Channel_Speed_krpm] = _IQtoIQ24(gMotorVars.Speed_krpm);
+        values[TELEM_Channel_Iq_A] = iq;
+        values[TELEM_Channel_IqRef_A] = _IQtoIQ24(gMotorVars.IqRef_A);
+        values[TELEM_Channel_VdcBus_kV] = _IQtoIQ24(_IQmpy(gAdcData.dcBus,_IQ(USER_IQ_FULL_SCALE_VOLTAGE_V/1000.0)));
+        values[TELEM_Channel_Torque_Nm] = _IQtoIQ24(gMotorVars.Torque_Nm);
+        values[TELEM_Channel_Vd_pu] = _IQtoIQ24(CTRL_getVd_out_pu(ctrlHandle));
+        values[TELEM_Channel_Vq_pu] = _IQtoIQ24(CTRL_getVq_out_pu(ctrlHandle));
+        values[TELEM_Channel_Excite_A] = gExcite.value;
+        values[TELEM_Channel_WheelGain_krpmpsPerA] = gWheelModel.gain_krpmpsPerA;
+        values[TELEM_Channel_WheelViscous_ApKrpm] = gWheelModel.viscous_ApKrpm;
+        values[TELEM_Channel_WheelCoulomb_A] = gWheelModel.coulomb_A;
+
+        TELEM_putSample(&gTelem,mask,values);
+      }
+  }
+
+  PROFILE_MARK(PROF_Stage_Telem);
+  PROFILE_END();
 
   return;
 } // end of mainISR() function
 
 
-#define QUEUE_SIZE 200
-int qbegin=0, qend=0;
-char queue[QUEUE_SIZE];
-int empty() { return qbegin==qend; }
-int full() { return ((qend+1)%QUEUE_SIZE)==qbegin; }
-void enqueue(char c) {
-    if (!full()) {
-        queue[qend]=c; qend=(qend+1)%QUEUE_SIZE;
-    }
-}
-char dequeue() {
-    if (!empty()) {
-        char out = queue[qbegin]; qbegin=(qbegin+1)%QUEUE_SIZE;
-        return out;
-    } else {
-        return 0;
-    }
-}
-
-#define QUEUE_SIZE_two 200
-int qbegin_two=0, qend_two=0;
-char queue_two[QUEUE_SIZE_two];
-int empty_two() { return qbegin_two==qend_two; }
-int full_two() { return ((qend_two+1)%QUEUE_SIZE_two)==qbegin_two; }
-void enqueue_two(char c) {
-    if (!full_two()) {
-        queue_two[qend_two]=c; qend_two=(qend_two+1)%QUEUE_SIZE_two;
-    }
-}
-char dequeue_two() {
-    if (!empty_two()) {
-        char out_two = queue_two[qbegin_two]; qbegin_two=(qbegin_two+1)%QUEUE_SIZE_two;
-        return out_two;
+void measureBackgroundLoop(void) {
+    const uint32_t stamp = HAL_readTimerCnt(halHandle,CPU_TIME_TIMER_NUMBER);
+    const uint_least32_t now_ms = elapsedMillis;
+
+    if(!gBgLoop.flag_started) {
+        gBgLoop.flag_started = true;
+        gBgLoop.numPasses = 0;
+        gBgLoop.windowStart_ms = now_ms;
     } else {
-        return 0;
+        // the timer counts down
+        const uint32_t pass_cnt = gBgLoop.lastStamp - stamp;
+
+        if(gBgLoop.flag_reset) {
+            gBgLoop.maxPass_cnt = 0;
+            gBgLoop.flag_reset = false;
+        }
+        if(pass_cnt > gBgLoop.maxPass_cnt) {
+            gBgLoop.maxPass_cnt = pass_cnt;
+        }
+        gBgLoop.numPasses++;
     }
-}
-int qlength_two() {
-    if(qend_two<qbegin_two) return (QUEUE_SIZE_two - qbegin_two + qend_two);
-    else return (qend_two-qbegin_two);
-}
+    gBgLoop.lastStamp = stamp;
 
-//! \brief the ISR for SCI-B receive interrupt
+    if((now_ms - gBgLoop.windowStart_ms) >= BGLOOP_WINDOW_ms) {
+        gBgLoop.rate_Hz = gBgLoop.numPasses * 1000 / (now_ms - gBgLoop.windowStart_ms);
+        gBgLoop.numPasses = 0;
+        gBgLoop.windowStart_ms = now_ms;
+    }
+} // end of measureBackgroundLoop() function
+
+
+void markBoot(const CMDLINK_Boot_e phase) {
+    BOOT_mark(&gBoot, phase, HAL_readTimerCnt(halHandle,CPU_TIME_TIMER_NUMBER));
+} // end of markBoot() function
+
+
+void loadParamStore(USER_Params *pUserParams) {
+    PSTORE_init(&gParamStore);
+
+    if(!PSTORE_load(&gParamStore,(const uint16_t *)HAL_PARAM_FLASH_ADDR)) {
+        return;
+    }
+
+    if(gParamStore.params.flags & PSTORE_Flag_Motor) {
+        pUserParams->motor_Rs = gParamStore.params.Rs_Ohm;
+        pUserParams->motor_Ls_d = gParamStore.params.Ls_d_H;
+        pUserParams->motor_Ls_q = gParamStore.params.Ls_q_H;
+        pUserParams->motor_ratedFlux = gParamStore.params.ratedFlux_VpHz;
+    }
+
+    // the saved biases stand in for the offset calibration and its OffLine wait
+    if(gParamStore.params.flags & PSTORE_Flag_Bias) {
+        gMotorVars.Flag_enableOffsetcalc = false;
+    }
+} // end of loadParamStore() function
+
+
+void serviceParamStore(void) {
+    uint16_t record[PSTORE_RECORD_WORDS];
+    uint_least16_t slot;
+    bool flag_erase;
+    bool flag_ok;
+
+    // mainISR is held off while the flash is busy, which only the Idle
+    // controller can take
+    if(CTRL_getState(ctrlHandle) != CTRL_State_Idle) {
+        return;
+    }
+
+    if(!PSTORE_prepare(&gParamStore,record,&slot,&flag_erase)) {
+        return;
+    }
+
+    flag_ok = HAL_writeParamRecord(halHandle,slot,flag_erase,record);
+
+    PSTORE_commit(&gParamStore,slot,flag_erase,flag_ok);
+} // end of serviceParamStore() function
+
+
+void serviceTelemetryTx(void) {
+    uint_least8_t frame[TELEM_MAX_FRAME_LENGTH];
+    uint_least16_t length;
+    bool queued = false;
+
+#ifndef CMDLINK_ASCII
+    // hold telemetry back while the baud rate changes, so the transmitter drains
+    if(gBaudLink.state != SCIB_BaudState_Idle) {
+        return;
+    }
+#endif
+
+    // only encode when a whole frame is sure to fit, otherwise the samples
+    // wait in the telemetry queue
+    while(RINGBUF_getSpace(&gTxQueue) >= TELEM_MAX_FRAME_LENGTH &&
+          (length = TELEM_encode(&gTelem, frame)) != 0) {
+        RINGBUF_pushBlock(&gTxQueue, frame, length);
+        queued = true;
+    }
+
+    if(queued) {
+        // the TX ISR refills the FIFO from the queue, never blocking here
+        SCI_enableTxFifoInt(halHandle->sciBHandle);
+    }
+} // end of serviceTelemetryTx() function
+
+#ifndef CMDLINK_ASCII
+//! \brief Queues one CMDLINK reply frame for the SCI-B transmit ISR
+static void queueCmdFrame(const uint_least8_t seq,const CMDLINK_Type_e type,const int32_t payload) {
+    CMDLINK_Frame_t frame;
+    uint_least8_t buf[CMDLINK_FRAME_LENGTH];
+
+    frame.seq = seq;
+    frame.type = type;
+    frame.payload = payload;
+
+    CMDLINK_encode(buf, &frame);
+    RINGBUF_pushBlock(&gTxQueue, buf, CMDLINK_FRAME_LENGTH);
+    SCI_enableTxFifoInt(halHandle->sciBHandle);
+} // end of queueCmdFrame() function
+
+//! \brief Queues one baud rate handshake reply
+static void queueBaudReply(const CMDLINK_Type_e type,const int32_t payload) {
+    queueCmdFrame(gBaudLink.txSeq, type, payload);
+    gBaudLink.txSeq = (gBaudLink.txSeq + 1) & 0xFF;
+} // end of queueBaudReply() function
+
+//! \brief Switches the SCI-B baud rate and drops anything half received at the old one
+static void switchSciBBaudRate(const uint32_t rate) {
+    HAL_disableGlobalInts(halHandle);
+    HAL_setSciBBaudRate(halHandle, rate);
+    SCI_resetRxFifo(halHandle->sciBHandle);
+    gCmdDecoder.length = 0;
+    HAL_enableGlobalInts(halHandle);
+} // end of switchSciBBaudRate() function
+
+void serviceBaudLink(void) {
+    BAUD_Config_t config;
+
+    switch(gBaudLink.state) {
+    case SCIB_BaudState_Idle:
+        if(gBaudLink.flag_request && RINGBUF_getSpace(&gTxQueue) >= CMDLINK_FRAME_LENGTH) {
+            if(BAUD_compute(HAL_LSPCLK_FREQ_Hz, gBaudLink.requestedRate, &config)) {
+                // answer at the old rate, switch once the answer is out
+                queueBaudReply(CMDLINK_Type_BaudAck, (int32_t)config.actual);
+                gBaudLink.previousRate = halHandle->sciBBaud.rate;
+                gBaudLink.state = SCIB_BaudState_Switching;
+            }
+            else {
+                queueBaudReply(CMDLINK_Type_BaudNack, (int32_t)halHandle->sciBBaud.actual);
+                gBaudLink.numNacks++;
+            }
+            gBaudLink.flag_request = false;
+        }
+        break;
+
+    case SCIB_BaudState_Switching:
+        if(RINGBUF_isEmpty(&gTxQueue) &&
+           SCI_getTxFifoStatus(halHandle->sciBHandle) == SCI_FifoStatus_Empty &&
+           SCI_isTxEmpty(halHandle->sciBHandle)) {
+            switchSciBBaudRate(gBaudLink.requestedRate);
+            gBaudLink.flag_probe = false;
+            gBaudLink.timer_ms = CMDLINK_PROBE_TIMEOUT_ms;
+            gBaudLink.state = SCIB_BaudState_Probing;
+        }
+        break;
+
+    case SCIB_BaudState_Probing:
+        if(gBaudLink.flag_probe) {
+            // the probe passed its CRC at the new rate, keep it
+            queueBaudReply(CMDLINK_Type_BaudProbeAck, CMDLINK_PROBE_PATTERN);
+            gBaudLink.numSwitches++;
+            gBaudLink.state = SCIB_BaudState_Idle;
+        }
+        else if(gBaudLink.timer_ms == 0) {
+            switchSciBBaudRate(gBaudLink.previousRate);
+            gBaudLink.numFallbacks++;
+            gBaudLink.state = SCIB_BaudState_Idle;
+        }
+        break;
+    }
+} // end of serviceBaudLink() function
+
+//! \brief Converts a CPU timer count difference to us, saturated to 16 bits
+static uint32_t getStampDelta_us(const uint32_t from,const uint32_t to) {
+    // the timer counts down
+    uint32_t delta_us = (from - to) / (uint32_t)USER_SYSTEM_FREQ_MHz;
+
+    return(delta_us > 0xFFFF ? 0xFFFF : delta_us);
+} // end of getStampDelta_us() function
+
+void serviceCmdEcho(void) {
+    if(gCmdEcho.state == CMDECHO_State_Done &&
+       gBaudLink.state == SCIB_BaudState_Idle &&
+       RINGBUF_getSpace(&gTxQueue) >= CMDLINK_FRAME_LENGTH) {
+        uint32_t rxToApply_us = getStampDelta_us(gCmdEcho.rxStamp, gCmdEcho.applyStamp);
+        uint32_t applyToPwm_us = getStampDelta_us(gCmdEcho.applyStamp, gCmdEcho.pwmStamp);
+
+        queueCmdFrame(gCmdEcho.seq, CMDLINK_Type_Echo, (int32_t)((applyToPwm_us << 16) | rxToApply_us));
+        gCmdEcho.numEchoes++;
+
+        // free for the next command
+        gCmdEcho.state = CMDECHO_State_Idle;
+    }
+} // end of serviceCmdEcho() function
+
+void serviceSpeedReply(void) {
+    if(gSpeedReply.flag_pending &&
+       gBaudLink.state == SCIB_BaudState_Idle &&
+       RINGBUF_getSpace(&gTxQueue) >= CMDLINK_FRAME_LENGTH) {
+        queueCmdFrame(gSpeedReply.seq, CMDLINK_Type_Speed, _IQtoIQ24(gSpeedReply.speed_krpm));
+        gSpeedReply.numReplies++;
+
+        // free for the next command, the fields are read
+        gSpeedReply.flag_pending = false;
+    }
+} // end of serviceSpeedReply() function
+
+void serviceBootReport(void) {
+    uint_least16_t phase;
+    uint32_t time_us;
+
+    while(gBaudLink.state == SCIB_BaudState_Idle &&
+          RINGBUF_getSpace(&gTxQueue) >= CMDLINK_FRAME_LENGTH &&
+          BOOT_getNext(&gBoot, &phase, &time_us)) {
+        queueCmdFrame(phase, CMDLINK_Type_BootMark, (int32_t)time_us);
+    }
+} // end of serviceBootReport() function
+
+//! \brief Keeps the telemetry decimation before an excitation run, which mainISR
+//!        changes on the first tick, or puts it back after the run
+static void setExciteLogging(const bool flag_on) {
+    uint_least16_t cnt;
+
+    if(flag_on && !gExciteLink.flag_logging && gExcite.logDecimation != 0) {
+        for(cnt=0; cnt<TELEM_NumChannels; cnt++) {
+            gExciteLink.decimation[cnt] = gTelem.decimation[cnt];
+        }
+        gExciteLink.flag_logging = true;
+    }
+    else if(!flag_on && gExciteLink.flag_logging) {
+        for(cnt=0; cnt<TELEM_NumChannels; cnt++) {
+            TELEM_setDecimation(&gTelem, (TELEM_Channel_e)cnt, gExciteLink.decimation[cnt]);
+        }
+        gExciteLink.flag_logging = false;
+    }
+} // end of setExciteLogging() function
+
+void serviceExcite(void) {
+    if(gBaudLink.state != SCIB_BaudState_Idle) {
+        return;
+    }
+
+    // tell the sender a run is over
+    if(gExcite.state == EXCITE_State_Done && RINGBUF_getSpace(&gTxQueue) >= CMDLINK_FRAME_LENGTH) {
+        EXCITE_stop(&gExcite);
+        setExciteLogging(false);
+        queueCmdFrame(gExciteLink.runSeq, CMDLINK_Type_ExciteAck, CMDLINK_makeParamPayload(EXCITE_Param_Run, 0));
+    }
+
+    if(gExciteLink.flag_pending && RINGBUF_getSpace(&gTxQueue) >= CMDLINK_FRAME_LENGTH) {
+        const EXCITE_Param_e param = (EXCITE_Param_e)CMDLINK_getParamId(gExciteLink.payload);
+        const int32_t value = CMDLINK_getParamValue(gExciteLink.payload);
+        const bool flag_wasLogging = gExciteLink.flag_logging;
+        bool flag_taken;
+
+        if(param == EXCITE_Param_Run && value == 1) {
+            // keep the telemetry decimation before the run is armed
+            setExciteLogging(true);
+            flag_taken = EXCITE_setParam(&gExcite, param, value);
+            if(flag_taken) {
+                gExciteLink.runSeq = gExciteLink.seq;
+            }
+            else if(!flag_wasLogging) {
+                setExciteLogging(false);
+            }
+        }
+        else {
+            flag_taken = EXCITE_setParam(&gExcite, param, value);
+            if(flag_taken && param == EXCITE_Param_Run) {
+                setExciteLogging(false);
+            }
+        }
+
+        queueCmdFrame(gExciteLink.seq, flag_taken ? CMDLINK_Type_ExciteAck : CMDLINK_Type_ExciteNack, gExciteLink.payload);
+        if(flag_taken) {
+            gExciteLink.numTaken++;
+        }
+        else {
+            gExciteLink.numRefused++;
+        }
+
+        // free for the next setting, the fields are read
+        gExciteLink.flag_pending = false;
+    }
+} // end of serviceExcite() function
+#endif
+
+//! \brief Converts a float to IQ24, saturated, without the long double _IQ24() math
+static int32_t getIQ24(const float value) {
+    if(value >= 127.0f) {
+        return((int32_t)0x7F000000L);
+    }
+    if(value <= -127.0f) {
+        return(-(int32_t)0x7F000000L);
+    }
+    return((int32_t)(value * 16777216.0f));
+} // end of getIQ24() function
+
+//! \brief Converts a float to a Model frame value, saturated at 24 bits
+static int32_t getModelValue(const float value) {
+    if(value >= (float)EXCITE_MAX_VALUE) {
+        return(EXCITE_MAX_VALUE);
+    }
+    if(value <= -(float)EXCITE_MAX_VALUE) {
+        return(-EXCITE_MAX_VALUE);
+    }
+    return((int32_t)value);
+} // end of getModelValue() function
+
+void serviceWheelModel(void) {
+    if(WHEELID_run(&gWheelId) != 0) {
+        gWheelModel.gain_krpmpsPerA = getIQ24(gWheelId.gain_krpmpsPerA);
+        gWheelModel.viscous_ApKrpm = getIQ24(gWheelId.viscous_ApKrpm);
+        gWheelModel.coulomb_A = getIQ24(gWheelId.coulomb_A);
+    }
+
+#ifndef CMDLINK_ASCII
+    // one parameter per period, only a model from enough windows
+    if(gWheelId.flag_valid &&
+       (elapsedMillis - gWheelModel.lastSent_ms) >= CMDLINK_MODEL_PERIOD_ms &&
+       gBaudLink.state == SCIB_BaudState_Idle &&
+       RINGBUF_getSpace(&gTxQueue) >= CMDLINK_FRAME_LENGTH) {
+        int32_t value;
+
+        // the wire units are rpm and mA, see CMDLINK_Model_e
+        switch(gWheelModel.nextId) {
+        case CMDLINK_Model_Gain_rpmpsPerA:
+            value = getModelValue(gWheelId.gain_krpmpsPerA * 1000.0f);
+            break;
+        case CMDLINK_Model_Viscous_mApKrpm:
+            value = getModelValue(gWheelId.viscous_ApKrpm * 1000.0f);
+            break;
+        default:
+            value = getModelValue(gWheelId.coulomb_A * 1000.0f);
+            break;
+        }
+
+        queueCmdFrame(gWheelModel.txSeq, CMDLINK_Type_Model, CMDLINK_makeParamPayload(gWheelModel.nextId, value));
+        gWheelModel.txSeq = (gWheelModel.txSeq + 1) & 0xFF;
+        gWheelModel.nextId = (gWheelModel.nextId + 1) % CMDLINK_NumModelParams;
+        gWheelModel.lastSent_ms = elapsedMillis;
+        gWheelModel.numSent++;
+    }
+#endif
+} // end of serviceWheelModel() function
+
+//! \brief the ISR for SCI-B transmit FIFO interrupt
 interrupt void sciBTxISR(void) {
     HAL_Obj *obj = (HAL_Obj *)halHandle;
-    //success = SCI_putDataNonBlocking(halHandle->sciBHandle, dataRx);
-    //gCounter_txdone++;
-    char message = dequeue();
-    if(message) SCI_putDataBlocking(halHandle->sciBHandle, message);
+    uint_least8_t data;
+    // refill the FIFO, up to 4 bytes per interrupt
+    while(SCI_getTxFifoStatus(halHandle->sciBHandle) != SCI_FifoStatus_4_Words &&
+          RINGBUF_pop(&gTxQueue, &data)) {
+        SCI_write(halHandle->sciBHandle, data);
+    }
+    if(RINGBUF_isEmpty(&gTxQueue)) {
+        // nothing left to send, stop the FIFO empty interrupt
+        SCI_disableTxFifoInt(halHandle->sciBHandle);
+    }
+    SCI_clearTxFifoInt(halHandle->sciBHandle);
     // acknowledge interrupt from SCI group so that SCI interrupt
     // is not received twice
     PIE_clearInt(obj->pieHandle,PIE_GroupNumber_9);
 } // end of sciBRxISR() function
 
-//char recBuffer[100];
-_iq bobby = 0.0;
-char inputStr[20];
-int inputLength = 0;
+#ifdef CMDLINK_ASCII
+//! \brief Handles one received byte, legacy "<float>a" commands
+static inline void processSciBRxByte(char dataRx) {
+    if(dataRx == 'a') {
+        int32_t value;
+
+        // the digits are already folded in, the terminator only commits them,
+        // malformed or out of range commands are dropped and counted by the parser
+        if(CMDPARSE_commit(&gCmdParser, &value) == CMDPARSE_Status_Ok) {
+            gMotorVars.IqRef_A = _IQ24toIQ(value);
+            postIqRef(gMotorVars.IqRef_A);
+            gSciBRxStats.numCmds++;
+        }
+    }
+    else {
+        CMDPARSE_putChar(&gCmdParser, dataRx);
+    }
+} // end of processSciBRxByte() function
+#else
+//! \brief Handles one received byte, binary CMDLINK frames
+static inline void processSciBRxByte(char dataRx) {
+    CMDLINK_Frame_t frame;
 
-//! \brief the ISR for SCI-B receive interrupt
-interrupt void sciBRxISR(void) {
-    HAL_Obj *obj = (HAL_Obj *)halHandle;
-    //success = SCI_putDataNonBlocking(halHandle->sciBHandle, dataRx);
-    //gCounter_txdone++;
-    uint16_t success;
-    char dataRx[2];
-    dataRx[0] = SCI_getDataNonBlocking(halHandle->sciBHandle, &success);
-    //SCI_putDataBlocking(halHandle->sciBHandle, dataRx);
-    if(dataRx[0] == 'a') {
-        //gMotorVars.IqRef_A = _atoIQ(recBuffer);
-        inputLength = qlength_two();
-        int i = 0;
-        while(1) {
-            char deq = dequeue_two();
-            if(deq) inputStr[i] = deq;
-            else break;
-            i++;
+    if(CMDLINK_decode(&gCmdDecoder,dataRx,&frame))
+    {
+        if(frame.type == CMDLINK_Type_Torque)
+        {
+            // the payload is already IQ24 amps, no parsing needed
+            gMotorVars.IqRef_A = _IQ24toIQ(frame.payload);
+            postIqRef(gMotorVars.IqRef_A);
+            gCmdSeq = frame.seq;
+            gSciBRxStats.numCmds++;
+
+            // stamp this command unless an earlier one is still in flight
+            if(gCmdEcho.state == CMDECHO_State_Idle)
+            {
+                gCmdEcho.rxStamp = HAL_readTimerCnt(halHandle,CPU_TIME_TIMER_NUMBER);
+                gCmdEcho.seq = frame.seq;
+                gCmdEcho.state = CMDECHO_State_Received;
+            }
+
+            // latch the motor speed for the reply, the latest one at this command
+            if(!gSpeedReply.flag_pending)
+            {
+                gSpeedReply.seq = frame.seq;
+                gSpeedReply.speed_krpm = gMotorVars.Speed_krpm;
+                gSpeedReply.flag_pending = true;
+            }
+            else
+            {
+                gSpeedReply.numSkipped++;
+            }
+        }
+        else if(frame.type == CMDLINK_Type_Excite)
+        {
+            // the background loop applies it, the sender waits for the answer
+            if(!gExciteLink.flag_pending)
+            {
+                gExciteLink.seq = frame.seq;
+                gExciteLink.payload = frame.payload;
+                gExciteLink.flag_pending = true;
+            }
+            else
+            {
+                gExciteLink.numRefused++;
+            }
+        }
+        else if(frame.type == CMDLINK_Type_BaudRequest)
+        {
+            // the background loop answers, one request at a time
+            if(gBaudLink.state == SCIB_BaudState_Idle && !gBaudLink.flag_request)
+            {
+                gBaudLink.requestedRate = (uint32_t)frame.payload;
+                gBaudLink.flag_request = true;
+            }
+        }
+        else if(frame.type == CMDLINK_Type_BootRequest)
+        {
+            // the background loop sends it
+            BOOT_requestReport(&gBoot);
         }
-        dequeue_two();
-        dequeue_two();
-        inputStr[i] = 0;
-        gMotorVars.IqRef_A = _atoIQ(inputStr);
-        /*int i = 0;
-        while (recBuffer[i] != '\0')
-        { // queue each char
-            enqueue(recBuffer[i]);
-            i++;
+        else if(frame.type == CMDLINK_Type_BaudProbe)
+        {
+            if(gBaudLink.state == SCIB_BaudState_Probing && frame.payload == CMDLINK_PROBE_PATTERN)
+            {
+                gBaudLink.flag_probe = true;
+            }
         }
-        SCI_putDataBlocking(halHandle->sciBHandle, dequeue()); // put the first char to start the flow*/
-        //recBuffer[0] = '\0';
-        //SCI_putDataBlocking(halHandle->sciBHandle, 'W');
     }
-    else if(dataRx[0] && dataRx[0]>32) {
-        enqueue_two(dataRx[0]);
+} // end of processSciBRxByte() function
+#endif
+
+void drainSciBRx(void) {
+    SCI_Handle sciHandle = halHandle->sciBHandle;
+
+    if(SCI_isRxFifoOvf(sciHandle)) {
+        gSciBRxStats.numFifoOvf++;
+        SCI_clearRxFifoOvf(sciHandle);
+    }
+
+    // empty the whole FIFO in one pass
+    while(SCI_getRxFifoStatus(sciHandle) != SCI_FifoStatus_Empty) {
+        processSciBRxByte((char)(SCI_read(sciHandle) & 0xFF));
+        gSciBRxStats.numBytes++;
     }
+} // end of drainSciBRx() function
+
+//! \brief the ISR for SCI-B receive FIFO interrupt
+interrupt void sciBRxISR(void) {
+    HAL_Obj *obj = (HAL_Obj *)halHandle;
+
+    gSciBRxStats.numInts++;
+    drainSciBRx();
+    SCI_clearRxFifoInt(halHandle->sciBHandle);
 
     // acknowledge interrupt from SCI group so that SCI interrupt
     // is not received twice
     PIE_clearInt(obj->pieHandle,PIE_GroupNumber_9);
 } // end of sciBRxISR() function
 
+void postIqRef(const _iq iqRef_A) {
+    // fill the buffer that was not published last, then publish it
+    uint_least16_t index = gCmdApply.index ^ 1;
+
+    gCmdApply.iqRef_pu[index] = _IQmpy(iqRef_A,_IQ(1.0/USER_IQ_FULL_SCALE_CURRENT_A));
+    gCmdApply.postStamp[index] = HAL_readTimerCnt(halHandle,CPU_TIME_TIMER_NUMBER);
+    gCmdApply.index = index;
+    gCmdApply.flag_new = true;
+} // end of postIqRef() function
+
+bool takeIqRef(_iq *pIqRef_pu) {
+    uint_least16_t index;
+    uint32_t delay_cnt;
+
+    if(!gCmdApply.flag_new) {
+        return(false);
+    }
+
+    gCmdApply.flag_new = false;
+    index = gCmdApply.index;
+    *pIqRef_pu = gCmdApply.iqRef_pu[index];
+
+    // the timer counts down
+    delay_cnt = gCmdApply.postStamp[index] - HAL_readTimerCnt(halHandle,CPU_TIME_TIMER_NUMBER);
+    gCmdApply.lastDelay_cnt = delay_cnt;
+    if(delay_cnt > gCmdApply.maxDelay_cnt) {
+        gCmdApply.maxDelay_cnt = delay_cnt;
+    }
+    gCmdApply.numApplied++;
+
+#ifndef CMDLINK_ASCII
+    if(gCmdEcho.state == CMDECHO_State_Received) {
+        gCmdEcho.applyStamp = HAL_readTimerCnt(halHandle,CPU_TIME_TIMER_NUMBER);
+        gCmdEcho.state = CMDECHO_State_Applied;
+    }
+#endif
+
+    return(true);
+} // end of takeIqRef() function
+
+_iq addFriction(const _iq iqRef_pu) {
+#ifdef FRIC_FEEDFORWARD
+    const _iq maxIq_pu = _IQ(USER_MOTOR_MAX_CURRENT / USER_IQ_FULL_SCALE_CURRENT_A);
+
+    // the feedforward never takes the reference past the motor limit
+    if(_IQabs(iqRef_pu) >= maxIq_pu) {
+        return(iqRef_pu);
+    }
+
+    return(_IQsat(iqRef_pu + gFricIq_pu, maxIq_pu, -maxIq_pu));
+#else
+    return(iqRef_pu);
+#endif
+} // end of addFriction() function
+
 void updateGlobalVariables_motor(CTRL_Handle handle)
 {
   CTRL_Obj *obj = (CTRL_Obj *)handle;
@@ -736,8 +1470,18 @@ void updateIqRef(CTRL_Handle handle)
         }
     }
 
-  // Set the Iq reference that use to come out of the PI speed control
-  CTRL_setIq_ref_pu(handle, iq_ref);
+#ifndef CMD_APPLY_IN_ISR
+  // Set the Iq reference that use to come out of the PI speed control, the
+  // feedforward and the excitation only at the background loop rate
+  CTRL_setIq_ref_pu(handle, addFriction(iq_ref) + gExciteIq_pu);
+
+  // iq_ref already holds the command, take it only to time the handoff
+  {
+    _iq iqRef_pu;
+
+    takeIqRef(&iqRef_pu);
+  }
+#endif
 
   return;
 } // end of updateIqRef() function
@@ -0,0 +1,344 @@
+//! \file   pstore.c
+//! \brief  Contains the flash parameter store (PSTORE) functions
+//!
+
+
+// **************************************************************************
+// the includes
+
+#include "pstore.h"
+
+
+// **************************************************************************
+// the defines
+
+//! \brief Defines the record word offsets
+//!
+#define PSTORE_WORD_MAGIC           (0)
+#define PSTORE_WORD_VERSION         (1)
+#define PSTORE_WORD_SEQUENCE        (2)
+#define PSTORE_WORD_FLAGS           (3)
+#define PSTORE_WORD_ERASES          (4)
+#define PSTORE_WORD_BIAS            (5)
+#define PSTORE_WORD_MOTOR           (17)
+#define PSTORE_WORD_CRC             (PSTORE_RECORD_WORDS - 1)
+
+//! \brief Defines the CRC-16/CCITT polynomial
+//!
+#define PSTORE_CRC_POLY             (0x1021)
+
+
+// **************************************************************************
+// the typedefs
+
+//! \brief Defines the float to bits conversion
+//!
+typedef union _PSTORE_Float_u_
+{
+  float     value;
+  uint32_t  bits;
+} PSTORE_Float_u;
+
+
+// **************************************************************************
+// the globals
+
+
+// **************************************************************************
+// the functions
+
+static void PSTORE_putLong(uint16_t *pWords,const uint32_t value)
+{
+  pWords[0] = (uint16_t)((value >> 16) & 0xFFFF);
+  pWords[1] = (uint16_t)(value & 0xFFFF);
+
+  return;
+} // end of PSTORE_putLong() function
+
+
+static uint32_t PSTORE_getLong(const uint16_t *pWords)
+{
+  return(((uint32_t)(pWords[0] & 0xFFFF) << 16) | (uint32_t)(pWords[1] & 0xFFFF));
+} // end of PSTORE_getLong() function
+
+
+static void PSTORE_putFloat(uint16_t *pWords,const float value)
+{
+  PSTORE_Float_u u;
+
+
+  u.value = value;
+  PSTORE_putLong(pWords,u.bits);
+
+  return;
+} // end of PSTORE_putFloat() function
+
+
+static float PSTORE_getFloat(const uint16_t *pWords)
+{
+  PSTORE_Float_u u;
+
+
+  u.bits = PSTORE_getLong(pWords);
+
+  return(u.value);
+} // end of PSTORE_getFloat() function
+
+
+static void PSTORE_encode(const PSTORE_Params_t *pParams,const uint16_t sequence,const uint16_t numErases,uint16_t *pRecord)
+{
+  uint_least16_t cnt;
+
+
+  pRecord[PSTORE_WORD_MAGIC] = PSTORE_MAGIC;
+  pRecord[PSTORE_WORD_VERSION] = PSTORE_VERSION;
+  pRecord[PSTORE_WORD_SEQUENCE] = sequence;
+  pRecord[PSTORE_WORD_FLAGS] = pParams->flags;
+  pRecord[PSTORE_WORD_ERASES] = numErases;
+
+  for(cnt=0;cnt<3;cnt++)
+    {
+      PSTORE_putLong(&pRecord[PSTORE_WORD_BIAS + 2 * cnt],(uint32_t)pParams->I_bias[cnt]);
+      PSTORE_putLong(&pRecord[PSTORE_WORD_BIAS + 6 + 2 * cnt],(uint32_t)pParams->V_bias[cnt]);
+    }
+
+  PSTORE_putFloat(&pRecord[PSTORE_WORD_MOTOR],pParams->Rs_Ohm);
+  PSTORE_putFloat(&pRecord[PSTORE_WORD_MOTOR + 2],pParams->Ls_d_H);
+  PSTORE_putFloat(&pRecord[PSTORE_WORD_MOTOR + 4],pParams->Ls_q_H);
+  PSTORE_putFloat(&pRecord[PSTORE_WORD_MOTOR + 6],pParams->ratedFlux_VpHz);
+
+  for(cnt=PSTORE_WORD_MOTOR + 8;cnt<PSTORE_WORD_CRC;cnt++)
+    {
+      pRecord[cnt] = 0;
+    }
+
+  pRecord[PSTORE_WORD_CRC] = PSTORE_getCrc(pRecord,PSTORE_WORD_CRC);
+
+  return;
+} // end of PSTORE_encode() function
+
+
+static bool PSTORE_decode(const uint16_t *pRecord,PSTORE_Params_t *pParams)
+{
+  uint_least16_t cnt;
+
+
+  if((pRecord[PSTORE_WORD_MAGIC] != PSTORE_MAGIC) ||
+     (pRecord[PSTORE_WORD_VERSION] != PSTORE_VERSION) ||
+     (pRecord[PSTORE_WORD_CRC] != PSTORE_getCrc(pRecord,PSTORE_WORD_CRC)))
+    {
+      return(false);
+    }
+
+  pParams->flags = pRecord[PSTORE_WORD_FLAGS] & (PSTORE_Flag_Bias | PSTORE_Flag_Motor);
+
+  for(cnt=0;cnt<3;cnt++)
+    {
+      pParams->I_bias[cnt] = (int32_t)PSTORE_getLong(&pRecord[PSTORE_WORD_BIAS + 2 * cnt]);
+      pParams->V_bias[cnt] = (int32_t)PSTORE_getLong(&pRecord[PSTORE_WORD_BIAS + 6 + 2 * cnt]);
+    }
+
+  pParams->Rs_Ohm = PSTORE_getFloat(&pRecord[PSTORE_WORD_MOTOR]);
+  pParams->Ls_d_H = PSTORE_getFloat(&pRecord[PSTORE_WORD_MOTOR + 2]);
+  pParams->Ls_q_H = PSTORE_getFloat(&pRecord[PSTORE_WORD_MOTOR + 4]);
+  pParams->ratedFlux_VpHz = PSTORE_getFloat(&pRecord[PSTORE_WORD_MOTOR + 6]);
+
+  // motor parameters that cannot be right are dropped, the NaN test fails too
+  if(!(pParams->Rs_Ohm > 0.0f) || !(pParams->Ls_d_H > 0.0f) ||
+     !(pParams->Ls_q_H > 0.0f) || !(pParams->ratedFlux_VpHz > 0.0f))
+    {
+      pParams->flags &= ~PSTORE_Flag_Motor;
+    }
+
+  return(true);
+} // end of PSTORE_decode() function
+
+
+void PSTORE_init(PSTORE_Obj *obj)
+{
+  uint_least16_t cnt;
+
+
+  obj->params.flags = 0;
+
+  for(cnt=0;cnt<3;cnt++)
+    {
+      obj->params.I_bias[cnt] = 0;
+      obj->params.V_bias[cnt] = 0;
+    }
+
+  obj->params.Rs_Ohm = 0.0f;
+  obj->params.Ls_d_H = 0.0f;
+  obj->params.Ls_q_H = 0.0f;
+  obj->params.ratedFlux_VpHz = 0.0f;
+
+  obj->flag_loaded = false;
+  obj->flag_dirty = false;
+  obj->flag_enableSave = true;
+  obj->nextSlot = 0;
+  obj->sequence = 0;
+  obj->numErases = 0;
+  obj->numCorrupt = 0;
+  obj->numSaves = 0;
+  obj->numFailed = 0;
+
+  return;
+} // end of PSTORE_init() function
+
+
+uint16_t PSTORE_getCrc(const uint16_t *pWords,const uint_least16_t num)
+{
+  uint16_t crc = 0xFFFF;
+  uint_least16_t cnt;
+  uint_least16_t bit;
+
+
+  for(cnt=0;cnt<num;cnt++)
+    {
+      crc ^= pWords[cnt] & 0xFFFF;
+
+      for(bit=0;bit<16;bit++)
+        {
+          crc = (crc & 0x8000) ? (uint16_t)(((crc << 1) ^ PSTORE_CRC_POLY) & 0xFFFF) : (uint16_t)((crc << 1) & 0xFFFF);
+        }
+    }
+
+  return(crc);
+} // end of PSTORE_getCrc() function
+
+
+bool PSTORE_load(PSTORE_Obj *obj,const uint16_t *pSector)
+{
+  PSTORE_Params_t params;
+  uint_least16_t slot;
+  uint_least16_t cnt;
+
+
+  obj->flag_loaded = false;
+  obj->nextSlot = 0;
+  obj->numCorrupt = 0;
+
+  for(slot=0;slot<PSTORE_NUM_SLOTS;slot++)
+    {
+      const uint16_t *pRecord = &pSector[slot * PSTORE_RECORD_WORDS];
+
+      for(cnt=0;(cnt<PSTORE_RECORD_WORDS) && ((pRecord[cnt] & 0xFFFF) == PSTORE_ERASED);cnt++)
+        {
+        }
+
+      if(cnt == PSTORE_RECORD_WORDS)
+        {
+          continue;
+        }
+
+      // a written slot is never programmed again, valid or not
+      obj->nextSlot = slot + 1;
+
+      if(!PSTORE_decode(pRecord,&params))
+        {
+          obj->numCorrupt++;
+          continue;
+        }
+
+      if(!obj->flag_loaded || ((int16_t)(pRecord[PSTORE_WORD_SEQUENCE] - obj->sequence) > 0))
+        {
+          obj->params = params;
+          obj->sequence = pRecord[PSTORE_WORD_SEQUENCE];
+          obj->numErases = pRecord[PSTORE_WORD_ERASES];
+          obj->flag_loaded = true;
+        }
+    }
+
+  obj->flag_dirty = false;
+
+  return(obj->flag_loaded);
+} // end of PSTORE_load() function
+
+
+void PSTORE_setBias(PSTORE_Obj *obj,const int32_t *pI_bias,const int32_t *pV_bias)
+{
+  uint_least16_t cnt;
+
+
+  for(cnt=0;cnt<3;cnt++)
+    {
+      if(!(obj->params.flags & PSTORE_Flag_Bias) ||
+         (obj->params.I_bias[cnt] != pI_bias[cnt]) || (obj->params.V_bias[cnt] != pV_bias[cnt]))
+        {
+          obj->flag_dirty = true;
+        }
+
+      obj->params.I_bias[cnt] = pI_bias[cnt];
+      obj->params.V_bias[cnt] = pV_bias[cnt];
+    }
+
+  obj->params.flags |= PSTORE_Flag_Bias;
+
+  return;
+} // end of PSTORE_setBias() function
+
+
+void PSTORE_setMotor(PSTORE_Obj *obj,const float Rs_Ohm,const float Ls_d_H,const float Ls_q_H,const float ratedFlux_VpHz)
+{
+  if(!(obj->params.flags & PSTORE_Flag_Motor) ||
+     (obj->params.Rs_Ohm != Rs_Ohm) || (obj->params.Ls_d_H != Ls_d_H) ||
+     (obj->params.Ls_q_H != Ls_q_H) || (obj->params.ratedFlux_VpHz != ratedFlux_VpHz))
+    {
+      obj->flag_dirty = true;
+    }
+
+  obj->params.Rs_Ohm = Rs_Ohm;
+  obj->params.Ls_d_H = Ls_d_H;
+  obj->params.Ls_q_H = Ls_q_H;
+  obj->params.ratedFlux_VpHz = ratedFlux_VpHz;
+  obj->params.flags |= PSTORE_Flag_Motor;
+
+  return;
+} // end of PSTORE_setMotor() function
+
+
+bool PSTORE_prepare(PSTORE_Obj *obj,uint16_t *pRecord,uint_least16_t *pSlot,bool *pFlag_erase)
+{
+  if(!obj->flag_enableSave || !obj->flag_dirty)
+    {
+      return(false);
+    }
+
+  *pFlag_erase = (obj->nextSlot >= PSTORE_NUM_SLOTS);
+  *pSlot = *pFlag_erase ? 0 : obj->nextSlot;
+
+  PSTORE_encode(&obj->params,obj->sequence + 1,obj->numErases + (*pFlag_erase ? 1 : 0),pRecord);
+
+  return(true);
+} // end of PSTORE_prepare() function
+
+
+void PSTORE_commit(PSTORE_Obj *obj,const uint_least16_t slot,const bool flag_erased,const bool flag_ok)
+{
+  // a slot that failed may hold part of a record, so it is skipped too
+  obj->nextSlot = slot + 1;
+
+  if(!flag_ok)
+    {
+      // do not wear the flash retrying, until saving is enabled again
+      obj->flag_enableSave = false;
+      obj->numFailed++;
+
+      return;
+    }
+
+  if(flag_erased)
+    {
+      obj->numErases++;
+    }
+
+  obj->sequence++;
+  obj->flag_dirty = false;
+  obj->flag_loaded = true;
+  obj->numSaves++;
+
+  return;
+} // end of PSTORE_commit() function
+
+
+// end of file
@@ -0,0 +1,186 @@
+#ifndef _PSTORE_H_
+#define _PSTORE_H_
+
+//! \file   pstore.h
+//! \brief  Contains the public interface to the flash parameter store (PSTORE)
+//!
+//!         The store keeps the calibrated ADC biases and the identified motor
+//!         parameters in a flash sector, so a restart can skip the offset
+//!         calibration and the motor identification.
+//!
+//!         The sector is a log of fixed size records, PSTORE_RECORD_WORDS 16
+//!         bit words each:
+//!
+//!           [0]       PSTORE_MAGIC
+//!           [1]       PSTORE_VERSION, records of another layout are ignored
+//!           [2]       the sequence number, one up per save
+//!           [3]       the PSTORE_Flag_e parts that are valid
+//!           [4]       the number of times the sector was erased
+//!           [5..16]   the current and voltage biases, IQ24, high word first
+//!           [17..24]  Rs, Ls_d, Ls_q and the rated flux, float bits, high word first
+//!           [25..30]  0
+//!           [31]      CRC-16/CCITT over words 0 to 30
+//!
+//!         Each save programs the next erased slot after the last used one,
+//!         so the sector is only erased once every PSTORE_NUM_SLOTS saves,
+//!         and only parameters that changed are saved.  PSTORE_load() takes
+//!         the record with the highest sequence number whose CRC matches, so
+//!         a save cut short by a reset leaves the previous one in use.
+//!
+//!         Programming and erasing the flash is left to the caller, see
+//!         PSTORE_prepare() and PSTORE_commit().
+//!
+//!         The module has no device specific includes and builds on the host,
+//!         where Code/tools/pstoretest checks it against an emulated sector.
+
+
+// **************************************************************************
+// the includes
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+//!
+//!
+//! \defgroup PSTORE PSTORE
+//!
+//@{
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+// **************************************************************************
+// the defines
+
+//! \brief Defines the record marker
+//!
+#define PSTORE_MAGIC                (0x5053)
+
+//! \brief Defines the record layout version
+//!
+#define PSTORE_VERSION              (1)
+
+//! \brief Defines the size of a record, 16 bit words
+//!
+#define PSTORE_RECORD_WORDS         (32)
+
+//! \brief Defines the number of records in a 16K word sector
+//!
+#define PSTORE_NUM_SLOTS            (0x4000 / PSTORE_RECORD_WORDS)
+
+//! \brief Defines the value of an erased flash word
+//!
+#define PSTORE_ERASED               (0xFFFF)
+
+
+// **************************************************************************
+// the typedefs
+
+//! \brief Enumeration for the parts of a record
+//!
+typedef enum
+{
+  PSTORE_Flag_Bias=(1 << 0),     //!< the ADC biases are valid
+  PSTORE_Flag_Motor=(1 << 1)     //!< the motor parameters are valid
+} PSTORE_Flag_e;
+
+
+//! \brief Defines the stored parameters
+//!
+typedef struct _PSTORE_Params_t_
+{
+  uint16_t  flags;               //!< the PSTORE_Flag_e parts that are valid
+  int32_t   I_bias[3];           //!< the current ADC biases, IQ24
+  int32_t   V_bias[3];           //!< the voltage ADC biases, IQ24
+  float     Rs_Ohm;              //!< the stator resistance, Ohm
+  float     Ls_d_H;              //!< the direct stator inductance, H
+  float     Ls_q_H;              //!< the quadrature stator inductance, H
+  float     ratedFlux_VpHz;      //!< the rated flux, V/Hz
+} PSTORE_Params_t;
+
+
+//! \brief Defines the parameter store
+//!
+//!        flag_enableSave may be cleared from the watch window to keep the
+//!        flash as it is
+//!
+typedef struct _PSTORE_Obj_
+{
+  PSTORE_Params_t params;        //!< the parameters, as loaded and updated since
+  bool      flag_loaded;         //!< a valid record was found by PSTORE_load()
+  bool      flag_dirty;          //!< params differ from the newest record
+  bool      flag_enableSave;     //!< PSTORE_prepare() may save
+  uint_least16_t nextSlot;       //!< the slot the next save goes to, PSTORE_NUM_SLOTS when full
+  uint16_t  sequence;            //!< the sequence number of the newest record
+  uint16_t  numErases;           //!< the number of times the sector was erased
+  uint_least16_t numCorrupt;     //!< the written slots PSTORE_load() rejected
+  uint32_t  numSaves;            //!< the number of records saved
+  uint32_t  numFailed;           //!< the number of saves the flash refused
+} PSTORE_Obj;
+
+
+// **************************************************************************
+// the function prototypes
+
+//! \brief     Initializes the store empty, for an erased sector
+//! \param[in] obj  A pointer to the store
+extern void PSTORE_init(PSTORE_Obj *obj);
+
+
+//! \brief     Computes the record CRC-16/CCITT, each word high byte first
+//! \param[in] pWords  A pointer to the words
+//! \param[in] num     The number of words
+//! \return    The CRC
+extern uint16_t PSTORE_getCrc(const uint16_t *pWords,const uint_least16_t num);
+
+
+//! \brief     Finds the newest valid record in the sector and the slot the next save goes to
+//! \param[in] obj      A pointer to the store
+//! \param[in] pSector  A pointer to the sector, PSTORE_NUM_SLOTS records
+//! \return    True if a valid record was found and loaded into obj->params
+extern bool PSTORE_load(PSTORE_Obj *obj,const uint16_t *pSector);
+
+
+//! \brief     Sets the ADC biases, marks the store dirty if they changed
+//! \param[in] obj     A pointer to the store
+//! \param[in] pI_bias The current biases, IQ24
+//! \param[in] pV_bias The voltage biases, IQ24
+extern void PSTORE_setBias(PSTORE_Obj *obj,const int32_t *pI_bias,const int32_t *pV_bias);
+
+
+//! \brief     Sets the motor parameters, marks the store dirty if they changed
+//! \param[in] obj             A pointer to the store
+//! \param[in] Rs_Ohm          The stator resistance, Ohm
+//! \param[in] Ls_d_H          The direct stator inductance, H
+//! \param[in] Ls_q_H          The quadrature stator inductance, H
+//! \param[in] ratedFlux_VpHz  The rated flux, V/Hz
+extern void PSTORE_setMotor(PSTORE_Obj *obj,const float Rs_Ohm,const float Ls_d_H,const float Ls_q_H,const float ratedFlux_VpHz);
+
+
+//! \brief      Builds the record to save, if the parameters changed
+//! \param[in]  obj          A pointer to the store
+//! \param[out] pRecord      The record, PSTORE_RECORD_WORDS words
+//! \param[out] pSlot        The slot to program it to
+//! \param[out] pFlag_erase  True if the sector is to be erased first
+//! \return     True if there is a record to save
+extern bool PSTORE_prepare(PSTORE_Obj *obj,uint16_t *pRecord,uint_least16_t *pSlot,bool *pFlag_erase);
+
+
+//! \brief     Takes the result of programming a record PSTORE_prepare() built
+//! \param[in] obj          A pointer to the store
+//! \param[in] slot         The slot from PSTORE_prepare()
+//! \param[in] flag_erased  True if the sector was erased first
+//! \param[in] flag_ok      True if the record was programmed and verified
+extern void PSTORE_commit(PSTORE_Obj *obj,const uint_least16_t slot,const bool flag_erased,const bool flag_ok);
+
+
+#ifdef __cplusplus
+}
+#endif // extern "C"
+
+//@} // ingroup
+#endif // end of _PSTORE_H_ definition
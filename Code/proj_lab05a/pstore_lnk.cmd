@@ -0,0 +1,22 @@
+/*
+ * FILE:  pstore_lnk.cmd
+ *
+ * TITLE: Flash parameter store sector
+ *
+ * DESCRIPTION:
+ *
+ *   Linked with F28069F.cmd in the Flash build, excluded from the RAM build.
+ *   Reserves all of flash sector H, HAL_PARAM_FLASH_ADDR in hal.h, for the
+ *   parameter store of pstore.h, so no code or constants are linked where
+ *   HAL_writeParamRecord() erases.  The section is NOLOAD, the debugger does
+ *   not program it, but set the on-chip flash erase to the needed sectors
+ *   only to keep the stored record across a reflash.
+ */
+
+SECTIONS
+{
+   /* bound to the sector address so it is placed before the sections linked to FLASHH */
+   paramstore : { . += 0x4000; } load = 0x3D8000, PAGE = 0, TYPE = NOLOAD
+}
+
+/* end of file */
@@ -0,0 +1,80 @@
+//! \file   ringbuf.c
+//! \brief  Contains the single-producer/single-consumer byte ring buffer
+//!         (RINGBUF) functions
+//!
+
+
+// **************************************************************************
+// the includes
+
+#include "ringbuf.h"
+
+
+// **************************************************************************
+// the defines
+
+
+// **************************************************************************
+// the globals
+
+
+// **************************************************************************
+// the functions
+
+bool RINGBUF_init(RINGBUF_Obj *obj,uint_least8_t *pBuf,const uint_least16_t size)
+{
+  if((size < 2) || (size > 0x8000) || ((size & (size - 1)) != 0))
+    {
+      return(false);
+    }
+
+  obj->pBuf = pBuf;
+  obj->mask = size - 1;
+  obj->head = 0;
+  obj->tail = 0;
+
+  return(true);
+} // end of RINGBUF_init() function
+
+
+uint_least16_t RINGBUF_pushBlock(RINGBUF_Obj *obj,const uint_least8_t *pData,const uint_least16_t length)
+{
+  uint_least16_t head = obj->head;
+  uint_least16_t space = obj->mask + 1 - ((head - obj->tail) & 0xFFFF);
+  uint_least16_t num = (length < space) ? length : space;
+  uint_least16_t cnt;
+
+
+  for(cnt=0;cnt<num;cnt++)
+    {
+      obj->pBuf[(head + cnt) & obj->mask] = pData[cnt];
+    }
+
+  // publish the whole block at once
+  obj->head = (head + num) & 0xFFFF;
+
+  return(num);
+} // end of RINGBUF_pushBlock() function
+
+
+uint_least16_t RINGBUF_popBlock(RINGBUF_Obj *obj,uint_least8_t *pData,const uint_least16_t length)
+{
+  uint_least16_t tail = obj->tail;
+  uint_least16_t count = (obj->head - tail) & 0xFFFF;
+  uint_least16_t num = (length < count) ? length : count;
+  uint_least16_t cnt;
+
+
+  for(cnt=0;cnt<num;cnt++)
+    {
+      pData[cnt] = obj->pBuf[(tail + cnt) & obj->mask];
+    }
+
+  // release the whole block at once
+  obj->tail = (tail + num) & 0xFFFF;
+
+  return(num);
+} // end of RINGBUF_popBlock() function
+
+
+// end of file
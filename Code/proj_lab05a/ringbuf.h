@@ -0,0 +1,178 @@
+#ifndef _RINGBUF_H_
+#define _RINGBUF_H_
+
+//! \file   ringbuf.h
+//! \brief  Contains the public interface to the single-producer/single-consumer
+//!         byte ring buffer (RINGBUF) used between the interrupts and the
+//!         background loop
+//!
+//!         One side only ever calls the push functions and the other side only
+//!         ever calls the pop functions.  The producer owns head and the
+//!         consumer owns tail, so no locking is needed as long as 16 bit loads
+//!         and stores are atomic, which holds on the C28x and on the Teensy.
+//!
+//!         The indices run freely and are masked on access, so the capacity
+//!         must be a power of two no larger than 2^15 and all of it is usable.
+//!         The count is head - tail modulo 2^16.
+//!
+//!         The module has no device specific includes and builds on the host.
+
+
+// **************************************************************************
+// the includes
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+//!
+//!
+//! \defgroup RINGBUF RINGBUF
+//!
+//@{
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+// **************************************************************************
+// the defines
+
+
+// **************************************************************************
+// the typedefs
+
+//! \brief Defines the ring buffer object
+//!
+typedef struct _RINGBUF_Obj_
+{
+  volatile uint_least8_t  *pBuf;     //!< the storage, size entries
+  uint_least16_t          mask;      //!< size - 1
+  volatile uint_least16_t head;      //!< the write index, written by the producer only
+  volatile uint_least16_t tail;      //!< the read index, written by the consumer only
+} RINGBUF_Obj;
+
+
+// **************************************************************************
+// the function prototypes
+
+//! \brief     Initializes the ring buffer
+//! \param[in] obj   A pointer to the ring buffer object
+//! \param[in] pBuf  A pointer to the storage
+//! \param[in] size  The number of entries in the storage, must be a power of two
+//! \return    False if size is not a power of two in [2, 2^15]
+extern bool RINGBUF_init(RINGBUF_Obj *obj,uint_least8_t *pBuf,const uint_least16_t size);
+
+
+//! \brief     Gets the number of entries waiting to be popped
+//! \param[in] obj  A pointer to the ring buffer object
+//! \return    The number of entries
+static inline uint_least16_t RINGBUF_getCount(const RINGBUF_Obj *obj)
+{
+  return((uint_least16_t)(obj->head - obj->tail) & 0xFFFF);
+} // end of RINGBUF_getCount() function
+
+
+//! \brief     Gets the number of entries that can still be pushed
+//! \param[in] obj  A pointer to the ring buffer object
+//! \return    The number of free entries
+static inline uint_least16_t RINGBUF_getSpace(const RINGBUF_Obj *obj)
+{
+  return(obj->mask + 1 - RINGBUF_getCount(obj));
+} // end of RINGBUF_getSpace() function
+
+
+//! \brief     Determines if the ring buffer is empty
+//! \param[in] obj  A pointer to the ring buffer object
+//! \return    True if there is nothing to pop
+static inline bool RINGBUF_isEmpty(const RINGBUF_Obj *obj)
+{
+  return(obj->head == obj->tail);
+} // end of RINGBUF_isEmpty() function
+
+
+//! \brief     Determines if the ring buffer is full
+//! \param[in] obj  A pointer to the ring buffer object
+//! \return    True if there is no room to push
+static inline bool RINGBUF_isFull(const RINGBUF_Obj *obj)
+{
+  return(RINGBUF_getCount(obj) > obj->mask);
+} // end of RINGBUF_isFull() function
+
+
+//! \brief     Pushes one entry, producer side only
+//! \param[in] obj   A pointer to the ring buffer object
+//! \param[in] data  The entry
+//! \return    False if the ring buffer was full and the entry was dropped
+static inline bool RINGBUF_push(RINGBUF_Obj *obj,const uint_least8_t data)
+{
+  uint_least16_t head = obj->head;
+
+  if((uint_least16_t)((head - obj->tail) & 0xFFFF) > obj->mask)
+    {
+      return(false);
+    }
+
+  // store the data before publishing the new head
+  obj->pBuf[head & obj->mask] = data;
+  obj->head = (head + 1) & 0xFFFF;
+
+  return(true);
+} // end of RINGBUF_push() function
+
+
+//! \brief      Pops one entry, consumer side only
+//! \param[in]  obj    A pointer to the ring buffer object
+//! \param[out] pData  A pointer to the entry, written only on success
+//! \return     False if the ring buffer was empty
+static inline bool RINGBUF_pop(RINGBUF_Obj *obj,uint_least8_t *pData)
+{
+  uint_least16_t tail = obj->tail;
+
+  if(tail == obj->head)
+    {
+      return(false);
+    }
+
+  // read the data before releasing the slot
+  *pData = obj->pBuf[tail & obj->mask];
+  obj->tail = (tail + 1) & 0xFFFF;
+
+  return(true);
+} // end of RINGBUF_pop() function
+
+
+//! \brief     Pushes as many entries as fit, producer side only
+//! \param[in] obj     A pointer to the ring buffer object
+//! \param[in] pData   A pointer to the entries
+//! \param[in] length  The number of entries offered
+//! \return    The number of entries pushed
+extern uint_least16_t RINGBUF_pushBlock(RINGBUF_Obj *obj,const uint_least8_t *pData,const uint_least16_t length);
+
+
+//! \brief      Pops up to length entries, consumer side only
+//! \param[in]  obj     A pointer to the ring buffer object
+//! \param[out] pData   A pointer to room for length entries
+//! \param[in]  length  The maximum number of entries to pop
+//! \return     The number of entries popped
+extern uint_least16_t RINGBUF_popBlock(RINGBUF_Obj *obj,uint_least8_t *pData,const uint_least16_t length);
+
+
+//! \brief     Discards everything in the ring buffer, consumer side only
+//! \param[in] obj  A pointer to the ring buffer object
+static inline void RINGBUF_flush(RINGBUF_Obj *obj)
+{
+  obj->tail = obj->head;
+
+  return;
+} // end of RINGBUF_flush() function
+
+
+#ifdef __cplusplus
+}
+#endif // extern "C"
+
+//@} // ingroup
+#endif // end of _RINGBUF_H_ definition
@@ -585,6 +585,36 @@ extern SCI_FifoStatus_e SCI_getTxFifoStatus(SCI_Handle sciHandle);
 extern SCI_Handle SCI_init(void *pMemory,const size_t numBytes);
 
 
+//! \brief     Determines if the serial communications interface (SCI) receive FIFO has overflowed
+//! \param[in] sciHandle  The serial communications interface (SCI) object handle
+//! \return    The receive FIFO overflow status
+static inline bool SCI_isRxFifoOvf(SCI_Handle sciHandle)
+{
+  SCI_Obj *sci = (SCI_Obj *)sciHandle;
+  bool status;
+
+  status = (sci->SCIFFRX & SCI_SCIFFRX_FIFO_OVF_BITS) >> 15;
+
+  return((bool)status);
+} // end of SCI_isRxFifoOvf() function
+
+
+//! \brief     Determines if the serial communications interface (SCI) transmitter is empty
+//! \details   Both the transmit buffer and the shift register are empty, so
+//!            the last stop bit has left the pin
+//! \param[in] sciHandle  The serial communications interface (SCI) object handle
+//! \return    The transmitter empty status
+static inline bool SCI_isTxEmpty(SCI_Handle sciHandle)
+{
+  SCI_Obj *sci = (SCI_Obj *)sciHandle;
+  bool status;
+
+  status = (sci->SCICTL2 & SCI_SCICTL2_TXEMPTY_BITS) >> 6;
+
+  return((bool)status);
+} // end of SCI_isTxEmpty() function
+
+
 //! \brief     Writes data to the serial communications interface (Blocking)
 //! \param[in] sciHandle  The serial communications interface (SCI) object handle
 //! \param[in] data       The data value
@@ -0,0 +1,288 @@
+//! \file   telem.c
+//! \brief  Contains the binary telemetry stream (TELEM) functions
+//!
+
+
+// **************************************************************************
+// the includes
+
+#include "telem.h"
+#include "cmdlink.h"
+
+
+// **************************************************************************
+// the defines
+
+//! \brief Defines the mask of all valid channels
+//!
+#define TELEM_CHANNEL_MASK          ((1 << TELEM_NumChannels) - 1)
+
+
+// **************************************************************************
+// the globals
+
+
+// **************************************************************************
+// the functions
+
+void TELEM_init(TELEM_Obj *obj)
+{
+  uint_least8_t cnt;
+
+
+  for(cnt=0;cnt<TELEM_NumChannels;cnt++)
+    {
+      obj->decimation[cnt] = 0;
+      obj->counter[cnt] = 0;
+    }
+
+  obj->tick = 0;
+  obj->head = 0;
+  obj->tail = 0;
+  obj->seq = 0;
+  obj->numFrames = 0;
+  obj->numDropped = 0;
+
+  return;
+} // end of TELEM_init() function
+
+
+void TELEM_setDecimation(TELEM_Obj *obj,const TELEM_Channel_e channel,const uint_least16_t decimation)
+{
+  obj->decimation[channel] = decimation;
+  obj->counter[channel] = 0;
+
+  return;
+} // end of TELEM_setDecimation() function
+
+
+uint_least16_t TELEM_getDueMask(TELEM_Obj *obj)
+{
+  uint_least16_t mask = 0;
+  uint_least8_t cnt;
+
+
+  obj->tick = (obj->tick + 1) & 0xFFFF;
+
+  for(cnt=0;cnt<TELEM_NumChannels;cnt++)
+    {
+      if(obj->decimation[cnt] != 0)
+        {
+          if(++obj->counter[cnt] >= obj->decimation[cnt])
+            {
+              obj->counter[cnt] = 0;
+              mask |= (1 << cnt);
+            }
+        }
+    }
+
+  return(mask);
+} // end of TELEM_getDueMask() function
+
+
+bool TELEM_putSample(TELEM_Obj *obj,const uint_least16_t mask,const int32_t *pValues)
+{
+  uint_least16_t head = obj->head;
+  TELEM_Sample_t *pSample;
+  uint_least8_t cnt;
+
+
+  if(((head - obj->tail) & 0xFFFF) >= TELEM_SAMPLE_QUEUE_SIZE)
+    {
+      obj->numDropped++;
+
+      return(false);
+    }
+
+  pSample = &obj->sample[head & (TELEM_SAMPLE_QUEUE_SIZE - 1)];
+  pSample->mask = mask;
+  pSample->tick = obj->tick;
+
+  for(cnt=0;cnt<TELEM_NumChannels;cnt++)
+    {
+      pSample->value[cnt] = pValues[cnt];
+    }
+
+  // publish the sample once it is complete
+  obj->head = (head + 1) & 0xFFFF;
+
+  return(true);
+} // end of TELEM_putSample() function
+
+
+uint_least16_t TELEM_getFrameLength(const uint_least16_t mask)
+{
+  uint_least16_t length = TELEM_HEADER_LENGTH + 1;
+  uint_least8_t cnt;
+
+
+  for(cnt=0;cnt<TELEM_NumChannels;cnt++)
+    {
+      if(mask & (1 << cnt))
+        {
+          length += 4;
+        }
+    }
+
+  return(length);
+} // end of TELEM_getFrameLength() function
+
+
+uint_least16_t TELEM_encode(TELEM_Obj *obj,uint_least8_t *pBuf)
+{
+  uint_least16_t tail = obj->tail;
+  const TELEM_Sample_t *pSample;
+  uint_least16_t length = TELEM_HEADER_LENGTH;
+  uint_least8_t cnt;
+
+
+  if(tail == obj->head)
+    {
+      return(0);
+    }
+
+  pSample = &obj->sample[tail & (TELEM_SAMPLE_QUEUE_SIZE - 1)];
+
+  pBuf[0] = TELEM_SYNC;
+  pBuf[1] = obj->seq;
+  pBuf[2] = pSample->mask & TELEM_CHANNEL_MASK & 0xFF;
+  pBuf[3] = ((pSample->mask & TELEM_CHANNEL_MASK) >> 8) & 0xFF;
+  pBuf[4] = pSample->tick & 0xFF;
+  pBuf[5] = (pSample->tick >> 8) & 0xFF;
+
+  for(cnt=0;cnt<TELEM_NumChannels;cnt++)
+    {
+      if(pSample->mask & (1 << cnt))
+        {
+          uint32_t value = (uint32_t)pSample->value[cnt];
+
+          pBuf[length++] = (uint_least8_t)(value & 0xFF);
+          pBuf[length++] = (uint_least8_t)((value >> 8) & 0xFF);
+          pBuf[length++] = (uint_least8_t)((value >> 16) & 0xFF);
+          pBuf[length++] = (uint_least8_t)((value >> 24) & 0xFF);
+        }
+    }
+
+  // release the sample
+  obj->tail = (tail + 1) & 0xFFFF;
+
+  pBuf[length] = CMDLINK_crc8(&pBuf[1],(uint_least8_t)(length - 1));
+  length++;
+
+  obj->seq = (obj->seq + 1) & 0xFF;
+  obj->numFrames++;
+
+  return(length);
+} // end of TELEM_encode() function
+
+
+void TELEM_initDecoder(TELEM_Decoder_t *pDecoder)
+{
+  pDecoder->length = 0;
+  pDecoder->numFrames = 0;
+  pDecoder->numCrcErrors = 0;
+  pDecoder->numSyncErrors = 0;
+
+  return;
+} // end of TELEM_initDecoder() function
+
+
+bool TELEM_decode(TELEM_Decoder_t *pDecoder,const uint_least8_t data,TELEM_Sample_t *pSample,uint_least8_t *pSeq)
+{
+  uint_least8_t *pBuf = pDecoder->buf;
+  uint_least16_t frameLength;
+  uint_least16_t mask;
+  uint_least16_t shift;
+  uint_least16_t cnt;
+
+
+  // hunt for the sync byte
+  if(pDecoder->length == 0)
+    {
+      if((data & 0xFF) != TELEM_SYNC)
+        {
+          pDecoder->numSyncErrors++;
+
+          return(false);
+        }
+    }
+
+  pBuf[pDecoder->length++] = data & 0xFF;
+
+  if(pDecoder->length < 4)
+    {
+      return(false);
+    }
+
+  mask = pBuf[2] | ((uint_least16_t)pBuf[3] << 8);
+  frameLength = TELEM_getFrameLength(mask);
+
+  if(((mask & ~TELEM_CHANNEL_MASK) == 0) && (mask != 0))
+    {
+      if(pDecoder->length < frameLength)
+        {
+          return(false);
+        }
+
+      if(CMDLINK_crc8(&pBuf[1],(uint_least8_t)(frameLength - 2)) == pBuf[frameLength - 1])
+        {
+          uint_least16_t index = TELEM_HEADER_LENGTH;
+
+          pSample->mask = mask;
+          pSample->tick = pBuf[4] | ((uint_least16_t)pBuf[5] << 8);
+
+          for(cnt=0;cnt<TELEM_NumChannels;cnt++)
+            {
+              if(pSample->mask & (1 << cnt))
+                {
+                  pSample->value[cnt] = (int32_t)((uint32_t)pBuf[index] |
+                                                  ((uint32_t)pBuf[index + 1] << 8) |
+                                                  ((uint32_t)pBuf[index + 2] << 16) |
+                                                  ((uint32_t)pBuf[index + 3] << 24));
+                  index += 4;
+                }
+              else
+                {
+                  pSample->value[cnt] = 0;
+                }
+            }
+
+          *pSeq = pBuf[1];
+
+          // keep anything received past the end of the frame, this only
+          // happens right after a resynchronization
+          for(cnt=frameLength;cnt<pDecoder->length;cnt++)
+            {
+              pBuf[cnt - frameLength] = pBuf[cnt];
+            }
+
+          pDecoder->length -= frameLength;
+          pDecoder->numFrames++;
+
+          return(true);
+        }
+    }
+
+  pDecoder->numCrcErrors++;
+
+  // resynchronize on the next sync byte already in the buffer
+  for(shift=1;shift<pDecoder->length;shift++)
+    {
+      if(pBuf[shift] == TELEM_SYNC)
+        {
+          break;
+        }
+    }
+
+  for(cnt=shift;cnt<pDecoder->length;cnt++)
+    {
+      pBuf[cnt - shift] = pBuf[cnt];
+    }
+
+  pDecoder->length -= shift;
+
+  return(false);
+} // end of TELEM_decode() function
+
+
+// end of file
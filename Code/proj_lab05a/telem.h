@@ -0,0 +1,192 @@
+#ifndef _TELEM_H_
+#define _TELEM_H_
+
+//! \file   telem.h
+//! \brief  Contains the public interface to the binary telemetry stream (TELEM)
+//!
+//!         mainISR asks TELEM_getDueMask() which channels are due on this
+//!         tick, and if any are it copies the channel values with
+//!         TELEM_putSample().  The background loop turns queued samples into
+//!         frames with TELEM_encode() and hands them to the SCI-B transmit
+//!         queue.  Every channel has its own decimation factor, in ISR ticks,
+//!         and a factor of 0 turns the channel off.
+//!
+//!         Frame layout, all multi-byte fields little endian:
+//!
+//!           [0]        TELEM_SYNC
+//!           [1]        sequence number, incremented for each frame
+//!           [2..3]     channel mask, bit n set when channel n is present
+//!           [4..5]     ISR tick counter at the time of the sample
+//!           [6..]      4 bytes per present channel, in channel order, IQ24
+//!           [last]     CRC-8 over bytes [1..last-1], see CMDLINK_crc8()
+//!
+//!         The module has no device specific includes and builds on the host,
+//!         where Code/tools/telemdump uses it to decode a recorded stream.
+
+
+// **************************************************************************
+// the includes
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+//!
+//!
+//! \defgroup TELEM TELEM
+//!
+//@{
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+// **************************************************************************
+// the defines
+
+//! \brief Defines the frame synchronization byte, CMDLINK_TELEM_SYNC in cmdlink.h
+//!
+#define TELEM_SYNC                  (0x5A)
+
+//! \brief Defines the number of bytes before the channel values
+//!
+#define TELEM_HEADER_LENGTH         (6)
+
+//! \brief Defines the number of samples queued between mainISR and the background loop,
+//!        must be a power of two
+//!
+#define TELEM_SAMPLE_QUEUE_SIZE     (16)
+
+//! \brief Defines the longest frame, bytes
+//!
+#define TELEM_MAX_FRAME_LENGTH      (TELEM_HEADER_LENGTH + 4 * TELEM_NumChannels + 1)
+
+
+// **************************************************************************
+// the typedefs
+
+//! \brief Enumeration for the telemetry channels, the order is the frame order
+//!
+typedef enum
+{
+  TELEM_Channel_Speed_krpm=0,    //!< estimated speed, krpm
+  TELEM_Channel_Iq_A,            //!< measured Iq, A
+  TELEM_Channel_IqRef_A,         //!< Iq reference, A
+  TELEM_Channel_VdcBus_kV,       //!< DC bus voltage, kV
+  TELEM_Channel_Torque_Nm,       //!< estimated torque, Nm
+  TELEM_Channel_Vd_pu,           //!< Vd controller output, pu
+  TELEM_Channel_Vq_pu,           //!< Vq controller output, pu
+  TELEM_Channel_Excite_A,        //!< excitation added to the Iq reference, A
+  TELEM_Channel_WheelGain_krpmpsPerA,   //!< identified wheel acceleration per A, see wheelid.h
+  TELEM_Channel_WheelViscous_ApKrpm,    //!< identified viscous friction, A per krpm
+  TELEM_Channel_WheelCoulomb_A,         //!< identified Coulomb friction, A
+  TELEM_NumChannels              //!< the number of channels, keep CMDLINK_TELEM_CHANNEL_MASK in cmdlink.h in step
+} TELEM_Channel_e;
+
+
+//! \brief Defines one queued sample
+//!
+typedef struct _TELEM_Sample_t_
+{
+  uint_least16_t  mask;                        //!< the channels present
+  uint_least16_t  tick;                        //!< the ISR tick counter
+  int32_t         value[TELEM_NumChannels];    //!< the values, indexed by channel
+} TELEM_Sample_t;
+
+
+//! \brief Defines the telemetry object
+//!
+typedef struct _TELEM_Obj_
+{
+  uint_least16_t  decimation[TELEM_NumChannels];   //!< ISR ticks between samples, 0 is off
+  uint_least16_t  counter[TELEM_NumChannels];      //!< ISR ticks since the last sample
+
+  uint_least16_t  tick;                            //!< the ISR tick counter
+
+  TELEM_Sample_t  sample[TELEM_SAMPLE_QUEUE_SIZE]; //!< the queued samples
+  volatile uint_least16_t head;                    //!< written by mainISR only
+  volatile uint_least16_t tail;                    //!< written by the background loop only
+
+  uint_least8_t   seq;                             //!< the next sequence number
+  uint32_t        numFrames;                       //!< the number of frames encoded
+  uint32_t        numDropped;                      //!< the number of samples dropped on a full queue
+} TELEM_Obj;
+
+
+//! \brief Defines the streaming frame decoder, used on the host
+//!
+typedef struct _TELEM_Decoder_t_
+{
+  uint_least8_t   buf[TELEM_MAX_FRAME_LENGTH];     //!< the partially received frame
+  uint_least16_t  length;                          //!< the number of bytes in buf
+
+  uint32_t        numFrames;                       //!< the number of valid frames
+  uint32_t        numCrcErrors;                    //!< the number of frames dropped on CRC mismatch
+  uint32_t        numSyncErrors;                   //!< the number of bytes discarded while hunting for sync
+} TELEM_Decoder_t;
+
+
+// **************************************************************************
+// the function prototypes
+
+//! \brief     Initializes the telemetry object with every channel off
+//! \param[in] obj  A pointer to the telemetry object
+extern void TELEM_init(TELEM_Obj *obj);
+
+
+//! \brief     Sets the decimation of one channel
+//! \param[in] obj         A pointer to the telemetry object
+//! \param[in] channel     The channel
+//! \param[in] decimation  ISR ticks between samples, 0 turns the channel off
+extern void TELEM_setDecimation(TELEM_Obj *obj,const TELEM_Channel_e channel,const uint_least16_t decimation);
+
+
+//! \brief     Advances the channel counters by one ISR tick, call from mainISR
+//! \param[in] obj  A pointer to the telemetry object
+//! \return    The mask of the channels due on this tick, 0 if none
+extern uint_least16_t TELEM_getDueMask(TELEM_Obj *obj);
+
+
+//! \brief     Queues a sample, call from mainISR
+//! \param[in] obj      A pointer to the telemetry object
+//! \param[in] mask     The channels to keep, from TELEM_getDueMask()
+//! \param[in] pValues  A pointer to TELEM_NumChannels values, IQ24, indexed by channel
+//! \return    False if the queue was full and the sample was dropped
+extern bool TELEM_putSample(TELEM_Obj *obj,const uint_least16_t mask,const int32_t *pValues);
+
+
+//! \brief      Encodes the oldest queued sample as a frame, call from the background loop
+//! \param[in]  obj   A pointer to the telemetry object
+//! \param[out] pBuf  A pointer to a buffer of at least TELEM_MAX_FRAME_LENGTH bytes
+//! \return     The frame length, 0 if nothing was queued
+extern uint_least16_t TELEM_encode(TELEM_Obj *obj,uint_least8_t *pBuf);
+
+
+//! \brief     Gets the frame length for a channel mask
+//! \param[in] mask  The channel mask
+//! \return    The frame length, bytes
+extern uint_least16_t TELEM_getFrameLength(const uint_least16_t mask);
+
+
+//! \brief     Initializes the frame decoder
+//! \param[in] pDecoder  A pointer to the decoder
+extern void TELEM_initDecoder(TELEM_Decoder_t *pDecoder);
+
+
+//! \brief      Feeds one received byte to the frame decoder
+//! \param[in]  pDecoder  A pointer to the decoder
+//! \param[in]  data      The received byte
+//! \param[out] pSample   A pointer to the sample, written only when a valid frame completes
+//! \param[out] pSeq      A pointer to the frame sequence number, written with pSample
+//! \return     True when a valid frame has been decoded into pSample
+extern bool TELEM_decode(TELEM_Decoder_t *pDecoder,const uint_least8_t data,TELEM_Sample_t *pSample,uint_least8_t *pSeq);
+
+
+#ifdef __cplusplus
+}
+#endif // extern "C"
+
+//@} // ingroup
+#endif // end of _TELEM_H_ definition
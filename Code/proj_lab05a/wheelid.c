@@ -0,0 +1,258 @@
+//! \file   wheelid.c
+//! \brief  Contains the online reaction wheel model identification (WHEELID) functions
+//!
+
+
+// **************************************************************************
+// the includes
+
+#include <math.h>
+
+#include "wheelid.h"
+
+
+#ifdef FLASH
+#pragma CODE_SECTION(WHEELID_putTick,"ramfuncs");
+#endif
+
+
+// **************************************************************************
+// the defines
+
+//! \brief Defines the IQ24 scale
+//!
+#define WHEELID_IQ24_SCALE          (16777216.0f)
+
+//! \brief Defines the smallest gain the friction is published for, krpm/s per A
+//!
+#define WHEELID_MIN_GAIN_krpmpsPerA (0.01f)
+
+
+// **************************************************************************
+// the globals
+
+
+// **************************************************************************
+// the functions
+
+void WHEELID_init(WHEELID_Obj *obj,const float isrFreq_Hz,const uint_least16_t decimation)
+{
+  obj->decimation = decimation;
+  obj->period_sec = (float)decimation / isrFreq_Hz;
+  obj->forgetting = (float)WHEELID_DEFAULT_FORGETTING;
+  obj->deadband_krpm = (float)WHEELID_DEFAULT_DEADBAND_krpm;
+  obj->maxSpeed_krpm = 0.0f;
+  obj->maxTrace = (float)WHEELID_DEFAULT_MAX_TRACE;
+  obj->minUpdates = WHEELID_DEFAULT_MIN_UPDATES;
+
+  obj->sumIq = 0;
+  obj->sumSpeed = 0;
+  obj->count = 0;
+  obj->flag_windowValid = true;
+  obj->head = 0;
+  obj->tail = 0;
+  obj->numDropped = 0;
+
+  WHEELID_reset(obj);
+
+  return;
+} // end of WHEELID_init() function
+
+
+void WHEELID_reset(WHEELID_Obj *obj)
+{
+  uint_least16_t row;
+  uint_least16_t col;
+
+
+  for(row=0;row<WHEELID_NUM_PARAMS;row++)
+    {
+      obj->theta[row] = 0.0f;
+
+      for(col=0;col<WHEELID_NUM_PARAMS;col++)
+        {
+          obj->P[row][col] = (row == col) ? (float)WHEELID_INITIAL_COVARIANCE : 0.0f;
+        }
+    }
+
+  obj->lastSpeed_krpm = 0.0f;
+  obj->flag_haveLast = false;
+  obj->meanSquareError = 0.0f;
+
+  obj->gain_krpmpsPerA = 0.0f;
+  obj->viscous_ApKrpm = 0.0f;
+  obj->coulomb_A = 0.0f;
+  obj->residual_krpmps = 0.0f;
+  obj->flag_valid = false;
+
+  obj->numUpdates = 0;
+  obj->numSkipped = 0;
+
+  return;
+} // end of WHEELID_reset() function
+
+
+void WHEELID_putTick(WHEELID_Obj *obj,const int32_t iq,const int32_t speed,const bool flag_valid)
+{
+  obj->sumIq += iq;
+  obj->sumSpeed += speed;
+  obj->flag_windowValid = obj->flag_windowValid && flag_valid;
+
+  if(++obj->count >= obj->decimation)
+    {
+      uint_least16_t head = obj->head;
+
+      if(((head - obj->tail) & 0xFFFF) < WHEELID_SAMPLE_QUEUE_SIZE)
+        {
+          WHEELID_Sample_t *pSample = &obj->sample[head & (WHEELID_SAMPLE_QUEUE_SIZE - 1)];
+
+          pSample->sumIq = obj->sumIq;
+          pSample->sumSpeed = obj->sumSpeed;
+          pSample->speed = speed;
+          pSample->flag_valid = obj->flag_windowValid;
+
+          // publish the window once it is complete
+          obj->head = (head + 1) & 0xFFFF;
+        }
+      else
+        {
+          obj->numDropped++;
+        }
+
+      obj->sumIq = 0;
+      obj->sumSpeed = 0;
+      obj->count = 0;
+      obj->flag_windowValid = true;
+    }
+
+  return;
+} // end of WHEELID_putTick() function
+
+
+uint_least16_t WHEELID_run(WHEELID_Obj *obj)
+{
+  const float scale = 1.0f / (WHEELID_IQ24_SCALE * (float)obj->decimation);
+  uint_least16_t tail = obj->tail;
+  uint_least16_t num = 0;
+
+
+  while(tail != obj->head)
+    {
+      const WHEELID_Sample_t *pSample = &obj->sample[tail & (WHEELID_SAMPLE_QUEUE_SIZE - 1)];
+      const float speed_krpm = (float)pSample->speed * (1.0f / WHEELID_IQ24_SCALE);
+      const float meanIq_A = (float)pSample->sumIq * scale;
+      const float meanSpeed_krpm = (float)pSample->sumSpeed * scale;
+
+      // release the window
+      tail = (tail + 1) & 0xFFFF;
+      obj->tail = tail;
+
+      // the first window after an invalid one only gives the speed the next one starts from
+      if(!pSample->flag_valid)
+        {
+          obj->numSkipped++;
+          obj->flag_haveLast = false;
+        }
+      else
+        {
+          if(obj->flag_haveLast)
+            {
+              WHEELID_update(obj,meanIq_A,meanSpeed_krpm,speed_krpm - obj->lastSpeed_krpm);
+            }
+
+          obj->lastSpeed_krpm = speed_krpm;
+          obj->flag_haveLast = true;
+        }
+
+      num++;
+    }
+
+  return(num);
+} // end of WHEELID_run() function
+
+
+bool WHEELID_update(WHEELID_Obj *obj,const float meanIq_A,const float meanSpeed_krpm,const float deltaSpeed_krpm)
+{
+  const float absSpeed_krpm = fabsf(meanSpeed_krpm);
+  float phi[WHEELID_NUM_PARAMS];
+  float Pphi[WHEELID_NUM_PARAMS];
+  float gain[WHEELID_NUM_PARAMS];
+  float forgetting = obj->forgetting;
+  float denom;
+  float error;
+  float trace = 0.0f;
+  uint_least16_t row;
+  uint_least16_t col;
+
+
+  if((absSpeed_krpm < obj->deadband_krpm) ||
+     ((obj->maxSpeed_krpm > 0.0f) && (absSpeed_krpm > obj->maxSpeed_krpm)))
+    {
+      obj->numSkipped++;
+      return(false);
+    }
+
+  phi[0] = meanIq_A;
+  phi[1] = -meanSpeed_krpm;
+  phi[2] = (meanSpeed_krpm > 0.0f) ? -1.0f : 1.0f;
+
+  // the prediction error of the acceleration and the gain
+  error = deltaSpeed_krpm / obj->period_sec;
+  denom = 0.0f;
+
+  for(row=0;row<WHEELID_NUM_PARAMS;row++)
+    {
+      Pphi[row] = 0.0f;
+
+      for(col=0;col<WHEELID_NUM_PARAMS;col++)
+        {
+          Pphi[row] += obj->P[row][col] * phi[col];
+        }
+
+      error -= obj->theta[row] * phi[row];
+      denom += phi[row] * Pphi[row];
+      trace += obj->P[row][row];
+    }
+
+  // a wound up covariance stops forgetting until new excitation shrinks it
+  if(trace >= obj->maxTrace)
+    {
+      forgetting = 1.0f;
+    }
+
+  denom += forgetting;
+
+  for(row=0;row<WHEELID_NUM_PARAMS;row++)
+    {
+      gain[row] = Pphi[row] / denom;
+      obj->theta[row] += gain[row] * error;
+    }
+
+  // the upper triangle, mirrored so the covariance stays symmetric
+  for(row=0;row<WHEELID_NUM_PARAMS;row++)
+    {
+      for(col=row;col<WHEELID_NUM_PARAMS;col++)
+        {
+          obj->P[row][col] = (obj->P[row][col] - gain[row] * Pphi[col]) / forgetting;
+          obj->P[col][row] = obj->P[row][col];
+        }
+    }
+
+  obj->meanSquareError = obj->forgetting * obj->meanSquareError + (1.0f - obj->forgetting) * error * error;
+  obj->numUpdates++;
+
+  // publish the model per A of Iq
+  obj->gain_krpmpsPerA = obj->theta[0];
+  if(obj->theta[0] > WHEELID_MIN_GAIN_krpmpsPerA)
+    {
+      obj->viscous_ApKrpm = obj->theta[1] / obj->theta[0];
+      obj->coulomb_A = obj->theta[2] / obj->theta[0];
+    }
+  obj->residual_krpmps = sqrtf(obj->meanSquareError);
+  obj->flag_valid = (obj->numUpdates >= obj->minUpdates) && (obj->theta[0] > WHEELID_MIN_GAIN_krpmpsPerA);
+
+  return(true);
+} // end of WHEELID_update() function
+
+
+// end of file
@@ -0,0 +1,202 @@
+#ifndef _WHEELID_H_
+#define _WHEELID_H_
+
+//! \file   wheelid.h
+//! \brief  Contains the public interface to the online reaction wheel model
+//!         identification (WHEELID)
+//!
+//!         The wheel follows
+//!
+//!           J dw/dt = Kt Iq - B w - Tc sign(w)
+//!
+//!         Only Iq and the speed are measured, so Kt and J cannot be told
+//!         apart and the model is identified per unit of Iq:
+//!
+//!           dw/dt = gain * (Iq - viscous * w - coulomb * sign(w))
+//!
+//!         with the gain Kt / J in krpm/s per A, and the viscous and Coulomb
+//!         friction as the Iq that holds them, A per krpm and A.  That is
+//!         the form the balance law wants, the lean per A of command is the
+//!         lean per krpm/s of wheel acceleration times the gain.
+//!
+//!         mainISR calls WHEELID_putTick() every tick.  It sums Iq and the
+//!         speed over decimation ticks and queues the sums with the speed at
+//!         the end of the window.  A window with a tick that was not valid,
+//!         such as one while the controller is not on line, is dropped, and
+//!         the next window only gives the speed the one after starts from.
+//!         The background loop calls WHEELID_run(), which takes the speed
+//!         change over each window against the window means with recursive
+//!         least squares and a forgetting factor:
+//!
+//!           dw / T = a * mean(Iq) - b * mean(w) - c * sign(mean(w))
+//!
+//!         and gain = a, viscous = b / a, coulomb = c / a.  Windows with the
+//!         mean speed inside deadband_krpm are skipped, the wheel is stuck in
+//!         static friction there and the sign of the Coulomb term unknown,
+//!         and so are windows with a mean speed beyond maxSpeed_krpm when it
+//!         is set.  The covariance is not forgotten once its trace reaches
+//!         maxTrace, so it does not wind up while the wheel runs at a
+//!         constant speed and nothing new is learned.
+//!
+//!         The estimate is float, run on the FPU from the background loop;
+//!         the ISR part is two 64 bit sums and a counter.  WHEELID_update()
+//!         takes one window directly, Code/tools/wheelreplay uses it to run
+//!         the estimator over recorded logs on the host.
+
+
+// **************************************************************************
+// the includes
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+//!
+//!
+//! \defgroup WHEELID WHEELID
+//!
+//@{
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+// **************************************************************************
+// the defines
+
+//! \brief Defines the number of estimated parameters
+//!
+#define WHEELID_NUM_PARAMS          (3)
+
+//! \brief Defines the number of windows queued between mainISR and the background loop,
+//!        must be a power of two
+//!
+#define WHEELID_SAMPLE_QUEUE_SIZE   (8)
+
+//! \brief Defines the default forgetting factor, a memory of 2000 windows, 4 s at 500 Hz
+//!
+#define WHEELID_DEFAULT_FORGETTING  (0.9995)
+
+//! \brief Defines the default speed below which windows are skipped, krpm
+//!
+#define WHEELID_DEFAULT_DEADBAND_krpm   (0.2)
+
+//! \brief Defines the initial covariance diagonal, large for an unknown start
+//!
+#define WHEELID_INITIAL_COVARIANCE  (100.0)
+
+//! \brief Defines the default covariance trace past which the forgetting stops
+//!
+#define WHEELID_DEFAULT_MAX_TRACE   (1000.0)
+
+//! \brief Defines the default number of windows taken before the estimate is valid
+//!
+#define WHEELID_DEFAULT_MIN_UPDATES (500)
+
+
+// **************************************************************************
+// the typedefs
+
+//! \brief Defines one queued window, IQ24 sums
+//!
+typedef struct _WHEELID_Sample_t_
+{
+  int64_t         sumIq;                         //!< the Iq sum over the window, A
+  int64_t         sumSpeed;                      //!< the speed sum over the window, krpm
+  int32_t         speed;                         //!< the speed on the last tick, krpm
+  bool            flag_valid;                    //!< every tick of the window was valid
+} WHEELID_Sample_t;
+
+
+//! \brief Defines the wheel model estimator
+//!
+//!        The settings may be changed from the watch window, the window
+//!        sums are mainISR only and the estimate is the background loop only
+//!
+typedef struct _WHEELID_Obj_
+{
+  // the settings
+  uint_least16_t  decimation;                    //!< ISR ticks per window
+  float           period_sec;                    //!< the window length
+  float           forgetting;                    //!< the forgetting factor, 1 never forgets
+  float           deadband_krpm;                 //!< windows with a slower mean speed are skipped
+  float           maxSpeed_krpm;                 //!< windows with a faster mean speed are skipped, 0 for no limit
+  float           maxTrace;                      //!< the covariance trace past which the forgetting stops
+  uint32_t        minUpdates;                    //!< the windows taken before the estimate is valid
+
+  // the window sums, mainISR only
+  int64_t         sumIq;                         //!< the Iq sum so far, IQ24 A
+  int64_t         sumSpeed;                      //!< the speed sum so far, IQ24 krpm
+  uint_least16_t  count;                         //!< the ticks so far
+  bool            flag_windowValid;              //!< every tick so far was valid
+
+  WHEELID_Sample_t sample[WHEELID_SAMPLE_QUEUE_SIZE];  //!< the queued windows
+  volatile uint_least16_t head;                  //!< written by mainISR only
+  volatile uint_least16_t tail;                  //!< written by the background loop only
+
+  // the estimate, the background loop only
+  float           theta[WHEELID_NUM_PARAMS];     //!< a, b and c of the regression
+  float           P[WHEELID_NUM_PARAMS][WHEELID_NUM_PARAMS];  //!< the covariance
+  float           lastSpeed_krpm;                //!< the speed at the end of the previous window
+  bool            flag_haveLast;                 //!< lastSpeed_krpm holds a window end
+  float           meanSquareError;               //!< the prediction error squared, smoothed with the forgetting factor
+
+  // the published model
+  float           gain_krpmpsPerA;               //!< the wheel acceleration per A, Kt / J
+  float           viscous_ApKrpm;                //!< the Iq that holds the viscous friction, per krpm
+  float           coulomb_A;                     //!< the Iq that holds the Coulomb friction
+  float           residual_krpmps;               //!< the RMS prediction error of the acceleration
+  volatile bool   flag_valid;                    //!< the published model is from enough windows
+
+  uint32_t        numUpdates;                    //!< the number of windows taken
+  uint32_t        numSkipped;                    //!< the number of windows skipped
+  uint32_t        numDropped;                    //!< the number of windows dropped on a full queue
+} WHEELID_Obj;
+
+
+// **************************************************************************
+// the function prototypes
+
+//! \brief     Initializes the estimator with the default settings and no estimate
+//! \param[in] obj         A pointer to the estimator
+//! \param[in] isrFreq_Hz  The WHEELID_putTick() rate
+//! \param[in] decimation  The ISR ticks per window
+extern void WHEELID_init(WHEELID_Obj *obj,const float isrFreq_Hz,const uint_least16_t decimation);
+
+
+//! \brief     Throws the estimate away and starts over, call from the background loop
+//! \param[in] obj  A pointer to the estimator
+extern void WHEELID_reset(WHEELID_Obj *obj);
+
+
+//! \brief     Adds one ISR tick to the window, call from mainISR
+//! \param[in] obj         A pointer to the estimator
+//! \param[in] iq          The measured Iq, IQ24 A
+//! \param[in] speed       The speed, IQ24 krpm
+//! \param[in] flag_valid  False when Iq and the speed do not follow the model on this tick
+extern void WHEELID_putTick(WHEELID_Obj *obj,const int32_t iq,const int32_t speed,const bool flag_valid);
+
+
+//! \brief     Takes the queued windows into the estimate, call from the background loop
+//! \param[in] obj  A pointer to the estimator
+//! \return    The number of windows taken or skipped
+extern uint_least16_t WHEELID_run(WHEELID_Obj *obj);
+
+
+//! \brief     Takes one window into the estimate
+//! \param[in] obj             A pointer to the estimator
+//! \param[in] meanIq_A        The mean Iq over the window
+//! \param[in] meanSpeed_krpm  The mean speed over the window
+//! \param[in] deltaSpeed_krpm The speed change over the window
+//! \return    True if the window was taken, false if it was skipped
+extern bool WHEELID_update(WHEELID_Obj *obj,const float meanIq_A,const float meanSpeed_krpm,const float deltaSpeed_krpm);
+
+
+#ifdef __cplusplus
+}
+#endif // extern "C"
+
+//@} // ingroup
+#endif // end of _WHEELID_H_ definition
@@ -0,0 +1,311 @@
+#ifndef _BALANCE_H_
+#define _BALANCE_H_
+
+//! \file   balance.h
+//! \brief  Contains the balance controller core of the Teensy balance
+//!         controller (rwp-1)
+//!
+//!         The roll estimate from the DMP quaternion and the PD law with its
+//!         clamp, deadband and overtravel cut, as loop() used to run them on
+//!         globals, now on an explicit state.  The law takes two more terms,
+//!         on the wheel speed the F28069 sends back and on the integral of the
+//!         error; their gains default to zero, which leaves the PD law:
+//!
+//!           Balance<T> balance(params);
+//!           T cmd_A = balance.step(sample);
+//!
+//!         T is the scalar type, float on a Teensy 3.x, double on the host,
+//!         or the Q16.16 Fixed16 of fixed16.h for parts without an FPU.  The
+//!         scalar math the core needs is in BalanceMath<T>, named so that the
+//!         Arduino abs() and constrain() macros cannot reach it.  The header has
+//!         no device specific includes, so the same code runs in the sketch,
+//!         in tools/cosim and in tools/balancetest.
+
+
+// **************************************************************************
+// the includes
+
+#include <math.h>
+#include <stdint.h>
+
+
+//!
+//!
+//! \defgroup BALANCE BALANCE
+//!
+//@{
+
+
+namespace rwp
+{
+
+
+// **************************************************************************
+// the defines
+
+//! \brief Defines the DMP quaternion scale, MotionApps 2.0
+//!
+#define BALANCE_QUAT_SCALE          (16384)
+
+//! \brief Defines the gyro counts per unit of the velocity the gains were tuned with
+//!
+#define BALANCE_VELOCITY_SCALE      (100)
+
+//! \brief Defines the IQ24 scale of the torque command payload
+//!
+#define BALANCE_IQ24_SCALE          (16777216.0)
+
+
+// **************************************************************************
+// the typedefs
+
+//! \brief Defines the scalar math of the core, specialized per scalar type
+//!
+template<typename T>
+struct BalanceMath;
+
+
+//! \brief Defines the float math, single precision throughout for the Teensy FPU
+//!
+template<>
+struct BalanceMath<float>
+{
+  static float fromDouble(const double value) { return((float)value); }
+  static float fromCounts(const int32_t counts,const int32_t scale) { return((float)counts / (float)scale); }
+  static float absolute(const float value) { return(fabsf(value)); }
+  static float squareRoot(const float value) { return(sqrtf(value)); }
+  static float atan_deg(const float value) { return(atanf(value) * 57.2957795f); }
+  static float toDouble(const float value) { return((double)value); }
+  static int32_t toIq24(const float value) { return((int32_t)(value * (float)BALANCE_IQ24_SCALE)); }
+  static float fromIq24(const int32_t value) { return((float)value / (float)BALANCE_IQ24_SCALE); }
+};
+
+
+//! \brief Defines the double math, the reference on the host
+//!
+template<>
+struct BalanceMath<double>
+{
+  static double fromDouble(const double value) { return(value); }
+  static double fromCounts(const int32_t counts,const int32_t scale) { return((double)counts / (double)scale); }
+  static double absolute(const double value) { return(fabs(value)); }
+  static double squareRoot(const double value) { return(sqrt(value)); }
+  static double atan_deg(const double value) { return(atan(value) * 57.295779513082321); }
+  static double toDouble(const double value) { return(value); }
+  static int32_t toIq24(const double value) { return((int32_t)(value * BALANCE_IQ24_SCALE)); }
+  static double fromIq24(const int32_t value) { return((double)value / BALANCE_IQ24_SCALE); }
+};
+
+
+//! \brief Defines one DMP packet, as the high words dmpGetQuaternion() and dmpGetGyro() return
+//!
+struct DmpSample
+{
+  int16_t  quat[4];              //!< w, x, y, z in units of 1/BALANCE_QUAT_SCALE
+  int16_t  gyroX;                //!< the X gyro counts
+};
+
+
+//! \brief Defines the controller
+//!
+template<typename T>
+class Balance
+{
+public:
+  //! \brief Defines the gains and limits, the rwp-1 defaults from setDefaultParams()
+  struct Params
+  {
+    T  kp;                       //!< the proportional gain, A per degree
+    T  kd;                       //!< the derivative gain, A per gyro count / 100
+    T  kw;                       //!< the wheel speed gain, A per krpm
+    T  ki;                       //!< the integral gain, A per degree second
+    T  integralLimit_degs;       //!< the error integral clamp
+    T  period_sec;               //!< the step period, for the integral
+    T  setpoint_deg;             //!< the roll at balance
+    T  range_A;                  //!< the command clamp
+    T  deadband_A;               //!< commands smaller than this are zeroed
+    T  overtravel_deg;           //!< the command is zeroed beyond this roll
+  };
+
+  //! \brief Defines the state after the last step
+  struct State
+  {
+    T  roll_deg;                 //!< the roll
+    T  velocity;                 //!< the roll rate, gyro counts / 100
+    T  error;                    //!< setpoint_deg - roll_deg
+    T  pterm;                    //!< the proportional term
+    T  dterm;                    //!< the derivative term
+    T  wheel_krpm;               //!< the last wheel speed from setWheelSpeed_krpm()
+    uint32_t numWheelSpeeds;     //!< the wheel speeds taken
+    T  integral_degs;            //!< the error integral
+    T  wterm;                    //!< the wheel speed term
+    T  iterm;                    //!< the integral term
+    T  motorOutput;              //!< the command, A
+    uint32_t numSteps;           //!< the steps run
+  };
+
+  //! \brief      Sets the rwp-1 gains: kp 18, kd -9, setpoint 2.25 deg, range 20 A, at 100 Hz
+  //! \param[out] pParams  A pointer to the parameters
+  static void setDefaultParams(Params *pParams)
+  {
+    pParams->kp = BalanceMath<T>::fromDouble(18.0);
+    pParams->kd = BalanceMath<T>::fromDouble(-9.0);
+    pParams->kw = BalanceMath<T>::fromDouble(0.0);
+    pParams->ki = BalanceMath<T>::fromDouble(0.0);
+    pParams->integralLimit_degs = BalanceMath<T>::fromDouble(5.0);
+    pParams->period_sec = BalanceMath<T>::fromDouble(0.01);
+    pParams->setpoint_deg = BalanceMath<T>::fromDouble(2.25);
+    pParams->range_A = BalanceMath<T>::fromDouble(20.0);
+    pParams->deadband_A = BalanceMath<T>::fromDouble(0.0);
+    pParams->overtravel_deg = BalanceMath<T>::fromDouble(5.0);
+  }
+
+  //! \brief Constructs the controller with the rwp-1 defaults
+  Balance(void)
+  {
+    setDefaultParams(&m_params);
+    reset();
+  }
+
+  explicit Balance(const Params &params)
+    : m_params(params)
+  {
+    reset();
+  }
+
+  //! \brief Clears the state
+  void reset(void)
+  {
+    const T zero = T();
+
+    m_state.roll_deg = zero;
+    m_state.velocity = zero;
+    m_state.error = zero;
+    m_state.pterm = zero;
+    m_state.dterm = zero;
+    m_state.wheel_krpm = zero;
+    m_state.numWheelSpeeds = 0;
+    m_state.integral_degs = zero;
+    m_state.wterm = zero;
+    m_state.iterm = zero;
+    m_state.motorOutput = zero;
+    m_state.numSteps = 0;
+  }
+
+  //! \brief     Computes the dmpGetYawPitchRoll() roll of a DMP quaternion
+  //! \param[in] quat  The quaternion words, w x y z
+  //! \return    The roll, deg
+  static T getRoll_deg(const int16_t *quat)
+  {
+    // the roll is a ratio of gravity components, so the quaternion is taken
+    // at 4 times its size: exact in float, and 4 more bits for fixed point
+    const T w = BalanceMath<T>::fromCounts(quat[0],BALANCE_QUAT_SCALE / 4);
+    const T x = BalanceMath<T>::fromCounts(quat[1],BALANCE_QUAT_SCALE / 4);
+    const T y = BalanceMath<T>::fromCounts(quat[2],BALANCE_QUAT_SCALE / 4);
+    const T z = BalanceMath<T>::fromCounts(quat[3],BALANCE_QUAT_SCALE / 4);
+
+    // dmpGetGravity()
+    const T gx = (x * z - w * y) + (x * z - w * y);
+    const T gy = (w * x + y * z) + (w * x + y * z);
+    const T gz = w * w - x * x - y * y + z * z;
+
+    return(BalanceMath<T>::atan_deg(gy / BalanceMath<T>::squareRoot(gx * gx + gz * gz)));
+  }
+
+  //! \brief     Runs the controller on one DMP packet
+  //! \param[in] sample  The packet
+  //! \return    The torque command, A
+  T step(const DmpSample &sample)
+  {
+    return(step(getRoll_deg(sample.quat),BalanceMath<T>::fromCounts(sample.gyroX,BALANCE_VELOCITY_SCALE)));
+  }
+
+  //! \brief     Runs the control law on a roll from any estimator
+  //! \param[in] roll_deg  The roll, dmpGetYawPitchRoll() convention
+  //! \param[in] velocity  The roll rate, gyro counts / 100
+  //! \return    The torque command, A
+  T step(const T roll_deg,const T velocity)
+  {
+    const T zero = T();
+    T output;
+
+    m_state.roll_deg = roll_deg;
+    m_state.velocity = velocity;
+    m_state.error = m_params.setpoint_deg - roll_deg;
+    m_state.pterm = m_params.kp * m_state.error;
+    m_state.dterm = velocity * m_params.kd;
+    m_state.wterm = m_params.kw * m_state.wheel_krpm;
+
+    m_state.integral_degs = m_state.integral_degs + m_state.error * m_params.period_sec;
+    m_state.integral_degs = (m_state.integral_degs < -m_params.integralLimit_degs) ? -m_params.integralLimit_degs :
+                            ((m_state.integral_degs > m_params.integralLimit_degs) ? m_params.integralLimit_degs : m_state.integral_degs);
+    m_state.iterm = m_params.ki * m_state.integral_degs;
+
+    output = m_state.pterm + m_state.dterm + m_state.wterm + m_state.iterm;
+    output = (output < -m_params.range_A) ? -m_params.range_A : ((output > m_params.range_A) ? m_params.range_A : output);
+
+    // deadband
+    if(BalanceMath<T>::absolute(output) < m_params.deadband_A)
+      {
+        output = zero;
+      }
+
+    // overtravel, the integral starts over once the pendulum is picked up
+    if(BalanceMath<T>::absolute(roll_deg) > m_params.overtravel_deg)
+      {
+        output = zero;
+        m_state.integral_degs = zero;
+      }
+
+    m_state.motorOutput = output;
+    m_state.numSteps++;
+
+    return(output);
+  }
+
+  //! \brief     Takes the wheel speed the F28069 sends back, used from the next step on
+  //! \param[in] wheel_krpm  The speed, krpm
+  void setWheelSpeed_krpm(const T wheel_krpm)
+  {
+    m_state.wheel_krpm = wheel_krpm;
+    m_state.numWheelSpeeds++;
+  }
+
+  //! \brief  Returns the state after the last step
+  const State &getState(void) const
+  {
+    return(m_state);
+  }
+
+  //! \brief  Returns the parameters, to change the gains between steps
+  Params &getParams(void)
+  {
+    return(m_params);
+  }
+
+  //! \brief     Converts a command to the cmdlink torque payload
+  //! \param[in] cmd_A  The command
+  //! \return    The IQ24 payload
+  static int32_t toPayload(const T cmd_A)
+  {
+    return(BalanceMath<T>::toIq24(cmd_A));
+  }
+
+  //! \brief     Converts a cmdlink speed payload
+  //! \param[in] payload  The IQ24 payload
+  //! \return    The speed, krpm
+  static T fromPayload(const int32_t payload)
+  {
+    return(BalanceMath<T>::fromIq24(payload));
+  }
+
+private:
+  Params  m_params;
+  State   m_state;
+};
+
+
+} // end of rwp namespace
+
+//@} // ingroup
+#endif // end of _BALANCE_H_ definition
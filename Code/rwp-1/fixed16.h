@@ -0,0 +1,183 @@
+#ifndef _FIXED16_H_
+#define _FIXED16_H_
+
+//! \file   fixed16.h
+//! \brief  Contains a Q16.16 fixed point scalar for the balance controller
+//!         core (balance.h), for parts without a floating point unit
+//!
+//!         The range is +-32768 with a resolution of 1/65536, enough for the
+//!         roll in degrees, the gyro rate in counts / 100 and the gain
+//!         products of the rwp-1 law.  Products and quotients go through 64
+//!         bits and round to nearest; nothing saturates, so the gains must
+//!         keep kp * 180 and kd * 328 inside the range.
+//!
+//!         atan is a 9th order odd minimax polynomial on [-1, 1], folded for
+//!         larger arguments, within 1e-5 rad of the true value, and sqrt is
+//!         an integer square root, so the roll from a DMP quaternion matches
+//!         the float result to about 1e-3 deg.
+
+
+// **************************************************************************
+// the includes
+
+#include "balance.h"
+
+
+//!
+//!
+//! \defgroup FIXED16 FIXED16
+//!
+//@{
+
+
+namespace rwp
+{
+
+
+// **************************************************************************
+// the defines
+
+//! \brief Defines the number of fractional bits
+//!
+#define FIXED16_Q                   (16)
+
+
+// **************************************************************************
+// the typedefs
+
+//! \brief Defines the Q16.16 scalar
+//!
+class Fixed16
+{
+public:
+  Fixed16(void) : m_raw(0) {}
+
+  //! \brief Converts a double, rounding to nearest
+  static Fixed16 fromDouble(const double value)
+  {
+    return(fromRaw((int32_t)(value * (double)(1L << FIXED16_Q) + ((value >= 0.0) ? 0.5 : -0.5))));
+  }
+
+  static Fixed16 fromRaw(const int32_t raw)
+  {
+    Fixed16 value;
+
+    value.m_raw = raw;
+
+    return(value);
+  }
+
+  int32_t getRaw(void) const { return(m_raw); }
+
+  double toDouble(void) const { return((double)m_raw / (double)(1L << FIXED16_Q)); }
+
+  Fixed16 operator-(void) const { return(fromRaw(-m_raw)); }
+  Fixed16 operator+(const Fixed16 &b) const { return(fromRaw(m_raw + b.m_raw)); }
+  Fixed16 operator-(const Fixed16 &b) const { return(fromRaw(m_raw - b.m_raw)); }
+
+  Fixed16 operator*(const Fixed16 &b) const
+  {
+    return(fromRaw((int32_t)(((int64_t)m_raw * b.m_raw + (1L << (FIXED16_Q - 1))) >> FIXED16_Q)));
+  }
+
+  Fixed16 operator/(const Fixed16 &b) const
+  {
+    int64_t num = (int64_t)m_raw * (1L << FIXED16_Q);
+    int64_t half = ((num >= 0) == (b.m_raw >= 0)) ? (b.m_raw / 2) : -(b.m_raw / 2);
+
+    return(fromRaw((b.m_raw != 0) ? (int32_t)((num + half) / b.m_raw) : ((m_raw >= 0) ? INT32_MAX : INT32_MIN)));
+  }
+
+  bool operator<(const Fixed16 &b) const { return(m_raw < b.m_raw); }
+  bool operator>(const Fixed16 &b) const { return(m_raw > b.m_raw); }
+
+private:
+  int32_t  m_raw;
+};
+
+
+//! \brief Defines the Q16.16 math
+//!
+template<>
+struct BalanceMath<Fixed16>
+{
+  static Fixed16 fromDouble(const double value) { return(Fixed16::fromDouble(value)); }
+
+  //! \brief Converts 16 bit counts at an integer scale, with one rounded divide
+  static Fixed16 fromCounts(const int32_t counts,const int32_t scale)
+  {
+    return(Fixed16::fromRaw(counts * (1L << FIXED16_Q)) / Fixed16::fromRaw(scale * (1L << FIXED16_Q)));
+  }
+
+  static Fixed16 absolute(const Fixed16 value) { return((value < Fixed16()) ? -value : value); }
+
+  static Fixed16 squareRoot(const Fixed16 value)
+  {
+    uint64_t x = (value.getRaw() > 0) ? ((uint64_t)value.getRaw() << FIXED16_Q) : 0;
+    uint64_t root = 0;
+    uint64_t bit = (uint64_t)1 << 62;
+
+    while(bit > x)
+      {
+        bit >>= 2;
+      }
+
+    while(bit != 0)
+      {
+        if(x >= root + bit)
+          {
+            x -= root + bit;
+            root = (root >> 1) + bit;
+          }
+        else
+          {
+            root >>= 1;
+          }
+
+        bit >>= 2;
+      }
+
+    return(Fixed16::fromRaw((int32_t)root));
+  }
+
+  static Fixed16 atan_deg(const Fixed16 value)
+  {
+    // atan(1/v) = 90 deg - atan(v) for v > 0
+    const Fixed16 one = Fixed16::fromRaw(1L << FIXED16_Q);
+    const bool flag_negative = (value < Fixed16());
+    const Fixed16 v = flag_negative ? -value : value;
+    const bool flag_fold = (v > one);
+    const Fixed16 z = flag_fold ? (one / v) : v;
+    const Fixed16 z2 = z * z;
+
+    // the coefficients are in degrees, raw Q16, so no double math runs on
+    // the target and the last rounding is 1/65536 deg rather than rad
+    Fixed16 angle = Fixed16::fromRaw(78234);                //  0.0208351 rad
+    angle = angle * z2 + Fixed16::fromRaw(-319669);         // -0.0851330 rad
+    angle = angle * z2 + Fixed16::fromRaw(676418);          //  0.1801410 rad
+    angle = angle * z2 + Fixed16::fromRaw(-1240254);        // -0.3302995 rad
+    angle = angle * z2 + Fixed16::fromRaw(3754433);         //  0.9998660 rad
+    angle = angle * z;
+
+    if(flag_fold)
+      {
+        angle = Fixed16::fromRaw(90L << FIXED16_Q) - angle;
+      }
+
+    return(flag_negative ? -angle : angle);
+  }
+
+  static double toDouble(const Fixed16 value) { return(value.toDouble()); }
+
+  //! \brief Converts to IQ24 exactly, the 8 extra bits are zero, for values within +-128
+  static int32_t toIq24(const Fixed16 value) { return((int32_t)((uint32_t)value.getRaw() << (24 - FIXED16_Q))); }
+
+  //! \brief Converts from IQ24, rounding off the 8 extra bits
+  static Fixed16 fromIq24(const int32_t value) { return(Fixed16::fromRaw((int32_t)(((int64_t)value + (1L << (23 - FIXED16_Q))) >> (24 - FIXED16_Q)))); }
+};
+
+
+} // end of rwp namespace
+
+//@} // ingroup
+#endif // end of _FIXED16_H_ definition
@@ -36,6 +36,12 @@
 
 #include "Wire.h"
 
+#include "cmdlink.h"
+
+#include "tiltest.h"
+#include "balance.h"
+#include "setpoint.h"
+
 
 // class default I2C address is 0x68
 // specific I2C addresses may be passed as a parameter here
@@ -83,24 +89,149 @@ VectorInt16 aa;         // [x, y, z]            accel sensor measurements
 VectorInt16 aaReal;     // [x, y, z]            gravity-free accel sensor measurements
 VectorInt16 aaWorld;    // [x, y, z]            world-frame accel sensor measurements
 VectorFloat gravity;    // [x, y, z]            gravity vector
+int16_t packetGyro[3];  // [x, y, z]            gyro from the DMP packet
 float euler[3];         // [psi, theta, phi]    Euler angle container
 float ypr[3];           // [yaw, pitch, roll]   yaw/pitch/roll container and gravity vector
 
-double rolldeg = 0.0;
-
-double error = 0, lastError = 0, currentTime = 0, lastTime = 0, motorOutput = 0,
-       pterm = 0, dterm = 0, measuredVel = 0, velocity = 0, dt = 0;
-
-double kp = 18.0;
-double kd = -9.0;
-double deadband = 0.0;
-double setpoint = 2.25;
-double range = 20.0; // amps
-
-double setpointfilter = .999; //unused
+// the roll estimate and balance law live in balance.h, on the Teensy FPU in
+// single precision. For a part without an FPU include fixed16.h and make
+// this rwp::Fixed16. Gains and limits: balance.getParams(), defaults kp 18,
+// kd -9, setpoint 2.25 deg, range 20 A, deadband 0, overtravel 5 deg.
+typedef float BalanceScalar;
+rwp::Balance<BalanceScalar> balance;
+rwp::DmpSample dmpSample;
 
 unsigned long counter = 0;
 
+// torque command link to the F28069
+CMDLINK_Frame_t cmdFrame;
+uint8_t cmdBuffer[CMDLINK_FRAME_LENGTH];
+uint8_t cmdSeq = 0;
+CMDLINK_Decoder_t cmdDecoder;
+
+// uncomment to step Serial2 up from 115200 to the fastest rate the F28069
+// accepts and that passes a probe, see cmdlink.h
+//#define BAUD_HANDSHAKE
+const uint32_t baudRates[] = {2000000, 1000000, 921600, 460800, 230400};
+uint32_t linkBaud = 115200;
+
+// IMU packet to torque latency, from the F28069 Echo frames, see cmdlink.h.
+// The send stamps stay here, indexed by sequence number, so the command
+// frame keeps its length.  Send 'l' over USB serial to dump, 'r' to reset.
+#define LATENCY_BIN_us 50
+#define LATENCY_NUM_BINS 200
+struct LatencyHist {
+  uint32_t bins[LATENCY_NUM_BINS + 1]; // the last bin collects everything longer
+  uint32_t count;
+  uint32_t min_us;
+  uint32_t max_us;
+};
+LatencyHist latencyApply; // IMU packet read to CTRL_setIq_ref_pu
+LatencyHist latencyPwm;   // IMU packet read to the first PWM update with the new Iq reference
+uint32_t imuStamp[256];   // micros() when the IMU packet behind each command was read
+uint32_t sendStamp[256];  // micros() when each command was written to Serial2
+
+// uncomment to run the balance loop at IMU_RATE_HZ on raw gyro/accel reads
+// fused by the tilt estimator, see tiltest.h, instead of waiting for the
+// 100 Hz DMP packets. The DMP is left off: its quaternion needs the 200 Hz
+// sample rate it was built for, and the raw registers need 1 kHz.
+//#define HIGH_RATE_IMU
+#define IMU_RATE_HZ 1000
+#define IMU_PERIOD_us (1000000 / IMU_RATE_HZ)
+#define IMU_RADIUS_m 0.0f // IMU distance from the pivot, set it to take the swing out of the accelerometer
+// the gyro scale at the +-2000 dps range dmpInitialize() sets, the DMP loop
+// rates and so kd are in these counts; the raw reads are 131 counts per dps
+#define DMP_GYRO_COUNTS_PER_dps 16.4f
+TILTEST_Obj tiltEst;
+int16_t accel[3];         // raw accelerometer counts, x y z
+int16_t gyro[3];          // raw gyro counts, x y z
+uint32_t nextImuMicros = 0;
+uint32_t lastImuMicros = 0;
+bool traceImu = false;    // 't' over USB serial streams the raw samples for tools/tiltreplay
+
+// uncomment to add the wheel speed the F28069 answers each torque command
+// with to the law, see balance.h. The gains are from tools/cosim/rwplqr at
+// its default weights, for the 100 Hz DMP loop; for HIGH_RATE_IMU rerun it
+// with -f 1000, its rate is scaled to the same 16.4 counts per dps.
+//#define FULL_STATE
+#define FULL_STATE_KP 16.80f
+#define FULL_STATE_KD -5.79f
+#define FULL_STATE_KW 7.74f
+
+// uncomment to move the setpoint to the balance point, estimated once a
+// second from the wheel acceleration and the mean command, see setpoint.h.
+// It needs the Speed replies of the F28069. Send 's' over USB serial to print it.
+// Once the F28069 has identified the wheel, its Model frames replace the
+// command scale and the friction, send 'm' to print the model.
+//#define AUTO_SETPOINT
+rwp::SetpointEstimator<BalanceScalar> setpointEst(balance.getParams().setpoint_deg);
+
+// the wheel model from the F28069 Model frames, see proj_lab05a/wheelid.h
+struct WheelModel {
+  float gain_krpmpsPerA;
+  float viscous_ApKrpm;
+  float coulomb_A;
+  uint8_t received;       // bit n set once CMDLINK_Model_e n has arrived
+  uint32_t count;
+};
+WheelModel wheelModel;
+
+// uncomment to start sooner: the MPU6050 gets the 100 ms start-up time of its
+// datasheet instead of 200 ms, the DMP firmware goes up at 400 kHz, and the
+// 8 s wait ends as soon as the F28069 reports OnLine. That is at once only
+// when it has its ADC biases stored, which needs PARAM_STORE and the flash
+// API in its build (see main.h); the default F28069 build stores nothing
+// and still runs its offset calibration first. The wait no longer leaves
+// the DMP 8 s to settle.
+// The DMP firmware cannot be kept across resets: pins 20 and 21 power the
+// MPU6050, so it is reloaded every boot.
+//#define FAST_BOOT
+#define BOOT_WAIT_ms 8000
+#define BOOT_REQUEST_PERIOD_ms 100
+
+// boot timeline, micros() at the end of each setup() step and at the first
+// torque command. Send 'b' over USB serial to print it and ask the F28069
+// for its own, see tools/boottime
+enum BootStep {
+  BOOT_Setup,       // reset to setup()
+  BOOT_Power,       // the MPU6050 start-up wait
+  BOOT_Links,       // I2C, USB serial, Serial2 and the estimators
+  BOOT_MpuInit,     // mpu.initialize() and the connection test
+  BOOT_DmpLoad,     // mpu.dmpInitialize(), the DMP firmware upload, and the offsets
+  BOOT_DmpEnable,   // the DMP or the raw reads enabled
+  BOOT_Wait,        // the wait for the F28069
+  BOOT_Baud,        // the baud rate handshake
+  BOOT_FirstTorque, // the first torque command sent
+  BOOT_NumSteps
+};
+const char *const bootStepNames[BOOT_NumSteps] = {
+  "setup", "power", "links", "mpu_init", "dmp_load", "dmp_enable", "wait", "baud", "first_torque"
+};
+uint32_t bootStamp[BOOT_NumSteps];
+uint16_t bootMask = 0;        // bit n set once BootStep n has ended
+uint16_t f28069BootMask = 0;  // bit n set once the F28069 sent CMDLINK_Boot_e n
+
+// uncomment to read the DMP packet the old way, with INT_STATUS, a polled
+// FIFO count and a separate getRotationX(), to compare the bus time
+//#define DMP_READ_LEGACY
+
+// control loop period, from one IMU read to the next, and the I2C bus time
+// spent reading the IMU each iteration. Send 'f' over USB serial to print
+// the rate, jitter and bus time, 'r' resets them with the latency.
+struct LoopStats {
+  bool started;
+  uint32_t count;
+  uint32_t min_us;
+  uint32_t max_us;
+  uint32_t last_us;
+  uint64_t sum_us;
+  uint64_t sumSq_us;
+  uint32_t busCount;
+  uint32_t busMax_us;
+  uint64_t busSum_us;
+};
+LoopStats loopStats;
+
 // ================================================================
 // ===               INTERRUPT DETECTION ROUTINE                ===
 // ================================================================
@@ -112,23 +243,377 @@ void dmpDataReady() {
 
 
 
+// ================================================================
+// ===                  BAUD RATE HANDSHAKE                     ===
+// ================================================================
+
+// sends one frame to the F28069 without waiting for it to go out, it fits
+// the transmit buffer, so it can be called while the balance loop runs
+void sendCmdFrame(uint8_t type, int32_t payload) {
+  cmdFrame.seq = cmdSeq++;
+  cmdFrame.type = type;
+  cmdFrame.payload = payload;
+  CMDLINK_encode(cmdBuffer, &cmdFrame);
+  Serial2.write(cmdBuffer, CMDLINK_FRAME_LENGTH);
+}
+
+// waits for a reply from the F28069, telemetry frames are skipped whole by CMDLINK_decodeMixed()
+bool waitCmdFrame(CMDLINK_Frame_t *pFrame, unsigned long timeout_ms) {
+  unsigned long start = millis();
+  while (millis() - start < timeout_ms) {
+    while (Serial2.available()) {
+      if (CMDLINK_decodeMixed(&cmdDecoder, (uint8_t)Serial2.read(), pFrame) &&
+          pFrame->type != CMDLINK_Type_Torque) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+// tries the rates fastest first, keeps the first one that passes the probe
+void negotiateBaudRate() {
+  CMDLINK_Frame_t reply;
+
+  for (unsigned int i = 0; i < sizeof(baudRates) / sizeof(baudRates[0]); i++) {
+    while (Serial2.available()) Serial2.read();
+    CMDLINK_initDecoder(&cmdDecoder);
+
+    sendCmdFrame(CMDLINK_Type_BaudRequest, (int32_t)baudRates[i]);
+    if (!waitCmdFrame(&reply, 50) || reply.type != CMDLINK_Type_BaudAck) {
+      continue; // refused or no answer, try the next rate
+    }
+
+    // the F28069 switches once its Ack is out, follow it to the rate it really runs at
+    uint32_t actualBaud = (uint32_t)reply.payload;
+    Serial2.begin(actualBaud);
+    CMDLINK_initDecoder(&cmdDecoder);
+    delay(5);
+
+    sendCmdFrame(CMDLINK_Type_BaudProbe, CMDLINK_PROBE_PATTERN);
+    if (waitCmdFrame(&reply, 50) && reply.type == CMDLINK_Type_BaudProbeAck &&
+        reply.payload == CMDLINK_PROBE_PATTERN) {
+      linkBaud = actualBaud;
+      Serial.print(F("Serial2 running at "));
+      Serial.println(linkBaud);
+      return;
+    }
+
+    // no good at this rate, the F28069 falls back on its own after the probe timeout
+    Serial2.begin(linkBaud);
+    delay(CMDLINK_PROBE_TIMEOUT_ms + 50);
+  }
+
+  Serial.println(F("Serial2 staying at 115200"));
+}
+
+
+
+// ================================================================
+// ===                      BOOT TIMELINE                       ===
+// ================================================================
+
+// keeps the first end time of a step
+void markBootStep(BootStep step) {
+  if (bootMask & (1 << step)) return;
+  bootStamp[step] = micros();
+  bootMask |= 1 << step;
+}
+
+// prints a BootMark frame from the F28069 as it comes, boottime keeps the last of each
+void takeBootMark(uint8_t phase, int32_t time_us) {
+  if (phase >= CMDLINK_NumBootPhases) return;
+  f28069BootMask |= 1 << phase;
+  Serial.print(F("boot f28069 "));
+  Serial.print(phase);
+  Serial.print(" ");
+  Serial.println((uint32_t)time_us);
+}
+
+// prints the steps done so far and asks the F28069 for its timeline
+void printBootTimeline() {
+  for (int i = 0; i < BOOT_NumSteps; i++) {
+    if (!(bootMask & (1 << i))) continue;
+    Serial.print(F("boot teensy "));
+    Serial.print(bootStepNames[i]);
+    Serial.print(" ");
+    Serial.println(bootStamp[i]);
+  }
+  sendCmdFrame(CMDLINK_Type_BootRequest, 0);
+}
+
+#ifdef FAST_BOOT
+// asks for the F28069 timeline until it answers, then waits for its OnLine
+// mark, at most BOOT_WAIT_ms
+void waitForF28069() {
+  CMDLINK_Frame_t frame;
+  unsigned long start = millis();
+  unsigned long lastRequest = start - BOOT_REQUEST_PERIOD_ms;
+
+  while (millis() - start < BOOT_WAIT_ms && !(f28069BootMask & (1 << CMDLINK_Boot_OnLine))) {
+    if (f28069BootMask == 0 && millis() - lastRequest >= BOOT_REQUEST_PERIOD_ms) {
+      sendCmdFrame(CMDLINK_Type_BootRequest, 0);
+      lastRequest = millis();
+    }
+    while (Serial2.available()) {
+      if (CMDLINK_decodeMixed(&cmdDecoder, (uint8_t)Serial2.read(), &frame) &&
+          frame.type == CMDLINK_Type_BootMark) {
+        takeBootMark(frame.seq, frame.payload);
+      }
+    }
+  }
+}
+#endif
+
+
+
+// ================================================================
+// ===                   LATENCY MEASUREMENT                    ===
+// ================================================================
+
+void resetLatency(LatencyHist *pHist) {
+  memset(pHist, 0, sizeof(*pHist));
+  pHist->min_us = 0xFFFFFFFF;
+}
+
+void addLatency(LatencyHist *pHist, uint32_t latency_us) {
+  uint32_t bin = latency_us / LATENCY_BIN_us;
+  pHist->bins[bin < LATENCY_NUM_BINS ? bin : LATENCY_NUM_BINS]++;
+  pHist->count++;
+  if (latency_us < pHist->min_us) pHist->min_us = latency_us;
+  if (latency_us > pHist->max_us) pHist->max_us = latency_us;
+}
+
+// upper edge of the bin holding the given fraction of the samples
+uint32_t getLatencyPercentile(const LatencyHist *pHist, uint32_t percent) {
+  uint32_t target = (pHist->count * percent + 99) / 100;
+  uint32_t sum = 0;
+  for (uint32_t i = 0; i <= LATENCY_NUM_BINS; i++) {
+    sum += pHist->bins[i];
+    if (sum >= target) return (i < LATENCY_NUM_BINS) ? (i + 1) * LATENCY_BIN_us : pHist->max_us;
+  }
+  return pHist->max_us;
+}
+
+void resetLoopStats(LoopStats *pStats) {
+  memset(pStats, 0, sizeof(*pStats));
+  pStats->min_us = 0xFFFFFFFF;
+}
+
+// takes the time of each IMU read and returns the period since the last
+// one, 0 for the first, which only starts the count
+uint32_t addLoopPeriod(LoopStats *pStats, uint32_t now_us) {
+  uint32_t period = 0;
+  if (pStats->started) {
+    period = now_us - pStats->last_us;
+    pStats->count++;
+    pStats->sum_us += period;
+    pStats->sumSq_us += (uint64_t)period * period;
+    if (period < pStats->min_us) pStats->min_us = period;
+    if (period > pStats->max_us) pStats->max_us = period;
+  }
+  pStats->last_us = now_us;
+  pStats->started = true;
+  return period;
+}
+
+void addBusTime(LoopStats *pStats, uint32_t bus_us) {
+  pStats->busCount++;
+  pStats->busSum_us += bus_us;
+  if (bus_us > pStats->busMax_us) pStats->busMax_us = bus_us;
+}
+
+void printLoopStats(const LoopStats *pStats) {
+  Serial.print(F("loop n="));
+  Serial.print(pStats->count);
+  if (pStats->count == 0) {
+    Serial.println();
+    return;
+  }
+  // the sums stay exact in integers, the variance is split into the integer
+  // quotients and the remainders so the float does not lose it to the mean^2
+  uint32_t meanInt = (uint32_t)(pStats->sum_us / pStats->count);
+  float meanFrac = (float)(pStats->sum_us % pStats->count) / pStats->count;
+  float mean = meanInt + meanFrac;
+  float var = (float)((int64_t)(pStats->sumSq_us / pStats->count) - (int64_t)meanInt * meanInt) +
+              (float)(pStats->sumSq_us % pStats->count) / pStats->count - meanFrac * (2.0f * meanInt + meanFrac);
+  Serial.print(F(" rate="));
+  Serial.print(1.0e6f / mean);
+  Serial.print(F(" Hz period mean="));
+  Serial.print(mean);
+  Serial.print(F(" min="));
+  Serial.print(pStats->min_us);
+  Serial.print(F(" max="));
+  Serial.print(pStats->max_us);
+  Serial.print(F(" jitter rms="));
+  Serial.print(var > 0.0f ? sqrtf(var) : 0.0f);
+  Serial.print(F(" us i2c mean="));
+  Serial.print(pStats->busCount != 0 ? (float)pStats->busSum_us / pStats->busCount : 0.0f);
+  Serial.print(F(" max="));
+  Serial.print(pStats->busMax_us);
+  Serial.println(F(" us"));
+}
+
+void printLatency(const __FlashStringHelper *pName, const LatencyHist *pHist) {
+  Serial.print(pName);
+  Serial.print(F(" n="));
+  Serial.print(pHist->count);
+  if (pHist->count == 0) {
+    Serial.println();
+    return;
+  }
+  Serial.print(F(" min="));
+  Serial.print(pHist->min_us);
+  Serial.print(F(" p50<="));
+  Serial.print(getLatencyPercentile(pHist, 50));
+  Serial.print(F(" p99<="));
+  Serial.print(getLatencyPercentile(pHist, 99));
+  Serial.print(F(" max="));
+  Serial.print(pHist->max_us);
+  Serial.println(F(" us"));
+}
+
+// keeps one wheel model parameter, and once all have arrived hands the
+// model to the setpoint estimator
+void takeWheelModel(int32_t payload) {
+  int32_t value = CMDLINK_getParamValue(payload);
+
+  switch (CMDLINK_getParamId(payload)) {
+    case CMDLINK_Model_Gain_rpmpsPerA:  wheelModel.gain_krpmpsPerA = value * 0.001f; break;
+    case CMDLINK_Model_Viscous_mApKrpm: wheelModel.viscous_ApKrpm = value * 0.001f; break;
+    case CMDLINK_Model_Coulomb_mA:      wheelModel.coulomb_A = value * 0.001f; break;
+    default: return;
+  }
+  wheelModel.received |= 1 << CMDLINK_getParamId(payload);
+  wheelModel.count++;
+
+#ifdef AUTO_SETPOINT
+  if (wheelModel.received == (1 << CMDLINK_NumModelParams) - 1) {
+    rwp::SetpointEstimator<BalanceScalar>::Params &params = setpointEst.getParams();
+    params.degPerA = params.degPerKrpmps * rwp::BalanceMath<BalanceScalar>::fromDouble(wheelModel.gain_krpmpsPerA);
+    params.friction_A = rwp::BalanceMath<BalanceScalar>::fromDouble(wheelModel.coulomb_A);
+    params.viscous_ApKrpm = rwp::BalanceMath<BalanceScalar>::fromDouble(wheelModel.viscous_ApKrpm);
+  }
+#endif
+}
+
+// reads Echo, Speed and Model frames from the F28069, telemetry frames are skipped whole by CMDLINK_decodeMixed()
+void serviceLatency() {
+  CMDLINK_Frame_t echo;
+
+  while (Serial2.available()) {
+    if (!CMDLINK_decodeMixed(&cmdDecoder, (uint8_t)Serial2.read(), &echo)) {
+      continue;
+    }
+    if (echo.type == CMDLINK_Type_Speed) {
+      // taken by the next balance.step(), kw is 0 unless FULL_STATE
+      balance.setWheelSpeed_krpm(rwp::Balance<BalanceScalar>::fromPayload(echo.payload));
+    } else if (echo.type == CMDLINK_Type_Model) {
+      takeWheelModel(echo.payload);
+    } else if (echo.type == CMDLINK_Type_BootMark) {
+      takeBootMark(echo.seq, echo.payload);
+    } else if (echo.type == CMDLINK_Type_Echo) {
+      uint32_t now = micros();
+      uint32_t rxToApply = CMDLINK_getEchoRxToApply_us(echo.payload);
+      uint32_t applyToPwm = CMDLINK_getEchoApplyToPwm_us(echo.payload);
+      uint32_t roundTrip = now - sendStamp[echo.seq];
+      // the wire time each way is taken as half of what the F28069 did not account for
+      uint32_t wire = (roundTrip > rxToApply + applyToPwm) ? (roundTrip - rxToApply - applyToPwm) / 2 : 0;
+      uint32_t toApply = (sendStamp[echo.seq] - imuStamp[echo.seq]) + wire + rxToApply;
+
+      addLatency(&latencyApply, toApply);
+      addLatency(&latencyPwm, toApply + applyToPwm);
+    }
+  }
+
+  while (Serial.available()) {
+    char c = Serial.read();
+    if (c == 'l') {
+      printLatency(F("imu->apply"), &latencyApply);
+      printLatency(F("imu->pwm"), &latencyPwm);
+    } else if (c == 'f') {
+      printLoopStats(&loopStats);
+    } else if (c == 'r') {
+      resetLatency(&latencyApply);
+      resetLatency(&latencyPwm);
+      resetLoopStats(&loopStats);
+    } else if (c == 's') {
+      const rwp::SetpointEstimator<BalanceScalar>::State &est = setpointEst.getState();
+      Serial.print(F("setpoint="));
+      Serial.print(balance.getParams().setpoint_deg, 3);
+      Serial.print(F(" lean="));
+      Serial.print(est.lean_deg, 3);
+      Serial.print(F(" wheel="));
+      Serial.print(est.meanWheel_krpm, 3);
+      Serial.print(F(" windows="));
+      Serial.print(est.numWindows);
+      Serial.print(F(" skipped="));
+      Serial.print(est.numSkipped);
+      Serial.println(est.flag_converged ? F(" converged") : F(""));
+    } else if (c == 'm') {
+      Serial.print(F("gain="));
+      Serial.print(wheelModel.gain_krpmpsPerA, 3);
+      Serial.print(F(" krpm/s/A viscous="));
+      Serial.print(wheelModel.viscous_ApKrpm, 4);
+      Serial.print(F(" A/krpm coulomb="));
+      Serial.print(wheelModel.coulomb_A, 3);
+      Serial.print(F(" A frames="));
+      Serial.println(wheelModel.count);
+    } else if (c == 't') {
+      traceImu = !traceImu;
+      if (traceImu) Serial.println(F("t_us,ax,ay,az,gx,gy,gz"));
+    } else if (c == 'b') {
+      printBootTimeline();
+    }
+  }
+}
+
+
+
 // ================================================================
 // ===                      INITIAL SETUP                       ===
 // ================================================================
 
 void setup() {
+  markBootStep(BOOT_Setup);
   pinMode(21, OUTPUT);
   pinMode(20, OUTPUT);
   digitalWrite(21, HIGH);
   digitalWrite(20, LOW);
+#ifdef FAST_BOOT
+  delay(100); // the mpu6050 start-up time, datasheet maximum
+#else
   delay(200); // wait for mpu6050 to boot up
+#endif
+  markBootStep(BOOT_Power);
   // join I2C bus (I2Cdev library doesn't do this automatically)
   Wire.begin();
+#ifdef HIGH_RATE_IMU
+  Wire.setClock(400000); // a getMotion6() read is 17 bytes, about 0.4 ms at 400 kHz
+#else
   //Wire.setClock(400000); // 400kHz I2C clock. Comment this line if having compilation difficulties
+#endif
 
   Serial.begin(9600); // this is actually much faster since it is over usb
 
-  Serial2.begin(115200); // this is the actual speed of Serial2
+  Serial2.begin(linkBaud); // this is the actual speed of Serial2
+  CMDLINK_initDecoder(&cmdDecoder);
+  resetLatency(&latencyApply);
+  resetLatency(&latencyPwm);
+  resetLoopStats(&loopStats);
+  TILTEST_init(&tiltEst, TILTEST_DEFAULT_TAU_sec, TILTEST_DEFAULT_GATE_g, IMU_RADIUS_m);
+
+#ifdef HIGH_RATE_IMU
+  balance.getParams().period_sec = 1.0f / IMU_RATE_HZ;
+#endif
+#ifdef FULL_STATE
+  balance.getParams().kp = FULL_STATE_KP;
+  balance.getParams().kd = FULL_STATE_KD;
+  balance.getParams().kw = FULL_STATE_KW;
+#endif
+  setpointEst.getParams().period_sec = balance.getParams().period_sec;
+  setpointEst.reset(balance.getParams().setpoint_deg);
+  markBootStep(BOOT_Links);
 
   // initialize device
   Serial.println(F("Initializing I2C devices..."));
@@ -138,10 +623,18 @@ void setup() {
   // verify connection
   Serial.println(F("Testing device connections..."));
   Serial.println(mpu.testConnection() ? F("MPU6050 connection successful") : F("MPU6050 connection failed"));
+  markBootStep(BOOT_MpuInit);
 
+#ifndef HIGH_RATE_IMU
+#ifdef FAST_BOOT
+  Wire.setClock(400000); // the firmware upload is most of dmpInitialize()
+#endif
   // load and configure the DMP
   Serial.println(F("Initializing DMP..."));
   devStatus = mpu.dmpInitialize();
+#else
+  devStatus = 0;
+#endif
 
   // supply your own gyro offsets here, scaled for min sensitivity
   // Use IMU_Zero to find the proper offsets
@@ -151,7 +644,15 @@ void setup() {
   mpu.setXAccelOffset(-2397);
   mpu.setYAccelOffset(-1303);
   mpu.setZAccelOffset(1600);
-
+  markBootStep(BOOT_DmpLoad);
+
+#ifdef HIGH_RATE_IMU
+  // 1 kHz gyro output with the widest filter, sampled without division
+  mpu.setDLPFMode(MPU6050_DLPF_BW_188);
+  mpu.setRate(1000 / IMU_RATE_HZ - 1);
+  Serial.println(F("Raw IMU reads ready"));
+  dmpReady = true;
+#else
   // make sure it worked (returns 0 if so)
   if (devStatus == 0) {
     // turn on the DMP, now that it's ready
@@ -178,11 +679,125 @@ void setup() {
     Serial.print(devStatus);
     Serial.println(F(")"));
   }
+#endif
+
+  markBootStep(BOOT_DmpEnable);
 
   // configure LED for output
   pinMode(LED_PIN, OUTPUT);
 
-  delay(8000);
+#ifdef FAST_BOOT
+  waitForF28069();
+#else
+  delay(BOOT_WAIT_ms);
+#endif
+  markBootStep(BOOT_Wait);
+
+#ifdef BAUD_HANDSHAKE
+  negotiateBaudRate();
+#endif
+  markBootStep(BOOT_Baud);
+
+  nextImuMicros = micros();
+}
+
+
+
+// ================================================================
+// ===                    BALANCE CONTROLLER                    ===
+// ================================================================
+
+// sends the torque command balance.step() returned, imuMicros is when the
+// IMU data behind it was read
+void runController(uint32_t imuMicros, BalanceScalar motorOutput) {
+    counter++;
+    uint32_t period_us = addLoopPeriod(&loopStats, imuMicros);
+
+    // the cycle frequency and jitter are kept in loopStats, send 'f' to print them.
+    // In the DMP loop it is stuck at 100hz because every loop waits for new data
+    // from the IMU, which comes in at 100hz. HIGH_RATE_IMU runs at IMU_RATE_HZ.
+
+    // send the torque command as a binary frame, amps in IQ24
+    cmdFrame.seq = cmdSeq++;
+    cmdFrame.type = CMDLINK_Type_Torque;
+    cmdFrame.payload = rwp::Balance<BalanceScalar>::toPayload(motorOutput);
+    CMDLINK_encode(cmdBuffer, &cmdFrame);
+    imuStamp[cmdFrame.seq] = imuMicros;
+    sendStamp[cmdFrame.seq] = micros();
+    Serial2.write(cmdBuffer, CMDLINK_FRAME_LENGTH);
+    markBootStep(BOOT_FirstTorque);
+
+#ifdef AUTO_SETPOINT
+    // the next step runs on the setpoint the window ending here estimated
+    balance.getParams().setpoint_deg = setpointEst.step(balance.getState(), balance.getParams().range_A);
+#endif
+
+    // blink LED to indicate activity
+    blinkState = !blinkState;
+    digitalWrite(LED_PIN, blinkState);
+
+//#define PRINT
+#ifdef PRINT
+      if(counter%5==0) {
+      const rwp::Balance<BalanceScalar>::State &state = balance.getState();
+      Serial.print(state.roll_deg);
+      Serial.print(",");
+      Serial.print(balance.getParams().setpoint_deg);
+      Serial.print(",");
+      Serial.print(state.motorOutput);
+      Serial.print(",");
+      Serial.print(state.velocity);
+      Serial.print(",");
+      Serial.print(period_us != 0 ? 1.0e6f / period_us : 0.0f);
+      Serial.print("\n");
+      }
+#endif
+}
+
+
+
+// ================================================================
+// ===                     HIGH RATE IMU LOOP                   ===
+// ================================================================
+
+// reads the raw gyro and accelerometer on a fixed IMU_PERIOD_us schedule
+// and runs the controller on the tilt estimate
+void runHighRateLoop() {
+  uint32_t now = micros();
+
+  if ((int32_t)(now - nextImuMicros) < 0) {
+    serviceLatency();
+    return;
+  }
+
+  // keep the schedule unless a read is a whole period late, then start over
+  nextImuMicros += IMU_PERIOD_us;
+  if ((int32_t)(now - nextImuMicros) >= 0) nextImuMicros = now + IMU_PERIOD_us;
+
+  mpu.getMotion6(&accel[0], &accel[1], &accel[2], &gyro[0], &gyro[1], &gyro[2]);
+  uint32_t imuMicros = micros();
+  addBusTime(&loopStats, imuMicros - now);
+
+  TILTEST_run(&tiltEst, accel, gyro[0],
+              lastImuMicros != 0 ? (imuMicros - lastImuMicros) * 1.0e-6f : 1.0f / IMU_RATE_HZ);
+  lastImuMicros = imuMicros;
+
+  // the rate in DMP gyro counts / 100, the units kd was tuned in
+  runController(imuMicros, balance.step(TILTEST_getAngle_deg(&tiltEst),
+                                        TILTEST_getRate_dps(&tiltEst) * DMP_GYRO_COUNTS_PER_dps / 100.0f));
+
+  if (traceImu) {
+    Serial.print(imuMicros);
+    for (int i = 0; i < 3; i++) {
+      Serial.print(",");
+      Serial.print(accel[i]);
+    }
+    for (int i = 0; i < 3; i++) {
+      Serial.print(",");
+      Serial.print(gyro[i]);
+    }
+    Serial.print("\n");
+  }
 }
 
 
@@ -194,6 +809,12 @@ void setup() {
 void loop() {
   // if programming failed, don't try to do anything
   if (!dmpReady) return;
+
+#ifdef HIGH_RATE_IMU
+  runHighRateLoop();
+  return;
+#endif
+
   // wait for MPU interrupt or extra packet(s) available
   while (!mpuInterrupt && fifoCount < packetSize) {
     // other program behavior stuff here
@@ -206,12 +827,14 @@ void loop() {
     // .
     // .
     // .
-    
+    serviceLatency();
 
   }
 
+#ifdef DMP_READ_LEGACY
   // reset interrupt flag and get INT_STATUS byte
   mpuInterrupt = false;
+  uint32_t busStart = micros();
   mpuIntStatus = mpu.getIntStatus();
 
   // get current FIFO count
@@ -226,79 +849,61 @@ void loop() {
     // otherwise, check for DMP data ready interrupt (this should happen frequently)
   } else if (mpuIntStatus & 0x02) {
 
-    counter++;
-    
     // wait for correct available data length, should be a VERY short wait
     while (fifoCount < packetSize) fifoCount = mpu.getFIFOCount();
 
     // read a packet from FIFO
     mpu.getFIFOBytes(fifoBuffer, packetSize);
+    uint32_t imuMicros = micros();
+    uint32_t busTime = imuMicros - busStart;
 
     // track FIFO count here in case there is > 1 packet available
     // (this lets us immediately read more without waiting for an interrupt)
     fifoCount -= packetSize;
 
-    mpu.dmpGetQuaternion(&q, fifoBuffer);
-    mpu.dmpGetGravity(&gravity, &q);
-    mpu.dmpGetYawPitchRoll(ypr, &q, &gravity);
-
-    rolldeg = ypr[2] * 180 / M_PI; // convert from rad to degrees
-    velocity = mpu.getRotationX() / 100.0;
-
-    // Here are some attempts at a setpoint adjustment system.
-    //if(abs(rolldeg)<5.0 && abs(velocity)<.05 && motorOutput<2.0) setpoint = setpoint - (.001 * (setpoint - rolldeg));
-
-    //if(abs(rolldeg)<5.0) setpoint = setpointfilter * setpoint - ((1 - setpointfilter) * (setpoint - rolldeg));
-    
-    error = setpoint - rolldeg;
+    mpu.dmpGetQuaternion(dmpSample.quat, fifoBuffer);
+    busStart = micros();
+    dmpSample.gyroX = mpu.getRotationX();
+    addBusTime(&loopStats, busTime + (micros() - busStart));
 
-    pterm = kp * error;
-
-    currentTime = (double)micros() / (double)1000000;
-    dt = currentTime - lastTime;
-
-    //measuredVel = ((error-lastError)/dt); // No longer used. This is numerical differentiation.
-    //velocity = velocity - (beta * (velocity - measuredVel));
-    
-    dterm = velocity * kd;
-
-    // uncomment this to get the cycle frequency. It is stuck at 100hz in my testing because every loop it waits for new data from the IMU, which comes in at 100hz.
-    //Serial.print("CYCLE Hz: ");
-    //Serial.println(1/dt);
-
-    motorOutput = pterm + dterm;
-    
-    lastError = error;
-    lastTime = currentTime;
-    
-    motorOutput = constrain(motorOutput, -range, range);
-
-    if (abs(motorOutput) < deadband) motorOutput = 0.0; // deadband
-
-    if (abs(rolldeg) > 5.0) motorOutput = 0.0; // overtravel
+    runController(imuMicros, balance.step(dmpSample));
+  }
+#else
+  // One FIFO count read and the packet reads. INT_STATUS is not read: the
+  // INT pin is not latched, and an overflow shows up as a full FIFO. A count
+  // that is not whole packets is the DMP still writing the next one, so the
+  // whole packets are read and the rest is left for the next pass.
+  mpuInterrupt = false;
+  uint32_t busStart = micros();
+  fifoCount = mpu.getFIFOCount();
 
-    Serial2.print(motorOutput);
-    Serial2.print("a");
+  if (fifoCount >= 1024) {
+    // reset so we can continue cleanly
+    mpu.resetFIFO();
+    fifoCount = 0;
+    Serial.println(F("FIFO overflow!"));
+    return;
+  }
 
-    // blink LED to indicate activity
-    blinkState = !blinkState;
-    digitalWrite(LED_PIN, blinkState);
+  // wait for correct available data length, should be a VERY short wait
+  while (fifoCount < packetSize) fifoCount = mpu.getFIFOCount();
 
-//#define PRINT
-#ifdef PRINT
-      if(counter%5==0) {
-      Serial.print(rolldeg);
-      Serial.print(",");
-      Serial.print(setpoint);
-      Serial.print(",");
-      Serial.print(motorOutput);
-      Serial.print(",");
-      Serial.print(velocity);
-      Serial.print(",");
-      Serial.print(1/dt);
-      Serial.print("\n");
-      }
-#endif
+  // drain to the newest whole packet, a queued older one would only add latency
+  while (fifoCount >= packetSize) {
+    mpu.getFIFOBytes(fifoBuffer, packetSize);
+    fifoCount -= packetSize;
   }
+  uint32_t imuMicros = micros();
+  addBusTime(&loopStats, imuMicros - busStart);
+
+  // the quaternion words and the packet gyro, the raw gyro at the DMP's
+  // 2000 dps range, the same counts getRotationX() returned, but sampled
+  // with the quaternion. balance.step() takes the roll from the quaternion
+  // as dmpGetYawPitchRoll() did.
+  mpu.dmpGetQuaternion(dmpSample.quat, fifoBuffer);
+  mpu.dmpGetGyro(packetGyro, fifoBuffer);
+  dmpSample.gyroX = packetGyro[0];
+
+  runController(imuMicros, balance.step(dmpSample));
+#endif
 }
-
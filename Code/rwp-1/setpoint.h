@@ -0,0 +1,281 @@
+#ifndef _SETPOINT_H_
+#define _SETPOINT_H_
+
+//! \file   setpoint.h
+//! \brief  Contains the balance point estimator of the Teensy balance
+//!         controller (rwp-1)
+//!
+//!         A setpoint off the true balance point leaves the pendulum leaning,
+//!         and the lean can only be held by torque that spins the wheel up.
+//!         The motor torque is internal to the pendulum, so over a window
+//!         where the lean rate averages out
+//!
+//!           mgl * mean lean = Jw * mean wheel acceleration
+//!                           = Kt * mean command - mean friction torque
+//!
+//!         Every window_sec the estimator takes the mean lean from the mean
+//!         wheel acceleration, from the speed the F28069 sends back, and from
+//!         the mean command less the friction, blends the two, and moves the
+//!         setpoint by a fraction of it.  The acceleration is exact but
+//!         noisy, the command smooth but only as good as the friction
+//!         values.  The target is not zero lean but the lean that brings the
+//!         wheel to rest in momentumTau_sec, so the wheel momentum goes to
+//!         zero and stays there.
+//!
+//!         Windows in which the pendulum was not balancing (error beyond
+//!         gate_deg, a clamped command) or that had too few speed replies
+//!         are skipped.  Each correction is limited to maxRate_degps and the
+//!         setpoint to range_deg around where it started.
+//!
+//!           SetpointEstimator<T> estimator(params,balance.getParams().setpoint_deg);
+//!           balance.step(sample);
+//!           balance.getParams().setpoint_deg = estimator.step(balance.getState(),balance.getParams().range_A);
+//!
+//!         The two scales, degrees of lean per krpm/s of wheel acceleration
+//!         and per A of command, are Jw / mgl and Kt / mgl; the defaults are
+//!         those of the tools/cosim plant.  Their signs assume the rwp-1
+//!         convention that a positive command raises the roll.  With the
+//!         wheel model the F28069 identifies, see proj_lab05a/wheelid.h,
+//!         degPerA is degPerKrpmps times its gain and the friction its
+//!         Coulomb and viscous terms.
+
+
+// **************************************************************************
+// the includes
+
+#include "balance.h"
+
+
+//!
+//!
+//! \defgroup SETPOINT SETPOINT
+//!
+//@{
+
+
+namespace rwp
+{
+
+
+// **************************************************************************
+// the typedefs
+
+//! \brief Defines the balance point estimator
+//!
+template<typename T>
+class SetpointEstimator
+{
+public:
+  //! \brief Defines the estimator settings, the defaults from setDefaultParams()
+  struct Params
+  {
+    T  period_sec;               //!< the Balance step period
+    T  window_sec;               //!< the averaging window
+    T  degPerKrpmps;             //!< the lean per wheel acceleration, Jw / mgl
+    T  degPerA;                  //!< the lean per command, Kt / mgl
+    T  commandWeight;            //!< the share of the command based lean, 0 to 1
+    T  friction_A;               //!< the Coulomb friction of the wheel, as command
+    T  viscous_ApKrpm;           //!< the viscous friction of the wheel, as command per krpm
+    T  momentumTau_sec;          //!< the time to bring the wheel to rest, 0 only stops the acceleration
+    T  gain;                     //!< the fraction of the estimated lean corrected per window
+    T  maxRate_degps;            //!< the setpoint rate limit
+    T  range_deg;                //!< the setpoint limit around the initial setpoint
+    T  gate_deg;                 //!< windows with a larger error are skipped
+    T  converged_deg;            //!< corrections smaller than this count as converged
+  };
+
+  //! \brief Defines the state after the last window
+  struct State
+  {
+    T  setpoint_deg;             //!< the setpoint
+    T  meanWheel_krpm;           //!< the mean wheel speed over the last window
+    T  wheelAccel_krpmps;        //!< the mean wheel acceleration between the last two windows
+    T  meanCommand_A;            //!< the mean command over the last window
+    T  lean_deg;                 //!< the estimated mean lean from the balance point
+    T  correction_deg;           //!< the last setpoint change
+    bool flag_converged;         //!< true if the last correction was below converged_deg
+    uint32_t numWindows;         //!< the windows completed
+    uint32_t numSkipped;         //!< the windows skipped
+  };
+
+  //! \brief      Sets the defaults: 1 s windows at 100 Hz, half the lean per window, 0.5 deg/s
+  //! \param[out] pParams  A pointer to the parameters
+  static void setDefaultParams(Params *pParams)
+  {
+    pParams->period_sec = BalanceMath<T>::fromDouble(0.01);
+    pParams->window_sec = BalanceMath<T>::fromDouble(1.0);
+    pParams->degPerKrpmps = BalanceMath<T>::fromDouble(3.4);
+    pParams->degPerA = BalanceMath<T>::fromDouble(0.83);
+    pParams->commandWeight = BalanceMath<T>::fromDouble(0.5);
+    pParams->friction_A = BalanceMath<T>::fromDouble(0.2);
+    pParams->viscous_ApKrpm = BalanceMath<T>::fromDouble(0.0);
+    pParams->momentumTau_sec = BalanceMath<T>::fromDouble(5.0);
+    pParams->gain = BalanceMath<T>::fromDouble(0.5);
+    pParams->maxRate_degps = BalanceMath<T>::fromDouble(0.5);
+    pParams->range_deg = BalanceMath<T>::fromDouble(3.0);
+    pParams->gate_deg = BalanceMath<T>::fromDouble(3.0);
+    pParams->converged_deg = BalanceMath<T>::fromDouble(0.02);
+  }
+
+  //! \brief     Constructs the estimator with the defaults
+  //! \param[in] setpoint_deg  The initial setpoint, the centre of the range
+  explicit SetpointEstimator(const T setpoint_deg)
+  {
+    setDefaultParams(&m_params);
+    reset(setpoint_deg);
+  }
+
+  SetpointEstimator(const Params &params,const T setpoint_deg)
+    : m_params(params)
+  {
+    reset(setpoint_deg);
+  }
+
+  //! \brief     Starts over from a setpoint, also after a parameter change
+  //! \param[in] setpoint_deg  The setpoint, the centre of the range
+  void reset(const T setpoint_deg)
+  {
+    const T zero = T();
+    const double numSteps = BalanceMath<T>::toDouble(m_params.window_sec) / BalanceMath<T>::toDouble(m_params.period_sec);
+
+    m_numWindowSteps = (numSteps < 1.0) ? 1 : (uint32_t)(numSteps + 0.5);
+    m_perStep = BalanceMath<T>::fromDouble(1.0 / (double)m_numWindowSteps);
+    m_perWindow = BalanceMath<T>::fromDouble(1.0 / BalanceMath<T>::toDouble(m_params.window_sec));
+    m_centre_deg = setpoint_deg;
+
+    m_sumWheel_krpm = zero;
+    m_sumCommand_A = zero;
+    m_numSteps = 0;
+    m_firstSpeed = 0;
+    m_flag_balancing = true;
+    m_flag_haveLast = false;
+
+    m_state.setpoint_deg = setpoint_deg;
+    m_state.meanWheel_krpm = zero;
+    m_state.wheelAccel_krpmps = zero;
+    m_state.meanCommand_A = zero;
+    m_state.lean_deg = zero;
+    m_state.correction_deg = zero;
+    m_state.flag_converged = false;
+    m_state.numWindows = 0;
+    m_state.numSkipped = 0;
+  }
+
+  //! \brief     Takes one Balance step, and moves the setpoint at the end of a window
+  //! \param[in] balance  The Balance state after the step
+  //! \param[in] range_A  The Balance command clamp, clamped steps are not balancing
+  //! \return    The setpoint for the next step
+  T step(const typename Balance<T>::State &balance,const T range_A)
+  {
+    if(m_numSteps == 0)
+      {
+        m_firstSpeed = balance.numWheelSpeeds;
+      }
+
+    m_sumWheel_krpm = m_sumWheel_krpm + balance.wheel_krpm;
+    m_sumCommand_A = m_sumCommand_A + balance.motorOutput;
+    m_flag_balancing = m_flag_balancing &&
+                       (BalanceMath<T>::absolute(balance.error) < m_params.gate_deg) &&
+                       (BalanceMath<T>::absolute(balance.motorOutput) < range_A);
+    m_numSteps++;
+
+    if(m_numSteps >= m_numWindowSteps)
+      {
+        // at least one speed reply for every other step
+        const bool flag_replies = ((balance.numWheelSpeeds - m_firstSpeed) * 2 >= m_numWindowSteps);
+
+        runWindow(m_flag_balancing && flag_replies);
+
+        m_sumWheel_krpm = T();
+        m_sumCommand_A = T();
+        m_numSteps = 0;
+        m_flag_balancing = true;
+      }
+
+    return(m_state.setpoint_deg);
+  }
+
+  //! \brief  Returns the state after the last window
+  const State &getState(void) const
+  {
+    return(m_state);
+  }
+
+  //! \brief  Returns the parameters, reset() after changing the window or the period
+  Params &getParams(void)
+  {
+    return(m_params);
+  }
+
+private:
+  //! \brief Closes a window, the correction needs two balancing windows in a row
+  void runWindow(const bool flag_valid)
+  {
+    const T zero = T();
+    const T one = BalanceMath<T>::fromDouble(1.0);
+    const T meanWheel_krpm = m_sumWheel_krpm * m_perStep;
+    const T meanCommand_A = m_sumCommand_A * m_perStep;
+
+    m_state.numWindows++;
+
+    if(!flag_valid || !m_flag_haveLast)
+      {
+        m_state.numSkipped += flag_valid ? 0 : 1;
+        m_state.meanWheel_krpm = meanWheel_krpm;
+        m_state.meanCommand_A = meanCommand_A;
+        m_flag_haveLast = flag_valid;
+        return;
+      }
+
+    // the mean lean two ways, and the lean that stops the wheel in momentumTau_sec
+    const T accel_krpmps = (meanWheel_krpm - m_state.meanWheel_krpm) * m_perWindow;
+    const T accelLean_deg = m_params.degPerKrpmps * accel_krpmps;
+    const T friction_A = ((meanWheel_krpm > zero) ? m_params.friction_A :
+                          ((meanWheel_krpm < zero) ? -m_params.friction_A : zero)) +
+                         m_params.viscous_ApKrpm * meanWheel_krpm;
+    const T commandLean_deg = m_params.degPerA * ((meanCommand_A + m_state.meanCommand_A) *
+                              BalanceMath<T>::fromDouble(0.5) - friction_A);
+    const T lean_deg = (one - m_params.commandWeight) * accelLean_deg + m_params.commandWeight * commandLean_deg;
+    const T target_deg = (m_params.momentumTau_sec > zero) ?
+                         (-(m_params.degPerKrpmps * meanWheel_krpm / m_params.momentumTau_sec)) : zero;
+    const T maxStep_deg = m_params.maxRate_degps * m_params.window_sec;
+    T correction_deg = m_params.gain * (lean_deg - target_deg);
+    T setpoint_deg;
+
+    correction_deg = (correction_deg > maxStep_deg) ? maxStep_deg :
+                     ((correction_deg < -maxStep_deg) ? -maxStep_deg : correction_deg);
+
+    setpoint_deg = m_state.setpoint_deg + correction_deg;
+    setpoint_deg = (setpoint_deg > m_centre_deg + m_params.range_deg) ? m_centre_deg + m_params.range_deg :
+                   ((setpoint_deg < m_centre_deg - m_params.range_deg) ? m_centre_deg - m_params.range_deg : setpoint_deg);
+
+    m_state.correction_deg = setpoint_deg - m_state.setpoint_deg;
+    m_state.setpoint_deg = setpoint_deg;
+    m_state.wheelAccel_krpmps = accel_krpmps;
+    m_state.lean_deg = lean_deg;
+    m_state.flag_converged = (BalanceMath<T>::absolute(m_state.correction_deg) < m_params.converged_deg);
+    m_state.meanWheel_krpm = meanWheel_krpm;
+    m_state.meanCommand_A = meanCommand_A;
+  }
+
+  Params    m_params;
+  State     m_state;
+
+  uint32_t  m_numWindowSteps;    //!< the steps per window
+  T         m_perStep;           //!< 1 / m_numWindowSteps
+  T         m_perWindow;         //!< 1 / window_sec
+  T         m_centre_deg;        //!< the centre of the setpoint range
+
+  T         m_sumWheel_krpm;     //!< the wheel speed sum over the window
+  T         m_sumCommand_A;      //!< the command sum over the window
+  uint32_t  m_numSteps;          //!< the steps in the window
+  uint32_t  m_firstSpeed;        //!< the speed reply count at the window start
+  bool      m_flag_balancing;    //!< false once a step in the window was not balancing
+  bool      m_flag_haveLast;     //!< true if the last window was valid, its means are in the state
+};
+
+
+} // end of rwp namespace
+
+//@} // ingroup
+#endif // end of _SETPOINT_H_ definition
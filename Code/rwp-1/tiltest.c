@@ -0,0 +1,108 @@
+//! \file   tiltest.c
+//! \brief  Contains the roll tilt estimator of the Teensy balance controller
+//!
+
+
+// **************************************************************************
+// the includes
+
+#include <math.h>
+
+#include "tiltest.h"
+
+
+// **************************************************************************
+// the defines
+
+//! \brief Defines degrees per radian
+//!
+#define TILTEST_DEG_PER_RAD         (57.2957795f)
+
+
+// **************************************************************************
+// the functions
+
+void TILTEST_init(TILTEST_Obj *obj,const float tau_sec,const float gate_g,const float radius_m)
+{
+  obj->Kp = 2.0f / tau_sec;
+  obj->Ki = 1.0f / (tau_sec * tau_sec);
+  obj->gate_g = gate_g;
+  obj->radius_m = radius_m;
+
+  obj->angle_deg = 0.0f;
+  obj->rate_dps = 0.0f;
+  obj->bias_dps = 0.0f;
+  obj->lastGyroX = 0;
+
+  obj->flag_started = false;
+  obj->numSamples = 0;
+  obj->numGated = 0;
+
+  return;
+} // end of TILTEST_init() function
+
+
+void TILTEST_run(TILTEST_Obj *obj,const int16_t *pAccel,const int16_t gyroX,const float dt_sec)
+{
+  float ax = (float)pAccel[0] / TILTEST_ACCEL_COUNTS_PER_g;
+  float ay = (float)pAccel[1] / TILTEST_ACCEL_COUNTS_PER_g;
+  float az = (float)pAccel[2] / TILTEST_ACCEL_COUNTS_PER_g;
+  float norm_g;
+  float accelAngle_deg;
+
+
+  obj->numSamples++;
+
+  // the bias cancels in the difference, so the raw rate serves for both terms
+  if(obj->flag_started && (obj->radius_m != 0.0f) && (dt_sec > 0.0f))
+    {
+      float rate_radps = (float)gyroX / (TILTEST_GYRO_COUNTS_PER_dps * TILTEST_DEG_PER_RAD);
+      float accel_radps2 = (float)(gyroX - obj->lastGyroX) / (TILTEST_GYRO_COUNTS_PER_dps * TILTEST_DEG_PER_RAD * dt_sec);
+
+      ay += obj->radius_m * accel_radps2 / TILTEST_GRAVITY_mps2;
+      az += obj->radius_m * rate_radps * rate_radps / TILTEST_GRAVITY_mps2;
+    }
+
+  obj->lastGyroX = gyroX;
+
+  // the dmpGetYawPitchRoll() roll, with the gravity vector from the accelerometer
+  norm_g = sqrtf(ax * ax + ay * ay + az * az);
+  accelAngle_deg = atanf(ay / sqrtf(ax * ax + az * az)) * TILTEST_DEG_PER_RAD;
+
+  if(!obj->flag_started)
+    {
+      obj->angle_deg = accelAngle_deg;
+      obj->rate_dps = (float)gyroX / TILTEST_GYRO_COUNTS_PER_dps;
+      obj->flag_started = true;
+
+      return;
+    }
+
+  obj->rate_dps = (float)gyroX / TILTEST_GYRO_COUNTS_PER_dps - obj->bias_dps;
+
+  if(fabsf(norm_g - 1.0f) <= obj->gate_g)
+    {
+      float error_deg = accelAngle_deg - obj->angle_deg;
+
+      obj->bias_dps -= obj->Ki * error_deg * dt_sec;
+      obj->angle_deg += (obj->rate_dps + obj->Kp * error_deg) * dt_sec;
+    }
+  else
+    {
+      obj->numGated++;
+      obj->angle_deg += obj->rate_dps * dt_sec;
+    }
+
+  return;
+} // end of TILTEST_run() function
+
+
+void TILTEST_correct(TILTEST_Obj *obj,const float roll_deg,const float gain)
+{
+  obj->angle_deg += gain * (roll_deg - obj->angle_deg);
+
+  return;
+} // end of TILTEST_correct() function
+
+
+// end of file
@@ -0,0 +1,150 @@
+#ifndef _TILTEST_H_
+#define _TILTEST_H_
+
+//! \file   tiltest.h
+//! \brief  Contains the public interface to the roll tilt estimator of the
+//!         Teensy balance controller (rwp-1)
+//!
+//!         A complementary filter with gyro bias tracking: the X gyro rate is
+//!         integrated every sample, and the roll from the accelerometer pulls
+//!         the estimate back with a proportional and an integral term, the
+//!         integral being the gyro bias.  With the time constant tau the
+//!         gains are Kp = 2 / tau and Ki = 1 / tau^2, a critically damped
+//!         correction, so tau sets how slowly accelerometer noise and the
+//!         pendulum's own tangential acceleration leak into the estimate.
+//!
+//!         The IMU rides on the pendulum, so the accelerometer also sees the
+//!         tangential and centripetal acceleration of its mount.  With the IMU
+//!         at radius r from the pivot along the sensor Z axis these are
+//!         removed using the gyro rate and its difference,
+//!
+//!           ay += r psi'' / g,  az += r psi'^2 / g
+//!
+//!         Samples whose acceleration magnitude is still far from 1 g are not
+//!         used for the correction, only integrated.  TILTEST_correct() takes any
+//!         other absolute roll, such as the DMP quaternion roll, as a slower
+//!         correction on top.
+//!
+//!         The roll sign and zero are those of dmpGetYawPitchRoll(), so the
+//!         estimate can replace rolldeg without touching the setpoint.  The
+//!         module has no device specific includes and runs unchanged on the
+//!         host, see Code/tools/tiltreplay.
+
+
+// **************************************************************************
+// the includes
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+//!
+//!
+//! \defgroup TILTEST TILTEST
+//!
+//@{
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+// **************************************************************************
+// the defines
+
+//! \brief Defines the MPU-6050 gyro scale at the +-250 dps range, counts per dps
+//!
+#define TILTEST_GYRO_COUNTS_PER_dps (131.0f)
+
+//! \brief Defines the MPU-6050 accelerometer scale at the +-2 g range, counts per g
+//!
+#define TILTEST_ACCEL_COUNTS_PER_g  (16384.0f)
+
+//! \brief Defines the default correction time constant, s
+//!
+#define TILTEST_DEFAULT_TAU_sec     (0.5f)
+
+//! \brief Defines the default acceleration gate, g away from 1 g
+//!
+#define TILTEST_DEFAULT_GATE_g      (0.15f)
+
+//! \brief Defines the gravitational acceleration, m/s^2
+//!
+#define TILTEST_GRAVITY_mps2        (9.81f)
+
+
+// **************************************************************************
+// the typedefs
+
+//! \brief Defines the estimator object
+//!
+typedef struct _TILTEST_Obj_
+{
+  float  Kp;                     //!< the correction proportional gain, 1/s
+  float  Ki;                     //!< the bias integral gain, 1/s^2
+  float  gate_g;                 //!< the largest acceleration magnitude error used for the correction
+  float  radius_m;               //!< the IMU distance from the pivot along the sensor Z axis
+
+  float  angle_deg;              //!< the roll estimate
+  float  rate_dps;               //!< the bias corrected roll rate of the last sample
+  float  bias_dps;               //!< the gyro bias estimate
+  int16_t lastGyroX;             //!< the previous gyro sample, for the angular acceleration
+
+  bool   flag_started;           //!< true once the first sample has set the angle
+  uint32_t numSamples;           //!< the samples run
+  uint32_t numGated;             //!< the samples that skipped the correction
+} TILTEST_Obj;
+
+
+// **************************************************************************
+// the function prototypes
+
+//! \brief     Initializes the estimator
+//! \param[in] obj      A pointer to the estimator
+//! \param[in] tau_sec  The correction time constant
+//! \param[in] gate_g   The largest acceleration magnitude error used for the correction
+//! \param[in] radius_m The IMU distance from the pivot, 0 to skip the mount acceleration
+extern void TILTEST_init(TILTEST_Obj *obj,const float tau_sec,const float gate_g,const float radius_m);
+
+
+//! \brief     Runs the estimator on one raw sample
+//! \details   The first sample sets the angle from the accelerometer.
+//! \param[in] obj     A pointer to the estimator
+//! \param[in] pAccel  The X, Y and Z accelerometer counts, getMotion6() order
+//! \param[in] gyroX   The X gyro counts
+//! \param[in] dt_sec  The time since the previous sample
+extern void TILTEST_run(TILTEST_Obj *obj,const int16_t *pAccel,const int16_t gyroX,const float dt_sec);
+
+
+//! \brief     Pulls the estimate toward an absolute roll
+//! \param[in] obj       A pointer to the estimator
+//! \param[in] roll_deg  The roll, dmpGetYawPitchRoll() convention
+//! \param[in] gain      The fraction of the difference to remove, 0 to 1
+extern void TILTEST_correct(TILTEST_Obj *obj,const float roll_deg,const float gain);
+
+
+//! \brief     Gets the roll estimate
+//! \param[in] obj  A pointer to the estimator
+//! \return    The roll, deg
+static inline float TILTEST_getAngle_deg(const TILTEST_Obj *obj)
+{
+  return(obj->angle_deg);
+} // end of TILTEST_getAngle_deg() function
+
+
+//! \brief     Gets the bias corrected roll rate
+//! \param[in] obj  A pointer to the estimator
+//! \return    The rate, deg/s
+static inline float TILTEST_getRate_dps(const TILTEST_Obj *obj)
+{
+  return(obj->rate_dps);
+} // end of TILTEST_getRate_dps() function
+
+
+#ifdef __cplusplus
+}
+#endif // extern "C"
+
+//@} // ingroup
+#endif // end of _TILTEST_H_ definition
@@ -0,0 +1,550 @@
+//! \file   balancetest.cpp
+//! \brief  Checks the rwp-1 balance controller core (see rwp-1/balance.h)
+//!         and balance point estimator (rwp-1/setpoint.h) on the host and
+//!         times one step for each scalar type
+//!
+//!         Build on Linux from this directory with
+//!
+//!           c++ -O2 -std=c++11 -I../../rwp-1 -o balancetest balancetest.cpp -lm
+//!
+//!         Usage
+//!
+//!           balancetest [-n num] [-r repeats] [-s seed]
+//!
+//!         The checks run first and the exit status is 1 if any fails:
+//!
+//!           - fixed cases of the clamp, deadband, overtravel cut, reset,
+//!             the wheel speed and integral terms and the payloads, for
+//!             float, double and Fixed16
+//!           - fixed cases of the balance point estimator: the correction
+//!             from a wheel acceleration, the rate limit and the skipped
+//!             windows, for the same types
+//!           - num random DMP packets, leaning up to +-8 deg with some pitch
+//!             and yaw, through the core against a transcription of the
+//!             loop() the core replaced: the MotionApps float roll and the
+//!             PD law in double
+//!
+//!         The timings step the core over the same packets, repeated, and
+//!         report nanoseconds and, on x86, time stamp counter cycles per
+//!         step.  They compare the scalar types on the host; on a Cortex-M4
+//!         double is software emulated and the gap is far larger.
+
+
+// **************************************************************************
+// the includes
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BALANCETEST_HAS_TSC
+#endif
+
+#include "balance.h"
+#include "fixed16.h"
+#include "setpoint.h"
+
+
+// **************************************************************************
+// the defines
+
+//! \brief Defines the default number of random packets
+//!
+#define BALANCETEST_NUM_SAMPLES     (100000)
+
+//! \brief Defines the default number of timing repeats over the packets
+//!
+#define BALANCETEST_NUM_REPEATS     (20)
+
+//! \brief Defines the largest random lean, deg
+//!
+#define BALANCETEST_MAX_ROLL_deg    (8.0)
+
+//! \brief Defines the largest random pitch and yaw, deg
+//!
+#define BALANCETEST_MAX_TILT_deg    (3.0)
+
+//! \brief Defines the largest random gyro reading, counts
+//!
+#define BALANCETEST_MAX_GYRO        (3000)
+
+//! \brief Defines the band around the overtravel cut where the reference and
+//!        the core may round to different sides, deg
+//!
+#define BALANCETEST_CUT_BAND_deg    (0.01)
+
+
+// **************************************************************************
+// the typedefs
+
+//! \brief Defines the reference result of one packet
+//!
+typedef struct _BALANCETEST_Ref_
+{
+  double  roll_deg;              //!< the roll
+  double  motorOutput;           //!< the command, A
+} BALANCETEST_Ref;
+
+
+//! \brief Defines the limits for one scalar type against the reference
+//!
+typedef struct _BALANCETEST_Limits_
+{
+  double  roll_deg;              //!< the largest roll difference
+  double  cmd_A;                 //!< the largest command difference
+} BALANCETEST_Limits;
+
+
+// **************************************************************************
+// the globals
+
+static unsigned long gNumFailures = 0;
+
+static uint32_t gRandState = 1;
+
+//! \brief Keeps the timed steps from being optimized away
+static volatile int32_t gSink;
+
+
+// **************************************************************************
+// the functions
+
+static void BALANCETEST_usage(const char *pName)
+{
+  fprintf(stderr,"usage: %s [-n num] [-r repeats] [-s seed]\n",pName);
+
+  return;
+} // end of BALANCETEST_usage() function
+
+
+static void BALANCETEST_check(const bool flag_ok,const char *pType,const char *pWhat)
+{
+  if(!flag_ok)
+    {
+      printf("FAIL %s: %s\n",pType,pWhat);
+      gNumFailures++;
+    }
+
+  return;
+} // end of BALANCETEST_check() function
+
+
+static uint32_t BALANCETEST_rand(void)
+{
+  // xorshift32
+  gRandState ^= gRandState << 13;
+  gRandState ^= gRandState >> 17;
+  gRandState ^= gRandState << 5;
+
+  return(gRandState);
+} // end of BALANCETEST_rand() function
+
+
+static double BALANCETEST_uniform(const double range)
+{
+  return(range * (2.0 * (double)BALANCETEST_rand() / 4294967295.0 - 1.0));
+} // end of BALANCETEST_uniform() function
+
+
+static double BALANCETEST_getTime_sec(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC,&now);
+
+  return((double)now.tv_sec + (double)now.tv_nsec * 1.0e-9);
+} // end of BALANCETEST_getTime_sec() function
+
+
+//! \brief Makes a DMP packet from roll, pitch and yaw, quantized as the DMP does
+static rwp::DmpSample BALANCETEST_makeSample(const double roll_deg,const double pitch_deg,
+                                             const double yaw_deg,const int16_t gyroX)
+{
+  const double r = 0.5 * roll_deg * M_PI / 180.0;
+  const double p = 0.5 * pitch_deg * M_PI / 180.0;
+  const double y = 0.5 * yaw_deg * M_PI / 180.0;
+  const double quat[4] = {cos(r) * cos(p) * cos(y) + sin(r) * sin(p) * sin(y),
+                          sin(r) * cos(p) * cos(y) - cos(r) * sin(p) * sin(y),
+                          cos(r) * sin(p) * cos(y) + sin(r) * cos(p) * sin(y),
+                          cos(r) * cos(p) * sin(y) - sin(r) * sin(p) * cos(y)};
+  rwp::DmpSample sample;
+  unsigned int cnt;
+
+  for(cnt=0;cnt<4;cnt++)
+    {
+      sample.quat[cnt] = (int16_t)floor(quat[cnt] * BALANCE_QUAT_SCALE + 0.5);
+    }
+  sample.gyroX = gyroX;
+
+  return(sample);
+} // end of BALANCETEST_makeSample() function
+
+
+//! \brief Runs one packet the way loop() did before the core
+static BALANCETEST_Ref BALANCETEST_reference(const rwp::DmpSample &sample)
+{
+  // dmpGetQuaternion(), dmpGetGravity() and dmpGetYawPitchRoll() in float
+  float w = (float)sample.quat[0] / 16384.0f;
+  float x = (float)sample.quat[1] / 16384.0f;
+  float y = (float)sample.quat[2] / 16384.0f;
+  float z = (float)sample.quat[3] / 16384.0f;
+  float gx = 2 * (x * z - w * y);
+  float gy = 2 * (w * x + y * z);
+  float gz = w * w - x * x - y * y + z * z;
+  float roll = atanf(gy / sqrtf(gx * gx + gz * gz));
+
+  // the PD law in double
+  double rolldeg = roll * 180 / M_PI;
+  double velocity = sample.gyroX / 100.0;
+  double error = 2.25 - rolldeg;
+  double motorOutput = 18.0 * error + velocity * -9.0;
+  BALANCETEST_Ref ref;
+
+
+  motorOutput = (motorOutput < -20.0) ? -20.0 : ((motorOutput > 20.0) ? 20.0 : motorOutput);
+
+  if(fabs(rolldeg) > 5.0)
+    {
+      motorOutput = 0.0;
+    }
+
+  ref.roll_deg = rolldeg;
+  ref.motorOutput = motorOutput;
+
+  return(ref);
+} // end of BALANCETEST_reference() function
+
+
+template<typename T>
+static double BALANCETEST_toDouble(const T value)
+{
+  return(rwp::BalanceMath<T>::toDouble(value));
+} // end of BALANCETEST_toDouble() function
+
+
+template<typename T>
+static T BALANCETEST_fromDouble(const double value)
+{
+  return(rwp::BalanceMath<T>::fromDouble(value));
+} // end of BALANCETEST_fromDouble() function
+
+
+//! \brief Runs the fixed cases for one scalar type, eps is the command resolution
+template<typename T>
+static void BALANCETEST_checkCases(const char *pType,const double eps)
+{
+  typename rwp::Balance<T>::Params params;
+  rwp::Balance<T> balance;
+  double cmd_A;
+
+
+  // at the setpoint and still
+  cmd_A = BALANCETEST_toDouble(balance.step(BALANCETEST_fromDouble<T>(2.25),T()));
+  BALANCETEST_check(fabs(cmd_A) < eps,pType,"zero command at the setpoint");
+
+  // proportional and derivative terms, kp 18 and kd -9
+  cmd_A = BALANCETEST_toDouble(balance.step(BALANCETEST_fromDouble<T>(2.0),BALANCETEST_fromDouble<T>(0.5)));
+  BALANCETEST_check(fabs(cmd_A - (18.0 * 0.25 - 9.0 * 0.5)) < eps,pType,"PD law");
+  BALANCETEST_check(fabs(BALANCETEST_toDouble(balance.getState().pterm) - 4.5) < eps,pType,"pterm in the state");
+  BALANCETEST_check(fabs(BALANCETEST_toDouble(balance.getState().dterm) + 4.5) < eps,pType,"dterm in the state");
+
+  // clamp, both ways
+  cmd_A = BALANCETEST_toDouble(balance.step(BALANCETEST_fromDouble<T>(-4.0),T()));
+  BALANCETEST_check(fabs(cmd_A - 20.0) < eps,pType,"positive clamp");
+  cmd_A = BALANCETEST_toDouble(balance.step(BALANCETEST_fromDouble<T>(4.0),BALANCETEST_fromDouble<T>(20.0)));
+  BALANCETEST_check(fabs(cmd_A + 20.0) < eps,pType,"negative clamp");
+
+  // overtravel, either side, whatever the rate
+  cmd_A = BALANCETEST_toDouble(balance.step(BALANCETEST_fromDouble<T>(5.5),BALANCETEST_fromDouble<T>(-3.0)));
+  BALANCETEST_check(cmd_A == 0.0,pType,"overtravel cut, positive");
+  cmd_A = BALANCETEST_toDouble(balance.step(BALANCETEST_fromDouble<T>(-5.5),BALANCETEST_fromDouble<T>(3.0)));
+  BALANCETEST_check(cmd_A == 0.0,pType,"overtravel cut, negative");
+  BALANCETEST_check(balance.getState().numSteps == 6,pType,"step count");
+
+  // reset
+  balance.reset();
+  BALANCETEST_check((balance.getState().numSteps == 0) && (BALANCETEST_toDouble(balance.getState().motorOutput) == 0.0),
+                    pType,"reset");
+
+  // deadband, set through the parameters
+  rwp::Balance<T>::setDefaultParams(&params);
+  params.deadband_A = BALANCETEST_fromDouble<T>(1.0);
+  rwp::Balance<T> banded(params);
+
+  cmd_A = BALANCETEST_toDouble(banded.step(BALANCETEST_fromDouble<T>(2.2),T()));
+  BALANCETEST_check(cmd_A == 0.0,pType,"deadband zeroes 0.9 A");
+  cmd_A = BALANCETEST_toDouble(banded.step(BALANCETEST_fromDouble<T>(2.1),T()));
+  BALANCETEST_check(fabs(cmd_A - 2.7) < eps,pType,"deadband passes 2.7 A");
+
+  banded.getParams().kp = BALANCETEST_fromDouble<T>(10.0);
+  cmd_A = BALANCETEST_toDouble(banded.step(BALANCETEST_fromDouble<T>(2.1),T()));
+  BALANCETEST_check(fabs(cmd_A - 1.5) < eps,pType,"gain change between steps");
+
+  // wheel speed and integral terms alone, 0.25 deg of error at 100 Hz
+  rwp::Balance<T>::setDefaultParams(&params);
+  params.kp = T();
+  params.kd = T();
+  params.kw = BALANCETEST_fromDouble<T>(2.0);
+  params.ki = BALANCETEST_fromDouble<T>(10.0);
+  rwp::Balance<T> full(params);
+
+  full.setWheelSpeed_krpm(BALANCETEST_fromDouble<T>(1.5));
+  cmd_A = BALANCETEST_toDouble(full.step(BALANCETEST_fromDouble<T>(2.0),T()));
+  BALANCETEST_check(fabs(cmd_A - (3.0 + 0.025)) < eps,pType,"wheel speed and integral terms");
+  full.step(BALANCETEST_fromDouble<T>(2.0),T());
+  full.step(BALANCETEST_fromDouble<T>(2.0),T());
+  cmd_A = BALANCETEST_toDouble(full.step(BALANCETEST_fromDouble<T>(2.0),T()));
+  BALANCETEST_check(fabs(BALANCETEST_toDouble(full.getState().integral_degs) - 0.01) < eps,pType,"integral");
+  BALANCETEST_check(fabs(cmd_A - (3.0 + 0.1)) < eps,pType,"integral term");
+
+  full.getParams().integralLimit_degs = BALANCETEST_fromDouble<T>(0.005);
+  full.step(BALANCETEST_fromDouble<T>(2.0),T());
+  BALANCETEST_check(fabs(BALANCETEST_toDouble(full.getState().integral_degs) - 0.005) < eps,pType,"integral clamp");
+  full.step(BALANCETEST_fromDouble<T>(6.0),T());
+  BALANCETEST_check(BALANCETEST_toDouble(full.getState().integral_degs) == 0.0,pType,"overtravel clears the integral");
+
+  // the payloads are IQ24 amps and krpm
+  BALANCETEST_check(rwp::Balance<T>::toPayload(BALANCETEST_fromDouble<T>(-1.5)) == -(3 << 23),pType,"payload");
+  BALANCETEST_check(BALANCETEST_toDouble(rwp::Balance<T>::fromPayload(-(3 << 23))) == -1.5,pType,"speed payload");
+
+  // a level quaternion reads zero roll
+  rwp::DmpSample level = BALANCETEST_makeSample(0.0,0.0,0.0,0);
+  BALANCETEST_check(BALANCETEST_toDouble(rwp::Balance<T>::getRoll_deg(level.quat)) == 0.0,pType,"level roll");
+
+  return;
+} // end of BALANCETEST_checkCases() function
+
+
+//! \brief Runs one estimator window of 1 s at 100 Hz on a wheel speed ramp
+template<typename T>
+static T BALANCETEST_runWindow(rwp::SetpointEstimator<T> *pEstimator,typename rwp::Balance<T>::State *pState,
+                               const double wheel_krpm,const double accel_krpmps,const double command_A,
+                               const double error_deg,const bool flag_replies)
+{
+  T setpoint_deg = T();
+  unsigned int cnt;
+
+  for(cnt=0;cnt<100;cnt++)
+    {
+      pState->wheel_krpm = BALANCETEST_fromDouble<T>(wheel_krpm + accel_krpmps * ((double)cnt * 0.01 - 0.495));
+      pState->motorOutput = BALANCETEST_fromDouble<T>(command_A);
+      pState->error = BALANCETEST_fromDouble<T>(error_deg);
+      pState->numWheelSpeeds += flag_replies ? 1 : 0;
+
+      setpoint_deg = pEstimator->step(*pState,BALANCETEST_fromDouble<T>(20.0));
+    }
+
+  return(setpoint_deg);
+} // end of BALANCETEST_runWindow() function
+
+
+template<typename T>
+static void BALANCETEST_checkSetpoint(const char *pType,const double eps)
+{
+  typename rwp::SetpointEstimator<T>::Params params;
+  typename rwp::Balance<T>::State state = rwp::Balance<T>().getState();
+  double setpoint_deg;
+
+
+  // the wheel acceleration alone, no momentum target
+  rwp::SetpointEstimator<T>::setDefaultParams(&params);
+  params.commandWeight = T();
+  params.momentumTau_sec = T();
+  rwp::SetpointEstimator<T> estimator(params,BALANCETEST_fromDouble<T>(2.25));
+
+  setpoint_deg = BALANCETEST_toDouble(BALANCETEST_runWindow(&estimator,&state,0.0,0.1,0.0,0.1,true));
+  BALANCETEST_check(setpoint_deg == 2.25,pType,"estimator waits for a second window");
+  setpoint_deg = BALANCETEST_toDouble(BALANCETEST_runWindow(&estimator,&state,0.1,0.1,0.0,0.1,true));
+  BALANCETEST_check(fabs(BALANCETEST_toDouble(estimator.getState().wheelAccel_krpmps) - 0.1) < eps,pType,
+                    "estimator wheel acceleration");
+  BALANCETEST_check(fabs(setpoint_deg - (2.25 + 0.5 * 3.4 * 0.1)) < 10.0 * eps,pType,"estimator correction");
+
+  // the rate limit, 0.5 deg per 1 s window
+  setpoint_deg = BALANCETEST_toDouble(BALANCETEST_runWindow(&estimator,&state,2.0,1.0,0.0,0.1,true));
+  BALANCETEST_check(fabs(setpoint_deg - (2.42 + 0.5)) < 10.0 * eps,pType,"estimator rate limit");
+
+  // windows without balancing or without speed replies
+  BALANCETEST_runWindow(&estimator,&state,4.0,1.0,0.0,4.0,true);
+  BALANCETEST_runWindow(&estimator,&state,5.0,1.0,0.0,0.1,false);
+  BALANCETEST_check((estimator.getState().numSkipped == 2) && (estimator.getState().numWindows == 5),pType,
+                    "estimator skips windows");
+  setpoint_deg = BALANCETEST_toDouble(estimator.getState().setpoint_deg);
+  BALANCETEST_check(fabs(setpoint_deg - 2.92) < 10.0 * eps,pType,"estimator holds over skipped windows");
+
+  // the command alone, less the friction, with the momentum target off
+  params.commandWeight = BALANCETEST_fromDouble<T>(1.0);
+  rwp::SetpointEstimator<T> commanded(params,BALANCETEST_fromDouble<T>(2.25));
+
+  BALANCETEST_runWindow(&commanded,&state,0.5,0.0,0.6,0.1,true);
+  setpoint_deg = BALANCETEST_toDouble(BALANCETEST_runWindow(&commanded,&state,0.5,0.0,0.6,0.1,true));
+  BALANCETEST_check(fabs(setpoint_deg - (2.25 + 0.5 * 0.83 * (0.6 - 0.2))) < 10.0 * eps,pType,"estimator command");
+
+  return;
+} // end of BALANCETEST_checkSetpoint() function
+
+
+//! \brief Runs the random packets for one scalar type against the reference
+template<typename T>
+static void BALANCETEST_checkSamples(const char *pType,const std::vector<rwp::DmpSample> &samples,
+                                     const BALANCETEST_Limits &limits)
+{
+  rwp::Balance<T> balance;
+  double maxRoll_deg = 0.0, maxCmd_A = 0.0, maxPayload_A = 0.0;
+  unsigned long numSkipped = 0;
+  size_t cnt;
+
+
+  for(cnt=0;cnt<samples.size();cnt++)
+    {
+      const BALANCETEST_Ref ref = BALANCETEST_reference(samples[cnt]);
+      const double cmd_A = BALANCETEST_toDouble(balance.step(samples[cnt]));
+      const double payload_A = (double)rwp::Balance<T>::toPayload(balance.getState().motorOutput) / BALANCE_IQ24_SCALE;
+      const double roll_deg = fabs(BALANCETEST_toDouble(balance.getState().roll_deg) - ref.roll_deg);
+
+      maxRoll_deg = (roll_deg > maxRoll_deg) ? roll_deg : maxRoll_deg;
+
+      if(fabs(fabs(ref.roll_deg) - 5.0) < BALANCETEST_CUT_BAND_deg)
+        {
+          numSkipped++;
+          continue;
+        }
+
+      maxCmd_A = (fabs(cmd_A - ref.motorOutput) > maxCmd_A) ? fabs(cmd_A - ref.motorOutput) : maxCmd_A;
+      maxPayload_A = (fabs(payload_A - ref.motorOutput) > maxPayload_A) ? fabs(payload_A - ref.motorOutput) : maxPayload_A;
+    }
+
+  printf("%-8s max roll error %.2e deg, max command error %.2e A, max payload error %.2e A (%lu near the cut skipped)\n",
+         pType,maxRoll_deg,maxCmd_A,maxPayload_A,numSkipped);
+
+  BALANCETEST_check(maxRoll_deg <= limits.roll_deg,pType,"roll against the reference");
+  BALANCETEST_check(maxCmd_A <= limits.cmd_A,pType,"command against the reference");
+  BALANCETEST_check(maxPayload_A <= limits.cmd_A,pType,"payload against the reference");
+
+  return;
+} // end of BALANCETEST_checkSamples() function
+
+
+//! \brief Times one step for one scalar type
+template<typename T>
+static void BALANCETEST_time(const char *pType,const std::vector<rwp::DmpSample> &samples,
+                             const unsigned int numRepeats)
+{
+  rwp::Balance<T> balance;
+  double start_sec, elapsed_sec;
+  double numSteps = (double)samples.size() * numRepeats;
+  int32_t sum = 0;
+  unsigned int repeat;
+  size_t cnt;
+#ifdef BALANCETEST_HAS_TSC
+  unsigned long long startCycles, numCycles;
+#endif
+
+
+  start_sec = BALANCETEST_getTime_sec();
+#ifdef BALANCETEST_HAS_TSC
+  startCycles = __rdtsc();
+#endif
+
+  for(repeat=0;repeat<numRepeats;repeat++)
+    {
+      for(cnt=0;cnt<samples.size();cnt++)
+        {
+          sum += rwp::Balance<T>::toPayload(balance.step(samples[cnt]));
+        }
+    }
+
+#ifdef BALANCETEST_HAS_TSC
+  numCycles = __rdtsc() - startCycles;
+#endif
+  elapsed_sec = BALANCETEST_getTime_sec() - start_sec;
+  gSink = sum;
+
+#ifdef BALANCETEST_HAS_TSC
+  printf("%-8s %7.2f ns/step %8.1f cycles/step\n",pType,elapsed_sec * 1.0e9 / numSteps,(double)numCycles / numSteps);
+#else
+  printf("%-8s %7.2f ns/step\n",pType,elapsed_sec * 1.0e9 / numSteps);
+#endif
+
+  return;
+} // end of BALANCETEST_time() function
+
+
+int main(int argc,char *argv[])
+{
+  const BALANCETEST_Limits floatLimits = {1.0e-5,1.0e-3};
+  const BALANCETEST_Limits doubleLimits = {1.0e-5,1.0e-3};
+  const BALANCETEST_Limits fixedLimits = {2.0e-3,5.0e-2};
+  unsigned long numSamples = BALANCETEST_NUM_SAMPLES;
+  unsigned int numRepeats = BALANCETEST_NUM_REPEATS;
+  std::vector<rwp::DmpSample> samples;
+  unsigned long cnt;
+  int arg;
+
+
+  for(arg=1;arg<argc;arg++)
+    {
+      bool flag_ok = true;
+
+      if((argv[arg][0] != '-') || (argv[arg][1] == '\0') || (argv[arg][2] != '\0') || (arg + 1 >= argc))
+        {
+          BALANCETEST_usage(argv[0]);
+          return(2);
+        }
+
+      switch(argv[arg++][1])
+        {
+          case 'n': numSamples = strtoul(argv[arg],NULL,0); break;
+          case 'r': numRepeats = (unsigned int)strtoul(argv[arg],NULL,0); break;
+          case 's': gRandState = (uint32_t)strtoul(argv[arg],NULL,0); break;
+          default: flag_ok = false; break;
+        }
+
+      if(!flag_ok)
+        {
+          BALANCETEST_usage(argv[0]);
+          return(2);
+        }
+    }
+
+  if((numSamples == 0) || (numRepeats == 0) || (gRandState == 0))
+    {
+      BALANCETEST_usage(argv[0]);
+      return(2);
+    }
+
+  samples.reserve(numSamples);
+  for(cnt=0;cnt<numSamples;cnt++)
+    {
+      samples.push_back(BALANCETEST_makeSample(BALANCETEST_uniform(BALANCETEST_MAX_ROLL_deg),
+                                               BALANCETEST_uniform(BALANCETEST_MAX_TILT_deg),
+                                               BALANCETEST_uniform(BALANCETEST_MAX_TILT_deg),
+                                               (int16_t)BALANCETEST_uniform(BALANCETEST_MAX_GYRO)));
+    }
+
+  BALANCETEST_checkCases<float>("float",1.0e-4);
+  BALANCETEST_checkCases<double>("double",1.0e-4);
+  BALANCETEST_checkCases<rwp::Fixed16>("Fixed16",1.0e-3);
+  BALANCETEST_checkSetpoint<float>("float",1.0e-4);
+  BALANCETEST_checkSetpoint<double>("double",1.0e-4);
+  BALANCETEST_checkSetpoint<rwp::Fixed16>("Fixed16",1.0e-3);
+
+  BALANCETEST_checkSamples<float>("float",samples,floatLimits);
+  BALANCETEST_checkSamples<double>("double",samples,doubleLimits);
+  BALANCETEST_checkSamples<rwp::Fixed16>("Fixed16",samples,fixedLimits);
+
+  printf("%lu checks failed\n\n",gNumFailures);
+
+  BALANCETEST_time<float>("float",samples,numRepeats);
+  BALANCETEST_time<double>("double",samples,numRepeats);
+  BALANCETEST_time<rwp::Fixed16>("Fixed16",samples,numRepeats);
+
+  return((gNumFailures != 0) ? 1 : 0);
+} // end of main() function
+
+
+// end of file
@@ -0,0 +1,165 @@
+//! \file   baudtable.c
+//! \brief  Prints the SCI baud rate table (see baud.h) for every supported
+//!         rate and LSPCLK prescaler setting, and checks each entry
+//!
+//!         Build on Linux from this directory with
+//!
+//!           cc -O2 -I../../proj_lab05a -o baudtable baudtable.c ../../proj_lab05a/baud.c -lm
+//!
+//!         Usage
+//!
+//!           baudtable [-s sysclk_MHz]
+//!
+//!         An accepted entry must have BRR in range, an error within
+//!         BAUD_MAX_ERROR_ppm, and no neighbouring BRR value closer to the
+//!         requested rate.  The exit status is 1 if any entry fails.
+
+
+// **************************************************************************
+// the includes
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "baud.h"
+
+
+// **************************************************************************
+// the defines
+
+//! \brief Defines the default system clock, MHz, see USER_SYSTEM_FREQ_MHz
+//!
+#define BAUDTABLE_DEFAULT_SYSCLK_MHz    (90.0)
+
+
+// **************************************************************************
+// the globals
+
+//! \brief The LSPCLK prescaler divisors, see CLK_LowSpdPreScaler_e
+static const unsigned int BAUDTABLE_prescalers[] = {1, 2, 4, 6, 8, 10, 12, 14};
+
+//! \brief The baud rates to check
+static const uint32_t BAUDTABLE_rates[] =
+{
+  9600, 19200, 38400, 57600, 115200, 230400, 460800, 921600,
+  1000000, 1500000, 2000000, 3000000
+};
+
+
+// **************************************************************************
+// the functions
+
+static double BAUDTABLE_getError(const uint32_t lspClk_Hz,const uint32_t rate,const uint32_t divider)
+{
+  return(((double)lspClk_Hz / (8.0 * (double)divider) - (double)rate) / (double)rate);
+} // end of BAUDTABLE_getError() function
+
+
+static int BAUDTABLE_check(const uint32_t lspClk_Hz,const uint32_t rate,const BAUD_Config_t *pConfig)
+{
+  uint32_t divider = (uint32_t)pConfig->brr + 1;
+  double error = BAUDTABLE_getError(lspClk_Hz,rate,divider);
+  double ppm;
+
+  if(divider < 2 || divider > 0x10000UL)
+    {
+      return(0);
+    }
+
+  if(pConfig->actual != lspClk_Hz / (8 * divider))
+    {
+      return(0);
+    }
+
+  ppm = error * 1e6;
+  if(ppm > BAUD_MAX_ERROR_ppm || ppm < -BAUD_MAX_ERROR_ppm)
+    {
+      return(0);
+    }
+
+  // the reported error is truncated to whole ppm
+  if((double)pConfig->error_ppm > ppm + 1.0 || (double)pConfig->error_ppm < ppm - 1.0)
+    {
+      return(0);
+    }
+
+  // rounding must have picked the closest divider
+  if(divider > 2 && fabs(BAUDTABLE_getError(lspClk_Hz,rate,divider - 1)) < fabs(error))
+    {
+      return(0);
+    }
+
+  if(divider < 0x10000UL && fabs(BAUDTABLE_getError(lspClk_Hz,rate,divider + 1)) < fabs(error))
+    {
+      return(0);
+    }
+
+  return(1);
+} // end of BAUDTABLE_check() function
+
+
+int main(int argc,char *argv[])
+{
+  double sysClk_MHz = BAUDTABLE_DEFAULT_SYSCLK_MHz;
+  unsigned int numFailed = 0;
+  unsigned int p;
+  unsigned int r;
+  int opt;
+
+
+  while((opt = getopt(argc,argv,"s:")) != -1)
+    {
+      switch(opt)
+        {
+          case 's': sysClk_MHz = strtod(optarg,NULL); break;
+          default:
+            fprintf(stderr,"usage: baudtable [-s sysclk_MHz]\n");
+            return(2);
+        }
+    }
+
+  printf("lspclk_Hz,rate,result,brr,actual,error_ppm\n");
+
+  for(p=0;p<sizeof(BAUDTABLE_prescalers)/sizeof(BAUDTABLE_prescalers[0]);p++)
+    {
+      uint32_t lspClk_Hz = (uint32_t)(sysClk_MHz * 1000000.0 / BAUDTABLE_prescalers[p]);
+
+      for(r=0;r<sizeof(BAUDTABLE_rates)/sizeof(BAUDTABLE_rates[0]);r++)
+        {
+          BAUD_Config_t config;
+          uint32_t rate = BAUDTABLE_rates[r];
+          const char *pResult;
+
+          if(BAUD_compute(lspClk_Hz,rate,&config))
+            {
+              pResult = "ok";
+
+              if(!BAUDTABLE_check(lspClk_Hz,rate,&config))
+                {
+                  pResult = "FAIL";
+                  numFailed++;
+                }
+            }
+          else
+            {
+              pResult = "rejected";
+            }
+
+          printf("%lu,%lu,%s,%u,%lu,%ld\n",(unsigned long)lspClk_Hz,(unsigned long)rate,pResult,
+                 (unsigned int)config.brr,(unsigned long)config.actual,(long)config.error_ppm);
+        }
+    }
+
+  if(numFailed != 0)
+    {
+      fprintf(stderr,"baudtable: %u entries failed\n",numFailed);
+      return(1);
+    }
+
+  return(0);
+} // end of main() function
+
+
+// end of file
@@ -0,0 +1,318 @@
+//! \file   boottime.c
+//! \brief  Reports the boot timelines of the Teensy (rwp-1) and the F28069
+//!         (proj_lab05a) from a capture of the Teensy USB serial output
+//!
+//!         Build on Linux from this directory with
+//!
+//!           cc -O2 -I../../proj_lab05a -o boottime boottime.c
+//!
+//!         Usage
+//!
+//!           boottime [log ...]
+//!
+//!         The Teensy prints its setup() steps when 'b' is sent over USB
+//!         serial, and each BootMark frame of the F28069 as it comes:
+//!
+//!           boot teensy <step> <us since reset>
+//!           boot f28069 <CMDLINK_Boot_e> <us since HAL_init() returned>
+//!
+//!         Other lines are skipped, and the last line for a step wins.  The
+//!         standard input is read when no log is given.  Each timeline is
+//!         printed in time order with the length of every step.  When both
+//!         have their first torque command, the F28069 one is shifted onto
+//!         the Teensy clock there, leaving out the link time, and the two
+//!         are printed merged.
+
+
+// **************************************************************************
+// the includes
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cmdlink.h"
+
+
+// **************************************************************************
+// the defines
+
+//! \brief Defines the most Teensy steps kept
+//!
+#define BOOTTIME_MAX_STEPS          (32)
+
+//! \brief Defines the longest step name
+//!
+#define BOOTTIME_MAX_NAME           (32)
+
+//! \brief Defines the Teensy step of the first torque command
+//!
+#define BOOTTIME_TEENSY_FIRST_TORQUE  "first_torque"
+
+
+// **************************************************************************
+// the typedefs
+
+//! \brief Defines one step of a timeline
+//!
+typedef struct _BOOTTIME_Step_t_
+{
+  const char  *pMcu;                       //!< the MCU
+  char        name[BOOTTIME_MAX_NAME];     //!< the step name
+  double      end_us;                      //!< the time the step ended, us
+} BOOTTIME_Step_t;
+
+
+// **************************************************************************
+// the globals
+
+static const char *BOOTTIME_f28069Names[CMDLINK_NumBootPhases] =
+{
+  "HalInit", "UserCheck", "UserParams", "HalParams", "CtrlInit", "IntsOn",
+  "DrvSpi", "LoopStart", "OffLine", "OnLine", "FirstTorque"
+};
+
+static BOOTTIME_Step_t BOOTTIME_teensy[BOOTTIME_MAX_STEPS];
+
+static int BOOTTIME_numTeensy = 0;
+
+static double BOOTTIME_f28069_us[CMDLINK_NumBootPhases];
+
+static int BOOTTIME_f28069Have[CMDLINK_NumBootPhases];
+
+
+// **************************************************************************
+// the functions
+
+static void BOOTTIME_usage(const char *pName)
+{
+  fprintf(stderr,"usage: %s [log ...]\n",pName);
+} // end of BOOTTIME_usage() function
+
+
+static void BOOTTIME_putTeensy(const char *pName,const double end_us)
+{
+  int cnt;
+
+
+  for(cnt=0;cnt<BOOTTIME_numTeensy;cnt++)
+    {
+      if(strcmp(BOOTTIME_teensy[cnt].name,pName) == 0)
+        {
+          BOOTTIME_teensy[cnt].end_us = end_us;
+          return;
+        }
+    }
+
+  if(BOOTTIME_numTeensy == BOOTTIME_MAX_STEPS)
+    {
+      fprintf(stderr,"more than %d Teensy steps, %s skipped\n",BOOTTIME_MAX_STEPS,pName);
+      return;
+    }
+
+  BOOTTIME_teensy[BOOTTIME_numTeensy].pMcu = "teensy";
+  snprintf(BOOTTIME_teensy[BOOTTIME_numTeensy].name,BOOTTIME_MAX_NAME,"%s",pName);
+  BOOTTIME_teensy[BOOTTIME_numTeensy].end_us = end_us;
+  BOOTTIME_numTeensy++;
+} // end of BOOTTIME_putTeensy() function
+
+
+static int BOOTTIME_read(FILE *pFile)
+{
+  char line[256];
+  char mcu[16];
+  char name[BOOTTIME_MAX_NAME];
+  double end_us;
+  int numLines = 0;
+
+
+  while(fgets(line,sizeof(line),pFile) != NULL)
+    {
+      if(sscanf(line," boot %15s %31s %lf",mcu,name,&end_us) != 3)
+        {
+          continue;
+        }
+
+      if(strcmp(mcu,"teensy") == 0)
+        {
+          BOOTTIME_putTeensy(name,end_us);
+          numLines++;
+        }
+      else if(strcmp(mcu,"f28069") == 0)
+        {
+          int phase = atoi(name);
+
+          if((phase < 0) || (phase >= CMDLINK_NumBootPhases))
+            {
+              continue;
+            }
+
+          BOOTTIME_f28069_us[phase] = end_us;
+          BOOTTIME_f28069Have[phase] = 1;
+          numLines++;
+        }
+    }
+
+  return(numLines);
+} // end of BOOTTIME_read() function
+
+
+static int BOOTTIME_compare(const void *pA,const void *pB)
+{
+  const BOOTTIME_Step_t *pStepA = (const BOOTTIME_Step_t *)pA;
+  const BOOTTIME_Step_t *pStepB = (const BOOTTIME_Step_t *)pB;
+
+
+  return((pStepA->end_us > pStepB->end_us) - (pStepA->end_us < pStepB->end_us));
+} // end of BOOTTIME_compare() function
+
+
+//! \brief Prints steps in time order, each with the time since the one before
+static void BOOTTIME_print(const char *pTitle,BOOTTIME_Step_t *pSteps,const int numSteps,const int flag_mcu)
+{
+  double last_us = 0.0;
+  int cnt;
+
+
+  qsort(pSteps,(size_t)numSteps,sizeof(BOOTTIME_Step_t),BOOTTIME_compare);
+
+  printf("%s\n",pTitle);
+  printf("  %s%-14s %12s %12s\n",flag_mcu ? "mcu     " : "","step","end_ms","step_ms");
+
+  for(cnt=0;cnt<numSteps;cnt++)
+    {
+      if(flag_mcu)
+        {
+          printf("  %-8s",pSteps[cnt].pMcu);
+        }
+      else
+        {
+          printf("  ");
+        }
+
+      printf("%-14s %12.3f %12.3f\n",pSteps[cnt].name,pSteps[cnt].end_us * 1.0e-3,
+             (pSteps[cnt].end_us - last_us) * 1.0e-3);
+
+      last_us = pSteps[cnt].end_us;
+    }
+
+  printf("\n");
+} // end of BOOTTIME_print() function
+
+
+//! \brief Gets the F28069 steps, shifted by offset_us
+static int BOOTTIME_getF28069(BOOTTIME_Step_t *pSteps,const double offset_us)
+{
+  int numSteps = 0;
+  int phase;
+
+
+  for(phase=0;phase<CMDLINK_NumBootPhases;phase++)
+    {
+      if(BOOTTIME_f28069Have[phase])
+        {
+          pSteps[numSteps].pMcu = "f28069";
+          snprintf(pSteps[numSteps].name,BOOTTIME_MAX_NAME,"%s",BOOTTIME_f28069Names[phase]);
+          pSteps[numSteps].end_us = BOOTTIME_f28069_us[phase] + offset_us;
+          numSteps++;
+        }
+    }
+
+  return(numSteps);
+} // end of BOOTTIME_getF28069() function
+
+
+int main(int argc,char *argv[])
+{
+  BOOTTIME_Step_t steps[BOOTTIME_MAX_STEPS + CMDLINK_NumBootPhases];
+  int numLines = 0;
+  int numF28069;
+  int cnt;
+
+
+  if((argc > 1) && (argv[1][0] == '-') && (argv[1][1] != '\0'))
+    {
+      BOOTTIME_usage(argv[0]);
+      return(2);
+    }
+
+  if(argc < 2)
+    {
+      numLines = BOOTTIME_read(stdin);
+    }
+
+  for(cnt=1;cnt<argc;cnt++)
+    {
+      FILE *pFile = (strcmp(argv[cnt],"-") == 0) ? stdin : fopen(argv[cnt],"r");
+
+      if(pFile == NULL)
+        {
+          perror(argv[cnt]);
+          return(1);
+        }
+
+      numLines += BOOTTIME_read(pFile);
+
+      if(pFile != stdin)
+        {
+          fclose(pFile);
+        }
+    }
+
+  if(numLines == 0)
+    {
+      fprintf(stderr,"no boot lines, send 'b' to the Teensy while capturing\n");
+      return(1);
+    }
+
+  numF28069 = BOOTTIME_getF28069(steps,0.0);
+
+  if(numF28069 != 0)
+    {
+      BOOTTIME_print("F28069, from HAL_init() returned",steps,numF28069,0);
+
+      if(BOOTTIME_f28069Have[CMDLINK_Boot_OnLine])
+        {
+          printf("  HAL_init() to OnLine %.3f ms, offset calibration %s",
+                 BOOTTIME_f28069_us[CMDLINK_Boot_OnLine] * 1.0e-3,
+                 BOOTTIME_f28069Have[CMDLINK_Boot_OffLine] ? "ran" : "skipped, biases restored");
+
+          if(BOOTTIME_f28069Have[CMDLINK_Boot_OffLine])
+            {
+              printf(" %.3f ms",(BOOTTIME_f28069_us[CMDLINK_Boot_OnLine] - BOOTTIME_f28069_us[CMDLINK_Boot_OffLine]) * 1.0e-3);
+            }
+
+          printf("\n\n");
+        }
+    }
+
+  if(BOOTTIME_numTeensy != 0)
+    {
+      memcpy(steps,BOOTTIME_teensy,sizeof(BOOTTIME_Step_t) * (size_t)BOOTTIME_numTeensy);
+      BOOTTIME_print("Teensy, from reset",steps,BOOTTIME_numTeensy,0);
+    }
+
+  if((numF28069 != 0) && BOOTTIME_f28069Have[CMDLINK_Boot_FirstTorque])
+    {
+      for(cnt=0;cnt<BOOTTIME_numTeensy;cnt++)
+        {
+          if(strcmp(BOOTTIME_teensy[cnt].name,BOOTTIME_TEENSY_FIRST_TORQUE) == 0)
+            {
+              const double offset_us = BOOTTIME_teensy[cnt].end_us - BOOTTIME_f28069_us[CMDLINK_Boot_FirstTorque];
+
+              numF28069 = BOOTTIME_getF28069(steps,offset_us);
+              memcpy(&steps[numF28069],BOOTTIME_teensy,sizeof(BOOTTIME_Step_t) * (size_t)BOOTTIME_numTeensy);
+
+              printf("F28069 HAL_init() returned %.3f ms after the Teensy reset\n\n",offset_us * 1.0e-3);
+              BOOTTIME_print("Both, on the Teensy clock",steps,numF28069 + BOOTTIME_numTeensy,1);
+              break;
+            }
+        }
+    }
+
+  return(0);
+} // end of main() function
+
+
+// end of file
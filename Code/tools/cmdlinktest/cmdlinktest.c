@@ -0,0 +1,731 @@
+//! \file   cmdlinktest.c
+//! \brief  Checks the binary command link frame coder (see cmdlink.h) on the
+//!         host and times its decoder against the legacy ASCII command parser
+//!         it replaced (see cmdparse.h)
+//!
+//!         Build on Linux from this directory with
+//!
+//!           cc -O2 -I../../proj_lab05a -o cmdlinktest cmdlinktest.c
+//!              ../../proj_lab05a/cmdlink.c ../../proj_lab05a/cmdparse.c
+//!              ../../proj_lab05a/telem.c
+//!
+//!         Usage
+//!
+//!           cmdlinktest [-n num] [-r repeats] [-s seed]
+//!
+//!         The checks run first and the exit status is 1 if any fails:
+//!
+//!           - CRC-8 check values, and CMDLINK_crc8() against a bit at a
+//!             time CRC over num random buffers
+//!           - encode and decode round trips of every frame type, each with
+//!             0, -1, INT32_MIN, INT32_MAX and num random payloads, and of the
+//!             Excite, Model and Echo payload macros
+//!           - resynchronization after num runs of garbage, with and without
+//!             sync bytes in it, and after num frames cut short by a dropped
+//!             byte.  A dropped byte costs the frame it was in; a following
+//!             frame may only be lost to a false frame passing the CRC.
+//!           - num frames of the F28069 transmit stream, command link frames
+//!             between TELEM_encode() telemetry frames of random channels,
+//!             their values full of CMDLINK_SYNC and some holding a whole
+//!             encoded frame.  CMDLINK_decodeMixed() must give exactly the
+//!             command link frames sent, with no false frame and no errors.
+//!             CMDLINK_decode() must give false frames on the same stream.
+//!
+//!         The timings feed the same torque commands, repeated, to the
+//!         CMDLINK decoder as frames and to the CMDPARSE parser as the
+//!         "%.4fa" text the Teensy sent before, and report nanoseconds per
+//!         command and per byte.  Keep the Code/rwp-1 copy of cmdlink.c
+//!         identical, this checks the Code/proj_lab05a one.
+
+
+// **************************************************************************
+// the includes
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "cmdlink.h"
+#include "cmdparse.h"
+#include "telem.h"
+
+
+// **************************************************************************
+// the defines
+
+//! \brief Defines the number of frame types
+//!
+#define CMDLINKTEST_NUM_TYPES       (CMDLINK_Type_BootMark + 1)
+
+//! \brief Defines the longest run of garbage, bytes
+//!
+#define CMDLINKTEST_MAX_GARBAGE     (40)
+
+//! \brief Defines the number of good frames sent after a damaged one
+//!
+#define CMDLINKTEST_NUM_AFTER       (4)
+
+//! \brief Defines the longest ASCII command, "-12.3456a"
+//!
+#define CMDLINKTEST_MAX_TEXT        (16)
+
+
+// **************************************************************************
+// the globals
+
+static uint64_t gSeed = 0x9E3779B97F4A7C15ULL;
+
+static unsigned long gNumFailures = 0;
+
+static volatile int32_t gSink;
+
+
+// **************************************************************************
+// the functions
+
+static uint32_t CMDLINKTEST_rand(void)
+{
+  // xorshift64*
+  gSeed ^= gSeed >> 12;
+  gSeed ^= gSeed << 25;
+  gSeed ^= gSeed >> 27;
+
+  return((uint32_t)((gSeed * 0x2545F4914F6CDD1DULL) >> 32));
+} // end of CMDLINKTEST_rand() function
+
+
+static void CMDLINKTEST_fail(const char *pFormat,...)
+{
+  va_list args;
+
+
+  if(gNumFailures++ < 20)
+    {
+      va_start(args,pFormat);
+      fprintf(stderr,"cmdlinktest: ");
+      vfprintf(stderr,pFormat,args);
+      fprintf(stderr,"\n");
+      va_end(args);
+    }
+} // end of CMDLINKTEST_fail() function
+
+
+//! \brief The CRC-8 a bit at a time, poly 0x07, init 0x00
+static uint_least8_t CMDLINKTEST_crc8(const uint_least8_t *pData,const size_t length)
+{
+  uint_least8_t crc = 0;
+  size_t cnt;
+  int bit;
+
+
+  for(cnt=0;cnt<length;cnt++)
+    {
+      crc ^= pData[cnt];
+
+      for(bit=0;bit<8;bit++)
+        {
+          crc = (crc & 0x80) ? (uint_least8_t)(((crc << 1) ^ 0x07) & 0xFF) : (uint_least8_t)((crc << 1) & 0xFF);
+        }
+    }
+
+  return(crc);
+} // end of CMDLINKTEST_crc8() function
+
+
+static void CMDLINKTEST_checkCrc(const unsigned long num)
+{
+  static const uint_least8_t check[9] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+  static const uint_least8_t zeros[6] = {0, 0, 0, 0, 0, 0};
+  uint_least8_t buf[CMDLINK_CRC_LENGTH];
+  unsigned long cnt;
+  int k;
+
+
+  // the CRC-8 check value, and no init or final XOR
+  if(CMDLINK_crc8(check,9) != 0xF4)
+    {
+      CMDLINKTEST_fail("crc8(\"123456789\") = 0x%02X, expected 0xF4",CMDLINK_crc8(check,9));
+    }
+
+  if(CMDLINK_crc8(zeros,6) != 0x00)
+    {
+      CMDLINKTEST_fail("crc8(zeros) = 0x%02X, expected 0x00",CMDLINK_crc8(zeros,6));
+    }
+
+  for(k=0;k<256;k++)
+    {
+      buf[0] = (uint_least8_t)k;
+
+      if(CMDLINK_crc8(buf,1) != CMDLINKTEST_crc8(buf,1))
+        {
+          CMDLINKTEST_fail("crc8(0x%02X) = 0x%02X",k,CMDLINK_crc8(buf,1));
+        }
+    }
+
+  for(cnt=0;cnt<num;cnt++)
+    {
+      for(k=0;k<CMDLINK_CRC_LENGTH;k++)
+        {
+          buf[k] = (uint_least8_t)(CMDLINKTEST_rand() & 0xFF);
+        }
+
+      if(CMDLINK_crc8(buf,CMDLINK_CRC_LENGTH) != CMDLINKTEST_crc8(buf,CMDLINK_CRC_LENGTH))
+        {
+          CMDLINKTEST_fail("crc8 of random buffer %lu = 0x%02X",cnt,CMDLINK_crc8(buf,CMDLINK_CRC_LENGTH));
+        }
+    }
+
+  return;
+} // end of CMDLINKTEST_checkCrc() function
+
+
+static void CMDLINKTEST_randFrame(CMDLINK_Frame_t *pFrame)
+{
+  pFrame->seq = (uint_least8_t)(CMDLINKTEST_rand() & 0xFF);
+  pFrame->type = (uint_least8_t)(CMDLINKTEST_rand() % CMDLINKTEST_NUM_TYPES);
+  pFrame->payload = (int32_t)CMDLINKTEST_rand();
+} // end of CMDLINKTEST_randFrame() function
+
+
+static bool CMDLINKTEST_isSame(const CMDLINK_Frame_t *pA,const CMDLINK_Frame_t *pB)
+{
+  return((pA->seq == pB->seq) && (pA->type == pB->type) && (pA->payload == pB->payload));
+} // end of CMDLINKTEST_isSame() function
+
+
+//! \brief Feeds bytes to the decoder, returns the number of frames decoded into pFrames
+static int CMDLINKTEST_feed(CMDLINK_Decoder_t *pDecoder,const uint_least8_t *pBuf,const size_t length,
+                            CMDLINK_Frame_t *pFrames,const int maxFrames)
+{
+  int numFrames = 0;
+  size_t cnt;
+
+
+  for(cnt=0;cnt<length;cnt++)
+    {
+      CMDLINK_Frame_t frame;
+
+      if(CMDLINK_decode(pDecoder,pBuf[cnt],&frame) && (numFrames < maxFrames))
+        {
+          pFrames[numFrames++] = frame;
+        }
+    }
+
+  return(numFrames);
+} // end of CMDLINKTEST_feed() function
+
+
+static void CMDLINKTEST_checkRoundTrip(const unsigned long num)
+{
+  static const int32_t edges[4] = {0, -1, INT32_MIN, INT32_MAX};
+  CMDLINK_Decoder_t decoder;
+  uint_least8_t buf[CMDLINK_FRAME_LENGTH];
+  unsigned long cnt;
+  int type;
+
+
+  CMDLINK_initDecoder(&decoder);
+
+  for(type=0;type<CMDLINKTEST_NUM_TYPES;type++)
+    {
+      for(cnt=0;cnt<num + 4;cnt++)
+        {
+          CMDLINK_Frame_t frame;
+          CMDLINK_Frame_t decoded = {0, 0, 0};
+
+          frame.seq = (uint_least8_t)(CMDLINKTEST_rand() & 0xFF);
+          frame.type = (uint_least8_t)type;
+          frame.payload = (cnt < 4) ? edges[cnt] : (int32_t)CMDLINKTEST_rand();
+
+          CMDLINK_encode(buf,&frame);
+
+          if((buf[0] != CMDLINK_SYNC) || (buf[7] != CMDLINKTEST_crc8(&buf[1],CMDLINK_CRC_LENGTH)))
+            {
+              CMDLINKTEST_fail("type %d payload 0x%08lX encoded without sync or CRC",type,(unsigned long)(uint32_t)frame.payload);
+            }
+
+          if((CMDLINKTEST_feed(&decoder,buf,CMDLINK_FRAME_LENGTH,&decoded,1) != 1) ||
+             !CMDLINKTEST_isSame(&frame,&decoded))
+            {
+              CMDLINKTEST_fail("type %d payload 0x%08lX did not round trip",type,(unsigned long)(uint32_t)frame.payload);
+            }
+        }
+    }
+
+  if((decoder.numFrames != (uint32_t)(CMDLINKTEST_NUM_TYPES * (num + 4))) ||
+     (decoder.numCrcErrors != 0) || (decoder.numSyncErrors != 0))
+    {
+      CMDLINKTEST_fail("round trip counts %lu frames, %lu errors",(unsigned long)decoder.numFrames,
+                       (unsigned long)(decoder.numCrcErrors + decoder.numSyncErrors));
+    }
+
+  // the payload macros, the parameter value keeps 24 bits with its sign
+  for(cnt=0;cnt<num;cnt++)
+    {
+      const uint_least8_t id = (uint_least8_t)(CMDLINKTEST_rand() & 0xFF);
+      const int32_t value = (int32_t)(CMDLINKTEST_rand() & 0xFFFFFF) - 0x800000L;
+      const int32_t payload = CMDLINK_makeParamPayload(id,value);
+      const uint32_t echo = CMDLINKTEST_rand();
+
+      if((CMDLINK_getParamId(payload) != id) || (CMDLINK_getParamValue(payload) != value))
+        {
+          CMDLINKTEST_fail("param payload id %d value %ld did not round trip",id,(long)value);
+        }
+
+      if((CMDLINK_getEchoRxToApply_us(echo) != (echo & 0xFFFF)) ||
+         (CMDLINK_getEchoApplyToPwm_us(echo) != (echo >> 16)))
+        {
+          CMDLINKTEST_fail("echo payload 0x%08lX split wrong",(unsigned long)echo);
+        }
+    }
+
+  return;
+} // end of CMDLINKTEST_checkRoundTrip() function
+
+
+//! \brief Sends a damaged stream then good frames, checks the good ones come out
+static void CMDLINKTEST_checkAfter(const char *pName,const uint_least8_t *pDamage,const size_t damageLength,
+                                   const bool flag_damageIsFrame)
+{
+  CMDLINK_Decoder_t decoder;
+  CMDLINK_Frame_t sent[CMDLINKTEST_NUM_AFTER];
+  CMDLINK_Frame_t decoded[CMDLINKTEST_MAX_GARBAGE + CMDLINKTEST_NUM_AFTER];
+  uint_least8_t stream[CMDLINKTEST_MAX_GARBAGE + CMDLINKTEST_NUM_AFTER * CMDLINK_FRAME_LENGTH];
+  int numDecoded;
+  int numFound = 0;
+  int numFalse;
+  int cnt;
+  int k;
+
+
+  memcpy(stream,pDamage,damageLength);
+
+  for(cnt=0;cnt<CMDLINKTEST_NUM_AFTER;cnt++)
+    {
+      CMDLINKTEST_randFrame(&sent[cnt]);
+      CMDLINK_encode(&stream[damageLength + cnt * CMDLINK_FRAME_LENGTH],&sent[cnt]);
+    }
+
+  CMDLINK_initDecoder(&decoder);
+  numDecoded = CMDLINKTEST_feed(&decoder,stream,damageLength + CMDLINKTEST_NUM_AFTER * CMDLINK_FRAME_LENGTH,
+                                decoded,CMDLINKTEST_MAX_GARBAGE + CMDLINKTEST_NUM_AFTER);
+
+  // a decoded frame that was not sent is a false frame
+  for(k=0;k<numDecoded;k++)
+    {
+      for(cnt=0;cnt<CMDLINKTEST_NUM_AFTER;cnt++)
+        {
+          if(CMDLINKTEST_isSame(&decoded[k],&sent[cnt]))
+            {
+              numFound++;
+              break;
+            }
+        }
+    }
+
+  numFalse = numDecoded - numFound;
+
+  // only a false frame can take the start of a good one with it
+  if((numFound < CMDLINKTEST_NUM_AFTER) && (numFalse == 0))
+    {
+      CMDLINKTEST_fail("%s: %d good frames lost",pName,CMDLINKTEST_NUM_AFTER - numFound);
+    }
+
+  // without a sync byte in the garbage there is nothing to mistake
+  if(!flag_damageIsFrame && (memchr(pDamage,CMDLINK_SYNC,damageLength) == NULL) &&
+     ((numDecoded != CMDLINKTEST_NUM_AFTER) || (decoder.numSyncErrors != damageLength)))
+    {
+      CMDLINKTEST_fail("%s: %d frames decoded after garbage without sync",pName,numDecoded);
+    }
+
+  return;
+} // end of CMDLINKTEST_checkAfter() function
+
+
+static void CMDLINKTEST_checkResync(const unsigned long num)
+{
+  uint_least8_t damage[CMDLINKTEST_MAX_GARBAGE];
+  unsigned long cnt;
+
+
+  for(cnt=0;cnt<num;cnt++)
+    {
+      const size_t length = 1 + CMDLINKTEST_rand() % CMDLINKTEST_MAX_GARBAGE;
+      const int mode = (int)(cnt % 3);
+      size_t k;
+
+      if(mode == 2)
+        {
+          // a frame cut short by one dropped byte, the sync byte too
+          CMDLINK_Frame_t frame;
+          uint_least8_t buf[CMDLINK_FRAME_LENGTH];
+          const size_t drop = CMDLINKTEST_rand() % CMDLINK_FRAME_LENGTH;
+
+          CMDLINKTEST_randFrame(&frame);
+          CMDLINK_encode(buf,&frame);
+
+          for(k=0;k<CMDLINK_FRAME_LENGTH - 1;k++)
+            {
+              damage[k] = buf[(k < drop) ? k : k + 1];
+            }
+
+          CMDLINKTEST_checkAfter("truncated frame",damage,CMDLINK_FRAME_LENGTH - 1,true);
+          continue;
+        }
+
+      for(k=0;k<length;k++)
+        {
+          damage[k] = (uint_least8_t)(CMDLINKTEST_rand() & 0xFF);
+
+          // mode 0 is garbage from a wrong baud rate or noise without sync bytes
+          if((mode == 0) && (damage[k] == CMDLINK_SYNC))
+            {
+              damage[k] = 0x5A;
+            }
+        }
+
+      CMDLINKTEST_checkAfter((mode == 0) ? "garbage" : "garbage with sync",damage,length,false);
+    }
+
+  return;
+} // end of CMDLINKTEST_checkResync() function
+
+
+//! \brief Builds a telemetry frame of random channels, returns its length
+static uint_least16_t CMDLINKTEST_buildTelem(TELEM_Obj *pTelem,uint_least8_t *pBuf,bool *pFlag_embedded)
+{
+  const uint_least16_t mask = (uint_least16_t)(1 + CMDLINKTEST_rand() % ((1 << TELEM_NumChannels) - 1));
+  uint_least8_t bytes[4 * TELEM_NumChannels];
+  int32_t values[TELEM_NumChannels];
+  size_t numBytes = 0;
+  size_t cnt;
+
+
+  // the values of the channels present, in frame order, sync bytes one in four
+  for(cnt=0;cnt<TELEM_NumChannels;cnt++)
+    {
+      numBytes += (mask & (1 << cnt)) ? 4 : 0;
+    }
+
+  for(cnt=0;cnt<numBytes;cnt++)
+    {
+      const uint32_t r = CMDLINKTEST_rand();
+
+      bytes[cnt] = ((r & 3) == 0) ? CMDLINK_SYNC : (uint_least8_t)(r >> 24);
+    }
+
+  // now and then a whole frame, a Speed frame would feed the balance law
+  *pFlag_embedded = (numBytes >= CMDLINK_FRAME_LENGTH) && ((CMDLINKTEST_rand() & 3) == 0);
+
+  if(*pFlag_embedded)
+    {
+      CMDLINK_Frame_t frame;
+
+      CMDLINKTEST_randFrame(&frame);
+      frame.type = CMDLINK_Type_Speed;
+      CMDLINK_encode(&bytes[CMDLINKTEST_rand() % (numBytes - CMDLINK_FRAME_LENGTH + 1)],&frame);
+    }
+
+  numBytes = 0;
+
+  for(cnt=0;cnt<TELEM_NumChannels;cnt++)
+    {
+      values[cnt] = 0;
+
+      if(mask & (1 << cnt))
+        {
+          values[cnt] = (int32_t)((uint32_t)bytes[numBytes] | ((uint32_t)bytes[numBytes + 1] << 8) |
+                                  ((uint32_t)bytes[numBytes + 2] << 16) | ((uint32_t)bytes[numBytes + 3] << 24));
+          numBytes += 4;
+        }
+    }
+
+  pTelem->tick = (uint_least16_t)CMDLINKTEST_rand();
+  TELEM_putSample(pTelem,mask,values);
+
+  return(TELEM_encode(pTelem,pBuf));
+} // end of CMDLINKTEST_buildTelem() function
+
+
+static void CMDLINKTEST_checkMixed(const unsigned long num)
+{
+  uint_least8_t *pStream = malloc(num * TELEM_MAX_FRAME_LENGTH);
+  CMDLINK_Frame_t *pSent = malloc(num * sizeof(CMDLINK_Frame_t));
+  TELEM_Obj telem;
+  CMDLINK_Decoder_t mixed;
+  CMDLINK_Decoder_t plain;
+  size_t length = 0;
+  unsigned long numSent = 0;
+  unsigned long numTelem = 0;
+  unsigned long numEmbedded = 0;
+  unsigned long numDecoded = 0;
+  unsigned long numFalse = 0;
+  unsigned long numPlainFalse = 0;
+  unsigned long next = 0;
+  unsigned long cnt;
+  size_t k;
+
+
+  TELEM_init(&telem);
+
+  for(cnt=0;cnt<num;cnt++)
+    {
+      if(CMDLINKTEST_rand() & 1)
+        {
+          bool flag_embedded;
+
+          length += CMDLINKTEST_buildTelem(&telem,&pStream[length],&flag_embedded);
+          numTelem++;
+          numEmbedded += flag_embedded;
+        }
+      else
+        {
+          CMDLINKTEST_randFrame(&pSent[numSent]);
+          CMDLINK_encode(&pStream[length],&pSent[numSent]);
+          length += CMDLINK_FRAME_LENGTH;
+          numSent++;
+        }
+    }
+
+  CMDLINK_initDecoder(&mixed);
+  CMDLINK_initDecoder(&plain);
+
+  for(k=0;k<length;k++)
+    {
+      CMDLINK_Frame_t frame = {0, 0, 0};
+
+      if(CMDLINK_decodeMixed(&mixed,pStream[k],&frame))
+        {
+          if((numDecoded < numSent) && CMDLINKTEST_isSame(&frame,&pSent[numDecoded]))
+            {
+              numDecoded++;
+            }
+          else
+            {
+              numFalse++;
+            }
+        }
+
+      // the plain decoder, a frame not among the next few sent is false
+      if(CMDLINK_decode(&plain,pStream[k],&frame))
+        {
+          unsigned long look;
+
+          for(look=next;(look < numSent) && (look < next + 4);look++)
+            {
+              if(CMDLINKTEST_isSame(&frame,&pSent[look]))
+                {
+                  break;
+                }
+            }
+
+          if((look < numSent) && (look < next + 4))
+            {
+              next = look + 1;
+            }
+          else
+            {
+              numPlainFalse++;
+            }
+        }
+    }
+
+  if((numFalse != 0) || (numDecoded != numSent) || (mixed.numTelemFrames != numTelem) ||
+     (mixed.numCrcErrors != 0) || (mixed.numSyncErrors != 0))
+    {
+      CMDLINKTEST_fail("mixed: %lu of %lu frames, %lu false, %lu of %lu telemetry frames, %lu CRC and %lu sync errors",
+                       numDecoded,numSent,numFalse,(unsigned long)mixed.numTelemFrames,numTelem,
+                       (unsigned long)mixed.numCrcErrors,(unsigned long)mixed.numSyncErrors);
+    }
+
+  if(numPlainFalse == 0)
+    {
+      CMDLINKTEST_fail("mixed: CMDLINK_decode gave no false frame, the stream does not test the skipping");
+    }
+
+  printf("mixed: %lu frames between %lu telemetry frames, %lu holding a frame; "
+         "CMDLINK_decodeMixed %lu false, CMDLINK_decode %lu false\n",
+         numSent,numTelem,numEmbedded,numFalse,numPlainFalse);
+
+  free(pStream);
+  free(pSent);
+
+  return;
+} // end of CMDLINKTEST_checkMixed() function
+
+
+static double CMDLINKTEST_getTime(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC,&now);
+
+  return((double)now.tv_sec + 1.0e-9 * (double)now.tv_nsec);
+} // end of CMDLINKTEST_getTime() function
+
+
+// the loops are not inlined so each one is timed as written
+
+static __attribute__((noinline)) int32_t CMDLINKTEST_runDecoder(CMDLINK_Decoder_t *pDecoder,const uint_least8_t *pBytes,
+                                                                const size_t numBytes)
+{
+  int32_t sum = 0;
+  size_t cnt;
+
+
+  for(cnt=0;cnt<numBytes;cnt++)
+    {
+      CMDLINK_Frame_t frame;
+
+      if(CMDLINK_decode(pDecoder,pBytes[cnt],&frame) && (frame.type == CMDLINK_Type_Torque))
+        {
+          sum += frame.payload;
+        }
+    }
+
+  return(sum);
+} // end of CMDLINKTEST_runDecoder() function
+
+
+static __attribute__((noinline)) int32_t CMDLINKTEST_runParser(CMDPARSE_Obj *pParser,const char *pText,
+                                                               const size_t numBytes)
+{
+  int32_t sum = 0;
+  size_t cnt;
+
+
+  for(cnt=0;cnt<numBytes;cnt++)
+    {
+      if(pText[cnt] == 'a')
+        {
+          int32_t value;
+
+          if(CMDPARSE_commit(pParser,&value) == CMDPARSE_Status_Ok)
+            {
+              sum += value;
+            }
+        }
+      else
+        {
+          CMDPARSE_putChar(pParser,pText[cnt]);
+        }
+    }
+
+  return(sum);
+} // end of CMDLINKTEST_runParser() function
+
+
+static void CMDLINKTEST_report(const char *pName,const double start,const double stop,const size_t num,
+                               const size_t numBytes,const long numRepeats)
+{
+  double ns = (stop - start) * 1.0e9 / (double)numRepeats;
+
+  printf("  %-16s %8.2f ns per command  %6.2f ns per byte  %5.2f bytes per command\n",pName,
+         ns / (double)num,ns / (double)numBytes,(double)numBytes / (double)num);
+} // end of CMDLINKTEST_report() function
+
+
+static void CMDLINKTEST_bench(const size_t num,const long numRepeats)
+{
+  uint_least8_t *pBytes = malloc(num * CMDLINK_FRAME_LENGTH);
+  char *pText = malloc(num * CMDLINKTEST_MAX_TEXT + 1);
+  CMDLINK_Decoder_t decoder;
+  CMDPARSE_Obj parser;
+  size_t textLength = 0;
+  double start;
+  size_t cnt;
+  long repeat;
+
+
+  // torque commands within +-20 A, as IQ24 and as the text the Teensy printed
+  for(cnt=0;cnt<num;cnt++)
+    {
+      const double iq_A = 40.0 * (double)CMDLINKTEST_rand() / 4294967296.0 - 20.0;
+      CMDLINK_Frame_t frame;
+
+      frame.seq = (uint_least8_t)(cnt & 0xFF);
+      frame.type = CMDLINK_Type_Torque;
+      frame.payload = (int32_t)(iq_A * 16777216.0);
+      CMDLINK_encode(&pBytes[cnt * CMDLINK_FRAME_LENGTH],&frame);
+
+      textLength += (size_t)snprintf(&pText[textLength],CMDLINKTEST_MAX_TEXT,"%.4fa",iq_A);
+    }
+
+  printf("%lu torque commands x %ld\n",(unsigned long)num,numRepeats);
+
+  CMDLINK_initDecoder(&decoder);
+  start = CMDLINKTEST_getTime();
+  for(repeat=0;repeat<numRepeats;repeat++) gSink += CMDLINKTEST_runDecoder(&decoder,pBytes,num * CMDLINK_FRAME_LENGTH);
+  CMDLINKTEST_report("CMDLINK_decode",start,CMDLINKTEST_getTime(),num,num * CMDLINK_FRAME_LENGTH,numRepeats);
+
+  CMDPARSE_init(&parser);
+  start = CMDLINKTEST_getTime();
+  for(repeat=0;repeat<numRepeats;repeat++) gSink += CMDLINKTEST_runParser(&parser,pText,textLength);
+  CMDLINKTEST_report("CMDPARSE ASCII",start,CMDLINKTEST_getTime(),num,textLength,numRepeats);
+
+  if((decoder.numFrames != (uint32_t)(num * (size_t)numRepeats)) || (parser.numErrors != 0))
+    {
+      CMDLINKTEST_fail("benchmark decoded %lu frames, %lu parse errors",(unsigned long)decoder.numFrames,
+                       (unsigned long)parser.numErrors);
+    }
+
+  free(pBytes);
+  free(pText);
+
+  return;
+} // end of CMDLINKTEST_bench() function
+
+
+static void CMDLINKTEST_usage(void)
+{
+  fprintf(stderr,"usage: cmdlinktest [-n num] [-r repeats] [-s seed]\n");
+} // end of CMDLINKTEST_usage() function
+
+
+int main(int argc,char *argv[])
+{
+  size_t num = 4096;
+  long numRepeats = 2000;
+  int opt;
+
+
+  while((opt = getopt(argc,argv,"n:r:s:")) != -1)
+    {
+      switch(opt)
+        {
+          case 'n': num = (size_t)strtoul(optarg,NULL,10); break;
+          case 'r': numRepeats = strtol(optarg,NULL,10); break;
+          case 's': gSeed = strtoull(optarg,NULL,0) | 1; break;
+          default:  CMDLINKTEST_usage(); return(2);
+        }
+    }
+
+  if((optind != argc) || (num < 1) || (numRepeats < 1))
+    {
+      CMDLINKTEST_usage();
+      return(2);
+    }
+
+  CMDLINKTEST_checkCrc(num * 100);
+  CMDLINKTEST_checkRoundTrip(num);
+  CMDLINKTEST_checkResync(num * 10);
+  CMDLINKTEST_checkMixed(num * 10);
+
+  printf("checks: %lu failures\n",gNumFailures);
+
+  if(gNumFailures != 0)
+    {
+      return(1);
+    }
+
+  CMDLINKTEST_bench(num,numRepeats);
+
+  return((gNumFailures != 0) ? 1 : 0);
+} // end of main() function
+
+
+// end of file
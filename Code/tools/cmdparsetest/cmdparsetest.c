@@ -0,0 +1,446 @@
+//! \file   cmdparsetest.c
+//! \brief  Fuzzes the legacy ASCII torque command parser (see cmdparse.h)
+//!         against the host _atoIQ emulation in ../iqmath on the host
+//!
+//!         Build on Linux from this directory with
+//!
+//!           cc -O2 -I../../proj_lab05a -I../iqmath -o cmdparsetest cmdparsetest.c
+//!              ../../proj_lab05a/cmdparse.c ../iqmath/IQmathLib.c -lm
+//!
+//!         Usage
+//!
+//!           cmdparsetest [-n num] [-s seed]
+//!
+//!         The firmware parsed these commands with _atoIQ before CMDPARSE
+//!         replaced it, so the two must agree.  The checks run first on fixed
+//!         cases, then on num random numbers built from
+//!
+//!           - no sign, '+' or '-'
+//!           - up to 6 leading zeros
+//!           - up to 3 integer digits, most 3 digit ones past
+//!             CMDPARSE_MAX_INT, or now and then up to 12
+//!           - no point, a bare point, or up to 30 fraction digits, past the
+//!             CMDPARSE_MAX_FRAC_DIGITS that can move an IQ24 value
+//!           - one in eight fractions the 24 digits of an exact IQ24 step,
+//!             as is, 1e-24 below it, or with more digits after it
+//!
+//!         Both truncate the exact value toward zero and must match bit for
+//!         bit for every number that does not overflow.  An integer part
+//!         above CMDPARSE_MAX_INT must give Overflow and the value _atoIQ
+//!         saturates to.  Each number is also fed with
+//!         whitespace between the characters, which CMDPARSE skips, and
+//!         malformed and empty commands must not write the value.  The exit
+//!         status is 1 if any check fails.
+
+
+// **************************************************************************
+// the includes
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "IQmathLib.h"
+#include "cmdparse.h"
+
+
+// **************************************************************************
+// the defines
+
+//! \brief Defines the longest generated number
+//!
+#define CMDPARSETEST_MAX_LENGTH     (64)
+
+//! \brief Defines the value the parser must leave alone on Malformed and Empty
+//!
+#define CMDPARSETEST_UNTOUCHED      ((int32_t)0x5A5A5A5AL)
+
+
+// **************************************************************************
+// the typedefs
+
+//! \brief Defines a fixed case
+//!
+typedef struct _CMDPARSETEST_Case_t_
+{
+  const char          *pText;    //!< the command without its 'a'
+  CMDPARSE_Status_e   status;    //!< the status expected
+  int32_t             value;     //!< the IQ24 value expected, for Ok and Overflow
+} CMDPARSETEST_Case_t;
+
+
+// **************************************************************************
+// the globals
+
+static uint64_t gSeed = 0x9E3779B97F4A7C15ULL;
+
+static unsigned long gNumFailures = 0;
+
+static const CMDPARSETEST_Case_t CMDPARSETEST_cases[] =
+{
+  {"0",              CMDPARSE_Status_Ok,         0},
+  {"-0",             CMDPARSE_Status_Ok,         0},
+  {"+0.000",         CMDPARSE_Status_Ok,         0},
+  {"1",              CMDPARSE_Status_Ok,         0x01000000L},
+  {"+1.5",           CMDPARSE_Status_Ok,         0x01800000L},
+  {"-1.5",           CMDPARSE_Status_Ok,         -0x01800000L},
+  {"007.25",         CMDPARSE_Status_Ok,         0x07400000L},
+  {"-000.5",         CMDPARSE_Status_Ok,         -0x00800000L},
+  {".5",             CMDPARSE_Status_Ok,         0x00800000L},
+  {"5.",             CMDPARSE_Status_Ok,         0x05000000L},
+  {"0.1",            CMDPARSE_Status_Ok,         0x00199999L},
+  {"-0.1",           CMDPARSE_Status_Ok,         -0x00199999L},
+  {"0.00000006",     CMDPARSE_Status_Ok,         1},
+  {"0.00000005",     CMDPARSE_Status_Ok,         0},
+  {"-0.00000006",    CMDPARSE_Status_Ok,         -1},
+  {"0.0000000599",   CMDPARSE_Status_Ok,         1},
+  {"0.000000059604644775390625",   CMDPARSE_Status_Ok,  1},
+  {"0.000000059604644775390624",   CMDPARSE_Status_Ok,  0},
+  {"0.0000000596046447753906249999", CMDPARSE_Status_Ok,  0},
+  {"0.0000000596046447753906250001", CMDPARSE_Status_Ok,  1},
+  {"-0.000000059604644775390625",  CMDPARSE_Status_Ok,  -1},
+  {"0.999999940395355224609375",   CMDPARSE_Status_Ok,  0x00FFFFFFL},
+  {"0.999999940395355224609374",   CMDPARSE_Status_Ok,  0x00FFFFFEL},
+  {"127.99999999",   CMDPARSE_Status_Ok,         0x7FFFFFFFL},
+  {"-127.99999999",  CMDPARSE_Status_Ok,         -0x7FFFFFFFL},
+  {"127",            CMDPARSE_Status_Ok,         0x7F000000L},
+  {"128",            CMDPARSE_Status_Overflow,   INT32_MAX},
+  {"-128",           CMDPARSE_Status_Overflow,   INT32_MIN},
+  {"99999999999999", CMDPARSE_Status_Overflow,   INT32_MAX},
+  {"-1000.5",        CMDPARSE_Status_Overflow,   INT32_MIN},
+  {" - 1 . 5 ",      CMDPARSE_Status_Ok,         -0x01800000L},
+  {"",               CMDPARSE_Status_Empty,      0},
+  {"-",              CMDPARSE_Status_Empty,      0},
+  {".",              CMDPARSE_Status_Empty,      0},
+  {"+.",             CMDPARSE_Status_Empty,      0},
+  {"--1",            CMDPARSE_Status_Malformed,  0},
+  {"1-",             CMDPARSE_Status_Malformed,  0},
+  {"1.2.3",          CMDPARSE_Status_Malformed,  0},
+  {"1e3",            CMDPARSE_Status_Malformed,  0},
+  {"0x10",           CMDPARSE_Status_Malformed,  0}
+};
+
+
+// **************************************************************************
+// the functions
+
+static uint32_t CMDPARSETEST_rand(void)
+{
+  // xorshift64*
+  gSeed ^= gSeed >> 12;
+  gSeed ^= gSeed << 25;
+  gSeed ^= gSeed >> 27;
+
+  return((uint32_t)((gSeed * 0x2545F4914F6CDD1DULL) >> 32));
+} // end of CMDPARSETEST_rand() function
+
+
+static void CMDPARSETEST_fail(const char *pFormat,...)
+{
+  va_list args;
+
+
+  if(gNumFailures++ < 20)
+    {
+      va_start(args,pFormat);
+      fprintf(stderr,"cmdparsetest: ");
+      vfprintf(stderr,pFormat,args);
+      fprintf(stderr,"\n");
+      va_end(args);
+    }
+} // end of CMDPARSETEST_fail() function
+
+
+//! \brief Parses a command as the firmware does, the 'a' terminator commits it
+static CMDPARSE_Status_e CMDPARSETEST_parse(CMDPARSE_Obj *pParser,const char *pText,int32_t *pValue)
+{
+  *pValue = CMDPARSETEST_UNTOUCHED;
+
+  for(;*pText!='\0';pText++)
+    {
+      CMDPARSE_putChar(pParser,*pText);
+    }
+
+  return(CMDPARSE_commit(pParser,pValue));
+} // end of CMDPARSETEST_parse() function
+
+
+static void CMDPARSETEST_checkFixed(void)
+{
+  CMDPARSE_Obj parser;
+  unsigned long numErrors = 0;
+  size_t cnt;
+
+
+  CMDPARSE_init(&parser);
+
+  for(cnt=0;cnt<sizeof(CMDPARSETEST_cases) / sizeof(CMDPARSETEST_cases[0]);cnt++)
+    {
+      const CMDPARSETEST_Case_t *pCase = &CMDPARSETEST_cases[cnt];
+      const bool flag_written = (pCase->status == CMDPARSE_Status_Ok) || (pCase->status == CMDPARSE_Status_Overflow);
+      int32_t value;
+      CMDPARSE_Status_e status = CMDPARSETEST_parse(&parser,pCase->pText,&value);
+
+      if((status != pCase->status) ||
+         (flag_written ? (value != pCase->value) : (value != CMDPARSETEST_UNTOUCHED)))
+        {
+          CMDPARSETEST_fail("\"%s\": status %d value 0x%08lX, expected status %d value 0x%08lX",pCase->pText,status,
+                            (unsigned long)(uint32_t)value,pCase->status,(unsigned long)(uint32_t)pCase->value);
+        }
+
+      numErrors += (pCase->status != CMDPARSE_Status_Ok);
+    }
+
+  if(parser.numErrors != numErrors)
+    {
+      CMDPARSETEST_fail("%lu errors counted, expected %lu",(unsigned long)parser.numErrors,numErrors);
+    }
+
+  return;
+} // end of CMDPARSETEST_checkFixed() function
+
+
+//! \brief Writes the 24 digits of a random exact IQ24 step, 1e-24 below it
+//!        or followed by more digits, returns the number of digits written
+static int CMDPARSETEST_buildStep(char *p)
+{
+  const uint32_t s = CMDPARSETEST_rand();
+  uint32_t frac = CMDPARSETEST_rand() & 0x00FFFFFFUL;
+  int numFrac = 0;
+  int cnt;
+
+
+  // m / 2^24 ends at the 24th digit, the long division is exact
+  for(cnt=0;cnt<24;cnt++)
+    {
+      frac *= 10;
+      p[numFrac++] = (char)('0' + (frac >> 24));
+      frac &= 0x00FFFFFFUL;
+    }
+
+  if((s & 3) == 1)
+    {
+      // 1e-24 below the step, borrowing through the zeros
+      for(cnt=numFrac - 1;(cnt >= 0) && (p[cnt] == '0');cnt--)
+        {
+          p[cnt] = '9';
+        }
+
+      if(cnt >= 0)
+        {
+          p[cnt]--;
+        }
+    }
+  else if((s & 3) >= 2)
+    {
+      const int numMore = 1 + (int)((s >> 2) % 6);
+
+      for(cnt=0;cnt<numMore;cnt++)
+        {
+          p[numFrac++] = (char)('0' + CMDPARSETEST_rand() % 10);
+        }
+    }
+
+  return(numFrac);
+} // end of CMDPARSETEST_buildStep() function
+
+
+//! \brief Builds a random number, returns if it lands on an IQ24 step and if the integer part overflows
+static bool CMDPARSETEST_build(char *pText,bool *pFlag_overflow)
+{
+  const uint32_t r = CMDPARSETEST_rand();
+  const int numZeros = (int)(CMDPARSETEST_rand() % 7);
+  int numInt = (int)(CMDPARSETEST_rand() % 4);
+  int numFrac = (int)(CMDPARSETEST_rand() % 31);
+  bool flag_step = false;
+  unsigned long long integer = 0;
+  char *p = pText;
+  int cnt;
+
+
+  if((r & 3) == 1)
+    {
+      *p++ = '-';
+    }
+  else if((r & 3) == 2)
+    {
+      *p++ = '+';
+    }
+
+  for(cnt=0;cnt<numZeros;cnt++)
+    {
+      *p++ = '0';
+    }
+
+  // now and then an integer part that overflows
+  if(((r >> 2) & 15) == 0)
+    {
+      numInt = 3 + (int)(CMDPARSETEST_rand() % 10);
+    }
+
+  for(cnt=0;cnt<numInt;cnt++)
+    {
+      const int digit = (int)(CMDPARSETEST_rand() % 10);
+
+      *p++ = (char)('0' + digit);
+      integer = integer * 10 + (unsigned long long)digit;
+    }
+
+  // no point, a bare point, or fraction digits
+  if(((r >> 6) & 7) == 0)
+    {
+      numFrac = 0;
+    }
+  else
+    {
+      *p++ = '.';
+
+      if(((r >> 9) & 7) == 0)
+        {
+          p += CMDPARSETEST_buildStep(p);
+          numFrac = 0;
+          flag_step = true;
+        }
+    }
+
+  for(cnt=0;cnt<numFrac;cnt++)
+    {
+      // runs of zeros and nines find the carries
+      const uint32_t s = CMDPARSETEST_rand();
+      const int digit = ((s & 7) == 0) ? 0 : ((s & 7) == 1) ? 9 : (int)((s >> 3) % 10);
+
+      *p++ = (char)('0' + digit);
+    }
+
+  *p = '\0';
+  *pFlag_overflow = (integer > CMDPARSE_MAX_INT);
+
+  return(flag_step);
+} // end of CMDPARSETEST_build() function
+
+
+//! \brief Puts whitespace between the characters of a number
+static void CMDPARSETEST_spread(char *pOut,const char *pText)
+{
+  static const char blanks[4] = {' ', '\t', '\r', '\n'};
+
+
+  for(;*pText!='\0';pText++)
+    {
+      if(CMDPARSETEST_rand() & 1)
+        {
+          *pOut++ = blanks[CMDPARSETEST_rand() & 3];
+        }
+
+      *pOut++ = *pText;
+    }
+
+  *pOut = '\0';
+} // end of CMDPARSETEST_spread() function
+
+
+static void CMDPARSETEST_checkRandom(const unsigned long num)
+{
+  CMDPARSE_Obj parser;
+  unsigned long numOverflow = 0;
+  unsigned long numStep = 0;
+  unsigned long cnt;
+
+
+  CMDPARSE_init(&parser);
+
+  for(cnt=0;cnt<num;cnt++)
+    {
+      char text[CMDPARSETEST_MAX_LENGTH];
+      char spread[2 * CMDPARSETEST_MAX_LENGTH];
+      bool flag_overflow;
+      const bool flag_step = CMDPARSETEST_build(text,&flag_overflow);
+      const bool flag_digits = (strpbrk(text,"0123456789") != NULL);
+      const _iq expected = _atoIQ(text);
+      int32_t value;
+      int32_t spreadValue;
+      CMDPARSE_Status_e status = CMDPARSETEST_parse(&parser,text,&value);
+      CMDPARSE_Status_e spreadStatus;
+
+      CMDPARSETEST_spread(spread,text);
+      spreadStatus = CMDPARSETEST_parse(&parser,spread,&spreadValue);
+
+      if((spreadStatus != status) || (spreadValue != value))
+        {
+          CMDPARSETEST_fail("\"%s\" parsed with whitespace gave 0x%08lX, without 0x%08lX",text,
+                            (unsigned long)(uint32_t)spreadValue,(unsigned long)(uint32_t)value);
+        }
+
+      if(!flag_digits)
+        {
+          if((status != CMDPARSE_Status_Empty) || (value != CMDPARSETEST_UNTOUCHED))
+            {
+              CMDPARSETEST_fail("\"%s\": status %d, expected Empty",text,status);
+            }
+
+          continue;
+        }
+
+      if(status != (flag_overflow ? CMDPARSE_Status_Overflow : CMDPARSE_Status_Ok))
+        {
+          CMDPARSETEST_fail("\"%s\": status %d, expected %s",text,status,flag_overflow ? "Overflow" : "Ok");
+          continue;
+        }
+
+      numOverflow += flag_overflow;
+      numStep += (flag_step && !flag_overflow);
+
+      if(value != expected)
+        {
+          CMDPARSETEST_fail("\"%s\"%s: 0x%08lX, _atoIQ 0x%08lX",text,flag_overflow ? " overflow" : "",
+                            (unsigned long)(uint32_t)value,(unsigned long)(uint32_t)expected);
+        }
+    }
+
+  printf("random: %lu numbers, %lu overflowed, %lu on or next to an IQ24 step\n",num,numOverflow,numStep);
+
+  return;
+} // end of CMDPARSETEST_checkRandom() function
+
+
+static void CMDPARSETEST_usage(void)
+{
+  fprintf(stderr,"usage: cmdparsetest [-n num] [-s seed]\n");
+} // end of CMDPARSETEST_usage() function
+
+
+int main(int argc,char *argv[])
+{
+  unsigned long num = 2000000;
+  int opt;
+
+
+  while((opt = getopt(argc,argv,"n:s:")) != -1)
+    {
+      switch(opt)
+        {
+          case 'n': num = strtoul(optarg,NULL,10); break;
+          case 's': gSeed = strtoull(optarg,NULL,0) | 1; break;
+          default:  CMDPARSETEST_usage(); return(2);
+        }
+    }
+
+  if((optind != argc) || (num < 1))
+    {
+      CMDPARSETEST_usage();
+      return(2);
+    }
+
+  CMDPARSETEST_checkFixed();
+  CMDPARSETEST_checkRandom(num);
+
+  printf("checks: %lu failures\n",gNumFailures);
+
+  return((gNumFailures != 0) ? 1 : 0);
+} // end of main() function
+
+
+// end of file
@@ -0,0 +1,720 @@
+//! \file   cosim.cpp
+//! \brief  Contains the reaction wheel pendulum co-simulation
+//!
+
+
+// **************************************************************************
+// the includes
+
+#include <cmath>
+#include <queue>
+#include <vector>
+
+#include "cosim.h"
+#include "balance.h"
+#include "setpoint.h"
+#include "cmdlink.h"
+#include "focsim.h"
+#include "halsim.h"
+#include "user_j1.h"
+
+
+namespace cosim
+{
+
+
+// **************************************************************************
+// the defines
+
+//! \brief Defines the CPU clock, Hz
+//!
+#define COSIM_CPU_FREQ_Hz           (90.0e6)
+
+//! \brief Defines the PWM period, cycles
+//!
+#define COSIM_PWM_PERIOD_cnt        ((Cycles)(COSIM_CPU_FREQ_Hz / (USER_PWM_FREQ_kHz * 1000.0) + 0.5))
+
+//! \brief Defines the mainISR period, cycles
+//!
+#define COSIM_ISR_PERIOD_cnt        (COSIM_PWM_PERIOD_cnt * USER_NUM_PWM_TICKS_PER_ISR_TICK)
+
+//! \brief Defines mainISR ticks per millisecond
+//!
+#define COSIM_ISR_TICKS_PER_ms      ((unsigned long)(USER_PWM_FREQ_kHz / USER_NUM_PWM_TICKS_PER_ISR_TICK + 0.5))
+
+//! \brief Defines the SCI-B receive FIFO interrupt level, see HAL_setupSciB()
+//!
+#define COSIM_SCI_RX_FIFO_LEVEL     (4)
+
+//! \brief Defines the MPU-6050 gyro scale at the +-2000 dps range dmpInitialize() sets, counts per dps
+//!
+#define COSIM_GYRO_COUNTS_PER_dps   (16.4)
+
+//! \brief Defines the DMP quaternion scale, MotionApps 2.0
+//!
+#define COSIM_QUAT_SCALE            (16384.0f)
+
+
+// **************************************************************************
+// the typedefs
+
+//! \brief Enumeration for the event types
+//!
+enum EventType
+{
+  Event_MainIsr=0,               //!< F28069 mainISR
+  Event_PwmLoad,                 //!< the PWM compare shadow load after mainISR
+  Event_DmpSample,               //!< the DMP writes a packet and raises INT
+  Event_GyroRead,                //!< the Teensy has the packet and the gyro rate
+  Event_Send,                    //!< the Teensy writes the torque frame to Serial2
+  Event_RxByte,                  //!< a byte lands in the SCI-B receive FIFO
+  Event_SpeedRx                  //!< the Teensy has the speed reply, the argument is IQ24 krpm
+};
+
+
+//! \brief Defines a scheduled event
+//!
+struct Event
+{
+  Cycles     time;
+  uint64_t   order;
+  EventType  type;
+  int32_t    arg;
+};
+
+
+//! \brief Orders events by time, then by scheduling order
+//!
+struct EventLater
+{
+  bool operator()(const Event &a,const Event &b) const
+  {
+    return((a.time > b.time) || ((a.time == b.time) && (a.order > b.order)));
+  }
+};
+
+
+//! \brief Defines one recorded plant step, for the sensor delay
+//!
+struct History
+{
+  double  psi_rad;
+  double  psiDot_radps;
+};
+
+
+//! \brief Defines one co-simulation run
+//!
+class Simulation
+{
+public:
+  Simulation(const Config &config,FILE *pOut,const unsigned long decimation);
+
+  Result run(void);
+
+private:
+  void schedule(const Cycles time,const EventType type,const int32_t arg);
+  void dispatch(const Event &event);
+
+  // the F28069
+  void runMainIsr(const Cycles now);
+  void loadPwm(void);
+  void drainRxFifo(const Cycles now);
+  void postIqRef(const uint_least8_t seq,const _iq iqRef_A);
+  bool takeIqRef(const Cycles now,_iq *pIqRef_pu);
+
+  // the Teensy
+  void sampleDmp(const Cycles now);
+  void readGyro(const Cycles now);
+  void sendCommand(const Cycles now);
+
+  const History &getDelayed(const Cycles now) const;
+  double getNoise(void);
+  Cycles toCycles(const double sec) const;
+
+  const Config  &m_config;
+  FILE          *m_pOut;
+  unsigned long m_decimation;
+
+  std::priority_queue<Event,std::vector<Event>,EventLater> m_events;
+  uint64_t      m_order;
+
+  // the plant
+  PlantState    m_state;
+  Cycles        m_step_cnt;
+  uint64_t      m_stepIndex;
+  std::vector<History> m_history;
+  Cycles        m_sensorDelay_cnt;
+  double        m_Vabc_V[HALSIM_NUM_SENSORS];
+
+  // the F28069
+  HALSIM_Obj    m_hal;
+  FOCSIM_Obj    m_foc;
+  uint16_t      m_cmpA[HALSIM_NUM_SENSORS];
+  CMDLINK_Decoder_t m_decoder;
+  uint_least8_t m_rxFifo[16];
+  unsigned int  m_rxLevel;
+  unsigned int  m_rxLastLevel;
+  _iq           m_IqRef_A;
+  _iq           m_applyIqRef_pu[2];
+  Cycles        m_applySample[2];
+  unsigned int  m_applyIndex;
+  bool          m_flag_applyNew;
+  unsigned long m_numTicks;
+
+  // the Teensy
+  rwp::Balance<float> m_balance;
+  rwp::SetpointEstimator<float> m_setpointEst;
+  rwp::DmpSample m_dmpPacket;
+  Cycles        m_dmpSample;
+  double        m_rolldeg;
+  double        m_packetRate_radps;
+  double        m_motorOutput;
+  uint_least8_t m_cmdSeq;
+  Cycles        m_sampleStamp[256];
+  Cycles        m_lineFree;
+  uint64_t      m_seed;
+
+  // the measurements
+  Result        m_result;
+  double        m_errorSum;
+  double        m_iqSum;
+  double        m_latencySum;
+};
+
+
+// **************************************************************************
+// the functions
+
+void setDefaultConfig(Config *pConfig)
+{
+  setDefaultParams(&pConfig->plant);
+
+  pConfig->run_sec = 5.0;
+  pConfig->numSubSteps = 4;
+  pConfig->dcBus_V = USER_IQ_FULL_SCALE_VOLTAGE_V;
+  pConfig->initialAngle_deg = 1.0;
+  pConfig->kick_Nm = 0.0;
+  pConfig->kickStart_sec = 1.0;
+  pConfig->kickLength_sec = 0.02;
+  pConfig->fall_deg = 30.0;
+
+  // the rwp-1 gains push the pendulum the way the roll reading points
+  // when the IMU roll axis is against the motor axis
+  pConfig->imuSign = -1.0;
+  pConfig->imuOffset_deg = 2.25;
+  pConfig->dmpRate_Hz = 100.0;
+  pConfig->dmpPhase_us = 0.0;
+  pConfig->sensorDelay_us = 4800.0;
+  pConfig->i2cClock_Hz = 100000.0;
+  pConfig->imuReadBytes = 5 + 45;
+  pConfig->gyroReadBytes = 0;
+  pConfig->compute_us = 50.0;
+  pConfig->gyroNoise_dps = 0.05;
+  pConfig->seed = 1;
+
+  pConfig->kp = 18.0;
+  pConfig->kd = -9.0;
+  pConfig->kw = 0.0;
+  pConfig->ki = 0.0;
+  pConfig->integralLimit_degs = 5.0;
+  pConfig->setpoint_deg = 2.25;
+  pConfig->range_A = 20.0;
+  pConfig->deadband_A = 0.0;
+  pConfig->overtravel_deg = 5.0;
+  pConfig->flag_autoSetpoint = false;
+
+  pConfig->baud = 115200.0;
+
+  pConfig->Kp_pu = -1.0;
+  pConfig->Ki_pu = -1.0;
+
+  return;
+} // end of setDefaultConfig() function
+
+
+Simulation::Simulation(const Config &config,FILE *pOut,const unsigned long decimation)
+  : m_config(config), m_pOut(pOut), m_decimation(decimation), m_order(0),
+    m_setpointEst((float)config.setpoint_deg)
+{
+  uint64_t historyLength = 1;
+  unsigned int cnt;
+
+
+  m_step_cnt = COSIM_PWM_PERIOD_cnt / config.numSubSteps;
+  m_stepIndex = 0;
+  m_sensorDelay_cnt = toCycles(config.sensorDelay_us * 1.0e-6);
+
+  while(historyLength < (uint64_t)(m_sensorDelay_cnt / m_step_cnt + 2))
+    {
+      historyLength <<= 1;
+    }
+
+  m_state.psi_rad = config.imuSign * config.initialAngle_deg * M_PI / 180.0;
+  m_state.psiDot_radps = 0.0;
+  m_state.wheelSpeed_radps = 0.0;
+  m_state.rotorAngle_rad = 0.0;
+  m_state.id_A = 0.0;
+  m_state.iq_A = 0.0;
+
+  // the sensors have seen the initial state forever
+  History initial = {m_state.psi_rad, m_state.psiDot_radps};
+  m_history.assign(historyLength,initial);
+
+  HALSIM_init(&m_hal);
+  FOCSIM_init(&m_foc);
+  if(config.Kp_pu >= 0.0)
+    {
+      FOCSIM_setGains(&m_foc,_IQ(config.Kp_pu),m_foc.pidIq.Ki);
+    }
+  if(config.Ki_pu >= 0.0)
+    {
+      FOCSIM_setGains(&m_foc,m_foc.pidIq.Kp,_IQ(config.Ki_pu));
+    }
+
+  for(cnt=0;cnt<HALSIM_NUM_SENSORS;cnt++)
+    {
+      m_cmpA[cnt] = m_hal.cmpA[cnt];
+    }
+  HALSIM_getPoleVoltages(&m_hal,config.dcBus_V,m_Vabc_V);
+
+  CMDLINK_initDecoder(&m_decoder);
+  m_rxLevel = 0;
+  m_rxLastLevel = 0;
+  m_IqRef_A = _IQ(0.0);
+  m_applyIqRef_pu[0] = m_applyIqRef_pu[1] = _IQ(0.0);
+  m_applySample[0] = m_applySample[1] = 0;
+  m_applyIndex = 0;
+  m_flag_applyNew = false;
+  m_numTicks = 0;
+
+  // the rwp-1 core, in the float it runs in on the Teensy
+  rwp::Balance<float>::Params &params = m_balance.getParams();
+  params.kp = (float)config.kp;
+  params.kd = (float)config.kd;
+  params.kw = (float)config.kw;
+  params.ki = (float)config.ki;
+  params.integralLimit_degs = (float)config.integralLimit_degs;
+  params.period_sec = (float)(1.0 / config.dmpRate_Hz);
+  params.setpoint_deg = (float)config.setpoint_deg;
+  params.range_A = (float)config.range_A;
+  params.deadband_A = (float)config.deadband_A;
+  params.overtravel_deg = (float)config.overtravel_deg;
+
+  m_setpointEst.getParams().period_sec = params.period_sec;
+  m_setpointEst.reset(params.setpoint_deg);
+
+  m_dmpSample = 0;
+  m_rolldeg = 0.0;
+  m_packetRate_radps = 0.0;
+  m_motorOutput = 0.0;
+  m_cmdSeq = 0;
+  for(cnt=0;cnt<256;cnt++)
+    {
+      m_sampleStamp[cnt] = 0;
+    }
+  m_lineFree = 0;
+  m_seed = 0x9E3779B97F4A7C15ULL ^ ((uint64_t)config.seed << 1 | 1);
+
+  m_result.flag_fallen = false;
+  m_result.fall_sec = 0.0;
+  m_result.rmsError_deg = 0.0;
+  m_result.maxError_deg = 0.0;
+  m_result.rmsIq_A = 0.0;
+  m_result.maxIq_A = 0.0;
+  m_result.maxWheelSpeed_rpm = 0.0;
+  m_result.meanLatency_us = 0.0;
+  m_result.maxLatency_us = 0.0;
+  m_result.numCommands = 0;
+  m_result.numTicks = 0;
+  m_result.finalSetpoint_deg = config.setpoint_deg;
+  m_result.numSetpointWindows = 0;
+  m_errorSum = 0.0;
+  m_iqSum = 0.0;
+  m_latencySum = 0.0;
+} // end of Simulation::Simulation() function
+
+
+Cycles Simulation::toCycles(const double sec) const
+{
+  return((Cycles)std::floor(sec * COSIM_CPU_FREQ_Hz + 0.5));
+} // end of Simulation::toCycles() function
+
+
+void Simulation::schedule(const Cycles time,const EventType type,const int32_t arg)
+{
+  Event event = {time, m_order++, type, arg};
+
+  m_events.push(event);
+
+  return;
+} // end of Simulation::schedule() function
+
+
+double Simulation::getNoise(void)
+{
+  // xorshift64* and Box-Muller, the same sequence on every host
+  double u[2];
+  unsigned int cnt;
+
+  for(cnt=0;cnt<2;cnt++)
+    {
+      m_seed ^= m_seed >> 12;
+      m_seed ^= m_seed << 25;
+      m_seed ^= m_seed >> 27;
+      u[cnt] = ((double)((m_seed * 0x2545F4914F6CDD1DULL) >> 11) + 0.5) / 9007199254740992.0;
+    }
+
+  return(std::sqrt(-2.0 * std::log(u[0])) * std::cos(2.0 * M_PI * u[1]));
+} // end of Simulation::getNoise() function
+
+
+const History &Simulation::getDelayed(const Cycles now) const
+{
+  Cycles delayed = now - m_sensorDelay_cnt;
+  uint64_t index = (delayed <= 0) ? 0 : (uint64_t)(delayed / m_step_cnt);
+
+  // before the first step the history holds only the initial state
+  if(index + m_history.size() <= m_stepIndex)
+    {
+      index = m_stepIndex - m_history.size() + 1;
+    }
+
+  return(m_history[index & (m_history.size() - 1)]);
+} // end of Simulation::getDelayed() function
+
+
+void Simulation::dispatch(const Event &event)
+{
+  switch(event.type)
+    {
+      case Event_MainIsr:
+        runMainIsr(event.time);
+        schedule(event.time + COSIM_ISR_PERIOD_cnt,Event_MainIsr,0);
+        break;
+
+      case Event_PwmLoad:
+        loadPwm();
+        break;
+
+      case Event_DmpSample:
+        sampleDmp(event.time);
+        schedule(event.time + toCycles(1.0 / m_config.dmpRate_Hz),Event_DmpSample,0);
+        break;
+
+      case Event_GyroRead:
+        readGyro(event.time);
+        break;
+
+      case Event_Send:
+        sendCommand(event.time);
+        break;
+
+      case Event_RxByte:
+        m_rxFifo[m_rxLevel++] = (uint_least8_t)event.arg;
+        if(m_rxLevel >= COSIM_SCI_RX_FIFO_LEVEL)
+          {
+            drainRxFifo(event.time);
+          }
+        break;
+
+      case Event_SpeedRx:
+        m_balance.setWheelSpeed_krpm(rwp::Balance<float>::fromPayload(event.arg));
+        break;
+    }
+
+  return;
+} // end of Simulation::dispatch() function
+
+
+void Simulation::postIqRef(const uint_least8_t seq,const _iq iqRef_A)
+{
+  unsigned int index = m_applyIndex ^ 1;
+
+
+  m_applyIqRef_pu[index] = _IQmpy(iqRef_A,_IQ(1.0 / USER_IQ_FULL_SCALE_CURRENT_A));
+  m_applySample[index] = m_sampleStamp[seq & 0xFF];
+  m_applyIndex = index;
+  m_flag_applyNew = true;
+
+  return;
+} // end of Simulation::postIqRef() function
+
+
+bool Simulation::takeIqRef(const Cycles now,_iq *pIqRef_pu)
+{
+  double latency_us;
+
+
+  if(!m_flag_applyNew)
+    {
+      return(false);
+    }
+
+  m_flag_applyNew = false;
+  *pIqRef_pu = m_applyIqRef_pu[m_applyIndex];
+
+  latency_us = (double)(now - m_applySample[m_applyIndex]) * 1.0e6 / COSIM_CPU_FREQ_Hz;
+  m_latencySum += latency_us;
+  if(latency_us > m_result.maxLatency_us)
+    {
+      m_result.maxLatency_us = latency_us;
+    }
+  m_result.numCommands++;
+
+  return(true);
+} // end of Simulation::takeIqRef() function
+
+
+void Simulation::drainRxFifo(const Cycles now)
+{
+  const double frame_sec = (double)CMDLINK_FRAME_LENGTH * 10.0 / m_config.baud;
+  unsigned int cnt;
+
+
+  for(cnt=0;cnt<m_rxLevel;cnt++)
+    {
+      CMDLINK_Frame_t frame;
+
+      // the sequence number only carries the sample stamp for the latency
+      if(CMDLINK_decode(&m_decoder,m_rxFifo[cnt],&frame) && (frame.type == CMDLINK_Type_Torque))
+        {
+          const double speed_krpm = (m_state.wheelSpeed_radps - m_state.psiDot_radps) * 60.0 / (2.0 * M_PI * 1000.0);
+
+          m_IqRef_A = _IQ24toIQ(frame.payload);
+          postIqRef(frame.seq,m_IqRef_A);
+
+          // serviceSpeedReply() answers with the speed at the command, one frame back
+          schedule(now + toCycles(frame_sec),Event_SpeedRx,(int32_t)std::floor(speed_krpm * 16777216.0 + 0.5));
+        }
+    }
+
+  m_rxLevel = 0;
+  m_rxLastLevel = 0;
+
+  return;
+} // end of Simulation::drainRxFifo() function
+
+
+void Simulation::runMainIsr(const Cycles now)
+{
+  HALSIM_AdcData_t adcData;
+  double Iabc_A[HALSIM_NUM_SENSORS];
+  _iq iqRef_pu;
+
+
+  // the partial RX FIFO flush once a millisecond
+  if((m_numTicks % COSIM_ISR_TICKS_PER_ms) == 0)
+    {
+      if((m_rxLevel != 0) && (m_rxLevel == m_rxLastLevel))
+        {
+          drainRxFifo(now);
+        }
+
+      m_rxLastLevel = m_rxLevel;
+    }
+
+  if(takeIqRef(now,&iqRef_pu))
+    {
+      m_foc.Iq_ref_pu = iqRef_pu;
+    }
+
+  getIabc(m_config.plant,m_state,Iabc_A);
+  HALSIM_convertAdc(&m_hal,Iabc_A,m_Vabc_V,m_config.dcBus_V);
+  HALSIM_readAdcData(&m_hal,&adcData);
+  FOCSIM_run(&m_foc,&adcData,_IQ(getElecAngle(m_config.plant,m_state) / (2.0 * M_PI)));
+  HALSIM_writePwmData(&m_hal,m_foc.Tabc);
+
+  // the compares take effect at the next PWM period
+  schedule(now + COSIM_PWM_PERIOD_cnt,Event_PwmLoad,0);
+
+  {
+    double lean_deg = m_state.psi_rad * 180.0 / M_PI;
+    double speed_rpm = std::fabs(m_state.wheelSpeed_radps - m_state.psiDot_radps) * 60.0 / (2.0 * M_PI);
+
+    m_errorSum += lean_deg * lean_deg;
+    m_iqSum += m_state.iq_A * m_state.iq_A;
+    if(std::fabs(lean_deg) > m_result.maxError_deg)
+      {
+        m_result.maxError_deg = std::fabs(lean_deg);
+      }
+    if(std::fabs(m_state.iq_A) > m_result.maxIq_A)
+      {
+        m_result.maxIq_A = std::fabs(m_state.iq_A);
+      }
+    if(speed_rpm > m_result.maxWheelSpeed_rpm)
+      {
+        m_result.maxWheelSpeed_rpm = speed_rpm;
+      }
+
+    if((m_pOut != NULL) && ((m_numTicks % m_decimation) == 0))
+      {
+        fprintf(m_pOut,"%.5f,%.4f,%.4f,%.3f,%.4f,%.4f,%.4f,%.2f\n",
+                (double)now / COSIM_CPU_FREQ_Hz,lean_deg,m_rolldeg,
+                m_state.psiDot_radps * 180.0 / M_PI,m_motorOutput,
+                _IQtoD(m_foc.Iq_ref_pu) * USER_IQ_FULL_SCALE_CURRENT_A,m_state.iq_A,
+                (m_state.wheelSpeed_radps - m_state.psiDot_radps) * 60.0 / (2.0 * M_PI));
+      }
+  }
+
+  m_numTicks++;
+
+  return;
+} // end of Simulation::runMainIsr() function
+
+
+void Simulation::loadPwm(void)
+{
+  HALSIM_getPoleVoltages(&m_hal,m_config.dcBus_V,m_Vabc_V);
+
+  return;
+} // end of Simulation::loadPwm() function
+
+
+void Simulation::sampleDmp(const Cycles now)
+{
+  const History &sample = getDelayed(now);
+  double roll_rad = m_config.imuSign * sample.psi_rad + m_config.imuOffset_deg * M_PI / 180.0;
+
+  // the DMP quaternion for a pure roll, in its 16 bit format
+  m_dmpPacket.quat[0] = (int16_t)std::floor(std::cos(0.5 * roll_rad) * COSIM_QUAT_SCALE + 0.5);
+  m_dmpPacket.quat[1] = (int16_t)std::floor(std::sin(0.5 * roll_rad) * COSIM_QUAT_SCALE + 0.5);
+  m_dmpPacket.quat[2] = 0;
+  m_dmpPacket.quat[3] = 0;
+
+  m_dmpSample = now;
+  m_rolldeg = rwp::Balance<float>::getRoll_deg(m_dmpPacket.quat);
+  m_packetRate_radps = sample.psiDot_radps;
+
+  // the FIFO reads, then getRotationX() if the rate is not taken from the packet
+  schedule(now + toCycles((double)(m_config.imuReadBytes + m_config.gyroReadBytes) * 9.0 / m_config.i2cClock_Hz),
+           Event_GyroRead,0);
+
+  return;
+} // end of Simulation::sampleDmp() function
+
+
+void Simulation::readGyro(const Cycles now)
+{
+  double rate_radps = (m_config.gyroReadBytes == 0) ? m_packetRate_radps : getDelayed(now).psiDot_radps;
+  double rate_counts = m_config.imuSign * rate_radps * 180.0 / M_PI * COSIM_GYRO_COUNTS_PER_dps +
+                       m_config.gyroNoise_dps * COSIM_GYRO_COUNTS_PER_dps * getNoise();
+
+
+  rate_counts = std::floor(rate_counts + 0.5);
+  m_dmpPacket.gyroX = (int16_t)((rate_counts > 32767.0) ? 32767.0 : ((rate_counts < -32768.0) ? -32768.0 : rate_counts));
+
+  // loop() from here to the Serial2 write, on the rwp-1 core itself
+  m_motorOutput = m_balance.step(m_dmpPacket);
+
+  if(m_config.flag_autoSetpoint)
+    {
+      m_balance.getParams().setpoint_deg = m_setpointEst.step(m_balance.getState(),m_balance.getParams().range_A);
+    }
+
+  schedule(now + toCycles(m_config.compute_us * 1.0e-6),Event_Send,0);
+
+  return;
+} // end of Simulation::readGyro() function
+
+
+void Simulation::sendCommand(const Cycles now)
+{
+  CMDLINK_Frame_t frame;
+  uint_least8_t buf[CMDLINK_FRAME_LENGTH];
+  const double byte_sec = 10.0 / m_config.baud;
+  Cycles start = (now > m_lineFree) ? now : m_lineFree;
+  unsigned int cnt;
+
+
+  frame.seq = m_cmdSeq++ & 0xFF;
+  frame.type = CMDLINK_Type_Torque;
+  frame.payload = rwp::Balance<float>::toPayload((float)m_motorOutput);
+  CMDLINK_encode(buf,&frame);
+  m_sampleStamp[frame.seq] = m_dmpSample;
+
+  for(cnt=0;cnt<CMDLINK_FRAME_LENGTH;cnt++)
+    {
+      schedule(start + toCycles((double)(cnt + 1) * byte_sec),Event_RxByte,buf[cnt] & 0xFF);
+    }
+
+  m_lineFree = start + toCycles((double)CMDLINK_FRAME_LENGTH * byte_sec);
+
+  return;
+} // end of Simulation::sendCommand() function
+
+
+Result Simulation::run(void)
+{
+  const Cycles end = toCycles(m_config.run_sec);
+  const Cycles kickStart = toCycles(m_config.kickStart_sec);
+  const Cycles kickEnd = kickStart + toCycles(m_config.kickLength_sec);
+  const double dt_sec = (double)m_step_cnt / COSIM_CPU_FREQ_Hz;
+  const double fall_rad = m_config.fall_deg * M_PI / 180.0;
+  Cycles now;
+
+
+  if(m_pOut != NULL)
+    {
+      fprintf(m_pOut,"time_s,lean_deg,roll_deg,leanRate_dps,cmd_A,IqRef_A,Iq_A,wheel_rpm\n");
+    }
+
+  schedule(0,Event_MainIsr,0);
+  schedule(toCycles(m_config.dmpPhase_us * 1.0e-6),Event_DmpSample,0);
+
+  for(now=0;now<end;now+=m_step_cnt)
+    {
+      History &entry = m_history[m_stepIndex & (m_history.size() - 1)];
+      double external_Nm = ((now >= kickStart) && (now < kickEnd)) ? m_config.kick_Nm : 0.0;
+
+      while(!m_events.empty() && (m_events.top().time <= now))
+        {
+          Event event = m_events.top();
+
+          m_events.pop();
+          dispatch(event);
+        }
+
+      entry.psi_rad = m_state.psi_rad;
+      entry.psiDot_radps = m_state.psiDot_radps;
+      m_stepIndex++;
+
+      step(m_config.plant,&m_state,m_Vabc_V,external_Nm,dt_sec);
+
+      if(std::fabs(m_state.psi_rad) > fall_rad)
+        {
+          m_result.flag_fallen = true;
+          m_result.fall_sec = (double)(now + m_step_cnt) / COSIM_CPU_FREQ_Hz;
+          break;
+        }
+    }
+
+  m_result.numTicks = m_numTicks;
+  m_result.finalSetpoint_deg = m_balance.getParams().setpoint_deg;
+  m_result.numSetpointWindows = m_setpointEst.getState().numWindows;
+  if(m_numTicks != 0)
+    {
+      m_result.rmsError_deg = std::sqrt(m_errorSum / (double)m_numTicks);
+      m_result.rmsIq_A = std::sqrt(m_iqSum / (double)m_numTicks);
+    }
+  if(m_result.numCommands != 0)
+    {
+      m_result.meanLatency_us = m_latencySum / (double)m_result.numCommands;
+    }
+
+  return(m_result);
+} // end of Simulation::run() function
+
+
+Result run(const Config &config,FILE *pOut,const unsigned long decimation)
+{
+  Simulation simulation(config,pOut,decimation);
+
+  return(simulation.run());
+} // end of run() function
+
+
+} // end of cosim namespace
+
+
+// end of file
@@ -0,0 +1,139 @@
+#ifndef _COSIM_H_
+#define _COSIM_H_
+
+//! \file   cosim.h
+//! \brief  Contains the public interface to the reaction wheel pendulum
+//!         co-simulation
+//!
+//!         Two firmware tasks run against the plant of plant.h:
+//!
+//!           - the rwp-1 loop(): the DMP packet, the gyro read, the balance
+//!             law with its clamp, deadband and overtravel cut, run by the
+//!             sketch's own core of rwp-1/balance.h, optionally the balance
+//!             point estimator of rwp-1/setpoint.h, and the torque frame
+//!             written to Serial2
+//!           - the proj_lab05a side: the SCI-B receive path decoding frames
+//!             with cmdlink.c, postIqRef()/takeIqRef(), and mainISR running
+//!             the current loop of hostsim/focsim.h through the HAL stub
+//!
+//!         Time is counted in 90 MHz CPU cycles so the PWM, ISR and DMP
+//!         periods are exact integers.  The plant advances in fixed RK4 steps
+//!         of a fraction of the PWM period.  Events (ISR ticks, PWM shadow
+//!         loads, DMP samples, I2C reads, serial bytes) run in time order at
+//!         the first plant step at or after their time, ties in the order
+//!         they were scheduled, so a run is fully determined by its Config.
+//!
+//!         The sensor side models the DMP sample rate, the filter delay of
+//!         the gyro and the DMP, the 16 bit quaternion and gyro quantization,
+//!         the I2C transfer times at the bus clock, and gyro noise from a
+//!         seeded generator.  The link carries the 8 byte frames at the baud
+//!         rate, one byte per start + 8 data + stop bits, with the IQ24
+//!         truncation of the payload.  Each torque frame is answered with the
+//!         motor speed, which reaches the law one frame time later.
+
+
+// **************************************************************************
+// the includes
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "plant.h"
+
+
+namespace cosim
+{
+
+
+// **************************************************************************
+// the typedefs
+
+//! \brief Defines the simulated time, 90 MHz CPU cycles
+//!
+typedef int64_t Cycles;
+
+
+//! \brief Defines the run settings
+//!
+struct Config
+{
+  PlantParams  plant;            //!< the plant
+
+  double   run_sec;              //!< the simulated time
+  int      numSubSteps;          //!< plant steps per PWM period, must divide the period in cycles
+  double   dcBus_V;              //!< the DC bus voltage
+  double   initialAngle_deg;     //!< the initial lean away from balance
+  double   kick_Nm;              //!< a disturbance torque on the pendulum
+  double   kickStart_sec;        //!< the disturbance start
+  double   kickLength_sec;       //!< the disturbance length
+  double   fall_deg;             //!< the lean at which the pendulum counts as fallen
+
+  double   imuSign;              //!< the IMU roll direction against the motor axis, +1 or -1
+  double   imuOffset_deg;        //!< the IMU roll reading at balance
+  double   dmpRate_Hz;           //!< the DMP FIFO rate
+  double   dmpPhase_us;          //!< the first DMP sample
+  double   sensorDelay_us;       //!< the delay of the DMP and gyro low pass filters
+  double   i2cClock_Hz;          //!< the I2C bus clock
+  int      imuReadBytes;         //!< the I2C bytes from the interrupt to the FIFO packet, addressing included
+  int      gyroReadBytes;        //!< the I2C bytes of getRotationX(), addressing included, 0 takes the rate from the DMP packet
+  double   compute_us;           //!< the Teensy time from the gyro read to the Serial2 write
+  double   gyroNoise_dps;        //!< the RMS gyro noise
+  uint32_t seed;                 //!< the noise seed
+
+  double   kp;                   //!< the rwp-1 proportional gain, A per degree
+  double   kd;                   //!< the rwp-1 derivative gain, A per gyro count / 100
+  double   kw;                   //!< the rwp-1 wheel speed gain, A per krpm
+  double   ki;                   //!< the rwp-1 integral gain, A per degree second
+  double   integralLimit_degs;   //!< the rwp-1 error integral clamp
+  double   setpoint_deg;         //!< the rwp-1 setpoint
+  double   range_A;              //!< the rwp-1 command clamp
+  double   deadband_A;           //!< the rwp-1 deadband
+  double   overtravel_deg;       //!< the rwp-1 cut-off lean
+  bool     flag_autoSetpoint;    //!< true runs the rwp-1 balance point estimator, setpoint.h
+
+  double   baud;                 //!< the Serial2 / SCI-B baud rate
+
+  double   Kp_pu;                //!< the current loop proportional gain, negative keeps the default
+  double   Ki_pu;                //!< the current loop integral gain, negative keeps the default
+};
+
+
+//! \brief Defines the run measurements
+//!
+struct Result
+{
+  bool     flag_fallen;          //!< true if the lean passed fall_deg
+  double   fall_sec;             //!< the time of the fall
+  double   rmsError_deg;         //!< the RMS lean from balance
+  double   maxError_deg;         //!< the largest lean from balance
+  double   rmsIq_A;              //!< the RMS motor current
+  double   maxIq_A;              //!< the largest motor current
+  double   maxWheelSpeed_rpm;    //!< the largest wheel speed relative to the pendulum
+  double   meanLatency_us;       //!< the mean time from the DMP sample to takeIqRef()
+  double   maxLatency_us;        //!< the longest time from the DMP sample to takeIqRef()
+  unsigned long numCommands;     //!< the torque frames applied
+  unsigned long numTicks;        //!< the mainISR ticks run
+  double   finalSetpoint_deg;    //!< the rwp-1 setpoint at the end
+  unsigned long numSetpointWindows;  //!< the balance point estimator windows run
+};
+
+
+// **************************************************************************
+// the function prototypes
+
+//! \brief      Sets the defaults: the user_j1.h motor, the rwp-1 gains and a 115200 link
+//! \param[out] pConfig  A pointer to the settings
+void setDefaultConfig(Config *pConfig);
+
+
+//! \brief     Runs one co-simulation, reentrant so runs can go in parallel
+//! \param[in] config      The settings
+//! \param[in] pOut        The CSV output, NULL for none
+//! \param[in] decimation  The mainISR ticks per CSV row
+//! \return    The measurements
+Result run(const Config &config,FILE *pOut,const unsigned long decimation);
+
+
+} // end of cosim namespace
+
+#endif // end of _COSIM_H_ definition
@@ -0,0 +1,670 @@
+//! \file   lqr.cpp
+//! \brief  Contains the full state balance gain design
+//!
+
+
+// **************************************************************************
+// the includes
+
+#include <cmath>
+#include <deque>
+#include <vector>
+
+#include "lqr.h"
+
+
+namespace cosim
+{
+
+
+// **************************************************************************
+// the defines
+
+//! \brief Defines the number of model states: psi, psi', motor speed
+//!
+#define LQR_NUM_STATES              (3)
+
+//! \brief Defines the simulation steps per control period
+//!
+#define LQR_SUB_STEPS               (100)
+
+//! \brief Defines the Riccati recursion limit
+//!
+#define LQR_MAX_ITERATIONS          (200000)
+
+//! \brief Defines the Riccati convergence tolerance, relative
+//!
+#define LQR_TOLERANCE               (1.0e-12)
+
+//! \brief Defines the squarings for the spectral radius, the power is 2^this
+//!
+#define LQR_NUM_SQUARINGS           (40)
+
+//! \brief Defines krpm per rad/s
+//!
+#define LQR_KRPM_PER_RADPS          (60.0 / (2.0 * M_PI * 1000.0))
+
+
+// **************************************************************************
+// the typedefs
+
+//! \brief Defines a small dense matrix, row major
+//!
+class Matrix
+{
+public:
+  Matrix(const size_t numRows,const size_t numCols)
+    : m_numRows(numRows), m_numCols(numCols), m_data(numRows * numCols,0.0)
+  {
+  }
+
+  static Matrix identity(const size_t size)
+  {
+    Matrix result(size,size);
+    size_t cnt;
+
+    for(cnt=0;cnt<size;cnt++)
+      {
+        result(cnt,cnt) = 1.0;
+      }
+
+    return(result);
+  }
+
+  double &operator()(const size_t row,const size_t col) { return(m_data[row * m_numCols + col]); }
+  double operator()(const size_t row,const size_t col) const { return(m_data[row * m_numCols + col]); }
+
+  size_t getNumRows(void) const { return(m_numRows); }
+  size_t getNumCols(void) const { return(m_numCols); }
+
+  Matrix operator*(const Matrix &b) const
+  {
+    Matrix result(m_numRows,b.m_numCols);
+    size_t row, col, cnt;
+
+    for(row=0;row<m_numRows;row++)
+      {
+        for(cnt=0;cnt<m_numCols;cnt++)
+          {
+            const double a = (*this)(row,cnt);
+
+            for(col=0;col<b.m_numCols;col++)
+              {
+                result(row,col) += a * b(cnt,col);
+              }
+          }
+      }
+
+    return(result);
+  }
+
+  Matrix operator+(const Matrix &b) const
+  {
+    Matrix result(*this);
+    size_t cnt;
+
+    for(cnt=0;cnt<m_data.size();cnt++)
+      {
+        result.m_data[cnt] += b.m_data[cnt];
+      }
+
+    return(result);
+  }
+
+  Matrix operator-(const Matrix &b) const
+  {
+    Matrix result(*this);
+    size_t cnt;
+
+    for(cnt=0;cnt<m_data.size();cnt++)
+      {
+        result.m_data[cnt] -= b.m_data[cnt];
+      }
+
+    return(result);
+  }
+
+  Matrix scale(const double factor) const
+  {
+    Matrix result(*this);
+    size_t cnt;
+
+    for(cnt=0;cnt<m_data.size();cnt++)
+      {
+        result.m_data[cnt] *= factor;
+      }
+
+    return(result);
+  }
+
+  Matrix transpose(void) const
+  {
+    Matrix result(m_numCols,m_numRows);
+    size_t row, col;
+
+    for(row=0;row<m_numRows;row++)
+      {
+        for(col=0;col<m_numCols;col++)
+          {
+            result(col,row) = (*this)(row,col);
+          }
+      }
+
+    return(result);
+  }
+
+  //! \brief Returns the largest absolute row sum
+  double getNorm(void) const
+  {
+    double norm = 0.0;
+    size_t row, col;
+
+    for(row=0;row<m_numRows;row++)
+      {
+        double sum = 0.0;
+
+        for(col=0;col<m_numCols;col++)
+          {
+            sum += std::fabs((*this)(row,col));
+          }
+
+        norm = (sum > norm) ? sum : norm;
+      }
+
+    return(norm);
+  }
+
+  //! \brief Returns the inverse, Gauss-Jordan with partial pivoting
+  Matrix inverse(void) const
+  {
+    Matrix a(*this);
+    Matrix result = identity(m_numRows);
+    size_t row, col, cnt;
+
+    for(col=0;col<m_numRows;col++)
+      {
+        size_t pivot = col;
+
+        for(row=col+1;row<m_numRows;row++)
+          {
+            if(std::fabs(a(row,col)) > std::fabs(a(pivot,col)))
+              {
+                pivot = row;
+              }
+          }
+
+        for(cnt=0;cnt<m_numRows;cnt++)
+          {
+            std::swap(a(col,cnt),a(pivot,cnt));
+            std::swap(result(col,cnt),result(pivot,cnt));
+          }
+
+        const double factor = 1.0 / a(col,col);
+
+        for(cnt=0;cnt<m_numRows;cnt++)
+          {
+            a(col,cnt) *= factor;
+            result(col,cnt) *= factor;
+          }
+
+        for(row=0;row<m_numRows;row++)
+          {
+            const double f = a(row,col);
+
+            if((row == col) || (f == 0.0))
+              {
+                continue;
+              }
+
+            for(cnt=0;cnt<m_numRows;cnt++)
+              {
+                a(row,cnt) -= f * a(col,cnt);
+                result(row,cnt) -= f * result(col,cnt);
+              }
+          }
+      }
+
+    return(result);
+  }
+
+private:
+  size_t  m_numRows;
+  size_t  m_numCols;
+  std::vector<double> m_data;
+};
+
+
+//! \brief Defines the plant discretized over one interval
+//!
+struct Discrete
+{
+  Matrix  phi;                   //!< the state transition
+  Matrix  gamma;                 //!< the held input response
+
+  Discrete(void) : phi(3,3), gamma(3,1) {}
+};
+
+
+// **************************************************************************
+// the functions
+
+void setDefaultLoop(LqrLoop *pLoop)
+{
+  pLoop->period_sec = 0.01;
+  pLoop->delay_sec = 10.1e-3;
+  pLoop->imuSign = -1.0;
+  pLoop->gyroCounts_per_dps = 16.4;
+  pLoop->range_A = 20.0;
+
+  return;
+} // end of setDefaultLoop() function
+
+
+void setDefaultWeights(LqrWeights *pWeights)
+{
+  pWeights->tilt_deg = 0.5;
+  pWeights->rate_dps = 20.0;
+  pWeights->wheel_krpm = 1.0;
+  pWeights->integral_degs = 0.0;
+  pWeights->iq_A = 10.0;
+
+  return;
+} // end of setDefaultWeights() function
+
+
+//! \brief Linearizes the plant about upright, states psi, psi', motor speed
+static void getContinuous(const PlantParams &plant,Matrix *pA,Matrix *pB)
+{
+  const double mgl = plant.mass_kg * plant.gravity_mps2 * plant.comLength_m;
+  const double Kt = 1.5 * plant.motor.numPolePairs * plant.motor.flux_Wb;
+  const double B = plant.motor.B_Nmps;
+  const double Jp = plant.Jp_kgm2;
+  const double Jw = plant.Jw_kgm2;
+
+  // Jp psi'' = mgl psi - (Kt iq - B w), Jw (w + psi')' = Kt iq - B w
+  (*pA)(0,1) = 1.0;
+  (*pA)(1,0) = mgl / Jp;
+  (*pA)(1,2) = B / Jp;
+  (*pA)(2,0) = -mgl / Jp;
+  (*pA)(2,2) = -B * (1.0 / Jw + 1.0 / Jp);
+
+  (*pB)(1,0) = -Kt / Jp;
+  (*pB)(2,0) = Kt * (1.0 / Jw + 1.0 / Jp);
+
+  return;
+} // end of getContinuous() function
+
+
+//! \brief Discretizes with a zero order hold, exp([A B; 0 0] t) by scaling and squaring
+static Discrete discretize(const PlantParams &plant,const double t_sec)
+{
+  Matrix A(3,3), B(3,1), M(4,4);
+  Discrete result;
+  unsigned int numSquarings = 0;
+  size_t row, col;
+  unsigned int cnt;
+
+
+  getContinuous(plant,&A,&B);
+
+  for(row=0;row<3;row++)
+    {
+      for(col=0;col<3;col++)
+        {
+          M(row,col) = A(row,col) * t_sec;
+        }
+      M(row,3) = B(row,0) * t_sec;
+    }
+
+  while(M.getNorm() > 0.5)
+    {
+      M = M.scale(0.5);
+      numSquarings++;
+    }
+
+  // Taylor series, far past double precision at a norm of 0.5
+  Matrix term = Matrix::identity(4);
+  Matrix expM = Matrix::identity(4);
+
+  for(cnt=1;cnt<=20;cnt++)
+    {
+      term = (term * M).scale(1.0 / (double)cnt);
+      expM = expM + term;
+    }
+
+  for(cnt=0;cnt<numSquarings;cnt++)
+    {
+      expM = expM * expM;
+    }
+
+  for(row=0;row<3;row++)
+    {
+      for(col=0;col<3;col++)
+        {
+          result.phi(row,col) = expM(row,col);
+        }
+      result.gamma(row,0) = expM(row,3);
+    }
+
+  return(result);
+} // end of discretize() function
+
+
+//! \brief Gets c with the lean integral = c x + a constant, from the angular
+//!        momentum (Jp + Jw) psi' + Jw w, which only mgl psi changes, see lqr.h
+static Matrix getIntegralMap(const PlantParams &plant)
+{
+  const double mgl = plant.mass_kg * plant.gravity_mps2 * plant.comLength_m;
+  Matrix c(1,LQR_NUM_STATES);
+
+  c(0,1) = (plant.Jp_kgm2 + plant.Jw_kgm2) / mgl;
+  c(0,2) = plant.Jw_kgm2 / mgl;
+
+  return(c);
+} // end of getIntegralMap() function
+
+
+//! \brief Converts the gains to SI state feedback, u = -K x, with the integral folded in
+static Matrix toStateFeedback(const PlantParams &plant,const LqrLoop &loop,const LqrGains &gains)
+{
+  const Matrix c = getIntegralMap(plant);
+  const double KI = gains.ki * loop.imuSign * 180.0 / M_PI;
+  Matrix K(1,LQR_NUM_STATES);
+
+  // e = -imuSign psi in degrees, v = imuSign psi' in dps * counts / 100
+  K(0,0) = gains.kp * loop.imuSign * 180.0 / M_PI;
+  K(0,1) = -gains.kd * loop.imuSign * 180.0 * loop.gyroCounts_per_dps / (100.0 * M_PI) + KI * c(0,1);
+  K(0,2) = -gains.kw * LQR_KRPM_PER_RADPS + KI * c(0,2);
+
+  return(K);
+} // end of toStateFeedback() function
+
+
+//! \brief Estimates the spectral radius as the limit of |M^n|^(1/n)
+static double getSpectralRadius(const Matrix &M)
+{
+  Matrix power(M);
+  double logScale;
+  double norm = M.getNorm();
+  unsigned int cnt;
+
+
+  if(norm == 0.0)
+    {
+      return(0.0);
+    }
+
+  power = power.scale(1.0 / norm);
+  logScale = std::log(norm);
+
+  for(cnt=0;cnt<LQR_NUM_SQUARINGS;cnt++)
+    {
+      power = power * power;
+      norm = power.getNorm();
+
+      if(norm == 0.0)
+        {
+          return(0.0);
+        }
+
+      power = power.scale(1.0 / norm);
+      logScale = 2.0 * logScale + std::log(norm);
+    }
+
+  return(std::exp(std::ldexp(logScale,-LQR_NUM_SQUARINGS)));
+} // end of getSpectralRadius() function
+
+
+//! \brief Builds the closed loop with the delay as held inputs u[k-1] .. u[k-m-1]
+static Matrix getDelayedLoop(const PlantParams &plant,const LqrLoop &loop,const Matrix &K)
+{
+  const double Ts = loop.period_sec;
+  const unsigned int m = (unsigned int)std::floor(loop.delay_sec / Ts);
+  const double f = loop.delay_sec - (double)m * Ts;
+  const Discrete whole = discretize(plant,Ts);
+  const Discrete late = discretize(plant,Ts - f);
+  const Discrete early = discretize(plant,f);
+  const Matrix gammaEarly = late.phi * early.gamma;     // u[k-m-1] held over [0, f)
+  const Matrix &gammaLate = late.gamma;                 // u[k-m] held over [f, Ts)
+  const size_t size = LQR_NUM_STATES + m + 1;
+  Matrix M(size,size);
+  size_t row, col;
+
+
+  for(row=0;row<LQR_NUM_STATES;row++)
+    {
+      for(col=0;col<LQR_NUM_STATES;col++)
+        {
+          M(row,col) = whole.phi(row,col);
+        }
+
+      if(m == 0)
+        {
+          for(col=0;col<LQR_NUM_STATES;col++)
+            {
+              M(row,col) -= gammaLate(row,0) * K(0,col);
+            }
+        }
+      else
+        {
+          M(row,LQR_NUM_STATES + m - 1) += gammaLate(row,0);
+        }
+
+      M(row,LQR_NUM_STATES + m) += gammaEarly(row,0);
+    }
+
+  // the input history, shifting by one
+  for(col=0;col<LQR_NUM_STATES;col++)
+    {
+      M(LQR_NUM_STATES,col) = -K(0,col);
+    }
+
+  for(row=LQR_NUM_STATES+1;row<size;row++)
+    {
+      M(row,row - 1) = 1.0;
+    }
+
+  return(M);
+} // end of getDelayedLoop() function
+
+
+void evaluate(const PlantParams &plant,const LqrLoop &loop,LqrGains *pGains)
+{
+  const Discrete whole = discretize(plant,loop.period_sec);
+  const Matrix K = toStateFeedback(plant,loop,*pGains);
+
+  pGains->rhoNominal = getSpectralRadius(whole.phi - whole.gamma * K);
+  pGains->rhoDelayed = getSpectralRadius(getDelayedLoop(plant,loop,K));
+
+  return;
+} // end of evaluate() function
+
+
+void design(const PlantParams &plant,const LqrLoop &loop,const LqrWeights &weights,LqrGains *pGains)
+{
+  const Discrete whole = discretize(plant,loop.period_sec);
+  const bool flag_wheel = (weights.wheel_krpm > 0.0);
+  const bool flag_integral = (weights.integral_degs > 0.0);
+  const size_t n = (flag_wheel || flag_integral) ? 3 : 2;
+  const double tilt_rad = weights.tilt_deg * M_PI / 180.0;
+  const double rate_radps = weights.rate_dps * M_PI / 180.0;
+  const Matrix c = getIntegralMap(plant);
+  Matrix A(n,n), B(n,1), Q(n,n), R(1,1);
+  size_t row, col, cnt;
+
+
+  // with neither the wheel speed nor the integral the motor speed is left
+  // out of the model, as the PD law leaves it out
+  for(row=0;row<n;row++)
+    {
+      for(col=0;col<n;col++)
+        {
+          A(row,col) = whole.phi(row,col);
+        }
+      B(row,0) = whole.gamma(row,0);
+    }
+
+  Q(0,0) = 1.0 / (tilt_rad * tilt_rad);
+  Q(1,1) = 1.0 / (rate_radps * rate_radps);
+
+  if(flag_wheel)
+    {
+      const double wheel_radps = weights.wheel_krpm / LQR_KRPM_PER_RADPS;
+
+      Q(2,2) += 1.0 / (wheel_radps * wheel_radps);
+    }
+
+  if(flag_integral)
+    {
+      const double integral_rads = weights.integral_degs * M_PI / 180.0;
+
+      // the integral through getIntegralMap(), c' c / weight^2
+      for(row=1;row<3;row++)
+        {
+          for(col=1;col<3;col++)
+            {
+              Q(row,col) += c(0,row) * c(0,col) / (integral_rads * integral_rads);
+            }
+        }
+    }
+
+  R(0,0) = 1.0 / (weights.iq_A * weights.iq_A);
+
+  // P = Q + A'PA - A'PB (R + B'PB)^-1 B'PA
+  const Matrix At = A.transpose();
+  const Matrix Bt = B.transpose();
+  Matrix P(Q);
+  Matrix K(1,n);
+
+  pGains->flag_converged = false;
+  for(cnt=0;cnt<LQR_MAX_ITERATIONS;cnt++)
+    {
+      const Matrix PA = P * A;
+      const Matrix PB = P * B;
+
+      K = (R + Bt * PB).inverse() * (Bt * PA);
+
+      const Matrix next = Q + At * PA - (At * PB) * K;
+      const double change = (next - P).getNorm();
+
+      P = next;
+
+      if(change <= LQR_TOLERANCE * P.getNorm())
+        {
+          pGains->flag_converged = true;
+          break;
+        }
+    }
+
+  K = (R + Bt * P * B).inverse() * (Bt * P * A);
+
+  // back to rwp::Balance units, see toStateFeedback(); the wheel speed gain
+  // goes to kw when the F28069 sends the speed, to ki when only the integral
+  // was asked for, which needs no speed reply
+  double KI = 0.0, Kw = (n == 3) ? K(0,2) : 0.0;
+  double Kd = K(0,1);
+
+  if(flag_integral && !flag_wheel)
+    {
+      KI = Kw / c(0,2);
+      Kd -= KI * c(0,1);
+      Kw = 0.0;
+    }
+
+  pGains->kp = K(0,0) * loop.imuSign * M_PI / 180.0;
+  pGains->kd = -Kd * loop.imuSign * 100.0 * M_PI / (180.0 * loop.gyroCounts_per_dps);
+  pGains->kw = (Kw != 0.0) ? (-Kw / LQR_KRPM_PER_RADPS) : 0.0;
+  pGains->ki = (KI != 0.0) ? (KI * loop.imuSign * M_PI / 180.0) : 0.0;
+
+  evaluate(plant,loop,pGains);
+
+  return;
+} // end of design() function
+
+
+LqrResponse simulate(const PlantParams &plant,const LqrLoop &loop,const LqrGains &gains,
+                     const double setpointError_deg,const double impulse_Nms,const double length_sec)
+{
+  const double h = loop.period_sec / LQR_SUB_STEPS;
+  const Discrete sub = discretize(plant,h);
+  const unsigned long numSteps = (unsigned long)std::floor(length_sec / h + 0.5);
+  const unsigned long delaySteps = (unsigned long)std::floor(loop.delay_sec / h + 0.5);
+  const unsigned long tailSteps = (unsigned long)std::floor(0.1 / h + 0.5);
+  std::vector<double> tilt_deg(numSteps + 1);
+  std::deque<std::pair<unsigned long,double> > pending;
+  double x[3] = {0.0, impulse_Nms / plant.Jp_kgm2, -impulse_Nms / plant.Jp_kgm2};
+  double integral_degs = 0.0, u_A = 0.0, tailWheel_krpm = 0.0;
+  LqrResponse response = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+  unsigned long step;
+
+
+  for(step=0;step<=numSteps;step++)
+    {
+      const double wheel_krpm = x[2] * LQR_KRPM_PER_RADPS;
+
+      tilt_deg[step] = x[0] * 180.0 / M_PI;
+      response.peakTilt_deg = (std::fabs(tilt_deg[step]) > response.peakTilt_deg) ? std::fabs(tilt_deg[step]) : response.peakTilt_deg;
+      response.peakWheel_krpm = (std::fabs(wheel_krpm) > response.peakWheel_krpm) ? std::fabs(wheel_krpm) : response.peakWheel_krpm;
+
+      if(step + tailSteps == numSteps)
+        {
+          tailWheel_krpm = wheel_krpm;
+        }
+
+      if(step == numSteps)
+        {
+          break;
+        }
+
+      // rwp::Balance::step() on what the IMU and the F28069 report
+      if((step % LQR_SUB_STEPS) == 0)
+        {
+          const double error_deg = -loop.imuSign * tilt_deg[step] + setpointError_deg;
+          const double velocity = loop.imuSign * x[1] * 180.0 / M_PI * loop.gyroCounts_per_dps / 100.0;
+          double cmd_A;
+
+          integral_degs += error_deg * loop.period_sec;
+          cmd_A = gains.kp * error_deg + gains.kd * velocity + gains.kw * wheel_krpm + gains.ki * integral_degs;
+          cmd_A = (cmd_A > loop.range_A) ? loop.range_A : ((cmd_A < -loop.range_A) ? -loop.range_A : cmd_A);
+
+          pending.push_back(std::make_pair(step + delaySteps,cmd_A));
+        }
+
+      while(!pending.empty() && (pending.front().first <= step))
+        {
+          u_A = pending.front().second;
+          pending.pop_front();
+        }
+
+      response.peakIq_A = (std::fabs(u_A) > response.peakIq_A) ? std::fabs(u_A) : response.peakIq_A;
+
+      const double next[3] = {sub.phi(0,0) * x[0] + sub.phi(0,1) * x[1] + sub.phi(0,2) * x[2] + sub.gamma(0,0) * u_A,
+                              sub.phi(1,0) * x[0] + sub.phi(1,1) * x[1] + sub.phi(1,2) * x[2] + sub.gamma(1,0) * u_A,
+                              sub.phi(2,0) * x[0] + sub.phi(2,1) * x[1] + sub.phi(2,2) * x[2] + sub.gamma(2,0) * u_A};
+
+      x[0] = next[0];
+      x[1] = next[1];
+      x[2] = next[2];
+    }
+
+  response.finalTilt_deg = tilt_deg[numSteps];
+  response.finalWheel_krpm = x[2] * LQR_KRPM_PER_RADPS;
+  response.wheelAccel_krpmps = (response.finalWheel_krpm - tailWheel_krpm) / ((double)tailSteps * h);
+
+  for(step=numSteps;step>0;step--)
+    {
+      if(std::fabs(tilt_deg[step] - response.finalTilt_deg) >= 0.1)
+        {
+          response.settle_sec = (double)step * h;
+          break;
+        }
+    }
+
+  return(response);
+} // end of simulate() function
+
+
+} // end of cosim namespace
+
+
+// end of file
@@ -0,0 +1,149 @@
+#ifndef _LQR_H_
+#define _LQR_H_
+
+//! \file   lqr.h
+//! \brief  Contains the public interface to the full state balance gain design
+//!
+//!         The plant of plant.h is linearized about upright, without the
+//!         Coulomb friction and with the current loop taken as ideal, in the
+//!         states the rwp-1 controller sees:
+//!
+//!           psi, psi' and the motor speed phi' - psi'
+//!
+//!         with the Iq reference as the input.  It is discretized with a zero
+//!         order hold at the control period, and the discrete LQR gain comes
+//!         from the Riccati recursion.  The weights follow Bryson's rule: each
+//!         state and the input are divided by the largest value that is still
+//!         acceptable.
+//!
+//!         The lean integral is not a fourth state.  The motor torque is
+//!         internal to the pendulum, so the integral is the change of the
+//!         total angular momentum over mgl, a fixed mix of psi' and the motor
+//!         speed; as a state it would add an uncontrollable pole at 1.  Its
+//!         weight goes into the cost through that mix, and when the wheel
+//!         speed is left out the wheel speed gain comes back as ki, which
+//!         needs no speed reply from the F28069.  Such a loop holds the
+//!         angular momentum it started with rather than a still wheel, and
+//!         like any integral of the setpoint error it runs the wheel up for
+//!         as long as the setpoint is off the true balance.
+//!
+//!         The design has no delay in it, since rwp-1 can only feed back what
+//!         it measures.  The check does: the closed loop is rebuilt with the
+//!         measured sensor filter and link delay between the IMU sample and
+//!         the new Iq reference, as held inputs, and its spectral radius and
+//!         responses are what the design is judged by.
+//!
+//!         The gains come out in the units of rwp::Balance (balance.h): kp
+//!         in A per degree of setpoint error, kd in A per DMP gyro count / 100,
+//!         kw in A per krpm of the speed the F28069 sends back and ki in A per
+//!         degree second of setpoint error.
+
+
+// **************************************************************************
+// the includes
+
+#include "plant.h"
+
+
+namespace cosim
+{
+
+
+// **************************************************************************
+// the typedefs
+
+//! \brief Defines the loop the gains are for
+//!
+struct LqrLoop
+{
+  double  period_sec;            //!< the control period
+  double  delay_sec;             //!< the IMU sample to Iq reference delay, for the check
+  double  imuSign;               //!< the IMU roll direction against the motor axis, +1 or -1
+  double  gyroCounts_per_dps;    //!< the gyro scale behind the velocity kd multiplies
+  double  range_A;               //!< the command clamp, for the responses
+};
+
+
+//! \brief Defines the Bryson weights, the largest acceptable values
+//!
+struct LqrWeights
+{
+  double  tilt_deg;              //!< the lean
+  double  rate_dps;              //!< the lean rate
+  double  wheel_krpm;            //!< the motor speed, 0 leaves it out as in the PD law
+  double  integral_degs;         //!< the lean integral, 0 leaves it out
+  double  iq_A;                  //!< the Iq reference
+};
+
+
+//! \brief Defines the gains, in rwp::Balance units, and how the closed loop fares
+//!
+struct LqrGains
+{
+  double  kp;                    //!< A per degree
+  double  kd;                    //!< A per gyro count / 100
+  double  kw;                    //!< A per krpm
+  double  ki;                    //!< A per degree second
+  bool    flag_converged;        //!< true if the Riccati recursion converged
+  double  rhoNominal;            //!< the closed loop spectral radius without the delay
+  double  rhoDelayed;            //!< the closed loop spectral radius with the delay
+};
+
+
+//! \brief Defines one closed loop response of the linear model with the delay
+//!
+struct LqrResponse
+{
+  double  peakTilt_deg;          //!< the largest lean
+  double  peakIq_A;              //!< the largest command
+  double  peakWheel_krpm;        //!< the largest motor speed
+  double  settle_sec;            //!< the last time the lean was 0.1 deg or more from its final value
+  double  finalTilt_deg;         //!< the lean at the end
+  double  finalWheel_krpm;       //!< the motor speed at the end
+  double  wheelAccel_krpmps;     //!< the motor acceleration at the end
+};
+
+
+// **************************************************************************
+// the function prototypes
+
+//! \brief      Sets the rwp-1 DMP loop: 100 Hz, the co-simulated 10.1 ms delay, 16.4 counts per dps
+//! \param[out] pLoop  A pointer to the loop
+void setDefaultLoop(LqrLoop *pLoop);
+
+
+//! \brief      Sets the default weights, wheel speed in and the integral out
+//! \param[out] pWeights  A pointer to the weights
+void setDefaultWeights(LqrWeights *pWeights);
+
+
+//! \brief      Designs the gains
+//! \param[in]  plant     The plant
+//! \param[in]  loop      The loop
+//! \param[in]  weights   The weights
+//! \param[out] pGains    A pointer to the gains
+void design(const PlantParams &plant,const LqrLoop &loop,const LqrWeights &weights,LqrGains *pGains);
+
+
+//! \brief         Gets the closed loop spectral radii of gains designed elsewhere, such as the PD law
+//! \param[in]     plant   The plant
+//! \param[in]     loop    The loop
+//! \param[in,out] pGains  A pointer to the gains, the radii are written
+void evaluate(const PlantParams &plant,const LqrLoop &loop,LqrGains *pGains);
+
+
+//! \brief     Simulates the linear plant with the delay under the gains
+//! \param[in] plant           The plant
+//! \param[in] loop            The loop
+//! \param[in] gains           The gains
+//! \param[in] setpointError_deg  The setpoint minus the true balance reading, the step
+//! \param[in] impulse_Nms     An impulse on the pendulum at the start
+//! \param[in] length_sec      The simulated time
+//! \return    The response
+LqrResponse simulate(const PlantParams &plant,const LqrLoop &loop,const LqrGains &gains,
+                     const double setpointError_deg,const double impulse_Nms,const double length_sec);
+
+
+} // end of cosim namespace
+
+#endif // end of _LQR_H_ definition
@@ -0,0 +1,175 @@
+//! \file   plant.cpp
+//! \brief  Contains the reaction wheel pendulum plant functions
+//!
+
+
+// **************************************************************************
+// the includes
+
+#include <cmath>
+
+#include "plant.h"
+
+
+namespace cosim
+{
+
+
+// **************************************************************************
+// the defines
+
+//! \brief Defines the default mechanical parameters, the Simulink model has none
+//!
+#define PLANT_DEFAULT_MASS_kg       (0.6)
+#define PLANT_DEFAULT_COM_m         (0.12)
+#define PLANT_DEFAULT_Jp_kgm2       (1.2e-2)
+#define PLANT_DEFAULT_Jw_kgm2       (4.0e-4)
+
+
+// **************************************************************************
+// the typedefs
+
+//! \brief Defines the integrated variables
+//!
+struct PlantDeriv
+{
+  double  psi;
+  double  psiDot;
+  double  wheelSpeed;
+  double  rotorAngle;
+  double  id;
+  double  iq;
+};
+
+
+// **************************************************************************
+// the functions
+
+void setDefaultParams(PlantParams *pParams)
+{
+  pParams->mass_kg = PLANT_DEFAULT_MASS_kg;
+  pParams->comLength_m = PLANT_DEFAULT_COM_m;
+  pParams->Jp_kgm2 = PLANT_DEFAULT_Jp_kgm2;
+  pParams->Jw_kgm2 = PLANT_DEFAULT_Jw_kgm2;
+  pParams->gravity_mps2 = 9.81;
+  pParams->frictionSmoothing_radps = 0.1;
+
+  PMSM_setDefaultParams(&pParams->motor);
+
+  return;
+} // end of setDefaultParams() function
+
+
+static void getDeriv(const PlantParams &params,const PlantDeriv &x,const double valpha,const double vbeta,
+                     const double external_Nm,PlantDeriv *pDx)
+{
+  const PMSM_Params_t &motor = params.motor;
+  double angle = motor.numPolePairs * x.rotorAngle;
+  double c = std::cos(angle);
+  double s = std::sin(angle);
+  double vd = valpha * c + vbeta * s;
+  double vq = -valpha * s + vbeta * c;
+  double speed = x.wheelSpeed - x.psiDot;
+  double we = motor.numPolePairs * speed;
+  double torque = 1.5 * motor.numPolePairs * motor.flux_Wb * x.iq;
+
+  // tanh keeps the Coulomb term smooth through zero speed so RK4 stays stable
+  double friction = motor.B_Nmps * speed + motor.Tc_Nm * std::tanh(speed / params.frictionSmoothing_radps);
+  double shaft = torque - friction;
+
+
+  pDx->psi = x.psiDot;
+  pDx->psiDot = (params.mass_kg * params.gravity_mps2 * params.comLength_m * std::sin(x.psi) - shaft + external_Nm) /
+                params.Jp_kgm2;
+  pDx->wheelSpeed = shaft / params.Jw_kgm2;
+  pDx->rotorAngle = speed;
+  pDx->id = (vd - motor.Rs_Ohm * x.id + we * motor.Ls_q_H * x.iq) / motor.Ls_d_H;
+  pDx->iq = (vq - motor.Rs_Ohm * x.iq - we * (motor.Ls_d_H * x.id + motor.flux_Wb)) / motor.Ls_q_H;
+
+  return;
+} // end of getDeriv() function
+
+
+static PlantDeriv add(const PlantDeriv &x,const PlantDeriv &dx,const double h)
+{
+  PlantDeriv y;
+
+  y.psi = x.psi + h * dx.psi;
+  y.psiDot = x.psiDot + h * dx.psiDot;
+  y.wheelSpeed = x.wheelSpeed + h * dx.wheelSpeed;
+  y.rotorAngle = x.rotorAngle + h * dx.rotorAngle;
+  y.id = x.id + h * dx.id;
+  y.iq = x.iq + h * dx.iq;
+
+  return(y);
+} // end of add() function
+
+
+void step(const PlantParams &params,PlantState *pState,const double *pVabc_V,
+          const double external_Nm,const double dt_sec)
+{
+  // the common mode of the pole voltages drops out of the Clarke transform
+  double valpha = (2.0 * pVabc_V[0] - pVabc_V[1] - pVabc_V[2]) / 3.0;
+  double vbeta = (pVabc_V[1] - pVabc_V[2]) / std::sqrt(3.0);
+  PlantDeriv x = {pState->psi_rad, pState->psiDot_radps, pState->wheelSpeed_radps,
+                  pState->rotorAngle_rad, pState->id_A, pState->iq_A};
+  PlantDeriv k1, k2, k3, k4;
+
+
+  getDeriv(params,x,valpha,vbeta,external_Nm,&k1);
+  getDeriv(params,add(x,k1,0.5 * dt_sec),valpha,vbeta,external_Nm,&k2);
+  getDeriv(params,add(x,k2,0.5 * dt_sec),valpha,vbeta,external_Nm,&k3);
+  getDeriv(params,add(x,k3,dt_sec),valpha,vbeta,external_Nm,&k4);
+
+  pState->psi_rad = x.psi + dt_sec / 6.0 * (k1.psi + 2.0 * k2.psi + 2.0 * k3.psi + k4.psi);
+  pState->psiDot_radps = x.psiDot + dt_sec / 6.0 * (k1.psiDot + 2.0 * k2.psiDot + 2.0 * k3.psiDot + k4.psiDot);
+  pState->wheelSpeed_radps = x.wheelSpeed + dt_sec / 6.0 *
+                             (k1.wheelSpeed + 2.0 * k2.wheelSpeed + 2.0 * k3.wheelSpeed + k4.wheelSpeed);
+  pState->id_A = x.id + dt_sec / 6.0 * (k1.id + 2.0 * k2.id + 2.0 * k3.id + k4.id);
+  pState->iq_A = x.iq + dt_sec / 6.0 * (k1.iq + 2.0 * k2.iq + 2.0 * k3.iq + k4.iq);
+  pState->rotorAngle_rad = std::fmod(x.rotorAngle + dt_sec / 6.0 *
+                                     (k1.rotorAngle + 2.0 * k2.rotorAngle + 2.0 * k3.rotorAngle + k4.rotorAngle),
+                                     2.0 * M_PI);
+
+  if(pState->rotorAngle_rad < 0.0)
+    {
+      pState->rotorAngle_rad += 2.0 * M_PI;
+    }
+
+  return;
+} // end of step() function
+
+
+void getIabc(const PlantParams &params,const PlantState &state,double *pIabc_A)
+{
+  double angle = getElecAngle(params,state);
+  double c = std::cos(angle);
+  double s = std::sin(angle);
+  double ialpha = state.id_A * c - state.iq_A * s;
+  double ibeta = state.id_A * s + state.iq_A * c;
+
+
+  pIabc_A[0] = ialpha;
+  pIabc_A[1] = -0.5 * ialpha + 0.5 * std::sqrt(3.0) * ibeta;
+  pIabc_A[2] = -0.5 * ialpha - 0.5 * std::sqrt(3.0) * ibeta;
+
+  return;
+} // end of getIabc() function
+
+
+double getElecAngle(const PlantParams &params,const PlantState &state)
+{
+  return(std::fmod(params.motor.numPolePairs * state.rotorAngle_rad,2.0 * M_PI));
+} // end of getElecAngle() function
+
+
+double getMotorTorque(const PlantParams &params,const PlantState &state)
+{
+  return(1.5 * params.motor.numPolePairs * params.motor.flux_Wb * state.iq_A);
+} // end of getMotorTorque() function
+
+
+} // end of cosim namespace
+
+
+// end of file
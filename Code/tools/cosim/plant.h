@@ -0,0 +1,103 @@
+#ifndef _PLANT_H_
+#define _PLANT_H_
+
+//! \file   plant.h
+//! \brief  Contains the public interface to the reaction wheel pendulum plant
+//!
+//!         The pendulum pivots about the motor axis and the wheel spins on the
+//!         motor shaft.  In motor axis coordinates, with psi the pendulum
+//!         angle from upright and phi the absolute wheel angle,
+//!
+//!           Jp psi''  = m g l sin(psi) - (Tm - Tf)
+//!           Jw phi''  = Tm - Tf
+//!
+//!         where Tm = 1.5 pp flux iq is the motor torque and Tf the bearing
+//!         friction at the motor speed phi' - psi'.  The motor is the dq model
+//!         of hostsim/pmsm.h driven by the inverter pole voltages, with its
+//!         electrical angle taken from the relative rotor angle.  Everything
+//!         is double and SI, and a step is fixed-step RK4.
+
+
+// **************************************************************************
+// the includes
+
+#include "pmsm.h"
+
+
+namespace cosim
+{
+
+
+// **************************************************************************
+// the typedefs
+
+//! \brief Defines the mechanical parameters
+//!
+struct PlantParams
+{
+  double  mass_kg;               //!< pendulum and wheel mass
+  double  comLength_m;           //!< pivot to centre of mass
+  double  Jp_kgm2;               //!< pendulum inertia about the pivot, wheel mass included
+  double  Jw_kgm2;               //!< wheel and rotor inertia about the motor axis
+  double  gravity_mps2;          //!< gravitational acceleration
+  double  frictionSmoothing_radps; //!< speed over which the Coulomb friction reaches full value
+
+  PMSM_Params_t motor;           //!< the motor, its J_kgm2 is not used
+};
+
+
+//! \brief Defines the plant state
+//!
+struct PlantState
+{
+  double  psi_rad;               //!< pendulum angle from upright, motor axis
+  double  psiDot_radps;          //!< pendulum speed
+  double  wheelSpeed_radps;      //!< absolute wheel speed
+  double  rotorAngle_rad;        //!< wheel angle relative to the pendulum, wrapped to [0, 2 pi)
+  double  id_A;                  //!< d axis current
+  double  iq_A;                  //!< q axis current
+};
+
+
+// **************************************************************************
+// the function prototypes
+
+//! \brief      Sets default parameters, the motor from user_j1.h
+//! \param[out] pParams  A pointer to the parameters
+void setDefaultParams(PlantParams *pParams);
+
+
+//! \brief         Advances the plant by one step
+//! \param[in]     params      The parameters
+//! \param[in,out] pState      A pointer to the state
+//! \param[in]     pVabc_V     The pole voltages, held over the step
+//! \param[in]     external_Nm A disturbance torque on the pendulum, held over the step
+//! \param[in]     dt_sec      The step
+void step(const PlantParams &params,PlantState *pState,const double *pVabc_V,
+          const double external_Nm,const double dt_sec);
+
+
+//! \brief      Gets the phase currents
+//! \param[in]  params   The parameters
+//! \param[in]  state    The state
+//! \param[out] pIabc_A  A pointer to the three phase currents
+void getIabc(const PlantParams &params,const PlantState &state,double *pIabc_A);
+
+
+//! \brief     Gets the electrical angle, what a perfect FAST estimate would be
+//! \param[in] params  The parameters
+//! \param[in] state   The state
+//! \return    The angle, rad in [0, 2 pi)
+double getElecAngle(const PlantParams &params,const PlantState &state);
+
+
+//! \brief     Gets the motor torque
+//! \param[in] params  The parameters
+//! \param[in] state   The state
+//! \return    The torque on the wheel, Nm
+double getMotorTorque(const PlantParams &params,const PlantState &state);
+
+
+} // end of cosim namespace
+
+#endif // end of _PLANT_H_ definition
@@ -0,0 +1,142 @@
+//! \file   pool.cpp
+//! \brief  Contains the work-stealing thread pool
+//!
+
+
+// **************************************************************************
+// the includes
+
+#include <thread>
+
+#include "pool.h"
+
+
+namespace cosim
+{
+
+
+// **************************************************************************
+// the functions
+
+WorkPool::WorkPool(const unsigned int numThreads)
+  : m_numThreads(numThreads)
+{
+  if(m_numThreads == 0)
+    {
+      m_numThreads = std::thread::hardware_concurrency();
+    }
+
+  if(m_numThreads == 0)
+    {
+      m_numThreads = 1;
+    }
+
+  // std::mutex cannot move, so the queues are sized once here
+  std::vector<Queue> queues(m_numThreads);
+  m_queues.swap(queues);
+} // end of WorkPool::WorkPool() function
+
+
+unsigned int WorkPool::getNumThreads(void) const
+{
+  return(m_numThreads);
+} // end of WorkPool::getNumThreads() function
+
+
+bool WorkPool::pop(const unsigned int worker,size_t *pTask)
+{
+  Queue &queue = m_queues[worker];
+  std::lock_guard<std::mutex> guard(queue.lock);
+
+
+  if(queue.tasks.empty())
+    {
+      return(false);
+    }
+
+  *pTask = queue.tasks.back();
+  queue.tasks.pop_back();
+
+  return(true);
+} // end of WorkPool::pop() function
+
+
+bool WorkPool::steal(const unsigned int worker,size_t *pTask)
+{
+  unsigned int cnt;
+
+
+  // start with the next worker so thieves spread over the victims
+  for(cnt=1;cnt<m_numThreads;cnt++)
+    {
+      Queue &queue = m_queues[(worker + cnt) % m_numThreads];
+      std::lock_guard<std::mutex> guard(queue.lock);
+
+      if(!queue.tasks.empty())
+        {
+          *pTask = queue.tasks.front();
+          queue.tasks.pop_front();
+
+          return(true);
+        }
+    }
+
+  return(false);
+} // end of WorkPool::steal() function
+
+
+void WorkPool::work(const unsigned int worker,const std::function<void(size_t)> &task)
+{
+  size_t index;
+
+
+  // tasks never add tasks, so once every deque is empty the work is done
+  while(pop(worker,&index) || steal(worker,&index))
+    {
+      task(index);
+    }
+
+  return;
+} // end of WorkPool::work() function
+
+
+void WorkPool::run(const size_t numTasks,const std::function<void(size_t)> &task)
+{
+  std::vector<std::thread> threads;
+  unsigned int worker;
+  size_t index;
+
+
+  // contiguous blocks, so neighbouring grid points start on one worker
+  for(worker=0;worker<m_numThreads;worker++)
+    {
+      size_t begin = numTasks * worker / m_numThreads;
+      size_t end = numTasks * (worker + 1) / m_numThreads;
+
+      m_queues[worker].tasks.clear();
+      for(index=begin;index<end;index++)
+        {
+          m_queues[worker].tasks.push_back(index);
+        }
+    }
+
+  for(worker=1;worker<m_numThreads;worker++)
+    {
+      threads.push_back(std::thread(&WorkPool::work,this,worker,std::cref(task)));
+    }
+
+  work(0,task);
+
+  for(worker=0;worker<threads.size();worker++)
+    {
+      threads[worker].join();
+    }
+
+  return;
+} // end of WorkPool::run() function
+
+
+} // end of cosim namespace
+
+
+// end of file
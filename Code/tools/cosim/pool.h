@@ -0,0 +1,65 @@
+#ifndef _POOL_H_
+#define _POOL_H_
+
+//! \file   pool.h
+//! \brief  Contains the public interface to the work-stealing thread pool
+//!
+//!         Each worker owns a deque of task indices.  run() deals the
+//!         indices out in contiguous blocks, a worker takes tasks from the
+//!         back of its own deque, and a worker whose deque is empty steals
+//!         from the front of the others, so long and short simulations
+//!         balance out without a shared queue on the hot path.
+
+
+// **************************************************************************
+// the includes
+
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+
+namespace cosim
+{
+
+
+// **************************************************************************
+// the typedefs
+
+//! \brief Defines the work-stealing pool
+//!
+class WorkPool
+{
+public:
+  //! \brief     Creates a pool
+  //! \param[in] numThreads  The number of workers, 0 for one per hardware thread
+  explicit WorkPool(const unsigned int numThreads);
+
+  //! \brief  Returns the number of workers
+  unsigned int getNumThreads(void) const;
+
+  //! \brief     Runs task(0) to task(numTasks - 1) and returns when all are done
+  //! \param[in] numTasks  The number of tasks
+  //! \param[in] task      The task, called from the workers with the task index
+  void run(const size_t numTasks,const std::function<void(size_t)> &task);
+
+private:
+  struct Queue
+  {
+    std::mutex          lock;
+    std::deque<size_t>  tasks;
+  };
+
+  bool pop(const unsigned int worker,size_t *pTask);
+  bool steal(const unsigned int worker,size_t *pTask);
+  void work(const unsigned int worker,const std::function<void(size_t)> &task);
+
+  unsigned int        m_numThreads;
+  std::vector<Queue>  m_queues;
+};
+
+
+} // end of cosim namespace
+
+#endif // end of _POOL_H_ definition
@@ -0,0 +1,166 @@
+//! \file   rwpcosim.cpp
+//! \brief  Runs the reaction wheel pendulum co-simulation from the command line
+//!
+//!         The rwp-1 balance loop and the proj_lab05a torque loop run
+//!         together against a pendulum and wheel model, see cosim.h.  A run
+//!         prints whether the pendulum stayed up, the lean and current
+//!         statistics, the DMP sample to takeIqRef() latency, and how much
+//!         faster than real time it went.
+//!
+//!         Build from this directory:
+//!
+//!           cc -O2 -I../../proj_lab05a -I../iqmath -I../hostsim -c ../hostsim/pmsm.c ../hostsim/halsim.c ../hostsim/focsim.c ../../proj_lab05a/cmdlink.c
+//!           c++ -O2 -std=c++11 -I../../proj_lab05a -I../../rwp-1 -I../iqmath -I../hostsim -o rwpcosim rwpcosim.cpp cosim.cpp plant.cpp pmsm.o halsim.o focsim.o cmdlink.o -lm
+//!
+//!         Usage:
+//!
+//!           rwpcosim [-t run_sec] [-a initial_deg] [-b baud] [-P kp] [-D kd]
+//!                    [-W kw] [-I ki] [-S setpoint_deg] [-A autoSetpoint] [-l sensorDelay_us]
+//!                    [-c i2cClock_Hz] [-k kick_Nm] [-K kickStart_sec] [-n gyroNoise_dps]
+//!                    [-s seed] [-o out.csv] [-d decimation] [-r repeats]
+
+
+// **************************************************************************
+// the includes
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "cosim.h"
+
+
+// **************************************************************************
+// the functions
+
+static void RWPCOSIM_usage(const char *pName)
+{
+  fprintf(stderr,
+          "usage: %s [-t run_sec] [-a initial_deg] [-b baud] [-P kp] [-D kd]\n"
+          "          [-W kw] [-I ki] [-S setpoint_deg] [-A autoSetpoint] [-l sensorDelay_us]\n"
+          "          [-c i2cClock_Hz] [-k kick_Nm] [-K kickStart_sec] [-n gyroNoise_dps]\n"
+          "          [-s seed] [-o out.csv] [-d decimation] [-r repeats]\n",
+          pName);
+
+  return;
+} // end of RWPCOSIM_usage() function
+
+
+static double RWPCOSIM_getTime_sec(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC,&now);
+
+  return((double)now.tv_sec + (double)now.tv_nsec * 1.0e-9);
+} // end of RWPCOSIM_getTime_sec() function
+
+
+int main(int argc,char *argv[])
+{
+  cosim::Config config;
+  cosim::Result result;
+  const char *pOutName = NULL;
+  FILE *pOut = NULL;
+  unsigned long decimation = 10;
+  unsigned long numRepeats = 1;
+  unsigned long cnt;
+  double start_sec, elapsed_sec;
+  int arg;
+
+
+  cosim::setDefaultConfig(&config);
+
+  for(arg=1;arg<argc;arg++)
+    {
+      if((argv[arg][0] != '-') || (argv[arg][1] == '\0') || (argv[arg][2] != '\0') || (arg + 1 >= argc))
+        {
+          RWPCOSIM_usage(argv[0]);
+          return(2);
+        }
+
+      switch(argv[arg++][1])
+        {
+          case 't': config.run_sec = atof(argv[arg]); break;
+          case 'a': config.initialAngle_deg = atof(argv[arg]); break;
+          case 'b': config.baud = atof(argv[arg]); break;
+          case 'P': config.kp = atof(argv[arg]); break;
+          case 'D': config.kd = atof(argv[arg]); break;
+          case 'W': config.kw = atof(argv[arg]); break;
+          case 'I': config.ki = atof(argv[arg]); break;
+          case 'S': config.setpoint_deg = atof(argv[arg]); break;
+          case 'A': config.flag_autoSetpoint = (atoi(argv[arg]) != 0); break;
+          case 'l': config.sensorDelay_us = atof(argv[arg]); break;
+          case 'c': config.i2cClock_Hz = atof(argv[arg]); break;
+          case 'k': config.kick_Nm = atof(argv[arg]); break;
+          case 'K': config.kickStart_sec = atof(argv[arg]); break;
+          case 'n': config.gyroNoise_dps = atof(argv[arg]); break;
+          case 's': config.seed = (uint32_t)strtoul(argv[arg],NULL,0); break;
+          case 'o': pOutName = argv[arg]; break;
+          case 'd': decimation = strtoul(argv[arg],NULL,0); break;
+          case 'r': numRepeats = strtoul(argv[arg],NULL,0); break;
+          default:
+            RWPCOSIM_usage(argv[0]);
+            return(2);
+        }
+    }
+
+  if((decimation == 0) || (numRepeats == 0) || (config.run_sec <= 0.0) || (config.baud <= 0.0))
+    {
+      RWPCOSIM_usage(argv[0]);
+      return(2);
+    }
+
+  if(pOutName != NULL)
+    {
+      pOut = fopen(pOutName,"w");
+      if(pOut == NULL)
+        {
+          perror(pOutName);
+          return(1);
+        }
+    }
+
+  // only the first run writes the CSV, the repeats time the engine
+  start_sec = RWPCOSIM_getTime_sec();
+  result = cosim::run(config,pOut,decimation);
+  for(cnt=1;cnt<numRepeats;cnt++)
+    {
+      cosim::run(config,NULL,decimation);
+    }
+  elapsed_sec = RWPCOSIM_getTime_sec() - start_sec;
+
+  if(pOut != NULL)
+    {
+      fclose(pOut);
+    }
+
+  if(result.flag_fallen)
+    {
+      printf("fell at %.3f s\n",result.fall_sec);
+    }
+  else
+    {
+      printf("balanced for %.3f s\n",config.run_sec);
+    }
+
+  printf("lean:      rms %.3f deg, max %.3f deg\n",result.rmsError_deg,result.maxError_deg);
+  printf("current:   rms %.3f A, max %.3f A\n",result.rmsIq_A,result.maxIq_A);
+  printf("wheel:     max %.0f rpm\n",result.maxWheelSpeed_rpm);
+  if(config.flag_autoSetpoint)
+    {
+      printf("setpoint:  %.3f deg after %lu windows, from %.3f deg\n",
+             result.finalSetpoint_deg,result.numSetpointWindows,config.setpoint_deg);
+    }
+  printf("latency:   mean %.0f us, max %.0f us over %lu commands\n",
+         result.meanLatency_us,result.maxLatency_us,result.numCommands);
+  printf("speed:     %.1f x real time (%lu mainISR ticks per run, %lu runs in %.3f s)\n",
+         (double)result.numTicks * numRepeats * 1.0e-4 / elapsed_sec,
+         result.numTicks,numRepeats,elapsed_sec);
+
+  return(result.flag_fallen ? 1 : 0);
+} // end of main() function
+
+
+// end of file
@@ -0,0 +1,245 @@
+//! \file   rwplqr.cpp
+//! \brief  Designs the full state balance gains from the command line
+//!
+//!         Prints a gain table over the wheel speed weight, with the stock PD
+//!         gains of rwp-1 for reference, then the step and impulse responses
+//!         of the chosen design on the linear model with the loop delay, see
+//!         lqr.h.  With -c the chosen gains and the PD gains also run in the
+//!         co-simulation, which has the friction, the current loop, the
+//!         sensor quantization and the link back in.
+//!
+//!         Build from this directory:
+//!
+//!           cc -O2 -I../../proj_lab05a -I../iqmath -I../hostsim -c ../hostsim/pmsm.c ../hostsim/halsim.c ../hostsim/focsim.c ../../proj_lab05a/cmdlink.c
+//!           c++ -O2 -std=c++11 -I../../proj_lab05a -I../../rwp-1 -I../iqmath -I../hostsim -o rwplqr rwplqr.cpp lqr.cpp cosim.cpp plant.cpp pmsm.o halsim.o focsim.o cmdlink.o -lm
+//!
+//!         Usage:
+//!
+//!           rwplqr [-T tilt_deg] [-R rate_dps] [-W wheel_krpm] [-I integral_degs]
+//!                  [-U iq_A] [-f rate_Hz] [-l delay_us] [-g gyroCounts_per_dps]
+//!                  [-e step_deg] [-i impulse_Nms] [-c run_sec]
+//!
+//!         The weights are the largest acceptable values of each state and
+//!         of the command; -W 0 leaves the wheel speed out and -I 0, the
+//!         default, the integral.  The printed kp, kd, kw and ki go straight
+//!         into rwp::Balance.
+//!
+//!         rho is the closed loop spectral radius without and with the delay,
+//!         and slow the time constant of the slowest mode with the delay.
+//!         Without kw that mode is the wheel speed held only by the viscous
+//!         friction, so rho reads 1.0000 for the PD law: the lean is caught
+//!         but the wheel keeps whatever speed catching it left.
+
+
+// **************************************************************************
+// the includes
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "cosim.h"
+#include "lqr.h"
+
+
+// **************************************************************************
+// the defines
+
+//! \brief Defines the number of wheel speed weights in the table
+//!
+#define RWPLQR_NUM_ROWS             (7)
+
+//! \brief Defines the simulated time of the linear responses, s
+//!
+#define RWPLQR_RESPONSE_sec         (5.0)
+
+
+// **************************************************************************
+// the functions
+
+static void RWPLQR_usage(const char *pName)
+{
+  fprintf(stderr,
+          "usage: %s [-T tilt_deg] [-R rate_dps] [-W wheel_krpm] [-I integral_degs]\n"
+          "          [-U iq_A] [-f rate_Hz] [-l delay_us] [-g gyroCounts_per_dps]\n"
+          "          [-e step_deg] [-i impulse_Nms] [-c run_sec]\n",
+          pName);
+
+  return;
+} // end of RWPLQR_usage() function
+
+
+static void RWPLQR_printRow(const char *pName,const cosim::LqrLoop &loop,const cosim::LqrGains &gains,
+                            const cosim::LqrResponse &impulse)
+{
+  // the slowest mode with the delay, the wheel speed drift once the lean is caught
+  const double slow_sec = (gains.rhoDelayed < 1.0) ? (-loop.period_sec / log(gains.rhoDelayed)) : INFINITY;
+
+  printf("%-10s %8.3f %8.3f %8.3f %8.3f %8.4f %8.4f %8.1f %8.3f %8.2f %8.2f\n",
+         pName,gains.kp,gains.kd,gains.kw,gains.ki,gains.rhoNominal,gains.rhoDelayed,slow_sec,
+         impulse.peakTilt_deg,impulse.peakIq_A,impulse.settle_sec);
+
+  return;
+} // end of RWPLQR_printRow() function
+
+
+static void RWPLQR_printResponse(const char *pName,const cosim::LqrResponse &response)
+{
+  printf("%-8s peak lean %.3f deg, peak command %.2f A, peak wheel %.3f krpm, settled %.2f s\n"
+         "         final lean %.4f deg, final wheel %.3f krpm, wheel acceleration %.4f krpm/s\n",
+         pName,response.peakTilt_deg,response.peakIq_A,response.peakWheel_krpm,response.settle_sec,
+         response.finalTilt_deg,response.finalWheel_krpm,response.wheelAccel_krpmps);
+
+  return;
+} // end of RWPLQR_printResponse() function
+
+
+static void RWPLQR_runCosim(const char *pName,const cosim::Config &config)
+{
+  const cosim::Result result = cosim::run(config,NULL,1);
+
+  if(result.flag_fallen)
+    {
+      printf("%-8s fell at %.3f s\n",pName,result.fall_sec);
+    }
+  else
+    {
+      printf("%-8s balanced, lean rms %.3f max %.3f deg, current rms %.3f max %.2f A, wheel max %.0f rpm\n",
+             pName,result.rmsError_deg,result.maxError_deg,result.rmsIq_A,result.maxIq_A,result.maxWheelSpeed_rpm);
+    }
+
+  return;
+} // end of RWPLQR_runCosim() function
+
+
+int main(int argc,char *argv[])
+{
+  static const double wheelWeights_krpm[RWPLQR_NUM_ROWS] = {0.0, 0.25, 0.5, 1.0, 2.0, 4.0, 8.0};
+  cosim::Config config;
+  cosim::LqrLoop loop;
+  cosim::LqrWeights weights;
+  cosim::LqrGains gains, pd;
+  double step_deg = 1.0;
+  double impulse_Nms = 0.002;
+  double check_sec = 0.0;
+  unsigned int row;
+  int arg;
+
+
+  cosim::setDefaultConfig(&config);
+  cosim::setDefaultLoop(&loop);
+  cosim::setDefaultWeights(&weights);
+
+  for(arg=1;arg<argc;arg++)
+    {
+      if((argv[arg][0] != '-') || (argv[arg][1] == '\0') || (argv[arg][2] != '\0') || (arg + 1 >= argc))
+        {
+          RWPLQR_usage(argv[0]);
+          return(2);
+        }
+
+      switch(argv[arg++][1])
+        {
+          case 'T': weights.tilt_deg = atof(argv[arg]); break;
+          case 'R': weights.rate_dps = atof(argv[arg]); break;
+          case 'W': weights.wheel_krpm = atof(argv[arg]); break;
+          case 'I': weights.integral_degs = atof(argv[arg]); break;
+          case 'U': weights.iq_A = atof(argv[arg]); break;
+          case 'f': loop.period_sec = 1.0 / atof(argv[arg]); break;
+          case 'l': loop.delay_sec = atof(argv[arg]) * 1.0e-6; break;
+          case 'g': loop.gyroCounts_per_dps = atof(argv[arg]); break;
+          case 'e': step_deg = atof(argv[arg]); break;
+          case 'i': impulse_Nms = atof(argv[arg]); break;
+          case 'c': check_sec = atof(argv[arg]); break;
+          default:
+            RWPLQR_usage(argv[0]);
+            return(2);
+        }
+    }
+
+  if((weights.tilt_deg <= 0.0) || (weights.rate_dps <= 0.0) || (weights.iq_A <= 0.0) ||
+     (weights.wheel_krpm < 0.0) || (weights.integral_degs < 0.0) ||
+     !(loop.period_sec > 0.0) || (loop.delay_sec < 0.0) || (loop.gyroCounts_per_dps <= 0.0))
+    {
+      RWPLQR_usage(argv[0]);
+      return(2);
+    }
+
+  printf("weights: tilt %.3g deg, rate %.3g dps, integral %.3g deg s, command %.3g A\n"
+         "loop:    %.0f Hz, %.0f us delay, %.1f counts per dps\n\n",
+         weights.tilt_deg,weights.rate_dps,weights.integral_degs,weights.iq_A,
+         1.0 / loop.period_sec,loop.delay_sec * 1.0e6,loop.gyroCounts_per_dps);
+
+  printf("impulse of %.4f Nms on the pendulum, %.0f s\n",impulse_Nms,RWPLQR_RESPONSE_sec);
+  printf("%-10s %8s %8s %8s %8s %8s %8s %8s %8s %8s %8s\n",
+         "wheel","kp","kd","kw","ki","rho","rho del","slow s","lean","cmd A","settle s");
+
+  // the stock PD law for reference
+  pd.kp = config.kp;
+  pd.kd = config.kd;
+  pd.kw = 0.0;
+  pd.ki = 0.0;
+  pd.flag_converged = true;
+  cosim::evaluate(config.plant,loop,&pd);
+  RWPLQR_printRow("PD",loop,pd,cosim::simulate(config.plant,loop,pd,0.0,impulse_Nms,RWPLQR_RESPONSE_sec));
+
+  for(row=0;row<RWPLQR_NUM_ROWS;row++)
+    {
+      cosim::LqrWeights rowWeights = weights;
+      cosim::LqrGains rowGains;
+      char name[16];
+
+      rowWeights.wheel_krpm = wheelWeights_krpm[row];
+      cosim::design(config.plant,loop,rowWeights,&rowGains);
+
+      if(wheelWeights_krpm[row] == 0.0)
+        {
+          snprintf(name,sizeof(name),"out");
+        }
+      else
+        {
+          snprintf(name,sizeof(name),"%.2f krpm",wheelWeights_krpm[row]);
+        }
+
+      RWPLQR_printRow(name,loop,rowGains,cosim::simulate(config.plant,loop,rowGains,0.0,impulse_Nms,RWPLQR_RESPONSE_sec));
+    }
+
+  cosim::design(config.plant,loop,weights,&gains);
+
+  printf("\nchosen, wheel %.3g krpm: kp %.4f kd %.4f kw %.4f ki %.4f\n",
+         weights.wheel_krpm,gains.kp,gains.kd,gains.kw,gains.ki);
+  if(!gains.flag_converged)
+    {
+      printf("the Riccati recursion did not converge\n");
+    }
+  if(gains.rhoDelayed >= 1.0)
+    {
+      printf("unstable with the delay, spectral radius %.4f\n",gains.rhoDelayed);
+    }
+
+  printf("\nsetpoint %.2f deg off, %.0f s\n",step_deg,RWPLQR_RESPONSE_sec);
+  RWPLQR_printResponse("PD",cosim::simulate(config.plant,loop,pd,step_deg,0.0,RWPLQR_RESPONSE_sec));
+  RWPLQR_printResponse("chosen",cosim::simulate(config.plant,loop,gains,step_deg,0.0,RWPLQR_RESPONSE_sec));
+
+  printf("\nimpulse of %.4f Nms, %.0f s\n",impulse_Nms,RWPLQR_RESPONSE_sec);
+  RWPLQR_printResponse("PD",cosim::simulate(config.plant,loop,pd,0.0,impulse_Nms,RWPLQR_RESPONSE_sec));
+  RWPLQR_printResponse("chosen",cosim::simulate(config.plant,loop,gains,0.0,impulse_Nms,RWPLQR_RESPONSE_sec));
+
+  if(check_sec > 0.0)
+    {
+      printf("\nco-simulation, %.1f s\n",check_sec);
+      config.run_sec = check_sec;
+      RWPLQR_runCosim("PD",config);
+
+      config.kp = gains.kp;
+      config.kd = gains.kd;
+      config.kw = gains.kw;
+      config.ki = gains.ki;
+      RWPLQR_runCosim("chosen",config);
+    }
+
+  return((gains.flag_converged && (gains.rhoDelayed < 1.0)) ? 0 : 1);
+} // end of main() function
+
+
+// end of file
@@ -0,0 +1,186 @@
+//! \file   rwpsweep.cpp
+//! \brief  Runs the Monte-Carlo balance gain sweep from the command line
+//!
+//!         Prints the success rate and the mean peak motor current over the
+//!         (kp, kd) grid, kd down and kp across, and optionally writes every
+//!         grid point to a CSV file.  See sweep.h for what is randomized.
+//!
+//!         Build from this directory:
+//!
+//!           cc -O2 -I../../proj_lab05a -I../iqmath -I../hostsim -c ../hostsim/pmsm.c ../hostsim/halsim.c ../hostsim/focsim.c ../../proj_lab05a/cmdlink.c
+//!           c++ -O2 -std=c++11 -pthread -I../../proj_lab05a -I../../rwp-1 -I../iqmath -I../hostsim -o rwpsweep rwpsweep.cpp sweep.cpp pool.cpp cosim.cpp plant.cpp pmsm.o halsim.o focsim.o cmdlink.o -lm
+//!
+//!         Usage:
+//!
+//!           rwpsweep [-P kpMin,kpMax,numKp] [-D kdMin,kdMax,numKd] [-N runsPerPoint]
+//!                    [-t run_sec] [-k kick_Nm] [-j threads] [-s seed] [-o out.csv]
+//!
+//!         The defaults, 108 grid points of 100 runs of 3 s, are a 10800 run
+//!         sweep.
+
+
+// **************************************************************************
+// the includes
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "sweep.h"
+
+
+// **************************************************************************
+// the functions
+
+static void RWPSWEEP_usage(const char *pName)
+{
+  fprintf(stderr,
+          "usage: %s [-P kpMin,kpMax,numKp] [-D kdMin,kdMax,numKd] [-N runsPerPoint]\n"
+          "          [-t run_sec] [-k kick_Nm] [-j threads] [-s seed] [-o out.csv]\n",
+          pName);
+
+  return;
+} // end of RWPSWEEP_usage() function
+
+
+static bool RWPSWEEP_parseRange(const char *pArg,double *pMin,double *pMax,unsigned int *pNum)
+{
+  return((sscanf(pArg,"%lf,%lf,%u",pMin,pMax,pNum) == 3) && (*pNum != 0));
+} // end of RWPSWEEP_parseRange() function
+
+
+static double RWPSWEEP_getTime_sec(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC,&now);
+
+  return((double)now.tv_sec + (double)now.tv_nsec * 1.0e-9);
+} // end of RWPSWEEP_getTime_sec() function
+
+
+int main(int argc,char *argv[])
+{
+  cosim::Config config;
+  cosim::SweepGrid grid;
+  cosim::SweepSpread spread;
+  std::vector<cosim::SweepCell> cells;
+  const char *pOutName = NULL;
+  unsigned int numThreads = 0;
+  unsigned int row, col;
+  double start_sec, elapsed_sec;
+  int arg;
+
+
+  cosim::setDefaultConfig(&config);
+  cosim::setDefaultGrid(&grid);
+  cosim::setDefaultSpread(&spread);
+  config.run_sec = 3.0;
+
+  for(arg=1;arg<argc;arg++)
+    {
+      bool flag_ok = true;
+
+      if((argv[arg][0] != '-') || (argv[arg][1] == '\0') || (argv[arg][2] != '\0') || (arg + 1 >= argc))
+        {
+          RWPSWEEP_usage(argv[0]);
+          return(2);
+        }
+
+      switch(argv[arg++][1])
+        {
+          case 'P': flag_ok = RWPSWEEP_parseRange(argv[arg],&grid.kpMin,&grid.kpMax,&grid.numKp); break;
+          case 'D': flag_ok = RWPSWEEP_parseRange(argv[arg],&grid.kdMin,&grid.kdMax,&grid.numKd); break;
+          case 'N': grid.runsPerPoint = (unsigned int)strtoul(argv[arg],NULL,0); break;
+          case 't': config.run_sec = atof(argv[arg]); break;
+          case 'k': config.kick_Nm = atof(argv[arg]); break;
+          case 'j': numThreads = (unsigned int)strtoul(argv[arg],NULL,0); break;
+          case 's': grid.seed = (uint32_t)strtoul(argv[arg],NULL,0); break;
+          case 'o': pOutName = argv[arg]; break;
+          default: flag_ok = false; break;
+        }
+
+      if(!flag_ok)
+        {
+          RWPSWEEP_usage(argv[0]);
+          return(2);
+        }
+    }
+
+  if((grid.runsPerPoint == 0) || (config.run_sec <= 0.0))
+    {
+      RWPSWEEP_usage(argv[0]);
+      return(2);
+    }
+
+  cosim::WorkPool pool(numThreads);
+
+  fprintf(stderr,"%u x %u points, %u runs each, %.1f s per run, %u threads\n",
+          grid.numKp,grid.numKd,grid.runsPerPoint,config.run_sec,pool.getNumThreads());
+
+  start_sec = RWPSWEEP_getTime_sec();
+  cells = cosim::sweep(config,grid,spread,pool);
+  elapsed_sec = RWPSWEEP_getTime_sec() - start_sec;
+
+  printf("success rate, %%\n%8s","kd \\ kp");
+  for(col=0;col<grid.numKp;col++)
+    {
+      printf(" %7.2f",cells[col].kp);
+    }
+  printf("\n");
+  for(row=0;row<grid.numKd;row++)
+    {
+      printf("%8.2f",cells[row * grid.numKp].kd);
+      for(col=0;col<grid.numKp;col++)
+        {
+          printf(" %7.1f",100.0 * cells[row * grid.numKp + col].successRate);
+        }
+      printf("\n");
+    }
+
+  printf("\nmean peak current, A\n%8s","kd \\ kp");
+  for(col=0;col<grid.numKp;col++)
+    {
+      printf(" %7.2f",cells[col].kp);
+    }
+  printf("\n");
+  for(row=0;row<grid.numKd;row++)
+    {
+      printf("%8.2f",cells[row * grid.numKp].kd);
+      for(col=0;col<grid.numKp;col++)
+        {
+          printf(" %7.2f",cells[row * grid.numKp + col].meanPeakIq_A);
+        }
+      printf("\n");
+    }
+
+  printf("\n%lu runs in %.1f s\n",
+         (unsigned long)cells.size() * grid.runsPerPoint,elapsed_sec);
+
+  if(pOutName != NULL)
+    {
+      FILE *pOut = fopen(pOutName,"w");
+      size_t cnt;
+
+      if(pOut == NULL)
+        {
+          perror(pOutName);
+          return(1);
+        }
+
+      fprintf(pOut,"kp,kd,runs,balanced,success,meanPeakIq_A,maxPeakIq_A\n");
+      for(cnt=0;cnt<cells.size();cnt++)
+        {
+          fprintf(pOut,"%.4f,%.4f,%lu,%lu,%.4f,%.4f,%.4f\n",
+                  cells[cnt].kp,cells[cnt].kd,cells[cnt].numRuns,cells[cnt].numBalanced,
+                  cells[cnt].successRate,cells[cnt].meanPeakIq_A,cells[cnt].maxPeakIq_A);
+        }
+
+      fclose(pOut);
+    }
+
+  return(0);
+} // end of main() function
+
+
+// end of file
@@ -0,0 +1,149 @@
+//! \file   sweep.cpp
+//! \brief  Contains the Monte-Carlo gain sweep
+//!
+
+
+// **************************************************************************
+// the includes
+
+#include "sweep.h"
+
+
+namespace cosim
+{
+
+
+// **************************************************************************
+// the functions
+
+//! \brief Returns the next value of a splitmix64 sequence
+static uint64_t SWEEP_next(uint64_t *pState)
+{
+  uint64_t z = (*pState += 0x9E3779B97F4A7C15ULL);
+
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+
+  return(z ^ (z >> 31));
+} // end of SWEEP_next() function
+
+
+//! \brief Returns a uniform value in [lo, hi)
+static double SWEEP_uniform(uint64_t *pState,const double lo,const double hi)
+{
+  double u = (double)(SWEEP_next(pState) >> 11) / 9007199254740992.0;
+
+  return(lo + (hi - lo) * u);
+} // end of SWEEP_uniform() function
+
+
+//! \brief Returns grid point cnt of num from min to max
+static double SWEEP_getPoint(const double min,const double max,const unsigned int num,const unsigned int cnt)
+{
+  return((num > 1) ? (min + (max - min) * (double)cnt / (double)(num - 1)) : min);
+} // end of SWEEP_getPoint() function
+
+
+void setDefaultGrid(SweepGrid *pGrid)
+{
+  // 108 points of 100 runs
+  pGrid->kpMin = 4.0;
+  pGrid->kpMax = 36.0;
+  pGrid->numKp = 9;
+  pGrid->kdMin = -11.0;
+  pGrid->kdMax = 0.0;
+  pGrid->numKd = 12;
+  pGrid->runsPerPoint = 100;
+  pGrid->seed = 1;
+
+  return;
+} // end of setDefaultGrid() function
+
+
+void setDefaultSpread(SweepSpread *pSpread)
+{
+  pSpread->inertia_pct = 30.0;
+  pSpread->friction_pct = 50.0;
+  pSpread->gyroNoiseMax_dps = 0.2;
+  pSpread->latencyMax_us = 2000.0;
+  pSpread->initialAngleMax_deg = 3.0;
+
+  return;
+} // end of setDefaultSpread() function
+
+
+std::vector<SweepCell> sweep(const Config &base,const SweepGrid &grid,
+                             const SweepSpread &spread,WorkPool &pool)
+{
+  const size_t numCells = (size_t)grid.numKp * grid.numKd;
+  const size_t numRuns = numCells * grid.runsPerPoint;
+  std::vector<Result> results(numRuns);
+  std::vector<SweepCell> cells(numCells);
+  size_t cnt, num;
+
+
+  pool.run(numRuns,[&](size_t index)
+    {
+      const size_t cell = index / grid.runsPerPoint;
+      const double inertia = spread.inertia_pct * 0.01;
+      const double friction = spread.friction_pct * 0.01;
+      uint64_t state = ((uint64_t)grid.seed << 32) ^ (uint64_t)index;
+      Config config = base;
+
+
+      config.kp = SWEEP_getPoint(grid.kpMin,grid.kpMax,grid.numKp,(unsigned int)(cell % grid.numKp));
+      config.kd = SWEEP_getPoint(grid.kdMin,grid.kdMax,grid.numKd,(unsigned int)(cell / grid.numKp));
+
+      config.plant.Jp_kgm2 *= SWEEP_uniform(&state,1.0 - inertia,1.0 + inertia);
+      config.plant.Jw_kgm2 *= SWEEP_uniform(&state,1.0 - inertia,1.0 + inertia);
+      config.plant.motor.B_Nmps *= SWEEP_uniform(&state,1.0 - friction,1.0 + friction);
+      config.plant.motor.Tc_Nm *= SWEEP_uniform(&state,1.0 - friction,1.0 + friction);
+      config.gyroNoise_dps = SWEEP_uniform(&state,0.0,spread.gyroNoiseMax_dps);
+      config.compute_us += SWEEP_uniform(&state,0.0,spread.latencyMax_us);
+      config.initialAngle_deg = SWEEP_uniform(&state,-spread.initialAngleMax_deg,spread.initialAngleMax_deg);
+      config.dmpPhase_us = SWEEP_uniform(&state,0.0,1.0e6 / config.dmpRate_Hz);
+      config.seed = (uint32_t)SWEEP_next(&state);
+
+      results[index] = cosim::run(config,NULL,1);
+    });
+
+  // reduce in index order so the sums do not depend on the schedule
+  for(cnt=0;cnt<numCells;cnt++)
+    {
+      SweepCell &out = cells[cnt];
+      double peakSum = 0.0;
+
+      out.kp = SWEEP_getPoint(grid.kpMin,grid.kpMax,grid.numKp,(unsigned int)(cnt % grid.numKp));
+      out.kd = SWEEP_getPoint(grid.kdMin,grid.kdMax,grid.numKd,(unsigned int)(cnt / grid.numKp));
+      out.numRuns = grid.runsPerPoint;
+      out.numBalanced = 0;
+      out.maxPeakIq_A = 0.0;
+
+      for(num=0;num<grid.runsPerPoint;num++)
+        {
+          const Result &result = results[cnt * grid.runsPerPoint + num];
+
+          if(!result.flag_fallen)
+            {
+              out.numBalanced++;
+            }
+
+          peakSum += result.maxIq_A;
+          if(result.maxIq_A > out.maxPeakIq_A)
+            {
+              out.maxPeakIq_A = result.maxIq_A;
+            }
+        }
+
+      out.successRate = (out.numRuns != 0) ? (double)out.numBalanced / (double)out.numRuns : 0.0;
+      out.meanPeakIq_A = (out.numRuns != 0) ? peakSum / (double)out.numRuns : 0.0;
+    }
+
+  return(cells);
+} // end of sweep() function
+
+
+} // end of cosim namespace
+
+
+// end of file
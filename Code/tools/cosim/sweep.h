@@ -0,0 +1,97 @@
+#ifndef _SWEEP_H_
+#define _SWEEP_H_
+
+//! \file   sweep.h
+//! \brief  Contains the public interface to the Monte-Carlo gain sweep
+//!
+//!         Every (kp, kd) grid point runs a number of co-simulations, each
+//!         with the pendulum and wheel inertias, the wheel friction, the gyro
+//!         noise, the Teensy to F28069 latency and the initial tilt drawn at
+//!         random around the base settings.  The draws depend only on the
+//!         sweep seed and the run index, never on the thread that ran it, so
+//!         a sweep gives the same maps on any number of cores.
+
+
+// **************************************************************************
+// the includes
+
+#include <vector>
+
+#include "cosim.h"
+#include "pool.h"
+
+
+namespace cosim
+{
+
+
+// **************************************************************************
+// the typedefs
+
+//! \brief Defines the gain grid
+//!
+struct SweepGrid
+{
+  double        kpMin;           //!< the first kp
+  double        kpMax;           //!< the last kp
+  unsigned int  numKp;           //!< the kp points
+  double        kdMin;           //!< the first kd
+  double        kdMax;           //!< the last kd
+  unsigned int  numKd;           //!< the kd points
+  unsigned int  runsPerPoint;    //!< the randomized runs at every grid point
+  uint32_t      seed;            //!< the sweep seed
+};
+
+
+//! \brief Defines the randomization around the base settings
+//!
+struct SweepSpread
+{
+  double  inertia_pct;           //!< Jp and Jw, uniform within +- this percentage
+  double  friction_pct;          //!< the viscous and Coulomb friction, uniform within +- this percentage
+  double  gyroNoiseMax_dps;      //!< the RMS gyro noise, uniform from zero to this
+  double  latencyMax_us;         //!< added Teensy compute and serial write time, uniform from zero to this
+  double  initialAngleMax_deg;   //!< the initial tilt, uniform within +- this
+};
+
+
+//! \brief Defines the results at one grid point
+//!
+struct SweepCell
+{
+  double        kp;              //!< the proportional gain
+  double        kd;              //!< the derivative gain
+  unsigned long numRuns;         //!< the runs
+  unsigned long numBalanced;     //!< the runs that did not fall
+  double        successRate;     //!< numBalanced / numRuns
+  double        meanPeakIq_A;    //!< the mean over the runs of the largest motor current
+  double        maxPeakIq_A;     //!< the largest motor current of any run
+};
+
+
+// **************************************************************************
+// the function prototypes
+
+//! \brief      Sets the default grid, around the rwp-1 gains
+//! \param[out] pGrid  A pointer to the grid
+void setDefaultGrid(SweepGrid *pGrid);
+
+
+//! \brief      Sets the default randomization
+//! \param[out] pSpread  A pointer to the randomization
+void setDefaultSpread(SweepSpread *pSpread);
+
+
+//! \brief     Runs the sweep
+//! \param[in] base    The settings the runs are randomized around, its kp and kd are replaced
+//! \param[in] grid    The gain grid
+//! \param[in] spread  The randomization
+//! \param[in] pool    The pool to run on
+//! \return    The grid points, kd major, numKd rows of numKp
+std::vector<SweepCell> sweep(const Config &base,const SweepGrid &grid,
+                             const SweepSpread &spread,WorkPool &pool);
+
+
+} // end of cosim namespace
+
+#endif // end of _SWEEP_H_ definition
@@ -0,0 +1,850 @@
+//! \file   drvspitest.c
+//! \brief  Checks the DRV8305 SPI transaction queue (see drvspi.h) on the
+//!         host against a scripted SPI and DRV8305 stub, and times it
+//!
+//!         Build on Linux from this directory with
+//!
+//!           cc -O2 -I../../proj_lab05a -o drvspitest drvspitest.c
+//!              ../../proj_lab05a/drvspi.c
+//!
+//!         Usage
+//!
+//!           drvspitest [-n num] [-r repeats] [-s seed]
+//!
+//!         Each background loop pass is run as HAL_runDrvSpi() does it: take
+//!         the reply if the receive FIFO has one, else check the timeout, then
+//!         start the next transfer.  The stub answers a frame a scripted number
+//!         of passes later, or never, and keeps the DRV8305 registers, with the
+//!         status faults cleared and CLR_FLTS dropped when CLR_FLTS is written.
+//!
+//!         The checks run first and the exit status is 1 if any fails:
+//!
+//!           - start and finish: the frames, writes ahead of reads lowest
+//!             register first, one transfer in flight, the reply masked into
+//!             the value and the counts
+//!           - the timeout: a transfer without reply is queued again after
+//!             DRVSPI_TIMEOUT_ms and not before, also across the ms wrap, and
+//!             a read answered while a write of the register waits keeps the
+//!             written value
+//!           - the status registers read round robin, one per pollPeriod_ms,
+//!             none with pollPeriod_ms 0, and the faults counted once per rise
+//!           - CLR_FLTS leaves the shadow once written, so the next clear is
+//!             sent again and a write without it is not
+//!           - the control registers are only written when they change
+//!           - num passes of random writes, reads and polls with replies late
+//!             by up to 3 passes or lost, after which the DRV8305 holds every
+//!             value written and the counts add up to the frames sent
+//!
+//!         The timings run repeats x num passes, idle and with a transfer
+//!         started and finished on each, and report nanoseconds per pass.
+//!         They are host figures; gBgLoop with and without DRV_SPI_QUEUE has
+//!         not been measured on the board.  For scale, the frame time from the
+//!         HAL_setupSpiA() clock is printed with what a blocking ReadCmd pass
+//!         waits for it.
+
+
+// **************************************************************************
+// the includes
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "drvspi.h"
+
+
+// **************************************************************************
+// the defines
+
+//! \brief Defines the SPI bit rate, LSPCLK 90 MHz over BRR + 1 = 14 in HAL_setupSpiA(), Hz
+//!
+#define DRVSPITEST_SPI_BIT_RATE_Hz  (90.0e6 / 14.0)
+
+//! \brief Defines the number of registers a blocking ReadCmd reads
+//!
+#define DRVSPITEST_NUM_READCMD      (11)
+
+//! \brief Defines the longest scripted reply delay, passes
+//!
+#define DRVSPITEST_MAX_DELAY        (3)
+
+//! \brief Defines the reply delay of a frame that is never answered
+//!
+#define DRVSPITEST_NO_REPLY         (-1)
+
+//! \brief Defines the status register fault bits the stub sets and clears
+//!
+#define DRVSPITEST_FAULT_BITS       (0x07FF)
+
+
+// **************************************************************************
+// the typedefs
+
+//! \brief Defines the scripted SPI and DRV8305 stub
+//!
+typedef struct _DRVSPITEST_Stub_t_
+{
+  uint16_t        reg[DRVSPI_NUM_REGS];     //!< the DRV8305 registers
+  int             delay;                    //!< the passes after the next one before the reply arrives, DRVSPITEST_NO_REPLY for none
+  uint16_t        reply;                    //!< the reply of the frame in flight
+  bool            flag_rx;                  //!< the receive FIFO holds the reply
+  int             script[8];                //!< the reply delays of the next frames, used in turn
+  int             numScript;                //!< the number of delays in the script, 0 for all next pass
+  int             nextScript;               //!< the next delay used
+  bool            flag_random;              //!< random delays instead of the script, one in 16 lost
+  uint16_t        frames[128];              //!< the first frames sent
+  uint32_t        frameTimes_ms[128];       //!< the times the first frames were sent, ms
+  unsigned long   numFrames;                //!< the number of frames sent
+  unsigned long   numLost;                  //!< the number of frames never answered
+} DRVSPITEST_Stub_t;
+
+
+// **************************************************************************
+// the globals
+
+static uint64_t gSeed = 0x9E3779B97F4A7C15ULL;
+
+static unsigned long gNumFailures = 0;
+
+static volatile uint32_t gSink;
+
+
+// **************************************************************************
+// the functions
+
+static uint32_t DRVSPITEST_rand(void)
+{
+  // xorshift64*
+  gSeed ^= gSeed >> 12;
+  gSeed ^= gSeed << 25;
+  gSeed ^= gSeed >> 27;
+
+  return((uint32_t)((gSeed * 0x2545F4914F6CDD1DULL) >> 32));
+} // end of DRVSPITEST_rand() function
+
+
+static void DRVSPITEST_fail(const char *pFormat,...)
+{
+  va_list args;
+
+
+  if(gNumFailures++ < 20)
+    {
+      va_start(args,pFormat);
+      fprintf(stderr,"drvspitest: ");
+      vfprintf(stderr,pFormat,args);
+      fprintf(stderr,"\n");
+      va_end(args);
+    }
+} // end of DRVSPITEST_fail() function
+
+
+static void DRVSPITEST_initStub(DRVSPITEST_Stub_t *pStub)
+{
+  memset(pStub,0,sizeof(*pStub));
+  pStub->delay = DRVSPITEST_NO_REPLY;
+
+  return;
+} // end of DRVSPITEST_initStub() function
+
+
+//! \brief Picks the reply delay of the next frame
+static int DRVSPITEST_pickDelay(DRVSPITEST_Stub_t *pStub)
+{
+  int delay = 0;
+
+
+  if(pStub->flag_random)
+    {
+      const uint32_t r = DRVSPITEST_rand();
+
+      delay = ((r & 15) == 0) ? DRVSPITEST_NO_REPLY : (int)((r >> 4) % (DRVSPITEST_MAX_DELAY + 1));
+    }
+  else if(pStub->numScript != 0)
+    {
+      delay = pStub->script[pStub->nextScript];
+      pStub->nextScript = (pStub->nextScript + 1) % pStub->numScript;
+    }
+
+  return(delay);
+} // end of DRVSPITEST_pickDelay() function
+
+
+//! \brief Sends a frame, as SPI_resetRxFifo() and SPI_write() in HAL_runDrvSpi()
+static void DRVSPITEST_send(DRVSPITEST_Stub_t *pStub,const uint16_t frame,const uint32_t now_ms)
+{
+  const uint_least16_t reg = (frame >> DRVSPI_ADDR_SHIFT) & (DRVSPI_NUM_REGS - 1);
+
+
+  if(pStub->numFrames < sizeof(pStub->frames) / sizeof(pStub->frames[0]))
+    {
+      pStub->frames[pStub->numFrames] = frame;
+      pStub->frameTimes_ms[pStub->numFrames] = now_ms;
+    }
+
+  // resetting the receive FIFO drops a late reply
+  pStub->numFrames++;
+  pStub->flag_rx = false;
+  pStub->delay = DRVSPITEST_pickDelay(pStub);
+
+  // a lost frame never reaches the DRV8305
+  if(pStub->delay == DRVSPITEST_NO_REPLY)
+    {
+      pStub->numLost++;
+      return;
+    }
+
+  pStub->reply = pStub->reg[reg];
+
+  if((frame & DRVSPI_READ_BIT) == 0)
+    {
+      pStub->reg[reg] = frame & DRVSPI_DATA_MASK;
+
+      // CLR_FLTS clears the faults and then itself
+      if((reg == DRVSPI_REG_CONTROL_9) && (frame & DRVSPI_CTRL09_CLR_FLTS))
+        {
+          uint_least16_t status;
+
+          for(status=0;status<DRVSPI_NUM_STATUS_REGS;status++)
+            {
+              pStub->reg[DRVSPI_REG_STATUS_1 + status] = 0;
+            }
+
+          pStub->reg[reg] &= ~DRVSPI_CTRL09_CLR_FLTS;
+        }
+    }
+
+  return;
+} // end of DRVSPITEST_send() function
+
+
+//! \brief Runs one background loop pass as HAL_runDrvSpi() does, without the commands
+static void DRVSPITEST_runPass(DRVSPI_Obj *pDrvSpi,DRVSPITEST_Stub_t *pStub,const uint32_t now_ms)
+{
+  uint_least16_t reg;
+  uint16_t frame;
+
+
+  // the reply arrives between passes
+  if(pStub->delay > 0)
+    {
+      pStub->delay--;
+    }
+  else if(pStub->delay == 0)
+    {
+      pStub->flag_rx = true;
+      pStub->delay = DRVSPITEST_NO_REPLY;
+    }
+
+  if(DRVSPI_isBusy(pDrvSpi))
+    {
+      if(pStub->flag_rx)
+        {
+          pStub->flag_rx = false;
+          DRVSPI_finish(pDrvSpi,pStub->reply,&reg);
+        }
+      else
+        {
+          DRVSPI_checkTimeout(pDrvSpi,now_ms);
+        }
+    }
+
+  if(DRVSPI_start(pDrvSpi,now_ms,&frame))
+    {
+      DRVSPITEST_send(pStub,frame,now_ms);
+    }
+
+  return;
+} // end of DRVSPITEST_runPass() function
+
+
+//! \brief Runs a pass every 100 us for a time
+static void DRVSPITEST_run(DRVSPI_Obj *pDrvSpi,DRVSPITEST_Stub_t *pStub,uint32_t *pNow_us,const uint32_t time_us)
+{
+  const uint32_t stop_us = *pNow_us + time_us;
+
+
+  while(*pNow_us != stop_us)
+    {
+      DRVSPITEST_runPass(pDrvSpi,pStub,*pNow_us / 1000);
+      *pNow_us += 100;
+    }
+
+  return;
+} // end of DRVSPITEST_run() function
+
+
+//! \brief Starts a transfer and checks its frame
+static void DRVSPITEST_expectStart(DRVSPI_Obj *pDrvSpi,const uint32_t now_ms,const uint16_t expected)
+{
+  uint16_t frame = 0;
+
+
+  if(!DRVSPI_start(pDrvSpi,now_ms,&frame) || (frame != expected))
+    {
+      DRVSPITEST_fail("start at %lu ms: frame 0x%04X, expected 0x%04X",(unsigned long)now_ms,frame,expected);
+    }
+
+  return;
+} // end of DRVSPITEST_expectStart() function
+
+
+static void DRVSPITEST_checkStartFinish(void)
+{
+  DRVSPI_Obj drvSpi;
+  uint_least16_t reg = 0;
+  uint16_t frame;
+
+
+  DRVSPI_init(&drvSpi,DRVSPI_DEFAULT_POLL_PERIOD_ms,0);
+
+  if(DRVSPI_start(&drvSpi,0,&frame) || DRVSPI_finish(&drvSpi,0,&reg))
+    {
+      DRVSPITEST_fail("start or finish with nothing queued");
+    }
+
+  DRVSPI_read(&drvSpi,0x2);
+  DRVSPI_write(&drvSpi,0x6,0xFFFF);
+  DRVSPI_read(&drvSpi,0xC);
+  DRVSPI_write(&drvSpi,0x5,0x123);
+
+  // writes first, lowest register first, the data masked
+  DRVSPITEST_expectStart(&drvSpi,1,(0x5 << DRVSPI_ADDR_SHIFT) | 0x123);
+
+  if(!DRVSPI_isBusy(&drvSpi) || DRVSPI_start(&drvSpi,1,&frame))
+    {
+      DRVSPITEST_fail("a second transfer started while one is in flight");
+    }
+
+  if(DRVSPI_finish(&drvSpi,0x7FF,&reg) || (drvSpi.numWrites != 1) || (DRVSPI_getValue(&drvSpi,0x5) != 0x123))
+    {
+      DRVSPITEST_fail("write finish: %lu writes, value 0x%03X",(unsigned long)drvSpi.numWrites,
+                      DRVSPI_getValue(&drvSpi,0x5));
+    }
+
+  DRVSPITEST_expectStart(&drvSpi,1,(0x6 << DRVSPI_ADDR_SHIFT) | DRVSPI_DATA_MASK);
+  DRVSPI_finish(&drvSpi,0,&reg);
+
+  DRVSPITEST_expectStart(&drvSpi,2,DRVSPI_READ_BIT | (0x2 << DRVSPI_ADDR_SHIFT));
+
+  if(!DRVSPI_finish(&drvSpi,0xFABC,&reg) || (reg != 0x2) || (DRVSPI_getValue(&drvSpi,0x2) != 0x2BC) ||
+     (drvSpi.numReads != 1))
+    {
+      DRVSPITEST_fail("read finish: register %u value 0x%03X, %lu reads",(unsigned)reg,DRVSPI_getValue(&drvSpi,0x2),
+                      (unsigned long)drvSpi.numReads);
+    }
+
+  DRVSPITEST_expectStart(&drvSpi,2,DRVSPI_READ_BIT | (0xC << DRVSPI_ADDR_SHIFT));
+
+  if(!DRVSPI_finish(&drvSpi,0x0155,&reg) || (reg != 0xC) || (DRVSPI_getValue(&drvSpi,0xC) != 0x155))
+    {
+      DRVSPITEST_fail("read finish of register 0xC");
+    }
+
+  if(DRVSPI_start(&drvSpi,3,&frame) || DRVSPI_finish(&drvSpi,0,&reg) || DRVSPI_isBusy(&drvSpi) ||
+     (drvSpi.numWrites != 2) || (drvSpi.numReads != 2) || (drvSpi.numTimeouts != 0))
+    {
+      DRVSPITEST_fail("queue not empty after four transfers");
+    }
+
+  return;
+} // end of DRVSPITEST_checkStartFinish() function
+
+
+static void DRVSPITEST_checkTimeout(void)
+{
+  DRVSPI_Obj drvSpi;
+  uint_least16_t reg = 0;
+
+
+  DRVSPI_init(&drvSpi,0,100);
+
+  // a read, 1 ms is not a timeout, 2 ms is
+  DRVSPI_read(&drvSpi,0x3);
+  DRVSPITEST_expectStart(&drvSpi,100,DRVSPI_READ_BIT | (0x3 << DRVSPI_ADDR_SHIFT));
+
+  if(DRVSPI_checkTimeout(&drvSpi,100) || DRVSPI_checkTimeout(&drvSpi,100 + DRVSPI_TIMEOUT_ms - 1))
+    {
+      DRVSPITEST_fail("read timed out early");
+    }
+
+  if(!DRVSPI_checkTimeout(&drvSpi,100 + DRVSPI_TIMEOUT_ms) || DRVSPI_isBusy(&drvSpi) || (drvSpi.numTimeouts != 1))
+    {
+      DRVSPITEST_fail("read did not time out after %d ms",DRVSPI_TIMEOUT_ms);
+    }
+
+  DRVSPITEST_expectStart(&drvSpi,102,DRVSPI_READ_BIT | (0x3 << DRVSPI_ADDR_SHIFT));
+  DRVSPI_finish(&drvSpi,0x0AA,&reg);
+
+  // a write, started just before the ms wrap
+  DRVSPI_write(&drvSpi,0xA,0x321);
+  DRVSPITEST_expectStart(&drvSpi,0xFFFFFFFFUL,(0xA << DRVSPI_ADDR_SHIFT) | 0x321);
+
+  if(DRVSPI_checkTimeout(&drvSpi,(uint32_t)(0xFFFFFFFFUL + DRVSPI_TIMEOUT_ms - 1)))
+    {
+      DRVSPITEST_fail("write timed out early across the wrap");
+    }
+
+  if(!DRVSPI_checkTimeout(&drvSpi,(uint32_t)(0xFFFFFFFFUL + DRVSPI_TIMEOUT_ms)) || (drvSpi.numTimeouts != 2))
+    {
+      DRVSPITEST_fail("write did not time out across the wrap");
+    }
+
+  DRVSPITEST_expectStart(&drvSpi,DRVSPI_TIMEOUT_ms - 1,(0xA << DRVSPI_ADDR_SHIFT) | 0x321);
+  DRVSPI_finish(&drvSpi,0,&reg);
+
+  if(DRVSPI_checkTimeout(&drvSpi,1000) || (drvSpi.numWrites != 1) || (drvSpi.numReads != 1))
+    {
+      DRVSPITEST_fail("timeout with nothing in flight");
+    }
+
+  // a read answered after a write of the register was queued
+  DRVSPI_read(&drvSpi,0x7);
+  DRVSPITEST_expectStart(&drvSpi,1000,DRVSPI_READ_BIT | (0x7 << DRVSPI_ADDR_SHIFT));
+  DRVSPI_write(&drvSpi,0x7,0x155);
+
+  if(!DRVSPI_finish(&drvSpi,0x2AA,&reg) || (DRVSPI_getValue(&drvSpi,0x7) != 0x155))
+    {
+      DRVSPITEST_fail("the read reply 0x2AA replaced the queued write 0x155, value 0x%03X",DRVSPI_getValue(&drvSpi,0x7));
+    }
+
+  DRVSPITEST_expectStart(&drvSpi,1000,(0x7 << DRVSPI_ADDR_SHIFT) | 0x155);
+
+  return;
+} // end of DRVSPITEST_checkTimeout() function
+
+
+static void DRVSPITEST_checkPoll(void)
+{
+  DRVSPI_Obj drvSpi;
+  DRVSPITEST_Stub_t stub;
+  uint32_t now_us = 0;
+  unsigned long numFrames;
+  unsigned long cnt;
+
+
+  DRVSPITEST_initStub(&stub);
+  DRVSPI_init(&drvSpi,DRVSPI_DEFAULT_POLL_PERIOD_ms,0);
+
+  // a fault from 200 to 500 ms and again from 700 ms
+  DRVSPITEST_run(&drvSpi,&stub,&now_us,200000);
+  stub.reg[DRVSPI_REG_STATUS_1] = DRVSPI_STATUS01_FAULT | 0x3;
+  DRVSPITEST_run(&drvSpi,&stub,&now_us,300000);
+  stub.reg[DRVSPI_REG_STATUS_1] = 0;
+  DRVSPITEST_run(&drvSpi,&stub,&now_us,200000);
+  stub.reg[DRVSPI_REG_STATUS_1] = DRVSPI_STATUS01_FAULT;
+  DRVSPITEST_run(&drvSpi,&stub,&now_us,300000);
+
+  // one status register every pollPeriod_ms from the first period on, 1 to 4 in turn
+  numFrames = 1000 / DRVSPI_DEFAULT_POLL_PERIOD_ms - 1;
+
+  if(stub.numFrames != numFrames)
+    {
+      DRVSPITEST_fail("%lu status reads in 1 s, expected %lu",stub.numFrames,numFrames);
+    }
+
+  for(cnt=0;(cnt<stub.numFrames) && (cnt<numFrames);cnt++)
+    {
+      const uint16_t expected = DRVSPI_READ_BIT | ((DRVSPI_REG_STATUS_1 + cnt % DRVSPI_NUM_STATUS_REGS) << DRVSPI_ADDR_SHIFT);
+
+      if((stub.frames[cnt] != expected) || (stub.frameTimes_ms[cnt] != (cnt + 1) * DRVSPI_DEFAULT_POLL_PERIOD_ms))
+        {
+          DRVSPITEST_fail("status read %lu: frame 0x%04X at %lu ms, expected 0x%04X at %lu ms",cnt,stub.frames[cnt],
+                          (unsigned long)stub.frameTimes_ms[cnt],expected,(cnt + 1) * DRVSPI_DEFAULT_POLL_PERIOD_ms);
+          break;
+        }
+    }
+
+  if((drvSpi.numFaults != 2) || !drvSpi.flag_fault ||
+     (DRVSPI_getValue(&drvSpi,DRVSPI_REG_STATUS_1) != DRVSPI_STATUS01_FAULT))
+    {
+      DRVSPITEST_fail("%lu faults counted, expected 2",(unsigned long)drvSpi.numFaults);
+    }
+
+  // pollPeriod_ms 0 stops the reads
+  drvSpi.pollPeriod_ms = 0;
+  numFrames = stub.numFrames;
+  DRVSPITEST_run(&drvSpi,&stub,&now_us,1000000);
+
+  if(stub.numFrames != numFrames)
+    {
+      DRVSPITEST_fail("%lu status reads with pollPeriod_ms 0",stub.numFrames - numFrames);
+    }
+
+  return;
+} // end of DRVSPITEST_checkPoll() function
+
+
+//! \brief Sets up a stub with random control registers and the queue with their values, as HAL_setupDrvSpiQueue()
+static void DRVSPITEST_setup(DRVSPI_Obj *pDrvSpi,DRVSPITEST_Stub_t *pStub,const uint_least16_t pollPeriod_ms)
+{
+  uint_least16_t reg;
+
+
+  DRVSPITEST_initStub(pStub);
+  DRVSPI_init(pDrvSpi,pollPeriod_ms,0);
+
+  for(reg=0;reg<DRVSPI_NUM_REGS;reg++)
+    {
+      if(DRVSPI_CONTROL_REGS & ((uint16_t)1 << reg))
+        {
+          pStub->reg[reg] = (uint16_t)(DRVSPITEST_rand() & DRVSPI_DATA_MASK);
+
+          if(reg == DRVSPI_REG_CONTROL_9)
+            {
+              pStub->reg[reg] &= ~DRVSPI_CTRL09_CLR_FLTS;
+            }
+
+          DRVSPI_setValue(pDrvSpi,reg,pStub->reg[reg]);
+        }
+    }
+
+  return;
+} // end of DRVSPITEST_setup() function
+
+
+static void DRVSPITEST_checkClearFaults(void)
+{
+  DRVSPI_Obj drvSpi;
+  DRVSPITEST_Stub_t stub;
+  uint32_t now_us = 0;
+  uint16_t ctrl9;
+  uint_least16_t status;
+
+
+  DRVSPITEST_setup(&drvSpi,&stub,0);
+  ctrl9 = stub.reg[DRVSPI_REG_CONTROL_9];
+
+  for(status=0;status<DRVSPI_NUM_STATUS_REGS;status++)
+    {
+      stub.reg[DRVSPI_REG_STATUS_1 + status] = (uint16_t)(DRVSPITEST_rand() & DRVSPITEST_FAULT_BITS) | 1;
+    }
+
+  // the clear is sent once, and leaves the shadow
+  if(!DRVSPI_update(&drvSpi,DRVSPI_REG_CONTROL_9,ctrl9 | DRVSPI_CTRL09_CLR_FLTS))
+    {
+      DRVSPITEST_fail("CLR_FLTS not queued");
+    }
+
+  DRVSPITEST_run(&drvSpi,&stub,&now_us,5000);
+
+  if((stub.numFrames != 1) || (stub.frames[0] != ((DRVSPI_REG_CONTROL_9 << DRVSPI_ADDR_SHIFT) | ctrl9 | DRVSPI_CTRL09_CLR_FLTS)))
+    {
+      DRVSPITEST_fail("CLR_FLTS: %lu frames, the first 0x%04X",stub.numFrames,stub.frames[0]);
+    }
+
+  if((stub.reg[DRVSPI_REG_STATUS_1] != 0) || (DRVSPI_getValue(&drvSpi,DRVSPI_REG_CONTROL_9) != ctrl9))
+    {
+      DRVSPITEST_fail("CLR_FLTS: status 1 0x%03X, control 9 shadow 0x%03X, expected 0x%03X",stub.reg[DRVSPI_REG_STATUS_1],
+                      DRVSPI_getValue(&drvSpi,DRVSPI_REG_CONTROL_9),ctrl9);
+    }
+
+  // the same value without the clear is not sent, the next clear is
+  if(DRVSPI_update(&drvSpi,DRVSPI_REG_CONTROL_9,ctrl9))
+    {
+      DRVSPITEST_fail("control 9 written again without a change");
+    }
+
+  if(!DRVSPI_update(&drvSpi,DRVSPI_REG_CONTROL_9,ctrl9 | DRVSPI_CTRL09_CLR_FLTS))
+    {
+      DRVSPITEST_fail("the second CLR_FLTS not queued");
+    }
+
+  DRVSPITEST_run(&drvSpi,&stub,&now_us,5000);
+
+  if((stub.numFrames != 2) || (stub.frames[1] != stub.frames[0]) || (stub.reg[DRVSPI_REG_CONTROL_9] != ctrl9))
+    {
+      DRVSPITEST_fail("the second CLR_FLTS: %lu frames",stub.numFrames);
+    }
+
+  return;
+} // end of DRVSPITEST_checkClearFaults() function
+
+
+static void DRVSPITEST_checkWriteOnChange(void)
+{
+  DRVSPI_Obj drvSpi;
+  DRVSPITEST_Stub_t stub;
+  uint32_t now_us = 0;
+  const uint16_t ctrl7 = (uint16_t)(DRVSPITEST_rand() & DRVSPI_DATA_MASK);
+  uint_least16_t reg;
+  unsigned long numReads = 0;
+
+
+  DRVSPITEST_setup(&drvSpi,&stub,0);
+  stub.reg[0x7] = (ctrl7 ^ 0x001) & DRVSPI_DATA_MASK;
+  DRVSPI_setValue(&drvSpi,0x7,stub.reg[0x7]);
+
+  // a WriteCmd, as HAL_runDrvSpi() queues it, with only control 7 changed
+  for(reg=0;reg<DRVSPI_NUM_REGS;reg++)
+    {
+      if(DRVSPI_CONTROL_REGS & ((uint16_t)1 << reg))
+        {
+          const uint16_t data = (reg == 0x7) ? ctrl7 : stub.reg[reg];
+
+          if(DRVSPI_update(&drvSpi,reg,data) != (reg == 0x7))
+            {
+              DRVSPITEST_fail("control %X %s",(unsigned)reg,(reg == 0x7) ? "not written on a change" : "written unchanged");
+            }
+        }
+    }
+
+  DRVSPITEST_run(&drvSpi,&stub,&now_us,10000);
+
+  if((stub.numFrames != 1) || (stub.frames[0] != ((0x7 << DRVSPI_ADDR_SHIFT) | ctrl7)) || (stub.reg[0x7] != ctrl7))
+    {
+      DRVSPITEST_fail("WriteCmd sent %lu frames, expected the one write of control 7",stub.numFrames);
+    }
+
+  // a ReadCmd reads the status and control registers, and writes nothing
+  for(reg=0;reg<DRVSPI_NUM_REGS;reg++)
+    {
+      if((DRVSPI_STATUS_REGS | DRVSPI_CONTROL_REGS) & ((uint16_t)1 << reg))
+        {
+          DRVSPI_read(&drvSpi,reg);
+          numReads++;
+        }
+    }
+
+  DRVSPITEST_run(&drvSpi,&stub,&now_us,10000);
+
+  if((numReads != DRVSPITEST_NUM_READCMD) || (stub.numFrames != 1 + numReads) || (drvSpi.numWrites != 1) ||
+     (drvSpi.numReads != numReads))
+    {
+      DRVSPITEST_fail("ReadCmd sent %lu frames, %lu reads",stub.numFrames - 1,(unsigned long)drvSpi.numReads);
+    }
+
+  for(reg=0;reg<DRVSPI_NUM_REGS;reg++)
+    {
+      if(((DRVSPI_STATUS_REGS | DRVSPI_CONTROL_REGS) & ((uint16_t)1 << reg)) &&
+         (DRVSPI_getValue(&drvSpi,reg) != stub.reg[reg]))
+        {
+          DRVSPITEST_fail("ReadCmd: register %X 0x%03X, the DRV8305 has 0x%03X",(unsigned)reg,
+                          DRVSPI_getValue(&drvSpi,reg),stub.reg[reg]);
+        }
+    }
+
+  return;
+} // end of DRVSPITEST_checkWriteOnChange() function
+
+
+//! \brief Picks a random control register
+static uint_least16_t DRVSPITEST_randControl(void)
+{
+  uint_least16_t reg;
+
+
+  do
+    {
+      reg = (uint_least16_t)(DRVSPITEST_rand() % DRVSPI_NUM_REGS);
+    } while((DRVSPI_CONTROL_REGS & ((uint16_t)1 << reg)) == 0);
+
+  return(reg);
+} // end of DRVSPITEST_randControl() function
+
+
+static void DRVSPITEST_checkRandom(const unsigned long num)
+{
+  DRVSPI_Obj drvSpi;
+  DRVSPITEST_Stub_t stub;
+  uint16_t expected[DRVSPI_NUM_REGS];
+  uint32_t now_us = 0;
+  uint_least16_t reg;
+  unsigned long cnt;
+
+
+  DRVSPITEST_setup(&drvSpi,&stub,DRVSPI_DEFAULT_POLL_PERIOD_ms);
+  memcpy(expected,stub.reg,sizeof(expected));
+  stub.flag_random = true;
+
+  for(cnt=0;cnt<num;cnt++)
+    {
+      const uint32_t r = DRVSPITEST_rand();
+
+      if((r & 7) == 0)
+        {
+          // a changed setting, the fault clear now and then
+          const uint16_t data = (uint16_t)(DRVSPITEST_rand() & DRVSPI_DATA_MASK);
+
+          reg = DRVSPITEST_randControl();
+          DRVSPI_update(&drvSpi,reg,data);
+          expected[reg] = (reg == DRVSPI_REG_CONTROL_9) ? (data & ~DRVSPI_CTRL09_CLR_FLTS) : data;
+        }
+      else if((r & 255) == 1)
+        {
+          // a manual write, sent whether or not it changes
+          const uint16_t data = (uint16_t)(DRVSPITEST_rand() & DRVSPI_DATA_MASK & ~DRVSPI_CTRL09_CLR_FLTS);
+
+          reg = DRVSPITEST_randControl();
+          DRVSPI_write(&drvSpi,reg,data);
+          expected[reg] = data;
+        }
+      else if((r & 31) == 2)
+        {
+          DRVSPI_read(&drvSpi,(uint_least16_t)(DRVSPITEST_rand() % DRVSPI_NUM_REGS));
+        }
+      else if((r & 63) == 3)
+        {
+          stub.reg[DRVSPI_REG_STATUS_1 + (r >> 8) % DRVSPI_NUM_STATUS_REGS] |= (uint16_t)((r >> 16) & DRVSPITEST_FAULT_BITS);
+        }
+
+      // passes 20 to 400 us apart, so a late reply may also time out
+      DRVSPITEST_runPass(&drvSpi,&stub,now_us / 1000);
+      now_us += 20 + (r >> 20) % 381;
+    }
+
+  // drain with every reply on the next pass, long enough to poll each status register
+  stub.flag_random = false;
+  DRVSPITEST_run(&drvSpi,&stub,&now_us,(2 * DRVSPI_NUM_STATUS_REGS + 1) * DRVSPI_DEFAULT_POLL_PERIOD_ms * 1000);
+
+  for(reg=0;reg<DRVSPI_NUM_REGS;reg++)
+    {
+      if((DRVSPI_CONTROL_REGS & ((uint16_t)1 << reg)) && (stub.reg[reg] != expected[reg]))
+        {
+          DRVSPITEST_fail("random: control %X is 0x%03X, last written 0x%03X",(unsigned)reg,stub.reg[reg],expected[reg]);
+        }
+
+      if(((DRVSPI_STATUS_REGS | DRVSPI_CONTROL_REGS) & ((uint16_t)1 << reg)) &&
+         (DRVSPI_getValue(&drvSpi,reg) != stub.reg[reg]))
+        {
+          DRVSPITEST_fail("random: register %X value 0x%03X, the DRV8305 has 0x%03X",(unsigned)reg,
+                          DRVSPI_getValue(&drvSpi,reg),stub.reg[reg]);
+        }
+    }
+
+  // every frame sent was finished or timed out, and each lost one timed out
+  if(DRVSPI_isBusy(&drvSpi) || (drvSpi.writeMask != 0) || (drvSpi.readMask != 0) ||
+     (drvSpi.numReads + drvSpi.numWrites + drvSpi.numTimeouts != stub.numFrames) || (drvSpi.numTimeouts < stub.numLost))
+    {
+      DRVSPITEST_fail("random: %lu frames, %lu reads, %lu writes, %lu timeouts, %lu lost",stub.numFrames,
+                      (unsigned long)drvSpi.numReads,(unsigned long)drvSpi.numWrites,(unsigned long)drvSpi.numTimeouts,
+                      stub.numLost);
+    }
+
+  printf("random: %lu passes, %lu frames, %lu reads, %lu writes, %lu timeouts, %lu lost\n",num,stub.numFrames,
+         (unsigned long)drvSpi.numReads,(unsigned long)drvSpi.numWrites,(unsigned long)drvSpi.numTimeouts,stub.numLost);
+
+  return;
+} // end of DRVSPITEST_checkRandom() function
+
+
+static double DRVSPITEST_getTime(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC,&now);
+
+  return((double)now.tv_sec + 1.0e-9 * (double)now.tv_nsec);
+} // end of DRVSPITEST_getTime() function
+
+
+// the loop is not inlined so it is timed as written
+
+static __attribute__((noinline)) uint32_t DRVSPITEST_runPasses(DRVSPI_Obj *pDrvSpi,DRVSPITEST_Stub_t *pStub,
+                                                               const unsigned long num,const bool flag_busy)
+{
+  unsigned long cnt;
+
+
+  for(cnt=0;cnt<num;cnt++)
+    {
+      if(flag_busy)
+        {
+          DRVSPI_read(pDrvSpi,DRVSPI_REG_STATUS_1);
+        }
+
+      DRVSPITEST_runPass(pDrvSpi,pStub,(uint32_t)(cnt >> 4));
+    }
+
+  return(pDrvSpi->numReads);
+} // end of DRVSPITEST_runPasses() function
+
+
+static void DRVSPITEST_bench(const unsigned long num,const long numRepeats)
+{
+  const double frame_us = 16.0 * 1.0e6 / DRVSPITEST_SPI_BIT_RATE_Hz;
+  DRVSPI_Obj drvSpi;
+  DRVSPITEST_Stub_t stub;
+  double start;
+  double stop;
+  long repeat;
+  int k;
+
+
+  printf("%lu passes x %ld, with the stub\n",num,numRepeats);
+
+  for(k=0;k<2;k++)
+    {
+      DRVSPITEST_initStub(&stub);
+      DRVSPI_init(&drvSpi,0,0);
+
+      start = DRVSPITEST_getTime();
+      for(repeat=0;repeat<numRepeats;repeat++) gSink += DRVSPITEST_runPasses(&drvSpi,&stub,num,k != 0);
+      stop = DRVSPITEST_getTime();
+
+      printf("  %-16s %8.2f ns per pass\n",(k != 0) ? "a read each pass" : "idle",
+             (stop - start) * 1.0e9 / ((double)num * (double)numRepeats));
+    }
+
+  printf("a frame takes %.2f us at %.2f MHz; a blocking ReadCmd pass waits for %d, %.1f us, a queued pass for none\n",
+         frame_us,DRVSPITEST_SPI_BIT_RATE_Hz * 1.0e-6,DRVSPITEST_NUM_READCMD,DRVSPITEST_NUM_READCMD * frame_us);
+
+  return;
+} // end of DRVSPITEST_bench() function
+
+
+static void DRVSPITEST_usage(void)
+{
+  fprintf(stderr,"usage: drvspitest [-n num] [-r repeats] [-s seed]\n");
+} // end of DRVSPITEST_usage() function
+
+
+int main(int argc,char *argv[])
+{
+  unsigned long num = 1000000;
+  long numRepeats = 20;
+  int opt;
+
+
+  while((opt = getopt(argc,argv,"n:r:s:")) != -1)
+    {
+      switch(opt)
+        {
+          case 'n': num = strtoul(optarg,NULL,10); break;
+          case 'r': numRepeats = strtol(optarg,NULL,10); break;
+          case 's': gSeed = strtoull(optarg,NULL,0) | 1; break;
+          default:  DRVSPITEST_usage(); return(2);
+        }
+    }
+
+  if((optind != argc) || (num < 1) || (numRepeats < 1))
+    {
+      DRVSPITEST_usage();
+      return(2);
+    }
+
+  DRVSPITEST_checkStartFinish();
+  DRVSPITEST_checkTimeout();
+  DRVSPITEST_checkPoll();
+  DRVSPITEST_checkClearFaults();
+  DRVSPITEST_checkWriteOnChange();
+  DRVSPITEST_checkRandom(num);
+
+  printf("checks: %lu failures\n",gNumFailures);
+
+  if(gNumFailures != 0)
+    {
+      return(1);
+    }
+
+  DRVSPITEST_bench(num,numRepeats);
+
+  return((gNumFailures != 0) ? 1 : 0);
+} // end of main() function
+
+
+// end of file
@@ -0,0 +1,497 @@
+//! \file   exciterun.c
+//! \brief  Runs a proj_lab05a excitation over the SCI-B command link and
+//!         records the synchronized response as CSV
+//!
+//!         Sends the settings as Excite frames, waiting for each ExciteAck
+//!         (see cmdlink.h and excite.h), starts the run and decodes the
+//!         telemetry (see telem.h) until the F28069 reports the run over.
+//!         During the run the firmware streams only the speed, Iq, the Iq
+//!         reference and the excitation, together on every log_decimation-th
+//!         tick from the first tick of the run, so each row has the input and
+//!         the response of the same ISR tick.  This is for a bench link with
+//!         a USB serial adapter in place of the Teensy.
+//!
+//!         Build on Linux from this directory with
+//!
+//!           cc -O2 -I../../proj_lab05a -o exciterun exciterun.c
+//!              ../../proj_lab05a/telem.c ../../proj_lab05a/cmdlink.c
+//!
+//!         Usage
+//!
+//!           exciterun [-b baud] [-r isr_Hz] [-m step|chirp|prbs|multisine]
+//!                     [-a amplitude_A] [-f start_Hz] [-F end_Hz] [-t duration_s]
+//!                     [-d log_decimation] <device> <out.csv>
+//!
+//!         The tick column counts ISR ticks from the first tick of the run.
+//!         At the default 115200 baud a 20 tick decimation, 500 samples per
+//!         second of the four channels, is about all the link carries.
+
+
+// **************************************************************************
+// the includes
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/select.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "cmdlink.h"
+#include "excite.h"
+#include "telem.h"
+
+
+// **************************************************************************
+// the defines
+
+//! \brief Defines the default ISR rate, Hz
+//!
+#define EXCITERUN_DEFAULT_ISR_Hz    (10000.0)
+
+//! \brief Defines how long to wait for an ExciteAck, s
+//!
+#define EXCITERUN_ACK_TIMEOUT_sec   (0.5)
+
+//! \brief Defines how long past the run length to wait for the end of run, s
+//!
+#define EXCITERUN_END_MARGIN_sec    (2.0)
+
+
+// **************************************************************************
+// the typedefs
+
+//! \brief Defines the link and the decoders
+//!
+typedef struct _EXCITERUN_Link_t_
+{
+  int               fd;                  //!< the serial port
+  CMDLINK_Decoder_t cmdDecoder;          //!< the Excite answer decoder
+  TELEM_Decoder_t   telemDecoder;        //!< the telemetry decoder
+  uint_least8_t     txSeq;               //!< the next Excite sequence number
+  FILE              *pOut;               //!< the CSV, NULL until the run starts
+  double            isrFreq_Hz;          //!< the ISR rate
+  unsigned int      decimation;          //!< the telemetry decimation of the run
+  int               flag_first;          //!< no telemetry frame recorded yet
+  unsigned long long ticks;              //!< the ticks since the start of the run
+  unsigned int      lastTick;            //!< the tick of the last recorded frame
+  unsigned long     numRows;             //!< the number of rows written
+} EXCITERUN_Link_t;
+
+
+// **************************************************************************
+// the globals
+
+static const char *EXCITERUN_modeNames[EXCITE_NumModes] =
+{
+  "off", "step", "chirp", "prbs", "multisine"
+};
+
+static volatile sig_atomic_t gFlag_stop = 0;
+
+
+// **************************************************************************
+// the functions
+
+static void EXCITERUN_onSignal(int sig)
+{
+  (void)sig;
+  gFlag_stop = 1;
+} // end of EXCITERUN_onSignal() function
+
+
+static speed_t EXCITERUN_getSpeed(const long baud)
+{
+  switch(baud)
+    {
+      case 115200:  return(B115200);
+      case 230400:  return(B230400);
+      case 460800:  return(B460800);
+      case 921600:  return(B921600);
+#ifdef B1000000
+      case 1000000: return(B1000000);
+#endif
+#ifdef B1500000
+      case 1500000: return(B1500000);
+#endif
+#ifdef B2000000
+      case 2000000: return(B2000000);
+#endif
+#ifdef B3000000
+      case 3000000: return(B3000000);
+#endif
+      default:      return(0);
+    }
+} // end of EXCITERUN_getSpeed() function
+
+
+static int EXCITERUN_open(const char *pPath,const long baud)
+{
+  struct termios tio;
+  speed_t speed = EXCITERUN_getSpeed(baud);
+  int fd;
+
+
+  if(speed == 0)
+    {
+      fprintf(stderr,"exciterun: unsupported baud rate %ld\n",baud);
+      return(-1);
+    }
+
+  fd = open(pPath,O_RDWR | O_NOCTTY);
+  if(fd < 0)
+    {
+      fprintf(stderr,"exciterun: %s: %s\n",pPath,strerror(errno));
+      return(-1);
+    }
+
+  if(tcgetattr(fd,&tio) != 0)
+    {
+      fprintf(stderr,"exciterun: %s: not a serial port\n",pPath);
+      close(fd);
+      return(-1);
+    }
+
+  cfmakeraw(&tio);
+  cfsetispeed(&tio,speed);
+  cfsetospeed(&tio,speed);
+  tio.c_cflag |= (CLOCAL | CREAD);
+  tio.c_cflag &= ~(CSTOPB | PARENB | CRTSCTS);
+  tio.c_cc[VMIN] = 0;
+  tio.c_cc[VTIME] = 0;
+
+  if(tcsetattr(fd,TCSANOW,&tio) != 0)
+    {
+      close(fd);
+      return(-1);
+    }
+
+  tcflush(fd,TCIOFLUSH);
+
+  return(fd);
+} // end of EXCITERUN_open() function
+
+
+//! \brief Records one telemetry frame once the run has started
+static void EXCITERUN_record(EXCITERUN_Link_t *pLink,const TELEM_Sample_t *pSample)
+{
+  int cnt;
+
+
+  // only the run frames carry the excitation
+  if((pLink->pOut == NULL) || !(pSample->mask & (1 << TELEM_Channel_Excite_A)))
+    {
+      return;
+    }
+
+  if(pLink->flag_first)
+    {
+      // the counters restart on the first tick, the first sample is on the last tick of the first decimation
+      pLink->flag_first = 0;
+      pLink->ticks = pLink->decimation - 1;
+    }
+  else
+    {
+      pLink->ticks += (pSample->tick - pLink->lastTick) & 0xFFFF;
+    }
+
+  pLink->lastTick = pSample->tick;
+
+  fprintf(pLink->pOut,"%llu",pLink->ticks);
+
+  for(cnt=0;cnt<TELEM_NumChannels;cnt++)
+    {
+      if(pSample->mask & (1 << cnt))
+        {
+          fprintf(pLink->pOut,",%.7f",(double)pSample->value[cnt] / 16777216.0);
+        }
+      else
+        {
+          fprintf(pLink->pOut,",");
+        }
+    }
+
+  fprintf(pLink->pOut,"\n");
+  pLink->numRows++;
+
+  return;
+} // end of EXCITERUN_record() function
+
+
+//! \brief Reads and decodes what arrived within timeout_sec, stops at the first command frame
+//! \return 1 with pFrame written, 0 on a timeout, -1 on an error
+static int EXCITERUN_poll(EXCITERUN_Link_t *pLink,const double timeout_sec,CMDLINK_Frame_t *pFrame)
+{
+  struct timeval tv;
+  fd_set fds;
+  uint8_t data;
+  int ready;
+
+
+  tv.tv_sec = (long)timeout_sec;
+  tv.tv_usec = (long)((timeout_sec - (double)tv.tv_sec) * 1.0e6);
+
+  for(;;)
+    {
+      TELEM_Sample_t sample;
+      uint_least8_t seq;
+      ssize_t num;
+
+      FD_ZERO(&fds);
+      FD_SET(pLink->fd,&fds);
+
+      // Linux select() counts tv down, so the loop keeps one overall timeout
+      ready = select(pLink->fd + 1,&fds,NULL,NULL,&tv);
+      if(ready < 0)
+        {
+          return((errno == EINTR) ? 0 : -1);
+        }
+      if(ready == 0)
+        {
+          return(0);
+        }
+
+      num = read(pLink->fd,&data,1);
+      if(num < 0)
+        {
+          return(-1);
+        }
+      if(num == 0)
+        {
+          continue;
+        }
+
+      // the telemetry and the answers share the link, feed both decoders
+      if(TELEM_decode(&pLink->telemDecoder,data,&sample,&seq))
+        {
+          EXCITERUN_record(pLink,&sample);
+        }
+
+      if(CMDLINK_decode(&pLink->cmdDecoder,data,pFrame))
+        {
+          return(1);
+        }
+    }
+} // end of EXCITERUN_poll() function
+
+
+//! \brief Sends one setting and waits for the answer
+//! \return 1 on an ExciteAck, 0 on an ExciteNack or no answer, -1 on an error
+static int EXCITERUN_set(EXCITERUN_Link_t *pLink,const EXCITE_Param_e param,const int32_t value)
+{
+  CMDLINK_Frame_t frame;
+  uint_least8_t buf[CMDLINK_FRAME_LENGTH];
+  uint8_t bytes[CMDLINK_FRAME_LENGTH];
+  uint_least8_t seq = pLink->txSeq;
+  int cnt;
+
+
+  frame.seq = seq;
+  frame.type = CMDLINK_Type_Excite;
+  frame.payload = CMDLINK_makeParamPayload(param,value);
+  pLink->txSeq = (pLink->txSeq + 1) & 0xFF;
+
+  CMDLINK_encode(buf,&frame);
+  for(cnt=0;cnt<CMDLINK_FRAME_LENGTH;cnt++)
+    {
+      bytes[cnt] = (uint8_t)buf[cnt];
+    }
+
+  if(write(pLink->fd,bytes,CMDLINK_FRAME_LENGTH) != CMDLINK_FRAME_LENGTH)
+    {
+      return(-1);
+    }
+
+  for(;;)
+    {
+      int result = EXCITERUN_poll(pLink,EXCITERUN_ACK_TIMEOUT_sec,&frame);
+
+      if(result <= 0)
+        {
+          return(result);
+        }
+
+      // skip the torque echoes and speed replies of anything else on the link
+      if((frame.seq == seq) &&
+         ((frame.type == CMDLINK_Type_ExciteAck) || (frame.type == CMDLINK_Type_ExciteNack)))
+        {
+          return((frame.type == CMDLINK_Type_ExciteAck) ? 1 : 0);
+        }
+    }
+} // end of EXCITERUN_set() function
+
+
+static void EXCITERUN_usage(void)
+{
+  fprintf(stderr,"usage: exciterun [-b baud] [-r isr_Hz] [-m step|chirp|prbs|multisine]\n"
+                 "                 [-a amplitude_A] [-f start_Hz] [-F end_Hz] [-t duration_s]\n"
+                 "                 [-d log_decimation] <device> <out.csv>\n");
+} // end of EXCITERUN_usage() function
+
+
+int main(int argc,char *argv[])
+{
+  static const char *paramNames[EXCITE_NumParams] =
+  {
+    "mode", "amplitude", "start frequency", "end frequency", "duration", "log decimation", "run"
+  };
+  EXCITERUN_Link_t link;
+  CMDLINK_Frame_t frame;
+  int32_t values[EXCITE_NumParams];
+  long baud = 115200;
+  double duration_sec = 2.0;
+  double waited_sec = 0.0;
+  int flag_done = 0;
+  int param;
+  int opt;
+  int cnt;
+
+
+  values[EXCITE_Param_Mode] = EXCITE_Mode_Chirp;
+  values[EXCITE_Param_Amplitude_mA] = 1000;
+  values[EXCITE_Param_StartFreq_mHz] = 1000;
+  values[EXCITE_Param_EndFreq_mHz] = 200000;
+  values[EXCITE_Param_LogDecimation] = 20;
+  link.isrFreq_Hz = EXCITERUN_DEFAULT_ISR_Hz;
+
+  while((opt = getopt(argc,argv,"b:r:m:a:f:F:t:d:")) != -1)
+    {
+      switch(opt)
+        {
+          case 'b': baud = strtol(optarg,NULL,10); break;
+          case 'r': link.isrFreq_Hz = strtod(optarg,NULL); break;
+          case 'm':
+            values[EXCITE_Param_Mode] = -1;
+            for(cnt=EXCITE_Mode_Step;cnt<EXCITE_NumModes;cnt++)
+              {
+                if(strcmp(optarg,EXCITERUN_modeNames[cnt]) == 0)
+                  {
+                    values[EXCITE_Param_Mode] = cnt;
+                  }
+              }
+            break;
+          case 'a': values[EXCITE_Param_Amplitude_mA] = (int32_t)(strtod(optarg,NULL) * 1000.0); break;
+          case 'f': values[EXCITE_Param_StartFreq_mHz] = (int32_t)(strtod(optarg,NULL) * 1000.0 + 0.5); break;
+          case 'F': values[EXCITE_Param_EndFreq_mHz] = (int32_t)(strtod(optarg,NULL) * 1000.0 + 0.5); break;
+          case 't': duration_sec = strtod(optarg,NULL); break;
+          case 'd': values[EXCITE_Param_LogDecimation] = (int32_t)strtol(optarg,NULL,10); break;
+          default:  EXCITERUN_usage(); return(2);
+        }
+    }
+
+  values[EXCITE_Param_Duration_ms] = (int32_t)(duration_sec * 1000.0 + 0.5);
+  values[EXCITE_Param_Run] = 1;
+
+  if(((argc - optind) != 2) || (values[EXCITE_Param_Mode] < 0) || (link.isrFreq_Hz <= 0.0) ||
+     (duration_sec <= 0.0) || (values[EXCITE_Param_LogDecimation] < 1))
+    {
+      EXCITERUN_usage();
+      return(2);
+    }
+
+  link.fd = EXCITERUN_open(argv[optind],baud);
+  if(link.fd < 0)
+    {
+      return(1);
+    }
+
+  CMDLINK_initDecoder(&link.cmdDecoder);
+  TELEM_initDecoder(&link.telemDecoder);
+  link.txSeq = 0;
+  link.pOut = NULL;
+  link.decimation = (unsigned int)values[EXCITE_Param_LogDecimation];
+  link.flag_first = 1;
+  link.ticks = 0;
+  link.lastTick = 0;
+  link.numRows = 0;
+
+  signal(SIGINT,EXCITERUN_onSignal);
+  signal(SIGTERM,EXCITERUN_onSignal);
+
+  // the settings, then the run
+  for(param=0;param<EXCITE_Param_Run;param++)
+    {
+      if(EXCITERUN_set(&link,(EXCITE_Param_e)param,values[param]) != 1)
+        {
+          fprintf(stderr,"exciterun: the %s setting was refused or not answered\n",paramNames[param]);
+          close(link.fd);
+          return(1);
+        }
+    }
+
+  link.pOut = fopen(argv[optind + 1],"w");
+  if(link.pOut == NULL)
+    {
+      fprintf(stderr,"exciterun: %s: %s\n",argv[optind + 1],strerror(errno));
+      close(link.fd);
+      return(1);
+    }
+
+  fprintf(link.pOut,"tick");
+  for(cnt=0;cnt<TELEM_NumChannels;cnt++)
+    {
+      static const char *channelNames[TELEM_NumChannels] =
+      {
+        "Speed_krpm", "Iq_A", "IqRef_A", "VdcBus_kV", "Torque_Nm", "Vd_pu", "Vq_pu", "Excite_A",
+        "WheelGain_krpmpsPerA", "WheelViscous_ApKrpm", "WheelCoulomb_A"
+      };
+
+      fprintf(link.pOut,",%s",channelNames[cnt]);
+    }
+  fprintf(link.pOut,"\n");
+
+  if(EXCITERUN_set(&link,EXCITE_Param_Run,1) != 1)
+    {
+      fprintf(stderr,"exciterun: the run was refused or not answered\n");
+      fclose(link.pOut);
+      close(link.fd);
+      return(1);
+    }
+
+  fprintf(stderr,"exciterun: %s, %.3f s\n",EXCITERUN_modeNames[values[EXCITE_Param_Mode]],duration_sec);
+
+  // record until the end of run notice
+  while(!gFlag_stop && !flag_done && (waited_sec < duration_sec + EXCITERUN_END_MARGIN_sec))
+    {
+      int result = EXCITERUN_poll(&link,0.1,&frame);
+
+      if(result < 0)
+        {
+          fprintf(stderr,"exciterun: read: %s\n",strerror(errno));
+          break;
+        }
+
+      if(result == 0)
+        {
+          waited_sec += 0.1;
+        }
+      else if((frame.type == CMDLINK_Type_ExciteAck) &&
+              (CMDLINK_getParamId(frame.payload) == EXCITE_Param_Run) &&
+              (CMDLINK_getParamValue(frame.payload) == 0))
+        {
+          flag_done = 1;
+        }
+    }
+
+  if(!flag_done)
+    {
+      // stop it rather than leave the motor excited
+      EXCITERUN_set(&link,EXCITE_Param_Run,0);
+      fprintf(stderr,"exciterun: no end of run, stopped\n");
+    }
+
+  fprintf(stderr,"exciterun: %lu rows, the time is the tick column / %.0f Hz, %lu crc errors\n",
+          link.numRows,link.isrFreq_Hz,
+          (unsigned long)(link.telemDecoder.numCrcErrors + link.cmdDecoder.numCrcErrors));
+
+  fclose(link.pOut);
+  close(link.fd);
+
+  return(flag_done ? 0 : 1);
+} // end of main() function
+
+
+// end of file
@@ -0,0 +1,643 @@
+//! \file   fricfit.c
+//! \brief  Fits the proj_lab05a friction feedforward table (see fric.h) to
+//!         recorded constant Iq step runs on the host
+//!
+//!         Build on Linux from this directory with
+//!
+//!           cc -O2 -I../../proj_lab05a -o fricfit fricfit.c -lm
+//!
+//!         Usage
+//!
+//!           fricfit [-r rate_Hz] [-s maxSpeed_krpm] [-p pointsPerKrpm] [-n minSamples]
+//!                   [-g gain_krpmpsPerA] [-o fric_table.c] [step_A:]<log> ...
+//!
+//!         Each log is one step run from rest at a constant Iq: one of the
+//!         Data/*.xlsm runs, read with unzip, or the worksheet XML or text
+//!         rows of speed_krpm it came from.  The Iq is taken from a leading
+//!         "<n>amp" in the file name unless given before a colon, so
+//!
+//!           fricfit -o ../../proj_lab05a/fric_table.c ../../../Data/*amp-500hz.xlsm
+//!                   ../../../Data/*amp-500hz-2.xlsm
+//!
+//!         makes the table in the tree.  The rows are taken as evenly spaced
+//!         at rate_Hz.
+//!
+//!         On the way up each run follows
+//!
+//!           dw/dt = gain * (Iq - friction(w))
+//!
+//!         The rise is cut into one speed bin per table point and the
+//!         acceleration of each run in each bin is the slope of a straight
+//!         line through its samples there.  Runs at different Iq that pass
+//!         through the same bin give the gain, from the spread of their
+//!         accelerations against the spread of their Iq, and with the gain
+//!         each run gives the friction in the bin, Iq less acceleration over
+//!         gain, averaged over the runs weighted by their samples.  -g fixes
+//!         the gain instead, for a single run.
+//!
+//!         The runs logged the Iq reference, which the current loop cannot
+//!         hold once it runs out of voltage near the top speed, so the rise
+//!         is cut at maxSpeed_krpm.  The table holds its last point beyond
+//!         it.  The first point is 0 A at 0 krpm, so the feedforward ramps
+//!         through zero speed.
+//!
+//!         The fit prints the gain, the table and the RMS acceleration error
+//!         over the bins with the table and with no friction at all.  The
+//!         runs logged no angle, so the cogging table is written empty.
+
+
+// **************************************************************************
+// the includes
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "fric.h"
+
+
+// **************************************************************************
+// the defines
+
+//! \brief Defines the rate of the recorded runs, Hz
+//!
+#define FRICFIT_DEFAULT_RATE_Hz         (500.0)
+
+//! \brief Defines the speed the rise is cut at, below where the recorded runs ran out of voltage, krpm
+//!
+#define FRICFIT_DEFAULT_MAX_SPEED_krpm  (7.0)
+
+//! \brief Defines the default table points per krpm
+//!
+#define FRICFIT_DEFAULT_POINTS_PER_krpm (4)
+
+//! \brief Defines the default fewest samples a run needs in a bin
+//!
+#define FRICFIT_DEFAULT_MIN_SAMPLES     (5)
+
+//! \brief Defines the largest number of runs
+//!
+#define FRICFIT_MAX_RUNS                (32)
+
+//! \brief Defines the largest log, bytes
+//!
+#define FRICFIT_MAX_LOG_LENGTH          (64L * 1024L * 1024L)
+
+
+// **************************************************************************
+// the typedefs
+
+//! \brief Defines one run in one bin
+//!
+typedef struct _FRICFIT_Bin_t_
+{
+  double  sumT;                  //!< the sum of the sample times
+  double  sumW;                  //!< the sum of the speeds
+  double  sumTT;                 //!< the sum of the times squared
+  double  sumTW;                 //!< the sum of time times speed
+  long    num;                   //!< the samples
+  double  accel_krpmps;          //!< the slope, once num reaches the minimum
+} FRICFIT_Bin_t;
+
+
+//! \brief Defines one step run
+//!
+typedef struct _FRICFIT_Run_t_
+{
+  const char     *pName;                         //!< the log name
+  double         iq_A;                           //!< the Iq it held
+  long           numRows;                        //!< the rows read
+  FRICFIT_Bin_t  bin[FRIC_MAX_SPEED_POINTS];     //!< the bins, index 0 unused
+} FRICFIT_Run_t;
+
+
+// **************************************************************************
+// the globals
+
+static FRICFIT_Run_t FRICFIT_runs[FRICFIT_MAX_RUNS];
+
+
+// **************************************************************************
+// the functions
+
+static void FRICFIT_usage(const char *pName)
+{
+  fprintf(stderr,
+          "usage: %s [-r rate_Hz] [-s maxSpeed_krpm] [-p pointsPerKrpm] [-n minSamples]\n"
+          "              [-g gain_krpmpsPerA] [-o fric_table.c] [step_A:]<log> ...\n",
+          pName);
+
+  return;
+} // end of FRICFIT_usage() function
+
+
+//! \brief Reads a whole log, through unzip for an .xlsm, returns NULL on failure
+static char *FRICFIT_read(const char *pName)
+{
+  const size_t nameLength = strlen(pName);
+  const int flag_xlsm = (nameLength > 5) && (strcmp(pName + nameLength - 5,".xlsm") == 0);
+  char *pText = malloc(FRICFIT_MAX_LOG_LENGTH + 1);
+  FILE *pFile;
+  size_t length = 0;
+  size_t num;
+
+
+  if(pText == NULL)
+    {
+      return(NULL);
+    }
+
+  if(flag_xlsm)
+    {
+      char command[1024];
+
+      if(strchr(pName,'\'') != NULL)
+        {
+          fprintf(stderr,"%s: quotes in the name\n",pName);
+          free(pText);
+          return(NULL);
+        }
+
+      snprintf(command,sizeof(command),"unzip -p '%s' xl/worksheets/sheet1.xml",pName);
+      pFile = popen(command,"r");
+    }
+  else
+    {
+      pFile = fopen(pName,"rb");
+    }
+
+  if(pFile == NULL)
+    {
+      perror(pName);
+      free(pText);
+      return(NULL);
+    }
+
+  while((length < FRICFIT_MAX_LOG_LENGTH) &&
+        ((num = fread(pText + length,1,FRICFIT_MAX_LOG_LENGTH - length,pFile)) != 0))
+    {
+      length += num;
+    }
+  pText[length] = '\0';
+
+  if(flag_xlsm ? (pclose(pFile) != 0) : (fclose(pFile) != 0))
+    {
+      fprintf(stderr,"%s: cannot read\n",pName);
+      free(pText);
+      return(NULL);
+    }
+
+  return(pText);
+} // end of FRICFIT_read() function
+
+
+//! \brief Gets the next speed from a worksheet, column A, or from text rows,
+//!        the first field; returns 0 at the end
+static int FRICFIT_getSpeed(const char **ppText,const int flag_sheet,double *pSpeed_krpm)
+{
+  const char *pText = *ppText;
+
+  if(flag_sheet)
+    {
+      const char *pCell;
+
+      while((pCell = strstr(pText,"<c r=\"A")) != NULL)
+        {
+          const char *pClose = strchr(pCell,'>');
+          const char *pType;
+          int flag_string = 0;
+
+          pText = pCell + 7;
+
+          if(pClose == NULL)
+            {
+              break;
+            }
+
+          for(pType=pCell;pType<pClose;pType++)
+            {
+              flag_string |= (strncmp(pType," t=\"s\"",6) == 0);
+            }
+
+          // only numbers, shared strings are header text
+          if(!flag_string && (pClose[-1] != '/') && (strncmp(pClose,"><v>",4) == 0))
+            {
+              *pSpeed_krpm = atof(pClose + 4);
+              *ppText = pClose + 4;
+              return(1);
+            }
+        }
+    }
+  else
+    {
+      while(*pText != '\0')
+        {
+          const char *pLine = pText;
+          char *pNumEnd;
+          double value;
+
+          pText += strcspn(pText,"\n");
+          pText += (*pText == '\n') ? 1 : 0;
+
+          // header and comment lines do not start with a number
+          value = strtod(pLine,&pNumEnd);
+          if(pNumEnd != pLine)
+            {
+              *pSpeed_krpm = value;
+              *ppText = pText;
+              return(1);
+            }
+        }
+    }
+
+  *ppText = pText;
+
+  return(0);
+} // end of FRICFIT_getSpeed() function
+
+
+//! \brief Gets the Iq from a leading "<n>amp" in the file name, returns 0 if there is none
+static int FRICFIT_getNameIq(const char *pName,double *pIq_A)
+{
+  const char *pBase = strrchr(pName,'/');
+  char *pEnd;
+
+  pBase = (pBase == NULL) ? pName : pBase + 1;
+  *pIq_A = strtod(pBase,&pEnd);
+
+  return((pEnd != pBase) && (strncmp(pEnd,"amp",3) == 0));
+} // end of FRICFIT_getNameIq() function
+
+
+//! \brief Reads one run and sorts its rise into the bins
+static int FRICFIT_addRun(FRICFIT_Run_t *pRun,const char *pArg,const double rate_Hz,
+                          const double maxSpeed_krpm,const int pointsPerKrpm,const long minSamples)
+{
+  const char *pColon = strchr(pArg,':');
+  const char *pText;
+  char *pLog;
+  double speed_krpm;
+  int flag_sheet;
+  int cnt;
+
+
+  memset(pRun,0,sizeof(FRICFIT_Run_t));
+
+  if((pColon != NULL) && (strspn(pArg,"+-.0123456789") == (size_t)(pColon - pArg)))
+    {
+      pRun->iq_A = atof(pArg);
+      pRun->pName = pColon + 1;
+    }
+  else
+    {
+      pRun->pName = pArg;
+
+      if(!FRICFIT_getNameIq(pArg,&pRun->iq_A))
+        {
+          fprintf(stderr,"%s: no Iq in the name, give it as step_A:%s\n",pArg,pArg);
+          return(0);
+        }
+    }
+
+  if((pLog = FRICFIT_read(pRun->pName)) == NULL)
+    {
+      return(0);
+    }
+
+  pText = pLog + strspn(pLog," \t\r\n");
+  flag_sheet = (pText[0] == '<');
+
+  // only the rise, up to the first row past maxSpeed_krpm
+  while(FRICFIT_getSpeed(&pText,flag_sheet,&speed_krpm) && (speed_krpm <= maxSpeed_krpm))
+    {
+      const double t_sec = (double)pRun->numRows / rate_Hz;
+      const long index = lround(speed_krpm * (double)pointsPerKrpm);
+
+      if((index >= 1) && (index < FRIC_MAX_SPEED_POINTS))
+        {
+          FRICFIT_Bin_t *pBin = &pRun->bin[index];
+
+          pBin->sumT += t_sec;
+          pBin->sumW += speed_krpm;
+          pBin->sumTT += t_sec * t_sec;
+          pBin->sumTW += t_sec * speed_krpm;
+          pBin->num++;
+        }
+
+      pRun->numRows++;
+    }
+
+  free(pLog);
+
+  for(cnt=1;cnt<FRIC_MAX_SPEED_POINTS;cnt++)
+    {
+      FRICFIT_Bin_t *pBin = &pRun->bin[cnt];
+      const double denom = (double)pBin->num * pBin->sumTT - pBin->sumT * pBin->sumT;
+
+      if((pBin->num >= minSamples) && (denom > 0.0))
+        {
+          pBin->accel_krpmps = ((double)pBin->num * pBin->sumTW - pBin->sumT * pBin->sumW) / denom;
+        }
+      else
+        {
+          pBin->num = 0;
+        }
+    }
+
+  return(1);
+} // end of FRICFIT_addRun() function
+
+
+//! \brief Gets the gain from the runs that share a bin, returns 0 if none do
+static int FRICFIT_getGain(const int numRuns,const int numPoints,double *pGain_krpmpsPerA)
+{
+  double sumXY = 0.0;
+  double sumXX = 0.0;
+  int point;
+  int run;
+
+
+  for(point=1;point<numPoints;point++)
+    {
+      double sumN = 0.0;
+      double sumI = 0.0;
+      double sumA = 0.0;
+
+      for(run=0;run<numRuns;run++)
+        {
+          const FRICFIT_Bin_t *pBin = &FRICFIT_runs[run].bin[point];
+
+          sumN += (double)pBin->num;
+          sumI += (double)pBin->num * FRICFIT_runs[run].iq_A;
+          sumA += (double)pBin->num * pBin->accel_krpmps;
+        }
+
+      if(sumN == 0.0)
+        {
+          continue;
+        }
+
+      // the spread about the bin means, the friction in the bin drops out
+      for(run=0;run<numRuns;run++)
+        {
+          const FRICFIT_Bin_t *pBin = &FRICFIT_runs[run].bin[point];
+          const double x = FRICFIT_runs[run].iq_A - sumI / sumN;
+          const double y = pBin->accel_krpmps - sumA / sumN;
+
+          sumXY += (double)pBin->num * x * y;
+          sumXX += (double)pBin->num * x * x;
+        }
+    }
+
+  if(sumXX <= 0.0)
+    {
+      return(0);
+    }
+
+  *pGain_krpmpsPerA = sumXY / sumXX;
+
+  return(1);
+} // end of FRICFIT_getGain() function
+
+
+static int FRICFIT_write(const char *pName,const FRIC_Table_t *pTable,const double gain_krpmpsPerA,
+                         const int argc,char *argv[],const int first)
+{
+  FILE *pOut = fopen(pName,"w");
+  char numPoints[16];
+  char perKrpm[16];
+  int cnt;
+
+
+  if(pOut == NULL)
+    {
+      perror(pName);
+      return(0);
+    }
+
+  snprintf(numPoints,sizeof(numPoints),"%u,",(unsigned)pTable->numSpeedPoints);
+  snprintf(perKrpm,sizeof(perKrpm),"%u,",(unsigned)pTable->pointsPerKrpm);
+
+  fprintf(pOut,
+          "//! \\file   fric_table.c\n"
+          "//! \\brief  Contains the friction feedforward table (see fric.h), generated by\n"
+          "//!         Code/tools/fricfit, do not edit\n"
+          "//!\n"
+          "//!         gain %.3f krpm/s per A, from\n"
+          "//!\n",
+          gain_krpmpsPerA);
+
+  for(cnt=first;cnt<argc;cnt++)
+    {
+      const char *pBase = strrchr(argv[cnt],'/');
+
+      fprintf(pOut,"//!           %s\n",(pBase == NULL) ? argv[cnt] : pBase + 1);
+    }
+
+  fprintf(pOut,
+          "\n"
+          "\n"
+          "// **************************************************************************\n"
+          "// the includes\n"
+          "\n"
+          "#include \"fric.h\"\n"
+          "\n"
+          "\n"
+          "// **************************************************************************\n"
+          "// the globals\n"
+          "\n"
+          "const FRIC_Table_t gFricTable =\n"
+          "{\n"
+          "  %-7s// numSpeedPoints\n"
+          "  %-7s// pointsPerKrpm\n"
+          "  {      // speed, Q%d A",
+          numPoints,perKrpm,FRIC_TABLE_Q);
+
+  for(cnt=0;cnt<pTable->numSpeedPoints;cnt++)
+    {
+      fprintf(pOut,"%s%5d",(cnt == 0) ? "\n    " : (((cnt % 8) == 0) ? ",\n    " : ","),(int)pTable->speed[cnt]);
+    }
+
+  fprintf(pOut,
+          "\n"
+          "  },\n"
+          "  0,     // numCoggingPoints\n"
+          "  {0}    // cogging\n"
+          "};\n"
+          "\n"
+          "\n"
+          "// end of file\n");
+
+  fclose(pOut);
+
+  return(1);
+} // end of FRICFIT_write() function
+
+
+int main(int argc,char *argv[])
+{
+  double rate_Hz = FRICFIT_DEFAULT_RATE_Hz;
+  double maxSpeed_krpm = FRICFIT_DEFAULT_MAX_SPEED_krpm;
+  int pointsPerKrpm = FRICFIT_DEFAULT_POINTS_PER_krpm;
+  long minSamples = FRICFIT_DEFAULT_MIN_SAMPLES;
+  double gain_krpmpsPerA = 0.0;
+  const char *pOutName = NULL;
+  FRIC_Table_t table;
+  double friction_A[FRIC_MAX_SPEED_POINTS];
+  int flag_have[FRIC_MAX_SPEED_POINTS];
+  double sumSqTable = 0.0;
+  double sumSqNone = 0.0;
+  long numBins = 0;
+  int numPoints;
+  int numRuns;
+  int point;
+  int run;
+  int opt;
+
+
+  while((opt = getopt(argc,argv,"r:s:p:n:g:o:")) != -1)
+    {
+      switch(opt)
+        {
+          case 'r': rate_Hz = atof(optarg); break;
+          case 's': maxSpeed_krpm = atof(optarg); break;
+          case 'p': pointsPerKrpm = atoi(optarg); break;
+          case 'n': minSamples = atol(optarg); break;
+          case 'g': gain_krpmpsPerA = atof(optarg); break;
+          case 'o': pOutName = optarg; break;
+          default:  FRICFIT_usage(argv[0]); return(2);
+        }
+    }
+
+  numRuns = argc - optind;
+  numPoints = (int)floor(maxSpeed_krpm * (double)pointsPerKrpm) + 1;
+
+  if((numRuns < 1) || (numRuns > FRICFIT_MAX_RUNS) || (rate_Hz <= 0.0) || (pointsPerKrpm < 1) ||
+     (numPoints < 2) || (numPoints > FRIC_MAX_SPEED_POINTS) || (minSamples < 2))
+    {
+      FRICFIT_usage(argv[0]);
+      return(2);
+    }
+
+  for(run=0;run<numRuns;run++)
+    {
+      if(!FRICFIT_addRun(&FRICFIT_runs[run],argv[optind + run],rate_Hz,maxSpeed_krpm,pointsPerKrpm,minSamples))
+        {
+          return(1);
+        }
+    }
+
+  if((gain_krpmpsPerA <= 0.0) && !FRICFIT_getGain(numRuns,numPoints,&gain_krpmpsPerA))
+    {
+      fprintf(stderr,"no two runs at different Iq share a speed bin, give the gain with -g\n");
+      return(1);
+    }
+
+  if(gain_krpmpsPerA <= 0.0)
+    {
+      fprintf(stderr,"the fit gives a gain of %.3f krpm/s per A, the runs do not follow the model\n",gain_krpmpsPerA);
+      return(1);
+    }
+
+  // the friction in each bin, weighted by the samples of each run
+  for(point=1;point<numPoints;point++)
+    {
+      double sumN = 0.0;
+      double sumF = 0.0;
+
+      for(run=0;run<numRuns;run++)
+        {
+          const FRICFIT_Bin_t *pBin = &FRICFIT_runs[run].bin[point];
+
+          sumN += (double)pBin->num;
+          sumF += (double)pBin->num * (FRICFIT_runs[run].iq_A - pBin->accel_krpmps / gain_krpmpsPerA);
+        }
+
+      flag_have[point] = (sumN > 0.0);
+      friction_A[point] = flag_have[point] ? sumF / sumN : 0.0;
+    }
+
+  friction_A[0] = 0.0;
+  flag_have[0] = 1;
+
+  // fill the bins no run had from their neighbours, the last one held
+  for(point=1;point<numPoints;point++)
+    {
+      if(!flag_have[point])
+        {
+          int next = point + 1;
+
+          while((next < numPoints) && !flag_have[next])
+            {
+              next++;
+            }
+
+          friction_A[point] = (next < numPoints) ?
+                              friction_A[point - 1] + (friction_A[next] - friction_A[point - 1]) / (double)(next - point + 1) :
+                              friction_A[point - 1];
+        }
+    }
+
+  memset(&table,0,sizeof(table));
+  table.numSpeedPoints = (uint_least16_t)numPoints;
+  table.pointsPerKrpm = (uint_least16_t)pointsPerKrpm;
+
+  for(point=0;point<numPoints;point++)
+    {
+      const double value = friction_A[point] * (double)(1 << FRIC_TABLE_Q);
+
+      table.speed[point] = (int16_t)((value > 32767.0) ? 32767 : ((value < -32768.0) ? -32768 : lround(value)));
+    }
+
+  // how much of the acceleration the table explains
+  for(run=0;run<numRuns;run++)
+    {
+      for(point=1;point<numPoints;point++)
+        {
+          const FRICFIT_Bin_t *pBin = &FRICFIT_runs[run].bin[point];
+
+          if(pBin->num != 0)
+            {
+              const double errorTable = pBin->accel_krpmps - gain_krpmpsPerA * (FRICFIT_runs[run].iq_A - friction_A[point]);
+              const double errorNone = pBin->accel_krpmps - gain_krpmpsPerA * FRICFIT_runs[run].iq_A;
+
+              sumSqTable += errorTable * errorTable;
+              sumSqNone += errorNone * errorNone;
+              numBins++;
+            }
+        }
+    }
+
+  for(run=0;run<numRuns;run++)
+    {
+      printf("run:       %-36s %6.2f A, %ld rows\n",FRICFIT_runs[run].pName,FRICFIT_runs[run].iq_A,FRICFIT_runs[run].numRows);
+    }
+
+  printf("gain:      %.3f krpm/s per A\n",gain_krpmpsPerA);
+  printf("table:     %d points, %d per krpm, up to %.2f krpm\n",numPoints,pointsPerKrpm,
+         (double)(numPoints - 1) / (double)pointsPerKrpm);
+
+  for(point=0;point<numPoints;point++)
+    {
+      printf("  %5.2f krpm  %6.3f A%s\n",(double)point / (double)pointsPerKrpm,
+             (double)table.speed[point] / (double)(1 << FRIC_TABLE_Q),flag_have[point] ? "" : "  (filled)");
+    }
+
+  if(numBins != 0)
+    {
+      printf("fit:       rms acceleration error %.3f krpm/s over %ld bins, %.3f with no friction\n",
+             sqrt(sumSqTable / (double)numBins),numBins,sqrt(sumSqNone / (double)numBins));
+    }
+
+  if((pOutName != NULL) && !FRICFIT_write(pOutName,&table,gain_krpmpsPerA,argc,argv,optind))
+    {
+      return(1);
+    }
+
+  return(0);
+} // end of main() function
+
+
+// end of file
@@ -0,0 +1,194 @@
+//! \file   focsim.c
+//! \brief  Contains the host copy of the MotorWare current loop (FOCSIM) functions
+//!
+
+
+// **************************************************************************
+// the includes
+
+#include "focsim.h"
+#include "user_j1.h"
+
+
+// **************************************************************************
+// the defines
+
+//! \brief Defines the controller period, s
+//!
+#define FOCSIM_CTRL_PERIOD_sec      (1.0e-3 / USER_PWM_FREQ_kHz * USER_NUM_PWM_TICKS_PER_ISR_TICK * \
+                                     USER_NUM_ISR_TICKS_PER_CTRL_TICK)
+
+//! \brief Defines the offset estimator pole, rad/s, see USER_OFFSET_POLE_rps in user.h
+//!
+#define FOCSIM_OFFSET_POLE_rps      (20.0)
+
+#define FOCSIM_ONE_OVER_THREE       (0.3333333333333333)
+#define FOCSIM_ONE_OVER_SQRT_THREE  (0.5773502691896258)
+#define FOCSIM_SQRT3_OVER_2         (0.8660254037844386)
+
+
+// **************************************************************************
+// the functions
+
+void FOCSIM_init(FOCSIM_Obj *obj)
+{
+  // the gains CTRL_setParams() computes from the motor parameters
+  _iq Kp = _IQ(0.25 * USER_MOTOR_Ls_d * USER_IQ_FULL_SCALE_CURRENT_A /
+               (FOCSIM_CTRL_PERIOD_sec * USER_IQ_FULL_SCALE_VOLTAGE_V));
+  _iq Ki = _IQ(USER_MOTOR_Rs / USER_MOTOR_Ls_d * FOCSIM_CTRL_PERIOD_sec);
+  _iq beta = _IQ(FOCSIM_OFFSET_POLE_rps * FOCSIM_CTRL_PERIOD_sec);
+  uint_least8_t cnt;
+
+
+  obj->maxVsMag_pu = _IQ(USER_MAX_VS_MAG_PU);
+  obj->Id_ref_pu = _IQ(0.0);
+  obj->Iq_ref_pu = _IQ(0.0);
+
+  obj->pidId.Ui = _IQ(0.0);
+  obj->pidId.outMin = -obj->maxVsMag_pu;
+  obj->pidId.outMax = obj->maxVsMag_pu;
+
+  obj->pidIq.Ui = _IQ(0.0);
+  obj->pidIq.outMin = -obj->maxVsMag_pu;
+  obj->pidIq.outMax = obj->maxVsMag_pu;
+
+  FOCSIM_setGains(obj,Kp,Ki);
+
+  // OFFSET_setBeta()
+  for(cnt=0;cnt<HALSIM_NUM_SENSORS;cnt++)
+    {
+      obj->offsetI[cnt].a1 = beta - _IQ(1.0);
+      obj->offsetI[cnt].b0 = beta;
+      obj->offsetI[cnt].b1 = _IQ(0.0);
+      obj->offsetI[cnt].x1 = _IQ(0.0);
+      obj->offsetI[cnt].y1 = _IQ(0.0);
+    }
+
+  for(cnt=0;cnt<2;cnt++)
+    {
+      obj->Iab_pu[cnt] = _IQ(0.0);
+      obj->Idq_pu[cnt] = _IQ(0.0);
+      obj->Vdq_pu[cnt] = _IQ(0.0);
+      obj->Vab_pu[cnt] = _IQ(0.0);
+    }
+
+  for(cnt=0;cnt<HALSIM_NUM_SENSORS;cnt++)
+    {
+      obj->Tabc[cnt] = _IQ(0.0);
+    }
+
+  return;
+} // end of FOCSIM_init() function
+
+
+void FOCSIM_setGains(FOCSIM_Obj *obj,const _iq Kp,const _iq Ki)
+{
+  obj->pidId.Kp = Kp;
+  obj->pidId.Ki = Ki;
+  obj->pidIq.Kp = Kp;
+  obj->pidIq.Ki = Ki;
+
+  return;
+} // end of FOCSIM_setGains() function
+
+
+static inline _iq FOCSIM_runFilterFo(FOCSIM_FilterFo_t *pFilter,const _iq inputValue)
+{
+  _iq y0 = _IQmpy(pFilter->b0,inputValue) + _IQmpy(pFilter->b1,pFilter->x1) - _IQmpy(pFilter->a1,pFilter->y1);
+
+  pFilter->x1 = inputValue;
+  pFilter->y1 = y0;
+
+  return(y0);
+} // end of FOCSIM_runFilterFo() function
+
+
+void FOCSIM_runOffsets(FOCSIM_Obj *obj,const HALSIM_AdcData_t *pAdcData)
+{
+  uint_least8_t cnt;
+
+
+  for(cnt=0;cnt<HALSIM_NUM_SENSORS;cnt++)
+    {
+      FOCSIM_runFilterFo(&obj->offsetI[cnt],pAdcData->I[cnt]);
+    }
+
+  return;
+} // end of FOCSIM_runOffsets() function
+
+
+_iq FOCSIM_getOffset(const FOCSIM_Obj *obj,const uint_least8_t cnt)
+{
+  return(obj->offsetI[cnt].y1);
+} // end of FOCSIM_getOffset() function
+
+
+static inline void FOCSIM_runPid(FOCSIM_Pid_t *pPid,const _iq refValue,const _iq fbackValue,_iq *pOutValue)
+{
+  _iq Error = refValue - fbackValue;
+  _iq Up = _IQmpy(pPid->Kp,Error);
+  _iq Ui = _IQsat(pPid->Ui + _IQmpy(pPid->Ki,Up),pPid->outMax,pPid->outMin);
+
+
+  pPid->Ui = Ui;
+  *pOutValue = _IQsat(Up + Ui,pPid->outMax,pPid->outMin);
+
+  return;
+} // end of FOCSIM_runPid() function
+
+
+void FOCSIM_run(FOCSIM_Obj *obj,const HALSIM_AdcData_t *pAdcData,const _iq angle_pu)
+{
+  _iq cosTh = _IQcosPU(angle_pu);
+  _iq sinTh = _IQsinPU(angle_pu);
+  _iq Va_tmp, Vb_tmp, Va, Vb, Vc, Vmax, Vmin, Vcom;
+  _iq oneOverDcBus = _IQdiv(_IQ(1.0),pAdcData->dcBus);
+
+
+  // CLARKE_run() with three sensors
+  obj->Iab_pu[0] = _IQmpy((pAdcData->I[0] << 1) - pAdcData->I[1] - pAdcData->I[2],_IQ(FOCSIM_ONE_OVER_THREE));
+  obj->Iab_pu[1] = _IQmpy(pAdcData->I[1] - pAdcData->I[2],_IQ(FOCSIM_ONE_OVER_SQRT_THREE));
+
+  // PARK_run()
+  obj->Idq_pu[0] = _IQmpy(obj->Iab_pu[0],cosTh) + _IQmpy(obj->Iab_pu[1],sinTh);
+  obj->Idq_pu[1] = _IQmpy(obj->Iab_pu[1],cosTh) - _IQmpy(obj->Iab_pu[0],sinTh);
+
+  // the Id controller
+  FOCSIM_runPid(&obj->pidId,obj->Id_ref_pu,obj->Idq_pu[0],&obj->Vdq_pu[0]);
+
+  // the Iq controller gets what Vd leaves of the voltage vector
+  {
+    _iq tmp = _IQsqrt(_IQmpy(obj->maxVsMag_pu,obj->maxVsMag_pu) - _IQmpy(obj->Vdq_pu[0],obj->Vdq_pu[0]));
+
+    obj->pidIq.outMin = -tmp;
+    obj->pidIq.outMax = tmp;
+  }
+
+  FOCSIM_runPid(&obj->pidIq,obj->Iq_ref_pu,obj->Idq_pu[1],&obj->Vdq_pu[1]);
+
+  // IPARK_run()
+  obj->Vab_pu[0] = _IQmpy(obj->Vdq_pu[0],cosTh) - _IQmpy(obj->Vdq_pu[1],sinTh);
+  obj->Vab_pu[1] = _IQmpy(obj->Vdq_pu[1],cosTh) + _IQmpy(obj->Vdq_pu[0],sinTh);
+
+  // SVGEN_run(), min/max common mode injection
+  Va = _IQmpy(obj->Vab_pu[0],oneOverDcBus);
+  Va_tmp = -(Va >> 1);
+  Vb_tmp = _IQmpy(_IQ(FOCSIM_SQRT3_OVER_2),_IQmpy(obj->Vab_pu[1],oneOverDcBus));
+  Vb = Va_tmp + Vb_tmp;
+  Vc = Va_tmp - Vb_tmp;
+
+  Vmax = (Va > Vb) ? Va : Vb;
+  Vmax = (Vmax > Vc) ? Vmax : Vc;
+  Vmin = (Va < Vb) ? Va : Vb;
+  Vmin = (Vmin < Vc) ? Vmin : Vc;
+  Vcom = _IQmpy(Vmax + Vmin,_IQ(0.5));
+
+  obj->Tabc[0] = Va - Vcom;
+  obj->Tabc[1] = Vb - Vcom;
+  obj->Tabc[2] = Vc - Vcom;
+
+  return;
+} // end of FOCSIM_run() function
+
+
+// end of file
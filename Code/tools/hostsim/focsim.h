@@ -0,0 +1,134 @@
+#ifndef _FOCSIM_H_
+#define _FOCSIM_H_
+
+//! \file   focsim.h
+//! \brief  Contains the public interface to the host copy of the MotorWare
+//!         current loop (FOCSIM)
+//!
+//!         This is a hand copy, not a build of the firmware sources.  ctrl.c,
+//!         pid.c, clarke.c, park.c, ipark.c, svgen.c, filter_fo.c and offset.c
+//!         are in Code/proj_lab05a, but they only hold the init and set
+//!         functions.  CTRL_runOnLine_User() and the _run() functions it calls
+//!         are static inline in the MotorWare headers, which are not in this
+//!         tree, so a change to either has to be copied here by hand.
+//!
+//!         FOCSIM_run() follows CTRL_runOnLine_User() step for step in IQ24:
+//!         CLARKE with three sensors, PARK, the Id and Iq PID controllers with
+//!         the Vq limit taken from what Vd leaves of maxVsMag, IPARK and SVGEN
+//!         with 1/Vdc scaling.  FOCSIM_runOffsets() mirrors the OFFSET
+//!         estimators run while CTRL is in the OffLine state, and FOCSIM_init()
+//!         sets the gains CTRL_setParams() in ctrl.c computes.  The FAST
+//!         estimator is a ROM binary, so the angle is an input.
+
+
+// **************************************************************************
+// the includes
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "IQmathLib.h"
+#include "halsim.h"
+
+
+//!
+//!
+//! \defgroup FOCSIM FOCSIM
+//!
+//@{
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+// **************************************************************************
+// the typedefs
+
+//! \brief Defines a PID controller, same fields and semantics as PID_Obj
+//!
+typedef struct _FOCSIM_Pid_t_
+{
+  _iq  Kp;                       //!< the proportional gain
+  _iq  Ki;                       //!< the integral gain, applied to the proportional output
+  _iq  Ui;                       //!< the integrator
+  _iq  outMin;                   //!< the minimum output
+  _iq  outMax;                   //!< the maximum output
+} FOCSIM_Pid_t;
+
+
+//! \brief Defines a first order filter, same fields and semantics as FILTER_FO_Obj
+//!
+typedef struct _FOCSIM_FilterFo_t_
+{
+  _iq  a1;                       //!< the denominator coefficient
+  _iq  b0;                       //!< the numerator coefficient for x(n)
+  _iq  b1;                       //!< the numerator coefficient for x(n-1)
+  _iq  x1;                       //!< x(n-1)
+  _iq  y1;                       //!< y(n-1)
+} FOCSIM_FilterFo_t;
+
+
+//! \brief Defines the current loop object
+//!
+typedef struct _FOCSIM_Obj_
+{
+  FOCSIM_Pid_t       pidId;                          //!< the Id controller
+  FOCSIM_Pid_t       pidIq;                          //!< the Iq controller
+  FOCSIM_FilterFo_t  offsetI[HALSIM_NUM_SENSORS];    //!< the current offset estimators
+
+  _iq  maxVsMag_pu;              //!< the largest voltage vector, pu
+  _iq  Id_ref_pu;                //!< the Id reference
+  _iq  Iq_ref_pu;                //!< the Iq reference
+
+  _iq  Iab_pu[2];                //!< the CLARKE output
+  _iq  Idq_pu[2];                //!< the PARK output
+  _iq  Vdq_pu[2];                //!< the controller outputs
+  _iq  Vab_pu[2];                //!< the IPARK output
+  _iq  Tabc[HALSIM_NUM_SENSORS]; //!< the SVGEN output
+} FOCSIM_Obj;
+
+
+// **************************************************************************
+// the function prototypes
+
+//! \brief      Initializes the current loop with the MotorWare default gains for
+//!             the motor selected in user_j1.h
+//! \param[out] obj  A pointer to the current loop object
+extern void FOCSIM_init(FOCSIM_Obj *obj);
+
+
+//! \brief     Sets the Id and Iq controller gains
+//! \param[in] obj  A pointer to the current loop object
+//! \param[in] Kp   The proportional gain, pu
+//! \param[in] Ki   The integral gain, pu
+extern void FOCSIM_setGains(FOCSIM_Obj *obj,const _iq Kp,const _iq Ki);
+
+
+//! \brief     Runs the current offset estimators, the inverter must be at 50% duty
+//! \param[in] obj       A pointer to the current loop object
+//! \param[in] pAdcData  A pointer to the ADC data, from HALSIM_readAdcDataWithOffsets()
+extern void FOCSIM_runOffsets(FOCSIM_Obj *obj,const HALSIM_AdcData_t *pAdcData);
+
+
+//! \brief     Gets an estimated current offset
+//! \param[in] obj  A pointer to the current loop object
+//! \param[in] cnt  The sensor
+//! \return    The offset, pu
+extern _iq FOCSIM_getOffset(const FOCSIM_Obj *obj,const uint_least8_t cnt);
+
+
+//! \brief     Runs the current loop once
+//! \param[in] obj       A pointer to the current loop object
+//! \param[in] pAdcData  A pointer to the ADC data, from HALSIM_readAdcData()
+//! \param[in] angle_pu  The electrical angle, pu of a revolution
+extern void FOCSIM_run(FOCSIM_Obj *obj,const HALSIM_AdcData_t *pAdcData,const _iq angle_pu);
+
+
+#ifdef __cplusplus
+}
+#endif // extern "C"
+
+//@} // ingroup
+#endif // end of _FOCSIM_H_ definition
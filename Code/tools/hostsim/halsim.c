@@ -0,0 +1,170 @@
+//! \file   halsim.c
+//! \brief  Contains the register free HAL stub (HALSIM) functions
+//!
+
+
+// **************************************************************************
+// the includes
+
+#include <math.h>
+
+#include "halsim.h"
+#include "user_j1.h"
+
+
+// **************************************************************************
+// the defines
+
+//! \brief Defines the ADC full range, counts
+//!
+#define HALSIM_ADC_RANGE_cnt        (1 << HALSIM_NUM_ADC_BITS)
+
+//! \brief Defines TBPRD for an up-down count at USER_PWM_FREQ_kHz from a 90 MHz TBCLK
+//!
+#define HALSIM_PWM_PERIOD           ((uint16_t)(90000.0 / USER_PWM_FREQ_kHz / 2.0))
+
+
+// **************************************************************************
+// the functions
+
+void HALSIM_init(HALSIM_Obj *obj)
+{
+  uint_least8_t cnt;
+
+
+  obj->adcFullScaleCurrent_A = USER_ADC_FULL_SCALE_CURRENT_A;
+  obj->adcFullScaleVoltage_V = USER_ADC_FULL_SCALE_VOLTAGE_V;
+
+  obj->current_sf = _IQ(USER_ADC_FULL_SCALE_CURRENT_A / USER_IQ_FULL_SCALE_CURRENT_A);
+  obj->voltage_sf = _IQ(USER_ADC_FULL_SCALE_VOLTAGE_V / USER_IQ_FULL_SCALE_VOLTAGE_V);
+
+  // the bidirectional current sensors sit at mid scale
+  for(cnt=0;cnt<HALSIM_NUM_SENSORS;cnt++)
+    {
+      obj->biasI[cnt] = _IQ12mpy((_iq)(HALSIM_ADC_RANGE_cnt / 2),obj->current_sf);
+      obj->biasV[cnt] = _IQ(0.0);
+      obj->offsetI_cnt[cnt] = 0.0;
+    }
+
+  for(cnt=0;cnt<(2 * HALSIM_NUM_SENSORS + 1);cnt++)
+    {
+      obj->adcResult[cnt] = 0;
+    }
+
+  obj->period = HALSIM_PWM_PERIOD;
+
+  for(cnt=0;cnt<HALSIM_NUM_SENSORS;cnt++)
+    {
+      obj->cmpA[cnt] = obj->period / 2;
+    }
+
+  return;
+} // end of HALSIM_init() function
+
+
+static uint16_t HALSIM_quantize(const double value)
+{
+  double counts = floor(value + 0.5);
+
+  if(counts < 0.0)
+    {
+      return(0);
+    }
+  else if(counts > (double)(HALSIM_ADC_RANGE_cnt - 1))
+    {
+      return(HALSIM_ADC_RANGE_cnt - 1);
+    }
+
+  return((uint16_t)counts);
+} // end of HALSIM_quantize() function
+
+
+void HALSIM_convertAdc(HALSIM_Obj *obj,const double *pIabc_A,const double *pVabc_V,const double dcBus_V)
+{
+  uint_least8_t cnt;
+
+
+  for(cnt=0;cnt<HALSIM_NUM_SENSORS;cnt++)
+    {
+      obj->adcResult[cnt] = HALSIM_quantize(pIabc_A[cnt] / obj->adcFullScaleCurrent_A * HALSIM_ADC_RANGE_cnt +
+                                            HALSIM_ADC_RANGE_cnt / 2 + obj->offsetI_cnt[cnt]);
+      obj->adcResult[HALSIM_NUM_SENSORS + cnt] = HALSIM_quantize(pVabc_V[cnt] / obj->adcFullScaleVoltage_V *
+                                                                 HALSIM_ADC_RANGE_cnt);
+    }
+
+  obj->adcResult[2 * HALSIM_NUM_SENSORS] = HALSIM_quantize(dcBus_V / obj->adcFullScaleVoltage_V * HALSIM_ADC_RANGE_cnt);
+
+  return;
+} // end of HALSIM_convertAdc() function
+
+
+void HALSIM_readAdcData(const HALSIM_Obj *obj,HALSIM_AdcData_t *pAdcData)
+{
+  uint_least8_t cnt;
+
+
+  for(cnt=0;cnt<HALSIM_NUM_SENSORS;cnt++)
+    {
+      pAdcData->I[cnt] = _IQ12mpy((_iq)obj->adcResult[cnt],obj->current_sf) - obj->biasI[cnt];
+      pAdcData->V[cnt] = _IQ12mpy((_iq)obj->adcResult[HALSIM_NUM_SENSORS + cnt],obj->voltage_sf) - obj->biasV[cnt];
+    }
+
+  pAdcData->dcBus = _IQ12mpy((_iq)obj->adcResult[2 * HALSIM_NUM_SENSORS],obj->voltage_sf);
+
+  return;
+} // end of HALSIM_readAdcData() function
+
+
+void HALSIM_readAdcDataWithOffsets(const HALSIM_Obj *obj,HALSIM_AdcData_t *pAdcData)
+{
+  uint_least8_t cnt;
+
+
+  for(cnt=0;cnt<HALSIM_NUM_SENSORS;cnt++)
+    {
+      pAdcData->I[cnt] = _IQ12mpy((_iq)obj->adcResult[cnt],obj->current_sf);
+      pAdcData->V[cnt] = _IQ12mpy((_iq)obj->adcResult[HALSIM_NUM_SENSORS + cnt],obj->voltage_sf);
+    }
+
+  pAdcData->dcBus = _IQ12mpy((_iq)obj->adcResult[2 * HALSIM_NUM_SENSORS],obj->voltage_sf);
+
+  return;
+} // end of HALSIM_readAdcDataWithOffsets() function
+
+
+void HALSIM_writePwmData(HALSIM_Obj *obj,const _iq *pTabc)
+{
+  uint_least8_t cnt;
+  _iq period = (_iq)obj->period;
+
+
+  for(cnt=0;cnt<HALSIM_NUM_SENSORS;cnt++)
+    {
+      _iq pwmData_neg = _IQmpy(pTabc[cnt],_IQ(-1.0));
+      _iq pwmData_sat = _IQsat(pwmData_neg,_IQ(0.5),_IQ(-0.5));
+      _iq pwmData_sat_dc = pwmData_sat + _IQ(0.5);
+      _iq value = _IQmpy(pwmData_sat_dc,period);
+
+      obj->cmpA[cnt] = (uint16_t)_IQsat(value,period,_IQ(0.0));
+    }
+
+  return;
+} // end of HALSIM_writePwmData() function
+
+
+void HALSIM_getPoleVoltages(const HALSIM_Obj *obj,const double dcBus_V,double *pVabc_V)
+{
+  uint_least8_t cnt;
+
+
+  // the high side is on while the counter is above CMPA
+  for(cnt=0;cnt<HALSIM_NUM_SENSORS;cnt++)
+    {
+      pVabc_V[cnt] = (1.0 - (double)obj->cmpA[cnt] / (double)obj->period) * dcBus_V;
+    }
+
+  return;
+} // end of HALSIM_getPoleVoltages() function
+
+
+// end of file
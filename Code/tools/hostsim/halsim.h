@@ -0,0 +1,125 @@
+#ifndef _HALSIM_H_
+#define _HALSIM_H_
+
+//! \file   halsim.h
+//! \brief  Contains the public interface to the register free HAL stub (HALSIM)
+//!         used by the host simulation
+//!
+//!         The ADC result and PWM compare registers are plain fields of the
+//!         object.  HALSIM_readAdcData(), HALSIM_readAdcDataWithOffsets() and
+//!         HALSIM_writePwmData() do the same IQ arithmetic as their HAL_
+//!         counterparts in proj_lab05a/hal.h, so quantization, scaling and
+//!         saturation match the target.
+
+
+// **************************************************************************
+// the includes
+
+#include <stdint.h>
+
+#include "IQmathLib.h"
+
+
+//!
+//!
+//! \defgroup HALSIM HALSIM
+//!
+//@{
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+// **************************************************************************
+// the defines
+
+//! \brief Defines the number of ADC bits
+//!
+#define HALSIM_NUM_ADC_BITS         (12)
+
+//! \brief Defines the number of current and voltage sensors
+//!
+#define HALSIM_NUM_SENSORS          (3)
+
+
+// **************************************************************************
+// the typedefs
+
+//! \brief Defines the ADC data, same layout as HAL_AdcData_t
+//!
+typedef struct _HALSIM_AdcData_t_
+{
+  _iq  I[HALSIM_NUM_SENSORS];    //!< the phase currents, pu
+  _iq  V[HALSIM_NUM_SENSORS];    //!< the phase voltages, pu
+  _iq  dcBus;                    //!< the DC bus voltage, pu
+} HALSIM_AdcData_t;
+
+
+//! \brief Defines the HAL stub object
+//!
+typedef struct _HALSIM_Obj_
+{
+  _iq       current_sf;                      //!< the current scale factor, see USER_CURRENT_SF
+  _iq       voltage_sf;                      //!< the voltage scale factor, see USER_VOLTAGE_SF
+  _iq       biasI[HALSIM_NUM_SENSORS];       //!< the current bias, pu
+  _iq       biasV[HALSIM_NUM_SENSORS];       //!< the voltage bias, pu
+
+  double    adcFullScaleCurrent_A;           //!< the current at a full ADC range
+  double    adcFullScaleVoltage_V;           //!< the voltage at a full ADC range
+  double    offsetI_cnt[HALSIM_NUM_SENSORS]; //!< the current sensor offset errors, ADC counts
+
+  uint16_t  adcResult[2 * HALSIM_NUM_SENSORS + 1]; //!< the ADC results, in HAL_readAdcData() order
+  uint16_t  period;                          //!< TBPRD
+  uint16_t  cmpA[HALSIM_NUM_SENSORS];        //!< the PWM compare values
+} HALSIM_Obj;
+
+
+// **************************************************************************
+// the function prototypes
+
+//! \brief      Initializes the HAL stub from user_j1.h, biases at mid scale
+//! \param[out] obj  A pointer to the HAL stub object
+extern void HALSIM_init(HALSIM_Obj *obj);
+
+
+//! \brief     Converts plant values into ADC results
+//! \param[in] obj        A pointer to the HAL stub object
+//! \param[in] pIabc_A    A pointer to the three phase currents
+//! \param[in] pVabc_V    A pointer to the three phase voltages
+//! \param[in] dcBus_V    The DC bus voltage
+extern void HALSIM_convertAdc(HALSIM_Obj *obj,const double *pIabc_A,const double *pVabc_V,const double dcBus_V);
+
+
+//! \brief      Mirrors HAL_readAdcData()
+//! \param[in]  obj       A pointer to the HAL stub object
+//! \param[out] pAdcData  A pointer to the ADC data
+extern void HALSIM_readAdcData(const HALSIM_Obj *obj,HALSIM_AdcData_t *pAdcData);
+
+
+//! \brief      Mirrors HAL_readAdcDataWithOffsets()
+//! \param[in]  obj       A pointer to the HAL stub object
+//! \param[out] pAdcData  A pointer to the ADC data
+extern void HALSIM_readAdcDataWithOffsets(const HALSIM_Obj *obj,HALSIM_AdcData_t *pAdcData);
+
+
+//! \brief     Mirrors HAL_writePwmData()
+//! \param[in] obj    A pointer to the HAL stub object
+//! \param[in] pTabc  A pointer to the three SVGEN outputs
+extern void HALSIM_writePwmData(HALSIM_Obj *obj,const _iq *pTabc);
+
+
+//! \brief      Gets the pole voltages the PWM compare values produce
+//! \param[in]  obj      A pointer to the HAL stub object
+//! \param[in]  dcBus_V  The DC bus voltage
+//! \param[out] pVabc_V  A pointer to the three pole voltages, against the negative rail
+extern void HALSIM_getPoleVoltages(const HALSIM_Obj *obj,const double dcBus_V,double *pVabc_V);
+
+
+#ifdef __cplusplus
+}
+#endif // extern "C"
+
+//@} // ingroup
+#endif // end of _HALSIM_H_ definition
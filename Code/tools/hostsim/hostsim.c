@@ -0,0 +1,450 @@
+//! \file   hostsim.c
+//! \brief  Runs the proj_lab05a current loop against a PMSM plant model on the
+//!         host, so current loop changes can be tried and timed without a
+//!         flash-and-scope cycle
+//!
+//!         Build on Linux from this directory with
+//!
+//!           cc -O2 -I../../proj_lab05a -I../iqmath -o hostsim hostsim.c
+//!              pmsm.c halsim.c focsim.c ../../proj_lab05a/excite.c -lm
+//!
+//!         Usage
+//!
+//!           hostsim [-t run_s] [-s step_s] [-i Iq_A] [-p Kp] [-I Ki] [-v Vdc_V]
+//!                   [-J J_kgm2] [-c offset_s] [-o offset_cnt] [-k substeps]
+//!                   [-r repeat] [-d decimation] [-w out.csv]
+//!                   [-x step|chirp|prbs|multisine] [-f start_Hz] [-F end_Hz]
+//!
+//!         Every mainISR tick samples the plant through the HAL stub, runs the
+//!         hand copy of the current loop in focsim.c in IQ24 and writes the
+//!         PWM compares.  As on the
+//!         target the new compares load on the next PWM period, so the plant
+//!         sees the previous duty for one of the USER_NUM_PWM_TICKS_PER_ISR_TICK
+//!         periods.  The run starts with the offset calibration at 50% duty,
+//!         then steps the Iq reference at step_s.  The step response is
+//!         reported, and with -r the run is repeated to time it.
+//!
+//!         With -x the Iq reference comes from the firmware excitation
+//!         generator instead, see excite.h, with Iq_A as the amplitude from
+//!         step_s to the end of the run.
+
+
+// **************************************************************************
+// the includes
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "excite.h"
+#include "focsim.h"
+#include "halsim.h"
+#include "pmsm.h"
+#include "user_j1.h"
+
+
+// **************************************************************************
+// the defines
+
+//! \brief Defines the mainISR rate, Hz
+//!
+#define HOSTSIM_ISR_FREQ_Hz         (USER_PWM_FREQ_kHz * 1000.0 / USER_NUM_PWM_TICKS_PER_ISR_TICK)
+
+
+// **************************************************************************
+// the typedefs
+
+//! \brief Defines the run settings
+//!
+typedef struct _HOSTSIM_Config_t_
+{
+  double         run_sec;        //!< the simulated time
+  double         step_sec;       //!< the time of the Iq reference step
+  double         Iq_A;           //!< the Iq reference after the step
+  double         dcBus_V;        //!< the DC bus voltage
+  double         offset_sec;     //!< the offset calibration time, 0 takes the ideal biases
+  double         offset_cnt;     //!< the phase A current sensor offset error, ADC counts
+  double         Kp;             //!< the Id and Iq proportional gain, pu, negative keeps the default
+  double         Ki;             //!< the Id and Iq integral gain, pu, negative keeps the default
+  EXCITE_Mode_e  mode;           //!< the excitation, Off for the plain step
+  double         startFreq_Hz;   //!< the excitation start or fundamental frequency
+  double         endFreq_Hz;     //!< the excitation end or top frequency
+  int            numSubSteps;    //!< the plant steps per PWM period
+  unsigned long  decimation;     //!< ISR ticks per CSV row
+  FILE           *pOut;          //!< the CSV output, NULL for none
+} HOSTSIM_Config_t;
+
+
+//! \brief Defines the step response measurements
+//!
+typedef struct _HOSTSIM_Result_t_
+{
+  double  rise_sec;              //!< the 10% to 90% rise time
+  double  overshoot_pct;         //!< the overshoot past the reference
+  double  error_A;               //!< the mean Iq error over the last tenth of the run
+  double  Id_rms_A;              //!< the RMS Id after the step
+  double  track_A;               //!< the RMS Iq error from step_s on
+  double  speed_rpm;             //!< the final speed
+  double  offset_A[HALSIM_NUM_SENSORS];  //!< the calibrated current offsets
+} HOSTSIM_Result_t;
+
+
+// **************************************************************************
+// the functions
+
+static bool HOSTSIM_setupExcite(const HOSTSIM_Config_t *pConfig,EXCITE_Obj *pExcite)
+{
+  EXCITE_init(pExcite,(uint32_t)HOSTSIM_ISR_FREQ_Hz,(int32_t)(USER_IQ_FULL_SCALE_CURRENT_A * 1000.0));
+
+  return(EXCITE_setParam(pExcite,EXCITE_Param_Mode,(int32_t)pConfig->mode) &&
+         EXCITE_setParam(pExcite,EXCITE_Param_Amplitude_mA,(int32_t)(pConfig->Iq_A * 1000.0)) &&
+         EXCITE_setParam(pExcite,EXCITE_Param_StartFreq_mHz,(int32_t)(pConfig->startFreq_Hz * 1000.0 + 0.5)) &&
+         EXCITE_setParam(pExcite,EXCITE_Param_EndFreq_mHz,(int32_t)(pConfig->endFreq_Hz * 1000.0 + 0.5)) &&
+         EXCITE_setParam(pExcite,EXCITE_Param_Duration_ms,
+                         (int32_t)((pConfig->run_sec - pConfig->step_sec) * 1000.0 + 0.5)) &&
+         EXCITE_start(pExcite));
+} // end of HOSTSIM_setupExcite() function
+
+
+static void HOSTSIM_run(const HOSTSIM_Config_t *pConfig,const PMSM_Params_t *pParams,HOSTSIM_Result_t *pResult)
+{
+  HALSIM_Obj hal;
+  HALSIM_AdcData_t adcData;
+  FOCSIM_Obj foc;
+  EXCITE_Obj excite;
+  PMSM_State_t state;
+  const double isrPeriod_sec = 1.0 / HOSTSIM_ISR_FREQ_Hz;
+  const double dt_sec = isrPeriod_sec / USER_NUM_PWM_TICKS_PER_ISR_TICK / pConfig->numSubSteps;
+  const unsigned long offsetTicks = (unsigned long)(pConfig->offset_sec * HOSTSIM_ISR_FREQ_Hz + 0.5);
+  const unsigned long numTicks = offsetTicks + (unsigned long)(pConfig->run_sec * HOSTSIM_ISR_FREQ_Hz + 0.5);
+  const unsigned long stepTick = offsetTicks + (unsigned long)(pConfig->step_sec * HOSTSIM_ISR_FREQ_Hz + 0.5);
+  const unsigned long tailTick = numTicks - (numTicks - offsetTicks) / 10;
+  double t10 = -1.0, t90 = -1.0, peak = 0.0, errorSum = 0.0, IdSum = 0.0, trackSum = 0.0;
+  unsigned long numError = 0, numId = 0;
+  unsigned long tick;
+  uint_least8_t cnt;
+
+
+  HALSIM_init(&hal);
+  hal.offsetI_cnt[0] = pConfig->offset_cnt;
+
+  FOCSIM_init(&foc);
+  if((pConfig->Kp >= 0.0) && (pConfig->Ki >= 0.0))
+    {
+      FOCSIM_setGains(&foc,_IQ(pConfig->Kp),_IQ(pConfig->Ki));
+    }
+  else if(pConfig->Kp >= 0.0)
+    {
+      FOCSIM_setGains(&foc,_IQ(pConfig->Kp),foc.pidIq.Ki);
+    }
+  else if(pConfig->Ki >= 0.0)
+    {
+      FOCSIM_setGains(&foc,foc.pidIq.Kp,_IQ(pConfig->Ki));
+    }
+
+  PMSM_reset(&state);
+
+  // armed here, the first EXCITE_run() is at stepTick
+  if(pConfig->mode != EXCITE_Mode_Off)
+    {
+      HOSTSIM_setupExcite(pConfig,&excite);
+    }
+
+  if(pConfig->pOut != NULL)
+    {
+      fprintf(pConfig->pOut,"time_s,IqRef_A,Iq_A,Id_A,IqMeas_A,Vd_pu,Vq_pu,Speed_rpm,Torque_Nm\n");
+    }
+
+  for(tick=0;tick<numTicks;tick++)
+    {
+      double Iabc_A[HALSIM_NUM_SENSORS];
+      double Vabc_V[HALSIM_NUM_SENSORS];
+      uint16_t cmpA[HALSIM_NUM_SENSORS];
+      int period, step;
+
+      // sample at the start of the tick
+      PMSM_getIabc(&state,Iabc_A);
+      HALSIM_getPoleVoltages(&hal,pConfig->dcBus_V,Vabc_V);
+      HALSIM_convertAdc(&hal,Iabc_A,Vabc_V,pConfig->dcBus_V);
+
+      for(cnt=0;cnt<HALSIM_NUM_SENSORS;cnt++)
+        {
+          cmpA[cnt] = hal.cmpA[cnt];
+        }
+
+      if(tick < offsetTicks)
+        {
+          // CTRL_State_OffLine, the inverter idles at 50% duty
+          static const _iq Tabc_idle[HALSIM_NUM_SENSORS] = {0, 0, 0};
+
+          HALSIM_readAdcDataWithOffsets(&hal,&adcData);
+          FOCSIM_runOffsets(&foc,&adcData);
+          HALSIM_writePwmData(&hal,Tabc_idle);
+        }
+      else
+        {
+          if((tick == offsetTicks) && (offsetTicks != 0))
+            {
+              // HAL_updateAdcBias()
+              for(cnt=0;cnt<HALSIM_NUM_SENSORS;cnt++)
+                {
+                  hal.biasI[cnt] = FOCSIM_getOffset(&foc,cnt);
+                }
+            }
+
+          if(tick < stepTick)
+            {
+              foc.Iq_ref_pu = _IQ(0.0);
+            }
+          else if(pConfig->mode == EXCITE_Mode_Off)
+            {
+              foc.Iq_ref_pu = _IQ(pConfig->Iq_A / USER_IQ_FULL_SCALE_CURRENT_A);
+            }
+          else
+            {
+              foc.Iq_ref_pu = _IQmpy(_IQ24toIQ(EXCITE_run(&excite)),_IQ(1.0 / USER_IQ_FULL_SCALE_CURRENT_A));
+            }
+
+          HALSIM_readAdcData(&hal,&adcData);
+          FOCSIM_run(&foc,&adcData,_IQ(state.angle_rad / (2.0 * M_PI)));
+          HALSIM_writePwmData(&hal,foc.Tabc);
+        }
+
+      // the new compares load at the end of the first PWM period
+      for(period=0;period<USER_NUM_PWM_TICKS_PER_ISR_TICK;period++)
+        {
+          if(period == 0)
+            {
+              uint16_t cmpA_new[HALSIM_NUM_SENSORS];
+
+              memcpy(cmpA_new,hal.cmpA,sizeof(cmpA_new));
+              memcpy(hal.cmpA,cmpA,sizeof(cmpA));
+              HALSIM_getPoleVoltages(&hal,pConfig->dcBus_V,Vabc_V);
+              memcpy(hal.cmpA,cmpA_new,sizeof(cmpA_new));
+            }
+          else if(period == 1)
+            {
+              HALSIM_getPoleVoltages(&hal,pConfig->dcBus_V,Vabc_V);
+            }
+
+          for(step=0;step<pConfig->numSubSteps;step++)
+            {
+              PMSM_step(pParams,&state,Vabc_V,0.0,dt_sec);
+            }
+        }
+
+      if(tick >= stepTick)
+        {
+          double t_sec = (double)(tick + 1 - stepTick) * isrPeriod_sec;
+          double ratio = state.iq_A / pConfig->Iq_A;
+
+          if((t10 < 0.0) && (ratio >= 0.1))
+            {
+              t10 = t_sec;
+            }
+
+          if((t90 < 0.0) && (ratio >= 0.9))
+            {
+              t90 = t_sec;
+            }
+
+          if(ratio > peak)
+            {
+              peak = ratio;
+            }
+
+          IdSum += state.id_A * state.id_A;
+          numId++;
+
+          {
+            double track_A = state.iq_A - _IQtoD(foc.Iq_ref_pu) * USER_IQ_FULL_SCALE_CURRENT_A;
+
+            trackSum += track_A * track_A;
+          }
+        }
+
+      if(tick >= tailTick)
+        {
+          errorSum += state.iq_A - _IQtoD(foc.Iq_ref_pu) * USER_IQ_FULL_SCALE_CURRENT_A;
+          numError++;
+        }
+
+      if((pConfig->pOut != NULL) && ((tick % pConfig->decimation) == 0))
+        {
+          fprintf(pConfig->pOut,"%.7f,%.5f,%.5f,%.5f,%.5f,%.6f,%.6f,%.3f,%.6f\n",
+                  (double)(tick + 1) * isrPeriod_sec,
+                  _IQtoD(foc.Iq_ref_pu) * USER_IQ_FULL_SCALE_CURRENT_A,
+                  state.iq_A,state.id_A,
+                  _IQtoD(foc.Idq_pu[1]) * USER_IQ_FULL_SCALE_CURRENT_A,
+                  _IQtoD(foc.Vdq_pu[0]),_IQtoD(foc.Vdq_pu[1]),
+                  state.speed_radps * 60.0 / (2.0 * M_PI),
+                  PMSM_getTorque(pParams,&state));
+        }
+    }
+
+  pResult->rise_sec = ((t10 >= 0.0) && (t90 >= 0.0)) ? (t90 - t10) : -1.0;
+  pResult->overshoot_pct = (peak > 1.0) ? (peak - 1.0) * 100.0 : 0.0;
+  pResult->error_A = (numError != 0) ? errorSum / (double)numError : 0.0;
+  pResult->Id_rms_A = (numId != 0) ? sqrt(IdSum / (double)numId) : 0.0;
+  pResult->track_A = (numId != 0) ? sqrt(trackSum / (double)numId) : 0.0;
+  pResult->speed_rpm = state.speed_radps * 60.0 / (2.0 * M_PI);
+
+  for(cnt=0;cnt<HALSIM_NUM_SENSORS;cnt++)
+    {
+      pResult->offset_A[cnt] = _IQtoD(hal.biasI[cnt] - _IQ12mpy((_iq)(1 << (HALSIM_NUM_ADC_BITS - 1)),hal.current_sf)) *
+                               USER_IQ_FULL_SCALE_CURRENT_A;
+    }
+
+  return;
+} // end of HOSTSIM_run() function
+
+
+static EXCITE_Mode_e HOSTSIM_getMode(const char *pName)
+{
+  static const char *names[EXCITE_NumModes] = {"off", "step", "chirp", "prbs", "multisine"};
+  int mode;
+
+
+  for(mode=0;mode<EXCITE_NumModes;mode++)
+    {
+      if(strcmp(pName,names[mode]) == 0)
+        {
+          return((EXCITE_Mode_e)mode);
+        }
+    }
+
+  return(EXCITE_NumModes);
+} // end of HOSTSIM_getMode() function
+
+
+static void HOSTSIM_usage(void)
+{
+  fprintf(stderr,"usage: hostsim [-t run_s] [-s step_s] [-i Iq_A] [-p Kp] [-I Ki] [-v Vdc_V]\n"
+                 "               [-J J_kgm2] [-c offset_s] [-o offset_cnt] [-k substeps]\n"
+                 "               [-r repeat] [-d decimation] [-w out.csv]\n"
+                 "               [-x step|chirp|prbs|multisine] [-f start_Hz] [-F end_Hz]\n");
+} // end of HOSTSIM_usage() function
+
+
+int main(int argc,char *argv[])
+{
+  HOSTSIM_Config_t config;
+  HOSTSIM_Result_t result;
+  PMSM_Params_t params;
+  EXCITE_Obj excite;
+  const char *pOutPath = NULL;
+  struct timespec start, stop;
+  double wall_sec;
+  long numRepeats = 1;
+  long repeat;
+  int opt;
+
+
+  config.run_sec = 0.05;
+  config.step_sec = 0.01;
+  config.Iq_A = 5.0;
+  config.dcBus_V = USER_IQ_FULL_SCALE_VOLTAGE_V;
+  config.offset_sec = 0.5;
+  config.offset_cnt = 0.0;
+  config.Kp = -1.0;
+  config.Ki = -1.0;
+  config.mode = EXCITE_Mode_Off;
+  config.startFreq_Hz = 10.0;
+  config.endFreq_Hz = 1000.0;
+  config.numSubSteps = 2;
+  config.decimation = 1;
+  config.pOut = NULL;
+
+  PMSM_setDefaultParams(&params);
+
+  while((opt = getopt(argc,argv,"t:s:i:p:I:v:J:c:o:k:r:d:w:x:f:F:")) != -1)
+    {
+      switch(opt)
+        {
+          case 't': config.run_sec = strtod(optarg,NULL); break;
+          case 's': config.step_sec = strtod(optarg,NULL); break;
+          case 'i': config.Iq_A = strtod(optarg,NULL); break;
+          case 'p': config.Kp = strtod(optarg,NULL); break;
+          case 'I': config.Ki = strtod(optarg,NULL); break;
+          case 'v': config.dcBus_V = strtod(optarg,NULL); break;
+          case 'J': params.J_kgm2 = strtod(optarg,NULL); break;
+          case 'c': config.offset_sec = strtod(optarg,NULL); break;
+          case 'o': config.offset_cnt = strtod(optarg,NULL); break;
+          case 'k': config.numSubSteps = (int)strtol(optarg,NULL,10); break;
+          case 'r': numRepeats = strtol(optarg,NULL,10); break;
+          case 'd': config.decimation = strtoul(optarg,NULL,10); break;
+          case 'w': pOutPath = optarg; break;
+          case 'x': config.mode = HOSTSIM_getMode(optarg); break;
+          case 'f': config.startFreq_Hz = strtod(optarg,NULL); break;
+          case 'F': config.endFreq_Hz = strtod(optarg,NULL); break;
+          default:  HOSTSIM_usage(); return(2);
+        }
+    }
+
+  if((optind != argc) || (config.run_sec <= config.step_sec) || (config.Iq_A == 0.0) ||
+     (config.dcBus_V <= 0.0) || (config.offset_sec < 0.0) || (params.J_kgm2 <= 0.0) ||
+     (config.numSubSteps < 1) || (numRepeats < 1) || (config.decimation < 1) ||
+     (config.mode == EXCITE_NumModes) ||
+     ((config.mode != EXCITE_Mode_Off) && !HOSTSIM_setupExcite(&config,&excite)))
+    {
+      HOSTSIM_usage();
+      return(2);
+    }
+
+  if(pOutPath != NULL)
+    {
+      config.pOut = fopen(pOutPath,"w");
+      if(config.pOut == NULL)
+        {
+          perror(pOutPath);
+          return(1);
+        }
+    }
+
+  // the CSV is only written on the first run
+  clock_gettime(CLOCK_MONOTONIC,&start);
+  for(repeat=0;repeat<numRepeats;repeat++)
+    {
+      HOSTSIM_run(&config,&params,&result);
+
+      if(config.pOut != NULL)
+        {
+          fclose(config.pOut);
+          config.pOut = NULL;
+        }
+    }
+  clock_gettime(CLOCK_MONOTONIC,&stop);
+
+  wall_sec = (double)(stop.tv_sec - start.tv_sec) + 1.0e-9 * (double)(stop.tv_nsec - start.tv_nsec);
+
+  printf("offsets         %+.4f %+.4f %+.4f A\n",result.offset_A[0],result.offset_A[1],result.offset_A[2]);
+  // the step measurements mean nothing for the other excitations
+  if(config.mode <= EXCITE_Mode_Step)
+    {
+      if(result.rise_sec >= 0.0)
+        {
+          printf("rise 10-90%%     %.1f us\n",result.rise_sec * 1.0e6);
+        }
+      else
+        {
+          printf("rise 10-90%%     not reached\n");
+        }
+      printf("overshoot       %.2f %%\n",result.overshoot_pct);
+      printf("Iq error        %+.4f A\n",result.error_A);
+    }
+  printf("Id rms          %.4f A\n",result.Id_rms_A);
+  printf("Iq tracking rms %.4f A\n",result.track_A);
+  printf("final speed     %.1f rpm\n",result.speed_rpm);
+  printf("%ld run(s) of %.3f s in %.3f s wall, %.0fx real time, %.1f ns per ISR tick\n",
+         numRepeats,config.offset_sec + config.run_sec,wall_sec,
+         numRepeats * (config.offset_sec + config.run_sec) / wall_sec,
+         wall_sec * 1.0e9 / (numRepeats * (config.offset_sec + config.run_sec) * HOSTSIM_ISR_FREQ_Hz));
+
+  return(0);
+} // end of main() function
+
+
+// end of file
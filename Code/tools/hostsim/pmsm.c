@@ -0,0 +1,182 @@
+//! \file   pmsm.c
+//! \brief  Contains the PMSM plant model (PMSM) functions
+//!
+
+
+// **************************************************************************
+// the includes
+
+#include <math.h>
+
+#include "pmsm.h"
+#include "user_j1.h"
+
+
+// **************************************************************************
+// the defines
+
+//! \brief Defines the default wheel inertia, rotor included, kg m^2
+//!
+#define PMSM_DEFAULT_J_kgm2         (5.0e-4)
+
+//! \brief Defines the default viscous friction, Nm per rad/s
+//!
+#define PMSM_DEFAULT_B_Nmps         (2.0e-6)
+
+//! \brief Defines the default Coulomb friction, Nm
+//!
+#define PMSM_DEFAULT_Tc_Nm          (2.0e-3)
+
+
+// **************************************************************************
+// the typedefs
+
+//! \brief Defines the integrated part of the state
+//!
+typedef struct _PMSM_Deriv_t_
+{
+  double  id;
+  double  iq;
+  double  speed;
+  double  angle;
+} PMSM_Deriv_t;
+
+
+// **************************************************************************
+// the functions
+
+void PMSM_setDefaultParams(PMSM_Params_t *pParams)
+{
+  pParams->Rs_Ohm = USER_MOTOR_Rs;
+  pParams->Ls_d_H = USER_MOTOR_Ls_d;
+  pParams->Ls_q_H = USER_MOTOR_Ls_q;
+
+  // USER_MOTOR_RATED_FLUX is in V/Hz
+  pParams->flux_Wb = USER_MOTOR_RATED_FLUX / (2.0 * M_PI);
+  pParams->numPolePairs = USER_MOTOR_NUM_POLE_PAIRS;
+
+  pParams->J_kgm2 = PMSM_DEFAULT_J_kgm2;
+  pParams->B_Nmps = PMSM_DEFAULT_B_Nmps;
+  pParams->Tc_Nm = PMSM_DEFAULT_Tc_Nm;
+
+  return;
+} // end of PMSM_setDefaultParams() function
+
+
+void PMSM_reset(PMSM_State_t *pState)
+{
+  pState->id_A = 0.0;
+  pState->iq_A = 0.0;
+  pState->speed_radps = 0.0;
+  pState->angle_rad = 0.0;
+
+  return;
+} // end of PMSM_reset() function
+
+
+static void PMSM_getDeriv(const PMSM_Params_t *pParams,const PMSM_Deriv_t *pX,
+                          const double valpha,const double vbeta,const double load_Nm,
+                          PMSM_Deriv_t *pDx)
+{
+  double c = cos(pX->angle);
+  double s = sin(pX->angle);
+  double vd = valpha * c + vbeta * s;
+  double vq = -valpha * s + vbeta * c;
+  double we = pParams->numPolePairs * pX->speed;
+  double torque = 1.5 * pParams->numPolePairs *
+                  (pParams->flux_Wb * pX->iq + (pParams->Ls_d_H - pParams->Ls_q_H) * pX->id * pX->iq);
+  double friction = pParams->B_Nmps * pX->speed;
+
+
+  // Coulomb friction only opposes motion, and holds the wheel below it
+  if(pX->speed > 0.0)
+    {
+      friction += pParams->Tc_Nm;
+    }
+  else if(pX->speed < 0.0)
+    {
+      friction -= pParams->Tc_Nm;
+    }
+  else if(fabs(torque - load_Nm) <= pParams->Tc_Nm)
+    {
+      friction = torque - load_Nm;
+    }
+
+  pDx->id = (vd - pParams->Rs_Ohm * pX->id + we * pParams->Ls_q_H * pX->iq) / pParams->Ls_d_H;
+  pDx->iq = (vq - pParams->Rs_Ohm * pX->iq - we * (pParams->Ls_d_H * pX->id + pParams->flux_Wb)) / pParams->Ls_q_H;
+  pDx->speed = (torque - friction - load_Nm) / pParams->J_kgm2;
+  pDx->angle = we;
+
+  return;
+} // end of PMSM_getDeriv() function
+
+
+void PMSM_step(const PMSM_Params_t *pParams,PMSM_State_t *pState,const double *pVabc_V,
+               const double load_Nm,const double dt_sec)
+{
+  // the Clarke transform of the applied voltages is fixed over the step
+  double valpha = (2.0 * pVabc_V[0] - pVabc_V[1] - pVabc_V[2]) / 3.0;
+  double vbeta = (pVabc_V[1] - pVabc_V[2]) / sqrt(3.0);
+  PMSM_Deriv_t x = {pState->id_A, pState->iq_A, pState->speed_radps, pState->angle_rad};
+  PMSM_Deriv_t k1, k2, k3, k4, xt;
+
+
+  PMSM_getDeriv(pParams,&x,valpha,vbeta,load_Nm,&k1);
+
+  xt.id = x.id + 0.5 * dt_sec * k1.id;
+  xt.iq = x.iq + 0.5 * dt_sec * k1.iq;
+  xt.speed = x.speed + 0.5 * dt_sec * k1.speed;
+  xt.angle = x.angle + 0.5 * dt_sec * k1.angle;
+  PMSM_getDeriv(pParams,&xt,valpha,vbeta,load_Nm,&k2);
+
+  xt.id = x.id + 0.5 * dt_sec * k2.id;
+  xt.iq = x.iq + 0.5 * dt_sec * k2.iq;
+  xt.speed = x.speed + 0.5 * dt_sec * k2.speed;
+  xt.angle = x.angle + 0.5 * dt_sec * k2.angle;
+  PMSM_getDeriv(pParams,&xt,valpha,vbeta,load_Nm,&k3);
+
+  xt.id = x.id + dt_sec * k3.id;
+  xt.iq = x.iq + dt_sec * k3.iq;
+  xt.speed = x.speed + dt_sec * k3.speed;
+  xt.angle = x.angle + dt_sec * k3.angle;
+  PMSM_getDeriv(pParams,&xt,valpha,vbeta,load_Nm,&k4);
+
+  pState->id_A = x.id + dt_sec / 6.0 * (k1.id + 2.0 * k2.id + 2.0 * k3.id + k4.id);
+  pState->iq_A = x.iq + dt_sec / 6.0 * (k1.iq + 2.0 * k2.iq + 2.0 * k3.iq + k4.iq);
+  pState->speed_radps = x.speed + dt_sec / 6.0 * (k1.speed + 2.0 * k2.speed + 2.0 * k3.speed + k4.speed);
+  pState->angle_rad = fmod(x.angle + dt_sec / 6.0 * (k1.angle + 2.0 * k2.angle + 2.0 * k3.angle + k4.angle),
+                           2.0 * M_PI);
+
+  if(pState->angle_rad < 0.0)
+    {
+      pState->angle_rad += 2.0 * M_PI;
+    }
+
+  return;
+} // end of PMSM_step() function
+
+
+void PMSM_getIabc(const PMSM_State_t *pState,double *pIabc_A)
+{
+  double c = cos(pState->angle_rad);
+  double s = sin(pState->angle_rad);
+  double ialpha = pState->id_A * c - pState->iq_A * s;
+  double ibeta = pState->id_A * s + pState->iq_A * c;
+
+
+  pIabc_A[0] = ialpha;
+  pIabc_A[1] = -0.5 * ialpha + 0.5 * sqrt(3.0) * ibeta;
+  pIabc_A[2] = -0.5 * ialpha - 0.5 * sqrt(3.0) * ibeta;
+
+  return;
+} // end of PMSM_getIabc() function
+
+
+double PMSM_getTorque(const PMSM_Params_t *pParams,const PMSM_State_t *pState)
+{
+  return(1.5 * pParams->numPolePairs *
+         (pParams->flux_Wb * pState->iq_A + (pParams->Ls_d_H - pParams->Ls_q_H) * pState->id_A * pState->iq_A));
+} // end of PMSM_getTorque() function
+
+
+// end of file
@@ -0,0 +1,107 @@
+#ifndef _PMSM_H_
+#define _PMSM_H_
+
+//! \file   pmsm.h
+//! \brief  Contains the public interface to the PMSM plant model (PMSM) used by
+//!         the host simulation
+//!
+//!         The electrical model is the usual rotor frame one,
+//!
+//!           Ld did/dt = vd - Rs id + we Lq iq
+//!           Lq diq/dt = vq - Rs iq - we Ld id - we flux
+//!
+//!         driven by phase voltages that are held over a step, and turns a
+//!         wheel with viscous and Coulomb friction.  A step is integrated with
+//!         fixed-step RK4.  Everything is double and SI.
+
+
+// **************************************************************************
+// the includes
+
+#include <stdint.h>
+
+
+//!
+//!
+//! \defgroup PMSM PMSM
+//!
+//@{
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+// **************************************************************************
+// the typedefs
+
+//! \brief Defines the plant parameters
+//!
+typedef struct _PMSM_Params_t_
+{
+  double  Rs_Ohm;                //!< phase resistance, Y equivalent
+  double  Ls_d_H;                //!< d axis inductance
+  double  Ls_q_H;                //!< q axis inductance
+  double  flux_Wb;               //!< rotor flux linkage
+  double  numPolePairs;          //!< the number of pole pairs
+  double  J_kgm2;                //!< rotor plus wheel inertia
+  double  B_Nmps;                //!< viscous friction, Nm per rad/s
+  double  Tc_Nm;                 //!< Coulomb friction
+} PMSM_Params_t;
+
+
+//! \brief Defines the plant state
+//!
+typedef struct _PMSM_State_t_
+{
+  double  id_A;                  //!< d axis current
+  double  iq_A;                  //!< q axis current
+  double  speed_radps;           //!< mechanical speed
+  double  angle_rad;             //!< electrical angle, wrapped to [0, 2 pi)
+} PMSM_State_t;
+
+
+// **************************************************************************
+// the function prototypes
+
+//! \brief      Sets the parameters of the motor selected in user_j1.h, with a
+//!             default wheel inertia and friction
+//! \param[out] pParams  A pointer to the parameters
+extern void PMSM_setDefaultParams(PMSM_Params_t *pParams);
+
+
+//! \brief      Sets the plant at rest
+//! \param[out] pState  A pointer to the state
+extern void PMSM_reset(PMSM_State_t *pState);
+
+
+//! \brief         Advances the plant by one step
+//! \param[in]     pParams   A pointer to the parameters
+//! \param[in,out] pState    A pointer to the state
+//! \param[in]     pVabc_V   The phase to neutral voltages, held over the step
+//! \param[in]     load_Nm   The external load torque, held over the step
+//! \param[in]     dt_sec    The step
+extern void PMSM_step(const PMSM_Params_t *pParams,PMSM_State_t *pState,const double *pVabc_V,
+                      const double load_Nm,const double dt_sec);
+
+
+//! \brief      Gets the phase currents
+//! \param[in]  pState   A pointer to the state
+//! \param[out] pIabc_A  A pointer to the three phase currents
+extern void PMSM_getIabc(const PMSM_State_t *pState,double *pIabc_A);
+
+
+//! \brief     Gets the electromagnetic torque
+//! \param[in] pParams  A pointer to the parameters
+//! \param[in] pState   A pointer to the state
+//! \return    The torque, Nm
+extern double PMSM_getTorque(const PMSM_Params_t *pParams,const PMSM_State_t *pState);
+
+
+#ifdef __cplusplus
+}
+#endif // extern "C"
+
+//@} // ingroup
+#endif // end of _PMSM_H_ definition
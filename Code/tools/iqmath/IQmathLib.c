@@ -0,0 +1,191 @@
+//! \file   IQmathLib.c
+//! \brief  Contains the string conversions of the host IQmath emulation
+//!
+//!         Both work one decimal digit at a time in integer arithmetic, the
+//!         way TI's C IQmath sources do, so no rounding happens anywhere: the
+//!         fraction digits of _atoIQN() are folded in from the last one with a
+//!         truncating divide by ten, and _IQNtoa() peels digits off the
+//!         fraction with a multiply by ten.
+
+
+// **************************************************************************
+// the includes
+
+#include <stdbool.h>
+
+#include "IQmathLib.h"
+
+
+// **************************************************************************
+// the defines
+
+//! \brief Defines the widest integer or fraction field of an _IQNtoa() format
+//!
+#define IQMATH_MAX_FORMAT_DIGITS    (11)
+
+
+// **************************************************************************
+// the functions
+
+static bool IQMATH_isDigit(const char c)
+{
+  return((c >= '0') && (c <= '9'));
+} // end of IQMATH_isDigit() function
+
+
+_iq _atoIQN(const char *pString,const int N)
+{
+  const uint64_t limit = (uint64_t)1 << 32;
+  const char *pFraction;
+  uint64_t integer = 0;
+  uint64_t fraction = 0;
+  uint64_t value;
+  bool flag_negative = false;
+
+
+  if(*pString == '-')
+    {
+      flag_negative = true;
+      pString++;
+    }
+  else if(*pString == '+')
+    {
+      pString++;
+    }
+
+  // stop accumulating once the value is out of range, it saturates anyway
+  while(IQMATH_isDigit(*pString))
+    {
+      if(integer < limit)
+        {
+          integer = integer * 10 + (uint64_t)(*pString - '0');
+        }
+
+      pString++;
+    }
+
+  if(*pString == '.')
+    {
+      pString++;
+      pFraction = pString;
+
+      while(IQMATH_isDigit(*pString))
+        {
+          pString++;
+        }
+
+      while(pString != pFraction)
+        {
+          pString--;
+          fraction = (fraction + ((uint64_t)(*pString - '0') << N)) / 10;
+        }
+    }
+
+  value = (integer >= limit) ? limit : ((integer << N) + fraction);
+
+  if(flag_negative)
+    {
+      return((value >= ((uint64_t)1 << 31)) ? MAX_IQ_NEG : (_iq)(0 - (int64_t)value));
+    }
+
+  return((value > (uint64_t)MAX_IQ_POS) ? MAX_IQ_POS : (_iq)value);
+} // end of _atoIQN() function
+
+
+static int IQMATH_parseWidth(const char **ppFormat)
+{
+  int width = 0;
+  int numDigits = 0;
+
+
+  while(IQMATH_isDigit(**ppFormat))
+    {
+      width = width * 10 + (**ppFormat - '0');
+      numDigits++;
+      (*ppFormat)++;
+    }
+
+  if((numDigits == 0) || (numDigits > 2) || (width < 1) || (width > IQMATH_MAX_FORMAT_DIGITS))
+    {
+      return(0);
+    }
+
+  return(width);
+} // end of IQMATH_parseWidth() function
+
+
+int _IQNtoa(char *pString,const char *pFormat,const _iq A,const int N)
+{
+  const uint32_t mask = (N >= 32) ? 0xFFFFFFFFUL : (((uint32_t)1 << N) - 1);
+  char digits[IQMATH_MAX_FORMAT_DIGITS];
+  uint32_t magnitude;
+  uint32_t integer;
+  uint64_t fraction;
+  int integerWidth;
+  int fractionWidth;
+  int numDigits = 0;
+  int cnt;
+
+
+  *pString = '\0';
+
+  if(*pFormat++ != '%')
+    {
+      return(2);
+    }
+
+  integerWidth = IQMATH_parseWidth(&pFormat);
+
+  if((integerWidth == 0) || (*pFormat++ != '.'))
+    {
+      return(2);
+    }
+
+  fractionWidth = IQMATH_parseWidth(&pFormat);
+
+  if((fractionWidth == 0) || ((*pFormat != 'f') && (*pFormat != 'F')) || (pFormat[1] != '\0'))
+    {
+      return(2);
+    }
+
+  magnitude = (A < 0) ? (0U - (uint32_t)A) : (uint32_t)A;
+  integer = magnitude >> N;
+  fraction = magnitude & mask;
+
+  do
+    {
+      if(numDigits == integerWidth)
+        {
+          return(1);
+        }
+
+      digits[numDigits++] = (char)('0' + integer % 10);
+      integer /= 10;
+    } while(integer != 0);
+
+  if(A < 0)
+    {
+      *pString++ = '-';
+    }
+
+  for(cnt=numDigits-1;cnt>=0;cnt--)
+    {
+      *pString++ = digits[cnt];
+    }
+
+  *pString++ = '.';
+
+  for(cnt=0;cnt<fractionWidth;cnt++)
+    {
+      fraction *= 10;
+      *pString++ = (char)('0' + (fraction >> N));
+      fraction &= mask;
+    }
+
+  *pString = '\0';
+
+  return(0);
+} // end of _IQNtoa() function
+
+
+// end of file
@@ -0,0 +1,233 @@
+#ifndef _IQMATHLIB_H_
+#define _IQMATHLIB_H_
+
+//! \file   IQmathLib.h
+//! \brief  Contains a host emulation of the subset of TI IQmath used by the
+//!         firmware and the host tools
+//!
+//!         _iq is a signed 32 bit value with GLOBAL_Q fractional bits, as on
+//!         the C28x.  The results match the target bit for bit where the
+//!         target result is set by the instruction set:
+//!
+//!           _IQNmpy    IMPYL/QMPYL then a 64 bit shift, so the product is
+//!                      truncated toward minus infinity and wraps on overflow
+//!           _IQNrmpy   as _IQNmpy with 2^(N-1) added first, round half up
+//!           _IQNrsmpy  as _IQNrmpy and saturated to the 32 bit range
+//!           _IQabs     ABS with OVM clear, so 0x80000000 stays 0x80000000
+//!           _IQNtoIQ   arithmetic shifts, truncating toward minus infinity
+//!
+//!         _IQsqrt returns the square root rounded to the nearest LSB and 0
+//!         for negative inputs.  _atoIQ and _IQtoa, in IQmathLib.c, follow the
+//!         digit by digit algorithm of TI's C IQmath sources.  These three are
+//!         library routines rather than instructions, so iqbench -v can check
+//!         them against vectors captured on the target.
+//!
+//!         The trigonometric functions and _IQdiv go through double and are
+//!         only close to the IQmath.lib results.
+//!
+//!         iqbatch.h has the same operations on arrays, with SSE4.1 and
+//!         AVX2 versions.
+
+
+// **************************************************************************
+// the includes
+
+#include <math.h>
+#include <stdint.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+// **************************************************************************
+// the defines
+
+#ifndef GLOBAL_Q
+#define GLOBAL_Q                    24
+#endif
+
+//! \brief Defines the largest and smallest IQ values
+//!
+#define MAX_IQ_POS                  INT32_MAX
+#define MAX_IQ_NEG                  INT32_MIN
+
+#define _IQ30(A)                    _IQN(A,30)
+#define _IQ24(A)                    _IQN(A,24)
+#define _IQ15(A)                    _IQN(A,15)
+#define _IQ12(A)                    _IQN(A,12)
+#define _IQ(A)                      _IQN(A,GLOBAL_Q)
+
+//! \brief Converts a double constant to IQ(N), truncating toward zero like the TI macro
+//!
+#define _IQN(A,N)                   ((_iq)((A) * (double)(1L << (N))))
+
+#define _IQtoF(A)                   ((float)(A) / (float)(1L << GLOBAL_Q))
+#define _IQtoD(A)                   ((double)(A) / (double)(1L << GLOBAL_Q))
+#define _IQ30toF(A)                 ((float)(A) / (float)(1L << 30))
+
+#define _IQ24toIQ(A)                _IQNtoIQ(A,24)
+#define _IQ30toIQ(A)                _IQNtoIQ(A,30)
+#define _IQtoIQ24(A)                _IQtoIQN(A,24)
+#define _IQtoIQ30(A)                _IQtoIQN(A,30)
+
+#define _IQmpy(A,B)                 _IQNmpy(A,B,GLOBAL_Q)
+#define _IQ12mpy(A,B)               _IQNmpy(A,B,12)
+#define _IQ24mpy(A,B)               _IQNmpy(A,B,24)
+#define _IQ30mpy(A,B)               _IQNmpy(A,B,30)
+
+#define _IQrmpy(A,B)                _IQNrmpy(A,B,GLOBAL_Q)
+#define _IQrsmpy(A,B)               _IQNrsmpy(A,B,GLOBAL_Q)
+
+#define _IQsqrt(A)                  _IQNsqrt(A,GLOBAL_Q)
+#define _IQtoa(S,F,A)               _IQNtoa(S,F,A,GLOBAL_Q)
+#define _atoIQ(S)                   _atoIQN(S,GLOBAL_Q)
+
+#define _IQsat(A,Pos,Neg)           ((A) > (Pos) ? (Pos) : ((A) < (Neg) ? (Neg) : (A)))
+
+
+// **************************************************************************
+// the typedefs
+
+typedef int32_t _iq;
+
+
+// **************************************************************************
+// the function prototypes
+
+//! \brief     Converts a decimal string to IQ(N), see IQmathLib.c
+//! \param[in] pString  The string, an optional sign, digits, an optional point and digits
+//! \param[in] N        The number of fractional bits
+//! \return    The value truncated toward zero, saturated to the IQ(N) range
+extern _iq _atoIQN(const char *pString,const int N);
+
+
+//! \brief      Converts an IQ(N) value to a decimal string, see IQmathLib.c
+//! \param[out] pString  The string, at least width + fraction digits + 3 characters
+//! \param[in]  pFormat  The format, "%I.Ff" with I and F from 1 to 11
+//! \param[in]  A        The value
+//! \param[in]  N        The number of fractional bits
+//! \return     0 on success, 1 if the integer part needs more than I digits, 2 for a bad format
+extern int _IQNtoa(char *pString,const char *pFormat,const _iq A,const int N);
+
+
+// **************************************************************************
+// the functions
+
+//! \brief Converts IQ(N) to GLOBAL_Q, wrapping on overflow like the C28x shifts
+static inline _iq _IQNtoIQ(const _iq A,const int N)
+{
+  return(N >= GLOBAL_Q ? (_iq)(A >> (N - GLOBAL_Q)) : (_iq)((uint32_t)A << (GLOBAL_Q - N)));
+} // end of _IQNtoIQ() function
+
+
+//! \brief Converts GLOBAL_Q to IQ(N), wrapping on overflow like the C28x shifts
+static inline _iq _IQtoIQN(const _iq A,const int N)
+{
+  return(N >= GLOBAL_Q ? (_iq)((uint32_t)A << (N - GLOBAL_Q)) : (_iq)(A >> (GLOBAL_Q - N)));
+} // end of _IQtoIQN() function
+
+
+//! \brief Multiplies two IQ(N) values, truncating the 64 bit product
+static inline _iq _IQNmpy(const _iq A,const _iq B,const int N)
+{
+  return((_iq)(uint32_t)(((int64_t)A * (int64_t)B) >> N));
+} // end of _IQNmpy() function
+
+
+//! \brief Multiplies two IQ(N) values, rounding the 64 bit product
+static inline _iq _IQNrmpy(const _iq A,const _iq B,const int N)
+{
+  return((_iq)(uint32_t)(((int64_t)A * (int64_t)B + ((int64_t)1 << (N - 1))) >> N));
+} // end of _IQNrmpy() function
+
+
+//! \brief Multiplies two IQ(N) values, rounding and saturating the 64 bit product
+static inline _iq _IQNrsmpy(const _iq A,const _iq B,const int N)
+{
+  int64_t value = ((int64_t)A * (int64_t)B + ((int64_t)1 << (N - 1))) >> N;
+
+  return((_iq)_IQsat(value,(int64_t)MAX_IQ_POS,(int64_t)MAX_IQ_NEG));
+} // end of _IQNrsmpy() function
+
+
+//! \brief Absolute value, 0x80000000 is returned unchanged
+static inline _iq _IQabs(const _iq A)
+{
+  return(A < 0 ? (_iq)(0U - (uint32_t)A) : A);
+} // end of _IQabs() function
+
+
+//! \brief Square root of an IQ(N) value rounded to the nearest LSB, 0 for negative inputs
+static inline _iq _IQNsqrt(const _iq A,const int N)
+{
+  uint64_t value;
+  uint64_t root;
+
+
+  if(A <= 0)
+    {
+      return(0);
+    }
+
+  value = (uint64_t)A << N;
+
+  // the double estimate is within one of the integer root, fix it up
+  root = (uint64_t)sqrt((double)value);
+
+  while(root * root > value)
+    {
+      root--;
+    }
+
+  while((root + 1) * (root + 1) <= value)
+    {
+      root++;
+    }
+
+  // (root + 1/2)^2 = root^2 + root + 1/4
+  if((value - root * root) > root)
+    {
+      root++;
+    }
+
+  return((_iq)root);
+} // end of _IQNsqrt() function
+
+
+//! \brief Divides two IQ values, saturating on overflow
+static inline _iq _IQdiv(const _iq A,const _iq B)
+{
+  int64_t q;
+
+  if(B == 0)
+    {
+      return(A >= 0 ? MAX_IQ_POS : MAX_IQ_NEG);
+    }
+
+  q = ((int64_t)A * ((int64_t)1 << GLOBAL_Q)) / B;
+
+  return((_iq)_IQsat(q,(int64_t)MAX_IQ_POS,(int64_t)MAX_IQ_NEG));
+} // end of _IQdiv() function
+
+
+//! \brief Sine of an angle in per unit of a revolution
+static inline _iq _IQsinPU(const _iq A)
+{
+  return(_IQ(sin(2.0 * M_PI * _IQtoD(A))));
+} // end of _IQsinPU() function
+
+
+//! \brief Cosine of an angle in per unit of a revolution
+static inline _iq _IQcosPU(const _iq A)
+{
+  return(_IQ(cos(2.0 * M_PI * _IQtoD(A))));
+} // end of _IQcosPU() function
+
+
+#ifdef __cplusplus
+}
+#endif // extern "C"
+
+#endif // end of _IQMATHLIB_H_ definition
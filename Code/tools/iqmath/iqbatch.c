@@ -0,0 +1,222 @@
+//! \file   iqbatch.c
+//! \brief  Contains the array forms of the host IQmath emulation (IQBATCH)
+//!
+
+
+// **************************************************************************
+// the includes
+
+#if defined(__AVX2__) || defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
+
+#include "iqbatch.h"
+
+
+// **************************************************************************
+// the defines
+
+#if defined(__AVX2__)
+#define IQBATCH_ISA                 "avx2"
+#define IQBATCH_WIDTH               (8)
+#elif defined(__SSE4_1__)
+#define IQBATCH_ISA                 "sse4.1"
+#define IQBATCH_WIDTH               (4)
+#else
+#define IQBATCH_ISA                 "scalar"
+#define IQBATCH_WIDTH               (1)
+#endif
+
+
+// **************************************************************************
+// the functions
+
+const char *IQBATCH_getIsa(void)
+{
+  return(IQBATCH_ISA);
+} // end of IQBATCH_getIsa() function
+
+
+#if defined(__AVX2__)
+static inline __m256i IQBATCH_mpy8(const __m256i a,const __m256i b,const __m128i shiftEven,const __m128i shiftOdd)
+{
+  // the signed products of the even and the odd elements
+  __m256i even = _mm256_mul_epi32(a,b);
+  __m256i odd = _mm256_mul_epi32(_mm256_srli_epi64(a,32),_mm256_srli_epi64(b,32));
+
+  // bits N to N + 31 go to the low half of the even and the high half of the odd lanes
+  even = _mm256_srl_epi64(even,shiftEven);
+  odd = _mm256_sll_epi64(odd,shiftOdd);
+
+  return(_mm256_blend_epi32(even,odd,0xAA));
+} // end of IQBATCH_mpy8() function
+#elif defined(__SSE4_1__)
+static inline __m128i IQBATCH_mpy4(const __m128i a,const __m128i b,const __m128i shiftEven,const __m128i shiftOdd)
+{
+  __m128i even = _mm_mul_epi32(a,b);
+  __m128i odd = _mm_mul_epi32(_mm_srli_epi64(a,32),_mm_srli_epi64(b,32));
+
+  even = _mm_srl_epi64(even,shiftEven);
+  odd = _mm_sll_epi64(odd,shiftOdd);
+
+  return(_mm_blend_epi16(even,odd,0xCC));
+} // end of IQBATCH_mpy4() function
+#endif
+
+
+void IQBATCH_mpy(_iq *pOut,const _iq *pA,const _iq *pB,const size_t num,const int N)
+{
+  size_t cnt = 0;
+
+#if defined(__AVX2__)
+  const __m128i shiftEven = _mm_cvtsi32_si128(N);
+  const __m128i shiftOdd = _mm_cvtsi32_si128(32 - N);
+
+  for(;(cnt + IQBATCH_WIDTH)<=num;cnt+=IQBATCH_WIDTH)
+    {
+      __m256i a = _mm256_loadu_si256((const __m256i *)&pA[cnt]);
+      __m256i b = _mm256_loadu_si256((const __m256i *)&pB[cnt]);
+
+      _mm256_storeu_si256((__m256i *)&pOut[cnt],IQBATCH_mpy8(a,b,shiftEven,shiftOdd));
+    }
+#elif defined(__SSE4_1__)
+  const __m128i shiftEven = _mm_cvtsi32_si128(N);
+  const __m128i shiftOdd = _mm_cvtsi32_si128(32 - N);
+
+  for(;(cnt + IQBATCH_WIDTH)<=num;cnt+=IQBATCH_WIDTH)
+    {
+      __m128i a = _mm_loadu_si128((const __m128i *)&pA[cnt]);
+      __m128i b = _mm_loadu_si128((const __m128i *)&pB[cnt]);
+
+      _mm_storeu_si128((__m128i *)&pOut[cnt],IQBATCH_mpy4(a,b,shiftEven,shiftOdd));
+    }
+#endif
+
+  for(;cnt<num;cnt++)
+    {
+      pOut[cnt] = _IQNmpy(pA[cnt],pB[cnt],N);
+    }
+
+  return;
+} // end of IQBATCH_mpy() function
+
+
+void IQBATCH_mpyK(_iq *pOut,const _iq *pA,const _iq K,const _iq offset,const size_t num,const int N)
+{
+  size_t cnt = 0;
+
+#if defined(__AVX2__)
+  const __m128i shiftEven = _mm_cvtsi32_si128(N);
+  const __m128i shiftOdd = _mm_cvtsi32_si128(32 - N);
+  const __m256i k = _mm256_set1_epi32(K);
+  const __m256i o = _mm256_set1_epi32(offset);
+
+  for(;(cnt + IQBATCH_WIDTH)<=num;cnt+=IQBATCH_WIDTH)
+    {
+      __m256i a = _mm256_loadu_si256((const __m256i *)&pA[cnt]);
+
+      _mm256_storeu_si256((__m256i *)&pOut[cnt],_mm256_sub_epi32(IQBATCH_mpy8(a,k,shiftEven,shiftOdd),o));
+    }
+#elif defined(__SSE4_1__)
+  const __m128i shiftEven = _mm_cvtsi32_si128(N);
+  const __m128i shiftOdd = _mm_cvtsi32_si128(32 - N);
+  const __m128i k = _mm_set1_epi32(K);
+  const __m128i o = _mm_set1_epi32(offset);
+
+  for(;(cnt + IQBATCH_WIDTH)<=num;cnt+=IQBATCH_WIDTH)
+    {
+      __m128i a = _mm_loadu_si128((const __m128i *)&pA[cnt]);
+
+      _mm_storeu_si128((__m128i *)&pOut[cnt],_mm_sub_epi32(IQBATCH_mpy4(a,k,shiftEven,shiftOdd),o));
+    }
+#endif
+
+  // the subtraction wraps, as on the C28x
+  for(;cnt<num;cnt++)
+    {
+      pOut[cnt] = (_iq)((uint32_t)_IQNmpy(pA[cnt],K,N) - (uint32_t)offset);
+    }
+
+  return;
+} // end of IQBATCH_mpyK() function
+
+
+void IQBATCH_abs(_iq *pOut,const _iq *pA,const size_t num)
+{
+  size_t cnt = 0;
+
+  // PABSD also leaves 0x80000000 unchanged
+#if defined(__AVX2__)
+  for(;(cnt + IQBATCH_WIDTH)<=num;cnt+=IQBATCH_WIDTH)
+    {
+      __m256i a = _mm256_loadu_si256((const __m256i *)&pA[cnt]);
+
+      _mm256_storeu_si256((__m256i *)&pOut[cnt],_mm256_abs_epi32(a));
+    }
+#elif defined(__SSE4_1__)
+  for(;(cnt + IQBATCH_WIDTH)<=num;cnt+=IQBATCH_WIDTH)
+    {
+      __m128i a = _mm_loadu_si128((const __m128i *)&pA[cnt]);
+
+      _mm_storeu_si128((__m128i *)&pOut[cnt],_mm_abs_epi32(a));
+    }
+#endif
+
+  for(;cnt<num;cnt++)
+    {
+      pOut[cnt] = _IQabs(pA[cnt]);
+    }
+
+  return;
+} // end of IQBATCH_abs() function
+
+
+void IQBATCH_sat(_iq *pOut,const _iq *pA,const _iq pos,const _iq neg,const size_t num)
+{
+  size_t cnt = 0;
+
+#if defined(__AVX2__)
+  const __m256i p = _mm256_set1_epi32(pos);
+  const __m256i n = _mm256_set1_epi32(neg);
+
+  for(;(cnt + IQBATCH_WIDTH)<=num;cnt+=IQBATCH_WIDTH)
+    {
+      __m256i a = _mm256_loadu_si256((const __m256i *)&pA[cnt]);
+
+      _mm256_storeu_si256((__m256i *)&pOut[cnt],_mm256_min_epi32(_mm256_max_epi32(a,n),p));
+    }
+#elif defined(__SSE4_1__)
+  const __m128i p = _mm_set1_epi32(pos);
+  const __m128i n = _mm_set1_epi32(neg);
+
+  for(;(cnt + IQBATCH_WIDTH)<=num;cnt+=IQBATCH_WIDTH)
+    {
+      __m128i a = _mm_loadu_si128((const __m128i *)&pA[cnt]);
+
+      _mm_storeu_si128((__m128i *)&pOut[cnt],_mm_min_epi32(_mm_max_epi32(a,n),p));
+    }
+#endif
+
+  for(;cnt<num;cnt++)
+    {
+      pOut[cnt] = _IQsat(pA[cnt],pos,neg);
+    }
+
+  return;
+} // end of IQBATCH_sat() function
+
+
+void IQBATCH_sqrt(_iq *pOut,const _iq *pA,const size_t num,const int N)
+{
+  size_t cnt;
+
+  for(cnt=0;cnt<num;cnt++)
+    {
+      pOut[cnt] = _IQNsqrt(pA[cnt],N);
+    }
+
+  return;
+} // end of IQBATCH_sqrt() function
+
+
+// end of file
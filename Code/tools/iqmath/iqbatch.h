@@ -0,0 +1,93 @@
+#ifndef _IQBATCH_H_
+#define _IQBATCH_H_
+
+//! \file   iqbatch.h
+//! \brief  Contains the public interface to the array forms of the host IQmath
+//!         emulation (IQBATCH)
+//!
+//!         Every function gives the same result, element by element, as the
+//!         scalar operation in IQmathLib.h.  The vector path is picked when
+//!         the file is compiled: AVX2 with -mavx2, SSE4.1 with -msse4.1, plain
+//!         C otherwise.  The multiplies keep only bits N to N + 31 of each 64
+//!         bit product, which a logical shift gives as well as an arithmetic
+//!         one, so the missing 64 bit arithmetic shift does not matter.
+//!         Arrays need no particular alignment.
+
+
+// **************************************************************************
+// the includes
+
+#include <stddef.h>
+
+#include "IQmathLib.h"
+
+
+//!
+//!
+//! \defgroup IQBATCH IQBATCH
+//!
+//@{
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+// **************************************************************************
+// the function prototypes
+
+//! \brief  Gets the instruction set the module was compiled for
+//! \return "avx2", "sse4.1" or "scalar"
+extern const char *IQBATCH_getIsa(void);
+
+
+//! \brief      pOut[i] = _IQNmpy(pA[i],pB[i],N)
+//! \param[out] pOut  A pointer to the results, may be pA or pB
+//! \param[in]  pA    A pointer to the first operands
+//! \param[in]  pB    A pointer to the second operands
+//! \param[in]  num   The number of elements
+//! \param[in]  N     The number of fractional bits, 1 to 31
+extern void IQBATCH_mpy(_iq *pOut,const _iq *pA,const _iq *pB,const size_t num,const int N);
+
+
+//! \brief      pOut[i] = _IQNmpy(pA[i],K,N) - offset, the HAL_readAdcData() scaling
+//! \param[out] pOut    A pointer to the results, may be pA
+//! \param[in]  pA      A pointer to the operands
+//! \param[in]  K       The scale factor
+//! \param[in]  offset  The offset subtracted after the multiply
+//! \param[in]  num     The number of elements
+//! \param[in]  N       The number of fractional bits, 1 to 31
+extern void IQBATCH_mpyK(_iq *pOut,const _iq *pA,const _iq K,const _iq offset,const size_t num,const int N);
+
+
+//! \brief      pOut[i] = _IQabs(pA[i])
+//! \param[out] pOut  A pointer to the results, may be pA
+//! \param[in]  pA    A pointer to the operands
+//! \param[in]  num   The number of elements
+extern void IQBATCH_abs(_iq *pOut,const _iq *pA,const size_t num);
+
+
+//! \brief      pOut[i] = _IQsat(pA[i],pos,neg)
+//! \param[out] pOut  A pointer to the results, may be pA
+//! \param[in]  pA    A pointer to the operands
+//! \param[in]  pos   The upper limit
+//! \param[in]  neg   The lower limit, at most pos
+//! \param[in]  num   The number of elements
+extern void IQBATCH_sat(_iq *pOut,const _iq *pA,const _iq pos,const _iq neg,const size_t num);
+
+
+//! \brief      pOut[i] = _IQNsqrt(pA[i],N), one element at a time on every path
+//! \param[out] pOut  A pointer to the results, may be pA
+//! \param[in]  pA    A pointer to the operands
+//! \param[in]  num   The number of elements
+//! \param[in]  N     The number of fractional bits
+extern void IQBATCH_sqrt(_iq *pOut,const _iq *pA,const size_t num,const int N);
+
+
+#ifdef __cplusplus
+}
+#endif // extern "C"
+
+//@} // ingroup
+#endif // end of _IQBATCH_H_ definition
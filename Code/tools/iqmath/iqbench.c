@@ -0,0 +1,728 @@
+//! \file   iqbench.c
+//! \brief  Checks the host IQmath emulation and times it against float and double
+//!
+//!         Build on Linux from this directory with one of
+//!
+//!           cc -O2 -mavx2 -o iqbench iqbench.c iqbatch.c IQmathLib.c -lm
+//!           cc -O2 -msse4.1 -o iqbench iqbench.c iqbatch.c IQmathLib.c -lm
+//!           cc -O2 -o iqbench iqbench.c iqbatch.c IQmathLib.c -lm
+//!
+//!         Usage
+//!
+//!           iqbench [-n num] [-r repeats] [-s seed] [-v vectors.csv]
+//!
+//!         The checks run first and the exit status is 1 if any fails:
+//!
+//!           - fixed cases whose C28x result follows from the instruction set
+//!           - every iqbatch.h function against the scalar one on random data
+//!             salted with 0, -1, 0x7FFFFFFF and 0x80000000
+//!           - _IQsqrt, _atoIQ and _IQtoa against exact integer arithmetic
+//!           - with -v, vectors captured on the target, one per line
+//!
+//!             mpy|mpy12|mpy30|rmpy|rsmpy,<A>,<B>,<result>
+//!             abs|sqrt|30toIQ,<A>,<result>
+//!             atoIQ,<string>,<result>
+//!             IQtoa,<format>,<A>,<string>
+//!
+//!           with integers in C notation, so hexadecimal works, and # comments
+//!
+//!         The timings are over num elements, repeated, and reported in
+//!         nanoseconds per element.
+
+
+// **************************************************************************
+// the includes
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "IQmathLib.h"
+#include "iqbatch.h"
+
+
+// **************************************************************************
+// the defines
+
+//! \brief Defines the number of random operands per check
+//!
+#define IQBENCH_NUM_CHECKS          (1000000)
+
+//! \brief Defines the longest vector file line
+//!
+#define IQBENCH_MAX_LINE_LENGTH     (256)
+
+
+// **************************************************************************
+// the globals
+
+static uint64_t gSeed = 0x9E3779B97F4A7C15ULL;
+
+static unsigned long gNumFailures = 0;
+
+static volatile int32_t gSink;
+
+
+// **************************************************************************
+// the functions
+
+static uint32_t IQBENCH_rand(void)
+{
+  // xorshift64*
+  gSeed ^= gSeed >> 12;
+  gSeed ^= gSeed << 25;
+  gSeed ^= gSeed >> 27;
+
+  return((uint32_t)((gSeed * 0x2545F4914F6CDD1DULL) >> 32));
+} // end of IQBENCH_rand() function
+
+
+static _iq IQBENCH_randIq(void)
+{
+  static const _iq salt[] = {0, -1, MAX_IQ_POS, MAX_IQ_NEG};
+  uint32_t r = IQBENCH_rand();
+
+  // salt 1 in 64 with edge values, otherwise any magnitude from a few LSB up
+  if((r & 0x3F) == 0)
+    {
+      return(salt[(r >> 6) & 3]);
+    }
+
+  return((_iq)(IQBENCH_rand() >> (r >> 27)) * (((r >> 6) & 1) ? -1 : 1));
+} // end of IQBENCH_randIq() function
+
+
+static void IQBENCH_fail(const char *pName,const long long a,const long long b,
+                         const long long expected,const long long result)
+{
+  if(gNumFailures++ < 20)
+    {
+      fprintf(stderr,"iqbench: %s(0x%llX,0x%llX) = 0x%llX, expected 0x%llX\n",
+              pName,a & 0xFFFFFFFFLL,b & 0xFFFFFFFFLL,result & 0xFFFFFFFFLL,expected & 0xFFFFFFFFLL);
+    }
+} // end of IQBENCH_fail() function
+
+
+static void IQBENCH_expect(const char *pName,const _iq a,const _iq b,const _iq expected,const _iq result)
+{
+  if(result != expected)
+    {
+      IQBENCH_fail(pName,a,b,expected,result);
+    }
+} // end of IQBENCH_expect() function
+
+
+static void IQBENCH_checkFixed(void)
+{
+  char string[32];
+
+
+  // the 64 bit product shifted down, wrapping and truncating toward minus infinity
+  IQBENCH_expect("_IQmpy",MAX_IQ_NEG,MAX_IQ_NEG,0,_IQmpy(MAX_IQ_NEG,MAX_IQ_NEG));
+  IQBENCH_expect("_IQmpy",_IQ(100.0),_IQ(2.0),(_iq)0xC8000000,_IQmpy(_IQ(100.0),_IQ(2.0)));
+  IQBENCH_expect("_IQmpy",-1,1,-1,_IQmpy(-1,1));
+  IQBENCH_expect("_IQmpy",1,1,0,_IQmpy(1,1));
+  IQBENCH_expect("_IQ12mpy",4095,-4096,-4095,_IQ12mpy(4095,-4096));
+  IQBENCH_expect("_IQ12mpy",-4095,2047,-2047,_IQ12mpy(-4095,2047));
+  IQBENCH_expect("_IQ30mpy",_IQ30(-0.5),_IQ30(0.5),_IQ30(-0.25),_IQ30mpy(_IQ30(-0.5),_IQ30(0.5)));
+
+  // round half up, and saturate only for the rs form
+  IQBENCH_expect("_IQrmpy",-1,1 << 23,0,_IQrmpy(-1,1 << 23));
+  IQBENCH_expect("_IQrmpy",1,1 << 23,1,_IQrmpy(1,1 << 23));
+  IQBENCH_expect("_IQrmpy",-3,1 << 23,-1,_IQrmpy(-3,1 << 23));
+  IQBENCH_expect("_IQrsmpy",_IQ(100.0),_IQ(2.0),MAX_IQ_POS,_IQrsmpy(_IQ(100.0),_IQ(2.0)));
+  IQBENCH_expect("_IQrsmpy",_IQ(-100.0),_IQ(2.0),MAX_IQ_NEG,_IQrsmpy(_IQ(-100.0),_IQ(2.0)));
+
+  IQBENCH_expect("_IQabs",MAX_IQ_NEG,0,MAX_IQ_NEG,_IQabs(MAX_IQ_NEG));
+  IQBENCH_expect("_IQabs",-5,0,5,_IQabs(-5));
+  IQBENCH_expect("_IQ30toIQ",-1,0,-1,_IQ30toIQ(-1));
+  IQBENCH_expect("_IQ30toIQ",_IQ30(1.5),0,_IQ(1.5),_IQ30toIQ(_IQ30(1.5)));
+  IQBENCH_expect("_IQtoIQ30",_IQ(2.5),0,(_iq)0xA0000000,_IQtoIQ30(_IQ(2.5)));
+
+  IQBENCH_expect("_IQsqrt",_IQ(4.0),0,_IQ(2.0),_IQsqrt(_IQ(4.0)));
+  IQBENCH_expect("_IQsqrt",_IQ(2.0),0,23726566,_IQsqrt(_IQ(2.0)));
+  IQBENCH_expect("_IQsqrt",-1,0,0,_IQsqrt(-1));
+  IQBENCH_expect("_IQsqrt",1,0,4096,_IQsqrt(1));
+
+  IQBENCH_expect("_atoIQ",0,0,_IQ(1.5),_atoIQ("1.5"));
+  IQBENCH_expect("_atoIQ",0,0,-1,_atoIQ("-0.0000001"));
+  IQBENCH_expect("_atoIQ",0,0,MAX_IQ_POS,_atoIQ("128"));
+  IQBENCH_expect("_atoIQ",0,0,MAX_IQ_NEG,_atoIQ("-128"));
+  IQBENCH_expect("_atoIQ",0,0,MAX_IQ_NEG,_atoIQ("-99999999999999999999"));
+  IQBENCH_expect("_atoIQ",0,0,MAX_IQ_POS,_atoIQ("127.99999999999"));
+
+  IQBENCH_expect("_IQtoa",0,0,0,_IQtoa(string,"%3.4f",_IQ(-12.34567)));
+  if(strcmp(string,"-12.3456") != 0)
+    {
+      IQBENCH_fail("_IQtoa string",_IQ(-12.34567),0,0,0);
+    }
+
+  IQBENCH_expect("_IQtoa",0,0,1,_IQtoa(string,"%1.4f",_IQ(12.0)));
+  IQBENCH_expect("_IQtoa",0,0,2,_IQtoa(string,"%3.4d",_IQ(12.0)));
+  IQBENCH_expect("_IQtoa",0,0,2,_IQtoa(string,"3.4f",_IQ(12.0)));
+
+  return;
+} // end of IQBENCH_checkFixed() function
+
+
+static void IQBENCH_checkBatch(const size_t num)
+{
+  _iq *pA = malloc(num * sizeof(_iq));
+  _iq *pB = malloc(num * sizeof(_iq));
+  _iq *pOut = malloc(num * sizeof(_iq));
+  static const int N[] = {12, 24, 30};
+  size_t cnt;
+  int n;
+
+
+  for(cnt=0;cnt<num;cnt++)
+    {
+      pA[cnt] = IQBENCH_randIq();
+      pB[cnt] = IQBENCH_randIq();
+    }
+
+  for(n=0;n<(int)(sizeof(N) / sizeof(N[0]));n++)
+    {
+      IQBATCH_mpy(pOut,pA,pB,num,N[n]);
+      for(cnt=0;cnt<num;cnt++)
+        {
+          IQBENCH_expect("IQBATCH_mpy",pA[cnt],pB[cnt],_IQNmpy(pA[cnt],pB[cnt],N[n]),pOut[cnt]);
+        }
+
+      IQBATCH_mpyK(pOut,pA,pB[0],pB[1],num,N[n]);
+      for(cnt=0;cnt<num;cnt++)
+        {
+          _iq expected = (_iq)((uint32_t)_IQNmpy(pA[cnt],pB[0],N[n]) - (uint32_t)pB[1]);
+
+          IQBENCH_expect("IQBATCH_mpyK",pA[cnt],pB[0],expected,pOut[cnt]);
+        }
+    }
+
+  IQBATCH_abs(pOut,pA,num);
+  for(cnt=0;cnt<num;cnt++)
+    {
+      IQBENCH_expect("IQBATCH_abs",pA[cnt],0,_IQabs(pA[cnt]),pOut[cnt]);
+    }
+
+  IQBATCH_sat(pOut,pA,_IQ(0.5),_IQ(-0.5),num);
+  for(cnt=0;cnt<num;cnt++)
+    {
+      IQBENCH_expect("IQBATCH_sat",pA[cnt],0,_IQsat(pA[cnt],_IQ(0.5),_IQ(-0.5)),pOut[cnt]);
+    }
+
+  IQBATCH_sqrt(pOut,pA,num,GLOBAL_Q);
+  for(cnt=0;cnt<num;cnt++)
+    {
+      IQBENCH_expect("IQBATCH_sqrt",pA[cnt],0,_IQsqrt(pA[cnt]),pOut[cnt]);
+    }
+
+  free(pA);
+  free(pB);
+  free(pOut);
+
+  return;
+} // end of IQBENCH_checkBatch() function
+
+
+static void IQBENCH_checkExact(const unsigned long num)
+{
+  unsigned long cnt;
+
+
+  for(cnt=0;cnt<num;cnt++)
+    {
+      _iq a = IQBENCH_randIq();
+      _iq b = IQBENCH_randIq();
+      _iq root = _IQsqrt(a);
+      char string[40];
+      char format[8];
+      __int128 value;
+
+      // against double where the product is exact
+      if((a > -(1 << 26)) && (a < (1 << 26)) && (b > -(1 << 26)) && (b < (1 << 26)))
+        {
+          IQBENCH_expect("_IQmpy",a,b,(_iq)floor((double)a * (double)b / 16777216.0),_IQmpy(a,b));
+        }
+
+      // (2 root - 1)^2 <= 4 a 2^24 < (2 root + 1)^2
+      if(a > 0)
+        {
+          __int128 scaled = (__int128)a << (GLOBAL_Q + 2);
+
+          if(((__int128)(2 * (int64_t)root - 1) * (2 * (int64_t)root - 1) > scaled) ||
+             ((__int128)(2 * (int64_t)root + 1) * (2 * (int64_t)root + 1) <= scaled))
+            {
+              IQBENCH_fail("_IQsqrt",a,0,0,root);
+            }
+        }
+
+      // a random decimal string of up to 3 integer and 15 fraction digits
+      {
+        uint64_t integer = IQBENCH_rand() % 1000;
+        uint64_t fraction = ((uint64_t)IQBENCH_rand() << 32 | IQBENCH_rand()) % 1000000000000000ULL;
+        bool flag_negative = (IQBENCH_rand() & 1) != 0;
+        __int128 scale = 1000000000000000LL;
+        _iq expected;
+
+        snprintf(string,sizeof(string),"%s%llu.%015llu",flag_negative ? "-" : "",
+                 (unsigned long long)integer,(unsigned long long)fraction);
+
+        value = (((__int128)integer * scale + fraction) << GLOBAL_Q) / scale;
+        if(value > MAX_IQ_POS + (__int128)flag_negative)
+          {
+            expected = flag_negative ? MAX_IQ_NEG : MAX_IQ_POS;
+          }
+        else
+          {
+            expected = (_iq)(flag_negative ? -value : value);
+          }
+
+        IQBENCH_expect("_atoIQ",(_iq)integer,(_iq)fraction,expected,_atoIQ(string));
+      }
+
+      // the printed digits are the value truncated toward zero
+      {
+        int fractionWidth = 1 + (int)(IQBENCH_rand() % 11);
+        __int128 scale = 1;
+        __int128 printed = 0;
+        __int128 magnitude = (a < 0) ? -(__int128)a : (__int128)a;
+        const char *p = string;
+        int k;
+
+        snprintf(format,sizeof(format),"%%3.%df",fractionWidth);
+
+        for(k=0;k<fractionWidth;k++)
+          {
+            scale *= 10;
+          }
+
+        if(_IQtoa(string,format,a) != 0)
+          {
+            // the integer part does not fit three digits
+            if(magnitude < ((__int128)1000 << GLOBAL_Q))
+              {
+                IQBENCH_fail("_IQtoa width",a,fractionWidth,0,1);
+              }
+
+            continue;
+          }
+
+        if(*p == '-')
+          {
+            p++;
+          }
+
+        for(;*p!='\0';p++)
+          {
+            if(*p != '.')
+              {
+                printed = printed * 10 + (*p - '0');
+              }
+          }
+
+        if(((printed << GLOBAL_Q) > magnitude * scale) || (((printed + 1) << GLOBAL_Q) <= magnitude * scale) ||
+           ((string[0] == '-') != (a < 0)))
+          {
+            IQBENCH_fail("_IQtoa",a,fractionWidth,0,0);
+          }
+      }
+    }
+
+  return;
+} // end of IQBENCH_checkExact() function
+
+
+static long long IQBENCH_parseInt(const char *pField,bool *pFlag_ok)
+{
+  char *pEnd;
+  long long value = strtoll(pField,&pEnd,0);
+
+  if((pEnd == pField) || ((*pEnd != '\0') && (*pEnd != ',')))
+    {
+      *pFlag_ok = false;
+    }
+
+  return(value);
+} // end of IQBENCH_parseInt() function
+
+
+static bool IQBENCH_checkVectors(const char *pPath)
+{
+  FILE *pFile = fopen(pPath,"r");
+  char line[IQBENCH_MAX_LINE_LENGTH];
+  unsigned long lineNumber = 0;
+  unsigned long numVectors = 0;
+  unsigned long numFailuresBefore = gNumFailures;
+
+
+  if(pFile == NULL)
+    {
+      perror(pPath);
+      return(false);
+    }
+
+  while(fgets(line,sizeof(line),pFile) != NULL)
+    {
+      char *pField[4] = {NULL, NULL, NULL, NULL};
+      char *p = line;
+      bool flag_ok = true;
+      int numFields = 0;
+      long long a, b, expected, result = 0;
+
+      lineNumber++;
+      line[strcspn(line,"\r\n")] = '\0';
+
+      if((line[0] == '#') || (line[0] == '\0'))
+        {
+          continue;
+        }
+
+      while((p != NULL) && (numFields < 4))
+        {
+          pField[numFields++] = p;
+          p = strchr(p,',');
+          if(p != NULL)
+            {
+              *p++ = '\0';
+            }
+        }
+
+      if(numFields < 3)
+        {
+          fprintf(stderr,"iqbench: %s:%lu: too few fields\n",pPath,lineNumber);
+          fclose(pFile);
+          return(false);
+        }
+
+      numVectors++;
+
+      if(strcmp(pField[0],"IQtoa") == 0)
+        {
+          char string[40];
+
+          if((numFields != 4) || (_IQtoa(string,pField[1],(_iq)IQBENCH_parseInt(pField[2],&flag_ok)) != 0) ||
+             !flag_ok || (strcmp(string,pField[3]) != 0))
+            {
+              fprintf(stderr,"iqbench: %s:%lu: IQtoa mismatch\n",pPath,lineNumber);
+              gNumFailures++;
+            }
+
+          continue;
+        }
+
+      if(strcmp(pField[0],"atoIQ") == 0)
+        {
+          expected = IQBENCH_parseInt(pField[2],&flag_ok);
+          result = _atoIQ(pField[1]);
+          a = 0;
+          b = 0;
+        }
+      else if(numFields == 3)
+        {
+          a = IQBENCH_parseInt(pField[1],&flag_ok);
+          b = 0;
+          expected = IQBENCH_parseInt(pField[2],&flag_ok);
+
+          if(strcmp(pField[0],"abs") == 0)         result = _IQabs((_iq)a);
+          else if(strcmp(pField[0],"sqrt") == 0)   result = _IQsqrt((_iq)a);
+          else if(strcmp(pField[0],"30toIQ") == 0) result = _IQ30toIQ((_iq)a);
+          else flag_ok = false;
+        }
+      else
+        {
+          a = IQBENCH_parseInt(pField[1],&flag_ok);
+          b = IQBENCH_parseInt(pField[2],&flag_ok);
+          expected = IQBENCH_parseInt(pField[3],&flag_ok);
+
+          if(strcmp(pField[0],"mpy") == 0)        result = _IQmpy((_iq)a,(_iq)b);
+          else if(strcmp(pField[0],"mpy12") == 0) result = _IQ12mpy((_iq)a,(_iq)b);
+          else if(strcmp(pField[0],"mpy30") == 0) result = _IQ30mpy((_iq)a,(_iq)b);
+          else if(strcmp(pField[0],"rmpy") == 0)  result = _IQrmpy((_iq)a,(_iq)b);
+          else if(strcmp(pField[0],"rsmpy") == 0) result = _IQrsmpy((_iq)a,(_iq)b);
+          else flag_ok = false;
+        }
+
+      if(!flag_ok)
+        {
+          fprintf(stderr,"iqbench: %s:%lu: bad vector\n",pPath,lineNumber);
+          fclose(pFile);
+          return(false);
+        }
+
+      if((_iq)result != (_iq)expected)
+        {
+          IQBENCH_fail(pField[0],a,b,expected,result);
+        }
+    }
+
+  fclose(pFile);
+
+  printf("%lu target vectors, %lu mismatches\n",numVectors,gNumFailures - numFailuresBefore);
+
+  return(true);
+} // end of IQBENCH_checkVectors() function
+
+
+static double IQBENCH_getTime(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC,&now);
+
+  return((double)now.tv_sec + 1.0e-9 * (double)now.tv_nsec);
+} // end of IQBENCH_getTime() function
+
+
+// the kernels are not inlined so each one is timed as written
+
+static __attribute__((noinline)) void IQBENCH_mpyScalar(_iq *pOut,const _iq *pA,const _iq *pB,const size_t num)
+{
+  size_t cnt;
+
+  for(cnt=0;cnt<num;cnt++)
+    {
+      pOut[cnt] = _IQmpy(pA[cnt],pB[cnt]);
+    }
+} // end of IQBENCH_mpyScalar() function
+
+
+static __attribute__((noinline)) void IQBENCH_mpyFloat(float *pOut,const float *pA,const float *pB,const size_t num)
+{
+  size_t cnt;
+
+  for(cnt=0;cnt<num;cnt++)
+    {
+      pOut[cnt] = pA[cnt] * pB[cnt];
+    }
+} // end of IQBENCH_mpyFloat() function
+
+
+static __attribute__((noinline)) void IQBENCH_mpyDouble(double *pOut,const double *pA,const double *pB,const size_t num)
+{
+  size_t cnt;
+
+  for(cnt=0;cnt<num;cnt++)
+    {
+      pOut[cnt] = pA[cnt] * pB[cnt];
+    }
+} // end of IQBENCH_mpyDouble() function
+
+
+static __attribute__((noinline)) void IQBENCH_scaleScalar(_iq *pOut,const _iq *pA,const _iq K,const _iq offset,
+                                                          const size_t num)
+{
+  size_t cnt;
+
+  for(cnt=0;cnt<num;cnt++)
+    {
+      pOut[cnt] = _IQ12mpy(pA[cnt],K) - offset;
+    }
+} // end of IQBENCH_scaleScalar() function
+
+
+static __attribute__((noinline)) void IQBENCH_scaleFloat(float *pOut,const float *pA,const float K,const float offset,
+                                                         const size_t num)
+{
+  size_t cnt;
+
+  for(cnt=0;cnt<num;cnt++)
+    {
+      pOut[cnt] = pA[cnt] * K - offset;
+    }
+} // end of IQBENCH_scaleFloat() function
+
+
+static __attribute__((noinline)) void IQBENCH_sqrtFloat(float *pOut,const float *pA,const size_t num)
+{
+  size_t cnt;
+
+  for(cnt=0;cnt<num;cnt++)
+    {
+      pOut[cnt] = sqrtf(pA[cnt]);
+    }
+} // end of IQBENCH_sqrtFloat() function
+
+
+static __attribute__((noinline)) void IQBENCH_sqrtDouble(double *pOut,const double *pA,const size_t num)
+{
+  size_t cnt;
+
+  for(cnt=0;cnt<num;cnt++)
+    {
+      pOut[cnt] = sqrt(pA[cnt]);
+    }
+} // end of IQBENCH_sqrtDouble() function
+
+
+static void IQBENCH_report(const char *pName,const double start,const double stop,const size_t num,const long numRepeats)
+{
+  double ns = (stop - start) * 1.0e9 / ((double)num * (double)numRepeats);
+
+  printf("  %-28s %8.3f ns  %8.1f M/s\n",pName,ns,1.0e3 / ns);
+} // end of IQBENCH_report() function
+
+
+static void IQBENCH_bench(const size_t num,const long numRepeats)
+{
+  _iq *pA = malloc(num * sizeof(_iq));
+  _iq *pB = malloc(num * sizeof(_iq));
+  _iq *pOut = malloc(num * sizeof(_iq));
+  float *pAf = malloc(num * sizeof(float));
+  float *pBf = malloc(num * sizeof(float));
+  float *pOutf = malloc(num * sizeof(float));
+  double *pAd = malloc(num * sizeof(double));
+  double *pBd = malloc(num * sizeof(double));
+  double *pOutd = malloc(num * sizeof(double));
+  const _iq current_sf = _IQ(47.14 / 25.0);
+  const _iq bias = _IQ12mpy(2048,current_sf);
+  double start;
+  size_t cnt;
+  long repeat;
+
+
+  // operands in the range the current loop sees, ADC counts for the scaling
+  for(cnt=0;cnt<num;cnt++)
+    {
+      pA[cnt] = (_iq)(IQBENCH_rand() & 0x01FFFFFF) - _IQ(1.0);
+      pB[cnt] = (_iq)(IQBENCH_rand() & 0x01FFFFFF) - _IQ(1.0);
+      pAf[cnt] = _IQtoF(pA[cnt]);
+      pBf[cnt] = _IQtoF(pB[cnt]);
+      pAd[cnt] = _IQtoD(pA[cnt]);
+      pBd[cnt] = _IQtoD(pB[cnt]);
+    }
+
+  printf("%lu elements x %ld, iqbatch compiled for %s\n",(unsigned long)num,numRepeats,IQBATCH_getIsa());
+
+  printf("multiply\n");
+
+  start = IQBENCH_getTime();
+  for(repeat=0;repeat<numRepeats;repeat++) IQBENCH_mpyScalar(pOut,pA,pB,num);
+  IQBENCH_report("_IQmpy",start,IQBENCH_getTime(),num,numRepeats);
+
+  start = IQBENCH_getTime();
+  for(repeat=0;repeat<numRepeats;repeat++) IQBATCH_mpy(pOut,pA,pB,num,GLOBAL_Q);
+  IQBENCH_report("IQBATCH_mpy",start,IQBENCH_getTime(),num,numRepeats);
+
+  start = IQBENCH_getTime();
+  for(repeat=0;repeat<numRepeats;repeat++) IQBENCH_mpyFloat(pOutf,pAf,pBf,num);
+  IQBENCH_report("float",start,IQBENCH_getTime(),num,numRepeats);
+
+  start = IQBENCH_getTime();
+  for(repeat=0;repeat<numRepeats;repeat++) IQBENCH_mpyDouble(pOutd,pAd,pBd,num);
+  IQBENCH_report("double",start,IQBENCH_getTime(),num,numRepeats);
+
+  printf("ADC scaling, _IQ12mpy(adc,current_sf) - bias\n");
+
+  for(cnt=0;cnt<num;cnt++)
+    {
+      pA[cnt] = (_iq)(IQBENCH_rand() & 0xFFF);
+      pAf[cnt] = (float)pA[cnt];
+    }
+
+  start = IQBENCH_getTime();
+  for(repeat=0;repeat<numRepeats;repeat++) IQBENCH_scaleScalar(pOut,pA,current_sf,bias,num);
+  IQBENCH_report("_IQ12mpy",start,IQBENCH_getTime(),num,numRepeats);
+
+  start = IQBENCH_getTime();
+  for(repeat=0;repeat<numRepeats;repeat++) IQBATCH_mpyK(pOut,pA,current_sf,bias,num,12);
+  IQBENCH_report("IQBATCH_mpyK",start,IQBENCH_getTime(),num,numRepeats);
+
+  start = IQBENCH_getTime();
+  for(repeat=0;repeat<numRepeats;repeat++) IQBENCH_scaleFloat(pOutf,pAf,47.14f / 25.0f / 4096.0f,0.5f * 47.14f / 25.0f,num);
+  IQBENCH_report("float",start,IQBENCH_getTime(),num,numRepeats);
+
+  printf("square root\n");
+
+  for(cnt=0;cnt<num;cnt++)
+    {
+      pA[cnt] = (_iq)(IQBENCH_rand() & 0x01FFFFFF);
+      pAf[cnt] = _IQtoF(pA[cnt]);
+      pAd[cnt] = _IQtoD(pA[cnt]);
+    }
+
+  start = IQBENCH_getTime();
+  for(repeat=0;repeat<numRepeats;repeat++) IQBATCH_sqrt(pOut,pA,num,GLOBAL_Q);
+  IQBENCH_report("_IQsqrt",start,IQBENCH_getTime(),num,numRepeats);
+
+  start = IQBENCH_getTime();
+  for(repeat=0;repeat<numRepeats;repeat++) IQBENCH_sqrtFloat(pOutf,pAf,num);
+  IQBENCH_report("sqrtf",start,IQBENCH_getTime(),num,numRepeats);
+
+  start = IQBENCH_getTime();
+  for(repeat=0;repeat<numRepeats;repeat++) IQBENCH_sqrtDouble(pOutd,pAd,num);
+  IQBENCH_report("sqrt",start,IQBENCH_getTime(),num,numRepeats);
+
+  gSink = pOut[num / 2] + (int32_t)pOutf[num / 2] + (int32_t)pOutd[num / 2];
+
+  free(pA);
+  free(pB);
+  free(pOut);
+  free(pAf);
+  free(pBf);
+  free(pOutf);
+  free(pAd);
+  free(pBd);
+  free(pOutd);
+
+  return;
+} // end of IQBENCH_bench() function
+
+
+static void IQBENCH_usage(void)
+{
+  fprintf(stderr,"usage: iqbench [-n num] [-r repeats] [-s seed] [-v vectors.csv]\n");
+} // end of IQBENCH_usage() function
+
+
+int main(int argc,char *argv[])
+{
+  const char *pVectorPath = NULL;
+  size_t num = 4096;
+  long numRepeats = 10000;
+  int opt;
+
+
+  while((opt = getopt(argc,argv,"n:r:s:v:")) != -1)
+    {
+      switch(opt)
+        {
+          case 'n': num = (size_t)strtoul(optarg,NULL,10); break;
+          case 'r': numRepeats = strtol(optarg,NULL,10); break;
+          case 's': gSeed = strtoull(optarg,NULL,0) | 1; break;
+          case 'v': pVectorPath = optarg; break;
+          default:  IQBENCH_usage(); return(2);
+        }
+    }
+
+  if((optind != argc) || (num < 1) || (numRepeats < 1))
+    {
+      IQBENCH_usage();
+      return(2);
+    }
+
+  IQBENCH_checkFixed();
+  IQBENCH_checkBatch(IQBENCH_NUM_CHECKS + 7);
+  IQBENCH_checkExact(IQBENCH_NUM_CHECKS);
+
+  if((pVectorPath != NULL) && !IQBENCH_checkVectors(pVectorPath))
+    {
+      return(1);
+    }
+
+  printf("checks: %lu failures\n",gNumFailures);
+
+  if(gNumFailures != 0)
+    {
+      return(1);
+    }
+
+  IQBENCH_bench(num,numRepeats);
+
+  return(0);
+} // end of main() function
+
+
+// end of file
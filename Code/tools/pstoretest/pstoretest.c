@@ -0,0 +1,682 @@
+//! \file   pstoretest.c
+//! \brief  Checks the flash parameter store (see pstore.h) on the host
+//!         against an emulated flash sector
+//!
+//!         Build on Linux from this directory with
+//!
+//!           cc -O2 -I../../proj_lab05a -o pstoretest pstoretest.c
+//!              ../../proj_lab05a/pstore.c
+//!
+//!         Usage
+//!
+//!           pstoretest [-n num] [-s seed]
+//!
+//!         The emulated sector programs as flash does, a bit can only go from
+//!         1 to 0 until the sector is erased, and saves the way
+//!         serviceParamStore() does: PSTORE_prepare(), erase if asked,
+//!         program and verify the slot, PSTORE_commit().  Programming a slot
+//!         that is not erased is a failure in itself.
+//!
+//!         The checks run first and the exit status is 1 if any fails:
+//!
+//!           - a blank sector loads nothing, and the first save goes to slot 0
+//!           - the newest sequence number is loaded wherever its slot is,
+//!             also across the 16 bit wrap
+//!           - a corrupt or half programmed slot is skipped, counted and never
+//!             programmed again, and the record before it is loaded
+//!           - once all PSTORE_NUM_SLOTS slots are used the sector is erased,
+//!             and the erase count is carried into the new record, twice
+//!           - a commit the flash refused stops the saves until they are
+//!             enabled again, and leaves the previous record in use
+//!           - motor parameters that are NaN, 0 or negative load without
+//!             PSTORE_Flag_Motor, the biases still load
+//!           - unchanged parameters are not saved
+//!           - num random saves, some cut short as by a reset, each followed
+//!             now and then by a load that must give the last saved record
+//!
+//!         There are no timings, a save is bound by the flash.
+
+
+// **************************************************************************
+// the includes
+
+#include <math.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "pstore.h"
+
+
+// **************************************************************************
+// the defines
+
+//! \brief Defines the size of the sector, 16 bit words
+//!
+#define PSTORETEST_SECTOR_WORDS     (PSTORE_NUM_SLOTS * PSTORE_RECORD_WORDS)
+
+
+// **************************************************************************
+// the typedefs
+
+//! \brief Defines the emulated flash sector
+//!
+typedef struct _PSTORETEST_Flash_t_
+{
+  uint16_t        words[PSTORETEST_SECTOR_WORDS];   //!< the sector
+  uint_least16_t  numProgrammed[PSTORE_NUM_SLOTS];  //!< the times each slot was programmed since the erase
+  unsigned long   numErases;                        //!< the number of erases
+  unsigned long   numPrograms;                      //!< the number of records programmed
+  uint_least16_t  cutWords;                         //!< program only this many words of the next record, 0 for all
+} PSTORETEST_Flash_t;
+
+
+// **************************************************************************
+// the globals
+
+static uint64_t gSeed = 0x9E3779B97F4A7C15ULL;
+
+static unsigned long gNumFailures = 0;
+
+static PSTORETEST_Flash_t gFlash;
+
+
+// **************************************************************************
+// the functions
+
+static uint32_t PSTORETEST_rand(void)
+{
+  // xorshift64*
+  gSeed ^= gSeed >> 12;
+  gSeed ^= gSeed << 25;
+  gSeed ^= gSeed >> 27;
+
+  return((uint32_t)((gSeed * 0x2545F4914F6CDD1DULL) >> 32));
+} // end of PSTORETEST_rand() function
+
+
+static void PSTORETEST_fail(const char *pFormat,...)
+{
+  va_list args;
+
+
+  if(gNumFailures++ < 20)
+    {
+      va_start(args,pFormat);
+      fprintf(stderr,"pstoretest: ");
+      vfprintf(stderr,pFormat,args);
+      fprintf(stderr,"\n");
+      va_end(args);
+    }
+} // end of PSTORETEST_fail() function
+
+
+static void PSTORETEST_erase(PSTORETEST_Flash_t *pFlash)
+{
+  uint_least16_t slot;
+
+
+  memset(pFlash->words,0xFF,sizeof(pFlash->words));
+
+  for(slot=0;slot<PSTORE_NUM_SLOTS;slot++)
+    {
+      pFlash->numProgrammed[slot] = 0;
+    }
+
+  pFlash->numErases++;
+
+  return;
+} // end of PSTORETEST_erase() function
+
+
+//! \brief Programs a record, bits only go from 1 to 0, returns if it verifies
+static bool PSTORETEST_program(PSTORETEST_Flash_t *pFlash,const uint_least16_t slot,const uint16_t *pRecord)
+{
+  uint16_t *pWords = &pFlash->words[slot * PSTORE_RECORD_WORDS];
+  const uint_least16_t numWords = (pFlash->cutWords != 0) ? pFlash->cutWords : PSTORE_RECORD_WORDS;
+  uint_least16_t cnt;
+
+
+  if(slot >= PSTORE_NUM_SLOTS)
+    {
+      PSTORETEST_fail("program of slot %u, past the sector",(unsigned)slot);
+      return(false);
+    }
+
+  if(pFlash->numProgrammed[slot]++ != 0)
+    {
+      PSTORETEST_fail("slot %u programmed again without an erase",(unsigned)slot);
+    }
+
+  for(cnt=0;cnt<numWords;cnt++)
+    {
+      pWords[cnt] &= pRecord[cnt];
+    }
+
+  pFlash->cutWords = 0;
+  pFlash->numPrograms++;
+
+  return(memcmp(pWords,pRecord,PSTORE_RECORD_WORDS * sizeof(uint16_t)) == 0);
+} // end of PSTORETEST_program() function
+
+
+//! \brief Saves as serviceParamStore() does, returns if a record was programmed
+static bool PSTORETEST_save(PSTORE_Obj *pStore,PSTORETEST_Flash_t *pFlash)
+{
+  uint16_t record[PSTORE_RECORD_WORDS];
+  uint_least16_t slot;
+  bool flag_erase;
+  bool flag_ok;
+
+
+  if(!PSTORE_prepare(pStore,record,&slot,&flag_erase))
+    {
+      return(false);
+    }
+
+  if(flag_erase)
+    {
+      PSTORETEST_erase(pFlash);
+    }
+
+  flag_ok = PSTORETEST_program(pFlash,slot,record);
+  PSTORE_commit(pStore,slot,flag_erase,flag_ok);
+
+  return(true);
+} // end of PSTORETEST_save() function
+
+
+//! \brief Sets random biases, different from the ones held
+static void PSTORETEST_setRandomBias(PSTORE_Obj *pStore)
+{
+  int32_t I_bias[3];
+  int32_t V_bias[3];
+  int cnt;
+
+
+  for(cnt=0;cnt<3;cnt++)
+    {
+      I_bias[cnt] = (int32_t)PSTORETEST_rand();
+      V_bias[cnt] = (int32_t)PSTORETEST_rand();
+    }
+
+  I_bias[0] = pStore->params.I_bias[0] + 1;
+
+  PSTORE_setBias(pStore,I_bias,V_bias);
+
+  return;
+} // end of PSTORETEST_setRandomBias() function
+
+
+static bool PSTORETEST_isSame(const PSTORE_Params_t *pA,const PSTORE_Params_t *pB)
+{
+  int cnt;
+
+
+  if(pA->flags != pB->flags)
+    {
+      return(false);
+    }
+
+  for(cnt=0;cnt<3;cnt++)
+    {
+      if((pA->I_bias[cnt] != pB->I_bias[cnt]) || (pA->V_bias[cnt] != pB->V_bias[cnt]))
+        {
+          return(false);
+        }
+    }
+
+  // the motor parameters only count when they are valid
+  if(pA->flags & PSTORE_Flag_Motor)
+    {
+      return((memcmp(&pA->Rs_Ohm,&pB->Rs_Ohm,sizeof(float)) == 0) &&
+             (memcmp(&pA->Ls_d_H,&pB->Ls_d_H,sizeof(float)) == 0) &&
+             (memcmp(&pA->Ls_q_H,&pB->Ls_q_H,sizeof(float)) == 0) &&
+             (memcmp(&pA->ratedFlux_VpHz,&pB->ratedFlux_VpHz,sizeof(float)) == 0));
+    }
+
+  return(true);
+} // end of PSTORETEST_isSame() function
+
+
+//! \brief Loads the sector into a new store, as at boot, and checks it against the one that saved
+static void PSTORETEST_expectLoad(const char *pName,const PSTORE_Obj *pSaved,const uint_least16_t nextSlot,
+                                  const uint_least16_t numCorrupt)
+{
+  PSTORE_Obj store;
+
+
+  PSTORE_init(&store);
+
+  if(!PSTORE_load(&store,gFlash.words) || !PSTORETEST_isSame(&store.params,&pSaved->params) ||
+     (store.sequence != pSaved->sequence) || (store.numErases != pSaved->numErases) ||
+     (store.nextSlot != nextSlot) || (store.numCorrupt != numCorrupt))
+    {
+      PSTORETEST_fail("%s: loaded %d sequence 0x%04X %u erases next slot %u %u corrupt, "
+                      "expected sequence 0x%04X %u erases next slot %u %u corrupt",pName,store.flag_loaded,
+                      store.sequence,store.numErases,(unsigned)store.nextSlot,(unsigned)store.numCorrupt,
+                      pSaved->sequence,pSaved->numErases,(unsigned)nextSlot,(unsigned)numCorrupt);
+    }
+
+  return;
+} // end of PSTORETEST_expectLoad() function
+
+
+static void PSTORETEST_checkBlank(void)
+{
+  PSTORE_Obj store;
+
+
+  PSTORETEST_erase(&gFlash);
+  PSTORE_init(&store);
+
+  if(PSTORE_load(&store,gFlash.words) || (store.nextSlot != 0) || (store.numCorrupt != 0) ||
+     PSTORETEST_save(&store,&gFlash))
+    {
+      PSTORETEST_fail("blank: loaded %d, next slot %u, %u corrupt",store.flag_loaded,(unsigned)store.nextSlot,
+                      (unsigned)store.numCorrupt);
+    }
+
+  PSTORETEST_setRandomBias(&store);
+
+  if(!PSTORETEST_save(&store,&gFlash) || (gFlash.numProgrammed[0] != 1) || (store.sequence != 1) ||
+     (store.nextSlot != 1) || (store.numSaves != 1))
+    {
+      PSTORETEST_fail("blank: the first save did not go to slot 0");
+    }
+
+  PSTORETEST_expectLoad("blank",&store,1,0);
+
+  // the same biases again are not saved
+  PSTORE_setBias(&store,store.params.I_bias,store.params.V_bias);
+
+  if(PSTORETEST_save(&store,&gFlash))
+    {
+      PSTORETEST_fail("blank: unchanged biases saved again");
+    }
+
+  return;
+} // end of PSTORETEST_checkBlank() function
+
+
+static void PSTORETEST_checkNewest(void)
+{
+  uint16_t slots[5][PSTORE_RECORD_WORDS];
+  PSTORE_Obj store;
+  int cnt;
+
+
+  // five saves from just below the wrap, 0xFFFE to 0x0002
+  PSTORETEST_erase(&gFlash);
+  PSTORE_init(&store);
+  store.sequence = 0xFFFD;
+
+  for(cnt=0;cnt<5;cnt++)
+    {
+      PSTORETEST_setRandomBias(&store);
+      PSTORETEST_save(&store,&gFlash);
+    }
+
+  if(store.sequence != 0x0002)
+    {
+      PSTORETEST_fail("newest: sequence 0x%04X after the wrap, expected 0x0002",store.sequence);
+    }
+
+  PSTORETEST_expectLoad("newest across the wrap",&store,5,0);
+
+  // the newest first, the slot order does not matter
+  memcpy(slots,gFlash.words,sizeof(slots));
+
+  for(cnt=0;cnt<5;cnt++)
+    {
+      memcpy(&gFlash.words[cnt * PSTORE_RECORD_WORDS],slots[4 - cnt],sizeof(slots[0]));
+    }
+
+  PSTORETEST_expectLoad("newest in slot 0",&store,5,0);
+
+  return;
+} // end of PSTORETEST_checkNewest() function
+
+
+static void PSTORETEST_checkCorrupt(void)
+{
+  PSTORE_Obj store;
+  PSTORE_Obj previous;
+  uint16_t kept[PSTORE_RECORD_WORDS];
+  int cnt;
+
+
+  PSTORETEST_erase(&gFlash);
+  PSTORE_init(&store);
+
+  for(cnt=0;cnt<3;cnt++)
+    {
+      previous = store;
+      PSTORETEST_setRandomBias(&store);
+      PSTORETEST_save(&store,&gFlash);
+    }
+
+  // a bit lost in the newest record, slot 2
+  gFlash.words[2 * PSTORE_RECORD_WORDS + 7] ^= 0x0100;
+  memcpy(kept,&gFlash.words[2 * PSTORE_RECORD_WORDS],sizeof(kept));
+  PSTORETEST_expectLoad("corrupt newest",&previous,3,1);
+
+  // a save cut short by a reset in slot 3, past the corrupt one
+  PSTORE_init(&store);
+  PSTORE_load(&store,gFlash.words);
+  PSTORETEST_setRandomBias(&store);
+  gFlash.cutWords = PSTORE_RECORD_WORDS / 2;
+  PSTORETEST_save(&store,&gFlash);
+
+  // at the next boot both are skipped, the next save goes to slot 4
+  PSTORE_init(&store);
+  PSTORE_load(&store,gFlash.words);
+
+  if((store.nextSlot != 4) || (store.numCorrupt != 2) || !PSTORETEST_isSame(&store.params,&previous.params))
+    {
+      PSTORETEST_fail("half programmed: next slot %u, %u corrupt",(unsigned)store.nextSlot,(unsigned)store.numCorrupt);
+    }
+
+  PSTORETEST_setRandomBias(&store);
+  PSTORETEST_save(&store,&gFlash);
+
+  if((gFlash.numProgrammed[2] != 1) || (gFlash.numProgrammed[3] != 1) || (gFlash.numProgrammed[4] != 1) ||
+     (memcmp(kept,&gFlash.words[2 * PSTORE_RECORD_WORDS],sizeof(kept)) != 0))
+    {
+      PSTORETEST_fail("corrupt: a skipped slot was programmed again");
+    }
+
+  PSTORETEST_expectLoad("after the corrupt slots",&store,5,2);
+
+  return;
+} // end of PSTORETEST_checkCorrupt() function
+
+
+static void PSTORETEST_checkRollover(void)
+{
+  PSTORE_Obj store;
+  int erase;
+  int cnt;
+
+
+  PSTORETEST_erase(&gFlash);
+  gFlash.numErases = 0;
+  PSTORE_init(&store);
+
+  for(erase=1;erase<=2;erase++)
+    {
+      // fill the sector, each save taking the next slot
+      for(cnt=store.nextSlot;cnt<PSTORE_NUM_SLOTS;cnt++)
+        {
+          PSTORETEST_setRandomBias(&store);
+          PSTORETEST_save(&store,&gFlash);
+        }
+
+      PSTORETEST_expectLoad("full sector",&store,PSTORE_NUM_SLOTS,0);
+
+      if(gFlash.numErases != (unsigned long)erase - 1)
+        {
+          PSTORETEST_fail("rollover: %lu erases before slot %u was used",gFlash.numErases,PSTORE_NUM_SLOTS - 1);
+        }
+
+      // the next save erases and takes slot 0, with the erase count one up
+      PSTORETEST_setRandomBias(&store);
+      PSTORETEST_save(&store,&gFlash);
+
+      if((gFlash.numErases != (unsigned long)erase) || (store.numErases != erase) || (store.nextSlot != 1) ||
+         (gFlash.words[4] != erase))
+        {
+          PSTORETEST_fail("rollover %d: %lu sector erases, %u counted, %u stored, next slot %u",erase,gFlash.numErases,
+                          store.numErases,gFlash.words[4],(unsigned)store.nextSlot);
+        }
+
+      for(cnt=PSTORE_RECORD_WORDS;cnt<PSTORETEST_SECTOR_WORDS;cnt++)
+        {
+          if(gFlash.words[cnt] != PSTORE_ERASED)
+            {
+              PSTORETEST_fail("rollover %d: word %d not erased",erase,cnt);
+              break;
+            }
+        }
+
+      // the count is carried across a restart
+      PSTORETEST_expectLoad("after the rollover",&store,1,0);
+      PSTORE_init(&store);
+      PSTORE_load(&store,gFlash.words);
+    }
+
+  return;
+} // end of PSTORETEST_checkRollover() function
+
+
+static void PSTORETEST_checkFailed(void)
+{
+  PSTORE_Obj store;
+  PSTORE_Obj previous;
+
+
+  PSTORETEST_erase(&gFlash);
+  PSTORE_init(&store);
+  PSTORETEST_setRandomBias(&store);
+  PSTORETEST_save(&store,&gFlash);
+  previous = store;
+
+  // a stuck bit in slot 1 fails the verify
+  gFlash.words[PSTORE_RECORD_WORDS + 9] = 0;
+  PSTORETEST_setRandomBias(&store);
+  PSTORETEST_save(&store,&gFlash);
+
+  if(store.flag_enableSave || (store.numFailed != 1) || (store.numSaves != 1) || !store.flag_dirty)
+    {
+      PSTORETEST_fail("failed commit: saves enabled %d, %lu failed, %lu saved",store.flag_enableSave,
+                      (unsigned long)store.numFailed,(unsigned long)store.numSaves);
+    }
+
+  // no retry, whatever changes
+  PSTORETEST_setRandomBias(&store);
+
+  if(PSTORETEST_save(&store,&gFlash) || (gFlash.numProgrammed[2] != 0))
+    {
+      PSTORETEST_fail("failed commit: saved again with saves disabled");
+    }
+
+  PSTORETEST_expectLoad("after a failed commit",&previous,2,1);
+
+  // enabled again from the watch window, the next save skips the failed slot
+  store.flag_enableSave = true;
+
+  if(!PSTORETEST_save(&store,&gFlash) || (gFlash.numProgrammed[1] != 1) || (gFlash.numProgrammed[2] != 1))
+    {
+      PSTORETEST_fail("failed commit: the save after enabling did not go to slot 2");
+    }
+
+  PSTORETEST_expectLoad("saves enabled again",&store,3,1);
+
+  return;
+} // end of PSTORETEST_checkFailed() function
+
+
+static void PSTORETEST_checkMotor(void)
+{
+  const float bad[4] = {NAN, 0.0f, -0.0f, -1.0e-3f};
+  const float good[4] = {0.35f, 1.2e-4f, 1.5e-4f, 0.0062f};
+  int param;
+  int k;
+
+
+  // each bad value in each of the four parameters
+  for(param=0;param<4;param++)
+    {
+      for(k=0;k<4;k++)
+        {
+          PSTORE_Obj store;
+          PSTORE_Obj loaded;
+          float values[4];
+
+          memcpy(values,good,sizeof(values));
+          values[param] = bad[k];
+
+          PSTORETEST_erase(&gFlash);
+          PSTORE_init(&store);
+          PSTORETEST_setRandomBias(&store);
+          PSTORE_setMotor(&store,values[0],values[1],values[2],values[3]);
+          PSTORETEST_save(&store,&gFlash);
+
+          PSTORE_init(&loaded);
+
+          if(!PSTORE_load(&loaded,gFlash.words) || (loaded.params.flags != PSTORE_Flag_Bias) ||
+             (memcmp(loaded.params.I_bias,store.params.I_bias,sizeof(store.params.I_bias)) != 0))
+            {
+              PSTORETEST_fail("motor parameter %d %g: flags %u, expected only the biases",param,(double)bad[k],
+                              loaded.params.flags);
+            }
+        }
+    }
+
+  // good ones load bit exact, and are not saved again unchanged
+  {
+    PSTORE_Obj store;
+
+    PSTORETEST_erase(&gFlash);
+    PSTORE_init(&store);
+    PSTORE_setMotor(&store,good[0],good[1],good[2],good[3]);
+    PSTORETEST_save(&store,&gFlash);
+    PSTORETEST_expectLoad("good motor parameters",&store,1,0);
+
+    PSTORE_setMotor(&store,good[0],good[1],good[2],good[3]);
+
+    if(PSTORETEST_save(&store,&gFlash) || !(store.params.flags & PSTORE_Flag_Motor))
+      {
+        PSTORETEST_fail("unchanged motor parameters saved again");
+      }
+  }
+
+  return;
+} // end of PSTORETEST_checkMotor() function
+
+
+static void PSTORETEST_checkRandom(const unsigned long num)
+{
+  PSTORE_Obj store;
+  PSTORE_Obj saved;
+  bool flag_saved = false;
+  uint_least16_t numCorrupt = 0;
+  unsigned long numSaves = 0;
+  unsigned long numCut = 0;
+  unsigned long numLoads = 0;
+  unsigned long cnt;
+
+
+  // start a little below the sequence number wrap
+  PSTORETEST_erase(&gFlash);
+  gFlash.numErases = 0;
+  PSTORE_init(&store);
+  store.sequence = (uint16_t)(0xFFFF - PSTORETEST_rand() % 1000);
+
+  for(cnt=0;cnt<num;cnt++)
+    {
+      const uint32_t r = PSTORETEST_rand();
+      uint16_t record[PSTORE_RECORD_WORDS];
+      uint_least16_t slot;
+      bool flag_erase;
+
+      if(r & 1)
+        {
+          PSTORETEST_setRandomBias(&store);
+        }
+      else
+        {
+          PSTORE_setMotor(&store,(float)((r >> 8) + 1) * 1.0e-6f,1.0e-4f,1.0e-4f,0.01f);
+        }
+
+      if(!PSTORE_prepare(&store,record,&slot,&flag_erase))
+        {
+          PSTORETEST_fail("random: nothing to save after a change");
+          continue;
+        }
+
+      if(flag_erase)
+        {
+          PSTORETEST_erase(&gFlash);
+          numCorrupt = 0;
+        }
+
+      // now and then a reset halfway through programming, the slot is left
+      // half written and the store is loaded again as at boot
+      if(((r & 0xF0) == 0) && !flag_erase)
+        {
+          gFlash.cutWords = (uint_least16_t)(1 + (r >> 12) % (PSTORE_RECORD_WORDS - 1));
+          PSTORETEST_program(&gFlash,slot,record);
+          numCorrupt++;
+          numCut++;
+
+          PSTORE_init(&store);
+          PSTORE_load(&store,gFlash.words);
+        }
+      else
+        {
+          PSTORE_commit(&store,slot,flag_erase,PSTORETEST_program(&gFlash,slot,record));
+          saved = store;
+          flag_saved = true;
+          numSaves++;
+        }
+
+      if(flag_saved && (((r & 0xF00) == 0) || (cnt == num - 1)))
+        {
+          PSTORETEST_expectLoad("random",&saved,store.nextSlot,numCorrupt);
+          numLoads++;
+        }
+    }
+
+  printf("random: %lu saves, %lu cut short, %lu loads, %lu erases\n",numSaves,numCut,numLoads,gFlash.numErases);
+
+  return;
+} // end of PSTORETEST_checkRandom() function
+
+
+static void PSTORETEST_usage(void)
+{
+  fprintf(stderr,"usage: pstoretest [-n num] [-s seed]\n");
+} // end of PSTORETEST_usage() function
+
+
+int main(int argc,char *argv[])
+{
+  unsigned long num = 20000;
+  int opt;
+
+
+  while((opt = getopt(argc,argv,"n:s:")) != -1)
+    {
+      switch(opt)
+        {
+          case 'n': num = strtoul(optarg,NULL,10); break;
+          case 's': gSeed = strtoull(optarg,NULL,0) | 1; break;
+          default:  PSTORETEST_usage(); return(2);
+        }
+    }
+
+  if((optind != argc) || (num < 1))
+    {
+      PSTORETEST_usage();
+      return(2);
+    }
+
+  PSTORETEST_checkBlank();
+  PSTORETEST_checkNewest();
+  PSTORETEST_checkCorrupt();
+  PSTORETEST_checkRollover();
+  PSTORETEST_checkFailed();
+  PSTORETEST_checkMotor();
+  PSTORETEST_checkRandom(num);
+
+  printf("checks: %lu failures\n",gNumFailures);
+
+  return((gNumFailures != 0) ? 1 : 0);
+} // end of main() function
+
+
+// end of file
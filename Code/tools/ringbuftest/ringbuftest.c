@@ -0,0 +1,667 @@
+//! \file   ringbuftest.c
+//! \brief  Checks the proj_lab05a ring buffer (see ringbuf.h) on the host,
+//!         with a producer and a consumer thread, and times it
+//!
+//!         Build on Linux from this directory with
+//!
+//!           cc -O2 -pthread -I../../proj_lab05a -o ringbuftest ringbuftest.c
+//!              ../../proj_lab05a/ringbuf.c
+//!
+//!         Usage
+//!
+//!           ringbuftest [-n num] [-r repeats] [-s seed] [-z size]
+//!
+//!         The checks run first and the exit status is 1 if any fails:
+//!
+//!           - RINGBUF_init() takes the powers of two in [2, 2^15] only
+//!           - every size filled to full and drained to empty, the counts,
+//!             the space and the dropped push and pop at either end
+//!           - a million random pushes and pops, single and block, against a
+//!             plain array queue, starting just below the 2^16 index wrap
+//!           - num bytes of a counting sequence through a size entry queue
+//!             from a producer thread to a consumer thread, each mixing
+//!             single and block calls, checked in order on the consumer
+//!
+//!         The thread check relies on the ordering RINGBUF gets from the
+//!         volatile accesses alone, as on the single core C28x and Teensy.
+//!         That holds on x86, whose stores and loads are not reordered among
+//!         themselves; on a weakly ordered host it can fail.  A side that
+//!         finds the queue full or empty yields, so one core does too.
+//!
+//!         The timings push and pop through a TX_QUEUE_SIZE queue, one entry
+//!         and 8 byte frames at a time, repeated, and then stream num bytes
+//!         between the two threads, and report nanoseconds per byte.
+
+
+// **************************************************************************
+// the includes
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ringbuf.h"
+
+
+// **************************************************************************
+// the defines
+
+//! \brief Defines the largest ring buffer, entries
+//!
+#define RINGBUFTEST_MAX_SIZE        (0x8000)
+
+//! \brief Defines the queue size the timings use, TX_QUEUE_SIZE in main.h
+//!
+#define RINGBUFTEST_BENCH_SIZE      (256)
+
+//! \brief Defines the largest block of the random and thread checks
+//!
+#define RINGBUFTEST_MAX_BLOCK       (24)
+
+//! \brief Defines the index the random check starts at, just below the wrap
+//!
+#define RINGBUFTEST_WRAP_START      (0xFFF0)
+
+
+// **************************************************************************
+// the typedefs
+
+//! \brief Defines one side of the thread check
+//!
+typedef struct _RINGBUFTEST_Thread_t_
+{
+  RINGBUF_Obj     *pRing;        //!< the shared ring buffer
+  unsigned long   num;           //!< the number of bytes to pass
+  uint64_t        seed;          //!< the seed of the call mix
+  unsigned long   numErrors;     //!< the bytes out of sequence, consumer only
+  unsigned long   numWaits;      //!< the calls that moved nothing
+} RINGBUFTEST_Thread_t;
+
+
+// **************************************************************************
+// the globals
+
+static uint64_t gSeed = 0x9E3779B97F4A7C15ULL;
+
+static unsigned long gNumFailures = 0;
+
+static volatile uint32_t gSink;
+
+
+// **************************************************************************
+// the functions
+
+static uint32_t RINGBUFTEST_randFrom(uint64_t *pSeed)
+{
+  // xorshift64*
+  *pSeed ^= *pSeed >> 12;
+  *pSeed ^= *pSeed << 25;
+  *pSeed ^= *pSeed >> 27;
+
+  return((uint32_t)((*pSeed * 0x2545F4914F6CDD1DULL) >> 32));
+} // end of RINGBUFTEST_randFrom() function
+
+
+static uint32_t RINGBUFTEST_rand(void)
+{
+  return(RINGBUFTEST_randFrom(&gSeed));
+} // end of RINGBUFTEST_rand() function
+
+
+static void RINGBUFTEST_fail(const char *pFormat,...)
+{
+  va_list args;
+
+
+  if(gNumFailures++ < 20)
+    {
+      va_start(args,pFormat);
+      fprintf(stderr,"ringbuftest: ");
+      vfprintf(stderr,pFormat,args);
+      fprintf(stderr,"\n");
+      va_end(args);
+    }
+} // end of RINGBUFTEST_fail() function
+
+
+static void RINGBUFTEST_checkInit(void)
+{
+  static uint_least8_t buf[RINGBUFTEST_MAX_SIZE];
+  RINGBUF_Obj ring;
+  unsigned long size;
+
+
+  for(size=0;size<=0xFFFF;size++)
+    {
+      const bool flag_valid = (size >= 2) && (size <= RINGBUFTEST_MAX_SIZE) && ((size & (size - 1)) == 0);
+
+      if(RINGBUF_init(&ring,buf,(uint_least16_t)size) != flag_valid)
+        {
+          RINGBUFTEST_fail("RINGBUF_init() size %lu %s",size,flag_valid ? "refused" : "taken");
+        }
+    }
+
+  return;
+} // end of RINGBUFTEST_checkInit() function
+
+
+//! \brief Checks the state getters against the expected count
+static void RINGBUFTEST_expectCount(const char *pName,const RINGBUF_Obj *pRing,const unsigned long size,
+                                    const unsigned long count)
+{
+  if((RINGBUF_getCount(pRing) != count) || (RINGBUF_getSpace(pRing) != size - count) ||
+     (RINGBUF_isEmpty(pRing) != (count == 0)) || (RINGBUF_isFull(pRing) != (count == size)))
+    {
+      RINGBUFTEST_fail("%s size %lu: count %u space %u empty %d full %d, expected count %lu",pName,size,
+                       (unsigned)RINGBUF_getCount(pRing),(unsigned)RINGBUF_getSpace(pRing),
+                       RINGBUF_isEmpty(pRing),RINGBUF_isFull(pRing),count);
+    }
+} // end of RINGBUFTEST_expectCount() function
+
+
+static void RINGBUFTEST_checkFullEmpty(void)
+{
+  static uint_least8_t buf[RINGBUFTEST_MAX_SIZE];
+  static uint_least8_t block[RINGBUFTEST_MAX_SIZE + 1];
+  RINGBUF_Obj ring;
+  unsigned long size;
+  unsigned long start;
+
+
+  for(size=2;size<=RINGBUFTEST_MAX_SIZE;size*=2)
+    {
+      // from index 0, from an index that wraps while full, and from the wrap itself
+      for(start=0;start<3;start++)
+        {
+          const uint_least16_t index = (start == 0) ? 0 : (start == 1) ? (uint_least16_t)(0x10000 - size / 2) : 0xFFFF;
+          uint_least8_t data = 0x5A;
+          unsigned long cnt;
+
+          RINGBUF_init(&ring,buf,(uint_least16_t)size);
+          ring.head = index;
+          ring.tail = index;
+
+          RINGBUFTEST_expectCount("empty",&ring,size,0);
+
+          if(RINGBUF_pop(&ring,&data) || (data != 0x5A))
+            {
+              RINGBUFTEST_fail("pop from empty size %lu returned data",size);
+            }
+
+          for(cnt=0;cnt<size;cnt++)
+            {
+              if(!RINGBUF_push(&ring,(uint_least8_t)(cnt * 7)))
+                {
+                  RINGBUFTEST_fail("push %lu of size %lu refused",cnt,size);
+                  break;
+                }
+            }
+
+          RINGBUFTEST_expectCount("full",&ring,size,size);
+
+          if(RINGBUF_push(&ring,0xEE) || (RINGBUF_pushBlock(&ring,block,4) != 0))
+            {
+              RINGBUFTEST_fail("push to full size %lu taken",size);
+            }
+
+          for(cnt=0;cnt<size;cnt++)
+            {
+              if(!RINGBUF_pop(&ring,&data) || (data != (uint_least8_t)(cnt * 7)))
+                {
+                  RINGBUFTEST_fail("pop %lu of size %lu gave 0x%02X",cnt,size,data);
+                  break;
+                }
+            }
+
+          RINGBUFTEST_expectCount("drained",&ring,size,0);
+
+          // the blocks stop at full and at empty
+          memset(block,0xC3,sizeof(block));
+
+          if((RINGBUF_pushBlock(&ring,block,(uint_least16_t)(size + 1)) != size) ||
+             (RINGBUF_popBlock(&ring,block,(uint_least16_t)(size + 1)) != size))
+            {
+              RINGBUFTEST_fail("blocks of size %lu + 1 not cut to size",size);
+            }
+
+          RINGBUF_push(&ring,1);
+          RINGBUF_push(&ring,2);
+          RINGBUF_flush(&ring);
+          RINGBUFTEST_expectCount("flushed",&ring,size,0);
+        }
+    }
+
+  return;
+} // end of RINGBUFTEST_checkFullEmpty() function
+
+
+static void RINGBUFTEST_checkModel(const unsigned long num)
+{
+  static const uint_least16_t sizes[4] = {2, 16, 256, RINGBUFTEST_MAX_SIZE};
+  static uint_least8_t buf[RINGBUFTEST_MAX_SIZE];
+  static uint_least8_t model[RINGBUFTEST_MAX_SIZE];
+  int k;
+
+
+  for(k=0;k<4;k++)
+    {
+      const unsigned long size = sizes[k];
+      unsigned long head = 0;
+      unsigned long tail = 0;
+      uint_least8_t next = 0;
+      RINGBUF_Obj ring;
+      unsigned long cnt;
+
+      RINGBUF_init(&ring,buf,(uint_least16_t)size);
+      ring.head = RINGBUFTEST_WRAP_START;
+      ring.tail = RINGBUFTEST_WRAP_START;
+
+      for(cnt=0;cnt<num;cnt++)
+        {
+          const uint32_t r = RINGBUFTEST_rand();
+          const unsigned long count = head - tail;
+          uint_least8_t block[RINGBUFTEST_MAX_BLOCK];
+          uint_least8_t data = 0;
+          unsigned long length = 1 + (r >> 8) % RINGBUFTEST_MAX_BLOCK;
+          unsigned long moved;
+          unsigned long n;
+
+          // big queues take runs of pushes, then runs of pops, to reach full and empty
+          if(((r & 3) < 2) == ((cnt / (size + 64)) % 2 == 0))
+            {
+              for(n=0;n<length;n++)
+                {
+                  block[n] = next++;
+                }
+
+              if(r & 4)
+                {
+                  moved = RINGBUF_pushBlock(&ring,block,(uint_least16_t)length);
+                }
+              else
+                {
+                  length = 1;
+                  moved = RINGBUF_push(&ring,block[0]) ? 1 : 0;
+                }
+
+              if(moved != ((length < size - count) ? length : size - count))
+                {
+                  RINGBUFTEST_fail("size %lu step %lu: pushed %lu of %lu with %lu free",size,cnt,moved,length,size - count);
+                }
+
+              next = (uint_least8_t)(next - (length - moved));
+
+              for(n=0;n<moved;n++)
+                {
+                  model[(head + n) % size] = block[n];
+                }
+
+              head += moved;
+            }
+          else
+            {
+              if(r & 4)
+                {
+                  moved = RINGBUF_popBlock(&ring,block,(uint_least16_t)length);
+                }
+              else
+                {
+                  length = 1;
+                  moved = RINGBUF_pop(&ring,&data) ? 1 : 0;
+                  block[0] = data;
+                }
+
+              if(moved != ((length < count) ? length : count))
+                {
+                  RINGBUFTEST_fail("size %lu step %lu: popped %lu of %lu with %lu waiting",size,cnt,moved,length,count);
+                }
+
+              for(n=0;n<moved;n++)
+                {
+                  if(block[n] != model[(tail + n) % size])
+                    {
+                      RINGBUFTEST_fail("size %lu step %lu: popped 0x%02X, expected 0x%02X",size,cnt,
+                                       block[n],model[(tail + n) % size]);
+                    }
+                }
+
+              tail += moved;
+            }
+
+          RINGBUFTEST_expectCount("random",&ring,size,head - tail);
+        }
+
+      // the indices really went through the wrap
+      if(head + RINGBUFTEST_WRAP_START < 0x10000)
+        {
+          RINGBUFTEST_fail("size %lu: %lu pushes do not reach the index wrap, raise -n",size,head);
+        }
+    }
+
+  return;
+} // end of RINGBUFTEST_checkModel() function
+
+
+static void *RINGBUFTEST_produce(void *pArg)
+{
+  RINGBUFTEST_Thread_t *pThread = (RINGBUFTEST_Thread_t *)pArg;
+  uint_least8_t next = 0;
+  unsigned long sent = 0;
+
+
+  while(sent < pThread->num)
+    {
+      const uint32_t r = RINGBUFTEST_randFrom(&pThread->seed);
+
+      if(r & 1)
+        {
+          uint_least8_t block[RINGBUFTEST_MAX_BLOCK];
+          unsigned long length = 1 + (r >> 8) % RINGBUFTEST_MAX_BLOCK;
+          uint_least16_t moved;
+          unsigned long n;
+
+          if(length > pThread->num - sent)
+            {
+              length = pThread->num - sent;
+            }
+
+          for(n=0;n<length;n++)
+            {
+              block[n] = (uint_least8_t)(next + n);
+            }
+
+          moved = RINGBUF_pushBlock(pThread->pRing,block,(uint_least16_t)length);
+          next = (uint_least8_t)(next + moved);
+          sent += moved;
+
+          if(moved == 0)
+            {
+              pThread->numWaits++;
+              sched_yield();
+            }
+        }
+      else if(RINGBUF_push(pThread->pRing,next))
+        {
+          next++;
+          sent++;
+        }
+      else
+        {
+          pThread->numWaits++;
+          sched_yield();
+        }
+    }
+
+  return(NULL);
+} // end of RINGBUFTEST_produce() function
+
+
+static void *RINGBUFTEST_consume(void *pArg)
+{
+  RINGBUFTEST_Thread_t *pThread = (RINGBUFTEST_Thread_t *)pArg;
+  uint_least8_t expected = 0;
+  unsigned long received = 0;
+
+
+  while(received < pThread->num)
+    {
+      const uint32_t r = RINGBUFTEST_randFrom(&pThread->seed);
+      uint_least8_t block[RINGBUFTEST_MAX_BLOCK];
+      uint_least16_t moved;
+      uint_least16_t n;
+
+      if(r & 1)
+        {
+          moved = RINGBUF_popBlock(pThread->pRing,block,(uint_least16_t)(1 + (r >> 8) % RINGBUFTEST_MAX_BLOCK));
+        }
+      else
+        {
+          moved = RINGBUF_pop(pThread->pRing,&block[0]) ? 1 : 0;
+        }
+
+      for(n=0;n<moved;n++)
+        {
+          if(block[n] != expected)
+            {
+              pThread->numErrors++;
+              expected = block[n];
+            }
+
+          expected++;
+        }
+
+      received += moved;
+
+      if(moved == 0)
+        {
+          pThread->numWaits++;
+          sched_yield();
+        }
+    }
+
+  return(NULL);
+} // end of RINGBUFTEST_consume() function
+
+
+//! \brief Streams num bytes from a producer thread to a consumer thread, returns the wall time
+static double RINGBUFTEST_runThreads(const unsigned long num,const uint_least16_t size,
+                                     RINGBUFTEST_Thread_t *pProducer,RINGBUFTEST_Thread_t *pConsumer)
+{
+  static uint_least8_t buf[RINGBUFTEST_MAX_SIZE];
+  RINGBUF_Obj ring;
+  pthread_t producer;
+  pthread_t consumer;
+  struct timespec start;
+  struct timespec stop;
+
+
+  RINGBUF_init(&ring,buf,size);
+
+  memset(pProducer,0,sizeof(RINGBUFTEST_Thread_t));
+  memset(pConsumer,0,sizeof(RINGBUFTEST_Thread_t));
+  pProducer->pRing = &ring;
+  pProducer->num = num;
+  pProducer->seed = gSeed ^ 0x1234567ULL;
+  pConsumer->pRing = &ring;
+  pConsumer->num = num;
+  pConsumer->seed = gSeed ^ 0x7654321ULL;
+
+  clock_gettime(CLOCK_MONOTONIC,&start);
+
+  if((pthread_create(&consumer,NULL,RINGBUFTEST_consume,pConsumer) != 0) ||
+     (pthread_create(&producer,NULL,RINGBUFTEST_produce,pProducer) != 0))
+    {
+      fprintf(stderr,"ringbuftest: cannot start the threads\n");
+      exit(1);
+    }
+
+  pthread_join(producer,NULL);
+  pthread_join(consumer,NULL);
+
+  clock_gettime(CLOCK_MONOTONIC,&stop);
+
+  if(!RINGBUF_isEmpty(&ring))
+    {
+      RINGBUFTEST_fail("threads: %u bytes left over",(unsigned)RINGBUF_getCount(&ring));
+    }
+
+  return((double)(stop.tv_sec - start.tv_sec) + 1.0e-9 * (double)(stop.tv_nsec - start.tv_nsec));
+} // end of RINGBUFTEST_runThreads() function
+
+
+static void RINGBUFTEST_checkThreads(const unsigned long num,const uint_least16_t size)
+{
+  RINGBUFTEST_Thread_t producer;
+  RINGBUFTEST_Thread_t consumer;
+
+
+  RINGBUFTEST_runThreads(num,size,&producer,&consumer);
+
+  if(consumer.numErrors != 0)
+    {
+      RINGBUFTEST_fail("threads: %lu of %lu bytes out of sequence through %u entries",consumer.numErrors,num,(unsigned)size);
+    }
+
+  printf("threads: %lu bytes through %u entries, %lu full and %lu empty waits\n",num,(unsigned)size,
+         producer.numWaits,consumer.numWaits);
+} // end of RINGBUFTEST_checkThreads() function
+
+
+static double RINGBUFTEST_getTime(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC,&now);
+
+  return((double)now.tv_sec + 1.0e-9 * (double)now.tv_nsec);
+} // end of RINGBUFTEST_getTime() function
+
+
+// the loops are not inlined so each one is timed as written
+
+static __attribute__((noinline)) void RINGBUFTEST_runSingle(RINGBUF_Obj *pRing,const long numRepeats)
+{
+  uint32_t sum = 0;
+  long repeat;
+  int cnt;
+
+
+  for(repeat=0;repeat<numRepeats;repeat++)
+    {
+      uint_least8_t data;
+
+      for(cnt=0;cnt<RINGBUFTEST_BENCH_SIZE;cnt++)
+        {
+          RINGBUF_push(pRing,(uint_least8_t)cnt);
+        }
+
+      while(RINGBUF_pop(pRing,&data))
+        {
+          sum += data;
+        }
+    }
+
+  gSink = sum;
+} // end of RINGBUFTEST_runSingle() function
+
+
+static __attribute__((noinline)) void RINGBUFTEST_runBlock(RINGBUF_Obj *pRing,const long numRepeats)
+{
+  uint_least8_t frame[8] = {0xA5, 1, 2, 3, 4, 5, 6, 7};
+  uint32_t sum = 0;
+  long repeat;
+  int cnt;
+
+
+  for(repeat=0;repeat<numRepeats;repeat++)
+    {
+      for(cnt=0;cnt<RINGBUFTEST_BENCH_SIZE / 8;cnt++)
+        {
+          RINGBUF_pushBlock(pRing,frame,8);
+        }
+
+      while(RINGBUF_popBlock(pRing,frame,8) == 8)
+        {
+          sum += frame[1];
+        }
+    }
+
+  gSink = sum;
+} // end of RINGBUFTEST_runBlock() function
+
+
+static void RINGBUFTEST_report(const char *pName,const double time_s,const double numBytes)
+{
+  double ns = time_s * 1.0e9 / numBytes;
+
+  printf("  %-28s %8.3f ns per byte  %8.1f MB/s\n",pName,ns,1.0e3 / ns);
+} // end of RINGBUFTEST_report() function
+
+
+static void RINGBUFTEST_bench(const unsigned long num,const long numRepeats)
+{
+  static uint_least8_t buf[RINGBUFTEST_BENCH_SIZE];
+  RINGBUFTEST_Thread_t producer;
+  RINGBUFTEST_Thread_t consumer;
+  RINGBUF_Obj ring;
+  double start;
+
+
+  RINGBUF_init(&ring,buf,RINGBUFTEST_BENCH_SIZE);
+
+  printf("%d entries, filled and drained x %ld\n",RINGBUFTEST_BENCH_SIZE,numRepeats);
+
+  start = RINGBUFTEST_getTime();
+  RINGBUFTEST_runSingle(&ring,numRepeats);
+  RINGBUFTEST_report("RINGBUF_push/pop",RINGBUFTEST_getTime() - start,(double)RINGBUFTEST_BENCH_SIZE * (double)numRepeats);
+
+  start = RINGBUFTEST_getTime();
+  RINGBUFTEST_runBlock(&ring,numRepeats);
+  RINGBUFTEST_report("RINGBUF_push/popBlock, 8",RINGBUFTEST_getTime() - start,(double)RINGBUFTEST_BENCH_SIZE * (double)numRepeats);
+
+  printf("%lu bytes between two threads\n",num);
+
+  RINGBUFTEST_report("mixed calls",RINGBUFTEST_runThreads(num,RINGBUFTEST_BENCH_SIZE,&producer,&consumer),(double)num);
+
+  return;
+} // end of RINGBUFTEST_bench() function
+
+
+static void RINGBUFTEST_usage(void)
+{
+  fprintf(stderr,"usage: ringbuftest [-n num] [-r repeats] [-s seed] [-z size]\n");
+} // end of RINGBUFTEST_usage() function
+
+
+int main(int argc,char *argv[])
+{
+  unsigned long num = 20000000;
+  unsigned long size = 16;
+  long numRepeats = 100000;
+  int opt;
+
+
+  while((opt = getopt(argc,argv,"n:r:s:z:")) != -1)
+    {
+      switch(opt)
+        {
+          case 'n': num = strtoul(optarg,NULL,10); break;
+          case 'r': numRepeats = strtol(optarg,NULL,10); break;
+          case 's': gSeed = strtoull(optarg,NULL,0) | 1; break;
+          case 'z': size = strtoul(optarg,NULL,0); break;
+          default:  RINGBUFTEST_usage(); return(2);
+        }
+    }
+
+  if((optind != argc) || (num < 1) || (numRepeats < 1) ||
+     (size < 2) || (size > RINGBUFTEST_MAX_SIZE) || ((size & (size - 1)) != 0))
+    {
+      RINGBUFTEST_usage();
+      return(2);
+    }
+
+  RINGBUFTEST_checkInit();
+  RINGBUFTEST_checkFullEmpty();
+  RINGBUFTEST_checkModel(1000000);
+  RINGBUFTEST_checkThreads(num,(uint_least16_t)size);
+
+  printf("checks: %lu failures\n",gNumFailures);
+
+  if(gNumFailures != 0)
+    {
+      return(1);
+    }
+
+  RINGBUFTEST_bench(num,numRepeats);
+
+  return(0);
+} // end of main() function
+
+
+// end of file
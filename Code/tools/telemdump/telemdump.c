@@ -0,0 +1,303 @@
+//! \file   telemdump.c
+//! \brief  Decodes the proj_lab05a binary telemetry stream (see telem.h) from a
+//!         serial port or a raw capture file and writes it to disk as CSV
+//!
+//!         Build on Linux from this directory with
+//!
+//!           cc -O2 -I../../proj_lab05a -o telemdump telemdump.c
+//!              ../../proj_lab05a/telem.c ../../proj_lab05a/cmdlink.c
+//!
+//!         Usage
+//!
+//!           telemdump [-b baud] [-r isr_Hz] [-w raw.bin] <device|capture> <out.csv>
+//!
+//!         One CSV row is written per frame.  Channels not present in a frame
+//!         are left empty, so rows from channels with different decimation
+//!         factors can be told apart.  The time column is reconstructed from
+//!         the 16 bit ISR tick counter and does not wrap.
+
+
+// **************************************************************************
+// the includes
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "telem.h"
+
+
+// **************************************************************************
+// the defines
+
+//! \brief Defines the default ISR rate, Hz
+//!
+#define TELEMDUMP_DEFAULT_ISR_Hz    (10000.0)
+
+
+// **************************************************************************
+// the globals
+
+static const char *TELEMDUMP_channelNames[TELEM_NumChannels] =
+{
+  "Speed_krpm", "Iq_A", "IqRef_A", "VdcBus_kV", "Torque_Nm", "Vd_pu", "Vq_pu", "Excite_A",
+  "WheelGain_krpmpsPerA", "WheelViscous_ApKrpm", "WheelCoulomb_A"
+};
+
+static volatile sig_atomic_t gFlag_stop = 0;
+
+
+// **************************************************************************
+// the functions
+
+static void TELEMDUMP_onSignal(int sig)
+{
+  (void)sig;
+  gFlag_stop = 1;
+} // end of TELEMDUMP_onSignal() function
+
+
+static speed_t TELEMDUMP_getSpeed(const long baud)
+{
+  switch(baud)
+    {
+      case 115200:  return(B115200);
+      case 230400:  return(B230400);
+      case 460800:  return(B460800);
+      case 921600:  return(B921600);
+#ifdef B1000000
+      case 1000000: return(B1000000);
+#endif
+#ifdef B1500000
+      case 1500000: return(B1500000);
+#endif
+#ifdef B2000000
+      case 2000000: return(B2000000);
+#endif
+#ifdef B3000000
+      case 3000000: return(B3000000);
+#endif
+      default:      return(0);
+    }
+} // end of TELEMDUMP_getSpeed() function
+
+
+static int TELEMDUMP_open(const char *pPath,const long baud)
+{
+  struct termios tio;
+  speed_t speed;
+  int fd = open(pPath,O_RDONLY | O_NOCTTY);
+
+
+  if(fd < 0)
+    {
+      return(-1);
+    }
+
+  // a plain file is a raw capture, leave it alone
+  if(!isatty(fd))
+    {
+      return(fd);
+    }
+
+  speed = TELEMDUMP_getSpeed(baud);
+  if(speed == 0)
+    {
+      fprintf(stderr,"telemdump: unsupported baud rate %ld\n",baud);
+      close(fd);
+      return(-1);
+    }
+
+  if(tcgetattr(fd,&tio) != 0)
+    {
+      close(fd);
+      return(-1);
+    }
+
+  cfmakeraw(&tio);
+  cfsetispeed(&tio,speed);
+  cfsetospeed(&tio,speed);
+  tio.c_cflag |= (CLOCAL | CREAD);
+  tio.c_cflag &= ~(CSTOPB | PARENB | CRTSCTS);
+  tio.c_cc[VMIN] = 1;
+  tio.c_cc[VTIME] = 1;
+
+  if(tcsetattr(fd,TCSANOW,&tio) != 0)
+    {
+      close(fd);
+      return(-1);
+    }
+
+  tcflush(fd,TCIFLUSH);
+
+  return(fd);
+} // end of TELEMDUMP_open() function
+
+
+static void TELEMDUMP_usage(void)
+{
+  fprintf(stderr,"usage: telemdump [-b baud] [-r isr_Hz] [-w raw.bin] <device|capture> <out.csv>\n");
+} // end of TELEMDUMP_usage() function
+
+
+int main(int argc,char *argv[])
+{
+  long baud = 115200;
+  double isrFreq_Hz = TELEMDUMP_DEFAULT_ISR_Hz;
+  const char *pRawPath = NULL;
+  FILE *pOut;
+  FILE *pRaw = NULL;
+  TELEM_Decoder_t decoder;
+  TELEM_Sample_t sample;
+  uint_least8_t seq;
+  uint_least8_t lastSeq = 0;
+  unsigned long numLost = 0;
+  unsigned long long ticks = 0;
+  unsigned int lastTick = 0;
+  int flag_first = 1;
+  int opt;
+  int fd;
+  int cnt;
+
+
+  while((opt = getopt(argc,argv,"b:r:w:")) != -1)
+    {
+      switch(opt)
+        {
+          case 'b': baud = strtol(optarg,NULL,10); break;
+          case 'r': isrFreq_Hz = strtod(optarg,NULL); break;
+          case 'w': pRawPath = optarg; break;
+          default:  TELEMDUMP_usage(); return(2);
+        }
+    }
+
+  if((argc - optind) != 2 || isrFreq_Hz <= 0.0)
+    {
+      TELEMDUMP_usage();
+      return(2);
+    }
+
+  fd = TELEMDUMP_open(argv[optind],baud);
+  if(fd < 0)
+    {
+      fprintf(stderr,"telemdump: %s: %s\n",argv[optind],strerror(errno));
+      return(1);
+    }
+
+  pOut = fopen(argv[optind + 1],"w");
+  if(pOut == NULL)
+    {
+      fprintf(stderr,"telemdump: %s: %s\n",argv[optind + 1],strerror(errno));
+      close(fd);
+      return(1);
+    }
+
+  if(pRawPath != NULL)
+    {
+      pRaw = fopen(pRawPath,"wb");
+      if(pRaw == NULL)
+        {
+          fprintf(stderr,"telemdump: %s: %s\n",pRawPath,strerror(errno));
+        }
+    }
+
+  signal(SIGINT,TELEMDUMP_onSignal);
+  signal(SIGTERM,TELEMDUMP_onSignal);
+
+  fprintf(pOut,"time_s,seq");
+  for(cnt=0;cnt<TELEM_NumChannels;cnt++)
+    {
+      fprintf(pOut,",%s",TELEMDUMP_channelNames[cnt]);
+    }
+  fprintf(pOut,"\n");
+
+  TELEM_initDecoder(&decoder);
+
+  while(!gFlag_stop)
+    {
+      uint8_t buf[256];
+      ssize_t num = read(fd,buf,sizeof(buf));
+      ssize_t index;
+
+      if(num < 0)
+        {
+          if(errno == EINTR)
+            {
+              continue;
+            }
+
+          fprintf(stderr,"telemdump: read: %s\n",strerror(errno));
+          break;
+        }
+
+      if(num == 0)
+        {
+          // end of a capture file
+          break;
+        }
+
+      if(pRaw != NULL)
+        {
+          fwrite(buf,1,(size_t)num,pRaw);
+        }
+
+      for(index=0;index<num;index++)
+        {
+          if(!TELEM_decode(&decoder,buf[index],&sample,&seq))
+            {
+              continue;
+            }
+
+          if(flag_first)
+            {
+              flag_first = 0;
+            }
+          else
+            {
+              numLost += (uint_least8_t)(seq - lastSeq - 1);
+              ticks += (sample.tick - lastTick) & 0xFFFF;
+            }
+
+          lastSeq = seq;
+          lastTick = sample.tick;
+
+          fprintf(pOut,"%.6f,%u",(double)ticks / isrFreq_Hz,(unsigned int)seq);
+
+          for(cnt=0;cnt<TELEM_NumChannels;cnt++)
+            {
+              if(sample.mask & (1 << cnt))
+                {
+                  fprintf(pOut,",%.7f",(double)sample.value[cnt] / 16777216.0);
+                }
+              else
+                {
+                  fprintf(pOut,",");
+                }
+            }
+
+          fprintf(pOut,"\n");
+        }
+    }
+
+  fprintf(stderr,"telemdump: %lu frames, %lu lost, %lu crc errors, %lu sync bytes skipped\n",
+          (unsigned long)decoder.numFrames,numLost,
+          (unsigned long)decoder.numCrcErrors,(unsigned long)decoder.numSyncErrors);
+
+  if(pRaw != NULL)
+    {
+      fclose(pRaw);
+    }
+
+  fclose(pOut);
+  close(fd);
+
+  return(0);
+} // end of main() function
+
+
+// end of file
@@ -0,0 +1,380 @@
+//! \file   tiltreplay.c
+//! \brief  Replays raw IMU traces through the rwp-1 tilt estimator (see
+//!         rwp-1/tiltest.h) on the host
+//!
+//!         Build on Linux from this directory with
+//!
+//!           cc -O2 -I../../rwp-1 -o tiltreplay tiltreplay.c ../../rwp-1/tiltest.c -lm
+//!
+//!         Usage
+//!
+//!           tiltreplay [-T tau_sec] [-g gate_g] [-r radius_m] [-e maxRms_deg] [-o out.csv] <trace.csv>
+//!           tiltreplay -S <trace.csv> [-s seed] [-l length_sec]
+//!
+//!         A trace is what rwp-1 streams over USB serial after 't' with
+//!         HIGH_RATE_IMU: rows of t_us,ax,ay,az,gx,gy,gz in raw counts.  An
+//!         optional eighth column is a reference roll in degrees, from a
+//!         motion capture or from -S.  Lines that do not parse, such as the
+//!         header or other console output, are skipped.
+//!
+//!         The replay prints the sample rate and period jitter from the
+//!         timestamps, the estimator gating and bias, and the RMS and largest
+//!         error against the reference when there is one.  With -e it exits
+//!         with status 1 when the RMS error is above the limit, so a trace
+//!         and a limit make a regression check for estimator changes.
+//!
+//!         -S writes a synthetic trace instead: a 1 kHz pendulum wobble with
+//!         timestamp jitter, gyro bias and noise, accelerometer noise and the
+//!         tangential acceleration of the IMU on the pendulum, with the true
+//!         roll as the reference column.  The IMU is TILTREPLAY_SYNTH_RADIUS_m
+//!         from the pivot, so replay it with -r 0.12.
+
+
+// **************************************************************************
+// the includes
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tiltest.h"
+
+
+// **************************************************************************
+// the defines
+
+//! \brief Defines the longest trace line, characters
+//!
+#define TILTREPLAY_MAX_LINE         (256)
+
+//! \brief Defines the synthetic trace rate, Hz
+//!
+#define TILTREPLAY_SYNTH_RATE_Hz    (1000.0)
+
+//! \brief Defines the IMU distance from the pivot in the synthetic trace, m
+//!
+#define TILTREPLAY_SYNTH_RADIUS_m   (0.12)
+
+
+// **************************************************************************
+// the typedefs
+
+//! \brief Defines one trace sample
+//!
+typedef struct _TILTREPLAY_Sample_t_
+{
+  double   t_us;                 //!< the read time
+  int16_t  accel[3];             //!< the accelerometer counts
+  int16_t  gyro[3];              //!< the gyro counts
+  double   ref_deg;              //!< the reference roll
+  int      flag_ref;             //!< non zero when ref_deg is present
+} TILTREPLAY_Sample_t;
+
+
+// **************************************************************************
+// the globals
+
+static uint64_t TILTREPLAY_seed = 1;
+
+
+// **************************************************************************
+// the functions
+
+static void TILTREPLAY_usage(const char *pName)
+{
+  fprintf(stderr,
+          "usage: %s [-T tau_sec] [-g gate_g] [-r radius_m] [-e maxRms_deg] [-o out.csv] <trace.csv>\n"
+          "       %s -S <trace.csv> [-s seed] [-l length_sec]\n",
+          pName,pName);
+
+  return;
+} // end of TILTREPLAY_usage() function
+
+
+//! \brief Returns a standard normal value, xorshift64* and Box-Muller
+static double TILTREPLAY_getNoise(void)
+{
+  double u[2];
+  int cnt;
+
+  for(cnt=0;cnt<2;cnt++)
+    {
+      TILTREPLAY_seed ^= TILTREPLAY_seed >> 12;
+      TILTREPLAY_seed ^= TILTREPLAY_seed << 25;
+      TILTREPLAY_seed ^= TILTREPLAY_seed >> 27;
+      u[cnt] = ((double)((TILTREPLAY_seed * 0x2545F4914F6CDD1DULL) >> 11) + 0.5) / 9007199254740992.0;
+    }
+
+  return(sqrt(-2.0 * log(u[0])) * cos(2.0 * M_PI * u[1]));
+} // end of TILTREPLAY_getNoise() function
+
+
+static int16_t TILTREPLAY_toCounts(const double value)
+{
+  double rounded = floor(value + 0.5);
+
+  return((int16_t)(rounded > 32767.0 ? 32767.0 : (rounded < -32768.0 ? -32768.0 : rounded)));
+} // end of TILTREPLAY_toCounts() function
+
+
+static int TILTREPLAY_synthesize(const char *pName,const double length_sec)
+{
+  const double w = 2.0 * M_PI * 1.3;
+  const double bias_dps = 1.7;
+  FILE *pOut = fopen(pName,"w");
+  long num = (long)(length_sec * TILTREPLAY_SYNTH_RATE_Hz);
+  long cnt;
+
+
+  if(pOut == NULL)
+    {
+      perror(pName);
+      return(1);
+    }
+
+  fprintf(pOut,"t_us,ax,ay,az,gx,gy,gz,ref_deg\n");
+
+  for(cnt=0;cnt<num;cnt++)
+    {
+      // the read time wanders around the schedule like a busy loop
+      double t_sec = (double)cnt / TILTREPLAY_SYNTH_RATE_Hz + 40.0e-6 * fabs(TILTREPLAY_getNoise());
+
+      // a balancing wobble around 2.25 deg with a slower drift
+      double roll_rad = (2.25 + 1.5 * sin(w * t_sec) + 0.8 * sin(0.21 * w * t_sec)) * M_PI / 180.0;
+      double rate_radps = (1.5 * w * cos(w * t_sec) + 0.8 * 0.21 * w * cos(0.21 * w * t_sec)) * M_PI / 180.0;
+      double accel_radps2 = (-1.5 * w * w * sin(w * t_sec) - 0.8 * 0.0441 * w * w * sin(0.21 * w * t_sec)) * M_PI / 180.0;
+
+      // specific force in the sensor frame, the IMU on the sensor Z axis above the pivot
+      double ay_g = sin(roll_rad) - TILTREPLAY_SYNTH_RADIUS_m * accel_radps2 / 9.81;
+      double az_g = cos(roll_rad) - TILTREPLAY_SYNTH_RADIUS_m * rate_radps * rate_radps / 9.81;
+
+      fprintf(pOut,"%.0f,%d,%d,%d,%d,%d,%d,%.5f\n",
+              t_sec * 1.0e6,
+              TILTREPLAY_toCounts((0.01 * TILTREPLAY_getNoise()) * TILTEST_ACCEL_COUNTS_PER_g),
+              TILTREPLAY_toCounts((ay_g + 0.01 * TILTREPLAY_getNoise()) * TILTEST_ACCEL_COUNTS_PER_g),
+              TILTREPLAY_toCounts((az_g + 0.01 * TILTREPLAY_getNoise()) * TILTEST_ACCEL_COUNTS_PER_g),
+              TILTREPLAY_toCounts((rate_radps * 180.0 / M_PI + bias_dps + 0.05 * TILTREPLAY_getNoise()) * TILTEST_GYRO_COUNTS_PER_dps),
+              TILTREPLAY_toCounts(0.05 * TILTREPLAY_getNoise() * TILTEST_GYRO_COUNTS_PER_dps),
+              TILTREPLAY_toCounts(0.05 * TILTREPLAY_getNoise() * TILTEST_GYRO_COUNTS_PER_dps),
+              roll_rad * 180.0 / M_PI);
+    }
+
+  fclose(pOut);
+
+  return(0);
+} // end of TILTREPLAY_synthesize() function
+
+
+static int TILTREPLAY_parse(const char *pLine,TILTREPLAY_Sample_t *pSample)
+{
+  int values[6];
+  int numFields;
+  int cnt;
+
+
+  numFields = sscanf(pLine,"%lf,%d,%d,%d,%d,%d,%d,%lf",&pSample->t_us,
+                     &values[0],&values[1],&values[2],&values[3],&values[4],&values[5],
+                     &pSample->ref_deg);
+
+  if(numFields < 7)
+    {
+      return(0);
+    }
+
+  for(cnt=0;cnt<3;cnt++)
+    {
+      pSample->accel[cnt] = (int16_t)values[cnt];
+      pSample->gyro[cnt] = (int16_t)values[cnt + 3];
+    }
+
+  pSample->flag_ref = (numFields == 8);
+
+  return(1);
+} // end of TILTREPLAY_parse() function
+
+
+int main(int argc,char *argv[])
+{
+  TILTEST_Obj est;
+  TILTREPLAY_Sample_t sample;
+  char line[TILTREPLAY_MAX_LINE];
+  const char *pTraceName = NULL;
+  const char *pOutName = NULL;
+  const char *pSynthName = NULL;
+  FILE *pTrace;
+  FILE *pOut = NULL;
+  double tau_sec = TILTEST_DEFAULT_TAU_sec;
+  double gate_g = TILTEST_DEFAULT_GATE_g;
+  double radius_m = 0.0;
+  double maxRms_deg = -1.0;
+  double length_sec = 20.0;
+  double lastT_us = 0.0;
+  double periodSum = 0.0, periodSqSum = 0.0, periodMin = 1.0e30, periodMax = 0.0;
+  double errorSqSum = 0.0, errorMax = 0.0;
+  unsigned long numSamples = 0, numPeriods = 0, numRef = 0;
+  int arg;
+
+
+  for(arg=1;arg<argc;arg++)
+    {
+      if((argv[arg][0] != '-') || (argv[arg][1] == '\0'))
+        {
+          pTraceName = argv[arg];
+          continue;
+        }
+
+      if(arg + 1 >= argc)
+        {
+          TILTREPLAY_usage(argv[0]);
+          return(2);
+        }
+
+      switch(argv[arg++][1])
+        {
+          case 'T': tau_sec = atof(argv[arg]); break;
+          case 'g': gate_g = atof(argv[arg]); break;
+          case 'r': radius_m = atof(argv[arg]); break;
+          case 'e': maxRms_deg = atof(argv[arg]); break;
+          case 'o': pOutName = argv[arg]; break;
+          case 'S': pSynthName = argv[arg]; break;
+          case 's': TILTREPLAY_seed = strtoull(argv[arg],NULL,0) | 1; break;
+          case 'l': length_sec = atof(argv[arg]); break;
+          default:
+            TILTREPLAY_usage(argv[0]);
+            return(2);
+        }
+    }
+
+  if(pSynthName != NULL)
+    {
+      return(TILTREPLAY_synthesize(pSynthName,length_sec));
+    }
+
+  if((pTraceName == NULL) || (tau_sec <= 0.0))
+    {
+      TILTREPLAY_usage(argv[0]);
+      return(2);
+    }
+
+  pTrace = fopen(pTraceName,"r");
+  if(pTrace == NULL)
+    {
+      perror(pTraceName);
+      return(1);
+    }
+
+  if(pOutName != NULL)
+    {
+      pOut = fopen(pOutName,"w");
+      if(pOut == NULL)
+        {
+          perror(pOutName);
+          fclose(pTrace);
+          return(1);
+        }
+
+      fprintf(pOut,"t_us,angle_deg,rate_dps,bias_dps,ref_deg\n");
+    }
+
+  TILTEST_init(&est,(float)tau_sec,(float)gate_g,(float)radius_m);
+
+  while(fgets(line,sizeof(line),pTrace) != NULL)
+    {
+      float dt_sec;
+
+      if(!TILTREPLAY_parse(line,&sample))
+        {
+          continue;
+        }
+
+      // the sketch falls back to the nominal period for its first read too
+      if(numSamples != 0)
+        {
+          double period_us = sample.t_us - lastT_us;
+
+          dt_sec = (float)(period_us * 1.0e-6);
+          periodSum += period_us;
+          periodSqSum += period_us * period_us;
+          periodMin = (period_us < periodMin) ? period_us : periodMin;
+          periodMax = (period_us > periodMax) ? period_us : periodMax;
+          numPeriods++;
+        }
+      else
+        {
+          dt_sec = (float)(1.0 / TILTREPLAY_SYNTH_RATE_Hz);
+        }
+
+      lastT_us = sample.t_us;
+      numSamples++;
+
+      TILTEST_run(&est,sample.accel,sample.gyro[0],dt_sec);
+
+      // the first second lets the estimator settle on the bias
+      if(sample.flag_ref && (numPeriods != 0) && (periodSum >= 1.0e6))
+        {
+          double error_deg = (double)TILTEST_getAngle_deg(&est) - sample.ref_deg;
+
+          errorSqSum += error_deg * error_deg;
+          errorMax = (fabs(error_deg) > errorMax) ? fabs(error_deg) : errorMax;
+          numRef++;
+        }
+
+      if(pOut != NULL)
+        {
+          fprintf(pOut,"%.0f,%.5f,%.4f,%.4f,",sample.t_us,TILTEST_getAngle_deg(&est),
+                  TILTEST_getRate_dps(&est),est.bias_dps);
+          if(sample.flag_ref)
+            {
+              fprintf(pOut,"%.5f",sample.ref_deg);
+            }
+          fprintf(pOut,"\n");
+        }
+    }
+
+  fclose(pTrace);
+  if(pOut != NULL)
+    {
+      fclose(pOut);
+    }
+
+  if(numPeriods == 0)
+    {
+      fprintf(stderr,"%s: fewer than two samples\n",pTraceName);
+      return(1);
+    }
+
+  {
+    double mean_us = periodSum / (double)numPeriods;
+    double var = periodSqSum / (double)numPeriods - mean_us * mean_us;
+
+    printf("samples:   %lu, %.1f Hz\n",numSamples,1.0e6 / mean_us);
+    printf("period:    mean %.1f us, min %.0f us, max %.0f us, jitter rms %.1f us\n",
+           mean_us,periodMin,periodMax,(var > 0.0) ? sqrt(var) : 0.0);
+    printf("estimator: %lu samples gated, bias %.3f dps, final %.3f deg\n",
+           (unsigned long)est.numGated,est.bias_dps,TILTEST_getAngle_deg(&est));
+  }
+
+  if(numRef != 0)
+    {
+      double rms_deg = sqrt(errorSqSum / (double)numRef);
+
+      printf("reference: rms error %.4f deg, max %.4f deg over %lu samples\n",rms_deg,errorMax,numRef);
+
+      if((maxRms_deg >= 0.0) && (rms_deg > maxRms_deg))
+        {
+          printf("FAIL: rms error above %.4f deg\n",maxRms_deg);
+          return(1);
+        }
+    }
+  else if(maxRms_deg >= 0.0)
+    {
+      fprintf(stderr,"%s: no reference column to check\n",pTraceName);
+      return(1);
+    }
+
+  return(0);
+} // end of main() function
+
+
+// end of file
@@ -0,0 +1,705 @@
+//! \file   wheelreplay.c
+//! \brief  Replays recorded wheel speed and Iq logs through the proj_lab05a
+//!         wheel model estimator (see wheelid.h) on the host
+//!
+//!         Build on Linux from this directory with
+//!
+//!           cc -O2 -I../../proj_lab05a -o wheelreplay wheelreplay.c
+//!              ../../proj_lab05a/wheelid.c -lm
+//!
+//!         Usage
+//!
+//!           wheelreplay [-r rate_Hz] [-i step_A] [-s maxSpeed_krpm] [-d deadband_krpm]
+//!                       [-f forgetting] [-g gain_krpmpsPerA] [-e maxError_pct]
+//!                       [-o out.csv] <log|->
+//!           wheelreplay -S <log.csv> [-k seed] [-l length_sec]
+//!
+//!         A log is one of
+//!
+//!           - one of the Data/*.xlsm runs, read through unzip like fricfit
+//!             does, with a column of speeds in krpm and, for the sine runs,
+//!             a column of the Iq reference in A.  The worksheet XML works
+//!             too, piped in from
+//!               unzip -p ../../../Data/5amp-500hz-sine.xlsm xl/worksheets/sheet1.xml
+//!           - text rows of speed_krpm[,Iq_A], the screenlog those came from
+//!           - a CSV from telemdump or exciterun, from its Speed_krpm and
+//!             Iq_A columns; rows missing either are skipped
+//!
+//!         The rows are taken as evenly spaced at rate_Hz.  The step runs
+//!         only logged the speed, -i gives the Iq they held; with Iq and the
+//!         direction both constant they cannot tell the gain from the
+//!         Coulomb friction, only the sine runs can.  All the runs logged the
+//!         Iq reference rather than the measured Iq, which the current loop
+//!         cannot hold once it runs out of voltage near the top speed, so -s
+//!         skips the windows beyond it; the firmware has the measured Iq and
+//!         runs without a limit.
+//!
+//!         The replay prints the model, the windows taken and the RMS
+//!         acceleration error of the final model over them.  A log may carry
+//!         its true model in a "# gain_krpmpsPerA=... viscous_ApKrpm=...
+//!         coulomb_A=..." line, -g gives a reference gain for one that does
+//!         not, and the errors against them are printed too.  With -e the
+//!         replay exits with status 1 when one is above the limit, or when
+//!         there is nothing to check against, so
+//!
+//!           wheelreplay -g 6.1 -e 5 ../../../Data/5amp-500hz-sine.xlsm
+//!
+//!         is a regression check for estimator changes.
+//!
+//!         -S writes a synthetic log instead: a 500 Hz swept sine of Iq
+//!         through the model of the default Turnigy wheel, with the speed
+//!         limited and rounded like the recorded runs, a lagging current and
+//!         speed noise, and its true model in the comment line.
+
+
+// **************************************************************************
+// the includes
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "wheelid.h"
+
+
+// **************************************************************************
+// the defines
+
+//! \brief Defines the rate of the recorded runs, Hz
+//!
+#define WHEELREPLAY_DEFAULT_RATE_Hz     (500.0)
+
+//! \brief Defines the speed beyond which the recorded runs ran out of voltage, krpm
+//!
+#define WHEELREPLAY_DEFAULT_MAX_SPEED_krpm  (8.0)
+
+//! \brief Defines the largest log, bytes
+//!
+#define WHEELREPLAY_MAX_LOG_LENGTH      (64L * 1024L * 1024L)
+
+//! \brief Defines the largest number of columns looked at
+//!
+#define WHEELREPLAY_MAX_COLUMNS         (16)
+
+//! \brief Defines the synthetic log rate, Hz
+//!
+#define WHEELREPLAY_SYNTH_RATE_Hz       (500.0)
+
+
+// **************************************************************************
+// the typedefs
+
+//! \brief Defines one log row
+//!
+typedef struct _WHEELREPLAY_Row_t_
+{
+  double  speed_krpm;            //!< the speed
+  double  iq_A;                  //!< the Iq
+  int     flag_iq;               //!< non zero when iq_A was logged
+} WHEELREPLAY_Row_t;
+
+
+//! \brief Defines a parsed log
+//!
+typedef struct _WHEELREPLAY_Log_t_
+{
+  WHEELREPLAY_Row_t  *pRows;     //!< the rows
+  unsigned long      numRows;    //!< the number of rows
+  unsigned long      maxRows;    //!< the rows allocated
+  double  ref[WHEELID_NUM_PARAMS];   //!< the true gain, viscous and Coulomb friction
+  int     flag_ref[WHEELID_NUM_PARAMS];  //!< non zero when the ref is given
+} WHEELREPLAY_Log_t;
+
+
+// **************************************************************************
+// the globals
+
+static uint64_t WHEELREPLAY_seed = 1;
+
+static const char *WHEELREPLAY_refNames[WHEELID_NUM_PARAMS] =
+{
+  "gain_krpmpsPerA", "viscous_ApKrpm", "coulomb_A"
+};
+
+
+// **************************************************************************
+// the functions
+
+static void WHEELREPLAY_usage(const char *pName)
+{
+  fprintf(stderr,
+          "usage: %s [-r rate_Hz] [-i step_A] [-s maxSpeed_krpm] [-d deadband_krpm]\n"
+          "                   [-f forgetting] [-g gain_krpmpsPerA] [-e maxError_pct]\n"
+          "                   [-o out.csv] <log|->\n"
+          "       %s -S <log.csv> [-k seed] [-l length_sec]\n",
+          pName,pName);
+
+  return;
+} // end of WHEELREPLAY_usage() function
+
+
+//! \brief Returns a standard normal value, xorshift64* and Box-Muller
+static double WHEELREPLAY_getNoise(void)
+{
+  double u[2];
+  int cnt;
+
+  for(cnt=0;cnt<2;cnt++)
+    {
+      WHEELREPLAY_seed ^= WHEELREPLAY_seed >> 12;
+      WHEELREPLAY_seed ^= WHEELREPLAY_seed << 25;
+      WHEELREPLAY_seed ^= WHEELREPLAY_seed >> 27;
+      u[cnt] = ((double)((WHEELREPLAY_seed * 0x2545F4914F6CDD1DULL) >> 11) + 0.5) / 9007199254740992.0;
+    }
+
+  return(sqrt(-2.0 * log(u[0])) * cos(2.0 * M_PI * u[1]));
+} // end of WHEELREPLAY_getNoise() function
+
+
+static int WHEELREPLAY_synthesize(const char *pName,const double length_sec)
+{
+  // near what the recorded sine runs give for the Turnigy wheel
+  const double gain_krpmpsPerA = 6.1;
+  const double viscous_ApKrpm = 0.06;
+  const double coulomb_A = 0.25;
+  const double dt_sec = 1.0 / WHEELREPLAY_SYNTH_RATE_Hz;
+  const int numSubSteps = 20;
+  FILE *pOut = fopen(pName,"w");
+  long num = (long)(length_sec * WHEELREPLAY_SYNTH_RATE_Hz);
+  double speed_krpm = 0.0;
+  double iq_A = 0.0;
+  double phase_rad = 0.0;
+  long cnt;
+
+
+  if(pOut == NULL)
+    {
+      perror(pName);
+      return(1);
+    }
+
+  fprintf(pOut,"# gain_krpmpsPerA=%.4f viscous_ApKrpm=%.4f coulomb_A=%.4f\n",
+          gain_krpmpsPerA,viscous_ApKrpm,coulomb_A);
+
+  for(cnt=0;cnt<num;cnt++)
+    {
+      // a 5 A sine swept from 0.2 Hz up to 4 Hz and back, like the variable sine runs
+      double t_sec = (double)cnt * dt_sec;
+      double freq_Hz = 0.2 + 3.8 * (0.5 - 0.5 * cos(2.0 * M_PI * t_sec / length_sec));
+      double iqRef_A = 5.0 * sin(phase_rad);
+      double logged_krpm;
+      int step;
+
+      for(step=0;step<numSubSteps;step++)
+        {
+          const double h = dt_sec / (double)numSubSteps;
+          double friction_A = viscous_ApKrpm * speed_krpm;
+          double accel_krpmps;
+
+          // a current loop with a 1 ms lag
+          iq_A += (iqRef_A - iq_A) * h / 1.0e-3;
+
+          if(speed_krpm > 0.0)
+            {
+              friction_A += coulomb_A;
+            }
+          else if(speed_krpm < 0.0)
+            {
+              friction_A -= coulomb_A;
+            }
+          else if(fabs(iq_A) <= coulomb_A)
+            {
+              friction_A = iq_A;
+            }
+          else
+            {
+              friction_A = (iq_A > 0.0) ? coulomb_A : -coulomb_A;
+            }
+
+          accel_krpmps = gain_krpmpsPerA * (iq_A - friction_A);
+
+          // out of voltage at the top speed, the current falls to what holds it there
+          if((fabs(speed_krpm) >= 8.5) && (accel_krpmps * speed_krpm > 0.0))
+            {
+              accel_krpmps = 0.0;
+            }
+
+          if((speed_krpm != 0.0) && ((speed_krpm + accel_krpmps * h) * speed_krpm < 0.0))
+            {
+              speed_krpm = 0.0;
+            }
+          else
+            {
+              speed_krpm += accel_krpmps * h;
+            }
+        }
+
+      // the speed estimate is noisy and was printed with two decimals
+      logged_krpm = floor((speed_krpm + 0.01 * WHEELREPLAY_getNoise()) * 100.0 + 0.5) / 100.0;
+
+      fprintf(pOut,"%.2f,%.2f\n",logged_krpm,floor(iqRef_A * 100.0 + 0.5) / 100.0);
+
+      phase_rad = fmod(phase_rad + 2.0 * M_PI * freq_Hz * dt_sec,2.0 * M_PI);
+    }
+
+  fclose(pOut);
+
+  return(0);
+} // end of WHEELREPLAY_synthesize() function
+
+
+static int WHEELREPLAY_addRow(WHEELREPLAY_Log_t *pLog,const double speed_krpm,const double iq_A,const int flag_iq)
+{
+  if(pLog->numRows == pLog->maxRows)
+    {
+      unsigned long maxRows = (pLog->maxRows == 0) ? 4096 : 2 * pLog->maxRows;
+      WHEELREPLAY_Row_t *pRows = realloc(pLog->pRows,maxRows * sizeof(WHEELREPLAY_Row_t));
+
+      if(pRows == NULL)
+        {
+          return(0);
+        }
+
+      pLog->pRows = pRows;
+      pLog->maxRows = maxRows;
+    }
+
+  pLog->pRows[pLog->numRows].speed_krpm = speed_krpm;
+  pLog->pRows[pLog->numRows].iq_A = iq_A;
+  pLog->pRows[pLog->numRows].flag_iq = flag_iq;
+  pLog->numRows++;
+
+  return(1);
+} // end of WHEELREPLAY_addRow() function
+
+
+//! \brief Reads the rows of an Excel worksheet, column A the speed and B the Iq
+static int WHEELREPLAY_parseSheet(const char *pText,WHEELREPLAY_Log_t *pLog)
+{
+  const char *pRow = pText;
+
+  while((pRow = strstr(pRow,"<row")) != NULL)
+    {
+      const char *pEnd = strstr(pRow,"</row>");
+      const char *pCell = pRow;
+      double value[2] = {0.0, 0.0};
+      int flag_value[2] = {0, 0};
+
+      if(pEnd == NULL)
+        {
+          break;
+        }
+
+      while(((pCell = strstr(pCell,"<c r=\"")) != NULL) && (pCell < pEnd))
+        {
+          const char *pClose = strchr(pCell,'>');
+          int column = pCell[6] - 'A';
+
+          pCell += 6;
+
+          // only numbers, shared strings are header text
+          if((pClose == NULL) || (pClose[-1] == '/') || (column < 0) || (column > 1) ||
+             (strstr(pCell,"t=\"s\"") != NULL && strstr(pCell,"t=\"s\"") < pClose) ||
+             (strncmp(pClose,"><v>",4) != 0))
+            {
+              continue;
+            }
+
+          value[column] = atof(pClose + 4);
+          flag_value[column] = 1;
+        }
+
+      if(flag_value[0] && !WHEELREPLAY_addRow(pLog,value[0],value[1],flag_value[1]))
+        {
+          return(0);
+        }
+
+      pRow = pEnd;
+    }
+
+  return(1);
+} // end of WHEELREPLAY_parseSheet() function
+
+
+//! \brief Splits a CSV line in place, returns the number of fields
+static int WHEELREPLAY_split(char *pLine,char *pFields[WHEELREPLAY_MAX_COLUMNS])
+{
+  int num = 0;
+
+  pLine[strcspn(pLine,"\r\n")] = '\0';
+
+  while(num < WHEELREPLAY_MAX_COLUMNS)
+    {
+      pFields[num++] = pLine;
+      pLine = strchr(pLine,',');
+      if(pLine == NULL)
+        {
+          break;
+        }
+      *pLine++ = '\0';
+    }
+
+  return(num);
+} // end of WHEELREPLAY_split() function
+
+
+//! \brief Reads text rows, with a header naming the Speed_krpm and Iq_A columns or speed_krpm[,Iq_A]
+static int WHEELREPLAY_parseText(char *pText,WHEELREPLAY_Log_t *pLog)
+{
+  char *pLine = pText;
+  int speedColumn = 0;
+  int iqColumn = 1;
+
+  while(pLine != NULL && *pLine != '\0')
+    {
+      char *pNext = strchr(pLine,'\n');
+      char *pFields[WHEELREPLAY_MAX_COLUMNS];
+      char *pStop;
+      double speed_krpm;
+      int numFields;
+      int cnt;
+
+      if(pNext != NULL)
+        {
+          *pNext++ = '\0';
+        }
+
+      if(pLine[0] == '#')
+        {
+          for(cnt=0;cnt<WHEELID_NUM_PARAMS;cnt++)
+            {
+              const char *pName = strstr(pLine,WHEELREPLAY_refNames[cnt]);
+
+              if((pName != NULL) && (pName[strlen(WHEELREPLAY_refNames[cnt])] == '='))
+                {
+                  pLog->ref[cnt] = atof(pName + strlen(WHEELREPLAY_refNames[cnt]) + 1);
+                  pLog->flag_ref[cnt] = 1;
+                }
+            }
+          pLine = pNext;
+          continue;
+        }
+
+      numFields = WHEELREPLAY_split(pLine,pFields);
+
+      // a telemdump or exciterun header
+      for(cnt=0;cnt<numFields;cnt++)
+        {
+          if(strcmp(pFields[cnt],"Speed_krpm") == 0)
+            {
+              speedColumn = cnt;
+            }
+          else if(strcmp(pFields[cnt],"Iq_A") == 0)
+            {
+              iqColumn = cnt;
+            }
+        }
+
+      if(speedColumn < numFields)
+        {
+          speed_krpm = strtod(pFields[speedColumn],&pStop);
+
+          if((pStop != pFields[speedColumn]) && (*pStop == '\0'))
+            {
+              double iq_A = 0.0;
+              int flag_iq = 0;
+
+              if(iqColumn < numFields)
+                {
+                  iq_A = strtod(pFields[iqColumn],&pStop);
+                  flag_iq = (pStop != pFields[iqColumn]) && (*pStop == '\0');
+                }
+
+              // a telemdump row without Iq is from another channel's decimation
+              if((flag_iq || (numFields <= 2)) && !WHEELREPLAY_addRow(pLog,speed_krpm,iq_A,flag_iq))
+                {
+                  return(0);
+                }
+            }
+        }
+
+      pLine = pNext;
+    }
+
+  return(1);
+} // end of WHEELREPLAY_parseText() function
+
+
+//! \brief Reads a whole log, a file, through unzip for an .xlsm, or stdin for "-"
+static int WHEELREPLAY_read(const char *pName,WHEELREPLAY_Log_t *pLog)
+{
+  const size_t nameLength = strlen(pName);
+  const int flag_xlsm = (nameLength > 5) && (strcmp(pName + nameLength - 5,".xlsm") == 0);
+  FILE *pFile;
+  char *pText;
+  size_t length = 0;
+  size_t num;
+  int flag_ok;
+
+
+  if(flag_xlsm)
+    {
+      char command[1024];
+
+      if(strchr(pName,'\'') != NULL)
+        {
+          fprintf(stderr,"%s: quotes in the name\n",pName);
+          return(0);
+        }
+
+      snprintf(command,sizeof(command),"unzip -p '%s' xl/worksheets/sheet1.xml",pName);
+      pFile = popen(command,"r");
+    }
+  else
+    {
+      pFile = (strcmp(pName,"-") == 0) ? stdin : fopen(pName,"rb");
+    }
+
+  if(pFile == NULL)
+    {
+      perror(pName);
+      return(0);
+    }
+
+  pText = malloc(WHEELREPLAY_MAX_LOG_LENGTH + 1);
+  if(pText == NULL)
+    {
+      return(0);
+    }
+
+  while((length < WHEELREPLAY_MAX_LOG_LENGTH) &&
+        ((num = fread(pText + length,1,WHEELREPLAY_MAX_LOG_LENGTH - length,pFile)) != 0))
+    {
+      length += num;
+    }
+  pText[length] = '\0';
+
+  if(flag_xlsm ? (pclose(pFile) != 0) : ((pFile != stdin) && (fclose(pFile) != 0)))
+    {
+      fprintf(stderr,"%s: cannot read\n",pName);
+      free(pText);
+      return(0);
+    }
+
+  num = strspn(pText," \t\r\n");
+  flag_ok = (pText[num] == '<') ? WHEELREPLAY_parseSheet(pText,pLog) : WHEELREPLAY_parseText(pText,pLog);
+
+  free(pText);
+
+  return(flag_ok);
+} // end of WHEELREPLAY_read() function
+
+
+int main(int argc,char *argv[])
+{
+  WHEELREPLAY_Log_t log = {NULL, 0, 0, {0.0, 0.0, 0.0}, {0, 0, 0}};
+  WHEELID_Obj id;
+  const char *pLogName = NULL;
+  const char *pOutName = NULL;
+  const char *pSynthName = NULL;
+  FILE *pOut = NULL;
+  double rate_Hz = WHEELREPLAY_DEFAULT_RATE_Hz;
+  double step_A = 0.0;
+  double maxSpeed_krpm = WHEELREPLAY_DEFAULT_MAX_SPEED_krpm;
+  double deadband_krpm = WHEELID_DEFAULT_DEADBAND_krpm;
+  double forgetting = WHEELID_DEFAULT_FORGETTING;
+  double maxError_pct = -1.0;
+  double refGain_krpmpsPerA = 0.0;
+  double length_sec = 60.0;
+  double errorSqSum = 0.0;
+  double accelSum = 0.0, accelSqSum = 0.0;
+  int flag_step = 0;
+  unsigned long cnt;
+  int arg;
+
+
+  for(arg=1;arg<argc;arg++)
+    {
+      if((argv[arg][0] != '-') || (argv[arg][1] == '\0'))
+        {
+          pLogName = argv[arg];
+          continue;
+        }
+
+      if(arg + 1 >= argc)
+        {
+          WHEELREPLAY_usage(argv[0]);
+          return(2);
+        }
+
+      switch(argv[arg++][1])
+        {
+          case 'r': rate_Hz = atof(argv[arg]); break;
+          case 'i': step_A = atof(argv[arg]); flag_step = 1; break;
+          case 's': maxSpeed_krpm = atof(argv[arg]); break;
+          case 'd': deadband_krpm = atof(argv[arg]); break;
+          case 'f': forgetting = atof(argv[arg]); break;
+          case 'g': refGain_krpmpsPerA = atof(argv[arg]); break;
+          case 'e': maxError_pct = atof(argv[arg]); break;
+          case 'o': pOutName = argv[arg]; break;
+          case 'S': pSynthName = argv[arg]; break;
+          case 'k': WHEELREPLAY_seed = strtoull(argv[arg],NULL,0) | 1; break;
+          case 'l': length_sec = atof(argv[arg]); break;
+          default:
+            WHEELREPLAY_usage(argv[0]);
+            return(2);
+        }
+    }
+
+  if(pSynthName != NULL)
+    {
+      return(WHEELREPLAY_synthesize(pSynthName,length_sec));
+    }
+
+  if((pLogName == NULL) || (rate_Hz <= 0.0) || (forgetting <= 0.0) || (forgetting > 1.0))
+    {
+      WHEELREPLAY_usage(argv[0]);
+      return(2);
+    }
+
+  if(!WHEELREPLAY_read(pLogName,&log))
+    {
+      fprintf(stderr,"%s: could not read the log\n",pLogName);
+      return(1);
+    }
+
+  if(refGain_krpmpsPerA > 0.0)
+    {
+      log.ref[0] = refGain_krpmpsPerA;
+      log.flag_ref[0] = 1;
+    }
+
+  if(log.numRows < 2)
+    {
+      fprintf(stderr,"%s: fewer than two rows\n",pLogName);
+      return(1);
+    }
+
+  if(!log.pRows[0].flag_iq && !flag_step)
+    {
+      fprintf(stderr,"%s: no Iq column, give the step current with -i\n",pLogName);
+      return(1);
+    }
+
+  if(pOutName != NULL)
+    {
+      pOut = fopen(pOutName,"w");
+      if(pOut == NULL)
+        {
+          perror(pOutName);
+          return(1);
+        }
+
+      fprintf(pOut,"row,speed_krpm,iq_A,gain_krpmpsPerA,viscous_ApKrpm,coulomb_A,residual_krpmps\n");
+    }
+
+  // one window per row, decimation 1 at the log rate
+  WHEELID_init(&id,(float)rate_Hz,1);
+  id.forgetting = (float)forgetting;
+  id.deadband_krpm = (float)deadband_krpm;
+  id.maxSpeed_krpm = (float)maxSpeed_krpm;
+
+  for(cnt=1;cnt<log.numRows;cnt++)
+    {
+      const WHEELREPLAY_Row_t *pLast = &log.pRows[cnt - 1];
+      const WHEELREPLAY_Row_t *pRow = &log.pRows[cnt];
+      double meanIq_A = flag_step ? step_A : 0.5 * (pLast->iq_A + pRow->iq_A);
+
+      WHEELID_update(&id,(float)meanIq_A,(float)(0.5 * (pLast->speed_krpm + pRow->speed_krpm)),
+                     (float)(pRow->speed_krpm - pLast->speed_krpm));
+
+      if(pOut != NULL)
+        {
+          fprintf(pOut,"%lu,%.3f,%.3f,%.4f,%.5f,%.4f,%.2f\n",cnt,pRow->speed_krpm,meanIq_A,
+                  id.gain_krpmpsPerA,id.viscous_ApKrpm,id.coulomb_A,id.residual_krpmps);
+        }
+    }
+
+  if(pOut != NULL)
+    {
+      fclose(pOut);
+    }
+
+  // the final model over the windows the estimator took
+  for(cnt=1;cnt<log.numRows;cnt++)
+    {
+      const WHEELREPLAY_Row_t *pLast = &log.pRows[cnt - 1];
+      const WHEELREPLAY_Row_t *pRow = &log.pRows[cnt];
+      double meanIq_A = flag_step ? step_A : 0.5 * (pLast->iq_A + pRow->iq_A);
+      double meanSpeed_krpm = 0.5 * (pLast->speed_krpm + pRow->speed_krpm);
+      double accel_krpmps = (pRow->speed_krpm - pLast->speed_krpm) * rate_Hz;
+      double friction_A = id.viscous_ApKrpm * meanSpeed_krpm + ((meanSpeed_krpm > 0.0) ? id.coulomb_A : -id.coulomb_A);
+      double error_krpmps = accel_krpmps - id.gain_krpmpsPerA * (meanIq_A - friction_A);
+
+      if((fabs(meanSpeed_krpm) < deadband_krpm) ||
+         ((maxSpeed_krpm > 0.0) && (fabs(meanSpeed_krpm) > maxSpeed_krpm)))
+        {
+          continue;
+        }
+
+      errorSqSum += error_krpmps * error_krpmps;
+      accelSum += accel_krpmps;
+      accelSqSum += accel_krpmps * accel_krpmps;
+    }
+
+  printf("rows:      %lu at %.0f Hz, %.2f s\n",log.numRows,rate_Hz,(double)log.numRows / rate_Hz);
+  printf("windows:   %lu taken, %lu skipped\n",(unsigned long)id.numUpdates,(unsigned long)id.numSkipped);
+  printf("model:     gain %.3f krpm/s per A, viscous %.4f A per krpm, Coulomb %.3f A%s\n",
+         id.gain_krpmpsPerA,id.viscous_ApKrpm,id.coulomb_A,id.flag_valid ? "" : " (not valid yet)");
+
+  if(id.numUpdates != 0)
+    {
+      double n = (double)id.numUpdates;
+      double var = accelSqSum / n - (accelSum / n) * (accelSum / n);
+      double rms_krpmps = sqrt(errorSqSum / n);
+
+      printf("fit:       rms acceleration error %.2f krpm/s, %.1f %% of the variance explained\n",
+             rms_krpmps,(var > 0.0) ? 100.0 * (1.0 - rms_krpmps * rms_krpmps / var) : 0.0);
+    }
+
+  if(flag_step)
+    {
+      printf("note:      a constant Iq cannot tell the gain from the Coulomb friction\n");
+    }
+
+  if(log.flag_ref[0] || log.flag_ref[1] || log.flag_ref[2])
+    {
+      const double model[WHEELID_NUM_PARAMS] = {id.gain_krpmpsPerA, id.viscous_ApKrpm, id.coulomb_A};
+      int flag_fail = 0;
+      int param;
+
+      for(param=0;param<WHEELID_NUM_PARAMS;param++)
+        {
+          double error_pct;
+
+          if(!log.flag_ref[param])
+            {
+              continue;
+            }
+
+          error_pct = 100.0 * (model[param] - log.ref[param]) / log.ref[param];
+
+          printf("reference: %-16s %.4f, error %+.1f %%\n",WHEELREPLAY_refNames[param],log.ref[param],error_pct);
+          flag_fail |= (maxError_pct >= 0.0) && (fabs(error_pct) > maxError_pct);
+        }
+
+      if(flag_fail)
+        {
+          printf("FAIL: error above %.1f %%\n",maxError_pct);
+          return(1);
+        }
+    }
+  else if(maxError_pct >= 0.0)
+    {
+      fprintf(stderr,"%s: no reference model to check\n",pLogName);
+      return(1);
+    }
+
+  free(log.pRows);
+
+  return(0);
+} // end of main() function
+
+
+// end of file